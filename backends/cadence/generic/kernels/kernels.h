@@ -6,16 +6,32 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#pragma once
+
 #include <stddef.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <limits>
 
 namespace impl {
 namespace generic {
 namespace kernels {
 
+// Quantize a fp32 value to an int8_t/uint8_t value. Defined inline so that the
+// loops that requantize whole rows of accumulators can be vectorized.
 template <typename T>
-T quantize(const float x, float scale, int32_t zero_point);
+inline T quantize(const float x, float scale, int32_t zero_point) {
+  // Match Executorch CPU kernel implementation at
+  // https://fburl.com/code/fxizw6u6
+  int64_t qvalue;
+  qvalue = static_cast<int64_t>(zero_point + std::nearbyint(scale * x));
+
+  qvalue = std::max<int64_t>(qvalue, std::numeric_limits<T>::min());
+  qvalue = std::min<int64_t>(qvalue, std::numeric_limits<T>::max());
+  return static_cast<T>(qvalue);
+}
 
 template <typename T>
 float dequantize(const T x, float scale, int32_t zero_point);
@@ -11,6 +11,7 @@
 #include <algorithm>
 
 #include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
 
 #ifndef DISABLE_ALWAYS_INLINE
 #define ALWAYS_INLINE __attribute__((always_inline))
@@ -48,7 +49,10 @@ ALWAYS_INLINE void im2row_(
     const int32_t dilation_h,
     const int32_t dilation_w,
     T* __restrict__ data_col,
-    bool channels_last) {
+    bool channels_last,
+    /* range of output rows to fill */
+    const int32_t out_h_begin,
+    const int32_t out_h_end) {
   // Consider convolving the input image of dimensions channels * height * width
   // (or height * width * channels for NHWC layout) with a filter of dimensions
   // channels * kernels_h * kernels_w. Assume that this convolution will produce
@@ -63,7 +67,7 @@ ALWAYS_INLINE void im2row_(
   // points when performing im2row.
   if (channels_last) {
     // Iterate over the output domain
-    for (int _h = 0; _h < out_height; ++_h) {
+    for (int _h = out_h_begin; _h < out_h_end; ++_h) {
       for (int _w = 0; _w < out_width; ++_w) {
         int32_t i_col = _h * out_width + _w;
         // Each point in the output domain is the result of applying a filter of
@@ -94,7 +98,7 @@ ALWAYS_INLINE void im2row_(
     }
   } else {
     // Iterate over the output domain
-    for (int _h = 0; _h < out_height; ++_h) {
+    for (int _h = out_h_begin; _h < out_h_end; ++_h) {
       for (int _w = 0; _w < out_width; ++_w) {
         int32_t i_col = _h * out_width + _w;
 
@@ -123,6 +127,59 @@ ALWAYS_INLINE void im2row_(
   }
 }
 
+// Runs im2row_ on the rows of the output, split across threads.
+template <typename T>
+void im2row_parallel_(
+    const T* __restrict__ data_im,
+    const int32_t in_zero_point,
+    const int32_t channels,
+    const int32_t height,
+    const int32_t width,
+    const int32_t out_height,
+    const int32_t out_width,
+    const int32_t kernel_h,
+    const int32_t kernel_w,
+    const int32_t pad_h,
+    const int32_t pad_w,
+    const int32_t stride_h,
+    const int32_t stride_w,
+    const int32_t dilation_h,
+    const int32_t dilation_w,
+    T* __restrict__ data_col,
+    bool channels_last) {
+  const int64_t row_size =
+      static_cast<int64_t>(out_width) * channels * kernel_h * kernel_w;
+  ::executorch::extension::parallel_for(
+      0,
+      out_height,
+      std::max<int64_t>(
+          1,
+          ::executorch::extension::internal::GRAIN_SIZE /
+              std::max<int64_t>(1, row_size)),
+      [&](const int64_t begin, const int64_t end) {
+        im2row_<T>(
+            data_im,
+            in_zero_point,
+            channels,
+            height,
+            width,
+            out_height,
+            out_width,
+            kernel_h,
+            kernel_w,
+            pad_h,
+            pad_w,
+            stride_h,
+            stride_w,
+            dilation_h,
+            dilation_w,
+            data_col,
+            channels_last,
+            static_cast<int32_t>(begin),
+            static_cast<int32_t>(end));
+      });
+}
+
 Tensor& im2row_out(
     ET_UNUSED KernelRuntimeContext& ctx,
     const Tensor& input,
@@ -179,7 +236,7 @@ Tensor& im2row_out(
     int32_t in_plane = in_c * in_h * in_w;                             \
     int32_t out_plane = kernel_h * kernel_w * in_c * out_h * out_w;    \
     for (int32_t n = 0; n < batch_size; ++n) {                         \
-      im2row_<ctype>(                                                  \
+      im2row_parallel_<ctype>(                                         \
           &in_data[n * in_plane],                                      \
           per_tensor_quantized ? zero_point[0] : zero_point[n],        \
           in_c,                                                        \
@@ -267,7 +324,7 @@ Tensor& im2row_per_tensor_out(
     int32_t in_plane = in_c * in_h * in_w;                             \
     int32_t out_plane = kernel_h * kernel_w * in_c * out_h * out_w;    \
     for (size_t n = 0; n < batch_size; ++n) {                          \
-      im2row_<ctype>(                                                  \
+      im2row_parallel_<ctype>(                                         \
           &in_data[n * in_plane],                                      \
           in_zero_point,                                               \
           in_c,                                                        \
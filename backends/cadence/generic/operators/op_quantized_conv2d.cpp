@@ -10,7 +10,13 @@
 
 #include <executorch/backends/cadence/generic/kernels/kernels.h>
 #include <executorch/backends/cadence/generic/operators/cadence_type_util.h>
+#include <executorch/backends/cadence/generic/operators/quantized_gemm.h>
 #include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
 
 namespace impl {
 namespace generic {
@@ -282,6 +288,380 @@ __attribute__((noinline)) void conv2d_nhwc_core_generic(
   }
 }
 
+// Integers below 2^24 in magnitude are exact in float.
+constexpr int64_t kFloatExactIntegerLimit = int64_t(1) << 24;
+// The shortest reduction for which im2row + GEMM beats the reference loops.
+constexpr int64_t kConv2dGemmMinDepth = 16;
+
+/* Fast host path for the quantized convolutions above: im2row followed by a
+ * blocked GEMM with int32 accumulation, split across threads by output
+ * channel. The reference kernels accumulate in float, in the order of the
+ * im2row columns, so the fast path has to reproduce their rounding:
+ *  - an output channel whose partial sums provably stay below 2^24 in
+ *    magnitude, given the largest input magnitude and the sum of its weight
+ *    magnitudes, is computed in int32, which is then exact in both;
+ *  - any other output channel is accumulated in float in the reference order,
+ *    which is exact as long as every single product is.
+ * Returns false, without touching the output, when some product may round,
+ * when some partial sum may overflow int32 or when the reductions are too
+ * short to pay for the im2row copy, as in depthwise convolutions; the caller
+ * then runs the reference kernel.
+ *
+ * channels_last selects NHWC input and output with [oc, wh, ww, wc] weights
+ * instead of NCHW with [oc, wc, wh, ww]; depthwise_hwc_weight selects the
+ * [wh, ww, oc] weights of NHWC depthwise convolutions.
+ */
+template <typename IT, typename WT, typename OT>
+bool conv2d_gemm(
+    const IT* __restrict__ p_in,
+    const WT* __restrict__ p_weight,
+    const int32_t* __restrict__ p_bias,
+    OT* __restrict__ p_out,
+    bool channels_last,
+    bool depthwise_hwc_weight,
+    int32_t n,
+    int32_t c,
+    int32_t h,
+    int32_t w,
+    int32_t oc,
+    int32_t wc,
+    int32_t wh,
+    int32_t ww,
+    int32_t oh,
+    int32_t ow,
+    int16_t s0,
+    int16_t s1,
+    int16_t p0,
+    int16_t p1,
+    int16_t d0,
+    int16_t d1,
+    int16_t groups,
+    int32_t in_zero_point,
+    int32_t weight_zero_point,
+    float bias_scale,
+    float out_scale,
+    int32_t out_zero_point) {
+  // The centered inputs fit CT only for zero points in the range of IT.
+  if (groups <= 0 || c % groups != 0 || oc % groups != 0 ||
+      static_cast<int32_t>(static_cast<IT>(in_zero_point)) != in_zero_point) {
+    return false;
+  }
+  const int64_t icpg = c / groups;
+  const int64_t ocpg = oc / groups;
+  if ((depthwise_hwc_weight && icpg != 1) ||
+      (!depthwise_hwc_weight && wc != icpg)) {
+    return false;
+  }
+  const int64_t k = icpg * wh * ww;
+  if (k < kConv2dGemmMinDepth) {
+    return false;
+  }
+  const int64_t npix = static_cast<int64_t>(oh) * ow;
+  const int64_t in_numel = static_cast<int64_t>(n) * c * h * w;
+
+  // Padding contributes nothing, so the largest input magnitude bounds every
+  // activation of the im2row matrix.
+  int64_t in_max = 0;
+  for (int64_t i = 0; i < in_numel; ++i) {
+    const int64_t x = static_cast<int64_t>(p_in[i]) - in_zero_point;
+    in_max = std::max(in_max, x < 0 ? -x : x);
+  }
+
+  // The weights without their zero point, as [oc, k] in the im2row column
+  // order.
+  using CT = ::impl::generic::quantized::centered_t<IT, WT>;
+  std::vector<CT> weight(static_cast<size_t>(oc) * k);
+  // Per output channel: whether int32 accumulation matches the reference.
+  std::vector<uint8_t> exact_int(oc);
+  for (int64_t j = 0; j < oc; ++j) {
+    int64_t abs_sum = 0;
+    int64_t abs_max = 0;
+    for (int64_t kk = 0; kk < k; ++kk) {
+      const int64_t rhs = static_cast<int64_t>(
+                              depthwise_hwc_weight ? p_weight[kk * oc + j]
+                                                   : p_weight[j * k + kk]) -
+          weight_zero_point;
+      weight[j * k + kk] = static_cast<CT>(rhs);
+      abs_sum += rhs < 0 ? -rhs : rhs;
+      abs_max = std::max(abs_max, rhs < 0 ? -rhs : rhs);
+    }
+    if (abs_max > std::numeric_limits<CT>::max() ||
+        in_max * abs_max >= kFloatExactIntegerLimit) {
+      return false;
+    }
+    // The GEMM accumulates every channel in int32, including the ones that
+    // are then recomputed in float.
+    const int64_t bias = p_bias[j];
+    const int64_t bound = (bias < 0 ? -bias : bias) + in_max * abs_sum;
+    if (bound > std::numeric_limits<int32_t>::max()) {
+      return false;
+    }
+    exact_int[j] = bound < kFloatExactIntegerLimit;
+  }
+
+  // The im2row matrix of a batch without the input zero point: [groups, npix,
+  // k], with zeros for the padding.
+  std::vector<CT> col(static_cast<size_t>(groups) * npix * k);
+  const float inv_out_scale = 1.f / out_scale;
+  const int64_t pixel_cost = std::max<int64_t>(1, groups * k);
+  for (int64_t _n = 0; _n < n; ++_n) {
+    const IT* in_batch = p_in + _n * c * h * w;
+    OT* out_batch = p_out + _n * oc * npix;
+    ::executorch::extension::parallel_for(
+        0,
+        npix,
+        std::max<int64_t>(
+            1, ::executorch::extension::internal::GRAIN_SIZE / pixel_cost),
+        [&](const int64_t begin, const int64_t end) {
+          for (int64_t pix = begin; pix < end; ++pix) {
+            const int64_t _h = (pix / ow) * s0 - p0;
+            const int64_t _w = (pix % ow) * s1 - p1;
+            for (int64_t _g = 0; _g < groups; ++_g) {
+              CT* col_row = col.data() + (_g * npix + pix) * k;
+              for (int64_t _wh = 0; _wh < wh; ++_wh) {
+                for (int64_t _ww = 0; _ww < ww; ++_ww) {
+                  const int64_t ih = _h + d0 * _wh;
+                  const int64_t iw = _w + d1 * _ww;
+                  const bool inside = ih >= 0 && ih < h && iw >= 0 && iw < w;
+                  for (int64_t _ic = 0; _ic < icpg; ++_ic) {
+                    const int64_t ic = _g * icpg + _ic;
+                    const int64_t col_idx = channels_last
+                        ? (_wh * ww + _ww) * icpg + _ic
+                        : (_ic * wh + _wh) * ww + _ww;
+                    const int64_t in_idx = channels_last
+                        ? (ih * w + iw) * c + ic
+                        : (ic * h + ih) * w + iw;
+                    col_row[col_idx] = inside
+                        ? static_cast<CT>(in_batch[in_idx] - in_zero_point)
+                        : CT(0);
+                  }
+                }
+              }
+            }
+          }
+        });
+
+    ::impl::generic::quantized::quantized_gemm_nt(
+        col.data(),
+        weight.data(),
+        p_bias,
+        groups,
+        npix,
+        ocpg,
+        k,
+        [&](int64_t j, int64_t m_begin, int64_t m_end, const int32_t* acc) {
+          const int64_t out_stride = channels_last ? oc : 1;
+          OT* out = channels_last ? out_batch + m_begin * oc + j
+                                  : out_batch + j * npix + m_begin;
+          if (exact_int[j]) {
+            for (int64_t i = 0; i < m_end - m_begin; ++i) {
+              float val = bias_scale * static_cast<float>(acc[i]);
+              out[i * out_stride] =
+                  quantize<OT>(val, inv_out_scale, out_zero_point);
+            }
+            return;
+          }
+          // Accumulate in float, in the order of the reference.
+          const CT* col_rows = col.data() + ((j / ocpg) * npix + m_begin) * k;
+          const CT* weight_row = weight.data() + j * k;
+          for (int64_t i = 0; i < m_end - m_begin; ++i) {
+            float acc_f = p_bias[j];
+            for (int64_t kk = 0; kk < k; ++kk) {
+              float lhs = col_rows[i * k + kk];
+              float rhs = weight_row[kk];
+              acc_f += lhs * rhs;
+            }
+            float val = bias_scale * acc_f;
+            out[i * out_stride] =
+                quantize<OT>(val, inv_out_scale, out_zero_point);
+          }
+        });
+  }
+  return true;
+}
+
+// Quantized NCHW convolution: the fast host path when it reproduces the
+// reference kernel, the reference kernel otherwise.
+template <typename IT, typename WT, typename OT>
+void quantized_conv2d_nchw_core(
+    const IT* __restrict__ p_in,
+    const WT* __restrict__ p_weight,
+    const int32_t* __restrict__ p_bias,
+    OT* __restrict__ p_out,
+    int32_t n,
+    int32_t c,
+    int32_t h,
+    int32_t w,
+    int32_t oc,
+    int32_t wc,
+    int32_t wh,
+    int32_t ww,
+    int32_t oh,
+    int32_t ow,
+    int16_t s0,
+    int16_t s1,
+    int16_t p0,
+    int16_t p1,
+    int16_t d0,
+    int16_t d1,
+    int16_t groups,
+    IT in_zero_point,
+    int32_t weight_zero_point,
+    float bias_scale,
+    float out_scale,
+    OT out_zero_point) {
+  if (conv2d_gemm<IT, WT, OT>(
+          p_in,
+          p_weight,
+          p_bias,
+          p_out,
+          /*channels_last=*/false,
+          /*depthwise_hwc_weight=*/false,
+          n,
+          c,
+          h,
+          w,
+          oc,
+          wc,
+          wh,
+          ww,
+          oh,
+          ow,
+          s0,
+          s1,
+          p0,
+          p1,
+          d0,
+          d1,
+          groups,
+          in_zero_point,
+          weight_zero_point,
+          bias_scale,
+          out_scale,
+          out_zero_point)) {
+    return;
+  }
+  conv2d_nchw_core_generic<IT, WT, int32_t, OT, true>(
+      p_in,
+      p_weight,
+      p_bias,
+      p_out,
+      n,
+      c,
+      h,
+      w,
+      oc,
+      wc,
+      wh,
+      ww,
+      oh,
+      ow,
+      s0,
+      s1,
+      p0,
+      p1,
+      d0,
+      d1,
+      groups,
+      in_zero_point,
+      weight_zero_point,
+      bias_scale,
+      out_scale,
+      out_zero_point);
+}
+
+// Quantized NHWC convolution: the fast host path when it reproduces the
+// reference kernel, the reference kernel otherwise.
+template <typename IT, typename WT, typename OT>
+void quantized_conv2d_nhwc_core(
+    const IT* __restrict__ p_in,
+    const WT* __restrict__ p_weight,
+    const int32_t* __restrict__ p_bias,
+    OT* __restrict__ p_out,
+    int32_t n,
+    int32_t h,
+    int32_t w,
+    int32_t c,
+    int32_t oc,
+    int32_t wh,
+    int32_t ww,
+    int32_t wc,
+    int32_t oh,
+    int32_t ow,
+    int16_t s0,
+    int16_t s1,
+    int16_t p0,
+    int16_t p1,
+    int16_t d0,
+    int16_t d1,
+    int16_t groups,
+    IT in_zero_point,
+    int32_t weight_zero_point,
+    float bias_scale,
+    float out_scale,
+    OT out_zero_point,
+    bool depthwise_hwc_weight) {
+  if (conv2d_gemm<IT, WT, OT>(
+          p_in,
+          p_weight,
+          p_bias,
+          p_out,
+          /*channels_last=*/true,
+          depthwise_hwc_weight,
+          n,
+          c,
+          h,
+          w,
+          oc,
+          wc,
+          wh,
+          ww,
+          oh,
+          ow,
+          s0,
+          s1,
+          p0,
+          p1,
+          d0,
+          d1,
+          groups,
+          in_zero_point,
+          weight_zero_point,
+          bias_scale,
+          out_scale,
+          out_zero_point)) {
+    return;
+  }
+  conv2d_nhwc_core_generic<IT, WT, int32_t, OT, true>(
+      p_in,
+      p_weight,
+      p_bias,
+      p_out,
+      n,
+      h,
+      w,
+      c,
+      oc,
+      wh,
+      ww,
+      wc,
+      oh,
+      ow,
+      s0,
+      s1,
+      p0,
+      p1,
+      d0,
+      d1,
+      groups,
+      in_zero_point,
+      weight_zero_point,
+      bias_scale,
+      out_scale,
+      out_zero_point,
+      depthwise_hwc_weight);
+}
+
 void quantized_conv2d_nchw(
     const Tensor& input,
     const Tensor& weight,
@@ -321,7 +701,7 @@ void quantized_conv2d_nchw(
   if (out.scalar_type() == ScalarType::Short &&
       input.scalar_type() == ScalarType::Short &&
       weight.scalar_type() == ScalarType::Char) {
-    conv2d_nchw_core_generic<int16_t, int8_t, int32_t, int16_t, true>(
+    quantized_conv2d_nchw_core<int16_t, int8_t, int16_t>(
         input.const_data_ptr<int16_t>(),
         weight.const_data_ptr<int8_t>(),
         bias.const_data_ptr<int32_t>(),
@@ -351,36 +731,36 @@ void quantized_conv2d_nchw(
     return;
   }
 
-#define typed_quantized_conv2d_nchw(ctype, dtype)                 \
-  case ScalarType::dtype: {                                       \
-    conv2d_nchw_core_generic<ctype, ctype, int32_t, ctype, true>( \
-        input.const_data_ptr<ctype>(),                            \
-        weight.const_data_ptr<ctype>(),                           \
-        bias.const_data_ptr<int32_t>(),                           \
-        out.mutable_data_ptr<ctype>(),                            \
-        n,                                                        \
-        c,                                                        \
-        h,                                                        \
-        w,                                                        \
-        oc,                                                       \
-        wc,                                                       \
-        wh,                                                       \
-        ww,                                                       \
-        oh,                                                       \
-        ow,                                                       \
-        stride[0],                                                \
-        stride[1],                                                \
-        padding[0],                                               \
-        padding[1],                                               \
-        dilation[0],                                              \
-        dilation[1],                                              \
-        groups,                                                   \
-        in_zero_point,                                            \
-        weight_zero_point,                                        \
-        bias_scale,                                               \
-        output_scale,                                             \
-        (ctype)output_zero_point);                                \
-    break;                                                        \
+#define typed_quantized_conv2d_nchw(ctype, dtype)    \
+  case ScalarType::dtype: {                          \
+    quantized_conv2d_nchw_core<ctype, ctype, ctype>( \
+        input.const_data_ptr<ctype>(),               \
+        weight.const_data_ptr<ctype>(),              \
+        bias.const_data_ptr<int32_t>(),              \
+        out.mutable_data_ptr<ctype>(),               \
+        n,                                           \
+        c,                                           \
+        h,                                           \
+        w,                                           \
+        oc,                                          \
+        wc,                                          \
+        wh,                                          \
+        ww,                                          \
+        oh,                                          \
+        ow,                                          \
+        stride[0],                                   \
+        stride[1],                                   \
+        padding[0],                                  \
+        padding[1],                                  \
+        dilation[0],                                 \
+        dilation[1],                                 \
+        groups,                                      \
+        in_zero_point,                               \
+        weight_zero_point,                           \
+        bias_scale,                                  \
+        output_scale,                                \
+        (ctype)output_zero_point);                   \
+    break;                                           \
   }
   ScalarType dtype = out.scalar_type();
   switch (dtype) {
@@ -443,6 +823,37 @@ void quantized_conv2d_nhwc_depthwise(
     const auto* p_weight = weight.const_data_ptr<ctype>();                   \
     const auto* p_bias = bias.const_data_ptr<int32_t>();                     \
     auto* p_out = out.mutable_data_ptr<ctype>();                             \
+    if (conv2d_gemm<ctype, ctype, ctype>(                                    \
+            p_in,                                                            \
+            p_weight,                                                        \
+            p_bias,                                                          \
+            p_out,                                                           \
+            /*channels_last=*/true,                                          \
+            /*depthwise_hwc_weight=*/true,                                   \
+            n,                                                               \
+            c,                                                               \
+            h,                                                               \
+            w,                                                               \
+            oc,                                                              \
+            /*wc=*/1,                                                        \
+            kh,                                                              \
+            kw,                                                              \
+            oh,                                                              \
+            ow,                                                              \
+            stride[0],                                                       \
+            stride[1],                                                       \
+            padding[0],                                                      \
+            padding[1],                                                      \
+            dilation[0],                                                     \
+            dilation[1],                                                     \
+            groups,                                                          \
+            in_zero_point,                                                   \
+            weight_zero_point,                                               \
+            bias_scale,                                                      \
+            output_scale,                                                    \
+            (ctype)output_zero_point)) {                                     \
+      break;                                                                 \
+    }                                                                        \
     for (int _n = 0; _n < n; ++_n) {                                         \
       const ctype* in_batch = p_in + _n * h * w * c;                         \
       ctype* out_batch = p_out + _n * oh * ow * oc;                          \
@@ -534,7 +945,7 @@ void quantized_conv2d_nhwc(
   if (out.scalar_type() == ScalarType::Short &&
       input.scalar_type() == ScalarType::Short &&
       weight.scalar_type() == ScalarType::Char) {
-    conv2d_nhwc_core_generic<int16_t, int8_t, int32_t, int16_t, true>(
+    quantized_conv2d_nhwc_core<int16_t, int8_t, int16_t>(
         input.const_data_ptr<int16_t>(),
         weight.const_data_ptr<int8_t>(),
         bias.const_data_ptr<int32_t>(),
@@ -565,37 +976,37 @@ void quantized_conv2d_nhwc(
     return;
   }
 
-#define typed_quantized_conv2d_nhwc(ctype, dtype)                 \
-  case ScalarType::dtype: {                                       \
-    conv2d_nhwc_core_generic<ctype, ctype, int32_t, ctype, true>( \
-        input.const_data_ptr<ctype>(),                            \
-        weight.const_data_ptr<ctype>(),                           \
-        bias.const_data_ptr<int32_t>(),                           \
-        out.mutable_data_ptr<ctype>(),                            \
-        n,                                                        \
-        h,                                                        \
-        w,                                                        \
-        c,                                                        \
-        oc,                                                       \
-        wh,                                                       \
-        ww,                                                       \
-        wc,                                                       \
-        oh,                                                       \
-        ow,                                                       \
-        stride[0],                                                \
-        stride[1],                                                \
-        padding[0],                                               \
-        padding[1],                                               \
-        dilation[0],                                              \
-        dilation[1],                                              \
-        groups,                                                   \
-        in_zero_point,                                            \
-        weight_zero_point,                                        \
-        bias_scale,                                               \
-        output_scale,                                             \
-        (ctype)output_zero_point,                                 \
-        is_depthwise);                                            \
-    break;                                                        \
+#define typed_quantized_conv2d_nhwc(ctype, dtype)    \
+  case ScalarType::dtype: {                          \
+    quantized_conv2d_nhwc_core<ctype, ctype, ctype>( \
+        input.const_data_ptr<ctype>(),               \
+        weight.const_data_ptr<ctype>(),              \
+        bias.const_data_ptr<int32_t>(),              \
+        out.mutable_data_ptr<ctype>(),               \
+        n,                                           \
+        h,                                           \
+        w,                                           \
+        c,                                           \
+        oc,                                          \
+        wh,                                          \
+        ww,                                          \
+        wc,                                          \
+        oh,                                          \
+        ow,                                          \
+        stride[0],                                   \
+        stride[1],                                   \
+        padding[0],                                  \
+        padding[1],                                  \
+        dilation[0],                                 \
+        dilation[1],                                 \
+        groups,                                      \
+        in_zero_point,                               \
+        weight_zero_point,                           \
+        bias_scale,                                  \
+        output_scale,                                \
+        (ctype)output_zero_point,                    \
+        is_depthwise);                               \
+    break;                                           \
   }
   ScalarType dtype = out.scalar_type();
   switch (dtype) {
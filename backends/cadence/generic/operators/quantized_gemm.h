@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+
+namespace impl::generic::quantized {
+
+// Output channels that are computed together, so that every activation value
+// loaded is used for several dot products.
+constexpr int64_t kGemmBlockN = 4;
+// Activation rows that are computed for every block of output channels before
+// moving on, so that they stay in cache across the blocks of a thread.
+constexpr int64_t kGemmTileM = 64;
+
+/**
+ * The type that holds the quantized values of types IT and WT after their
+ * zero points are subtracted. int16_t operands let the dot products use the
+ * 16-bit multiply-accumulate instructions of the host.
+ */
+template <typename IT, typename WT>
+using centered_t =
+    std::conditional_t<sizeof(IT) == 1 && sizeof(WT) == 1, int16_t, int32_t>;
+
+// Stores x[i] - zero_point into y[i], for i in [0, size).
+template <typename T, typename CT>
+inline void center_(
+    CT* __restrict__ y,
+    const T* __restrict__ x,
+    int32_t zero_point,
+    int64_t size) {
+  for (int64_t i = 0; i < size; ++i) {
+    y[i] = static_cast<CT>(static_cast<int32_t>(x[i]) - zero_point);
+  }
+}
+
+// Computes the dot products of `rows` activation rows of `a` with `cols` <=
+// kGemmBlockN weight rows of `b`, all `k` long. acc[j][i] receives the product
+// of activation row i and weight row j.
+template <typename CT>
+inline void gemm_block_(
+    const CT* __restrict__ a,
+    const CT* __restrict__ b,
+    int64_t k,
+    int64_t rows,
+    int64_t cols,
+    int32_t (*__restrict__ acc)[kGemmTileM]) {
+  for (int64_t i = 0; i < rows; ++i) {
+    const CT* __restrict__ a_row = a + i * k;
+    if (cols == kGemmBlockN) {
+      const CT* __restrict__ b0 = b;
+      const CT* __restrict__ b1 = b + k;
+      const CT* __restrict__ b2 = b + 2 * k;
+      const CT* __restrict__ b3 = b + 3 * k;
+      int32_t sum0 = 0;
+      int32_t sum1 = 0;
+      int32_t sum2 = 0;
+      int32_t sum3 = 0;
+      for (int64_t kk = 0; kk < k; ++kk) {
+        sum0 += static_cast<int32_t>(a_row[kk]) * b0[kk];
+        sum1 += static_cast<int32_t>(a_row[kk]) * b1[kk];
+        sum2 += static_cast<int32_t>(a_row[kk]) * b2[kk];
+        sum3 += static_cast<int32_t>(a_row[kk]) * b3[kk];
+      }
+      acc[0][i] = sum0;
+      acc[1][i] = sum1;
+      acc[2][i] = sum2;
+      acc[3][i] = sum3;
+    } else {
+      for (int64_t j = 0; j < cols; ++j) {
+        const CT* __restrict__ b_row = b + j * k;
+        int32_t sum = 0;
+        for (int64_t kk = 0; kk < k; ++kk) {
+          sum += static_cast<int32_t>(a_row[kk]) * b_row[kk];
+        }
+        acc[j][i] = sum;
+      }
+    }
+  }
+}
+
+/**
+ * Multiplies the activations `a` with the transposed weights `b` in int32:
+ *
+ *   acc[i][j] = bias[j] + sum_k a[i][k] * b[j][k]
+ *
+ * for the [m x k] activations and [n x k] weights of each of `groups`
+ * independent problems, laid out one after the other; output channel j uses
+ * the activations of group j / n_per_group. Both operands have their zero
+ * points subtracted already (see center_()). Every element is accumulated in
+ * int32 like the scalar reference loops, so the result does not depend on the
+ * summation order.
+ *
+ * The output channels are split across threads with parallel_for, in blocks
+ * of kGemmBlockN. Each result is handed to `store(j, m_begin, m_end, acc)`,
+ * where acc[i - m_begin] holds the accumulator of activation row i and output
+ * channel j. Calls for different output channels may run concurrently.
+ */
+template <typename CT, typename Store>
+void quantized_gemm_nt(
+    const CT* __restrict__ a,
+    const CT* __restrict__ b,
+    const int32_t* __restrict__ bias,
+    int64_t groups,
+    int64_t m,
+    int64_t n_per_group,
+    int64_t k,
+    const Store& store) {
+  if (groups <= 0 || m <= 0 || n_per_group <= 0) {
+    return;
+  }
+  const int64_t blocks_per_group =
+      (n_per_group + kGemmBlockN - 1) / kGemmBlockN;
+  const int64_t work_per_block = std::max<int64_t>(1, kGemmBlockN * m * k);
+  const int64_t grain_size = std::max<int64_t>(
+      1, ::executorch::extension::internal::GRAIN_SIZE / work_per_block);
+  ::executorch::extension::parallel_for(
+      0,
+      groups * blocks_per_group,
+      grain_size,
+      [&](const int64_t begin, const int64_t end) {
+        int32_t acc[kGemmBlockN][kGemmTileM];
+        for (int64_t m_begin = 0; m_begin < m; m_begin += kGemmTileM) {
+          const int64_t rows = std::min(kGemmTileM, m - m_begin);
+          for (int64_t block = begin; block < end; ++block) {
+            const int64_t g = block / blocks_per_group;
+            const int64_t j_begin = g * n_per_group +
+                (block % blocks_per_group) * kGemmBlockN;
+            const int64_t cols =
+                std::min(kGemmBlockN, (g + 1) * n_per_group - j_begin);
+            gemm_block_(
+                a + (g * m + m_begin) * k, b + j_begin * k, k, rows, cols, acc);
+            for (int64_t j = 0; j < cols; ++j) {
+              const int32_t bias_j = bias[j_begin + j];
+              for (int64_t i = 0; i < rows; ++i) {
+                acc[j][i] += bias_j;
+              }
+              store(j_begin + j, m_begin, m_begin + rows, acc[j]);
+            }
+          }
+        }
+      });
+}
+
+// Handles the products with fewer activation rows than kGemmBlockN, like the
+// ones of decoding a single token, where centering the weights would cost as
+// much as the products themselves.
+template <typename IT, typename WT, typename Store>
+void matvec_nt_(
+    const IT* __restrict__ a,
+    const WT* __restrict__ b,
+    const int32_t* __restrict__ bias,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    int32_t a_zero_point,
+    int32_t b_zero_point,
+    const Store& store) {
+  std::vector<int32_t> a_centered(m * k);
+  center_(a_centered.data(), a, a_zero_point, m * k);
+  ::executorch::extension::parallel_for(
+      0,
+      n,
+      std::max<int64_t>(
+          1,
+          ::executorch::extension::internal::GRAIN_SIZE /
+              std::max<int64_t>(1, m * k)),
+      [&](const int64_t begin, const int64_t end) {
+        int32_t acc[kGemmBlockN];
+        for (int64_t j = begin; j < end; ++j) {
+          const WT* __restrict__ b_row = b + j * k;
+          for (int64_t i = 0; i < m; ++i) {
+            const int32_t* __restrict__ a_row = a_centered.data() + i * k;
+            int32_t sum = bias[j];
+            for (int64_t kk = 0; kk < k; ++kk) {
+              sum += a_row[kk] *
+                  (static_cast<int32_t>(b_row[kk]) - b_zero_point);
+            }
+            acc[i] = sum;
+          }
+          store(j, 0, m, acc);
+        }
+      });
+}
+
+template <typename CT, typename IT, typename WT, typename Store>
+void centered_matmul_nt_(
+    const IT* __restrict__ a,
+    const WT* __restrict__ b,
+    const int32_t* __restrict__ bias,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    int32_t a_zero_point,
+    int32_t b_zero_point,
+    const Store& store) {
+  std::vector<CT> a_centered(m * k);
+  std::vector<CT> b_centered(n * k);
+  center_(a_centered.data(), a, a_zero_point, m * k);
+  center_(b_centered.data(), b, b_zero_point, n * k);
+  quantized_gemm_nt(
+      a_centered.data(),
+      b_centered.data(),
+      bias,
+      /*groups=*/1,
+      m,
+      n,
+      k,
+      store);
+}
+
+/**
+ * Runs quantized_gemm_nt() on the [m x k] activations `a` and the [n x k]
+ * weights `b`, after subtracting their zero points. The int32 results wrap
+ * around like the ones of the scalar reference loops.
+ */
+template <typename IT, typename WT, typename Store>
+void quantized_matmul_nt(
+    const IT* __restrict__ a,
+    const WT* __restrict__ b,
+    const int32_t* __restrict__ bias,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    int32_t a_zero_point,
+    int32_t b_zero_point,
+    const Store& store) {
+  if (m < kGemmBlockN) {
+    matvec_nt_(a, b, bias, m, n, k, a_zero_point, b_zero_point, store);
+    return;
+  }
+  // The narrow type only holds the centered values when the zero points are
+  // in the range of their quantized types.
+  if constexpr (std::is_same_v<centered_t<IT, WT>, int16_t>) {
+    if (static_cast<int32_t>(static_cast<IT>(a_zero_point)) == a_zero_point &&
+        static_cast<int32_t>(static_cast<WT>(b_zero_point)) == b_zero_point) {
+      centered_matmul_nt_<int16_t>(
+          a, b, bias, m, n, k, a_zero_point, b_zero_point, store);
+      return;
+    }
+  }
+  centered_matmul_nt_<int32_t>(
+      a, b, bias, m, n, k, a_zero_point, b_zero_point, store);
+}
+
+} // namespace impl::generic::quantized
@@ -11,6 +11,7 @@
 #include <cstdint>
 
 #include <executorch/backends/cadence/generic/kernels/kernels.h>
+#include <executorch/backends/cadence/generic/operators/quantized_gemm.h>
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -45,19 +46,21 @@ inline __attribute__((always_inline)) void quantized_linear_per_tensor_(
   // Compute the requant_scale from out_multiplier and out_shift
   const float requant_scale =
       -out_multiplier * 1.0 / (1 << 31) * pow(2, out_shift);
-  for (size_t i = 0; i < leading_dims; ++i) {
-    for (size_t j = 0; j < out_dim; ++j) {
-      int32_t sum = bias_data[j];
-      for (size_t k = 0; k < in_dim; ++k) {
-        int32_t x = (int32_t)in_data[i * in_dim + k] - src_zero_point;
-        int32_t w =
-            (int32_t)weight_data[j * in_dim + k] - (int32_t)weight_zero_point;
-        sum += x * w;
-      }
-      out_data[i * out_dim + j] = ::impl::generic::kernels::quantize<IT>(
-          sum, requant_scale, out_zero_point);
-    }
-  }
+  quantized_matmul_nt(
+      in_data,
+      weight_data,
+      bias_data,
+      leading_dims,
+      out_dim,
+      in_dim,
+      static_cast<int32_t>(src_zero_point),
+      static_cast<int32_t>(weight_zero_point),
+      [&](int64_t j, int64_t i_begin, int64_t i_end, const int32_t* sum) {
+        for (int64_t i = i_begin; i < i_end; ++i) {
+          out_data[i * out_dim + j] = ::impl::generic::kernels::quantize<IT>(
+              sum[i - i_begin], requant_scale, out_zero_point);
+        }
+      });
 }
 
 template <typename T, typename WT = T>
@@ -114,22 +117,24 @@ inline __attribute__((always_inline)) void quantized_linear_per_channel_(
   const int32_t* __restrict__ out_shift_data =
       out_shift.const_data_ptr<int32_t>();
 
-  for (size_t i = 0; i < leading_dims; ++i) {
-    for (size_t j = 0; j < out_dim; ++j) {
-      int32_t sum = bias_data[j];
-      for (size_t k = 0; k < in_dim; ++k) {
-        int32_t x = (int32_t)in_data[i * in_dim + k] - src_zero_point;
-        int32_t w =
-            (int32_t)weight_data[j * in_dim + k] - (int32_t)weight_zero_point;
-        sum += x * w;
-      }
-      // Compute the out_scale from out_multiplier and out_shift
-      const float out_scale =
-          -out_multiplier_data[j] * 1.0 / (1 << 31) * pow(2, out_shift_data[j]);
-      out_data[i * out_dim + j] =
-          ::impl::generic::kernels::quantize<T>(sum, out_scale, out_zero_point);
-    }
-  }
+  quantized_matmul_nt(
+      in_data,
+      weight_data,
+      bias_data,
+      leading_dims,
+      out_dim,
+      in_dim,
+      static_cast<int32_t>(src_zero_point),
+      static_cast<int32_t>(weight_zero_point),
+      [&](int64_t j, int64_t i_begin, int64_t i_end, const int32_t* sum) {
+        // Compute the out_scale from out_multiplier and out_shift
+        const float out_scale = -out_multiplier_data[j] * 1.0 / (1 << 31) *
+            pow(2, out_shift_data[j]);
+        for (int64_t i = i_begin; i < i_end; ++i) {
+          out_data[i * out_dim + j] = ::impl::generic::kernels::quantize<T>(
+              sum[i - i_begin], out_scale, out_zero_point);
+        }
+      });
 }
 
 template <typename T, typename WT = T>
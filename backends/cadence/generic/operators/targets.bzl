@@ -20,10 +20,19 @@ def define_common_targets():
         ]
     )
 
+    runtime.cxx_library(
+        name = "quantized_gemm",
+        exported_headers = ["quantized_gemm.h"],
+        exported_deps = [
+            "//executorch/extension/threadpool:threadpool",
+        ],
+    )
+
     runtime.cxx_library(
         name = "quantized_linear",
         exported_headers = ["quantized_linear.h"],
         exported_deps = [
+            ":quantized_gemm",
             "//executorch/runtime/kernel:kernel_includes",
             "//executorch/backends/cadence/generic/kernels:cadence_kernels",
         ]
@@ -153,6 +162,7 @@ def define_common_targets():
         platforms = CXX,
         deps = [
             ":cadence_type_util",
+            ":quantized_gemm",
             "//executorch/backends/cadence/generic/kernels:cadence_kernels",
             "//executorch/runtime/kernel:kernel_includes",
         ],
@@ -386,6 +396,7 @@ def define_common_targets():
         platforms = CXX,
         deps = [
             "//executorch/backends/cadence/generic/kernels:cadence_kernels",
+            "//executorch/extension/threadpool:threadpool",
             "//executorch/runtime/core/exec_aten:lib",
             "//executorch/runtime/kernel:kernel_runtime_context",
         ],
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Measures the host implementations of the quantized convolution and linear
+// operators on the layer shapes of common vision and language models. The
+// items processed are multiply-accumulates.
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <executorch/backends/cadence/generic/operators/op_quantized_conv2d.h>
+#include <executorch/backends/cadence/generic/operators/op_quantized_linear.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::KernelRuntimeContext;
+using executorch::runtime::testing::TensorFactory;
+
+namespace {
+
+std::vector<int8_t> random_int8(size_t size, int seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int32_t> dist(-128, 127);
+  std::vector<int8_t> values(size);
+  for (auto& value : values) {
+    value = static_cast<int8_t>(dist(gen));
+  }
+  return values;
+}
+
+struct ConvLayer {
+  const char* name;
+  int32_t c;
+  int32_t hw;
+  int32_t oc;
+  int32_t k;
+  int64_t stride;
+  int32_t groups;
+};
+
+const std::vector<ConvLayer>& conv_layers() {
+  static const std::vector<ConvLayer> layers = {
+      // ResNet stem-like strided 3x3.
+      {"3x3_s2_c3_oc32_224", 3, 224, 32, 3, 2, 1},
+      // ResNet body 3x3.
+      {"3x3_c64_oc64_56", 64, 56, 64, 3, 1, 1},
+      // MobileNet pointwise.
+      {"1x1_c128_oc256_28", 128, 28, 256, 1, 1, 1},
+      // MobileNet depthwise.
+      {"dw3x3_c128_28", 128, 28, 128, 3, 1, 128},
+  };
+  return layers;
+}
+
+void BM_QuantizedConv2d(
+    benchmark::State& state,
+    const ConvLayer& layer,
+    bool channels_last) {
+  TensorFactory<ScalarType::Char> tf_int8;
+  TensorFactory<ScalarType::Int> tf_int32;
+  const int32_t icpg = layer.c / layer.groups;
+  const int32_t padding = layer.k / 2;
+  const int32_t out_hw =
+      (layer.hw + 2 * padding - layer.k) / static_cast<int32_t>(layer.stride) +
+      1;
+  const auto in_values =
+      random_int8(static_cast<size_t>(layer.c) * layer.hw * layer.hw, 0);
+  const auto weight_values =
+      random_int8(static_cast<size_t>(layer.oc) * icpg * layer.k * layer.k, 1);
+  Tensor in = channels_last
+      ? tf_int8.make({1, layer.hw, layer.hw, layer.c}, in_values)
+      : tf_int8.make({1, layer.c, layer.hw, layer.hw}, in_values);
+  Tensor weight = channels_last
+      ? tf_int8.make({layer.oc, layer.k, layer.k, icpg}, weight_values)
+      : tf_int8.make({layer.oc, icpg, layer.k, layer.k}, weight_values);
+  Tensor bias = tf_int32.full({layer.oc}, 1000);
+  Tensor out = channels_last ? tf_int8.zeros({1, out_hw, out_hw, layer.oc})
+                             : tf_int8.zeros({1, layer.oc, out_hw, out_hw});
+  const int64_t stride[2] = {layer.stride, layer.stride};
+  const int64_t pad[2] = {padding, padding};
+  const int64_t dilation[2] = {1, 1};
+  KernelRuntimeContext ctx;
+  const auto op = channels_last
+      ? impl::generic::native::quantized_conv2d_nhwc_per_tensor_out
+      : impl::generic::native::quantized_conv2d_nchw_per_tensor_out;
+  for (auto _ : state) {
+    op(ctx,
+       in,
+       weight,
+       bias,
+       {stride, 2},
+       {pad, 2},
+       {dilation, 2},
+       layer.groups,
+       /*in_zero_point=*/-2,
+       /*weight_zero_point=*/0,
+       /*bias_scale=*/0.0004,
+       /*output_scale=*/0.5,
+       /*output_zero_point=*/1,
+       /*out_multiplier=*/0,
+       /*out_shift=*/0,
+       out);
+    benchmark::DoNotOptimize(out.const_data_ptr());
+  }
+  state.SetItemsProcessed(
+      state.iterations() * out.numel() * icpg * layer.k * layer.k);
+}
+
+void BM_QuantizedLinear(benchmark::State& state) {
+  const int32_t m = static_cast<int32_t>(state.range(0));
+  const int32_t n = static_cast<int32_t>(state.range(1));
+  const int32_t k = static_cast<int32_t>(state.range(2));
+  TensorFactory<ScalarType::Char> tf_int8;
+  TensorFactory<ScalarType::Int> tf_int32;
+  Tensor in = tf_int8.make({m, k}, random_int8(static_cast<size_t>(m) * k, 2));
+  Tensor weight =
+      tf_int8.make({n, k}, random_int8(static_cast<size_t>(n) * k, 3));
+  Tensor bias = tf_int32.full({n}, 1000);
+  Tensor out = tf_int8.zeros({m, n});
+  KernelRuntimeContext ctx;
+  for (auto _ : state) {
+    impl::generic::native::quantized_linear_per_tensor_out(
+        ctx,
+        in,
+        weight,
+        bias,
+        /*src_zero_point=*/-2,
+        /*weight_zero_point=*/0,
+        /*out_multiplier=*/-(1 << 30),
+        /*out_shift=*/-10,
+        /*out_zero_point=*/1,
+        {},
+        out);
+    benchmark::DoNotOptimize(out.const_data_ptr());
+  }
+  state.SetItemsProcessed(state.iterations() * m * n * k);
+}
+
+// Decode (one token) and prefill (128 tokens) through the projections of a
+// transformer with model dimension 1024.
+BENCHMARK(BM_QuantizedLinear)
+    ->Args({1, 1024, 1024})
+    ->Args({1, 4096, 1024})
+    ->Args({128, 1024, 1024})
+    ->Args({128, 1024, 4096});
+
+const bool registered = [] {
+  executorch::runtime::runtime_init();
+  for (const auto& layer : conv_layers()) {
+    for (const bool channels_last : {false, true}) {
+      const std::string name = std::string("BM_QuantizedConv2d/") +
+          layer.name + (channels_last ? "/nhwc" : "/nchw");
+      benchmark::RegisterBenchmark(
+          name.c_str(), [&layer, channels_last](benchmark::State& state) {
+            BM_QuantizedConv2d(state, layer, channels_last);
+          });
+    }
+  }
+  return true;
+}();
+
+} // namespace
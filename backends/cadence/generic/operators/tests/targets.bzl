@@ -0,0 +1,39 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
+
+def define_common_targets():
+    """Defines targets that should be shared between fbcode and xplat.
+
+    The directory containing this targets.bzl file should also contain both
+    TARGETS and BUCK files that call this function.
+    """
+
+    runtime.cxx_test(
+        name = "test_op_quantized_conv2d",
+        srcs = ["test_op_quantized_conv2d.cpp"],
+        deps = [
+            "//executorch/backends/cadence/generic/operators:op_quantized_conv2d",
+            "//executorch/kernels/test:gtest_utils",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "test_op_quantized_linear",
+        srcs = ["test_op_quantized_linear.cpp"],
+        deps = [
+            "//executorch/backends/cadence/generic/operators:op_quantized_linear",
+            "//executorch/kernels/test:gtest_utils",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "quantized_conv_linear_benchmark",
+        srcs = ["quantized_conv_linear_benchmark.cpp"],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/backends/cadence/generic/operators:op_quantized_conv2d",
+            "//executorch/backends/cadence/generic/operators:op_quantized_linear",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+        ],
+    )
@@ -0,0 +1,436 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Checks that the quantized convolutions are bit-exact with the scalar
+// reference loops, which accumulate in float from the bias, in the order of
+// the im2row columns.
+
+#include <executorch/backends/cadence/generic/operators/op_quantized_conv2d.h>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <executorch/backends/cadence/generic/kernels/kernels.h>
+#include <executorch/kernels/test/TestUtil.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <gtest/gtest.h>
+
+namespace impl {
+namespace generic {
+namespace native {
+namespace {
+
+using ::executorch::aten::ScalarType;
+using ::executorch::aten::Tensor;
+using ::executorch::runtime::testing::TensorFactory;
+
+struct ConvParams {
+  int32_t n;
+  int32_t c;
+  int32_t h;
+  int32_t w;
+  int32_t oc;
+  int32_t kh;
+  int32_t kw;
+  int64_t stride[2];
+  int64_t padding[2];
+  int64_t dilation[2];
+  int32_t groups;
+
+  int32_t oh() const {
+    return (h + 2 * padding[0] - dilation[0] * (kh - 1) - 1) / stride[0] + 1;
+  }
+  int32_t ow() const {
+    return (w + 2 * padding[1] - dilation[1] * (kw - 1) - 1) / stride[1] + 1;
+  }
+};
+
+struct QuantParams {
+  int32_t in_zero_point;
+  int32_t weight_zero_point;
+  float bias_scale;
+  float output_scale;
+  int32_t output_zero_point;
+};
+
+template <typename T>
+std::vector<T> random_values(size_t size, int32_t lo, int32_t hi, int seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int32_t> dist(lo, hi);
+  std::vector<T> values(size);
+  for (auto& value : values) {
+    value = static_cast<T>(dist(gen));
+  }
+  return values;
+}
+
+enum class Layout {
+  kNchw,
+  kNhwc,
+  // NHWC input with [kh, kw, oc] weights.
+  kNhwcDepthwise,
+};
+
+// The reference loops, in plain form.
+template <typename IT, typename WT, typename OT>
+std::vector<OT> reference_conv2d(
+    const ConvParams& p,
+    const QuantParams& q,
+    Layout layout,
+    const std::vector<IT>& in,
+    const std::vector<WT>& weight,
+    const std::vector<int32_t>& bias) {
+  const int32_t oh = p.oh();
+  const int32_t ow = p.ow();
+  const int32_t icpg = p.c / p.groups;
+  const int32_t ocpg = p.oc / p.groups;
+  const bool channels_last = layout != Layout::kNchw;
+  const float inv_out_scale = 1.f / q.output_scale;
+  std::vector<OT> out(static_cast<size_t>(p.n) * p.oc * oh * ow);
+  const auto in_at = [&](int32_t n, int32_t c, int32_t ih, int32_t iw) {
+    return channels_last ? in[((n * p.h + ih) * p.w + iw) * p.c + c]
+                         : in[((n * p.c + c) * p.h + ih) * p.w + iw];
+  };
+  const auto weight_at = [&](int32_t o, int32_t ic, int32_t kh, int32_t kw) {
+    switch (layout) {
+      case Layout::kNchw:
+        return weight[((o * icpg + ic) * p.kh + kh) * p.kw + kw];
+      case Layout::kNhwc:
+        return weight[((o * p.kh + kh) * p.kw + kw) * icpg + ic];
+      case Layout::kNhwcDepthwise:
+        return weight[(kh * p.kw + kw) * p.oc + o];
+    }
+    return WT(0);
+  };
+  for (int32_t n = 0; n < p.n; ++n) {
+    for (int32_t o = 0; o < p.oc; ++o) {
+      const int32_t sic = (o / ocpg) * icpg;
+      for (int32_t y = 0; y < oh; ++y) {
+        for (int32_t x = 0; x < ow; ++x) {
+          float acc = bias[o];
+          const auto accumulate = [&](int32_t ic, int32_t kh, int32_t kw) {
+            const int32_t ih =
+                y * p.stride[0] + kh * p.dilation[0] - p.padding[0];
+            const int32_t iw =
+                x * p.stride[1] + kw * p.dilation[1] - p.padding[1];
+            if (ih >= 0 && ih < p.h && iw >= 0 && iw < p.w) {
+              float lhs = in_at(n, sic + ic, ih, iw) - q.in_zero_point;
+              float rhs = weight_at(o, ic, kh, kw) - q.weight_zero_point;
+              acc += lhs * rhs;
+            }
+          };
+          if (channels_last) {
+            for (int32_t kh = 0; kh < p.kh; ++kh) {
+              for (int32_t kw = 0; kw < p.kw; ++kw) {
+                for (int32_t ic = 0; ic < icpg; ++ic) {
+                  accumulate(ic, kh, kw);
+                }
+              }
+            }
+          } else {
+            for (int32_t ic = 0; ic < icpg; ++ic) {
+              for (int32_t kh = 0; kh < p.kh; ++kh) {
+                for (int32_t kw = 0; kw < p.kw; ++kw) {
+                  accumulate(ic, kh, kw);
+                }
+              }
+            }
+          }
+          float val = q.bias_scale * acc;
+          const size_t out_idx = channels_last
+              ? ((static_cast<size_t>(n) * oh + y) * ow + x) * p.oc + o
+              : ((static_cast<size_t>(n) * p.oc + o) * oh + y) * ow + x;
+          out[out_idx] = ::impl::generic::kernels::quantize<OT>(
+              val, inv_out_scale, q.output_zero_point);
+        }
+      }
+    }
+  }
+  return out;
+}
+
+using ConvOp = decltype(&quantized_conv2d_nchw_per_tensor_out);
+
+class GenericQuantizedConv2dTest : public OperatorTest {
+ protected:
+  // Same, on random data.
+  template <ScalarType kIn, ScalarType kWeight>
+  void expect_matches_reference(
+      const ConvParams& p,
+      const QuantParams& q,
+      Layout layout,
+      int32_t weight_lo,
+      int32_t weight_hi,
+      int32_t bias_magnitude,
+      int seed,
+      ConvOp op = nullptr) {
+    using IT = typename TensorFactory<kIn>::ctype;
+    using WT = typename TensorFactory<kWeight>::ctype;
+    const int32_t icpg = p.c / p.groups;
+    expect_matches_reference<kIn, kWeight>(
+        p,
+        q,
+        layout,
+        random_values<IT>(
+            static_cast<size_t>(p.n) * p.c * p.h * p.w,
+            std::numeric_limits<IT>::min(),
+            std::numeric_limits<IT>::max(),
+            seed),
+        random_values<WT>(
+            static_cast<size_t>(p.oc) * icpg * p.kh * p.kw,
+            weight_lo,
+            weight_hi,
+            seed + 1),
+        random_values<int32_t>(
+            p.oc, -bias_magnitude, bias_magnitude, seed + 2),
+        op);
+  }
+
+  // Runs `op`, or the per-tensor operator for the layout, on the given data
+  // and compares the output with reference_conv2d().
+  template <ScalarType kIn, ScalarType kWeight>
+  void expect_matches_reference(
+      const ConvParams& p,
+      const QuantParams& q,
+      Layout layout,
+      const std::vector<typename TensorFactory<kIn>::ctype>& in_values,
+      const std::vector<typename TensorFactory<kWeight>::ctype>& weight_values,
+      const std::vector<int32_t>& bias_values,
+      ConvOp op = nullptr) {
+    using IT = typename TensorFactory<kIn>::ctype;
+    using WT = typename TensorFactory<kWeight>::ctype;
+    TensorFactory<kIn> tf_in;
+    TensorFactory<kWeight> tf_weight;
+    TensorFactory<ScalarType::Int> tf_int;
+
+    const int32_t icpg = p.c / p.groups;
+    const int32_t oh = p.oh();
+    const int32_t ow = p.ow();
+    const bool channels_last = layout != Layout::kNchw;
+    std::vector<int32_t> in_sizes = channels_last
+        ? std::vector<int32_t>{p.n, p.h, p.w, p.c}
+        : std::vector<int32_t>{p.n, p.c, p.h, p.w};
+    std::vector<int32_t> weight_sizes;
+    switch (layout) {
+      case Layout::kNchw:
+        weight_sizes = {p.oc, icpg, p.kh, p.kw};
+        break;
+      case Layout::kNhwc:
+        weight_sizes = {p.oc, p.kh, p.kw, icpg};
+        break;
+      case Layout::kNhwcDepthwise:
+        weight_sizes = {p.kh, p.kw, p.oc};
+        break;
+    }
+    std::vector<int32_t> out_sizes = channels_last
+        ? std::vector<int32_t>{p.n, oh, ow, p.oc}
+        : std::vector<int32_t>{p.n, p.oc, oh, ow};
+
+    Tensor in = tf_in.make(in_sizes, in_values);
+    Tensor weight = tf_weight.make(weight_sizes, weight_values);
+    Tensor bias = tf_int.make({p.oc}, bias_values);
+    Tensor out = tf_in.zeros(out_sizes);
+
+    if (op == nullptr) {
+      op = channels_last ? quantized_conv2d_nhwc_per_tensor_out
+                         : quantized_conv2d_nchw_per_tensor_out;
+    }
+    op(context_,
+        in,
+        weight,
+        bias,
+        {p.stride, 2},
+        {p.padding, 2},
+        {p.dilation, 2},
+        p.groups,
+        q.in_zero_point,
+        q.weight_zero_point,
+        q.bias_scale,
+        q.output_scale,
+        q.output_zero_point,
+        /*out_multiplier=*/0,
+        /*out_shift=*/0,
+        out);
+
+    const auto expected = reference_conv2d<IT, WT, IT>(
+        p, q, layout, in_values, weight_values, bias_values);
+    ASSERT_EQ(out.numel(), expected.size());
+    const IT* actual = out.const_data_ptr<IT>();
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(actual[i], expected[i]) << "at output " << i;
+    }
+  }
+};
+
+const std::vector<ConvParams>& conv_params() {
+  static const std::vector<ConvParams> params = {
+      // Pointwise.
+      {1, 16, 8, 8, 8, 1, 1, {1, 1}, {0, 0}, {1, 1}, 1},
+      // 3x3 with padding, more output channels than a block.
+      {2, 8, 9, 7, 13, 3, 3, {1, 1}, {1, 1}, {1, 1}, 1},
+      // Strided and dilated.
+      {1, 4, 15, 12, 6, 3, 3, {2, 2}, {2, 1}, {2, 2}, 1},
+      // Grouped.
+      {1, 8, 6, 6, 12, 3, 3, {1, 1}, {1, 1}, {1, 1}, 2},
+      // Depthwise with a channel multiplier.
+      {1, 6, 10, 10, 12, 5, 5, {1, 1}, {2, 2}, {1, 1}, 6},
+      // Depthwise 3x3, too shallow for the GEMM path.
+      {1, 6, 10, 10, 6, 3, 3, {1, 1}, {1, 1}, {1, 1}, 6},
+      // 1D-like, with more pixels than a tile.
+      {1, 4, 1, 200, 5, 1, 5, {1, 1}, {0, 2}, {1, 1}, 1},
+  };
+  return params;
+}
+
+constexpr QuantParams kUint8Quant = {128, 120, 0.0123f, 0.71f, 131};
+constexpr QuantParams kInt8Quant = {-3, 2, 0.0087f, 0.45f, -7};
+
+TEST_F(GenericQuantizedConv2dTest, NchwUint8MatchesReference) {
+  int seed = 0;
+  for (const auto& p : conv_params()) {
+    expect_matches_reference<ScalarType::Byte, ScalarType::Byte>(
+        p, kUint8Quant, Layout::kNchw, 0, 255, 1 << 12, seed += 3);
+  }
+}
+
+TEST_F(GenericQuantizedConv2dTest, NchwInt8MatchesReference) {
+  int seed = 100;
+  for (const auto& p : conv_params()) {
+    expect_matches_reference<ScalarType::Char, ScalarType::Char>(
+        p, kInt8Quant, Layout::kNchw, -128, 127, 1 << 12, seed += 3);
+  }
+}
+
+TEST_F(GenericQuantizedConv2dTest, NhwcMatchesReference) {
+  int seed = 200;
+  for (const auto& p : conv_params()) {
+    expect_matches_reference<ScalarType::Byte, ScalarType::Byte>(
+        p, kUint8Quant, Layout::kNhwc, 0, 255, 1 << 12, seed += 3);
+    expect_matches_reference<ScalarType::Char, ScalarType::Char>(
+        p, kInt8Quant, Layout::kNhwc, -128, 127, 1 << 12, seed += 3);
+  }
+}
+
+TEST_F(GenericQuantizedConv2dTest, NhwcDepthwiseMatchesReference) {
+  const ConvParams p = {2, 16, 9, 9, 16, 5, 5, {2, 1}, {2, 2}, {1, 2}, 16};
+  expect_matches_reference<ScalarType::Byte, ScalarType::Byte>(
+      p, kUint8Quant, Layout::kNhwcDepthwise, 0, 255, 1 << 12, 300);
+  expect_matches_reference<ScalarType::Char, ScalarType::Char>(
+      p, kInt8Quant, Layout::kNhwcDepthwise, -128, 127, 1 << 12, 301);
+  expect_matches_reference<ScalarType::Byte, ScalarType::Byte>(
+      p,
+      kUint8Quant,
+      Layout::kNhwcDepthwise,
+      0,
+      255,
+      1 << 12,
+      302,
+      quantized_conv2d_nhwc_depthwise_asym8uxsym8u_asym8u_per_tensor_out);
+  expect_matches_reference<ScalarType::Char, ScalarType::Char>(
+      p,
+      kInt8Quant,
+      Layout::kNhwcDepthwise,
+      -128,
+      127,
+      1 << 12,
+      303,
+      quantized_conv2d_nhwc_depthwise_asym8sxsym8s_asym8s_per_tensor_out);
+}
+
+TEST_F(GenericQuantizedConv2dTest, W8A16MatchesReference) {
+  constexpr QuantParams kW8A16Quant = {-21, 1, 0.00031f, 0.9f, 17};
+  int seed = 400;
+  for (const auto& p : conv_params()) {
+    expect_matches_reference<ScalarType::Short, ScalarType::Char>(
+        p, kW8A16Quant, Layout::kNchw, -128, 127, 1 << 20, seed += 3);
+    expect_matches_reference<ScalarType::Short, ScalarType::Char>(
+        p, kW8A16Quant, Layout::kNhwc, -128, 127, 1 << 20, seed += 3);
+  }
+}
+
+// Deep reductions with full-range weights have partial sums beyond 2^24,
+// where the float accumulation of the reference rounds; small weights keep
+// them exact. Both have to match.
+TEST_F(GenericQuantizedConv2dTest, DeepReductionsMatchReference) {
+  const ConvParams p = {1, 256, 6, 6, 9, 3, 3, {1, 1}, {1, 1}, {1, 1}, 1};
+  for (const Layout layout : {Layout::kNchw, Layout::kNhwc}) {
+    expect_matches_reference<ScalarType::Byte, ScalarType::Byte>(
+        p, kUint8Quant, layout, 0, 255, 1 << 12, 500);
+    expect_matches_reference<ScalarType::Byte, ScalarType::Byte>(
+        p, kUint8Quant, layout, 118, 122, 1 << 12, 501);
+    expect_matches_reference<ScalarType::Char, ScalarType::Char>(
+        p, kInt8Quant, layout, -128, 127, 1 << 24, 502);
+  }
+}
+
+// Large int16 inputs and weights of the same sign over 2048 channels have
+// products that are exact in float, but sums beyond the range of int32, which
+// must not be computed in int32 at all.
+TEST_F(GenericQuantizedConv2dTest, WideReductionsMatchReference) {
+  constexpr QuantParams kQuant = {-21, 1, 0.00031f, 0.9f, 17};
+  const ConvParams p = {1, 2048, 2, 2, 5, 1, 1, {1, 1}, {0, 0}, {1, 1}, 1};
+  const auto in_values =
+      random_values<int16_t>(p.c * p.h * p.w, 20000, 32767, 800);
+  const auto weight_values = random_values<int8_t>(p.oc * p.c, 100, 127, 801);
+  const auto bias_values = random_values<int32_t>(p.oc, -1000, 1000, 802);
+  for (const Layout layout : {Layout::kNchw, Layout::kNhwc}) {
+    expect_matches_reference<ScalarType::Short, ScalarType::Char>(
+        p, kQuant, layout, in_values, weight_values, bias_values);
+  }
+}
+
+// Accumulates a sum that grows well beyond 2^24 and then cancels out, so the
+// output is made of the rounding errors of the float accumulation.
+TEST_F(GenericQuantizedConv2dTest, CancellingReductionsMatchReference) {
+  const ConvParams p = {1, 4096, 2, 3, 4, 1, 1, {1, 1}, {0, 0}, {1, 1}, 1};
+  constexpr QuantParams kQuant = {0, 0, 1.f, 1.f, 0};
+  const int32_t half = p.c / 2;
+  const int32_t pixels = p.h * p.w;
+  auto in_values = random_values<int8_t>(p.c * pixels, 100, 127, 700);
+  auto weight_values = random_values<int8_t>(p.oc * p.c, 100, 127, 701);
+  for (int32_t ic = half; ic < p.c; ++ic) {
+    for (int32_t pix = 0; pix < pixels; ++pix) {
+      // NCHW and NHWC.
+      in_values[ic * pixels + pix] = in_values[(ic - half) * pixels + pix];
+    }
+    for (int32_t o = 0; o < p.oc; ++o) {
+      weight_values[o * p.c + ic] = -weight_values[o * p.c + ic - half];
+    }
+  }
+  std::vector<int8_t> in_nhwc(in_values.size());
+  for (int32_t ic = 0; ic < p.c; ++ic) {
+    for (int32_t pix = 0; pix < pixels; ++pix) {
+      in_nhwc[pix * p.c + ic] = in_values[ic * pixels + pix];
+    }
+  }
+  const std::vector<int32_t> bias(p.oc, 0);
+  expect_matches_reference<ScalarType::Char, ScalarType::Char>(
+      p, kQuant, Layout::kNchw, in_values, weight_values, bias);
+  expect_matches_reference<ScalarType::Char, ScalarType::Char>(
+      p, kQuant, Layout::kNhwc, in_nhwc, weight_values, bias);
+}
+
+// Small int16 weights keep the products exact in float; full-range ones do
+// not, and run on the reference loops.
+TEST_F(GenericQuantizedConv2dTest, Int16MatchesReference) {
+  constexpr QuantParams kInt16Quant = {5, -3, 0.0002f, 1.3f, 11};
+  const ConvParams p = {1, 4, 5, 5, 3, 3, 3, {1, 1}, {1, 1}, {1, 1}, 1};
+  for (const Layout layout : {Layout::kNchw, Layout::kNhwc}) {
+    expect_matches_reference<ScalarType::Short, ScalarType::Short>(
+        p, kInt16Quant, layout, -8, 8, 1 << 12, 600);
+    expect_matches_reference<ScalarType::Short, ScalarType::Short>(
+        p, kInt16Quant, layout, -32768, 32767, 1 << 12, 601);
+  }
+}
+
+} // namespace
+} // namespace native
+} // namespace generic
+} // namespace impl
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Checks that the quantized linear operators are bit-exact with the scalar
+// reference loops, which accumulate in int32 from the bias.
+
+#include <executorch/backends/cadence/generic/operators/op_quantized_linear.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <executorch/backends/cadence/generic/kernels/kernels.h>
+#include <executorch/kernels/test/TestUtil.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <gtest/gtest.h>
+
+namespace impl {
+namespace generic {
+namespace native {
+namespace {
+
+using ::executorch::aten::ScalarType;
+using ::executorch::aten::Tensor;
+using ::executorch::runtime::testing::TensorFactory;
+
+template <typename T>
+std::vector<T> random_values(size_t size, int32_t lo, int32_t hi, int seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int32_t> dist(lo, hi);
+  std::vector<T> values(size);
+  for (auto& value : values) {
+    value = static_cast<T>(dist(gen));
+  }
+  return values;
+}
+
+// The reference loops, in plain form. `out_multiplier` and `out_shift` hold
+// either one value or one per output channel.
+template <typename IT, typename WT>
+std::vector<IT> reference_linear(
+    int32_t m,
+    int32_t n,
+    int32_t k,
+    const std::vector<IT>& in,
+    const std::vector<WT>& weight,
+    const std::vector<int32_t>& bias,
+    int32_t in_zero_point,
+    int32_t weight_zero_point,
+    const std::vector<int32_t>& out_multiplier,
+    const std::vector<int32_t>& out_shift,
+    int32_t out_zero_point) {
+  std::vector<IT> out(static_cast<size_t>(m) * n);
+  for (int32_t i = 0; i < m; ++i) {
+    for (int32_t j = 0; j < n; ++j) {
+      int32_t sum = bias[j];
+      for (int32_t kk = 0; kk < k; ++kk) {
+        sum += (static_cast<int32_t>(in[i * k + kk]) - in_zero_point) *
+            (static_cast<int32_t>(weight[j * k + kk]) - weight_zero_point);
+      }
+      const size_t q = out_multiplier.size() == 1 ? 0 : j;
+      const float out_scale =
+          -out_multiplier[q] * 1.0 / (1 << 31) * pow(2, out_shift[q]);
+      out[i * n + j] = ::impl::generic::kernels::quantize<IT>(
+          sum, out_scale, out_zero_point);
+    }
+  }
+  return out;
+}
+
+struct LinearShape {
+  int32_t m;
+  int32_t n;
+  int32_t k;
+};
+
+const std::vector<LinearShape>& linear_shapes() {
+  static const std::vector<LinearShape> shapes = {
+      {1, 1, 1},
+      {1, 64, 256},
+      {7, 9, 17},
+      {65, 4, 33},
+      {130, 13, 64},
+  };
+  return shapes;
+}
+
+class GenericQuantizedLinearTest : public OperatorTest {
+ protected:
+  template <ScalarType kIn, ScalarType kWeight>
+  void expect_matches_reference(
+      const LinearShape& shape,
+      bool per_channel,
+      int32_t in_zero_point,
+      int32_t weight_zero_point,
+      int32_t out_zero_point,
+      int seed) {
+    using IT = typename TensorFactory<kIn>::ctype;
+    using WT = typename TensorFactory<kWeight>::ctype;
+    TensorFactory<kIn> tf_in;
+    TensorFactory<kWeight> tf_weight;
+    TensorFactory<ScalarType::Int> tf_int;
+
+    const auto in_values = random_values<IT>(
+        static_cast<size_t>(shape.m) * shape.k,
+        std::numeric_limits<IT>::min(),
+        std::numeric_limits<IT>::max(),
+        seed);
+    const auto weight_values = random_values<WT>(
+        static_cast<size_t>(shape.n) * shape.k,
+        std::numeric_limits<WT>::min(),
+        std::numeric_limits<WT>::max(),
+        seed + 1);
+    const auto bias_values =
+        random_values<int32_t>(shape.n, -(1 << 16), 1 << 16, seed + 2);
+    const auto multipliers = random_values<int32_t>(
+        per_channel ? shape.n : 1, -(1 << 30), -(1 << 28), seed + 3);
+    const auto shifts =
+        random_values<int32_t>(per_channel ? shape.n : 1, -14, -8, seed + 4);
+
+    Tensor in = tf_in.make({shape.m, shape.k}, in_values);
+    Tensor weight = tf_weight.make({shape.n, shape.k}, weight_values);
+    Tensor bias = tf_int.make({shape.n}, bias_values);
+    Tensor out = tf_in.zeros({shape.m, shape.n});
+    if (per_channel) {
+      quantized_linear_out(
+          context_,
+          in,
+          weight,
+          bias,
+          in_zero_point,
+          tf_int.make({1}, {weight_zero_point}),
+          tf_int.make({shape.n}, multipliers),
+          tf_int.make({shape.n}, shifts),
+          out_zero_point,
+          {},
+          out);
+    } else {
+      quantized_linear_per_tensor_out(
+          context_,
+          in,
+          weight,
+          bias,
+          in_zero_point,
+          weight_zero_point,
+          multipliers[0],
+          shifts[0],
+          out_zero_point,
+          {},
+          out);
+    }
+
+    const auto expected = reference_linear<IT, WT>(
+        shape.m,
+        shape.n,
+        shape.k,
+        in_values,
+        weight_values,
+        bias_values,
+        in_zero_point,
+        weight_zero_point,
+        multipliers,
+        shifts,
+        out_zero_point);
+    ASSERT_EQ(out.numel(), expected.size());
+    const IT* actual = out.const_data_ptr<IT>();
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(actual[i], expected[i]) << "at output " << i;
+    }
+  }
+};
+
+TEST_F(GenericQuantizedLinearTest, PerTensorMatchesReference) {
+  int seed = 0;
+  for (const auto& shape : linear_shapes()) {
+    expect_matches_reference<ScalarType::Byte, ScalarType::Byte>(
+        shape, /*per_channel=*/false, 128, 127, 130, seed += 5);
+    expect_matches_reference<ScalarType::Char, ScalarType::Char>(
+        shape, /*per_channel=*/false, -4, 0, 3, seed += 5);
+  }
+}
+
+TEST_F(GenericQuantizedLinearTest, PerChannelMatchesReference) {
+  int seed = 100;
+  for (const auto& shape : linear_shapes()) {
+    expect_matches_reference<ScalarType::Byte, ScalarType::Byte>(
+        shape, /*per_channel=*/true, 121, 128, 125, seed += 5);
+    expect_matches_reference<ScalarType::Char, ScalarType::Char>(
+        shape, /*per_channel=*/true, 7, -1, -2, seed += 5);
+  }
+}
+
+TEST_F(GenericQuantizedLinearTest, W8A16MatchesReference) {
+  int seed = 200;
+  for (const auto& shape : linear_shapes()) {
+    expect_matches_reference<ScalarType::Short, ScalarType::Char>(
+        shape, /*per_channel=*/false, -11, 0, 9, seed += 5);
+    expect_matches_reference<ScalarType::Short, ScalarType::Char>(
+        shape, /*per_channel=*/true, 13, 0, -6, seed += 5);
+  }
+}
+
+} // namespace
+} // namespace native
+} // namespace generic
+} // namespace impl
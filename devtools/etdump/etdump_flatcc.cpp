@@ -9,6 +9,7 @@
 #include <executorch/devtools/etdump/etdump_flatcc.h>
 
 #include <cstring>
+#include <new>
 
 #include <executorch/devtools/etdump/data_sinks/buffer_data_sink.h>
 #include <executorch/devtools/etdump/emitter.h>
@@ -19,7 +20,9 @@
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
 #include <executorch/runtime/platform/assert.h>
+#include <executorch/runtime/platform/log.h>
 
+#include <flatcc/flatcc_builder.h>
 #include <flatcc/flatcc_types.h>
 
 using ::executorch::aten::Tensor;
@@ -42,6 +45,18 @@ namespace executorch {
 namespace etdump {
 namespace {
 
+// Header written once at the start of an ETDump stream: magic + version.
+constexpr char kStreamMagic[4] = {'E', 'T', 'D', 'S'};
+constexpr uint32_t kStreamVersion = 0;
+// Header of every frame in an ETDump stream: magic + payload length. Frames
+// are padded to kStreamFrameAlignment bytes.
+constexpr char kStreamFrameMagic[4] = {'E', 'T', 'D', 'B'};
+constexpr size_t kStreamFrameAlignment = 8;
+
+// Distinguishes event buffers installed through set_event_buffer() so that a
+// thread never reuses a ring cached for a buffer that has been replaced.
+std::atomic<uint32_t> event_buffer_generation{0};
+
 Result<executorch_flatbuffer_ScalarType_enum_t> get_flatbuffer_scalar_type(
     executorch::aten::ScalarType tensor_scalar_type) {
   switch (tensor_scalar_type) {
@@ -147,12 +162,26 @@ ETDumpGen::~ETDumpGen() {
   if (!is_static_etdump()) {
     free(builder_);
   }
+  for (size_t i = 0; i < num_retained_; ++i) {
+    free(retained_[(retained_head_ + i) % stream_config_.retained_blocks].buf);
+  }
+  free(retained_);
+  free(stream_chunk_);
 }
 
 void ETDumpGen::reset() {
-  state_ = State::Init;
   num_blocks_ = 0;
   data_sink_ = nullptr;
+  // Discard buffered events that were logged before the reset.
+  for (size_t i = 0; i < num_event_rings_; ++i) {
+    event_rings_[i].drain([](const internal::BufferedProfileEvent&) {});
+  }
+  reset_builder();
+}
+
+void ETDumpGen::reset_builder() {
+  state_ = State::Init;
+  buffered_blocks_ = 0;
   flatcc_builder_reset(builder_);
   flatbuffers_buffer_start(builder_, etdump_ETDump_file_identifier);
   etdump_ETDump_start_as_root_with_size(builder_);
@@ -162,16 +191,30 @@ void ETDumpGen::reset() {
 }
 
 void ETDumpGen::create_event_block(const char* name) {
+  if (stream_sink_ != nullptr && buffered_blocks_ > 0) {
+    // The previous block is complete, hand it off to the stream so that the
+    // builder only ever holds a single block.
+    Error err = emit_stream_block();
+    if (err != Error::Ok) {
+      ET_LOG(
+          Error,
+          "Failed to stream ETDump block, error 0x%" PRIx32,
+          static_cast<uint32_t>(err));
+    }
+  } else if (buffered_blocks_ > 0 && state_ != State::Done) {
+    drain_event_buffer();
+  }
   if (state_ == State::AddingEvents) {
     etdump_RunData_events_end(builder_);
   } else if (state_ == State::Done) {
     reset();
   }
-  if (num_blocks_ > 0) {
+  if (buffered_blocks_ > 0) {
     etdump_ETDump_run_data_push_end(builder_);
     etdump_ETDump_run_data_push_start(builder_);
   }
   ++num_blocks_;
+  ++buffered_blocks_;
   etdump_RunData_name_create_strn(builder_, name, strlen(name));
   if (bundled_input_index_ != -1) {
     etdump_RunData_bundled_input_index_add(builder_, bundled_input_index_);
@@ -214,7 +257,13 @@ EventTracerEntry ETDumpGen::start_profiling(
     ChainID chain_id,
     DebugHandle debug_handle) {
   EventTracerEntry prof_entry;
-  prof_entry.event_id = name != nullptr ? create_string_entry(name) : -1;
+  if (event_rings_ != nullptr) {
+    // The name is only copied into the event buffer by end_profiling(), which
+    // keeps flatbuffer building out of the profiled region.
+    prof_entry.event_id = reinterpret_cast<intptr_t>(name);
+  } else {
+    prof_entry.event_id = name != nullptr ? create_string_entry(name) : -1;
+  }
   prof_entry.delegate_event_id_type = DelegateDebugIdType::kNone;
 
   if (chain_id == -1) {
@@ -224,6 +273,9 @@ EventTracerEntry ETDumpGen::start_profiling(
     prof_entry.chain_id = chain_id;
     prof_entry.debug_handle = debug_handle;
   }
+  if (event_rings_ == nullptr) {
+    start_perf_counters();
+  }
   prof_entry.start_time = runtime::pal_current_ticks();
   return prof_entry;
 }
@@ -246,6 +298,7 @@ EventTracerEntry ETDumpGen::start_profiling_delegate(
   prof_entry.event_id = delegate_debug_index == kUnsetDelegateDebugIntId
       ? create_string_entry(name)
       : delegate_debug_index;
+  start_perf_counters();
   prof_entry.start_time = runtime::pal_current_ticks();
   return prof_entry;
 }
@@ -255,6 +308,8 @@ void ETDumpGen::end_profiling_delegate(
     const void* metadata,
     size_t metadata_len) {
   et_timestamp_t end_time = runtime::pal_current_ticks();
+  internal::PerfCounterValues perf_counters;
+  bool has_perf_counters = end_perf_counters(&perf_counters);
   check_ready_to_add_events();
 
   // Start building the ProfileEvent entry.
@@ -277,6 +332,9 @@ void ETDumpGen::end_profiling_delegate(
   flatbuffers_uint8_vec_ref_t vec_ref = flatbuffers_uint8_vec_create_pe(
       builder_, (const uint8_t*)metadata, metadata_len);
   etdump_ProfileEvent_delegate_debug_metadata_add(builder_, vec_ref);
+  if (has_perf_counters) {
+    add_perf_counters(perf_counters);
+  }
   etdump_ProfileEvent_ref_t id = etdump_ProfileEvent_end(builder_);
   etdump_RunData_events_push_start(builder_);
   etdump_Event_profile_event_add(builder_, id);
@@ -473,15 +531,49 @@ void ETDumpGen::end_profiling(EventTracerEntry prof_entry) {
   ET_CHECK_MSG(
       prof_entry.delegate_event_id_type == DelegateDebugIdType::kNone,
       "Delegate events must use end_profiling_delegate to mark the end of a delegate profiling event.");
+  if (event_rings_ != nullptr) {
+    internal::ProfileEventRing* ring = get_producer_ring();
+    if (ring == nullptr) {
+      num_unbuffered_events_dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    ring->push(
+        reinterpret_cast<const char*>(prof_entry.event_id),
+        prof_entry.chain_id,
+        prof_entry.debug_handle,
+        prof_entry.start_time,
+        end_time);
+    return;
+  }
+  internal::PerfCounterValues perf_counters;
+  bool has_perf_counters = end_perf_counters(&perf_counters);
   check_ready_to_add_events();
+  add_profile_event(
+      prof_entry.event_id,
+      prof_entry.chain_id,
+      prof_entry.debug_handle,
+      prof_entry.start_time,
+      end_time,
+      has_perf_counters ? &perf_counters : nullptr);
+}
 
+void ETDumpGen::add_profile_event(
+    int64_t name_id,
+    ChainID chain_id,
+    DebugHandle debug_handle,
+    et_timestamp_t start_time,
+    et_timestamp_t end_time,
+    const internal::PerfCounterValues* perf_counters) {
   etdump_ProfileEvent_start(builder_);
-  etdump_ProfileEvent_start_time_add(builder_, prof_entry.start_time);
+  etdump_ProfileEvent_start_time_add(builder_, start_time);
   etdump_ProfileEvent_end_time_add(builder_, end_time);
-  etdump_ProfileEvent_chain_index_add(builder_, prof_entry.chain_id);
-  etdump_ProfileEvent_instruction_id_add(builder_, prof_entry.debug_handle);
-  if (prof_entry.event_id != -1) {
-    etdump_ProfileEvent_name_add(builder_, prof_entry.event_id);
+  etdump_ProfileEvent_chain_index_add(builder_, chain_id);
+  etdump_ProfileEvent_instruction_id_add(builder_, debug_handle);
+  if (name_id != -1) {
+    etdump_ProfileEvent_name_add(builder_, name_id);
+  }
+  if (perf_counters != nullptr) {
+    add_perf_counters(*perf_counters);
   }
   etdump_ProfileEvent_ref_t id = etdump_ProfileEvent_end(builder_);
   etdump_RunData_events_push_start(builder_);
@@ -489,6 +581,117 @@ void ETDumpGen::end_profiling(EventTracerEntry prof_entry) {
   etdump_RunData_events_push_end(builder_);
 }
 
+void ETDumpGen::add_perf_counters(
+    const internal::PerfCounterValues& perf_counters) {
+  static_assert(
+      etdump_PerfCounterType_Cycles == static_cast<int>(PerfCounter::Cycles) &&
+          etdump_PerfCounterType_Instructions ==
+              static_cast<int>(PerfCounter::Instructions) &&
+          etdump_PerfCounterType_CacheMisses ==
+              static_cast<int>(PerfCounter::CacheMisses) &&
+          etdump_PerfCounterType_BranchMisses ==
+              static_cast<int>(PerfCounter::BranchMisses),
+      "PerfCounter must match the PerfCounterType schema enum");
+  etdump_ProfileEvent_perf_counters_start(builder_);
+  for (size_t i = 0; i < kNumPerfCounters; ++i) {
+    if (perf_counters_.is_available(static_cast<PerfCounter>(i))) {
+      etdump_ProfileEvent_perf_counters_push_create(
+          builder_,
+          static_cast<etdump_PerfCounterType_enum_t>(i),
+          perf_counters.values[i]);
+    }
+  }
+  etdump_ProfileEvent_perf_counters_end(builder_);
+}
+
+Error ETDumpGen::enable_perf_counters(bool enable) {
+  perf_counter_depth_ = 0;
+  if (!enable) {
+    perf_counters_.close();
+    return Error::Ok;
+  }
+  return perf_counters_.open();
+}
+
+void ETDumpGen::start_perf_counters() {
+  if (!perf_counters_.is_open()) {
+    return;
+  }
+  // Events nested deeper than the stack are recorded without counters.
+  if (perf_counter_depth_ < kMaxPerfCounterDepth) {
+    perf_counter_valid_[perf_counter_depth_] =
+        perf_counters_.read(&perf_counter_stack_[perf_counter_depth_]);
+  }
+  ++perf_counter_depth_;
+}
+
+bool ETDumpGen::end_perf_counters(internal::PerfCounterValues* delta) {
+  if (!perf_counters_.is_open() || perf_counter_depth_ == 0) {
+    return false;
+  }
+  internal::PerfCounterValues end;
+  const bool read_ok = perf_counters_.read(&end);
+  const size_t depth = --perf_counter_depth_;
+  if (!read_ok || depth >= kMaxPerfCounterDepth ||
+      !perf_counter_valid_[depth]) {
+    return false;
+  }
+  for (size_t i = 0; i < kNumPerfCounters; ++i) {
+    delta->values[i] = end.values[i] - perf_counter_stack_[depth].values[i];
+  }
+  return true;
+}
+
+internal::ProfileEventRing* ETDumpGen::get_producer_ring() {
+  // Every thread caches the rings it was assigned by the last few ETDumpGens
+  // it logged to, so that a thread alternating between instances keeps its
+  // rings instead of claiming a new one on every switch. The cache is keyed by
+  // the owning ETDumpGen and the buffer generation so that it is never used
+  // with a ring from a different or replaced event buffer.
+  struct ProducerSlot {
+    const ETDumpGen* owner = nullptr;
+    uint32_t generation = 0;
+    internal::ProfileEventRing* ring = nullptr;
+  };
+  constexpr size_t kNumProducerSlots = 8;
+  thread_local ProducerSlot slots[kNumProducerSlots];
+  thread_local size_t next_slot = 0;
+  for (size_t i = 0; i < kNumProducerSlots; ++i) {
+    if (slots[i].owner == this &&
+        slots[i].generation == event_buffer_generation_) {
+      return slots[i].ring;
+    }
+  }
+  // Replace the oldest assignment. A thread that logs to more than
+  // kNumProducerSlots instances in turn is assigned a new ring when it comes
+  // back to an evicted one.
+  ProducerSlot& slot = slots[next_slot];
+  next_slot = (next_slot + 1) % kNumProducerSlots;
+  size_t index = num_event_producers_.fetch_add(1, std::memory_order_acq_rel);
+  slot.owner = this;
+  slot.generation = event_buffer_generation_;
+  slot.ring = index < num_event_rings_ ? &event_rings_[index] : nullptr;
+  return slot.ring;
+}
+
+void ETDumpGen::drain_event_buffer() {
+  size_t num_rings = num_event_producers_.load(std::memory_order_acquire);
+  if (num_rings > num_event_rings_) {
+    num_rings = num_event_rings_;
+  }
+  for (size_t i = 0; i < num_rings; ++i) {
+    event_rings_[i].drain([this](const internal::BufferedProfileEvent& event) {
+      check_ready_to_add_events();
+      add_profile_event(
+          event.name[0] != '\0' ? create_string_entry(event.name) : -1,
+          event.chain_id,
+          event.debug_handle,
+          event.start_time,
+          event.end_time);
+    });
+  }
+}
+
 AllocatorID ETDumpGen::track_allocator(const char* name) {
   ET_CHECK_MSG(
       (state_ == State::BlockCreated || state_ == State::AddingAllocators),
@@ -513,23 +716,42 @@ void ETDumpGen::track_allocation(
 }
 
 ETDumpResult ETDumpGen::get_etdump_data() {
-  ETDumpResult result;
+  if (stream_sink_ != nullptr) {
+    // Completed blocks have already been handed to the streaming sink.
+    Result<bool> ret = flush_stream();
+    if (!ret.ok()) {
+      ET_LOG(
+          Error,
+          "Failed to flush ETDump stream, error 0x%" PRIx32,
+          static_cast<uint32_t>(ret.error()));
+    }
+    return {nullptr, 0};
+  }
+  if (state_ == State::Init) {
+    return {nullptr, 0};
+  }
+  ETDumpResult result = finish_buffer();
+  state_ = State::Done;
+  return result;
+}
+
+ETDumpResult ETDumpGen::finish_buffer() {
+  ETDumpResult result = {nullptr, 0};
+  if (buffered_blocks_ > 0) {
+    drain_event_buffer();
+  }
   if (state_ == State::AddingEvents) {
     etdump_RunData_events_end(builder_);
   } else if (state_ == State::AddingAllocators) {
     etdump_RunData_allocators_end(builder_);
   } else if (state_ == State::Init) {
-    result.buf = nullptr;
-    result.size = 0;
     return result;
   }
   etdump_ETDump_run_data_push_end(builder_);
   etdump_ETDump_run_data_end(builder_);
   etdump_ETDump_ref_t root = etdump_ETDump_end(builder_);
   flatbuffers_buffer_end(builder_, root);
-  if (num_blocks_ == 0) {
-    result = {nullptr, 0};
-  } else {
+  if (buffered_blocks_ > 0) {
     if (alloc_.data) {
       result.buf = alloc_.front_cursor;
       result.size = alloc_.out_size - alloc_.front_left;
@@ -538,10 +760,219 @@ ETDumpResult ETDumpGen::get_etdump_data() {
           flatcc_builder_finalize_aligned_buffer(builder_, &result.size);
     }
   }
-  state_ = State::Done;
   return result;
 }
 
+Result<bool> ETDumpGen::set_streaming_sink(
+    DataSinkBase* sink,
+    ETDumpStreamingConfig config) {
+  ET_CHECK_OR_RETURN_ERROR(
+      sink != nullptr, InvalidArgument, "Streaming sink must not be null");
+  ET_CHECK_OR_RETURN_ERROR(
+      config.chunk_size > 0 && config.chunk_size % kStreamFrameAlignment == 0,
+      InvalidArgument,
+      "Stream chunk size %zu must be a non-zero multiple of %zu",
+      config.chunk_size,
+      kStreamFrameAlignment);
+  ET_CHECK_OR_RETURN_ERROR(
+      stream_sink_ == nullptr && state_ == State::Init,
+      InvalidState,
+      "Streaming must be enabled once, before any event block is created");
+
+  stream_chunk_ = static_cast<uint8_t*>(malloc(config.chunk_size));
+  ET_CHECK_OR_RETURN_ERROR(
+      stream_chunk_ != nullptr,
+      MemoryAllocationFailed,
+      "Failed to allocate %zu byte stream chunk",
+      config.chunk_size);
+  if (config.retained_blocks > 0) {
+    retained_ = static_cast<ETDumpResult*>(
+        calloc(config.retained_blocks, sizeof(ETDumpResult)));
+    if (retained_ == nullptr) {
+      free(stream_chunk_);
+      stream_chunk_ = nullptr;
+      ET_LOG(Error, "Failed to allocate ETDump retention ring");
+      return Error::MemoryAllocationFailed;
+    }
+  }
+  stream_sink_ = sink;
+  stream_config_ = config;
+  stream_chunk_used_ = 0;
+  stream_header_written_ = false;
+  return true;
+}
+
+Result<bool> ETDumpGen::flush_stream() {
+  ET_CHECK_OR_RETURN_ERROR(
+      stream_sink_ != nullptr, InvalidState, "Streaming is not enabled");
+  if (buffered_blocks_ > 0) {
+    ET_CHECK_OK_OR_RETURN_ERROR(emit_stream_block());
+  }
+  ET_CHECK_OK_OR_RETURN_ERROR(flush_stream_chunk());
+  return true;
+}
+
+Result<bool> ETDumpGen::flush_retained_blocks() {
+  ET_CHECK_OR_RETURN_ERROR(
+      stream_sink_ != nullptr && retained_ != nullptr,
+      InvalidState,
+      "Block retention is not enabled");
+  while (num_retained_ > 0) {
+    ETDumpResult& block = retained_[retained_head_];
+    Error err = write_stream_frame(block.buf, block.size);
+    free(block.buf);
+    block = {nullptr, 0};
+    retained_head_ = (retained_head_ + 1) % stream_config_.retained_blocks;
+    --num_retained_;
+    ET_CHECK_OK_OR_RETURN_ERROR(err);
+  }
+  ET_CHECK_OK_OR_RETURN_ERROR(flush_stream_chunk());
+  return true;
+}
+
+bool ETDumpGen::is_streaming() {
+  return stream_sink_ != nullptr;
+}
+
+Error ETDumpGen::emit_stream_block() {
+  ETDumpResult block = finish_buffer();
+  Error err = Error::Ok;
+  if (block.buf != nullptr) {
+    if (retained_ != nullptr) {
+      // Keep a private copy: the builder memory is reused for the next block.
+      void* copy = malloc(block.size);
+      if (copy == nullptr) {
+        err = Error::MemoryAllocationFailed;
+      } else {
+        memcpy(copy, block.buf, block.size);
+        const size_t capacity = stream_config_.retained_blocks;
+        if (num_retained_ == capacity) {
+          free(retained_[retained_head_].buf);
+          retained_head_ = (retained_head_ + 1) % capacity;
+          --num_retained_;
+        }
+        retained_[(retained_head_ + num_retained_) % capacity] = {
+            copy, block.size};
+        ++num_retained_;
+      }
+    } else {
+      err = write_stream_frame(block.buf, block.size);
+    }
+    if (is_static_etdump()) {
+      alloc_.reset_emitter();
+    } else {
+      flatcc_builder_aligned_free(block.buf);
+    }
+  }
+  reset_builder();
+  return err;
+}
+
+Error ETDumpGen::write_stream_frame(const void* data, size_t size) {
+  if (!stream_header_written_) {
+    uint32_t version = kStreamVersion;
+    ET_CHECK_OK_OR_RETURN_ERROR(
+        write_stream(kStreamMagic, sizeof(kStreamMagic)));
+    ET_CHECK_OK_OR_RETURN_ERROR(write_stream(&version, sizeof(version)));
+    stream_header_written_ = true;
+  }
+  uint32_t frame_size = static_cast<uint32_t>(size);
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      write_stream(kStreamFrameMagic, sizeof(kStreamFrameMagic)));
+  ET_CHECK_OK_OR_RETURN_ERROR(write_stream(&frame_size, sizeof(frame_size)));
+  ET_CHECK_OK_OR_RETURN_ERROR(write_stream(data, size));
+  static const uint8_t kPadding[kStreamFrameAlignment] = {};
+  size_t padding = (kStreamFrameAlignment - size % kStreamFrameAlignment) %
+      kStreamFrameAlignment;
+  return write_stream(kPadding, padding);
+}
+
+Error ETDumpGen::write_stream(const void* data, size_t size) {
+  const uint8_t* src = static_cast<const uint8_t*>(data);
+  while (size > 0) {
+    size_t n = stream_config_.chunk_size - stream_chunk_used_;
+    if (n > size) {
+      n = size;
+    }
+    memcpy(stream_chunk_ + stream_chunk_used_, src, n);
+    stream_chunk_used_ += n;
+    src += n;
+    size -= n;
+    if (stream_chunk_used_ == stream_config_.chunk_size) {
+      ET_CHECK_OK_OR_RETURN_ERROR(flush_stream_chunk());
+    }
+  }
+  return Error::Ok;
+}
+
+Error ETDumpGen::flush_stream_chunk() {
+  if (stream_chunk_used_ == 0) {
+    return Error::Ok;
+  }
+  // Always write whole chunks; readers skip the zero padding.
+  memset(
+      stream_chunk_ + stream_chunk_used_,
+      0,
+      stream_config_.chunk_size - stream_chunk_used_);
+  stream_chunk_used_ = 0;
+  Result<size_t> ret =
+      stream_sink_->write(stream_chunk_, stream_config_.chunk_size);
+  if (!ret.ok()) {
+    return ret.error();
+  }
+  return Error::Ok;
+}
+
+Result<bool> ETDumpGen::set_event_buffer(
+    Span<uint8_t> buffer,
+    size_t max_threads) {
+  ET_CHECK_OR_RETURN_ERROR(
+      max_threads > 0, InvalidArgument, "max_threads must be positive");
+  ET_CHECK_OR_RETURN_ERROR(
+      event_rings_ == nullptr && state_ == State::Init,
+      InvalidState,
+      "The event buffer must be set once, before any event block is created");
+
+  uint8_t* end = buffer.data() + buffer.size();
+  uint8_t* rings = internal::align_pointer(
+      buffer.data(), alignof(internal::ProfileEventRing));
+  uint8_t* events = internal::align_pointer(
+      rings + max_threads * sizeof(internal::ProfileEventRing),
+      alignof(internal::BufferedProfileEvent));
+  size_t events_per_thread = events < end
+      ? (size_t)(end - events) / sizeof(internal::BufferedProfileEvent) /
+          max_threads
+      : 0;
+  ET_CHECK_OR_RETURN_ERROR(
+      buffer.data() != nullptr && events_per_thread > 0,
+      InvalidArgument,
+      "Event buffer of %zu bytes is too small for %zu threads",
+      buffer.size(),
+      max_threads);
+
+  event_rings_ = reinterpret_cast<internal::ProfileEventRing*>(rings);
+  for (size_t i = 0; i < max_threads; ++i) {
+    new (&event_rings_[i]) internal::ProfileEventRing();
+    event_rings_[i].init(
+        reinterpret_cast<internal::BufferedProfileEvent*>(events) +
+            i * events_per_thread,
+        events_per_thread);
+  }
+  num_event_rings_ = max_threads;
+  num_event_producers_.store(0, std::memory_order_release);
+  event_buffer_generation_ = event_buffer_generation.fetch_add(1) + 1;
+  return true;
+}
+
+size_t ETDumpGen::get_num_dropped_events() {
+  size_t dropped =
+      num_unbuffered_events_dropped_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < num_event_rings_; ++i) {
+    dropped += event_rings_[i].dropped();
+  }
+  return dropped;
+}
+
 Result<bool> ETDumpGen::set_debug_buffer(Span<uint8_t> buffer) {
   Result<BufferDataSink> bds_ret = BufferDataSink::create(buffer);
   ET_CHECK_OR_RETURN_ERROR(
@@ -8,10 +8,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
 #include <executorch/devtools/etdump/data_sinks/buffer_data_sink.h>
 #include <executorch/devtools/etdump/data_sinks/data_sink_base.h>
+#include <executorch/devtools/etdump/perf_counters.h>
+#include <executorch/devtools/etdump/profile_event_buffer.h>
 #include <executorch/runtime/core/event_tracer.h>
 #include <executorch/runtime/core/result.h>
 #include <executorch/runtime/core/span.h>
@@ -45,6 +48,13 @@ struct ETDumpStaticAllocator {
     front_left = out_size;
   }
 
+  // Rewind the build buffer so that a new flatbuffer can be emitted into it.
+  // Only valid once the previously emitted buffer is no longer referenced.
+  void reset_emitter() {
+    front_cursor = &data[data_size + out_size];
+    front_left = out_size;
+  }
+
   // Pointer to backing buffer to allocate from.
   uint8_t* data{nullptr};
 
@@ -70,6 +80,22 @@ struct ETDumpResult {
   size_t size;
 };
 
+/**
+ * Configuration for ETDumpGen's streaming mode, see
+ * ETDumpGen::set_streaming_sink().
+ */
+struct ETDumpStreamingConfig {
+  /// Size in bytes of every write issued to the streaming sink. A partially
+  /// filled chunk is zero padded when the stream is flushed. This should be a
+  /// multiple of the sink's alignment so that chunks are stored back to back.
+  size_t chunk_size = 4096;
+
+  /// When non-zero, completed event blocks are not written out immediately.
+  /// Instead the last `retained_blocks` blocks are kept in memory (older ones
+  /// are discarded) until flush_retained_blocks() writes them to the sink.
+  size_t retained_blocks = 0;
+};
+
 class ETDumpGen : public ::executorch::runtime::EventTracer {
  public:
   ETDumpGen(::executorch::runtime::Span<uint8_t> buffer = {nullptr, (size_t)0});
@@ -162,6 +188,89 @@ class ETDumpGen : public ::executorch::runtime::EventTracer {
   bool is_static_etdump();
   void reset();
 
+  /**
+   * Switches ETDumpGen to streaming mode. Instead of accumulating every event
+   * block in one flatbuffer until get_etdump_data() is called, each completed
+   * block (i.e. when the next block is created or the stream is flushed) is
+   * serialized as a standalone ETDump and written to `sink` in fixed-size
+   * chunks, after which its builder memory is reused. Memory usage is thus
+   * bounded by the size of a single block.
+   *
+   * The stream starts with an 8-byte header ("ETDS" followed by a version) and
+   * is made of 8-byte aligned frames, each holding one size-prefixed ETDump.
+   * Zero bytes between frames are padding. Use
+   * `executorch.devtools.etdump.serialize.deserialize_from_etdump_stream` or
+   * the Inspector to read it back.
+   *
+   * Must be called before the first event block is created. The sink is not
+   * owned and must outlive this ETDumpGen.
+   */
+  Result<bool> set_streaming_sink(
+      DataSinkBase* sink,
+      ETDumpStreamingConfig config = ETDumpStreamingConfig());
+
+  /**
+   * Closes the current event block, emits it to the streaming sink (or the
+   * retention ring) and writes out any partially filled chunk.
+   */
+  Result<bool> flush_stream();
+
+  /**
+   * Writes the blocks held by the retention ring (see
+   * ETDumpStreamingConfig::retained_blocks) to the streaming sink, oldest
+   * first, and empties the ring. Typically called after an anomaly is detected
+   * to capture the last N executions.
+   */
+  Result<bool> flush_retained_blocks();
+
+  /**
+   * Enables buffering of operator profiling events. start_profiling() and
+   * end_profiling() then only record a fixed-size entry into a lock-free
+   * per-thread queue carved out of `buffer`, and the entries are serialized
+   * when the enclosing event block is completed. This keeps flatbuffer
+   * building out of the timed region of every operator.
+   *
+   * Up to `max_threads` distinct threads may log events; events from further
+   * threads, or events that don't fit in a thread's queue, are dropped and
+   * reported by get_num_dropped_events(). Names passed to start_profiling()
+   * must stay valid until the matching end_profiling() and are truncated to
+   * internal::kBufferedEventNameLength bytes.
+   *
+   * Must be called before the first event block is created.
+   */
+  Result<bool> set_event_buffer(
+      ::executorch::runtime::Span<uint8_t> buffer,
+      size_t max_threads = 1);
+
+  /**
+   * Returns the number of buffered profiling events that were dropped because
+   * their queue was full or too many threads were logging.
+   */
+  size_t get_num_dropped_events();
+
+  bool is_streaming();
+
+  /**
+   * Enables or disables recording of hardware performance counters (cycles,
+   * instructions, cache misses and branch misses) for every operator and
+   * delegate profiling event. The counters are opened for the calling thread,
+   * so this must be called from the thread that executes the method.
+   *
+   * Counter values are stored alongside the timestamps of each event in the
+   * ProfileEvent.perf_counters field; counters that the device does not
+   * support are omitted. Events recorded through set_event_buffer() and
+   * log_profiling_delegate() do not carry counters.
+   *
+   * @retval Error::Ok The counters were enabled or disabled.
+   * @retval Error::NotSupported No counter is available on this platform.
+   *     Profiling continues with timestamps only.
+   */
+  ::executorch::runtime::Error enable_perf_counters(bool enable = true);
+
+  bool perf_counters_enabled() const {
+    return perf_counters_.is_open();
+  }
+
  private:
   enum class State {
     Init,
@@ -173,6 +282,26 @@ class ETDumpGen : public ::executorch::runtime::EventTracer {
 
   void check_ready_to_add_events();
   int64_t create_string_entry(const char* name);
+  void reset_builder();
+  ETDumpResult finish_buffer();
+  void add_profile_event(
+      int64_t name_id,
+      ::executorch::runtime::ChainID chain_id,
+      ::executorch::runtime::DebugHandle debug_handle,
+      et_timestamp_t start_time,
+      et_timestamp_t end_time,
+      const internal::PerfCounterValues* perf_counters = nullptr);
+  void add_perf_counters(const internal::PerfCounterValues& perf_counters);
+  void start_perf_counters();
+  bool end_perf_counters(internal::PerfCounterValues* delta);
+  internal::ProfileEventRing* get_producer_ring();
+  void drain_event_buffer();
+  ::executorch::runtime::Error emit_stream_block();
+  ::executorch::runtime::Error write_stream(const void* data, size_t size);
+  ::executorch::runtime::Error write_stream_frame(
+      const void* data,
+      size_t size);
+  ::executorch::runtime::Error flush_stream_chunk();
 
   /**
    * Templated helper function used to log various types of intermediate output.
@@ -188,8 +317,38 @@ class ETDumpGen : public ::executorch::runtime::EventTracer {
 
   struct flatcc_builder* builder_;
   size_t num_blocks_ = 0;
+  // Number of blocks held by the flatbuffer currently being built. Equal to
+  // num_blocks_ unless streaming, where completed blocks are emitted eagerly.
+  size_t buffered_blocks_ = 0;
   DataSinkBase* data_sink_;
 
+  // Streaming mode state, see set_streaming_sink().
+  DataSinkBase* stream_sink_ = nullptr;
+  ETDumpStreamingConfig stream_config_;
+  uint8_t* stream_chunk_ = nullptr;
+  size_t stream_chunk_used_ = 0;
+  bool stream_header_written_ = false;
+  // Ring of the last stream_config_.retained_blocks serialized blocks.
+  ETDumpResult* retained_ = nullptr;
+  size_t num_retained_ = 0;
+  size_t retained_head_ = 0;
+
+  // Buffered profiling event state, see set_event_buffer().
+  internal::ProfileEventRing* event_rings_ = nullptr;
+  size_t num_event_rings_ = 0;
+  std::atomic<size_t> num_event_producers_{0};
+  std::atomic<size_t> num_unbuffered_events_dropped_{0};
+  uint32_t event_buffer_generation_ = 0;
+
+  // Hardware performance counter state, see enable_perf_counters(). The
+  // readings taken at the start of the currently open profiling events form
+  // a stack, as these events are properly nested.
+  static constexpr size_t kMaxPerfCounterDepth = 16;
+  internal::PerfCounterGroup perf_counters_;
+  internal::PerfCounterValues perf_counter_stack_[kMaxPerfCounterDepth];
+  bool perf_counter_valid_[kMaxPerfCounterDepth] = {};
+  size_t perf_counter_depth_ = 0;
+
   // It is only for set_debug_buffer function.
   BufferDataSink buffer_data_sink_;
 
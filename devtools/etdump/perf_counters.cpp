@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/devtools/etdump/perf_counters.h>
+
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <executorch/runtime/platform/log.h>
+
+using ::executorch::runtime::Error;
+
+namespace executorch {
+namespace etdump {
+namespace internal {
+
+#if defined(__linux__)
+
+namespace {
+
+struct CounterConfig {
+  uint32_t type;
+  uint64_t config;
+};
+
+// Indexed by PerfCounter.
+constexpr CounterConfig kCounterConfigs[kNumPerfCounters] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+int perf_event_open(struct perf_event_attr* attr, int group_fd) {
+  // Count the calling thread on whichever CPU it runs.
+  return static_cast<int>(syscall(
+      __NR_perf_event_open, attr, /*pid=*/0, /*cpu=*/-1, group_fd, 0UL));
+}
+
+} // namespace
+
+Error PerfCounterGroup::open() {
+  if (is_open()) {
+    return Error::Ok;
+  }
+  for (size_t i = 0; i < kNumPerfCounters; ++i) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = kCounterConfigs[i].type;
+    attr.config = kCounterConfigs[i].config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // Only the leader starts disabled; members follow its state.
+    attr.disabled = leader_fd_ == -1 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    int fd = perf_event_open(&attr, leader_fd_);
+    if (fd == -1) {
+      continue;
+    }
+    if (leader_fd_ == -1) {
+      leader_fd_ = fd;
+    }
+    fds_[i] = fd;
+    slots_[i] = static_cast<int>(num_open_++);
+  }
+  if (!is_open()) {
+    ET_LOG(Info, "Hardware performance counters are not available");
+    return Error::NotSupported;
+  }
+  ioctl(leader_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  if (ioctl(leader_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == -1) {
+    ET_LOG(Info, "Failed to enable hardware performance counters");
+    close();
+    return Error::NotSupported;
+  }
+  return Error::Ok;
+}
+
+void PerfCounterGroup::close() {
+  if (leader_fd_ != -1) {
+    ioctl(leader_fd_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  }
+  // Close the members before the leader.
+  for (size_t i = kNumPerfCounters; i-- > 0;) {
+    if (fds_[i] != -1 && fds_[i] != leader_fd_) {
+      ::close(fds_[i]);
+    }
+    fds_[i] = -1;
+    slots_[i] = -1;
+  }
+  if (leader_fd_ != -1) {
+    ::close(leader_fd_);
+    leader_fd_ = -1;
+  }
+  num_open_ = 0;
+}
+
+bool PerfCounterGroup::read(PerfCounterValues* out) const {
+  if (!is_open()) {
+    return false;
+  }
+  // PERF_FORMAT_GROUP layout: the number of counters followed by their
+  // values in the order they were added to the group.
+  uint64_t buffer[1 + kNumPerfCounters];
+  const size_t expected = (1 + num_open_) * sizeof(uint64_t);
+  if (::read(leader_fd_, buffer, sizeof(buffer)) !=
+      static_cast<ssize_t>(expected)) {
+    return false;
+  }
+  for (size_t i = 0; i < kNumPerfCounters; ++i) {
+    out->values[i] = slots_[i] != -1 ? buffer[1 + slots_[i]] : 0;
+  }
+  return true;
+}
+
+#else // !defined(__linux__)
+
+Error PerfCounterGroup::open() {
+  ET_LOG(Info, "Hardware performance counters require Linux perf events");
+  return Error::NotSupported;
+}
+
+void PerfCounterGroup::close() {}
+
+bool PerfCounterGroup::read(PerfCounterValues* out) const {
+  (void)out;
+  return false;
+}
+
+#endif // defined(__linux__)
+
+PerfCounterGroup::~PerfCounterGroup() {
+  close();
+}
+
+} // namespace internal
+} // namespace etdump
+} // namespace executorch
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <executorch/runtime/core/error.h>
+
+namespace executorch {
+namespace etdump {
+
+/**
+ * Hardware performance counters that ETDumpGen can record per profiling
+ * event. The order matches the PerfCounterType enum of the ETDump schema.
+ */
+enum class PerfCounter : uint8_t {
+  Cycles = 0,
+  Instructions = 1,
+  CacheMisses = 2,
+  BranchMisses = 3,
+};
+
+constexpr size_t kNumPerfCounters = 4;
+
+namespace internal {
+
+/// One reading of every counter of a PerfCounterGroup.
+struct PerfCounterValues {
+  uint64_t values[kNumPerfCounters];
+};
+
+/**
+ * A group of hardware performance counters of the calling thread, opened with
+ * Linux perf_event_open(2) and read with a single system call.
+ *
+ * Counters that the kernel or the CPU does not support (e.g. in most virtual
+ * machines, or when perf_event_paranoid forbids it) are left out of the
+ * group; is_available() reports which ones are counted.
+ */
+class PerfCounterGroup {
+ public:
+  PerfCounterGroup() = default;
+  ~PerfCounterGroup();
+
+  PerfCounterGroup(const PerfCounterGroup&) = delete;
+  PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+  /**
+   * Opens and starts the counters for the calling thread.
+   *
+   * @retval Error::Ok At least one counter is available.
+   * @retval Error::NotSupported Not on Linux, or no counter could be opened.
+   */
+  ::executorch::runtime::Error open();
+
+  /// Stops and closes all counters.
+  void close();
+
+  bool is_open() const {
+    return leader_fd_ != -1;
+  }
+
+  bool is_available(PerfCounter counter) const {
+    return slots_[static_cast<size_t>(counter)] != -1;
+  }
+
+  /**
+   * Reads the current value of every counter into `out`. Unavailable
+   * counters read as 0.
+   *
+   * @returns false if the group is not open or the read failed.
+   */
+  bool read(PerfCounterValues* out) const;
+
+ private:
+  int leader_fd_ = -1;
+  int fds_[kNumPerfCounters] = {-1, -1, -1, -1};
+  // Position of each counter in the group read, or -1 if unavailable.
+  int slots_[kNumPerfCounters] = {-1, -1, -1, -1};
+  size_t num_open_ = 0;
+};
+
+} // namespace internal
+} // namespace etdump
+} // namespace executorch
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <executorch/runtime/core/event_tracer.h>
+#include <executorch/runtime/platform/platform.h>
+
+namespace executorch {
+namespace etdump {
+namespace internal {
+
+/// Number of bytes (including the terminating null) of an event name that a
+/// buffered profiling event keeps. Longer names are truncated.
+constexpr size_t kBufferedEventNameLength = 64;
+
+/**
+ * Plain-old-data record of a completed operator profiling event. Records are
+ * appended on the hot path and only serialized into the flatbuffer when the
+ * event block they belong to is completed.
+ */
+struct BufferedProfileEvent {
+  char name[kBufferedEventNameLength];
+  ::executorch::runtime::ChainID chain_id;
+  ::executorch::runtime::DebugHandle debug_handle;
+  et_timestamp_t start_time;
+  et_timestamp_t end_time;
+};
+
+/**
+ * Bounded, lock-free single-producer/single-consumer queue of
+ * BufferedProfileEvent records backed by caller-provided storage.
+ *
+ * Exactly one thread may call push() and exactly one (possibly different)
+ * thread may call drain() concurrently. When the queue is full new events are
+ * dropped and counted instead of blocking the producer.
+ */
+class ProfileEventRing {
+ public:
+  ProfileEventRing() = default;
+
+  ProfileEventRing(const ProfileEventRing&) = delete;
+  ProfileEventRing& operator=(const ProfileEventRing&) = delete;
+
+  /**
+   * Points the ring at `capacity` records of storage. Must not be called while
+   * a producer or consumer is active.
+   */
+  void init(BufferedProfileEvent* storage, size_t capacity) {
+    storage_ = storage;
+    capacity_ = capacity;
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    dropped_.store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   * Appends an event. Returns false (and counts the event as dropped) if the
+   * ring is full.
+   */
+  bool push(
+      const char* name,
+      ::executorch::runtime::ChainID chain_id,
+      ::executorch::runtime::DebugHandle debug_handle,
+      et_timestamp_t start_time,
+      et_timestamp_t end_time) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) >= capacity_) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    BufferedProfileEvent& event = storage_[tail % capacity_];
+    if (name != nullptr) {
+      size_t len = strnlen(name, kBufferedEventNameLength - 1);
+      memcpy(event.name, name, len);
+      event.name[len] = '\0';
+    } else {
+      event.name[0] = '\0';
+    }
+    event.chain_id = chain_id;
+    event.debug_handle = debug_handle;
+    event.start_time = start_time;
+    event.end_time = end_time;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Pops every event that was visible when the call started, in insertion
+   * order, and invokes `fn(const BufferedProfileEvent&)` on each.
+   *
+   * @returns The number of events drained.
+   */
+  template <typename Fn>
+  size_t drain(Fn&& fn) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    const size_t count = tail - head;
+    for (; head != tail; ++head) {
+      fn(static_cast<const BufferedProfileEvent&>(storage_[head % capacity_]));
+    }
+    head_.store(head, std::memory_order_release);
+    return count;
+  }
+
+  /// Number of events dropped because the ring was full.
+  size_t dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  size_t capacity() const {
+    return capacity_;
+  }
+
+ private:
+  BufferedProfileEvent* storage_ = nullptr;
+  size_t capacity_ = 0;
+  // Monotonic read and write counters; the slot is counter % capacity_.
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+  std::atomic<size_t> dropped_{0};
+};
+
+} // namespace internal
+} // namespace etdump
+} // namespace executorch
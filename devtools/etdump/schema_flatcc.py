@@ -109,6 +109,20 @@ class PROFILE_EVENT_ENUM(Enum):
     LOAD_MODEL = "Program::load_method"
 
 
+@dataclass
+class PerfCounterType(Enum):
+    CYCLES = "Cycles"
+    INSTRUCTIONS = "Instructions"
+    CACHE_MISSES = "CacheMisses"
+    BRANCH_MISSES = "BranchMisses"
+
+
+@dataclass
+class PerfCounter:
+    counter: str  # Member of PerfCounterType
+    value: int
+
+
 @dataclass
 class ProfileEvent:
     name: Optional[str]
@@ -119,6 +133,7 @@ class ProfileEvent:
     delegate_debug_metadata: Optional[bytes]
     start_time: int
     end_time: int
+    perf_counters: Optional[List[PerfCounter]] = None
 
 
 @dataclass
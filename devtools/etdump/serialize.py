@@ -10,7 +10,9 @@
 import importlib.resources as _resources
 import json
 import os
+import struct
 import tempfile
+from typing import List
 
 import executorch.devtools.etdump as etdump_package
 from executorch.devtools.etdump.schema_flatcc import ETDumpFlatCC
@@ -21,6 +23,12 @@ from executorch.exir._serialize._flatbuffer import _flatc_compile, _flatc_decomp
 ETDUMP_FLATCC_SCHEMA_NAME = "etdump_schema_flatcc"
 SCALAR_TYPE_SCHEMA_NAME = "scalar_type"
 
+# Magic bytes at the start of an ETDump stream and of each of its frames, see
+# ETDumpGen::set_streaming_sink().
+ETDUMP_STREAM_MAGIC = b"ETDS"
+ETDUMP_STREAM_FRAME_MAGIC = b"ETDB"
+_ETDUMP_STREAM_ALIGNMENT = 8
+
 
 def _write_schema(d: str, schema_name: str) -> None:
     schema_path = os.path.join(d, "{}.fbs".format(schema_name))
@@ -106,3 +114,57 @@ def deserialize_from_etdump_flatcc(
     return _deserialize_from_json_to_etdump_flatcc(
         _convert_from_flatcc(data, size_prefixed)
     )
+
+
+def is_etdump_stream(data: bytes) -> bool:
+    """
+    Returns True if `data` was produced by ETDumpGen's streaming mode rather
+    than being a single ETDump flatbuffer.
+    """
+    return data[: len(ETDUMP_STREAM_MAGIC)] == ETDUMP_STREAM_MAGIC
+
+
+def split_etdump_stream(data: bytes) -> List[bytes]:
+    """
+    Splits an ETDump stream into the size-prefixed ETDump flatbuffers it holds,
+    one per streamed event block, in the order they were written.
+    """
+    if not is_etdump_stream(data):
+        raise ValueError("Data is not an ETDump stream")
+    frames = []
+    pos = _ETDUMP_STREAM_ALIGNMENT
+    while pos + _ETDUMP_STREAM_ALIGNMENT <= len(data):
+        magic = data[pos : pos + 4]
+        if magic == b"\x00" * 4:
+            # Zero padding at the end of a chunk.
+            pos += _ETDUMP_STREAM_ALIGNMENT
+            continue
+        if magic != ETDUMP_STREAM_FRAME_MAGIC:
+            raise ValueError(f"Corrupt ETDump stream at offset {pos}")
+        (size,) = struct.unpack_from("<I", data, pos + 4)
+        start = pos + _ETDUMP_STREAM_ALIGNMENT
+        if start + size > len(data):
+            raise ValueError(f"Truncated ETDump stream frame at offset {pos}")
+        frames.append(data[start : start + size])
+        padding = -size % _ETDUMP_STREAM_ALIGNMENT
+        pos = start + size + padding
+    return frames
+
+
+def deserialize_from_etdump_stream(data: bytes) -> ETDumpFlatCC:
+    """
+    Given the output of ETDumpGen's streaming mode, deserializes every streamed
+    ETDump and merges their run data into a single ETDump python object.
+    Args:
+        data: ETDump stream.
+    Returns:
+        Deserialized ETDump python object holding all streamed event blocks.
+    """
+    frames = split_etdump_stream(data)
+    if not frames:
+        raise ValueError("ETDump stream does not contain any event block")
+    etdumps = [deserialize_from_etdump_flatcc(frame) for frame in frames]
+    merged = etdumps[0]
+    for etdump in etdumps[1:]:
+        merged.run_data.extend(etdump.run_data)
+    return merged
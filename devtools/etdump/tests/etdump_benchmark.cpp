@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Measures the per-event cost of operator profiling in the different ETDumpGen
+// modes. Each benchmark iteration logs one start_profiling()/end_profiling()
+// pair; a new event block is started every `events_per_block` events to mimic
+// repeated Method::execute() calls.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include <executorch/devtools/etdump/data_sinks/data_sink_base.h>
+#include <executorch/devtools/etdump/etdump_flatcc.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using ::executorch::etdump::DataSinkBase;
+using ::executorch::etdump::ETDumpGen;
+using ::executorch::etdump::ETDumpResult;
+using ::executorch::etdump::ETDumpStreamingConfig;
+using ::executorch::etdump::internal::BufferedProfileEvent;
+using ::executorch::runtime::EventTracerEntry;
+using ::executorch::runtime::Result;
+using ::executorch::runtime::Span;
+
+namespace {
+
+// Sink that only counts bytes, so that the benchmark measures ETDumpGen and
+// not the storage.
+class CountingDataSink : public DataSinkBase {
+ public:
+  Result<size_t> write(const void* ptr, size_t length) override {
+    (void)ptr;
+    size_t offset = used_;
+    used_ += length;
+    return offset;
+  }
+  size_t get_used_bytes() const override {
+    return used_;
+  }
+
+ private:
+  size_t used_ = 0;
+};
+
+void log_events(
+    benchmark::State& state,
+    ETDumpGen& etdump_gen,
+    bool in_memory) {
+  const size_t events_per_block = state.range(0);
+  size_t events = 0;
+  etdump_gen.create_event_block("Execute");
+  for (auto _ : state) {
+    EventTracerEntry entry =
+        etdump_gen.start_profiling("native_call_add.out", 0, events);
+    etdump_gen.end_profiling(entry);
+    if (++events % events_per_block == 0) {
+      if (in_memory) {
+        // Bound the in-memory buffer the way a caller would: dump and start
+        // over. This is excluded from the measurement.
+        state.PauseTiming();
+        ETDumpResult result = etdump_gen.get_etdump_data();
+        free(result.buf);
+        etdump_gen.reset();
+        state.ResumeTiming();
+      }
+      etdump_gen.create_event_block("Execute");
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ProfileEventInMemory(benchmark::State& state) {
+  ETDumpGen etdump_gen;
+  log_events(state, etdump_gen, /*in_memory=*/true);
+}
+
+void BM_ProfileEventStreaming(benchmark::State& state) {
+  ETDumpGen etdump_gen;
+  CountingDataSink sink;
+  ETDumpStreamingConfig config;
+  config.chunk_size = 64 * 1024;
+  etdump_gen.set_streaming_sink(&sink, config);
+  log_events(state, etdump_gen, /*in_memory=*/false);
+  etdump_gen.flush_stream();
+  state.counters["bytes_per_event"] = benchmark::Counter(
+      sink.get_used_bytes(), benchmark::Counter::kAvgIterations);
+}
+
+void BM_ProfileEventStreamingBuffered(benchmark::State& state) {
+  ETDumpGen etdump_gen;
+  CountingDataSink sink;
+  ETDumpStreamingConfig config;
+  config.chunk_size = 64 * 1024;
+  etdump_gen.set_streaming_sink(&sink, config);
+  // Room for every event of a block, plus the ring bookkeeping.
+  std::vector<uint8_t> event_buffer(
+      (state.range(0) + 1) * sizeof(BufferedProfileEvent) + 1024);
+  etdump_gen.set_event_buffer(
+      Span<uint8_t>(event_buffer.data(), event_buffer.size()));
+  log_events(state, etdump_gen, /*in_memory=*/false);
+  etdump_gen.flush_stream();
+  state.counters["dropped"] = etdump_gen.get_num_dropped_events();
+}
+
+BENCHMARK(BM_ProfileEventInMemory)->Arg(1000)->Arg(10000);
+BENCHMARK(BM_ProfileEventStreaming)->Arg(1000)->Arg(10000);
+BENCHMARK(BM_ProfileEventStreamingBuffered)->Arg(1000)->Arg(10000);
+
+// Make sure the PAL is initialized before the first tick is read.
+const bool runtime_initialized = [] {
+  executorch::runtime::runtime_init();
+  return true;
+}();
+
+} // namespace
@@ -9,6 +9,8 @@
 #include <gtest/gtest.h>
 #include <cstdio>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <executorch/devtools/etdump/data_sinks/buffer_data_sink.h>
 #include <executorch/devtools/etdump/data_sinks/file_data_sink.h>
@@ -1046,3 +1048,274 @@ TEST_F(ProfilerETDumpTest, AllocatorOverrunAborts) {
   delete small_etdump;
   free(small_buf);
 }
+
+namespace {
+
+// Splits an ETDump stream into the size-prefixed ETDump buffers it holds.
+std::vector<const uint8_t*> parse_etdump_stream(
+    const uint8_t* data,
+    size_t size) {
+  std::vector<const uint8_t*> frames;
+  EXPECT_GE(size, 8);
+  EXPECT_EQ(memcmp(data, "ETDS", 4), 0);
+  size_t pos = 8;
+  while (pos + 8 <= size) {
+    uint32_t word = 0;
+    memcpy(&word, data + pos, sizeof(word));
+    if (word == 0) {
+      // Padding at the end of a chunk.
+      pos += 8;
+      continue;
+    }
+    EXPECT_EQ(memcmp(data + pos, "ETDB", 4), 0);
+    uint32_t frame_size = 0;
+    memcpy(&frame_size, data + pos + 4, sizeof(frame_size));
+    frames.push_back(data + pos + 8);
+    pos += 8 + ((frame_size + 7) & ~size_t(7));
+  }
+  return frames;
+}
+
+std::string run_data_name(const uint8_t* frame) {
+  size_t size = 0;
+  const void* buf = flatbuffers_read_size_prefix((void*)frame, &size);
+  etdump_ETDump_table_t etdump = etdump_ETDump_as_root_with_identifier(
+      buf, etdump_ETDump_file_identifier);
+  EXPECT_NE(etdump, nullptr);
+  etdump_RunData_vec_t run_data_vec = etdump_ETDump_run_data(etdump);
+  EXPECT_EQ(etdump_RunData_vec_len(run_data_vec), 1);
+  return etdump_RunData_name(etdump_RunData_vec_at(run_data_vec, 0));
+}
+
+} // namespace
+
+TEST_F(ProfilerETDumpTest, StreamingWritesBlocksInChunks) {
+  const size_t buffer_size = 64 * 1024;
+  const size_t chunk_size = 256;
+  for (size_t i = 0; i < 2; i++) {
+    std::vector<uint8_t> storage(buffer_size);
+    auto sink = BufferDataSink::create(storage.data(), buffer_size);
+    ASSERT_TRUE(sink.ok());
+    ASSERT_TRUE(etdump_gen[i]
+                    ->set_streaming_sink(&sink.get(), {chunk_size, 0})
+                    .ok());
+    EXPECT_TRUE(etdump_gen[i]->is_streaming());
+
+    for (size_t block = 0; block < 5; block++) {
+      std::string name = "block_" + std::to_string(block);
+      etdump_gen[i]->create_event_block(name.c_str());
+      for (size_t j = 0; j < 16; j++) {
+        EventTracerEntry entry =
+            etdump_gen[i]->start_profiling("test_event", 0, j);
+        etdump_gen[i]->end_profiling(entry);
+      }
+    }
+    ASSERT_TRUE(etdump_gen[i]->flush_stream().ok());
+    EXPECT_EQ(etdump_gen[i]->get_num_blocks(), 5);
+
+    // Every write issued to the sink is exactly one chunk.
+    size_t used = sink.get().get_used_bytes();
+    ASSERT_GT(used, 0);
+    EXPECT_EQ(used % chunk_size, 0);
+
+    std::vector<const uint8_t*> frames =
+        parse_etdump_stream(storage.data(), used);
+    ASSERT_EQ(frames.size(), 5);
+    for (size_t block = 0; block < 5; block++) {
+      EXPECT_EQ(run_data_name(frames[block]), "block_" + std::to_string(block));
+    }
+
+    // Data has been handed over to the sink already.
+    ETDumpResult result = etdump_gen[i]->get_etdump_data();
+    EXPECT_EQ(result.buf, nullptr);
+  }
+}
+
+TEST_F(ProfilerETDumpTest, StreamingRetainsLastBlocks) {
+  const size_t buffer_size = 64 * 1024;
+  for (size_t i = 0; i < 2; i++) {
+    std::vector<uint8_t> storage(buffer_size);
+    auto sink = BufferDataSink::create(storage.data(), buffer_size);
+    ASSERT_TRUE(sink.ok());
+    ASSERT_TRUE(
+        etdump_gen[i]->set_streaming_sink(&sink.get(), {512, 3}).ok());
+
+    for (size_t block = 0; block < 10; block++) {
+      std::string name = "block_" + std::to_string(block);
+      etdump_gen[i]->create_event_block(name.c_str());
+      EventTracerEntry entry = etdump_gen[i]->start_profiling("test_event");
+      etdump_gen[i]->end_profiling(entry);
+    }
+    ASSERT_TRUE(etdump_gen[i]->flush_stream().ok());
+    // Nothing is written until the retained blocks are flushed.
+    EXPECT_EQ(sink.get().get_used_bytes(), 0);
+
+    ASSERT_TRUE(etdump_gen[i]->flush_retained_blocks().ok());
+    std::vector<const uint8_t*> frames =
+        parse_etdump_stream(storage.data(), sink.get().get_used_bytes());
+    ASSERT_EQ(frames.size(), 3);
+    EXPECT_EQ(run_data_name(frames[0]), "block_7");
+    EXPECT_EQ(run_data_name(frames[1]), "block_8");
+    EXPECT_EQ(run_data_name(frames[2]), "block_9");
+  }
+}
+
+TEST_F(ProfilerETDumpTest, BufferedProfileEvents) {
+  for (size_t i = 0; i < 2; i++) {
+    std::vector<uint8_t> event_buffer(8 * 1024);
+    ASSERT_TRUE(etdump_gen[i]
+                    ->set_event_buffer(
+                        Span<uint8_t>(event_buffer.data(), event_buffer.size()))
+                    .ok());
+
+    etdump_gen[i]->create_event_block("test_block");
+    size_t num_events = 0;
+    // Log more events than fit in the buffer to exercise dropping.
+    for (size_t j = 0; j < 1000; j++) {
+      EventTracerEntry entry =
+          etdump_gen[i]->start_profiling("test_event", 0, j);
+      etdump_gen[i]->end_profiling(entry);
+    }
+    num_events = 1000 - etdump_gen[i]->get_num_dropped_events();
+    EXPECT_GT(num_events, 0);
+    EXPECT_LT(num_events, 1000);
+
+    ETDumpResult result = etdump_gen[i]->get_etdump_data();
+    ASSERT_TRUE(result.buf != nullptr);
+    size_t size = 0;
+    void* buf = flatbuffers_read_size_prefix(result.buf, &size);
+    etdump_ETDump_table_t etdump = etdump_ETDump_as_root_with_identifier(
+        buf, etdump_ETDump_file_identifier);
+    etdump_RunData_table_t run_data =
+        etdump_RunData_vec_at(etdump_ETDump_run_data(etdump), 0);
+    etdump_Event_vec_t events = etdump_RunData_events(run_data);
+    ASSERT_EQ(etdump_Event_vec_len(events), num_events);
+
+    etdump_ProfileEvent_table_t event =
+        etdump_Event_profile_event(etdump_Event_vec_at(events, 1));
+    EXPECT_EQ(std::string(etdump_ProfileEvent_name(event)), "test_event");
+    EXPECT_EQ(etdump_ProfileEvent_instruction_id(event), 1);
+
+    if (!etdump_gen[i]->is_static_etdump()) {
+      free(result.buf);
+    }
+  }
+}
+
+TEST_F(ProfilerETDumpTest, BufferedProfileEventsAlternatingInstances) {
+  std::vector<uint8_t> event_buffers[2];
+  for (size_t i = 0; i < 2; i++) {
+    event_buffers[i].resize(8 * 1024);
+    // A single ring: a second assignment to this thread would drop events.
+    ASSERT_TRUE(etdump_gen[i]
+                    ->set_event_buffer(
+                        Span<uint8_t>(
+                            event_buffers[i].data(), event_buffers[i].size()),
+                        1)
+                    .ok());
+    etdump_gen[i]->create_event_block("test_block");
+  }
+
+  for (size_t j = 0; j < 10; j++) {
+    for (size_t i = 0; i < 2; i++) {
+      EventTracerEntry entry =
+          etdump_gen[i]->start_profiling("test_event", 0, j);
+      etdump_gen[i]->end_profiling(entry);
+    }
+  }
+
+  for (size_t i = 0; i < 2; i++) {
+    EXPECT_EQ(etdump_gen[i]->get_num_dropped_events(), 0);
+
+    ETDumpResult result = etdump_gen[i]->get_etdump_data();
+    ASSERT_TRUE(result.buf != nullptr);
+    size_t size = 0;
+    void* buf = flatbuffers_read_size_prefix(result.buf, &size);
+    etdump_ETDump_table_t etdump = etdump_ETDump_as_root_with_identifier(
+        buf, etdump_ETDump_file_identifier);
+    etdump_RunData_table_t run_data =
+        etdump_RunData_vec_at(etdump_ETDump_run_data(etdump), 0);
+    EXPECT_EQ(etdump_Event_vec_len(etdump_RunData_events(run_data)), 10);
+
+    if (!etdump_gen[i]->is_static_etdump()) {
+      free(result.buf);
+    }
+  }
+}
+
+TEST_F(ProfilerETDumpTest, PerfCounters) {
+  for (size_t i = 0; i < 2; i++) {
+    Error err = etdump_gen[i]->enable_perf_counters();
+    // Counters are commonly unavailable, e.g. in containers and VMs. Profiling
+    // must then continue without them.
+    ASSERT_TRUE(err == Error::Ok || err == Error::NotSupported);
+    EXPECT_EQ(etdump_gen[i]->perf_counters_enabled(), err == Error::Ok);
+
+    etdump_gen[i]->create_event_block("test_block");
+    EventTracerEntry outer = etdump_gen[i]->start_profiling("outer", 0, 0);
+    EventTracerEntry inner = etdump_gen[i]->start_profiling("inner", 0, 1);
+    etdump_gen[i]->end_profiling(inner);
+    etdump_gen[i]->end_profiling(outer);
+    EventTracerEntry delegate =
+        etdump_gen[i]->start_profiling_delegate(nullptr, 7);
+    etdump_gen[i]->end_profiling_delegate(delegate, nullptr, 0);
+
+    ETDumpResult result = etdump_gen[i]->get_etdump_data();
+    ASSERT_TRUE(result.buf != nullptr);
+    size_t size = 0;
+    void* buf = flatbuffers_read_size_prefix(result.buf, &size);
+    etdump_ETDump_table_t etdump = etdump_ETDump_as_root_with_identifier(
+        buf, etdump_ETDump_file_identifier);
+    etdump_RunData_table_t run_data =
+        etdump_RunData_vec_at(etdump_ETDump_run_data(etdump), 0);
+    etdump_Event_vec_t events = etdump_RunData_events(run_data);
+    ASSERT_EQ(etdump_Event_vec_len(events), 3);
+
+    for (size_t j = 0; j < 3; j++) {
+      etdump_PerfCounter_vec_t counters = etdump_ProfileEvent_perf_counters(
+          etdump_Event_profile_event(etdump_Event_vec_at(events, j)));
+      if (err != Error::Ok) {
+        EXPECT_EQ(counters, nullptr);
+        continue;
+      }
+      ASSERT_NE(counters, nullptr);
+      EXPECT_GT(etdump_PerfCounter_vec_len(counters), 0);
+    }
+
+    if (err == Error::Ok) {
+      // The outer event encloses the inner one, so it can't count fewer
+      // cycles or instructions.
+      etdump_PerfCounter_vec_t inner_counters =
+          etdump_ProfileEvent_perf_counters(
+              etdump_Event_profile_event(etdump_Event_vec_at(events, 0)));
+      etdump_PerfCounter_vec_t outer_counters =
+          etdump_ProfileEvent_perf_counters(
+              etdump_Event_profile_event(etdump_Event_vec_at(events, 1)));
+      ASSERT_EQ(
+          etdump_PerfCounter_vec_len(inner_counters),
+          etdump_PerfCounter_vec_len(outer_counters));
+      for (size_t j = 0; j < etdump_PerfCounter_vec_len(inner_counters); j++) {
+        etdump_PerfCounter_table_t inner_counter =
+            etdump_PerfCounter_vec_at(inner_counters, j);
+        etdump_PerfCounter_table_t outer_counter =
+            etdump_PerfCounter_vec_at(outer_counters, j);
+        EXPECT_EQ(
+            etdump_PerfCounter_counter(inner_counter),
+            etdump_PerfCounter_counter(outer_counter));
+        if (etdump_PerfCounter_counter(inner_counter) !=
+            etdump_PerfCounterType_CacheMisses) {
+          EXPECT_LE(
+              etdump_PerfCounter_value(inner_counter),
+              etdump_PerfCounter_value(outer_counter));
+        }
+      }
+    }
+
+    EXPECT_EQ(etdump_gen[i]->enable_perf_counters(false), Error::Ok);
+    EXPECT_FALSE(etdump_gen[i]->perf_counters_enabled());
+
+    if (!etdump_gen[i]->is_static_etdump()) {
+      free(result.buf);
+    }
+  }
+}
@@ -8,6 +8,7 @@
 
 import difflib
 import json
+import struct
 import unittest
 from pprint import pformat
 from typing import List
@@ -16,7 +17,9 @@ import executorch.devtools.etdump.schema_flatcc as flatcc
 
 from executorch.devtools.etdump.serialize import (
     deserialize_from_etdump_flatcc,
+    is_etdump_stream,
     serialize_to_etdump_flatcc,
+    split_etdump_stream,
 )
 from executorch.exir._serialize._dataclass import _DataclassEncoder
 
@@ -140,3 +143,26 @@ class TestSerializeFlatCC(unittest.TestCase):
                 )
             ),
         )
+
+    def test_split_etdump_stream(self) -> None:
+        def frame(payload: bytes) -> bytes:
+            padding = b"\x00" * (-len(payload) % 8)
+            return b"ETDB" + struct.pack("<I", len(payload)) + payload + padding
+
+        # Header, two frames, chunk padding, then a third frame.
+        stream = (
+            b"ETDS"
+            + struct.pack("<I", 0)
+            + frame(b"first")
+            + frame(b"12345678")
+            + b"\x00" * 16
+            + frame(b"third frame")
+        )
+        self.assertTrue(is_etdump_stream(stream))
+        self.assertFalse(is_etdump_stream(b"\x10\x00\x00\x00ED00"))
+        self.assertEqual(
+            split_etdump_stream(stream), [b"first", b"12345678", b"third frame"]
+        )
+
+        with self.assertRaises(ValueError):
+            split_etdump_stream(stream[: len(stream) - 8])
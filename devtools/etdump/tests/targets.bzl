@@ -33,3 +33,15 @@ def define_common_targets():
             "//executorch/runtime/platform:platform",
         ],
     )
+
+    runtime.cxx_binary(
+        name = "etdump_benchmark",
+        srcs = [
+            "etdump_benchmark.cpp",
+        ],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/devtools/etdump:etdump_flatcc",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
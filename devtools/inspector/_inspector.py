@@ -61,6 +61,7 @@ from executorch.devtools.inspector._inspector_utils import (
     is_inference_output_equal,
     map_runtime_aot_intermediate_outputs,
     merge_runtime_overlapping_debug_handles,
+    PERF_COUNTER_NAMES,
     ProgramOutput,
     propagate_back_debug_handle,
     RESERVED_FRAMEWORK_EVENT_NAMES,
@@ -330,6 +331,9 @@ class Event:
             Available as Event.raw_delegate_debug_metadatas
 
         debug_data: A list containing intermediate data collected.
+        perf_counters: Hardware performance counters (e.g. "cycles", "instructions", "cache_misses",
+            "branch_misses") recorded by the runtime, each a list with one value per profile event.
+            Empty if the runtime did not record counters.
 
         _instruction_id: Instruction Identifier for Symbolication
         _delegate_metadata_parser: Optional Parser for _delegate_debug_metadatas
@@ -348,6 +352,7 @@ class Event:
     _delegate_debug_metadatas: List[str] = dataclasses.field(default_factory=list)
 
     debug_data: ProgramOutput = dataclasses.field(default_factory=list)
+    perf_counters: Dict[str, List[int]] = dataclasses.field(default_factory=dict)
     _instruction_id: Optional[int] = None
 
     _delegate_metadata_parser: Optional[Callable[[List[str]], Dict[str, Any]]] = None
@@ -552,6 +557,7 @@ class Event:
             is_delegated_op
             perf_data
             delegate_debug_metadatas
+            perf_counters
         """
 
         # Fill out fields from profile event signature
@@ -561,6 +567,7 @@ class Event:
         data = []
         stime = []
         delegate_debug_metadatas = []
+        perf_counters: Dict[str, List[int]] = {}
         for event in events:
             if (profile_events := event.profile_events) is not None:
                 if len(profile_events) != 1:
@@ -607,12 +614,18 @@ class Event:
                     if profile_event.delegate_debug_metadata
                     else ""
                 )
+                for perf_counter in profile_event.perf_counters or []:
+                    perf_counters.setdefault(
+                        PERF_COUNTER_NAMES[perf_counter.counter], []
+                    ).append(perf_counter.value)
 
         # Update fields
         if len(data) > 0:
             ret_event.perf_data = PerfData(data)
         if any(delegate_debug_metadatas):
             ret_event._delegate_debug_metadatas = delegate_debug_metadatas
+        if perf_counters:
+            ret_event.perf_counters = perf_counters
 
         # add _start_time to the event
         if len(stime) > 0:
@@ -724,7 +737,10 @@ class EventBlock:
     reference_output: Optional[ProgramOutput] = None
 
     def to_dataframe(
-        self, include_units: bool = False, include_delegate_debug_data: bool = False
+        self,
+        include_units: bool = False,
+        include_delegate_debug_data: bool = False,
+        include_perf_counters: bool = False,
     ) -> pd.DataFrame:
         """
         Converts the EventBlock into a DataFrame with each row being an event instance
@@ -735,6 +751,8 @@ class EventBlock:
         Args:
             include_units: Whether headers should include units (default false)
             include_delegate_debug_data: Whether to show the delegate debug data
+            include_perf_counters: Whether to add the average of each hardware performance
+                counter recorded by the runtime, and the instructions per cycle
 
         Returns:
             A pandas DataFrame containing the data of each Event instance in this EventBlock.
@@ -773,6 +791,21 @@ class EventBlock:
             if any(not data.empty for data in delegate_data):
                 df = pd.concat([df, pd.DataFrame(delegate_data)], axis=1)
 
+        # Add hardware performance counter columns
+        if include_perf_counters:
+            counter_data = []
+            for event in self.events:
+                counters = {
+                    name: np.mean(values)
+                    for name, values in event.perf_counters.items()
+                }
+                if counters.get("cycles") and "instructions" in counters:
+                    counters["ipc"] = counters["instructions"] / counters["cycles"]
+                counter_data.append(pd.Series(counters, dtype=float))
+
+            if any(not data.empty for data in counter_data):
+                df = pd.concat([df, pd.DataFrame(counter_data)], axis=1)
+
         return df
 
     @staticmethod
@@ -1377,11 +1410,13 @@ class Inspector:
         self,
         include_units: bool = True,
         include_delegate_debug_data: bool = False,
+        include_perf_counters: bool = False,
     ) -> pd.DataFrame:
         """
         Args:
             include_units: Whether headers should include units (default true)
             include_delegate_debug_data: Whether to include delegate debug metadata (default false)
+            include_perf_counters: Whether to include hardware performance counters (default false)
 
         Returns:
             Returns a pandas DataFrame of the Events in each EventBlock in the inspector, with each row representing an Event.
@@ -1391,6 +1426,7 @@ class Inspector:
             event_block.to_dataframe(
                 include_units=include_units,
                 include_delegate_debug_data=include_delegate_debug_data,
+                include_perf_counters=include_perf_counters,
             )
             for event_block in self.event_blocks
         ]
@@ -1400,16 +1436,20 @@ class Inspector:
         self,
         include_units: bool = True,
         include_delegate_debug_data: bool = False,
+        include_perf_counters: bool = False,
     ) -> pd.DataFrame:
         """
         Args:
             include_units: Whether headers should include units (default true)
             include_delegate_debug_data: Whether to include delegate debug metadata (default false)
+            include_perf_counters: Whether to include hardware performance counters (default false)
 
         Returns:
             Returns a pandas DataFrame of the Events in each EventBlock in the inspector, with additional filtering.
         """
-        combined_df = self.to_dataframe(include_units, include_delegate_debug_data)
+        combined_df = self.to_dataframe(
+            include_units, include_delegate_debug_data, include_perf_counters
+        )
 
         # Filter out some columns and rows for better readability when printing
         filtered_column_df = combined_df.drop(columns=EXCLUDED_COLUMNS_WHEN_PRINTING)
@@ -1426,6 +1466,7 @@ class Inspector:
         file: IO[str] = sys.stdout,
         include_units: bool = True,
         include_delegate_debug_data: bool = False,
+        include_perf_counters: bool = False,
     ) -> None:
         """
         Displays the underlying EventBlocks in a structured tabular format, with each row representing an Event.
@@ -1434,11 +1475,14 @@ class Inspector:
             file: Which IO stream to print to. Defaults to stdout. Not used if this is in an IPython environment such as a Jupyter notebook.
             include_units: Whether headers should include units (default true).
             include_delegate_debug_data: Whether to include delegate debug metadata (default false).
+            include_perf_counters: Whether to include hardware performance counters (default false).
 
         Returns:
             None
         """
-        df = self._prepare_dataframe(include_units, include_delegate_debug_data)
+        df = self._prepare_dataframe(
+            include_units, include_delegate_debug_data, include_perf_counters
+        )
         display_or_print_df(df, file)
 
     def save_data_to_tsv(
@@ -25,6 +25,7 @@ from executorch.devtools.debug_format.et_schema import FXOperatorGraph, Operator
 from executorch.devtools.etdump.schema_flatcc import (
     DebugEvent,
     ETDumpFlatCC,
+    PerfCounterType,
     ProfileEvent,
     ScalarType,
     Tensor,
@@ -32,7 +33,11 @@ from executorch.devtools.etdump.schema_flatcc import (
     ValueType,
 )
 
-from executorch.devtools.etdump.serialize import deserialize_from_etdump_flatcc
+from executorch.devtools.etdump.serialize import (
+    deserialize_from_etdump_flatcc,
+    deserialize_from_etdump_stream,
+    is_etdump_stream,
+)
 from executorch.devtools.etrecord import ETRecord
 
 from executorch.exir.debug_handle_utils import (
@@ -67,6 +72,15 @@ EXCLUDED_EVENTS_WHEN_PRINTING = {"OPERATOR_CALL"}
 
 EXCLUDED_EVENTS_FOR_INTERMEDIATE_OUTPUT = {"OPERATOR_CALL"}
 
+# Names under which the hardware performance counters of ProfileEvents are
+# surfaced in Event.perf_counters and in DataFrames.
+PERF_COUNTER_NAMES = {
+    PerfCounterType.CYCLES.value: "cycles",
+    PerfCounterType.INSTRUCTIONS.value: "instructions",
+    PerfCounterType.CACHE_MISSES.value: "cache_misses",
+    PerfCounterType.BRANCH_MISSES.value: "branch_misses",
+}
+
 
 class TimeScale(Enum):
     NS = "ns"
@@ -369,6 +383,8 @@ def gen_etdump_object(
             "Unable to get ETDump data. One and only one of etdump_path and etdump_data must be specified."
         )
 
+    if is_etdump_stream(etdump_data):
+        return deserialize_from_etdump_stream(etdump_data)
     return deserialize_from_etdump_flatcc(etdump_data)
 
 
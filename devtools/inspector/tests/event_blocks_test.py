@@ -362,6 +362,39 @@ class TestEventBlock(unittest.TestCase):
                 run_counts.add((len(block.events), len(perf_data.raw)))
         self.assertSetEqual(run_counts, {(1, 2), (2, 1)})
 
+    def test_gen_from_etdump_perf_counters(self) -> None:
+        """
+        Test that hardware performance counters of ProfileEvents are collected
+        per Event and surfaced in the DataFrame
+        """
+        etdump: ETDumpFlatCC = TestEventBlock._get_sample_etdump_flatcc()
+        cycles = flatcc.PerfCounterType.CYCLES.value
+        instructions = flatcc.PerfCounterType.INSTRUCTIONS.value
+        for run_data, (cycle_count, instruction_count) in zip(
+            etdump.run_data[:2], [(100, 50), (300, 450)]
+        ):
+            profile_event = run_data.events[0].profile_event
+            profile_event.perf_counters = [  # pyre-ignore
+                flatcc.PerfCounter(counter=cycles, value=cycle_count),
+                flatcc.PerfCounter(counter=instructions, value=instruction_count),
+            ]
+
+        blocks: List[EventBlock] = EventBlock._gen_from_etdump(etdump)
+        block_a = next(block for block in blocks if block.name == "signature_a")
+        block_b = next(block for block in blocks if block.name == "signature_b")
+        self.assertEqual(
+            block_a.events[0].perf_counters,
+            {"cycles": [100, 300], "instructions": [50, 450]},
+        )
+        self.assertEqual(block_b.events[0].perf_counters, {})
+
+        df = block_a.to_dataframe(include_perf_counters=True)
+        self.assertEqual(df["cycles"][0], 200)
+        self.assertEqual(df["instructions"][0], 250)
+        self.assertAlmostEqual(df["ipc"][0], 1.25)
+        self.assertNotIn("cycles", block_b.to_dataframe(include_perf_counters=True))
+        self.assertNotIn("cycles", block_a.to_dataframe())
+
     def test_gen_from_etdump_profiling_and_debugging(self) -> None:
         """
         Test "e2e" generation of EventBlocks given an ETDump with both profiling and debugging events
@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/devtools/memory_plan/memory_plan_report.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <tuple>
+#include <utility>
+
+#include <executorch/runtime/platform/log.h>
+
+using ::executorch::runtime::Error;
+using ::executorch::runtime::MethodMeta;
+using ::executorch::runtime::PlannedTensorInfo;
+using ::executorch::runtime::Result;
+using ::executorch::runtime::Span;
+
+namespace executorch {
+namespace memory_plan {
+
+namespace {
+
+// Bytes of a buffer that are live over [first_use, last_use].
+struct LiveBlock {
+  size_t buffer_index;
+  size_t offset;
+  size_t nbytes;
+  int64_t first_use;
+  int64_t last_use;
+};
+
+// The blocks occupied by the used tensors. Tensors at the same buffer and
+// offset with overlapping lifetimes, such as a view and its base, alias the
+// same bytes and are merged into one block covering all of them.
+std::vector<LiveBlock> live_blocks(
+    const std::vector<PlannedTensorInfo>& tensors) {
+  std::vector<LiveBlock> blocks;
+  for (const PlannedTensorInfo& tensor : tensors) {
+    if (tensor.first_use >= 0) {
+      blocks.push_back(
+          {tensor.buffer_index,
+           tensor.offset,
+           tensor.nbytes,
+           tensor.first_use,
+           tensor.last_use});
+    }
+  }
+  std::sort(
+      blocks.begin(), blocks.end(), [](const LiveBlock& a, const LiveBlock& b) {
+        return std::tie(a.buffer_index, a.offset, a.first_use) <
+            std::tie(b.buffer_index, b.offset, b.first_use);
+      });
+
+  std::vector<LiveBlock> merged;
+  for (const LiveBlock& block : blocks) {
+    if (!merged.empty() && merged.back().buffer_index == block.buffer_index &&
+        merged.back().offset == block.offset &&
+        block.first_use <= merged.back().last_use) {
+      LiveBlock& alias = merged.back();
+      alias.nbytes = std::max(alias.nbytes, block.nbytes);
+      alias.last_use = std::max(alias.last_use, block.last_use);
+    } else {
+      merged.push_back(block);
+    }
+  }
+  return merged;
+}
+
+} // namespace
+
+Result<MemoryPlanReport> MemoryPlanReport::create(
+    const MethodMeta& method_meta) {
+  std::vector<PlannedTensorInfo> tensors(method_meta.num_planned_tensors());
+  Result<size_t> num_tensors = method_meta.planned_tensor_infos(
+      Span<PlannedTensorInfo>(tensors.data(), tensors.size()));
+  if (!num_tensors.ok()) {
+    return num_tensors.error();
+  }
+  tensors.resize(num_tensors.get());
+
+  std::vector<size_t> buffer_sizes(method_meta.num_memory_planned_buffers());
+  for (size_t i = 0; i < buffer_sizes.size(); ++i) {
+    Result<int64_t> size = method_meta.memory_planned_buffer_size(i);
+    if (!size.ok()) {
+      return size.error();
+    }
+    buffer_sizes[i] = static_cast<size_t>(size.get());
+  }
+  return create(
+      std::move(tensors),
+      std::move(buffer_sizes),
+      method_meta.num_instructions());
+}
+
+Result<MemoryPlanReport> MemoryPlanReport::create(
+    std::vector<PlannedTensorInfo> tensors,
+    std::vector<size_t> buffer_sizes,
+    size_t num_instructions) {
+  for (const PlannedTensorInfo& tensor : tensors) {
+    ET_CHECK_OR_RETURN_ERROR(
+        tensor.buffer_index < buffer_sizes.size(),
+        InvalidArgument,
+        "Tensor at value %zu is in buffer %zu, but there are %zu buffers",
+        tensor.value_index,
+        tensor.buffer_index,
+        buffer_sizes.size());
+    ET_CHECK_OR_RETURN_ERROR(
+        tensor.first_use <= tensor.last_use &&
+            tensor.last_use < static_cast<int64_t>(num_instructions),
+        InvalidArgument,
+        "Tensor at value %zu has invalid lifetime [%" PRId64 ", %" PRId64 "]",
+        tensor.value_index,
+        tensor.first_use,
+        tensor.last_use);
+  }
+  return MemoryPlanReport(
+      std::move(tensors), std::move(buffer_sizes), num_instructions);
+}
+
+MemoryPlanReport::MemoryPlanReport(
+    std::vector<PlannedTensorInfo> tensors,
+    std::vector<size_t> buffer_sizes,
+    size_t num_instructions)
+    : tensors_(std::move(tensors)),
+      buffer_usage_(buffer_sizes.size()),
+      num_instructions_(num_instructions),
+      live_bytes_(buffer_sizes.size() * num_instructions, 0) {
+  const size_t num_buffers = buffer_sizes.size();
+
+  // Accumulate the lifetimes as differences, then take the prefix sums.
+  std::vector<int64_t> deltas(num_buffers * (num_instructions + 1), 0);
+  for (const LiveBlock& block : live_blocks(tensors_)) {
+    int64_t* buffer_deltas =
+        &deltas[block.buffer_index * (num_instructions + 1)];
+    buffer_deltas[block.first_use] += static_cast<int64_t>(block.nbytes);
+    buffer_deltas[block.last_use + 1] -= static_cast<int64_t>(block.nbytes);
+  }
+
+  for (size_t b = 0; b < num_buffers; ++b) {
+    BufferUsage& usage = buffer_usage_[b];
+    usage.size = buffer_sizes[b];
+    int64_t live = 0;
+    double utilization_sum = 0.0;
+    for (size_t i = 0; i < num_instructions; ++i) {
+      live += deltas[b * (num_instructions + 1) + i];
+      live_bytes_[b * num_instructions + i] = static_cast<size_t>(live);
+      if (static_cast<size_t>(live) > usage.peak_live_bytes) {
+        usage.peak_live_bytes = static_cast<size_t>(live);
+        usage.peak_instruction = static_cast<int64_t>(i);
+      }
+      if (usage.size > 0) {
+        utilization_sum +=
+            static_cast<double>(live) / static_cast<double>(usage.size);
+      }
+    }
+    if (num_instructions > 0) {
+      usage.average_utilization = utilization_sum / num_instructions;
+    }
+  }
+
+  // Fragmentation of each buffer at its peak.
+  for (const PlannedTensorInfo& tensor : tensors_) {
+    BufferUsage& usage = buffer_usage_[tensor.buffer_index];
+    if (usage.peak_instruction >= 0 &&
+        is_live(tensor, static_cast<size_t>(usage.peak_instruction))) {
+      usage.peak_extent =
+          std::max(usage.peak_extent, tensor.offset + tensor.nbytes);
+    }
+  }
+  for (BufferUsage& usage : buffer_usage_) {
+    if (usage.peak_extent > 0) {
+      usage.peak_fragmentation = 1.0 -
+          static_cast<double>(usage.peak_live_bytes) /
+              static_cast<double>(usage.peak_extent);
+    }
+  }
+
+  for (size_t i = 0; i < num_instructions; ++i) {
+    size_t live = total_live_bytes(i);
+    if (live > peak_live_bytes_) {
+      peak_live_bytes_ = live;
+      peak_instruction_ = static_cast<int64_t>(i);
+    }
+  }
+}
+
+size_t MemoryPlanReport::total_live_bytes(size_t instruction) const {
+  size_t total = 0;
+  for (size_t b = 0; b < num_buffers(); ++b) {
+    total += live_bytes(b, instruction);
+  }
+  return total;
+}
+
+size_t MemoryPlanReport::total_planned_bytes() const {
+  size_t total = 0;
+  for (const BufferUsage& usage : buffer_usage_) {
+    total += usage.size;
+  }
+  return total;
+}
+
+std::vector<size_t> MemoryPlanReport::live_tensors(size_t instruction) const {
+  std::vector<size_t> live;
+  for (size_t i = 0; i < tensors_.size(); ++i) {
+    if (is_live(tensors_[i], instruction)) {
+      live.push_back(i);
+    }
+  }
+  std::stable_sort(live.begin(), live.end(), [this](size_t a, size_t b) {
+    return tensors_[a].nbytes > tensors_[b].nbytes;
+  });
+  return live;
+}
+
+void MemoryPlanReport::write_summary(std::ostream& out, size_t top_k) const {
+  char line[256];
+  snprintf(
+      line,
+      sizeof(line),
+      "%zu planned tensors in %zu buffers over %zu instructions\n",
+      tensors_.size(),
+      num_buffers(),
+      num_instructions_);
+  out << line;
+  for (size_t b = 0; b < num_buffers(); ++b) {
+    const BufferUsage& usage = buffer_usage_[b];
+    snprintf(
+        line,
+        sizeof(line),
+        "buffer %zu: size %zu, peak live %zu at instruction %" PRId64
+        ", fragmentation at peak %.1f%%, average utilization %.1f%%\n",
+        b,
+        usage.size,
+        usage.peak_live_bytes,
+        usage.peak_instruction,
+        usage.peak_fragmentation * 100.0,
+        usage.average_utilization * 100.0);
+    out << line;
+  }
+  const size_t planned = total_planned_bytes();
+  snprintf(
+      line,
+      sizeof(line),
+      "total: planned %zu, peak live %zu at instruction %" PRId64
+      " (%.1f%% of planned)\n",
+      planned,
+      peak_live_bytes_,
+      peak_instruction_,
+      planned > 0 ? 100.0 * peak_live_bytes_ / planned : 0.0);
+  out << line;
+
+  if (peak_instruction_ < 0 || top_k == 0) {
+    return;
+  }
+  out << "largest tensors live at the peak:\n";
+  std::vector<size_t> live =
+      live_tensors(static_cast<size_t>(peak_instruction_));
+  for (size_t i = 0; i < live.size() && i < top_k; ++i) {
+    const PlannedTensorInfo& tensor = tensors_[live[i]];
+    snprintf(
+        line,
+        sizeof(line),
+        "  value %zu: %zu bytes at buffer %zu offset %zu, live [%" PRId64
+        ", %" PRId64 "]\n",
+        tensor.value_index,
+        tensor.nbytes,
+        tensor.buffer_index,
+        tensor.offset,
+        tensor.first_use,
+        tensor.last_use);
+    out << line;
+  }
+}
+
+void MemoryPlanReport::write_chrome_trace(std::ostream& out) const {
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  auto separator = [&]() -> std::ostream& {
+    if (!first) {
+      out << ",";
+    }
+    first = false;
+    return out << "\n";
+  };
+
+  for (size_t b = 0; b < num_buffers(); ++b) {
+    separator() << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << b
+                << ",\"args\":{\"name\":\"buffer " << b << " ("
+                << buffer_usage_[b].size << " bytes)\"}}";
+  }
+  for (const PlannedTensorInfo& tensor : tensors_) {
+    if (tensor.first_use < 0) {
+      continue;
+    }
+    // One row per tensor: slices on the same row would have to nest.
+    separator() << "{\"ph\":\"X\",\"cat\":\"tensor\",\"name\":\"value "
+                << tensor.value_index << "\",\"pid\":" << tensor.buffer_index
+                << ",\"tid\":" << tensor.value_index
+                << ",\"ts\":" << tensor.first_use
+                << ",\"dur\":" << (tensor.last_use - tensor.first_use + 1)
+                << ",\"args\":{\"offset\":" << tensor.offset
+                << ",\"nbytes\":" << tensor.nbytes << "}}";
+  }
+  for (size_t b = 0; b < num_buffers(); ++b) {
+    for (size_t i = 0; i < num_instructions_; ++i) {
+      // Counters are step functions, only emit the changes.
+      if (i > 0 && live_bytes(b, i) == live_bytes(b, i - 1)) {
+        continue;
+      }
+      separator() << "{\"ph\":\"C\",\"name\":\"live bytes\",\"pid\":" << b
+                  << ",\"ts\":" << i << ",\"args\":{\"live\":"
+                  << live_bytes(b, i) << ",\"idle\":"
+                  << (buffer_usage_[b].size - std::min(
+                                                  buffer_usage_[b].size,
+                                                  live_bytes(b, i)))
+                  << "}}";
+    }
+  }
+  out << "\n]}\n";
+}
+
+} // namespace memory_plan
+} // namespace executorch
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/executor/method_meta.h>
+
+namespace executorch {
+namespace memory_plan {
+
+/**
+ * Usage statistics of one memory-planned buffer over the execution of a
+ * method.
+ */
+struct BufferUsage {
+  /// Size of the buffer as planned during export.
+  size_t size = 0;
+
+  /// Largest number of bytes of tensors that are live at the same time.
+  /// Tensors at the same offset whose lifetimes overlap, such as a view and
+  /// its base, alias each other and count once.
+  size_t peak_live_bytes = 0;
+
+  /// First instruction at which peak_live_bytes is reached, or -1 if no
+  /// tensor of the buffer is ever used.
+  int64_t peak_instruction = -1;
+
+  /// End offset of the highest tensor that is live at peak_instruction.
+  size_t peak_extent = 0;
+
+  /// Fraction of [0, peak_extent) that is not occupied by a live tensor at
+  /// peak_instruction, i.e. memory that is lost to fragmentation.
+  double peak_fragmentation = 0.0;
+
+  /// Mean over all instructions of the fraction of the buffer occupied by
+  /// live tensors.
+  double average_utilization = 0.0;
+};
+
+/**
+ * Analysis of the memory plan of a method: when each memory-planned tensor is
+ * live, how many bytes are live at each instruction, the peak and how much of
+ * each planned buffer sits idle or fragmented. Intended for comparing memory
+ * planning algorithms on the host.
+ *
+ * Instructions are numbered as in MethodMeta::num_instructions().
+ */
+class MemoryPlanReport final {
+ public:
+  /**
+   * Builds the report of a method from the placement and lifetime of its
+   * planned tensors (see MethodMeta::planned_tensor_infos()).
+   */
+  static ::executorch::runtime::Result<MemoryPlanReport> create(
+      const ::executorch::runtime::MethodMeta& method_meta);
+
+  /**
+   * Builds a report from explicit plan data.
+   *
+   * @param[in] tensors The planned tensors.
+   * @param[in] buffer_sizes The size of every memory-planned buffer.
+   * @param[in] num_instructions The number of instructions of the method.
+   */
+  static ::executorch::runtime::Result<MemoryPlanReport> create(
+      std::vector<::executorch::runtime::PlannedTensorInfo> tensors,
+      std::vector<size_t> buffer_sizes,
+      size_t num_instructions);
+
+  const std::vector<::executorch::runtime::PlannedTensorInfo>& tensors()
+      const {
+    return tensors_;
+  }
+
+  size_t num_buffers() const {
+    return buffer_usage_.size();
+  }
+
+  size_t num_instructions() const {
+    return num_instructions_;
+  }
+
+  const BufferUsage& buffer_usage(size_t buffer_index) const {
+    return buffer_usage_[buffer_index];
+  }
+
+  /// Bytes of the tensors of `buffer_index` that are live at `instruction`.
+  size_t live_bytes(size_t buffer_index, size_t instruction) const {
+    return live_bytes_[buffer_index * num_instructions_ + instruction];
+  }
+
+  /// Bytes of the tensors of all buffers that are live at `instruction`.
+  size_t total_live_bytes(size_t instruction) const;
+
+  /// Sum of the sizes of all planned buffers.
+  size_t total_planned_bytes() const;
+
+  /// Largest value of total_live_bytes() over all instructions.
+  size_t peak_live_bytes() const {
+    return peak_live_bytes_;
+  }
+
+  /// First instruction at which peak_live_bytes() is reached, or -1.
+  int64_t peak_instruction() const {
+    return peak_instruction_;
+  }
+
+  /// Indices into tensors() of the tensors live at `instruction`, largest
+  /// first.
+  std::vector<size_t> live_tensors(size_t instruction) const;
+
+  /**
+   * Writes a human readable summary: per-buffer usage, the peak and the
+   * `top_k` largest tensors live at the peak.
+   */
+  void write_summary(std::ostream& out, size_t top_k = 10) const;
+
+  /**
+   * Writes the plan as a Chrome trace (JSON Trace Event Format) that can be
+   * opened with chrome://tracing or https://ui.perfetto.dev. Each buffer is a
+   * process holding one slice per tensor lifetime and a counter of its live
+   * bytes. The time axis counts instructions: 1us is one instruction.
+   */
+  void write_chrome_trace(std::ostream& out) const;
+
+ private:
+  MemoryPlanReport(
+      std::vector<::executorch::runtime::PlannedTensorInfo> tensors,
+      std::vector<size_t> buffer_sizes,
+      size_t num_instructions);
+
+  bool is_live(
+      const ::executorch::runtime::PlannedTensorInfo& tensor,
+      size_t instruction) const {
+    return tensor.first_use >= 0 &&
+        tensor.first_use <= static_cast<int64_t>(instruction) &&
+        static_cast<int64_t>(instruction) <= tensor.last_use;
+  }
+
+  std::vector<::executorch::runtime::PlannedTensorInfo> tensors_;
+  std::vector<BufferUsage> buffer_usage_;
+  size_t num_instructions_;
+  // Live bytes indexed by [buffer][instruction].
+  std::vector<size_t> live_bytes_;
+  size_t peak_live_bytes_ = 0;
+  int64_t peak_instruction_ = -1;
+};
+
+} // namespace memory_plan
+} // namespace executorch
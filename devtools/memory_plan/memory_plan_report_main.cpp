@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file
+ *
+ * Prints the memory plan report of a method of a .pte file and optionally
+ * writes its timeline as a Chrome trace. The method is not loaded or
+ * executed; everything is read from the program.
+ */
+
+#include <fstream>
+#include <iostream>
+
+#include <gflags/gflags.h>
+
+#include <executorch/devtools/memory_plan/memory_plan_report.h>
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/runtime/executor/program.h>
+#include <executorch/runtime/platform/log.h>
+#include <executorch/runtime/platform/runtime.h>
+
+DEFINE_string(
+    model_path,
+    "model.pte",
+    "Model serialized in flatbuffer format.");
+
+DEFINE_string(method_name, "forward", "Method to report on.");
+
+DEFINE_string(
+    trace_path,
+    "",
+    "If set, the memory timeline is written to this path as a Chrome trace.");
+
+DEFINE_int32(top_k, 10, "Number of tensors live at the peak to print.");
+
+using executorch::extension::FileDataLoader;
+using executorch::memory_plan::MemoryPlanReport;
+using executorch::runtime::MethodMeta;
+using executorch::runtime::Program;
+using executorch::runtime::Result;
+
+int main(int argc, char** argv) {
+  executorch::runtime::runtime_init();
+
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  if (argc != 1) {
+    ET_LOG(Error, "Unexpected command line argument '%s'", argv[1]);
+    return 1;
+  }
+
+  Result<FileDataLoader> loader =
+      FileDataLoader::from(FLAGS_model_path.c_str());
+  if (!loader.ok()) {
+    ET_LOG(Error, "Failed to open %s", FLAGS_model_path.c_str());
+    return 1;
+  }
+  Result<Program> program = Program::load(&loader.get());
+  if (!program.ok()) {
+    ET_LOG(Error, "Failed to parse model file %s", FLAGS_model_path.c_str());
+    return 1;
+  }
+  Result<MethodMeta> method_meta =
+      program->method_meta(FLAGS_method_name.c_str());
+  if (!method_meta.ok()) {
+    ET_LOG(
+        Error,
+        "Failed to get method_meta for %s: 0x%x",
+        FLAGS_method_name.c_str(),
+        (unsigned int)method_meta.error());
+    return 1;
+  }
+
+  Result<MemoryPlanReport> report = MemoryPlanReport::create(*method_meta);
+  if (!report.ok()) {
+    ET_LOG(
+        Error,
+        "Failed to read the memory plan: 0x%x",
+        (unsigned int)report.error());
+    return 1;
+  }
+  report->write_summary(std::cout, FLAGS_top_k > 0 ? FLAGS_top_k : 0);
+
+  if (!FLAGS_trace_path.empty()) {
+    std::ofstream trace(FLAGS_trace_path);
+    report->write_chrome_trace(trace);
+    if (!trace) {
+      ET_LOG(Error, "Failed to write %s", FLAGS_trace_path.c_str());
+      return 1;
+    }
+    ET_LOG(Info, "Memory timeline written to %s", FLAGS_trace_path.c_str());
+  }
+  return 0;
+}
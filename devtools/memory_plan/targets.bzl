@@ -0,0 +1,40 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
+
+def define_common_targets():
+    """Defines targets that should be shared between fbcode and xplat.
+
+    The directory containing this targets.bzl file should also contain both
+    TARGETS and BUCK files that call this function.
+    """
+
+    runtime.cxx_library(
+        name = "memory_plan_report",
+        srcs = [
+            "memory_plan_report.cpp",
+        ],
+        exported_headers = [
+            "memory_plan_report.h",
+        ],
+        deps = [
+            "//executorch/runtime/platform:platform",
+        ],
+        exported_deps = [
+            "//executorch/runtime/executor:program",
+        ],
+        visibility = ["PUBLIC"],
+    )
+
+    runtime.cxx_binary(
+        name = "memory_plan_report_main",
+        srcs = [
+            "memory_plan_report_main.cpp",
+        ],
+        deps = [
+            ":memory_plan_report",
+            "//executorch/extension/data_loader:file_data_loader",
+            "//executorch/runtime/executor:program",
+        ],
+        external_deps = [
+            "gflags",
+        ],
+    )
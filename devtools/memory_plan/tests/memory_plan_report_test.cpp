@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <executorch/devtools/memory_plan/memory_plan_report.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gtest/gtest.h>
+
+using ::executorch::memory_plan::BufferUsage;
+using ::executorch::memory_plan::MemoryPlanReport;
+using ::executorch::runtime::Error;
+using ::executorch::runtime::PlannedTensorInfo;
+using ::executorch::runtime::Result;
+
+namespace {
+
+PlannedTensorInfo make_tensor(
+    size_t value_index,
+    size_t buffer_index,
+    size_t offset,
+    size_t nbytes,
+    int64_t first_use,
+    int64_t last_use) {
+  PlannedTensorInfo info;
+  info.value_index = value_index;
+  info.buffer_index = buffer_index;
+  info.offset = offset;
+  info.nbytes = nbytes;
+  info.first_use = first_use;
+  info.last_use = last_use;
+  info.is_persistent = false;
+  return info;
+}
+
+// A chain a -> b -> c -> d over 4 instructions in one 64-byte buffer, where
+// c reuses the memory of a.
+//
+//   offset  0..16  a [0, 1]   c [2, 3]
+//   offset 16..48  b [1, 2]
+//   offset 48..56  d [3, 3]
+std::vector<PlannedTensorInfo> chain_tensors() {
+  return {
+      make_tensor(0, 0, 0, 16, 0, 1),
+      make_tensor(1, 0, 16, 32, 1, 2),
+      make_tensor(2, 0, 0, 16, 2, 3),
+      make_tensor(3, 0, 48, 8, 3, 3),
+  };
+}
+
+} // namespace
+
+class MemoryPlanReportTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+  }
+};
+
+TEST_F(MemoryPlanReportTest, LiveBytesAndPeak) {
+  Result<MemoryPlanReport> report =
+      MemoryPlanReport::create(chain_tensors(), {64}, 4);
+  ASSERT_EQ(report.error(), Error::Ok);
+
+  EXPECT_EQ(report->num_buffers(), 1);
+  EXPECT_EQ(report->num_instructions(), 4);
+  EXPECT_EQ(report->live_bytes(0, 0), 16);
+  EXPECT_EQ(report->live_bytes(0, 1), 48);
+  EXPECT_EQ(report->live_bytes(0, 2), 48);
+  EXPECT_EQ(report->live_bytes(0, 3), 24);
+  EXPECT_EQ(report->total_live_bytes(1), 48);
+  EXPECT_EQ(report->total_planned_bytes(), 64);
+
+  EXPECT_EQ(report->peak_live_bytes(), 48);
+  EXPECT_EQ(report->peak_instruction(), 1);
+
+  const BufferUsage& usage = report->buffer_usage(0);
+  EXPECT_EQ(usage.size, 64);
+  EXPECT_EQ(usage.peak_live_bytes, 48);
+  EXPECT_EQ(usage.peak_instruction, 1);
+  EXPECT_EQ(usage.peak_extent, 48);
+  EXPECT_DOUBLE_EQ(usage.peak_fragmentation, 0.0);
+  EXPECT_DOUBLE_EQ(usage.average_utilization, (16 + 48 + 48 + 24) / 256.0);
+}
+
+TEST_F(MemoryPlanReportTest, Fragmentation) {
+  // At instruction 1 the live tensors cover [0, 8), [48, 56) and [56, 96):
+  // 56 of the 96 bytes below the highest live tensor, the rest is a hole.
+  std::vector<PlannedTensorInfo> tensors = {
+      make_tensor(0, 0, 0, 8, 0, 1),
+      make_tensor(1, 0, 8, 40, 0, 0),
+      make_tensor(2, 0, 48, 8, 1, 1),
+      make_tensor(3, 0, 56, 40, 1, 1),
+  };
+  Result<MemoryPlanReport> report =
+      MemoryPlanReport::create(tensors, {96}, 2);
+  ASSERT_EQ(report.error(), Error::Ok);
+
+  const BufferUsage& usage = report->buffer_usage(0);
+  EXPECT_EQ(report->live_bytes(0, 0), 48);
+  EXPECT_EQ(usage.peak_live_bytes, 56);
+  EXPECT_EQ(usage.peak_instruction, 1);
+  EXPECT_EQ(usage.peak_extent, 96);
+  EXPECT_DOUBLE_EQ(usage.peak_fragmentation, 40.0 / 96.0);
+}
+
+TEST_F(MemoryPlanReportTest, AliasedViewsCountOnce) {
+  // Value 1 is a view of value 0 that outlives it, value 2 is placed after
+  // them. Value 3 reuses the bytes of the view once it is dead.
+  std::vector<PlannedTensorInfo> tensors = {
+      make_tensor(0, 0, 0, 32, 0, 1),
+      make_tensor(1, 0, 0, 32, 1, 2),
+      make_tensor(2, 0, 32, 16, 1, 1),
+      make_tensor(3, 0, 0, 16, 3, 3),
+  };
+  Result<MemoryPlanReport> report =
+      MemoryPlanReport::create(tensors, {48}, 4);
+  ASSERT_EQ(report.error(), Error::Ok);
+
+  EXPECT_EQ(report->live_bytes(0, 0), 32);
+  EXPECT_EQ(report->live_bytes(0, 1), 48);
+  EXPECT_EQ(report->live_bytes(0, 2), 32);
+  EXPECT_EQ(report->live_bytes(0, 3), 16);
+
+  const BufferUsage& usage = report->buffer_usage(0);
+  EXPECT_EQ(usage.peak_live_bytes, 48);
+  EXPECT_LE(usage.peak_live_bytes, usage.size);
+  EXPECT_EQ(usage.peak_extent, 48);
+  EXPECT_GE(usage.peak_fragmentation, 0.0);
+  EXPECT_LE(usage.peak_fragmentation, 1.0);
+  EXPECT_LE(usage.average_utilization, 1.0);
+}
+
+TEST_F(MemoryPlanReportTest, MultipleBuffers) {
+  std::vector<PlannedTensorInfo> tensors = {
+      make_tensor(0, 0, 0, 100, 0, 0),
+      make_tensor(1, 1, 0, 10, 0, 2),
+      make_tensor(2, 1, 16, 10, 2, 2),
+      make_tensor(3, 1, 32, 10, 2, 2),
+  };
+  Result<MemoryPlanReport> report =
+      MemoryPlanReport::create(tensors, {100, 48}, 3);
+  ASSERT_EQ(report.error(), Error::Ok);
+
+  EXPECT_EQ(report->buffer_usage(0).peak_instruction, 0);
+  EXPECT_EQ(report->buffer_usage(1).peak_live_bytes, 30);
+  EXPECT_EQ(report->buffer_usage(1).peak_instruction, 2);
+  EXPECT_EQ(report->buffer_usage(1).peak_extent, 42);
+  EXPECT_DOUBLE_EQ(report->buffer_usage(1).peak_fragmentation, 12.0 / 42.0);
+
+  // The overall peak combines both buffers.
+  EXPECT_EQ(report->total_live_bytes(0), 110);
+  EXPECT_EQ(report->peak_live_bytes(), 110);
+  EXPECT_EQ(report->peak_instruction(), 0);
+}
+
+TEST_F(MemoryPlanReportTest, LiveTensorsLargestFirst) {
+  Result<MemoryPlanReport> report =
+      MemoryPlanReport::create(chain_tensors(), {64}, 4);
+  ASSERT_EQ(report.error(), Error::Ok);
+
+  std::vector<size_t> live = report->live_tensors(1);
+  ASSERT_EQ(live.size(), 2);
+  EXPECT_EQ(report->tensors()[live[0]].value_index, 1);
+  EXPECT_EQ(report->tensors()[live[1]].value_index, 0);
+
+  live = report->live_tensors(3);
+  ASSERT_EQ(live.size(), 2);
+  EXPECT_EQ(report->tensors()[live[0]].value_index, 2);
+  EXPECT_EQ(report->tensors()[live[1]].value_index, 3);
+}
+
+TEST_F(MemoryPlanReportTest, UnusedTensorsAreNeverLive) {
+  std::vector<PlannedTensorInfo> tensors = {
+      make_tensor(0, 0, 0, 16, -1, -1),
+      make_tensor(1, 0, 16, 16, 0, 0),
+  };
+  Result<MemoryPlanReport> report = MemoryPlanReport::create(tensors, {32}, 1);
+  ASSERT_EQ(report.error(), Error::Ok);
+
+  EXPECT_EQ(report->live_bytes(0, 0), 16);
+  EXPECT_EQ(report->live_tensors(0).size(), 1);
+}
+
+TEST_F(MemoryPlanReportTest, RejectsInvalidPlans) {
+  // Unknown buffer.
+  Result<MemoryPlanReport> bad_buffer =
+      MemoryPlanReport::create({make_tensor(0, 1, 0, 8, 0, 0)}, {64}, 1);
+  EXPECT_EQ(bad_buffer.error(), Error::InvalidArgument);
+
+  // Used past the last instruction.
+  Result<MemoryPlanReport> bad_last_use =
+      MemoryPlanReport::create({make_tensor(0, 0, 0, 8, 0, 1)}, {64}, 1);
+  EXPECT_EQ(bad_last_use.error(), Error::InvalidArgument);
+
+  // Last use before first use.
+  Result<MemoryPlanReport> bad_lifetime =
+      MemoryPlanReport::create({make_tensor(0, 0, 0, 8, 1, 0)}, {64}, 2);
+  EXPECT_EQ(bad_lifetime.error(), Error::InvalidArgument);
+}
+
+TEST_F(MemoryPlanReportTest, WriteSummary) {
+  Result<MemoryPlanReport> report =
+      MemoryPlanReport::create(chain_tensors(), {64}, 4);
+  ASSERT_EQ(report.error(), Error::Ok);
+
+  std::ostringstream out;
+  report->write_summary(out, /*top_k=*/1);
+  const std::string summary = out.str();
+  EXPECT_NE(summary.find("4 planned tensors in 1 buffers"), std::string::npos);
+  EXPECT_NE(summary.find("peak live 48 at instruction 1"), std::string::npos);
+  EXPECT_NE(summary.find("value 1: 32 bytes"), std::string::npos);
+  // Only the largest tensor is listed.
+  EXPECT_EQ(summary.find("value 0: 16 bytes"), std::string::npos);
+}
+
+TEST_F(MemoryPlanReportTest, WriteChromeTrace) {
+  Result<MemoryPlanReport> report =
+      MemoryPlanReport::create(chain_tensors(), {64}, 4);
+  ASSERT_EQ(report.error(), Error::Ok);
+
+  std::ostringstream out;
+  report->write_chrome_trace(out);
+  const std::string trace = out.str();
+  EXPECT_EQ(trace.find("{\"displayTimeUnit\""), 0);
+  EXPECT_NE(trace.find("\"name\":\"buffer 0 (64 bytes)\""), std::string::npos);
+  EXPECT_NE(
+      trace.find("\"name\":\"value 1\",\"pid\":0,\"tid\":1,\"ts\":1,\"dur\":2"),
+      std::string::npos);
+  EXPECT_NE(
+      trace.find("\"ts\":3,\"args\":{\"live\":24,\"idle\":40}"),
+      std::string::npos);
+  // The counter does not change between instructions 1 and 2.
+  EXPECT_EQ(trace.find("\"ts\":2,\"args\":{\"live\""), std::string::npos);
+  EXPECT_EQ(trace.substr(trace.size() - 4), "\n]}\n");
+}
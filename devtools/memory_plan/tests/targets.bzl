@@ -0,0 +1,19 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
+
+def define_common_targets():
+    """Defines targets that should be shared between fbcode and xplat.
+
+    The directory containing this targets.bzl file should also contain both
+    TARGETS and BUCK files that call this function.
+    """
+
+    runtime.cxx_test(
+        name = "memory_plan_report_test",
+        srcs = [
+            "memory_plan_report_test.cpp",
+        ],
+        deps = [
+            "//executorch/devtools/memory_plan:memory_plan_report",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <executorch/runtime/platform/platform.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ET_HAS_CYCLE_COUNTER 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define ET_HAS_CYCLE_COUNTER 1
+#elif defined(__aarch64__)
+#define ET_HAS_CYCLE_COUNTER 1
+#else
+#define ET_HAS_CYCLE_COUNTER 0
+#endif
+
+namespace executorch {
+namespace sampling_tracer {
+namespace internal {
+
+/**
+ * Reads a free-running, constant-rate counter directly from the CPU: the TSC
+ * on x86 and the virtual counter (cntvct_el0) on AArch64. This is
+ * considerably cheaper than a call through the PAL. Falls back to
+ * et_pal_current_ticks() on other targets.
+ */
+inline uint64_t read_cycle_counter() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t value;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+  return value;
+#else
+  return et_pal_current_ticks();
+#endif
+}
+
+/**
+ * Returns the frequency of read_cycle_counter() in Hz if the hardware reports
+ * it, or 0 if it must be calibrated.
+ */
+inline uint64_t cycle_counter_frequency() {
+#if defined(__aarch64__)
+  uint64_t frequency;
+  asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+  return frequency;
+#else
+  return 0;
+#endif
+}
+
+} // namespace internal
+} // namespace sampling_tracer
+} // namespace executorch
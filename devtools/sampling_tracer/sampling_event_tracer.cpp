@@ -0,0 +1,518 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/devtools/sampling_tracer/sampling_event_tracer.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <executorch/devtools/sampling_tracer/cycle_counter.h>
+#include <executorch/runtime/platform/assert.h>
+#include <executorch/runtime/platform/platform.h>
+
+using ::executorch::aten::Tensor;
+using ::executorch::etdump::DataSinkBase;
+using ::executorch::runtime::AllocatorID;
+using ::executorch::runtime::ArrayRef;
+using ::executorch::runtime::ChainID;
+using ::executorch::runtime::DebugHandle;
+using ::executorch::runtime::DelegateDebugIdType;
+using ::executorch::runtime::DelegateDebugIntId;
+using ::executorch::runtime::Error;
+using ::executorch::runtime::EValue;
+using ::executorch::runtime::EventTracerEntry;
+using ::executorch::runtime::EventTracerFilterBase;
+using ::executorch::runtime::kUnsetDelegateDebugIntId;
+using ::executorch::runtime::LoggedEValueType;
+using ::executorch::runtime::Result;
+
+namespace executorch {
+namespace sampling_tracer {
+namespace internal {
+
+size_t LatencyHistogram::bucket_index(uint64_t value) {
+  if (value < kSubBuckets) {
+    return static_cast<size_t>(value);
+  }
+  size_t msb = 63 - __builtin_clzll(value);
+  if (msb >= kMaxBits) {
+    return kNumBuckets - 1;
+  }
+  size_t shift = msb - kSubBucketBits;
+  size_t sub_bucket = (value >> shift) & (kSubBuckets - 1);
+  return (msb - kSubBucketBits + 1) * kSubBuckets + sub_bucket;
+}
+
+uint64_t LatencyHistogram::bucket_lower_bound(size_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  size_t msb = index / kSubBuckets + kSubBucketBits - 1;
+  uint64_t sub_bucket = index % kSubBuckets;
+  return (kSubBuckets + sub_bucket) << (msb - kSubBucketBits);
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(size_t index) {
+  if (index + 1 >= kNumBuckets) {
+    return UINT64_MAX;
+  }
+  return bucket_lower_bound(index + 1) - 1;
+}
+
+void LatencyHistogram::add(uint64_t value) {
+  ++buckets_[bucket_index(value)];
+  ++count_;
+  sum_ += value;
+  if (value < min_) {
+    min_ = value;
+  }
+  if (value > max_) {
+    max_ = value;
+  }
+}
+
+void LatencyHistogram::clear() {
+  memset(buckets_, 0, sizeof(buckets_));
+  count_ = 0;
+  sum_ = 0;
+  min_ = UINT64_MAX;
+  max_ = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  // Rank of the requested sample, 1-based.
+  uint64_t rank = static_cast<uint64_t>(p / 100.0 * count_ + 0.5);
+  if (rank < 1) {
+    rank = 1;
+  } else if (rank > count_) {
+    rank = count_;
+  }
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      // Report the middle of the bucket, clamped to the observed range.
+      uint64_t lower = bucket_lower_bound(i);
+      uint64_t upper = bucket_upper_bound(i);
+      uint64_t value = upper == UINT64_MAX ? max_ : lower + (upper - lower) / 2;
+      if (value < min_) {
+        value = min_;
+      }
+      if (value > max_) {
+        value = max_;
+      }
+      return value;
+    }
+  }
+  return max_;
+}
+
+} // namespace internal
+
+namespace {
+
+// Marks an EventTracerEntry whose event was not sampled.
+constexpr int64_t kNotSampled = -1;
+
+uint64_t hash_name(const char* name) {
+  // FNV-1a over the (possibly truncated) name.
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < kMaxOperatorNameLength - 1 && name[i] != '\0'; ++i) {
+    hash ^= static_cast<uint8_t>(name[i]);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+bool name_equals(const char* stored, const char* name) {
+  return strncmp(stored, name, kMaxOperatorNameLength - 1) == 0;
+}
+
+double calibrate_ns_per_cycle() {
+  uint64_t frequency = internal::cycle_counter_frequency();
+  if (frequency != 0) {
+    return 1e9 / static_cast<double>(frequency);
+  }
+  et_tick_ratio_t ratio = runtime::pal_ticks_to_ns_multiplier();
+#if ET_HAS_CYCLE_COUNTER
+  // Measure the counter against the PAL clock for about a millisecond.
+  constexpr uint64_t kCalibrationNs = 1000 * 1000;
+  const et_timestamp_t start_ticks = runtime::pal_current_ticks();
+  const uint64_t start_cycles = internal::read_cycle_counter();
+  uint64_t elapsed_ns = 0;
+  uint64_t end_cycles = start_cycles;
+  while (elapsed_ns < kCalibrationNs) {
+    end_cycles = internal::read_cycle_counter();
+    elapsed_ns = static_cast<uint64_t>(
+                     runtime::pal_current_ticks() - start_ticks) *
+        ratio.numerator / ratio.denominator;
+  }
+  if (end_cycles > start_cycles) {
+    return static_cast<double>(elapsed_ns) /
+        static_cast<double>(end_cycles - start_cycles);
+  }
+#endif
+  // read_cycle_counter() falls back to PAL ticks.
+  return static_cast<double>(ratio.numerator) /
+      static_cast<double>(ratio.denominator);
+}
+
+} // namespace
+
+SamplingEventTracer::SamplingEventTracer(SamplingConfig config)
+    : config_(config), rng_state_(config.seed != 0 ? config.seed : 1) {
+  ET_CHECK_MSG(
+      config_.sample_every_n_executions > 0,
+      "sample_every_n_executions must be positive");
+  ET_CHECK_MSG(
+      config_.event_sample_rate >= 0.0 && config_.event_sample_rate <= 1.0,
+      "event_sample_rate must be in [0, 1]");
+  ET_CHECK_MSG(config_.max_operators > 0, "max_operators must be positive");
+
+  event_sample_threshold_ = config_.event_sample_rate >= 1.0
+      ? UINT64_MAX
+      : static_cast<uint64_t>(
+            config_.event_sample_rate * 18446744073709551616.0 /* 2^64 */);
+
+  operators_ = static_cast<OperatorEntry*>(
+      malloc(config_.max_operators * sizeof(OperatorEntry)));
+  // Keep the hash table at most half full.
+  table_size_ = 1;
+  while (table_size_ < 2 * config_.max_operators) {
+    table_size_ *= 2;
+  }
+  table_ = static_cast<int32_t*>(malloc(table_size_ * sizeof(int32_t)));
+  ET_CHECK_MSG(
+      operators_ != nullptr && table_ != nullptr,
+      "Failed to allocate the operator table of SamplingEventTracer");
+  reset();
+
+  ns_per_cycle_ = calibrate_ns_per_cycle();
+}
+
+SamplingEventTracer::~SamplingEventTracer() {
+  free(operators_);
+  free(table_);
+}
+
+void SamplingEventTracer::reset() {
+  num_operators_ = 0;
+  for (size_t i = 0; i < table_size_; ++i) {
+    table_[i] = -1;
+  }
+  num_executions_ = 0;
+  num_sampled_executions_ = 0;
+  num_dropped_events_ = 0;
+  execution_sampled_ = true;
+}
+
+void SamplingEventTracer::create_event_block(const char* name) {
+  (void)name;
+  execution_sampled_ =
+      num_executions_ % config_.sample_every_n_executions == 0;
+  ++num_executions_;
+  if (execution_sampled_) {
+    ++num_sampled_executions_;
+  }
+}
+
+bool SamplingEventTracer::sample_event() {
+  if (!execution_sampled_) {
+    return false;
+  }
+  if (event_sample_threshold_ == UINT64_MAX) {
+    return true;
+  }
+  // xorshift64*
+  rng_state_ ^= rng_state_ >> 12;
+  rng_state_ ^= rng_state_ << 25;
+  rng_state_ ^= rng_state_ >> 27;
+  return rng_state_ * 0x2545f4914f6cdd1dULL < event_sample_threshold_;
+}
+
+int64_t SamplingEventTracer::find_or_insert_operator(const char* name) {
+  if (name == nullptr) {
+    name = "";
+  }
+  const uint64_t hash = hash_name(name);
+  const size_t mask = table_size_ - 1;
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    int32_t index = table_[slot];
+    if (index < 0) {
+      if (num_operators_ == config_.max_operators) {
+        return kNotSampled;
+      }
+      OperatorEntry* entry = new (&operators_[num_operators_]) OperatorEntry();
+      strncpy(entry->name, name, kMaxOperatorNameLength - 1);
+      entry->name[kMaxOperatorNameLength - 1] = '\0';
+      entry->hash = hash;
+      table_[slot] = static_cast<int32_t>(num_operators_);
+      return static_cast<int64_t>(num_operators_++);
+    }
+    const OperatorEntry& entry = operators_[index];
+    if (entry.hash == hash && name_equals(entry.name, name)) {
+      return index;
+    }
+  }
+}
+
+int64_t SamplingEventTracer::find_or_insert_delegate(
+    const char* name,
+    DelegateDebugIntId delegate_debug_index) {
+  if (delegate_debug_index == kUnsetDelegateDebugIntId) {
+    return find_or_insert_operator(name);
+  }
+  char delegate_name[kMaxOperatorNameLength];
+  snprintf(
+      delegate_name,
+      sizeof(delegate_name),
+      "delegate_%" PRId32,
+      delegate_debug_index);
+  return find_or_insert_operator(delegate_name);
+}
+
+uint64_t SamplingEventTracer::cycles_to_ns(uint64_t cycles) const {
+  return static_cast<uint64_t>(static_cast<double>(cycles) * ns_per_cycle_);
+}
+
+void SamplingEventTracer::record(int64_t op_index, uint64_t duration_ns) {
+  if (op_index == kNotSampled) {
+    ++num_dropped_events_;
+    return;
+  }
+  operators_[op_index].histogram.add(duration_ns);
+}
+
+EventTracerEntry SamplingEventTracer::start_profiling(
+    const char* name,
+    ChainID chain_id,
+    DebugHandle debug_handle) {
+  EventTracerEntry prof_entry;
+  prof_entry.delegate_event_id_type = DelegateDebugIdType::kNone;
+  prof_entry.chain_id = chain_id == -1 ? chain_id_ : chain_id;
+  prof_entry.debug_handle = chain_id == -1 ? debug_handle_ : debug_handle;
+  if (!sample_event()) {
+    prof_entry.event_id = kNotSampled;
+    prof_entry.start_time = 0;
+    return prof_entry;
+  }
+  // Resolve the operator before reading the counter so that the lookup is
+  // not part of the measured duration.
+  int64_t op_index = find_or_insert_operator(name);
+  if (op_index == kNotSampled) {
+    ++num_dropped_events_;
+  }
+  prof_entry.event_id = op_index;
+  prof_entry.start_time = internal::read_cycle_counter();
+  return prof_entry;
+}
+
+void SamplingEventTracer::end_profiling(EventTracerEntry prof_entry) {
+  if (prof_entry.event_id == kNotSampled) {
+    return;
+  }
+  const uint64_t end_time = internal::read_cycle_counter();
+  record(prof_entry.event_id, cycles_to_ns(end_time - prof_entry.start_time));
+}
+
+EventTracerEntry SamplingEventTracer::start_profiling_delegate(
+    const char* name,
+    DelegateDebugIntId delegate_debug_index) {
+  EventTracerEntry prof_entry;
+  prof_entry.delegate_event_id_type = delegate_debug_index ==
+          kUnsetDelegateDebugIntId
+      ? DelegateDebugIdType::kStr
+      : DelegateDebugIdType::kInt;
+  prof_entry.chain_id = chain_id_;
+  prof_entry.debug_handle = debug_handle_;
+  if (!sample_event()) {
+    prof_entry.event_id = kNotSampled;
+    prof_entry.start_time = 0;
+    return prof_entry;
+  }
+  int64_t op_index = find_or_insert_delegate(name, delegate_debug_index);
+  if (op_index == kNotSampled) {
+    ++num_dropped_events_;
+  }
+  prof_entry.event_id = op_index;
+  prof_entry.start_time = internal::read_cycle_counter();
+  return prof_entry;
+}
+
+void SamplingEventTracer::end_profiling_delegate(
+    EventTracerEntry prof_entry,
+    const void* metadata,
+    size_t metadata_len) {
+  (void)metadata;
+  (void)metadata_len;
+  end_profiling(prof_entry);
+}
+
+void SamplingEventTracer::log_profiling_delegate(
+    const char* name,
+    DelegateDebugIntId delegate_debug_index,
+    et_timestamp_t start_time,
+    et_timestamp_t end_time,
+    const void* metadata,
+    size_t metadata_len) {
+  (void)metadata;
+  (void)metadata_len;
+  if (!sample_event()) {
+    return;
+  }
+  // These timestamps come from the delegate in PAL ticks.
+  et_tick_ratio_t ratio = runtime::pal_ticks_to_ns_multiplier();
+  uint64_t duration_ns = static_cast<uint64_t>(end_time - start_time) *
+      ratio.numerator / ratio.denominator;
+  record(find_or_insert_delegate(name, delegate_debug_index), duration_ns);
+}
+
+void SamplingEventTracer::track_allocation(AllocatorID id, size_t size) {
+  (void)id;
+  (void)size;
+}
+
+AllocatorID SamplingEventTracer::track_allocator(const char* name) {
+  (void)name;
+  return 0;
+}
+
+Result<bool> SamplingEventTracer::log_evalue(
+    const EValue& evalue,
+    LoggedEValueType evalue_type) {
+  (void)evalue;
+  (void)evalue_type;
+  return false;
+}
+
+Result<bool> SamplingEventTracer::log_intermediate_output_delegate(
+    const char* name,
+    DelegateDebugIntId delegate_debug_index,
+    const Tensor& output) {
+  (void)name;
+  (void)delegate_debug_index;
+  (void)output;
+  return false;
+}
+
+Result<bool> SamplingEventTracer::log_intermediate_output_delegate(
+    const char* name,
+    DelegateDebugIntId delegate_debug_index,
+    const ArrayRef<Tensor> output) {
+  (void)name;
+  (void)delegate_debug_index;
+  (void)output;
+  return false;
+}
+
+Result<bool> SamplingEventTracer::log_intermediate_output_delegate(
+    const char* name,
+    DelegateDebugIntId delegate_debug_index,
+    const int& output) {
+  (void)name;
+  (void)delegate_debug_index;
+  (void)output;
+  return false;
+}
+
+Result<bool> SamplingEventTracer::log_intermediate_output_delegate(
+    const char* name,
+    DelegateDebugIntId delegate_debug_index,
+    const bool& output) {
+  (void)name;
+  (void)delegate_debug_index;
+  (void)output;
+  return false;
+}
+
+Result<bool> SamplingEventTracer::log_intermediate_output_delegate(
+    const char* name,
+    DelegateDebugIntId delegate_debug_index,
+    const double& output) {
+  (void)name;
+  (void)delegate_debug_index;
+  (void)output;
+  return false;
+}
+
+void SamplingEventTracer::set_delegation_intermediate_output_filter(
+    EventTracerFilterBase* event_tracer_filter) {
+  (void)event_tracer_filter;
+}
+
+size_t SamplingEventTracer::get_num_operators() const {
+  return num_operators_;
+}
+
+OperatorStats SamplingEventTracer::get_operator_stats(size_t index) const {
+  ET_CHECK_MSG(
+      index < num_operators_,
+      "Operator index %zu out of range %zu",
+      index,
+      num_operators_);
+  const internal::LatencyHistogram& histogram = operators_[index].histogram;
+  OperatorStats stats;
+  stats.name = operators_[index].name;
+  stats.count = histogram.count();
+  stats.total_ns = histogram.sum();
+  stats.min_ns = histogram.min();
+  stats.p50_ns = histogram.percentile(50);
+  stats.p90_ns = histogram.percentile(90);
+  stats.p99_ns = histogram.percentile(99);
+  stats.max_ns = histogram.max();
+  return stats;
+}
+
+Result<size_t> SamplingEventTracer::export_csv(DataSinkBase* sink) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      sink != nullptr, InvalidArgument, "Sink must not be null");
+  static const char kHeader[] =
+      "name,count,total_ns,min_ns,p50_ns,p90_ns,p99_ns,max_ns\n";
+  Result<size_t> header_ret = sink->write(kHeader, sizeof(kHeader) - 1);
+  if (!header_ret.ok()) {
+    return header_ret.error();
+  }
+  size_t written = sizeof(kHeader) - 1;
+  for (size_t i = 0; i < num_operators_; ++i) {
+    OperatorStats stats = get_operator_stats(i);
+    char line[kMaxOperatorNameLength + 8 * 21];
+    int len = snprintf(
+        line,
+        sizeof(line),
+        "%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+        ",%" PRIu64 ",%" PRIu64 "\n",
+        stats.name,
+        stats.count,
+        stats.total_ns,
+        stats.min_ns,
+        stats.p50_ns,
+        stats.p90_ns,
+        stats.p99_ns,
+        stats.max_ns);
+    ET_CHECK_OR_RETURN_ERROR(
+        len > 0 && static_cast<size_t>(len) < sizeof(line),
+        Internal,
+        "Failed to format statistics of %s",
+        stats.name);
+    Result<size_t> ret = sink->write(line, static_cast<size_t>(len));
+    if (!ret.ok()) {
+      return ret.error();
+    }
+    written += static_cast<size_t>(len);
+  }
+  return written;
+}
+
+} // namespace sampling_tracer
+} // namespace executorch
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <executorch/devtools/etdump/data_sinks/data_sink_base.h>
+#include <executorch/runtime/core/event_tracer.h>
+#include <executorch/runtime/core/result.h>
+
+namespace executorch {
+namespace sampling_tracer {
+
+/// Maximum number of bytes (including the terminating null) of an operator
+/// name that is kept. Longer names are truncated.
+constexpr size_t kMaxOperatorNameLength = 64;
+
+namespace internal {
+
+/**
+ * Log-linear latency histogram: values below 8ns are counted exactly, larger
+ * values fall in one of 8 equally sized sub-buckets per power of two, so the
+ * relative error of a reported percentile is below 1/8.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr size_t kSubBucketBits = 3;
+  static constexpr size_t kSubBuckets = 1 << kSubBucketBits;
+  /// Values at or above 2^kMaxBits ns (about 2.4 hours) share the last bucket.
+  static constexpr size_t kMaxBits = 43;
+  static constexpr size_t kNumBuckets =
+      kSubBuckets + (kMaxBits - kSubBucketBits) * kSubBuckets;
+
+  static size_t bucket_index(uint64_t value);
+  static uint64_t bucket_lower_bound(size_t index);
+  static uint64_t bucket_upper_bound(size_t index);
+
+  void add(uint64_t value);
+  void clear();
+
+  /// Returns the value at percentile `p` in [0, 100], or 0 if empty.
+  uint64_t percentile(double p) const;
+
+  uint64_t count() const {
+    return count_;
+  }
+  uint64_t sum() const {
+    return sum_;
+  }
+  uint64_t min() const {
+    return count_ == 0 ? 0 : min_;
+  }
+  uint64_t max() const {
+    return max_;
+  }
+
+ private:
+  uint32_t buckets_[kNumBuckets] = {};
+  uint64_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t min_ = UINT64_MAX;
+  uint64_t max_ = 0;
+};
+
+} // namespace internal
+
+/**
+ * Configuration of a SamplingEventTracer.
+ */
+struct SamplingConfig {
+  /// Only every Nth execution (event block) is profiled. 1 profiles all.
+  size_t sample_every_n_executions = 1;
+
+  /// Fraction in [0, 1] of the profiling events of a sampled execution that
+  /// are recorded, chosen pseudo-randomly.
+  double event_sample_rate = 1.0;
+
+  /// Maximum number of distinct operator names that are aggregated. Events
+  /// of further operators are counted by get_num_dropped_events().
+  size_t max_operators = 256;
+
+  /// Seed of the pseudo-random event sampler.
+  uint64_t seed = 0x9e3779b97f4a7c15ULL;
+};
+
+/**
+ * Aggregated latency statistics of one operator, in nanoseconds.
+ */
+struct OperatorStats {
+  const char* name;
+  uint64_t count;
+  uint64_t total_ns;
+  uint64_t min_ns;
+  uint64_t p50_ns;
+  uint64_t p90_ns;
+  uint64_t p99_ns;
+  uint64_t max_ns;
+};
+
+/**
+ * A low-overhead EventTracer that is meant to be left enabled in production.
+ *
+ * Unlike ETDumpGen it does not keep individual events. It only profiles a
+ * subset of executions and/or events (see SamplingConfig), timestamps them
+ * with the CPU cycle counter where one is available (see cycle_counter.h)
+ * and folds the durations into per-operator latency histograms from which
+ * percentiles can be queried or exported at any time.
+ *
+ * Debug events (evalues, intermediate outputs) and allocation events are
+ * ignored. Not thread-safe: all events must be logged from one thread at a
+ * time.
+ */
+class SamplingEventTracer : public ::executorch::runtime::EventTracer {
+ public:
+  explicit SamplingEventTracer(SamplingConfig config = SamplingConfig());
+  ~SamplingEventTracer() override;
+
+  SamplingEventTracer(const SamplingEventTracer&) = delete;
+  SamplingEventTracer& operator=(const SamplingEventTracer&) = delete;
+
+  void create_event_block(const char* name) override;
+  ::executorch::runtime::EventTracerEntry start_profiling(
+      const char* name,
+      ::executorch::runtime::ChainID chain_id = -1,
+      ::executorch::runtime::DebugHandle debug_handle = 0) override;
+  void end_profiling(
+      ::executorch::runtime::EventTracerEntry prof_entry) override;
+  ::executorch::runtime::EventTracerEntry start_profiling_delegate(
+      const char* name,
+      ::executorch::runtime::DelegateDebugIntId delegate_debug_index) override;
+  void end_profiling_delegate(
+      ::executorch::runtime::EventTracerEntry prof_entry,
+      const void* metadata,
+      size_t metadata_len) override;
+  void log_profiling_delegate(
+      const char* name,
+      ::executorch::runtime::DelegateDebugIntId delegate_debug_index,
+      et_timestamp_t start_time,
+      et_timestamp_t end_time,
+      const void* metadata,
+      size_t metadata_len) override;
+  void track_allocation(::executorch::runtime::AllocatorID id, size_t size)
+      override;
+  ::executorch::runtime::AllocatorID track_allocator(const char* name) override;
+  ::executorch::runtime::Result<bool> log_evalue(
+      const ::executorch::runtime::EValue& evalue,
+      ::executorch::runtime::LoggedEValueType evalue_type) override;
+  ::executorch::runtime::Result<bool> log_intermediate_output_delegate(
+      const char* name,
+      ::executorch::runtime::DelegateDebugIntId delegate_debug_index,
+      const executorch::aten::Tensor& output) override;
+  ::executorch::runtime::Result<bool> log_intermediate_output_delegate(
+      const char* name,
+      ::executorch::runtime::DelegateDebugIntId delegate_debug_index,
+      const ::executorch::runtime::ArrayRef<executorch::aten::Tensor> output)
+      override;
+  ::executorch::runtime::Result<bool> log_intermediate_output_delegate(
+      const char* name,
+      ::executorch::runtime::DelegateDebugIntId delegate_debug_index,
+      const int& output) override;
+  ::executorch::runtime::Result<bool> log_intermediate_output_delegate(
+      const char* name,
+      ::executorch::runtime::DelegateDebugIntId delegate_debug_index,
+      const bool& output) override;
+  ::executorch::runtime::Result<bool> log_intermediate_output_delegate(
+      const char* name,
+      ::executorch::runtime::DelegateDebugIntId delegate_debug_index,
+      const double& output) override;
+  void set_delegation_intermediate_output_filter(
+      ::executorch::runtime::EventTracerFilterBase* event_tracer_filter)
+      override;
+
+  /// Number of distinct operators with at least one recorded event.
+  size_t get_num_operators() const;
+
+  /// Statistics of the operator at `index` < get_num_operators().
+  OperatorStats get_operator_stats(size_t index) const;
+
+  /// Number of executions (event blocks) seen and profiled so far.
+  size_t get_num_executions() const {
+    return num_executions_;
+  }
+  size_t get_num_sampled_executions() const {
+    return num_sampled_executions_;
+  }
+
+  /// Number of events that were sampled but could not be aggregated because
+  /// the operator table was full.
+  size_t get_num_dropped_events() const {
+    return num_dropped_events_;
+  }
+
+  /**
+   * Writes the statistics of every operator to `sink` as CSV with the header
+   * `name,count,total_ns,min_ns,p50_ns,p90_ns,p99_ns,max_ns`.
+   *
+   * @returns The number of bytes written, or an error from the sink.
+   */
+  ::executorch::runtime::Result<size_t> export_csv(
+      ::executorch::etdump::DataSinkBase* sink) const;
+
+  /// Clears all aggregated statistics and counters.
+  void reset();
+
+ private:
+  struct OperatorEntry {
+    char name[kMaxOperatorNameLength];
+    uint64_t hash;
+    internal::LatencyHistogram histogram;
+  };
+
+  bool sample_event();
+  int64_t find_or_insert_operator(const char* name);
+  int64_t find_or_insert_delegate(
+      const char* name,
+      ::executorch::runtime::DelegateDebugIntId delegate_debug_index);
+  void record(int64_t op_index, uint64_t duration_ns);
+  uint64_t cycles_to_ns(uint64_t cycles) const;
+
+  SamplingConfig config_;
+  uint64_t event_sample_threshold_;
+  uint64_t rng_state_;
+  bool execution_sampled_ = true;
+  size_t num_executions_ = 0;
+  size_t num_sampled_executions_ = 0;
+  size_t num_dropped_events_ = 0;
+
+  // Open-addressed hash table of operators, with `table_size_` slots holding
+  // indices into `operators_` (-1 when empty).
+  OperatorEntry* operators_ = nullptr;
+  size_t num_operators_ = 0;
+  int32_t* table_ = nullptr;
+  size_t table_size_ = 0;
+
+  // Conversion factor from read_cycle_counter() to nanoseconds.
+  double ns_per_cycle_ = 1.0;
+};
+
+} // namespace sampling_tracer
+} // namespace executorch
@@ -0,0 +1,29 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "get_aten_mode_options", "runtime")
+
+def define_common_targets():
+    """Defines targets that should be shared between fbcode and xplat.
+
+    The directory containing this targets.bzl file should also contain both
+    TARGETS and BUCK files that call this function.
+    """
+    for aten_mode in get_aten_mode_options():
+        aten_suffix = "_aten" if aten_mode else ""
+
+        runtime.cxx_library(
+            name = "sampling_event_tracer" + aten_suffix,
+            srcs = [
+                "sampling_event_tracer.cpp",
+            ],
+            exported_headers = [
+                "cycle_counter.h",
+                "sampling_event_tracer.h",
+            ],
+            deps = [
+                "//executorch/runtime/platform:platform",
+            ],
+            exported_deps = [
+                "//executorch/devtools/etdump/data_sinks:data_sink_base" + aten_suffix,
+                "//executorch/runtime/core:event_tracer" + aten_suffix,
+            ],
+            visibility = ["PUBLIC"],
+        )
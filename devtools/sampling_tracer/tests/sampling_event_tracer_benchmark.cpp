@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Compares the per-event cost of operator profiling with SamplingEventTracer
+// against full ETDumpGen tracing and against no tracer at all. Each benchmark
+// iteration logs one start_profiling()/end_profiling() pair; a new event block
+// is started every 1000 events to mimic repeated Method::execute() calls.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+
+#include <executorch/devtools/etdump/etdump_flatcc.h>
+#include <executorch/devtools/sampling_tracer/sampling_event_tracer.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using ::executorch::etdump::ETDumpGen;
+using ::executorch::etdump::ETDumpResult;
+using ::executorch::runtime::EventTracer;
+using ::executorch::runtime::EventTracerEntry;
+using ::executorch::sampling_tracer::SamplingConfig;
+using ::executorch::sampling_tracer::SamplingEventTracer;
+
+namespace {
+
+constexpr size_t kEventsPerBlock = 1000;
+
+// Logs events the way the executor hooks do, so that the null tracer case
+// measures the cost of the surrounding loop alone.
+void log_events(
+    benchmark::State& state,
+    EventTracer* event_tracer,
+    ETDumpGen* etdump_gen = nullptr) {
+  size_t events = 0;
+  if (event_tracer != nullptr) {
+    event_tracer->create_event_block("Execute");
+  }
+  for (auto _ : state) {
+    if (event_tracer != nullptr) {
+      EventTracerEntry entry =
+          event_tracer->start_profiling("native_call_add.out");
+      event_tracer->end_profiling(entry);
+    }
+    benchmark::ClobberMemory();
+    if (++events % kEventsPerBlock == 0 && event_tracer != nullptr) {
+      if (etdump_gen != nullptr) {
+        // Bound the in-memory buffer the way a caller would: dump and start
+        // over. This is excluded from the measurement.
+        state.PauseTiming();
+        ETDumpResult result = etdump_gen->get_etdump_data();
+        free(result.buf);
+        etdump_gen->reset();
+        state.ResumeTiming();
+      }
+      event_tracer->create_event_block("Execute");
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_NoEventTracer(benchmark::State& state) {
+  log_events(state, nullptr);
+}
+
+void BM_ETDumpGen(benchmark::State& state) {
+  ETDumpGen etdump_gen;
+  log_events(state, &etdump_gen, &etdump_gen);
+}
+
+// Arguments: sample every Nth execution, event sample rate in percent.
+void BM_SamplingEventTracer(benchmark::State& state) {
+  SamplingConfig config;
+  config.sample_every_n_executions = state.range(0);
+  config.event_sample_rate = state.range(1) / 100.0;
+  SamplingEventTracer tracer(config);
+  log_events(state, &tracer);
+  state.counters["p50_ns"] = tracer.get_num_operators() > 0
+      ? tracer.get_operator_stats(0).p50_ns
+      : 0;
+}
+
+BENCHMARK(BM_NoEventTracer);
+BENCHMARK(BM_ETDumpGen);
+BENCHMARK(BM_SamplingEventTracer)
+    ->Args({1, 100})
+    ->Args({1, 10})
+    ->Args({10, 100})
+    ->Args({100, 100});
+
+// Make sure the PAL is initialized before the first tick is read.
+const bool runtime_initialized = [] {
+  executorch::runtime::runtime_init();
+  return true;
+}();
+
+} // namespace
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstring>
+#include <string>
+
+#include <executorch/devtools/sampling_tracer/sampling_event_tracer.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gtest/gtest.h>
+
+using ::executorch::etdump::DataSinkBase;
+using ::executorch::runtime::Error;
+using ::executorch::runtime::EventTracerEntry;
+using ::executorch::runtime::Result;
+using ::executorch::sampling_tracer::OperatorStats;
+using ::executorch::sampling_tracer::SamplingConfig;
+using ::executorch::sampling_tracer::SamplingEventTracer;
+using ::executorch::sampling_tracer::internal::LatencyHistogram;
+
+namespace {
+
+class StringDataSink : public DataSinkBase {
+ public:
+  Result<size_t> write(const void* ptr, size_t length) override {
+    size_t offset = data_.size();
+    data_.append(static_cast<const char*>(ptr), length);
+    return offset;
+  }
+  size_t get_used_bytes() const override {
+    return data_.size();
+  }
+  const std::string& data() const {
+    return data_;
+  }
+
+ private:
+  std::string data_;
+};
+
+// Returns the index of the operator called `name`, or -1.
+int find_operator(const SamplingEventTracer& tracer, const char* name) {
+  for (size_t i = 0; i < tracer.get_num_operators(); ++i) {
+    if (strcmp(tracer.get_operator_stats(i).name, name) == 0) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void run_execution(SamplingEventTracer& tracer, size_t num_ops) {
+  tracer.create_event_block("Execute");
+  for (size_t i = 0; i < num_ops; ++i) {
+    EventTracerEntry entry =
+        tracer.start_profiling(i % 2 == 0 ? "op_add" : "op_mul", 0, i);
+    tracer.end_profiling(entry);
+  }
+}
+
+} // namespace
+
+class SamplingEventTracerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+  }
+};
+
+TEST(LatencyHistogramTest, BucketBoundsCoverValues) {
+  const uint64_t values[] = {0, 1, 7, 8, 9, 15, 16, 17, 1000, 123456789};
+  for (uint64_t value : values) {
+    size_t index = LatencyHistogram::bucket_index(value);
+    EXPECT_LE(LatencyHistogram::bucket_lower_bound(index), value);
+    EXPECT_GE(LatencyHistogram::bucket_upper_bound(index), value);
+  }
+  EXPECT_EQ(
+      LatencyHistogram::bucket_index(UINT64_MAX),
+      LatencyHistogram::kNumBuckets - 1);
+}
+
+TEST(LatencyHistogramTest, Percentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.percentile(50), 0);
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    histogram.add(i * 1000);
+  }
+  EXPECT_EQ(histogram.count(), 1000);
+  EXPECT_EQ(histogram.min(), 1000);
+  EXPECT_EQ(histogram.max(), 1000 * 1000);
+  // Percentiles are exact up to the width of a bucket (1/8 relative).
+  EXPECT_NEAR(histogram.percentile(50), 500 * 1000, 500 * 1000 / 8);
+  EXPECT_NEAR(histogram.percentile(99), 990 * 1000, 990 * 1000 / 8);
+  EXPECT_EQ(histogram.percentile(100), 1000 * 1000);
+  EXPECT_EQ(histogram.percentile(0), 1000);
+
+  histogram.clear();
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.min(), 0);
+}
+
+TEST_F(SamplingEventTracerTest, AggregatesPerOperator) {
+  SamplingEventTracer tracer;
+  for (int i = 0; i < 10; ++i) {
+    run_execution(tracer, 4);
+  }
+  EXPECT_EQ(tracer.get_num_executions(), 10);
+  EXPECT_EQ(tracer.get_num_sampled_executions(), 10);
+  ASSERT_EQ(tracer.get_num_operators(), 2);
+
+  int add = find_operator(tracer, "op_add");
+  int mul = find_operator(tracer, "op_mul");
+  ASSERT_GE(add, 0);
+  ASSERT_GE(mul, 0);
+  OperatorStats stats = tracer.get_operator_stats(add);
+  EXPECT_EQ(stats.count, 20);
+  EXPECT_LE(stats.min_ns, stats.p50_ns);
+  EXPECT_LE(stats.p50_ns, stats.p99_ns);
+  EXPECT_LE(stats.p99_ns, stats.max_ns);
+  EXPECT_EQ(tracer.get_operator_stats(mul).count, 20);
+}
+
+TEST_F(SamplingEventTracerTest, SamplesEveryNthExecution) {
+  SamplingConfig config;
+  config.sample_every_n_executions = 4;
+  SamplingEventTracer tracer(config);
+  for (int i = 0; i < 10; ++i) {
+    run_execution(tracer, 2);
+  }
+  EXPECT_EQ(tracer.get_num_executions(), 10);
+  // Executions 0, 4 and 8.
+  EXPECT_EQ(tracer.get_num_sampled_executions(), 3);
+  int add = find_operator(tracer, "op_add");
+  ASSERT_GE(add, 0);
+  EXPECT_EQ(tracer.get_operator_stats(add).count, 3);
+}
+
+TEST_F(SamplingEventTracerTest, SamplesFractionOfEvents) {
+  SamplingConfig config;
+  config.event_sample_rate = 0.25;
+  SamplingEventTracer tracer(config);
+  run_execution(tracer, 8000);
+  uint64_t total = 0;
+  for (size_t i = 0; i < tracer.get_num_operators(); ++i) {
+    total += tracer.get_operator_stats(i).count;
+  }
+  EXPECT_GT(total, 1500);
+  EXPECT_LT(total, 2500);
+
+  config.event_sample_rate = 0.0;
+  SamplingEventTracer none(config);
+  run_execution(none, 100);
+  EXPECT_EQ(none.get_num_operators(), 0);
+}
+
+TEST_F(SamplingEventTracerTest, DelegateEvents) {
+  SamplingEventTracer tracer;
+  tracer.create_event_block("Execute");
+  EventTracerEntry entry = tracer.start_profiling_delegate(
+      "conv", executorch::runtime::kUnsetDelegateDebugIntId);
+  tracer.end_profiling_delegate(entry, nullptr, 0);
+  entry = tracer.start_profiling_delegate(nullptr, 7);
+  tracer.end_profiling_delegate(entry, nullptr, 0);
+  tracer.log_profiling_delegate(nullptr, 7, 100, 300, nullptr, 0);
+
+  int conv = find_operator(tracer, "conv");
+  int delegate = find_operator(tracer, "delegate_7");
+  ASSERT_GE(conv, 0);
+  ASSERT_GE(delegate, 0);
+  EXPECT_EQ(tracer.get_operator_stats(conv).count, 1);
+  EXPECT_EQ(tracer.get_operator_stats(delegate).count, 2);
+}
+
+TEST_F(SamplingEventTracerTest, DropsEventsWhenTableIsFull) {
+  SamplingConfig config;
+  config.max_operators = 2;
+  SamplingEventTracer tracer(config);
+  tracer.create_event_block("Execute");
+  const char* names[] = {"a", "b", "c", "a", "d"};
+  for (const char* name : names) {
+    tracer.end_profiling(tracer.start_profiling(name));
+  }
+  EXPECT_EQ(tracer.get_num_operators(), 2);
+  EXPECT_EQ(tracer.get_num_dropped_events(), 2);
+  EXPECT_EQ(tracer.get_operator_stats(find_operator(tracer, "a")).count, 2);
+
+  tracer.reset();
+  EXPECT_EQ(tracer.get_num_operators(), 0);
+  EXPECT_EQ(tracer.get_num_dropped_events(), 0);
+}
+
+TEST_F(SamplingEventTracerTest, ExportCsv) {
+  SamplingEventTracer tracer;
+  run_execution(tracer, 4);
+  StringDataSink sink;
+  Result<size_t> written = tracer.export_csv(&sink);
+  ASSERT_EQ(written.error(), Error::Ok);
+  EXPECT_EQ(written.get(), sink.data().size());
+
+  const std::string& csv = sink.data();
+  EXPECT_EQ(
+      csv.find("name,count,total_ns,min_ns,p50_ns,p90_ns,p99_ns,max_ns\n"), 0);
+  EXPECT_NE(csv.find("\nop_add,2,"), std::string::npos);
+  EXPECT_NE(csv.find("\nop_mul,2,"), std::string::npos);
+
+  EXPECT_EQ(tracer.export_csv(nullptr).error(), Error::InvalidArgument);
+}
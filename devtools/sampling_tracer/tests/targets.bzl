@@ -0,0 +1,32 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
+
+def define_common_targets():
+    """Defines targets that should be shared between fbcode and xplat.
+
+    The directory containing this targets.bzl file should also contain both
+    TARGETS and BUCK files that call this function.
+    """
+
+    runtime.cxx_test(
+        name = "sampling_event_tracer_test",
+        srcs = [
+            "sampling_event_tracer_test.cpp",
+        ],
+        deps = [
+            "//executorch/devtools/sampling_tracer:sampling_event_tracer",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "sampling_event_tracer_benchmark",
+        srcs = [
+            "sampling_event_tracer_benchmark.cpp",
+        ],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/devtools/etdump:etdump_flatcc",
+            "//executorch/devtools/sampling_tracer:sampling_event_tracer",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
@@ -101,6 +101,30 @@ class QuantizedKVCache(nn.Module):
         return quantized_value, scales, zero_points
 
     def _quantize_and_update(self, input_pos, k_val, v_val, indices=None):
+        if (
+            self.use_custom_update_cache_op
+            and indices is None
+            and self.cache_type == QuantizedCacheType.AffineAsymmetric
+        ):
+            # Quantizes and writes the values, scales and zero points in one op
+            # per cache, instead of choose_qparams, quantize and three copies.
+            start_pos = input_pos[0].item()
+            _ = torch.ops.llama.update_quantized_cache(
+                k_val,
+                self.k_cache,
+                self.k_cache_scales,
+                self.k_cache_zero_points,
+                start_pos,
+            )
+            _ = torch.ops.llama.update_quantized_cache(
+                v_val,
+                self.v_cache,
+                self.v_cache_scales,
+                self.v_cache_zero_points,
+                start_pos,
+            )
+            return
+
         quantized_k_val, k_scales, k_zero_points = self._quantize(k_val)
         quantized_v_val, v_scales, v_zero_points = self._quantize(v_val)
 
@@ -112,13 +112,20 @@ class QuantizedSDPA(torch.nn.Module):
     Args:
         dim (int): The dimension of the model
         kv_cache (QuantizedKVCache): The cache for storing quantized key-value pairs
+        quantize_query (bool): Whether to quantize the query to int8 too. If False,
+            the float query attends to the int8 cache, which is dequantized inside
+            the op.
     Note that it needs to own kv_cache to access scales and zero points, and since
     SDPA forward signature only accepts q, k and v, to allow accessing scales and
     zero points, we need to pass kv_cache to SDPA.
     """
 
     def __init__(
-        self, dim: int, kv_cache: QuantizedKVCache, use_attention_mask: bool = False
+        self,
+        dim: int,
+        kv_cache: QuantizedKVCache,
+        use_attention_mask: bool = False,
+        quantize_query: bool = True,
     ):
         super().__init__()
         self.dim = dim
@@ -126,6 +133,7 @@ class QuantizedSDPA(torch.nn.Module):
         self.float_dtype = torch.float32
         self.kv_cache = kv_cache
         self.use_attention_mask = use_attention_mask
+        self.quantize_query = quantize_query
 
     def forward(
         self,
@@ -141,21 +149,26 @@ class QuantizedSDPA(torch.nn.Module):
         k_quantized = k_quantized.transpose(1, 2)
         v_quantized = v_quantized.transpose(1, 2)
 
-        q_scale, q_zero_point = (
-            torch.ops.quantized_decomposed.choose_qparams_per_token_asymmetric.default(
-                q, self.quantized_dtype
+        if self.quantize_query:
+            q_scale, q_zero_point = (
+                torch.ops.quantized_decomposed.choose_qparams_per_token_asymmetric.default(
+                    q, self.quantized_dtype
+                )
             )
-        )
-        q_quantized = torch.ops.quantized_decomposed.quantize_per_token(
-            q,
-            q_scale,
-            q_zero_point,
-            torch.iinfo(self.quantized_dtype).min,
-            torch.iinfo(self.quantized_dtype).max,
-            self.quantized_dtype,
-        )
-        q_zero_point_int8 = q_zero_point.to(dtype=torch.int8)
-        q_scale_fp32 = q_scale.to(dtype=torch.float32)
+            q_quantized = torch.ops.quantized_decomposed.quantize_per_token(
+                q,
+                q_scale,
+                q_zero_point,
+                torch.iinfo(self.quantized_dtype).min,
+                torch.iinfo(self.quantized_dtype).max,
+                self.quantized_dtype,
+            )
+            q_zero_point_int8 = q_zero_point.to(dtype=torch.int8)
+            q_scale_fp32 = q_scale.to(dtype=torch.float32)
+        else:
+            q_quantized = q
+            q_zero_point_int8 = None
+            q_scale_fp32 = None
 
         k_zero_point_int8 = self.kv_cache.k_cache_zero_points
         k_scale_fp32 = self.kv_cache.k_cache_scales
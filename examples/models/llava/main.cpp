@@ -7,14 +7,13 @@
  */
 
 #include <executorch/extension/llm/runner/image.h>
+#include <executorch/extension/llm/runner/image_preprocessor.h>
 #include <executorch/extension/llm/runner/multimodal_input.h>
 #include <executorch/extension/llm/runner/multimodal_runner.h>
 #include <gflags/gflags.h>
 #include <pytorch/tokenizers/llama2c_tokenizer.h>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
-#define STB_IMAGE_RESIZE_IMPLEMENTATION
-#include <stb_image_resize.h>
 
 #if defined(ET_USE_THREADPOOL)
 #include <executorch/extension/threadpool/cpuinfo_utils.h>
@@ -48,6 +47,9 @@ DEFINE_int32(
     "Number of CPU threads for inference. Defaults to -1, which implies we'll use a heuristic to derive the # of performant cores for a specific device.");
 
 using ::executorch::extension::llm::Image;
+using ::executorch::extension::llm::ImageBuffer;
+using ::executorch::extension::llm::ImagePreprocessor;
+using ::executorch::extension::llm::ImagePreprocessorConfig;
 using ::executorch::extension::llm::make_image_input;
 using ::executorch::extension::llm::make_text_input;
 using ::executorch::extension::llm::MultimodalInput;
@@ -60,34 +62,18 @@ void load_image(const std::string& image_path, Image& image) {
     ET_LOG(Fatal, "Failed to load image: %s", image_path.c_str());
     exit(1);
   }
-  // resize the longest edge to 336
-  int new_width = width;
-  int new_height = height;
-  if (width > height) {
-    new_width = 336;
-    new_height = static_cast<int>(height * 336.0 / width);
-  } else {
-    new_height = 336;
-    new_width = static_cast<int>(width * 336.0 / height);
-  }
-  std::vector<uint8_t> resized_data(new_width * new_height * channels);
-  stbir_resize_uint8(
-      data,
-      width,
-      height,
-      0,
-      resized_data.data(),
-      new_width,
-      new_height,
-      0,
-      channels);
-  std::vector<uint8_t> chw_data(channels * new_width * new_height);
-  for (int i = 0; i < new_width * new_height; ++i) {
-    for (int c = 0; c < channels; ++c) {
-      chw_data[c * new_width * new_height + i] = resized_data[i * channels + c];
-    }
+  // resize the longest edge to 336, into a CHW uint8 image
+  ImagePreprocessorConfig config;
+  config.longest_edge = 336;
+  config.dtype = ::executorch::aten::ScalarType::Byte;
+  auto preprocessed = ImagePreprocessor(config).preprocess_to_image(
+      ImageBuffer{data, width, height, channels});
+  stbi_image_free(data);
+  if (!preprocessed.ok()) {
+    ET_LOG(Fatal, "Failed to preprocess image: %s", image_path.c_str());
+    exit(1);
   }
-  image = Image(std::move(chw_data), new_width, new_height, channels);
+  image = std::move(*preprocessed);
   // convert to tensor
   ET_LOG(
       Info,
@@ -95,7 +81,6 @@ void load_image(const std::string& image_path, Image& image) {
       image.channels(),
       image.height(),
       image.width());
-  stbi_image_free(data);
 }
 
 int32_t main(int32_t argc, char** argv) {
@@ -10,6 +10,7 @@
 
 #include <inttypes.h>
 #include <algorithm>
+#include <cstring>
 #include <optional>
 
 #include <executorch/extension/llm/runner/constants.h>
@@ -46,6 +47,18 @@ AsrRunner::AsrRunner(
   }
 }
 
+AsrRunner::AsrRunner(
+    std::unique_ptr<Module> module,
+    std::unique_ptr<::tokenizers::Tokenizer> tokenizer,
+    std::unordered_set<int64_t> eos_token_ids,
+    ::executorch::aten::ScalarType encoder_input_dtype)
+    : module_(std::move(module)),
+      tokenizer_(std::move(tokenizer)),
+      eos_token_ids_(std::move(eos_token_ids)),
+      encoder_method_loaded_(true),
+      decoder_method_loaded_(true),
+      encoder_input_dtype_(encoder_input_dtype) {}
+
 bool AsrRunner::is_loaded() const {
   return module_ && encoder_method_loaded_ && decoder_method_loaded_ &&
       (!sampler_method_present_ || sampler_method_loaded_) && tokenizer_ &&
@@ -192,10 +205,7 @@ Result<std::vector<int64_t>> AsrRunner::transcribe(
   // Reset internal state and start inference
   stats_.inference_start_ms = ::executorch::extension::llm::time_in_ms();
 
-  const std::unordered_set<int64_t>* eos_tokens = &eos_token_ids();
-  if (!config.eos_token_ids.empty()) {
-    eos_tokens = &config.eos_token_ids;
-  }
+  const std::unordered_set<int64_t>* eos_tokens = &eos_token_ids(config);
   ET_CHECK_OR_RETURN_ERROR(
       !eos_tokens->empty(),
       InvalidArgument,
@@ -204,18 +214,10 @@ Result<std::vector<int64_t>> AsrRunner::transcribe(
       tokenizer_->vocab_size(), config.temperature);
 
   // Check expected dtype for encoder input
-  auto encoder_method_meta_result = module_->method_meta(kEncoderMethodName);
-  ET_CHECK_OK_OR_RETURN_ERROR(encoder_method_meta_result.error());
-  auto encoder_method_meta = encoder_method_meta_result.get();
-
-  ::executorch::aten::ScalarType expected_dtype =
-      ::executorch::aten::ScalarType::Float;
-  if (encoder_method_meta.num_inputs() > 0) {
-    auto input_meta_result = encoder_method_meta.input_tensor_meta(0);
-    if (input_meta_result.error() == ::executorch::runtime::Error::Ok) {
-      expected_dtype = input_meta_result.get().scalar_type();
-    }
-  }
+  auto expected_dtype_result = encoder_input_dtype();
+  ET_CHECK_OK_OR_RETURN_ERROR(expected_dtype_result.error());
+  const ::executorch::aten::ScalarType expected_dtype =
+      expected_dtype_result.get();
 
   // Convert preprocessed_features to expected dtype if needed
   if (preprocessed_features->scalar_type() != expected_dtype) {
@@ -288,49 +290,11 @@ Result<std::vector<int64_t>> AsrRunner::transcribe(
   decoder_inputs.emplace_back(cache_position_ptr);
   // Add some green coloring for the first generated token
   // token_callback("\033[1;32m");
-  const bool use_sampler_method = sampler_method_loaded_;
   while (generated_tokens < config.max_new_tokens) {
     input_id = tokens.back();
-    auto decoder_result = module_->execute(kDecoderMethodName, decoder_inputs);
-    ET_CHECK_OK_OR_RETURN_ERROR(decoder_result.error());
-
-    auto decoder_outputs = std::move(*decoder_result);
-    ET_CHECK_OR_RETURN_ERROR(
-        decoder_outputs.size() == 1 && decoder_outputs[0].isTensor(),
-        Internal,
-        "Decoder returned %zu outputs; expected a single tensor.",
-        decoder_outputs.size());
-
-    int64_t next_token = 0;
-    if (!use_sampler_method || config.temperature != 0.0f) {
-      ::executorch::aten::Tensor logits_tensor =
-          std::move(decoder_outputs[0]).toTensor();
-      const int64_t vocab_size = logits_tensor.numel();
-      ET_CHECK_OR_RETURN_ERROR(
-          vocab_size > 0, Internal, "Decoder logits tensor is empty.");
-      next_token =
-          static_cast<int64_t>(::executorch::extension::llm::logits_to_token(
-              logits_tensor, config.temperature));
-    } else {
-      auto sampler_result =
-          module_->execute(kSamplerMethodName, decoder_outputs);
-      ET_CHECK_OK_OR_RETURN_ERROR(sampler_result.error());
-
-      auto sampler_outputs = std::move(*sampler_result);
-      ET_CHECK_OR_RETURN_ERROR(
-          sampler_outputs.size() == 1 && sampler_outputs[0].isTensor(),
-          Internal,
-          "Sampler returned %zu outputs; expected a single tensor.",
-          sampler_outputs.size());
-
-      ::executorch::aten::Tensor token_tensor =
-          std::move(sampler_outputs[0]).toTensor();
-      ET_CHECK_OR_RETURN_ERROR(
-          token_tensor.numel() > 0,
-          Internal,
-          "Sampler logits tensor is empty.");
-      next_token = token_tensor.mutable_data_ptr<int64_t>()[0];
-    }
+    auto next_token_result = decode_step(decoder_inputs, config.temperature);
+    ET_CHECK_OK_OR_RETURN_ERROR(next_token_result.error());
+    const int64_t next_token = next_token_result.get();
 
     if (!first_token_generated) {
       stats_.first_token_ms = ::executorch::extension::llm::time_in_ms();
@@ -343,21 +307,7 @@ Result<std::vector<int64_t>> AsrRunner::transcribe(
     ++cache_position;
     input_id = next_token;
 
-    if (token_callback) {
-      auto piece_result = tokenizer_->decode(
-          static_cast<uint64_t>(prev_token), static_cast<uint64_t>(next_token));
-      if (piece_result.ok()) {
-        token_callback(piece_result.get());
-      } else {
-        ET_LOG(
-            Error,
-            "Tokenizer failed to decode token pair (%" PRId64 ", %" PRId64
-            ") with error %d",
-            prev_token,
-            next_token,
-            static_cast<int>(piece_result.error()));
-      }
-    }
+    emit_token(prev_token, next_token, token_callback);
 
     if (eos_tokens->count(next_token) > 0) {
       break;
@@ -374,4 +324,378 @@ Result<std::vector<int64_t>> AsrRunner::transcribe(
   return tokens;
 }
 
+Result<::executorch::aten::ScalarType> AsrRunner::encoder_input_dtype() {
+  if (encoder_input_dtype_.has_value()) {
+    return encoder_input_dtype_.value();
+  }
+  auto encoder_method_meta_result = module_->method_meta(kEncoderMethodName);
+  ET_CHECK_OK_OR_RETURN_ERROR(encoder_method_meta_result.error());
+  auto encoder_method_meta = encoder_method_meta_result.get();
+
+  ::executorch::aten::ScalarType expected_dtype =
+      ::executorch::aten::ScalarType::Float;
+  if (encoder_method_meta.num_inputs() > 0) {
+    auto input_meta_result = encoder_method_meta.input_tensor_meta(0);
+    if (input_meta_result.error() == ::executorch::runtime::Error::Ok) {
+      expected_dtype = input_meta_result.get().scalar_type();
+    }
+  }
+  encoder_input_dtype_ = expected_dtype;
+  return expected_dtype;
+}
+
+Result<int64_t> AsrRunner::decode_step(
+    const std::vector<::executorch::runtime::EValue>& decoder_inputs,
+    float temperature) {
+  auto decoder_result = module_->execute(kDecoderMethodName, decoder_inputs);
+  ET_CHECK_OK_OR_RETURN_ERROR(decoder_result.error());
+
+  auto decoder_outputs = std::move(*decoder_result);
+  ET_CHECK_OR_RETURN_ERROR(
+      decoder_outputs.size() == 1 && decoder_outputs[0].isTensor(),
+      Internal,
+      "Decoder returned %zu outputs; expected a single tensor.",
+      decoder_outputs.size());
+
+  if (!sampler_method_loaded_ || temperature != 0.0f) {
+    ::executorch::aten::Tensor logits_tensor =
+        std::move(decoder_outputs[0]).toTensor();
+    const int64_t vocab_size = logits_tensor.numel();
+    ET_CHECK_OR_RETURN_ERROR(
+        vocab_size > 0, Internal, "Decoder logits tensor is empty.");
+    return static_cast<int64_t>(::executorch::extension::llm::logits_to_token(
+        logits_tensor, temperature));
+  }
+
+  auto sampler_result = module_->execute(kSamplerMethodName, decoder_outputs);
+  ET_CHECK_OK_OR_RETURN_ERROR(sampler_result.error());
+
+  auto sampler_outputs = std::move(*sampler_result);
+  ET_CHECK_OR_RETURN_ERROR(
+      sampler_outputs.size() == 1 && sampler_outputs[0].isTensor(),
+      Internal,
+      "Sampler returned %zu outputs; expected a single tensor.",
+      sampler_outputs.size());
+
+  ::executorch::aten::Tensor token_tensor =
+      std::move(sampler_outputs[0]).toTensor();
+  ET_CHECK_OR_RETURN_ERROR(
+      token_tensor.numel() > 0, Internal, "Sampler logits tensor is empty.");
+  return token_tensor.mutable_data_ptr<int64_t>()[0];
+}
+
+void AsrRunner::emit_token(
+    int64_t prev_token,
+    int64_t next_token,
+    const std::function<void(const std::string&)>& token_callback) {
+  if (!token_callback) {
+    return;
+  }
+  auto piece_result = tokenizer_->decode(
+      static_cast<uint64_t>(prev_token), static_cast<uint64_t>(next_token));
+  if (piece_result.ok()) {
+    token_callback(piece_result.get());
+  } else {
+    ET_LOG(
+        Error,
+        "Tokenizer failed to decode token pair (%" PRId64 ", %" PRId64
+        ") with error %d",
+        prev_token,
+        next_token,
+        static_cast<int>(piece_result.error()));
+  }
+}
+
+Error AsrRunner::begin_stream(
+    AsrTranscribeConfig config,
+    AsrStreamingConfig streaming_config,
+    std::function<void(const std::string&)> token_callback) {
+  ET_CHECK_OR_RETURN_ERROR(
+      config.max_new_tokens > 0,
+      InvalidArgument,
+      "max_new_tokens must be positive, got %" PRId64,
+      config.max_new_tokens);
+  ET_CHECK_OR_RETURN_ERROR(
+      streaming_config.left_context_frames >= 0 &&
+          streaming_config.max_chunk_frames > 0 &&
+          streaming_config.max_encoder_frames > 0 &&
+          streaming_config.max_tokens_per_chunk >= 0,
+      InvalidArgument,
+      "Invalid streaming config: left_context_frames=%" PRId64
+      ", max_chunk_frames=%" PRId64 ", max_encoder_frames=%" PRId64
+      ", max_tokens_per_chunk=%" PRId64,
+      streaming_config.left_context_frames,
+      streaming_config.max_chunk_frames,
+      streaming_config.max_encoder_frames,
+      streaming_config.max_tokens_per_chunk);
+#ifdef CUDA_AVAILABLE
+  // The encoder output stays on the device, but the stream gathers the
+  // encoder states of its chunks on the host.
+  ET_LOG(Error, "Streaming transcription is not supported with CUDA.");
+  return Error::NotSupported;
+#endif
+
+  if (!is_loaded()) {
+    ET_CHECK_OK_OR_RETURN_ERROR(load());
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      !eos_token_ids(config).empty(),
+      InvalidArgument,
+      "EOS token set must not be empty.");
+
+  auto feature_dtype_result = encoder_input_dtype();
+  ET_CHECK_OK_OR_RETURN_ERROR(feature_dtype_result.error());
+  ET_CHECK_OR_RETURN_ERROR(
+      feature_dtype_result.get() == ::executorch::aten::ScalarType::Float ||
+          feature_dtype_result.get() ==
+              ::executorch::aten::ScalarType::BFloat16,
+      NotSupported,
+      "Streaming supports Float and BFloat16 encoder inputs, got %s",
+      ::executorch::runtime::toString(feature_dtype_result.get()));
+
+  // Buffers sized for a different config, or another feature dtype, are
+  // reallocated by the first chunk.
+  if (feature_dtype_result.get() != stream_.feature_dtype ||
+      streaming_config.left_context_frames !=
+          stream_.streaming_config.left_context_frames ||
+      streaming_config.max_chunk_frames !=
+          stream_.streaming_config.max_chunk_frames) {
+    stream_.features_tensor = nullptr;
+  }
+  if (streaming_config.max_encoder_frames !=
+      stream_.streaming_config.max_encoder_frames) {
+    stream_.encoder_states_tensor = nullptr;
+  }
+  stream_.feature_dtype = feature_dtype_result.get();
+
+  stream_.active = true;
+  stream_.finished = false;
+  stream_.config = std::move(config);
+  stream_.streaming_config = streaming_config;
+  stream_.token_callback = std::move(token_callback);
+  stream_.num_chunks = 0;
+  stream_.num_context_frames = 0;
+  stream_.num_encoder_frames = 0;
+  stream_.tokens.assign(1, stream_.config.decoder_start_token_id);
+  stream_.input_id = stream_.config.decoder_start_token_id;
+  stream_.cache_position = 0;
+  if (!stream_.input_id_tensor) {
+    stream_.input_id_tensor = ::executorch::extension::from_blob(
+        &stream_.input_id,
+        {static_cast<::executorch::aten::SizesType>(1),
+         static_cast<::executorch::aten::SizesType>(1)},
+        ::executorch::aten::ScalarType::Long);
+    stream_.cache_position_tensor = ::executorch::extension::from_blob(
+        &stream_.cache_position,
+        {static_cast<::executorch::aten::SizesType>(1)},
+        ::executorch::aten::ScalarType::Long);
+  }
+
+  stats_.reset();
+  stats_.inference_start_ms = ::executorch::extension::llm::time_in_ms();
+  return Error::Ok;
+}
+
+Error AsrRunner::transcribe_chunk(
+    ::executorch::extension::TensorPtr feature_chunk) {
+  ET_CHECK_OR_RETURN_ERROR(
+      stream_.active, InvalidState, "begin_stream() must be called first.");
+  ET_CHECK_OR_RETURN_ERROR(
+      feature_chunk->dim() == 3 && feature_chunk->size(0) == 1,
+      InvalidArgument,
+      "Feature chunk must have shape [1, time, features].");
+  const int64_t num_frames = feature_chunk->size(1);
+  const int64_t num_features = feature_chunk->size(2);
+  const AsrStreamingConfig& streaming_config = stream_.streaming_config;
+  ET_CHECK_OR_RETURN_ERROR(
+      num_frames > 0 && num_frames <= streaming_config.max_chunk_frames,
+      InvalidArgument,
+      "Feature chunk has %" PRId64 " frames; expected 1 to %" PRId64,
+      num_frames,
+      streaming_config.max_chunk_frames);
+  ET_CHECK_OR_RETURN_ERROR(
+      feature_chunk->scalar_type() == ::executorch::aten::ScalarType::Float ||
+          feature_chunk->scalar_type() == stream_.feature_dtype,
+      InvalidArgument,
+      "Feature chunk dtype %s is neither Float nor the encoder input dtype",
+      ::executorch::runtime::toString(feature_chunk->scalar_type()));
+
+  const size_t feature_size =
+      ::executorch::runtime::elementSize(stream_.feature_dtype);
+  if (!stream_.features_tensor || num_features != stream_.num_features) {
+    ET_CHECK_OR_RETURN_ERROR(
+        stream_.num_chunks == 0,
+        InvalidArgument,
+        "Feature chunk has %" PRId64 " features; expected %" PRId64,
+        num_features,
+        stream_.num_features);
+    const int64_t max_frames = streaming_config.left_context_frames +
+        streaming_config.max_chunk_frames;
+    stream_.num_features = num_features;
+    stream_.features.resize(max_frames * num_features * feature_size);
+    stream_.features_tensor = ::executorch::extension::from_blob(
+        stream_.features.data(),
+        {1,
+         static_cast<::executorch::aten::SizesType>(max_frames),
+         static_cast<::executorch::aten::SizesType>(num_features)},
+        stream_.feature_dtype);
+  }
+
+  // Append the chunk to the left context, in the encoder input dtype.
+  const int64_t num_input_frames = stream_.num_context_frames + num_frames;
+  const size_t chunk_numel = static_cast<size_t>(num_frames * num_features);
+  uint8_t* chunk_data = stream_.features.data() +
+      stream_.num_context_frames * num_features * feature_size;
+  if (feature_chunk->scalar_type() == stream_.feature_dtype) {
+    std::memcpy(
+        chunk_data,
+        feature_chunk->const_data_ptr(),
+        chunk_numel * feature_size);
+  } else {
+    const float* src = feature_chunk->const_data_ptr<float>();
+    auto* dst = reinterpret_cast<::executorch::aten::BFloat16*>(chunk_data);
+    for (size_t i = 0; i < chunk_numel; ++i) {
+      dst[i] = ::executorch::aten::BFloat16(src[i]);
+    }
+  }
+  ET_CHECK_OK_OR_RETURN_ERROR(::executorch::extension::resize_tensor_ptr(
+      stream_.features_tensor,
+      {1,
+       static_cast<::executorch::aten::SizesType>(num_input_frames),
+       static_cast<::executorch::aten::SizesType>(num_features)}));
+
+  const long encoder_start_ms = ::executorch::extension::llm::time_in_ms();
+  auto encoder_result =
+      module_->execute(kEncoderMethodName, stream_.features_tensor);
+  ET_CHECK_OK_OR_RETURN_ERROR(encoder_result.error());
+  auto encoder_outputs = std::move(*encoder_result);
+  ET_CHECK_OR_RETURN_ERROR(
+      encoder_outputs.size() == 1 && encoder_outputs[0].isTensor() &&
+          encoder_outputs[0].toTensor().dim() == 3,
+      Internal,
+      "Encoder returned %zu outputs; expected a single 3D tensor.",
+      encoder_outputs.size());
+  const ::executorch::aten::Tensor encoder_output =
+      encoder_outputs[0].toTensor();
+  const int64_t num_output_frames = encoder_output.size(1);
+  const int64_t hidden_size = encoder_output.size(2);
+
+  if (!stream_.encoder_states_tensor || hidden_size != stream_.hidden_size ||
+      encoder_output.scalar_type() != stream_.encoder_states_dtype) {
+    ET_CHECK_OR_RETURN_ERROR(
+        stream_.num_chunks == 0,
+        Internal,
+        "Encoder output changed shape or dtype within a stream.");
+    stream_.hidden_size = hidden_size;
+    stream_.encoder_states_dtype = encoder_output.scalar_type();
+    stream_.encoder_states.resize(
+        streaming_config.max_encoder_frames * hidden_size *
+        ::executorch::runtime::elementSize(stream_.encoder_states_dtype));
+    stream_.encoder_states_tensor = ::executorch::extension::from_blob(
+        stream_.encoder_states.data(),
+        {1,
+         static_cast<::executorch::aten::SizesType>(
+             streaming_config.max_encoder_frames),
+         static_cast<::executorch::aten::SizesType>(hidden_size)},
+        stream_.encoder_states_dtype);
+  }
+
+  // Keep the encoder states of the chunk, not those of its left context.
+  const int64_t num_context_output_frames =
+      stream_.num_context_frames * num_output_frames / num_input_frames;
+  const int64_t num_new_frames = num_output_frames - num_context_output_frames;
+  ET_CHECK_OR_RETURN_ERROR(
+      stream_.num_encoder_frames + num_new_frames <=
+          streaming_config.max_encoder_frames,
+      OutOfResources,
+      "Stream exceeds max_encoder_frames=%" PRId64,
+      streaming_config.max_encoder_frames);
+  const size_t frame_size = hidden_size * encoder_output.element_size();
+  std::memcpy(
+      stream_.encoder_states.data() + stream_.num_encoder_frames * frame_size,
+      static_cast<const uint8_t*>(encoder_output.const_data_ptr()) +
+          num_context_output_frames * frame_size,
+      num_new_frames * frame_size);
+  stream_.num_encoder_frames += num_new_frames;
+  ET_CHECK_OK_OR_RETURN_ERROR(::executorch::extension::resize_tensor_ptr(
+      stream_.encoder_states_tensor,
+      {1,
+       static_cast<::executorch::aten::SizesType>(stream_.num_encoder_frames),
+       static_cast<::executorch::aten::SizesType>(hidden_size)}));
+  stats_.aggregate_encoder_time_ms +=
+      ::executorch::extension::llm::time_in_ms() - encoder_start_ms;
+
+  // Move the last frames to the front as the left context of the next chunk.
+  const int64_t num_context_frames =
+      std::min(streaming_config.left_context_frames, num_input_frames);
+  const size_t input_frame_size = num_features * feature_size;
+  std::memmove(
+      stream_.features.data(),
+      stream_.features.data() +
+          (num_input_frames - num_context_frames) * input_frame_size,
+      num_context_frames * input_frame_size);
+  stream_.num_context_frames = num_context_frames;
+  ++stream_.num_chunks;
+
+  return decode_stream(/*final=*/false);
+}
+
+Error AsrRunner::decode_stream(bool final) {
+  const AsrTranscribeConfig& config = stream_.config;
+  const std::unordered_set<int64_t>& eos_tokens = eos_token_ids(config);
+  const int64_t max_steps =
+      final ? 0 : stream_.streaming_config.max_tokens_per_chunk;
+  int64_t steps = 0;
+  while (!stream_.finished && stream_.num_encoder_frames > 0 &&
+         static_cast<int64_t>(stream_.tokens.size()) - 1 <
+             config.max_new_tokens &&
+         (max_steps == 0 || steps < max_steps)) {
+    stream_.input_id = stream_.tokens.back();
+    std::vector<::executorch::runtime::EValue> decoder_inputs;
+    decoder_inputs.reserve(3);
+    decoder_inputs.emplace_back(stream_.input_id_tensor);
+    decoder_inputs.emplace_back(stream_.encoder_states_tensor);
+    decoder_inputs.emplace_back(stream_.cache_position_tensor);
+    auto next_token_result = decode_step(decoder_inputs, config.temperature);
+    ET_CHECK_OK_OR_RETURN_ERROR(next_token_result.error());
+    const int64_t next_token = next_token_result.get();
+
+    const bool is_eos = eos_tokens.count(next_token) > 0;
+    if (is_eos && !final) {
+      // Everything heard so far is transcribed. The next chunk decodes from
+      // the same position again, with more audio to attend to.
+      break;
+    }
+    if (stats_.first_token_ms == 0) {
+      stats_.first_token_ms = ::executorch::extension::llm::time_in_ms();
+    }
+    const int64_t prev_token = stream_.tokens.back();
+    stream_.tokens.push_back(next_token);
+    ++stream_.cache_position;
+    ++steps;
+    emit_token(prev_token, next_token, stream_.token_callback);
+    stream_.finished = is_eos;
+  }
+  return Error::Ok;
+}
+
+Result<std::vector<int64_t>> AsrRunner::end_stream() {
+  ET_CHECK_OR_RETURN_ERROR(
+      stream_.active, InvalidState, "begin_stream() must be called first.");
+  stream_.active = false;
+  ET_CHECK_OK_OR_RETURN_ERROR(decode_stream(/*final=*/true));
+
+  stats_.prompt_eval_end_ms = stats_.inference_start_ms;
+  stats_.num_prompt_tokens = 0;
+  stats_.num_generated_tokens =
+      static_cast<int64_t>(stream_.tokens.size()) - 1;
+  stats_.inference_end_ms = ::executorch::extension::llm::time_in_ms();
+  printf("\n");
+  print_report(stats_);
+  // Leave no stream stats behind for transcribe().
+  stats_.reset();
+
+  return std::move(stream_.tokens);
+}
+
 } // namespace executorch::extension::asr
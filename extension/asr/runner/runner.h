@@ -10,6 +10,7 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -47,6 +48,27 @@ struct ET_EXPERIMENTAL AsrTranscribeConfig {
   int64_t decoder_start_token_id = 0;
 };
 
+/**
+ * Configuration for streaming transcription, see AsrRunner::begin_stream().
+ *
+ * Each chunk of features is encoded together with the last
+ * left_context_frames feature frames that came before it, and only the
+ * encoder states of the chunk itself are kept. Frame counts should be
+ * multiples of the time downsampling factor of the encoder.
+ *
+ * max_chunk_frames and max_encoder_frames size the buffers that hold the
+ * features of a chunk and the encoder states of the whole stream. They are
+ * allocated once and reused by later chunks and streams.
+ * max_tokens_per_chunk bounds the decoder steps run after each chunk, 0 for
+ * no bound other than max_new_tokens.
+ */
+struct ET_EXPERIMENTAL AsrStreamingConfig {
+  int64_t left_context_frames = 0;
+  int64_t max_chunk_frames = 100;
+  int64_t max_encoder_frames = 1500;
+  int64_t max_tokens_per_chunk = 0;
+};
+
 /**
  * Runner that owns a ASR model encoder + decoder pair exported as a single
  * ExecuTorch module. A good example is Whisper
@@ -64,6 +86,22 @@ class ET_EXPERIMENTAL AsrRunner {
       std::optional<std::string> data_path,
       const std::string& tokenizer_path);
 
+  /**
+   * Creates a runner around a Module and a tokenizer that are already set up,
+   * for example to replace them in tests. The Module must provide the
+   * "encoder" and "text_decoder" methods, and the "text_decoder" must return
+   * logits, as no "sampler" method is used.
+   *
+   * @param eos_token_ids Tokens that end a transcription.
+   * @param encoder_input_dtype The dtype of the features the encoder takes.
+   */
+  AsrRunner(
+      std::unique_ptr<Module> module,
+      std::unique_ptr<::tokenizers::Tokenizer> tokenizer,
+      std::unordered_set<int64_t> eos_token_ids,
+      ::executorch::aten::ScalarType encoder_input_dtype =
+          ::executorch::aten::ScalarType::Float);
+
   /**
    * Returns true when the module and tokenizer are ready for inference.
    */
@@ -92,11 +130,105 @@ class ET_EXPERIMENTAL AsrRunner {
       AsrTranscribeConfig config = {},
       std::function<void(const std::string&)> token_callback = {});
 
+  /**
+   * Starts a streaming transcription, which takes the audio features in
+   * chunks as they become available instead of all at once. Each chunk runs
+   * the encoder on the chunk alone, plus some left context, and then as many
+   * decoder steps as the audio so far supports, so that text is emitted
+   * while the audio is still arriving.
+   *
+   * Decoded tokens are final: the decoder does not revisit them when later
+   * audio arrives, so the model should be trained or exported for streaming.
+   * The encoder and the "text_decoder" must accept a dynamic number of
+   * frames.
+   *
+   * @param config Controls generation length and termination criteria.
+   * @param streaming_config Controls the chunking and the buffer sizes.
+   * @param token_callback Optional functor invoked for each decoded piece of
+   * text, as soon as the decoder step that produced it completes.
+   *
+   * @returns Error::Ok if the stream started.
+   */
+  ::executorch::runtime::Error begin_stream(
+      AsrTranscribeConfig config = {},
+      AsrStreamingConfig streaming_config = {},
+      std::function<void(const std::string&)> token_callback = {});
+
+  /**
+   * Transcribes the next chunk of a stream started with begin_stream().
+   *
+   * @param feature_chunk Audio features of shape [1, time, features], with at
+   * most max_chunk_frames frames and the same number of features as the
+   * previous chunks.
+   *
+   * @returns Error::Ok once the decoder has caught up with the chunk.
+   */
+  ::executorch::runtime::Error transcribe_chunk(
+      ::executorch::extension::TensorPtr feature_chunk);
+
+  /**
+   * Ends a stream started with begin_stream(), decoding until an EOS token
+   * or max_new_tokens.
+   *
+   * @returns Result containing the decoder token ids of the stream (including
+   * the seed prompt and generated tokens), or an error.
+   */
+  ::executorch::runtime::Result<std::vector<int64_t>> end_stream();
+
  private:
+  // State of the stream started by begin_stream(). The buffers outlive the
+  // stream and are reused by the next one.
+  struct StreamState {
+    bool active = false;
+    bool finished = false;
+    AsrTranscribeConfig config;
+    AsrStreamingConfig streaming_config;
+    std::function<void(const std::string&)> token_callback;
+    int64_t num_chunks = 0;
+
+    // Left context followed by the current chunk, in the encoder input
+    // dtype.
+    ::executorch::aten::ScalarType feature_dtype =
+        ::executorch::aten::ScalarType::Float;
+    int64_t num_features = 0;
+    int64_t num_context_frames = 0;
+    std::vector<uint8_t> features;
+    ::executorch::extension::TensorPtr features_tensor;
+
+    // Encoder states of all chunks so far.
+    ::executorch::aten::ScalarType encoder_states_dtype =
+        ::executorch::aten::ScalarType::Float;
+    int64_t hidden_size = 0;
+    int64_t num_encoder_frames = 0;
+    std::vector<uint8_t> encoder_states;
+    ::executorch::extension::TensorPtr encoder_states_tensor;
+
+    std::vector<int64_t> tokens;
+    int64_t input_id = 0;
+    int64_t cache_position = 0;
+    ::executorch::extension::TensorPtr input_id_tensor;
+    ::executorch::extension::TensorPtr cache_position_tensor;
+  };
+
   ::executorch::runtime::Error load_tokenizer();
   inline const std::unordered_set<int64_t>& eos_token_ids() const {
     return eos_token_ids_;
   }
+  const std::unordered_set<int64_t>& eos_token_ids(
+      const AsrTranscribeConfig& config) const {
+    return config.eos_token_ids.empty() ? eos_token_ids_
+                                        : config.eos_token_ids;
+  }
+  ::executorch::runtime::Result<::executorch::aten::ScalarType>
+  encoder_input_dtype();
+  ::executorch::runtime::Result<int64_t> decode_step(
+      const std::vector<::executorch::runtime::EValue>& decoder_inputs,
+      float temperature);
+  void emit_token(
+      int64_t prev_token,
+      int64_t next_token,
+      const std::function<void(const std::string&)>& token_callback);
+  ::executorch::runtime::Error decode_stream(bool final);
 
   std::string module_path_;
   std::string data_path_;
@@ -110,8 +242,11 @@ class ET_EXPERIMENTAL AsrRunner {
   bool decoder_method_loaded_ = false;
   bool sampler_method_loaded_ = false;
   bool sampler_method_present_ = false;
+  // Looked up from the encoder method meta on first use.
+  std::optional<::executorch::aten::ScalarType> encoder_input_dtype_;
 
   Stats stats_;
+  StreamState stream_;
 };
 
 } // namespace executorch::extension::asr
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Measures the latency of streaming transcription with AsrRunner against
+// transcribing the whole input at once, on synthetic audio features of a
+// long recording. The model must accept a dynamic number of frames, see
+// AsrRunner::begin_stream().
+//
+// For live audio, the time to first text of a whole-input transcription
+// starts when the recording ends, while that of a stream starts when the
+// chunk that holds the first word arrives, so the report lists how much
+// audio each mode needed before it emitted text.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include <executorch/extension/asr/runner/runner.h>
+#include <executorch/extension/llm/runner/util.h>
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/runtime/platform/log.h>
+
+DEFINE_string(model_path, "model.pte", "Path to the ASR model (.pte).");
+DEFINE_string(data_path, "", "Optional path to the model weights (.ptd).");
+DEFINE_string(tokenizer_path, ".", "Path to the tokenizer.");
+DEFINE_int32(audio_seconds, 60, "Length of the synthetic audio.");
+DEFINE_int32(frames_per_second, 100, "Feature frames per second of audio.");
+DEFINE_int32(num_features, 128, "Features per frame, e.g. mel bins.");
+DEFINE_int32(chunk_ms, 1000, "Audio per streamed chunk.");
+DEFINE_int32(left_context_ms, 500, "Audio encoded again as left context.");
+DEFINE_int32(max_encoder_frames, 6000, "Encoder states kept per stream.");
+DEFINE_int32(max_new_tokens, 448, "Maximum number of tokens to generate.");
+DEFINE_int32(max_tokens_per_chunk, 0, "Decoder steps per chunk, 0 for all.");
+DEFINE_int64(decoder_start_token_id, 0, "Token that starts decoding.");
+DEFINE_bool(whole_input, true, "Also transcribe the whole input at once.");
+
+namespace {
+
+using ::executorch::extension::asr::AsrRunner;
+using ::executorch::extension::asr::AsrStreamingConfig;
+using ::executorch::extension::asr::AsrTranscribeConfig;
+using ::executorch::extension::llm::time_in_ms;
+
+// Log-mel-like features: a smooth spectral envelope per frame plus noise.
+std::vector<float> make_features(int64_t num_frames, int64_t num_features) {
+  std::mt19937 gen(0);
+  std::normal_distribution<float> noise(0.0f, 0.1f);
+  std::vector<float> features(num_frames * num_features);
+  for (int64_t t = 0; t < num_frames; ++t) {
+    const float energy = 0.5f + 0.5f * static_cast<float>((t / 37) % 5) / 4;
+    for (int64_t f = 0; f < num_features; ++f) {
+      const float envelope = 1.0f - static_cast<float>(f) / num_features;
+      features[t * num_features + f] = energy * envelope - 0.5f + noise(gen);
+    }
+  }
+  return features;
+}
+
+long percentile(std::vector<long> values, double p) {
+  if (values.empty()) {
+    return 0;
+  }
+  std::sort(values.begin(), values.end());
+  const size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+  return values[index];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  const int64_t num_frames =
+      static_cast<int64_t>(FLAGS_audio_seconds) * FLAGS_frames_per_second;
+  const int64_t chunk_frames =
+      static_cast<int64_t>(FLAGS_chunk_ms) * FLAGS_frames_per_second / 1000;
+  const int64_t context_frames = static_cast<int64_t>(FLAGS_left_context_ms) *
+      FLAGS_frames_per_second / 1000;
+  if (num_frames <= 0 || chunk_frames <= 0) {
+    ET_LOG(Error, "audio_seconds and chunk_ms must be long enough.");
+    return 1;
+  }
+  std::vector<float> features = make_features(num_frames, FLAGS_num_features);
+
+  std::optional<std::string> data_path;
+  if (!FLAGS_data_path.empty()) {
+    data_path = FLAGS_data_path;
+  }
+  AsrRunner runner(FLAGS_model_path, data_path, FLAGS_tokenizer_path);
+  if (runner.load() != ::executorch::runtime::Error::Ok) {
+    ET_LOG(Error, "Failed to load the model.");
+    return 1;
+  }
+
+  AsrTranscribeConfig config;
+  config.max_new_tokens = FLAGS_max_new_tokens;
+  config.decoder_start_token_id = FLAGS_decoder_start_token_id;
+
+  // Streaming, with the chunks fed as fast as they are transcribed.
+  AsrStreamingConfig streaming_config;
+  streaming_config.left_context_frames = context_frames;
+  streaming_config.max_chunk_frames = chunk_frames;
+  streaming_config.max_encoder_frames = FLAGS_max_encoder_frames;
+  streaming_config.max_tokens_per_chunk = FLAGS_max_tokens_per_chunk;
+
+  long first_text_ms = 0;
+  int64_t chunks_before_text = 0;
+  int64_t chunk_index = 0;
+  const long stream_start_ms = time_in_ms();
+  auto error = runner.begin_stream(
+      config, streaming_config, [&](const std::string&) {
+        if (first_text_ms == 0) {
+          first_text_ms = time_in_ms();
+          chunks_before_text = chunk_index + 1;
+        }
+      });
+  std::vector<long> chunk_latencies_ms;
+  for (int64_t start = 0;
+       error == ::executorch::runtime::Error::Ok && start < num_frames;
+       start += chunk_frames, ++chunk_index) {
+    const int64_t frames = std::min(chunk_frames, num_frames - start);
+    auto chunk = ::executorch::extension::from_blob(
+        features.data() + start * FLAGS_num_features,
+        {1,
+         static_cast<::executorch::aten::SizesType>(frames),
+         static_cast<::executorch::aten::SizesType>(FLAGS_num_features)});
+    const long chunk_start_ms = time_in_ms();
+    error = runner.transcribe_chunk(chunk);
+    chunk_latencies_ms.push_back(time_in_ms() - chunk_start_ms);
+  }
+  if (error != ::executorch::runtime::Error::Ok) {
+    ET_LOG(Error, "Streaming failed with error %d", static_cast<int>(error));
+    return 1;
+  }
+  auto stream_result = runner.end_stream();
+  const long stream_end_ms = time_in_ms();
+  if (!stream_result.ok()) {
+    ET_LOG(Error, "Streaming failed.");
+    return 1;
+  }
+
+  const double audio_ms = FLAGS_audio_seconds * 1000.0;
+  printf(
+      "Streaming: %" PRId64 " chunks of %d ms, %d ms left context\n",
+      chunk_index,
+      FLAGS_chunk_ms,
+      FLAGS_left_context_ms);
+  printf(
+      "\tAudio before first text: %" PRId64 " ms\n",
+      std::min<int64_t>(chunks_before_text * FLAGS_chunk_ms, audio_ms));
+  printf(
+      "\tTime to first text: %ld ms\n",
+      first_text_ms == 0 ? -1 : first_text_ms - stream_start_ms);
+  printf(
+      "\tChunk latency: p50 %ld ms, p90 %ld ms, max %ld ms\n",
+      percentile(chunk_latencies_ms, 0.5),
+      percentile(chunk_latencies_ms, 0.9),
+      percentile(chunk_latencies_ms, 1.0));
+  printf(
+      "\tTokens: %zu, real-time factor: %.3f\n",
+      stream_result.get().size() - 1,
+      (stream_end_ms - stream_start_ms) / audio_ms);
+
+  if (!FLAGS_whole_input) {
+    return 0;
+  }
+  first_text_ms = 0;
+  const long whole_start_ms = time_in_ms();
+  auto whole_result = runner.transcribe(
+      ::executorch::extension::from_blob(
+          features.data(),
+          {1,
+           static_cast<::executorch::aten::SizesType>(num_frames),
+           static_cast<::executorch::aten::SizesType>(FLAGS_num_features)}),
+      config,
+      [&](const std::string&) {
+        if (first_text_ms == 0) {
+          first_text_ms = time_in_ms();
+        }
+      });
+  const long whole_end_ms = time_in_ms();
+  if (!whole_result.ok()) {
+    ET_LOG(Error, "Whole-input transcription failed.");
+    return 1;
+  }
+  printf("Whole input:\n");
+  printf("\tAudio before first text: %.0f ms\n", audio_ms);
+  printf(
+      "\tTime to first text: %ld ms\n",
+      first_text_ms == 0 ? -1 : first_text_ms - whole_start_ms);
+  printf(
+      "\tTokens: %zu, real-time factor: %.3f\n",
+      whole_result.get().size() - 1,
+      (whole_end_ms - whole_start_ms) / audio_ms);
+  return 0;
+}
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ * @lint-ignore-every CLANGTIDY facebook-hte-Deprecated
+ */
+
+#include <executorch/extension/asr/runner/runner.h>
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace ::testing;
+using executorch::extension::make_tensor_ptr;
+using executorch::extension::Module;
+using executorch::extension::TensorPtr;
+using executorch::extension::asr::AsrRunner;
+using executorch::extension::asr::AsrStreamingConfig;
+using executorch::extension::asr::AsrTranscribeConfig;
+using executorch::runtime::Error;
+using executorch::runtime::EValue;
+using executorch::runtime::Result;
+
+namespace {
+
+constexpr int64_t kEosToken = 1;
+constexpr int64_t kVocabSize = 64;
+// The first generated token; the token at cache position p is kFirstToken + p.
+constexpr int64_t kFirstToken = 10;
+
+// A Module whose "encoder" halves the number of frames, mapping frame j of its
+// output to the first feature of input frame 2 * j, and whose "text_decoder"
+// needs frames_per_token encoder frames for every token, emitting EOS when
+// there are not enough of them.
+class StubModule : public Module {
+ public:
+  StubModule() : Module("") {}
+
+  int64_t frames_per_token = 2;
+  int64_t hidden_size = 4;
+
+  // Data pointers of the tensors passed to the methods, per call.
+  std::vector<const void*> feature_buffers;
+  std::vector<const void*> encoder_state_buffers;
+  // Cache positions of the decoder calls.
+  std::vector<int64_t> cache_positions;
+  // Encoder states seen by the last decoder call, one value per frame.
+  std::vector<float> last_encoder_states;
+
+  Error load(const executorch::runtime::Program::Verification) override {
+    return Error::Ok;
+  }
+
+  bool is_loaded() const override {
+    return true;
+  }
+
+  Result<std::vector<EValue>> execute(
+      const std::string& method_name,
+      const std::vector<EValue>& inputs) override {
+    if (method_name == "encoder") {
+      return encode(inputs[0].toTensor());
+    }
+    if (method_name == "text_decoder") {
+      return decode(inputs[1].toTensor(), inputs[2].toTensor());
+    }
+    return Error::NotFound;
+  }
+
+ private:
+  Result<std::vector<EValue>> encode(
+      const executorch::aten::Tensor& features) {
+    feature_buffers.push_back(features.const_data_ptr());
+    const int64_t num_frames = features.size(1) / 2;
+    const int64_t num_features = features.size(2);
+    std::vector<float> states(num_frames * hidden_size);
+    for (int64_t j = 0; j < num_frames; ++j) {
+      const float value =
+          features.const_data_ptr<float>()[2 * j * num_features];
+      for (int64_t h = 0; h < hidden_size; ++h) {
+        states[j * hidden_size + h] = value;
+      }
+    }
+    // Like planned memory, the output stays valid until the next run.
+    encoder_output_ = make_tensor_ptr(
+        {1,
+         static_cast<executorch::aten::SizesType>(num_frames),
+         static_cast<executorch::aten::SizesType>(hidden_size)},
+        std::move(states));
+    return std::vector<EValue>{EValue(*encoder_output_)};
+  }
+
+  Result<std::vector<EValue>> decode(
+      const executorch::aten::Tensor& encoder_states,
+      const executorch::aten::Tensor& cache_position) {
+    encoder_state_buffers.push_back(encoder_states.const_data_ptr());
+    const int64_t position = cache_position.const_data_ptr<int64_t>()[0];
+    cache_positions.push_back(position);
+    const int64_t num_frames = encoder_states.size(1);
+    last_encoder_states.clear();
+    for (int64_t j = 0; j < num_frames; ++j) {
+      last_encoder_states.push_back(
+          encoder_states.const_data_ptr<float>()[j * encoder_states.size(2)]);
+    }
+    const int64_t token = (position + 1) * frames_per_token <= num_frames
+        ? kFirstToken + position
+        : kEosToken;
+    std::vector<float> logits(kVocabSize, 0.0f);
+    logits[token] = 1.0f;
+    logits_ = make_tensor_ptr({1, 1, kVocabSize}, std::move(logits));
+    return std::vector<EValue>{EValue(*logits_)};
+  }
+
+  TensorPtr encoder_output_;
+  TensorPtr logits_;
+};
+
+// Decodes every token to its id followed by a space.
+class StubTokenizer : public ::tokenizers::Tokenizer {
+ public:
+  ::tokenizers::Error load(const std::string&) override {
+    return ::tokenizers::Error::Ok;
+  }
+  bool is_loaded() const override {
+    return true;
+  }
+  ::tokenizers::Result<std::vector<uint64_t>> encode(
+      const std::string&,
+      int8_t,
+      int8_t) const override {
+    return ::tokenizers::Error::EncodeFailure;
+  }
+  ::tokenizers::Result<std::string> decode(
+      uint64_t,
+      uint64_t token,
+      bool) const override {
+    return std::to_string(token) + " ";
+  }
+  ::tokenizers::Result<std::string> id_to_piece(uint64_t) const override {
+    return ::tokenizers::Error::DecodeFailure;
+  }
+  ::tokenizers::Result<uint64_t> piece_to_id(
+      const std::string&) const override {
+    return ::tokenizers::Error::EncodeFailure;
+  }
+};
+
+class AsrRunnerTest : public Test {
+ protected:
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+    auto module = std::make_unique<StubModule>();
+    module_ = module.get();
+    runner_ = std::make_unique<AsrRunner>(
+        std::move(module),
+        std::make_unique<StubTokenizer>(),
+        std::unordered_set<int64_t>{kEosToken});
+  }
+
+  // Features of frames [first_frame, first_frame + num_frames), whose first
+  // feature is the frame index.
+  static TensorPtr make_chunk(
+      int64_t first_frame,
+      int64_t num_frames,
+      int64_t num_features = 3) {
+    std::vector<float> features(num_frames * num_features, 0.0f);
+    for (int64_t i = 0; i < num_frames; ++i) {
+      features[i * num_features] = static_cast<float>(first_frame + i);
+    }
+    return make_tensor_ptr(
+        {1,
+         static_cast<executorch::aten::SizesType>(num_frames),
+         static_cast<executorch::aten::SizesType>(num_features)},
+        std::move(features));
+  }
+
+  Error begin_stream(
+      AsrStreamingConfig streaming_config,
+      AsrTranscribeConfig config = {}) {
+    return runner_->begin_stream(
+        config, streaming_config, [this](const std::string& piece) {
+          text_ += piece;
+        });
+  }
+
+  StubModule* module_;
+  std::unique_ptr<AsrRunner> runner_;
+  std::string text_;
+};
+
+} // namespace
+
+TEST_F(AsrRunnerTest, StreamKeepsEncoderStatesOfChunksOnly) {
+  ASSERT_EQ(begin_stream({4, 6, 100, 0}), Error::Ok);
+  for (int64_t chunk = 0; chunk < 3; ++chunk) {
+    ASSERT_EQ(
+        runner_->transcribe_chunk(make_chunk(chunk * 6, 6)), Error::Ok);
+  }
+
+  // Every chunk is encoded with the 4 frames before it, whose 2 encoder
+  // frames are dropped.
+  EXPECT_EQ(
+      module_->last_encoder_states,
+      (std::vector<float>{0, 2, 4, 6, 8, 10, 12, 14, 16}));
+  auto result = runner_->end_stream();
+  ASSERT_TRUE(result.ok());
+  // 9 encoder frames support 4 tokens.
+  EXPECT_EQ(
+      result.get(), (std::vector<int64_t>{0, 10, 11, 12, 13, kEosToken}));
+  EXPECT_EQ(text_, "10 11 12 13 1 ");
+}
+
+TEST_F(AsrRunnerTest, StreamRedecodesAfterEosOnPartialAudio) {
+  ASSERT_EQ(begin_stream({0, 4, 100, 0}), Error::Ok);
+
+  // 2 encoder frames support 1 token, and the second step sees EOS.
+  ASSERT_EQ(runner_->transcribe_chunk(make_chunk(0, 4)), Error::Ok);
+  EXPECT_EQ(module_->cache_positions, (std::vector<int64_t>{0, 1}));
+  EXPECT_EQ(text_, "10 ");
+
+  // The EOS was not kept: the next chunk decodes position 1 again.
+  ASSERT_EQ(runner_->transcribe_chunk(make_chunk(4, 4)), Error::Ok);
+  EXPECT_EQ(module_->cache_positions, (std::vector<int64_t>{0, 1, 1, 2}));
+  EXPECT_EQ(text_, "10 11 ");
+
+  // At the end of the stream, EOS is final.
+  auto result = runner_->end_stream();
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.get(), (std::vector<int64_t>{0, 10, 11, kEosToken}));
+  EXPECT_EQ(module_->cache_positions, (std::vector<int64_t>{0, 1, 1, 2, 2}));
+  EXPECT_EQ(text_, "10 11 1 ");
+}
+
+TEST_F(AsrRunnerTest, StreamStopsAtMaxNewTokens) {
+  AsrTranscribeConfig config;
+  config.max_new_tokens = 3;
+  ASSERT_EQ(begin_stream({0, 20, 100, 0}, config), Error::Ok);
+  ASSERT_EQ(runner_->transcribe_chunk(make_chunk(0, 20)), Error::Ok);
+
+  auto result = runner_->end_stream();
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.get(), (std::vector<int64_t>{0, 10, 11, 12}));
+}
+
+TEST_F(AsrRunnerTest, StreamBoundsTokensPerChunk) {
+  ASSERT_EQ(begin_stream({0, 20, 100, 2}), Error::Ok);
+
+  // 10 encoder frames support 5 tokens, but only 2 are decoded per chunk.
+  ASSERT_EQ(runner_->transcribe_chunk(make_chunk(0, 20)), Error::Ok);
+  EXPECT_EQ(text_, "10 11 ");
+  ASSERT_EQ(runner_->transcribe_chunk(make_chunk(20, 2)), Error::Ok);
+  EXPECT_EQ(text_, "10 11 12 13 ");
+
+  // The end of the stream is not bounded.
+  auto result = runner_->end_stream();
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(
+      result.get(), (std::vector<int64_t>{0, 10, 11, 12, 13, 14, kEosToken}));
+}
+
+TEST_F(AsrRunnerTest, StreamFailsPastMaxEncoderFrames) {
+  ASSERT_EQ(begin_stream({0, 10, 8, 0}), Error::Ok);
+  ASSERT_EQ(runner_->transcribe_chunk(make_chunk(0, 10)), Error::Ok);
+  // 5 more encoder frames do not fit in 8.
+  EXPECT_EQ(
+      runner_->transcribe_chunk(make_chunk(10, 10)), Error::OutOfResources);
+}
+
+TEST_F(AsrRunnerTest, StreamRejectsInvalidChunks) {
+  EXPECT_EQ(runner_->transcribe_chunk(make_chunk(0, 4)), Error::InvalidState);
+  ASSERT_EQ(begin_stream({0, 4, 100, 0}), Error::Ok);
+  // More frames than max_chunk_frames.
+  EXPECT_EQ(
+      runner_->transcribe_chunk(make_chunk(0, 6)), Error::InvalidArgument);
+
+  // The number of features cannot change within a stream.
+  ASSERT_EQ(runner_->transcribe_chunk(make_chunk(0, 4, 3)), Error::Ok);
+  EXPECT_EQ(
+      runner_->transcribe_chunk(make_chunk(4, 4, 5)), Error::InvalidArgument);
+  ASSERT_TRUE(runner_->end_stream().ok());
+
+  // But it can in the next stream.
+  ASSERT_EQ(begin_stream({0, 4, 100, 0}), Error::Ok);
+  EXPECT_EQ(runner_->transcribe_chunk(make_chunk(0, 4, 5)), Error::Ok);
+}
+
+TEST_F(AsrRunnerTest, StreamReusesBuffers) {
+  const AsrStreamingConfig streaming_config{2, 4, 100, 0};
+  for (int stream = 0; stream < 2; ++stream) {
+    ASSERT_EQ(begin_stream(streaming_config), Error::Ok);
+    for (int64_t chunk = 0; chunk < 3; ++chunk) {
+      ASSERT_EQ(
+          runner_->transcribe_chunk(make_chunk(chunk * 4, 4)), Error::Ok);
+    }
+    ASSERT_TRUE(runner_->end_stream().ok());
+  }
+  const void* features = module_->feature_buffers.front();
+  for (const void* buffer : module_->feature_buffers) {
+    EXPECT_EQ(buffer, features);
+  }
+  const void* encoder_states = module_->encoder_state_buffers.front();
+  for (const void* buffer : module_->encoder_state_buffers) {
+    EXPECT_EQ(buffer, encoder_states);
+  }
+
+  // Larger buffers are allocated for a config that needs them.
+  ASSERT_EQ(begin_stream({2, 8, 200, 0}), Error::Ok);
+  ASSERT_EQ(runner_->transcribe_chunk(make_chunk(0, 8)), Error::Ok);
+  EXPECT_NE(module_->feature_buffers.back(), features);
+  EXPECT_NE(module_->encoder_state_buffers.back(), encoder_states);
+  ASSERT_TRUE(runner_->end_stream().ok());
+}
@@ -186,11 +186,47 @@ def custom_sdpa(
     return torch.empty_like(query)
 
 
+@impl(custom_ops_lib, "custom_ring_sdpa", "Meta")
+def custom_ring_sdpa_meta(
+    query,
+    key_cache,
+    value_cache,
+    start_pos,
+    window_size,
+    sink_size=0,
+    scale=None,
+):
+    seq_len = query.size(1)
+    _validate_params(
+        query,
+        key_cache,
+        value_cache,
+        key_cache,
+        value_cache,
+        start_pos,
+        seq_len,
+        None,
+        0.0,
+        False,
+        scale,
+    )
+    assert window_size > 0, f"Expected window_size > 0 but got {window_size}"
+    assert (
+        0 <= sink_size < key_cache.size(1)
+    ), f"Expected sink_size in [0, {key_cache.size(1)}) but got {sink_size}"
+    assert (
+        key_cache.size(1) - sink_size >= window_size + seq_len - 1
+    ), f"A ring of {key_cache.size(1) - sink_size} slots cannot hold a window of {window_size} for {seq_len} queries"
+
+    return torch.empty_like(query)
+
+
 def _validate_update_cache_params(
     value,
     cache,
     start_pos,
     indices=None,
+    quantized=False,
 ):
     seq_len = value.size(1)
     assert (
@@ -198,7 +234,7 @@ def _validate_update_cache_params(
     ), f"Expected value to be 4 dimensional but got {value.dim()} dimensions."
 
     assert (
-        value.dtype == cache.dtype
+        quantized or value.dtype == cache.dtype
     ), f"Expected value and cache to be of the same type but got value type {value.dtype} and cache type {cache.dtype}"
 
     for i in [0, 2, 3]:
@@ -251,6 +287,69 @@ def update_cache_meta(
     return torch.empty((1,), dtype=value.dtype, device="meta")
 
 
+@impl(custom_ops_lib, "update_quantized_cache", "Meta")
+def update_quantized_cache_meta(
+    value,
+    cache,
+    cache_scales,
+    cache_zero_points,
+    start_pos,
+):
+    assert (
+        value.dtype == torch.float32
+    ), f"Expected value to be float32 but got {value.dtype}"
+    assert (
+        cache.dtype == torch.int8
+    ), f"Expected cache to be int8 but got {cache.dtype}"
+    assert (
+        cache_scales.dtype == torch.float32
+    ), f"Expected cache_scales to be float32 but got {cache_scales.dtype}"
+    assert (
+        cache_zero_points.dtype == torch.int8
+    ), f"Expected cache_zero_points to be int8 but got {cache_zero_points.dtype}"
+    for qparams in (cache_scales, cache_zero_points):
+        assert (
+            qparams.size()[:-1] == cache.size()[:-1] and qparams.size(-1) == 1
+        ), f"Expected cache qparams of size {cache.size()[:-1] + (1,)} but got {qparams.size()}"
+    _validate_update_cache_params(
+        value,
+        cache,
+        start_pos,
+        quantized=True,
+    )
+
+    return torch.empty((1,), dtype=value.dtype, device="meta")
+
+
+@impl(custom_ops_lib, "update_ring_cache", "Meta")
+def update_ring_cache_meta(
+    value,
+    cache,
+    start_pos,
+    sink_size=0,
+):
+    assert (
+        value.dim() == 4 and cache.dim() == 4
+    ), f"Expected value and cache to be 4 dimensional but got {value.dim()} and {cache.dim()}"
+    assert (
+        value.dtype == cache.dtype
+    ), f"Expected value and cache to be of the same type but got value type {value.dtype} and cache type {cache.dtype}"
+    for i in [0, 2, 3]:
+        assert value.size(i) == cache.size(
+            i
+        ), f"Expected value and cache to have same size in dimension {i} but got {value.size(i)} and {cache.size(i)}"
+    torch._check_is_size(start_pos)
+    assert (
+        0 <= sink_size < cache.size(1)
+    ), f"Expected sink_size in [0, {cache.size(1)}) but got {sink_size}"
+    # Positions wrap around, so only the length of an update is bounded.
+    assert (
+        value.size(1) <= cache.size(1) - sink_size
+    ), f"Update of length {value.size(1)} does not fit in the ring of {cache.size(1) - sink_size} slots"
+
+    return torch.empty((1,), dtype=value.dtype, device="meta")
+
+
 @impl(custom_ops_lib, "update_cache_with_indices", "Meta")
 def update_cache_with_indices_meta(
     value,
@@ -299,8 +398,10 @@ def _validate_quantized_sdpa_params(
         value.dim() == 4
     ), f"Expected value to be 4 dimensional but got {value.dim()} dimensions."
 
-    assert (q_scale is not None) and (
-        q_zero_point is not None
+    # A float query can attend to an int8 key and value, without qparams.
+    is_quantized_query = query.dtype == torch.int8
+    assert not is_quantized_query or (
+        (q_scale is not None) and (q_zero_point is not None)
     ), "q_scale and q_zero_point must be provided"
     assert (k_scale is not None) and (
         k_zero_point is not None
@@ -309,16 +410,20 @@ def _validate_quantized_sdpa_params(
         v_zero_point is not None
     ), "v_scale and v_zero_point must be provided"
 
-    assert query.dtype == torch.int8, f"Expected query to be int8 but got {query.dtype}"
+    assert query.dtype in (
+        torch.int8,
+        torch.float32,
+    ), f"Expected query to be int8 or float32 but got {query.dtype}"
     assert key.dtype == torch.int8, f"Expected key to be int8 but got {key.dtype}"
     assert value.dtype == torch.int8, f"Expected value to be int8 but got {value.dtype}"
 
-    assert (
-        q_scale.dtype == torch.float32
-    ), f"Expected q_scale to be float32 but got {q_scale.dtype}"
-    assert (
-        q_zero_point.dtype == torch.int8
-    ), f"Expected q_zero_point to be int8 but got {q_zero_point.dtype}"
+    if is_quantized_query:
+        assert (
+            q_scale.dtype == torch.float32
+        ), f"Expected q_scale to be float32 but got {q_scale.dtype}"
+        assert (
+            q_zero_point.dtype == torch.int8
+        ), f"Expected q_zero_point to be int8 but got {q_zero_point.dtype}"
     assert (
         k_scale.dtype == torch.float32
     ), f"Expected k_scale to be float32 but got {k_scale.dtype}"
@@ -332,12 +437,13 @@ def _validate_quantized_sdpa_params(
         v_zero_point.dtype == torch.int8
     ), f"Expected v_zero_point to be int8 but got {v_zero_point.dtype}"
 
-    assert (
-        query.size()[:-1] == q_scale.size()[:-1]
-    ), f"Expected query and q_scale to have same size except last dimensions but got {query.size()} and {q_scale.size()}"
-    assert (
-        query.size()[:-1] == q_zero_point.size()[:-1]
-    ), f"Expected query and q_zero_point to have same size except last dimensions but got {query.size()} and {q_zero_point.size()}"
+    if is_quantized_query:
+        assert (
+            query.size()[:-1] == q_scale.size()[:-1]
+        ), f"Expected query and q_scale to have same size except last dimensions but got {query.size()} and {q_scale.size()}"
+        assert (
+            query.size()[:-1] == q_zero_point.size()[:-1]
+        ), f"Expected query and q_zero_point to have same size except last dimensions but got {query.size()} and {q_zero_point.size()}"
 
     assert (
         key.size()[:-1] == k_scale.size()[:-1]
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Checks custom_quantized_sdpa with a float query and an int8 KV cache
+// against a float reference over the dequantized cache.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <executorch/extension/llm/custom_ops/op_sdpa.h>
+
+#include <executorch/kernels/test/TestUtil.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::testing::TensorFactory;
+
+namespace {
+
+constexpr int32_t kBatch = 2;
+constexpr int32_t kNumHeads = 4;
+constexpr int32_t kNumKvHeads = 2;
+
+struct Config {
+  int32_t seq_len;
+  int32_t start_pos;
+  int32_t cache_len;
+  int32_t head_dim;
+  bool is_seq_at_dim_2;
+};
+
+// An int8 cache with a scale and zero point per row of head_dim values, as
+// update_quantized_cache writes it, and its dequantized values.
+struct QuantizedCache {
+  std::vector<int8_t> values;
+  std::vector<float> scales;
+  std::vector<int8_t> zero_points;
+  std::vector<float> dequantized;
+};
+
+QuantizedCache make_quantized_cache(
+    int32_t num_rows,
+    int32_t head_dim,
+    std::mt19937& generator) {
+  std::uniform_real_distribution<float> distribution(-2.0f, 2.0f);
+  QuantizedCache cache;
+  for (int32_t row = 0; row < num_rows; ++row) {
+    std::vector<float> values(head_dim);
+    for (auto& value : values) {
+      value = distribution(generator);
+    }
+    const auto [min, max] = std::minmax_element(values.begin(), values.end());
+    const float min_value = std::min(*min, 0.0f);
+    const float max_value = std::max(*max, 0.0f);
+    const float scale = (max_value - min_value) / 255.0f;
+    const int32_t zero_point = std::clamp<int32_t>(
+        static_cast<int32_t>(std::nearbyint(-128.0f - min_value / scale)),
+        -128,
+        127);
+    cache.scales.push_back(scale);
+    cache.zero_points.push_back(static_cast<int8_t>(zero_point));
+    for (float value : values) {
+      const int32_t quantized = std::clamp<int32_t>(
+          static_cast<int32_t>(std::nearbyint(value / scale)) + zero_point,
+          -128,
+          127);
+      cache.values.push_back(static_cast<int8_t>(quantized));
+      cache.dequantized.push_back((quantized - zero_point) * scale);
+    }
+  }
+  return cache;
+}
+
+// The sizes of a [batch, seq, heads, dim] tensor in the given layout.
+std::vector<int32_t>
+sizes(int32_t seq, int32_t heads, int32_t dim, bool is_seq_at_dim_2) {
+  return is_seq_at_dim_2 ? std::vector<int32_t>{kBatch, heads, seq, dim}
+                         : std::vector<int32_t>{kBatch, seq, heads, dim};
+}
+
+int64_t offset(
+    int32_t b,
+    int32_t s,
+    int32_t h,
+    int32_t seq,
+    int32_t heads,
+    int32_t dim,
+    bool is_seq_at_dim_2) {
+  return is_seq_at_dim_2 ? ((int64_t(b) * heads + h) * seq + s) * dim
+                         : ((int64_t(b) * seq + s) * heads + h) * dim;
+}
+
+// Causal attention of each query at start_pos + s over the keys up to it.
+std::vector<float> reference_sdpa(
+    const std::vector<float>& q,
+    const std::vector<float>& k,
+    const std::vector<float>& v,
+    const Config& config) {
+  const int32_t seq = config.seq_len;
+  const int32_t cache_len = config.cache_len;
+  const int32_t dim = config.head_dim;
+  const bool dim_2 = config.is_seq_at_dim_2;
+  std::vector<float> out(q.size());
+  for (int32_t b = 0; b < kBatch; ++b) {
+    for (int32_t h = 0; h < kNumHeads; ++h) {
+      const int32_t h_kv = h / (kNumHeads / kNumKvHeads);
+      for (int32_t s = 0; s < seq; ++s) {
+        const float* q_row =
+            &q[offset(b, s, h, seq, kNumHeads, dim, dim_2)];
+        const int32_t num_keys = config.start_pos + s + 1;
+        std::vector<double> weights(num_keys);
+        double max_weight = -INFINITY;
+        for (int32_t n = 0; n < num_keys; ++n) {
+          const float* k_row =
+              &k[offset(b, n, h_kv, cache_len, kNumKvHeads, dim, dim_2)];
+          double dot = 0;
+          for (int32_t d = 0; d < dim; ++d) {
+            dot += double(q_row[d]) * k_row[d];
+          }
+          weights[n] = dot / std::sqrt(double(dim));
+          max_weight = std::max(max_weight, weights[n]);
+        }
+        double sum = 0;
+        for (auto& weight : weights) {
+          weight = std::exp(weight - max_weight);
+          sum += weight;
+        }
+        float* out_row = &out[offset(b, s, h, seq, kNumHeads, dim, dim_2)];
+        for (int32_t d = 0; d < dim; ++d) {
+          double value = 0;
+          for (int32_t n = 0; n < num_keys; ++n) {
+            value += weights[n] *
+                v[offset(b, n, h_kv, cache_len, kNumKvHeads, dim, dim_2) + d];
+          }
+          out_row[d] = static_cast<float>(value / sum);
+        }
+      }
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+class OpQuantizedSDPATest : public OperatorTest {
+ protected:
+  void expect_matches_reference(const Config& config);
+};
+
+void OpQuantizedSDPATest::expect_matches_reference(const Config& config) {
+  SCOPED_TRACE(
+      testing::Message() << "seq_len=" << config.seq_len
+                         << " start_pos=" << config.start_pos
+                         << " head_dim=" << config.head_dim
+                         << " is_seq_at_dim_2=" << config.is_seq_at_dim_2);
+  std::mt19937 generator(config.seq_len * 1000 + config.start_pos);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  const int32_t dim = config.head_dim;
+
+  std::vector<float> q_data(kBatch * config.seq_len * kNumHeads * dim);
+  for (auto& value : q_data) {
+    value = distribution(generator);
+  }
+  const int32_t num_cache_rows = kBatch * config.cache_len * kNumKvHeads;
+  const QuantizedCache k_cache =
+      make_quantized_cache(num_cache_rows, dim, generator);
+  const QuantizedCache v_cache =
+      make_quantized_cache(num_cache_rows, dim, generator);
+
+  TensorFactory<ScalarType::Float> tf_float;
+  TensorFactory<ScalarType::Char> tf_char;
+  const auto cache_sizes =
+      sizes(config.cache_len, kNumKvHeads, dim, config.is_seq_at_dim_2);
+  const auto qparams_sizes =
+      sizes(config.cache_len, kNumKvHeads, 1, config.is_seq_at_dim_2);
+  Tensor q = tf_float.make(
+      sizes(config.seq_len, kNumHeads, dim, config.is_seq_at_dim_2), q_data);
+  Tensor k = tf_char.make(cache_sizes, k_cache.values);
+  Tensor v = tf_char.make(cache_sizes, v_cache.values);
+  Tensor k_scales = tf_float.make(qparams_sizes, k_cache.scales);
+  Tensor k_zero_points = tf_char.make(qparams_sizes, k_cache.zero_points);
+  Tensor v_scales = tf_float.make(qparams_sizes, v_cache.scales);
+  Tensor v_zero_points = tf_char.make(qparams_sizes, v_cache.zero_points);
+  Tensor out = tf_float.zeros(
+      sizes(config.seq_len, kNumHeads, dim, config.is_seq_at_dim_2));
+
+  torch::executor::native::custom_quantized_sdpa_out(
+      context_,
+      q,
+      k,
+      v,
+      config.start_pos,
+      {},
+      0.0,
+      /*is_causal=*/true,
+      {},
+      {},
+      {},
+      k_zero_points,
+      k_scales,
+      v_zero_points,
+      v_scales,
+      config.is_seq_at_dim_2,
+      out);
+  ASSERT_EQ(context_.failure_state(), executorch::runtime::Error::Ok);
+
+  const std::vector<float> expected = reference_sdpa(
+      q_data, k_cache.dequantized, v_cache.dequantized, config);
+  const float* actual = out.const_data_ptr<float>();
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_NEAR(actual[i], expected[i], 1e-4) << "at " << i;
+  }
+}
+
+// Up to 4 queries dot the int8 keys directly and use the fused int8 value
+// kernel.
+TEST_F(OpQuantizedSDPATest, FloatQueryDecodeMatchesReference) {
+  for (bool is_seq_at_dim_2 : {false, true}) {
+    for (int32_t seq_len : {1, 3, 4}) {
+      expect_matches_reference({seq_len, 0, 64, 32, is_seq_at_dim_2});
+      expect_matches_reference({seq_len, 37, 64, 20, is_seq_at_dim_2});
+    }
+  }
+}
+
+// More queries dequantize the key and value blocks and use BLAS.
+TEST_F(OpQuantizedSDPATest, FloatQueryPrefillMatchesReference) {
+  for (bool is_seq_at_dim_2 : {false, true}) {
+    for (int32_t seq_len : {5, 16, 40}) {
+      expect_matches_reference({seq_len, 0, 64, 32, is_seq_at_dim_2});
+      expect_matches_reference({seq_len, 9, 64, 20, is_seq_at_dim_2});
+    }
+  }
+}
+
+// Contexts past one block of 512 keys.
+TEST_F(OpQuantizedSDPATest, FloatQueryLongContextMatchesReference) {
+  for (bool is_seq_at_dim_2 : {false, true}) {
+    for (int32_t seq_len : {1, 8}) {
+      expect_matches_reference({seq_len, 1100, 1200, 16, is_seq_at_dim_2});
+    }
+  }
+}
@@ -49,9 +49,14 @@ bool validate_flash_attention_args(
       "Query must be Float type");
 
   ET_CHECK_OR_RETURN_FALSE(
-      (query.scalar_type() == key.scalar_type()) &&
-          (query.scalar_type() == value.scalar_type()),
-      "Key and Value must have the same data type as Query");
+      key.scalar_type() == value.scalar_type(),
+      "Key and Value must have the same data type");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      (query.scalar_type() == key.scalar_type()) ||
+          (query.scalar_type() == ScalarType::Float &&
+           key.scalar_type() == ScalarType::Char),
+      "Key and Value must have the same data type as Query, or be int8 with a Float Query");
 
   ET_CHECK_OR_RETURN_FALSE(
       !attn_mask.has_value() || attn_mask.value().dim() == 2,
@@ -258,6 +263,13 @@ Tensor& flash_attention_kernel_out(
       InvalidArgument,
       output);
 
+  ET_KERNEL_CHECK_MSG(
+      ctx,
+      query.scalar_type() == key.scalar_type(),
+      InvalidArgument,
+      output,
+      "An int8 key and value need custom_quantized_sdpa");
+
   ET_KERNEL_CHECK(
       ctx,
       resize_tensor(output, query.sizes()) == Error::Ok,
@@ -345,7 +357,8 @@ Tensor& custom_sdpa_out_impl(
     const optional<Tensor>& k_scales = nullopt,
     const optional<Tensor>& v_zero_points = nullopt,
     const optional<Tensor>& v_scales = nullopt,
-    bool is_seq_at_dim_2 = false) {
+    bool is_seq_at_dim_2 = false,
+    const optional<RingKVCacheLayout>& ring_cache = nullopt) {
   ET_KERNEL_CHECK_MSG(
       ctx,
       !attn_mask.has_value() || !is_causal,
@@ -365,19 +378,17 @@ Tensor& custom_sdpa_out_impl(
   if (!is_seq_at_dim_2) {
     seq_dim = SeqDim::ONE;
   }
+  if (seq_dim == SeqDim::TWO) {
+    seq_len = q.size(2);
+  }
 
   if (q.scalar_type() == ScalarType::Char) {
-    if (seq_dim == SeqDim::TWO) {
-      seq_len = q.size(2);
-    }
     ET_KERNEL_CHECK_MSG(
         ctx,
-        q_scales.has_value() && q_zero_points.has_value() &&
-            k_scales.has_value() && k_zero_points.has_value() &&
-            q_scales.has_value() && q_zero_points.has_value(),
+        q_scales.has_value() && q_zero_points.has_value(),
         InvalidArgument,
         output,
-        "If q is quantized, k and v must be quantized as well");
+        "A quantized q needs its scales and zero points");
     ET_KERNEL_CHECK_MSG(
         ctx,
         validate_cache_quant_params_args(
@@ -385,6 +396,16 @@ Tensor& custom_sdpa_out_impl(
         InvalidArgument,
         output,
         "Invalid arguments for quantized query");
+  }
+
+  if (k.scalar_type() == ScalarType::Char) {
+    ET_KERNEL_CHECK_MSG(
+        ctx,
+        k_scales.has_value() && k_zero_points.has_value() &&
+            v_scales.has_value() && v_zero_points.has_value(),
+        InvalidArgument,
+        output,
+        "A quantized k and v need their scales and zero points");
     ET_KERNEL_CHECK_MSG(
         ctx,
         validate_cache_quant_params_args(
@@ -403,8 +424,12 @@ Tensor& custom_sdpa_out_impl(
 
   ET_CHECK_MSG(q.dim() == 4, "query must be a 4D tensor");
 
-  const int64_t num_keys_for_causal_attention =
-      attn_mask.has_value() ? -1 : start_pos + seq_len;
+  // A ring buffer cache is full once it has wrapped around.
+  const int64_t num_keys_for_causal_attention = attn_mask.has_value()
+      ? -1
+      : ring_cache.has_value()
+      ? std::min(start_pos + seq_len, ring_cache->capacity)
+      : start_pos + seq_len;
 
   ET_KERNEL_CHECK(
       ctx,
@@ -438,7 +463,8 @@ Tensor& custom_sdpa_out_impl(
               v_scales, // v_scales
               seq_dim, /* seq_dim */
               start_pos,
-              num_keys_for_causal_attention);
+              num_keys_for_causal_attention,
+              ring_cache);
         } else if (seq_len >= 192) {
           sdpa::impl::cpu_flash_attention<CTYPE, 64, 512>(
               ctx,
@@ -458,7 +484,8 @@ Tensor& custom_sdpa_out_impl(
               v_scales, // v_scales
               seq_dim, /* seq_dim */
               start_pos,
-              num_keys_for_causal_attention);
+              num_keys_for_causal_attention,
+              ring_cache);
         } else {
           sdpa::impl::cpu_flash_attention<CTYPE, 32, 512>(
               ctx,
@@ -478,7 +505,8 @@ Tensor& custom_sdpa_out_impl(
               v_scales, // v_scales
               seq_dim, /* seq_dim */
               start_pos,
-              num_keys_for_causal_attention);
+              num_keys_for_causal_attention,
+              ring_cache);
         }
       });
   return output;
@@ -553,6 +581,78 @@ Tensor& custom_sdpa_out(
   return custom_sdpa_out_impl(
       ctx, q, k, v, start_pos, attn_mask, dropout_p, is_causal, scale, output);
 }
+
+/*
+  Input params
+  @param[in] q Query of the tokens at start_pos onwards.
+  Format [batch size, seq_len, num heads, head dim]
+  @param[in] k, v Key and value caches used as ring buffers, already updated
+  with update_ring_cache. Format [batch size, capacity, num kv heads, head dim]
+  @param[in] start_pos: sequence position of the first query
+  @param[in] window_size: each query attends to the window_size positions up
+  to its own
+  @param[in] sink_size: and to the first sink_size positions, which the first
+  slots of the caches keep
+*/
+Tensor& custom_ring_sdpa_out(
+    RuntimeContext& ctx,
+    const Tensor& q,
+    const Tensor& k,
+    const Tensor& v,
+    const int64_t start_pos,
+    const int64_t window_size,
+    const int64_t sink_size,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output) {
+  ET_KERNEL_CHECK_MSG(
+      ctx,
+      q.dim() == 4 && k.dim() == 4,
+      InvalidArgument,
+      output,
+      "query and key must be 4D tensors");
+  const RingKVCacheLayout layout{k.size(1), sink_size, window_size};
+  ET_KERNEL_CHECK_MSG(
+      ctx,
+      start_pos >= 0 && window_size > 0 && sink_size >= 0 &&
+          sink_size < layout.capacity,
+      InvalidArgument,
+      output,
+      "Need start_pos >= 0, window_size > 0 and sink_size in [0, %zd)",
+      k.size(1));
+  // Otherwise the last queries of the chunk would overwrite keys in the window
+  // of the first ones.
+  ET_KERNEL_CHECK_MSG(
+      ctx,
+      layout.ring_size() >= window_size + q.size(1) - 1,
+      InvalidArgument,
+      output,
+      "A ring of %" PRId64 " slots cannot hold a window of %" PRId64
+      " for %zd queries",
+      layout.ring_size(),
+      window_size,
+      q.size(1));
+
+  return custom_sdpa_out_impl(
+      ctx,
+      q,
+      k,
+      v,
+      start_pos,
+      nullopt,
+      0.0,
+      /*is_causal=*/false,
+      scale,
+      output,
+      nullopt,
+      nullopt,
+      nullopt,
+      nullopt,
+      nullopt,
+      nullopt,
+      /*is_seq_at_dim_2=*/false,
+      layout);
+}
 /*
   Input params
   @param[in] q_projected Projected query with query weights.
@@ -624,6 +724,13 @@ EXECUTORCH_LIBRARY(
     "custom_sdpa.out",
     torch::executor::native::custom_sdpa_out);
 
+// Attends to a sliding window, and attention sinks, of caches used as ring
+// buffers, masking from the positions their slots hold.
+EXECUTORCH_LIBRARY(
+    llama,
+    "custom_ring_sdpa.out",
+    torch::executor::native::custom_ring_sdpa_out);
+
 EXECUTORCH_LIBRARY(
     llama,
     "custom_quantized_sdpa.out",
@@ -44,6 +44,21 @@ Tensor& custom_sdpa_out(
     const optional<double> scale,
     Tensor& output);
 
+// custom_sdpa over key and value caches used as ring buffers: each query
+// attends to the window_size positions up to its own, and to the first
+// sink_size positions. See RingKVCacheLayout.
+Tensor& custom_ring_sdpa_out(
+    RuntimeContext& ctx,
+    const Tensor& q,
+    const Tensor& k,
+    const Tensor& v,
+    const int64_t start_pos,
+    const int64_t window_size,
+    const int64_t sink_size,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output);
+
 Tensor& flash_attention_kernel_out(
     KernelRuntimeContext& ctx,
     const Tensor& query,
@@ -77,6 +77,27 @@ at::Tensor custom_sdpa_aten(
     // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
     const std::optional<double> scale);
 
+Tensor& custom_ring_sdpa_out_no_context(
+    const Tensor& q,
+    const Tensor& k,
+    const Tensor& v,
+    const int64_t start_pos,
+    const int64_t window_size,
+    const int64_t sink_size,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output);
+
+at::Tensor custom_ring_sdpa_aten(
+    const at::Tensor& q,
+    const at::Tensor& k,
+    const at::Tensor& v,
+    const int64_t start_pos,
+    const int64_t window_size,
+    const int64_t sink_size,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const std::optional<double> scale);
+
 Tensor& custom_quantized_sdpa_out_no_context(
     const Tensor& q,
     const Tensor& k,
@@ -129,6 +150,34 @@ at::Tensor update_cache_aten(
     at::Tensor& cache,
     const int64_t start_pos);
 
+Tensor& update_quantized_cache_out_no_context(
+    const Tensor& value,
+    Tensor& cache,
+    Tensor& cache_scales,
+    Tensor& cache_zero_points,
+    const int64_t start_pos,
+    Tensor& output);
+
+at::Tensor update_quantized_cache_aten(
+    const at::Tensor& value,
+    at::Tensor& cache,
+    at::Tensor& cache_scales,
+    at::Tensor& cache_zero_points,
+    const int64_t start_pos);
+
+Tensor& update_ring_cache_out_no_context(
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    Tensor& output);
+
+at::Tensor update_ring_cache_aten(
+    const at::Tensor& value,
+    at::Tensor& cache,
+    const int64_t start_pos,
+    const int64_t sink_size);
+
 // New functions for update_cache_with_indices
 Tensor& update_cache_with_indices_out_no_context(
     const Tensor& value,
@@ -253,6 +302,36 @@ at::Tensor custom_sdpa_aten(
   return output;
 }
 
+Tensor& custom_ring_sdpa_out_no_context(
+    const Tensor& q,
+    const Tensor& k,
+    const Tensor& v,
+    const int64_t start_pos,
+    const int64_t window_size,
+    const int64_t sink_size,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output) {
+  executorch::aten::RuntimeContext context{};
+  return torch::executor::native::custom_ring_sdpa_out(
+      context, q, k, v, start_pos, window_size, sink_size, scale, output);
+}
+
+at::Tensor custom_ring_sdpa_aten(
+    const at::Tensor& q,
+    const at::Tensor& k,
+    const at::Tensor& v,
+    const int64_t start_pos,
+    const int64_t window_size,
+    const int64_t sink_size,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const std::optional<double> scale) {
+  auto output = at::empty(q.sizes());
+  WRAP_TO_ATEN(custom_ring_sdpa_out_no_context, 7)
+  (q, k, v, start_pos, window_size, sink_size, scale, output);
+  return output;
+}
+
 Tensor& custom_quantized_sdpa_out_no_context(
     const Tensor& q,
     const Tensor& k,
@@ -354,6 +433,52 @@ at::Tensor update_cache_aten(
   return output;
 }
 
+Tensor& update_quantized_cache_out_no_context(
+    const Tensor& value,
+    Tensor& cache,
+    Tensor& cache_scales,
+    Tensor& cache_zero_points,
+    const int64_t start_pos,
+    Tensor& output) {
+  executorch::aten::RuntimeContext context{};
+  return torch::executor::native::update_quantized_cache_out(
+      context, value, cache, cache_scales, cache_zero_points, start_pos, output);
+}
+
+at::Tensor update_quantized_cache_aten(
+    const at::Tensor& value,
+    at::Tensor& cache,
+    at::Tensor& cache_scales,
+    at::Tensor& cache_zero_points,
+    const int64_t start_pos) {
+  auto output = at::empty({1});
+  WRAP_TO_ATEN(update_quantized_cache_out_no_context, 5)
+  (value, cache, cache_scales, cache_zero_points, start_pos, output);
+  return output;
+}
+
+Tensor& update_ring_cache_out_no_context(
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    Tensor& output) {
+  executorch::aten::RuntimeContext context{};
+  return torch::executor::native::update_ring_cache_out(
+      context, value, cache, start_pos, sink_size, output);
+}
+
+at::Tensor update_ring_cache_aten(
+    const at::Tensor& value,
+    at::Tensor& cache,
+    const int64_t start_pos,
+    const int64_t sink_size) {
+  auto output = at::empty({1});
+  WRAP_TO_ATEN(update_ring_cache_out_no_context, 4)
+  (value, cache, start_pos, sink_size, output);
+  return output;
+}
+
 // Implementations for update_cache_with_indices
 Tensor& update_cache_with_indices_out_no_context(
     const Tensor& value,
@@ -398,12 +523,32 @@ TORCH_LIBRARY_FRAGMENT(llama, m) {
       "custom_sdpa.out(Tensor query, Tensor key, Tensor value, SymInt start_pos, "
       "Tensor? attn_mask=None, float drpout_p=0.0, bool is_causal=False, "
       "float? scale=None, *, Tensor(a!) out) -> Tensor(a!)");
+  m.def(
+      "custom_ring_sdpa(Tensor query, Tensor key, Tensor value, SymInt start_pos, "
+      "int window_size, int sink_size=0, float? scale=None) -> Tensor");
+  m.def(
+      "custom_ring_sdpa.out(Tensor query, Tensor key, Tensor value, SymInt start_pos, "
+      "int window_size, int sink_size=0, float? scale=None, *, Tensor(a!) out) -> Tensor(a!)");
   m.def(
       "update_cache(Tensor value, Tensor(a!) cache, "
       "SymInt start_pos) -> Tensor");
   m.def(
       "update_cache.out(Tensor value, Tensor(a!) cache, "
       "SymInt start_pos, *, Tensor(b!) out) -> Tensor(b!)");
+  m.def(
+      "update_quantized_cache(Tensor value, Tensor(a!) cache, "
+      "Tensor(b!) cache_scales, Tensor(c!) cache_zero_points, "
+      "SymInt start_pos) -> Tensor");
+  m.def(
+      "update_quantized_cache.out(Tensor value, Tensor(a!) cache, "
+      "Tensor(b!) cache_scales, Tensor(c!) cache_zero_points, "
+      "SymInt start_pos, *, Tensor(d!) out) -> Tensor(d!)");
+  m.def(
+      "update_ring_cache(Tensor value, Tensor(a!) cache, "
+      "SymInt start_pos, int sink_size=0) -> Tensor");
+  m.def(
+      "update_ring_cache.out(Tensor value, Tensor(a!) cache, "
+      "SymInt start_pos, int sink_size=0, *, Tensor(b!) out) -> Tensor(b!)");
   m.def(
       "update_cache_with_indices(Tensor value, Tensor(a!) cache, "
       "SymInt start_pos, Tensor indices) -> Tensor");
@@ -436,10 +581,26 @@ TORCH_LIBRARY_IMPL(llama, CompositeExplicitAutograd, m) {
   m.impl(
       "custom_sdpa.out",
       WRAP_TO_ATEN(torch::executor::native::custom_sdpa_out_no_context, 8));
+  m.impl("custom_ring_sdpa", torch::executor::native::custom_ring_sdpa_aten);
+  m.impl(
+      "custom_ring_sdpa.out",
+      WRAP_TO_ATEN(torch::executor::native::custom_ring_sdpa_out_no_context, 7));
   m.impl("update_cache", torch::executor::native::update_cache_aten);
   m.impl(
       "update_cache.out",
       WRAP_TO_ATEN(torch::executor::native::update_cache_out_no_context, 3));
+  m.impl(
+      "update_quantized_cache",
+      torch::executor::native::update_quantized_cache_aten);
+  m.impl(
+      "update_quantized_cache.out",
+      WRAP_TO_ATEN(
+          torch::executor::native::update_quantized_cache_out_no_context, 5));
+  m.impl("update_ring_cache", torch::executor::native::update_ring_cache_aten);
+  m.impl(
+      "update_ring_cache.out",
+      WRAP_TO_ATEN(
+          torch::executor::native::update_ring_cache_out_no_context, 4));
   m.impl(
       "update_cache_with_indices",
       torch::executor::native::update_cache_with_indices_aten);
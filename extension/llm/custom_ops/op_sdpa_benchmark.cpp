@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Measures a decode step of custom_sdpa, one query token attending to a KV
+// cache filled up to the given context length, with a float32 cache and with
+// an int8 cache and a float32 query. The heads are those of Llama 3 8B: 32
+// query heads, 8 KV heads of 128. The "cache_MiB" counter is the size of the
+// K and V caches of one layer read by the step, scales and zero points
+// included, and "tokens/s" is the decode rate of one layer.
+//
+// BM_DecodeRingCache generates from the given position on with a ring-buffer
+// cache of 4 attention sinks and a window of 4096 positions, each step writing
+// its key and value with update_ring_cache before custom_ring_sdpa. Its
+// "cache_MiB" stays the same however far the generation goes.
+//
+// BM_DecodeFewHeads measures the decode step of a small model, 14 query heads
+// and 2 KV heads of 64 as in Qwen2.5 0.5B, for the given context length and
+// number of threads. With fewer heads than threads, the keys are split across
+// threads.
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <executorch/extension/llm/custom_ops/op_sdpa.h>
+#include <executorch/extension/llm/custom_ops/op_update_cache.h>
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/extension/threadpool/threadpool.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using executorch::aten::ScalarType;
+using executorch::extension::empty;
+using executorch::extension::full;
+using executorch::extension::rand;
+using executorch::extension::randint;
+
+namespace {
+
+constexpr int32_t kNumHeads = 32;
+constexpr int32_t kNumKvHeads = 8;
+constexpr int32_t kHeadDim = 128;
+constexpr int32_t kSinkSize = 4;
+constexpr int32_t kWindowSize = 4096;
+constexpr int32_t kSmallNumHeads = 14;
+constexpr int32_t kSmallNumKvHeads = 2;
+constexpr int32_t kSmallHeadDim = 64;
+
+executorch::extension::TensorPtr random_int8(
+    std::vector<executorch::aten::SizesType> sizes) {
+  return randint(-128, 127, std::move(sizes), ScalarType::Char);
+}
+
+void set_counters(benchmark::State& state, double cache_bytes) {
+  state.counters["cache_MiB"] = cache_bytes / (1 << 20);
+  state.counters["tokens/s"] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+void BM_DecodeFloatCache(benchmark::State& state) {
+  executorch::runtime::runtime_init();
+  const int32_t context = state.range(0);
+  auto q = rand({1, 1, kNumHeads, kHeadDim});
+  auto k = rand({1, context, kNumKvHeads, kHeadDim});
+  auto v = rand({1, context, kNumKvHeads, kHeadDim});
+  auto out = empty({1, 1, kNumHeads, kHeadDim});
+
+  for (auto _ : state) {
+    executorch::runtime::KernelRuntimeContext ctx{};
+    torch::executor::native::custom_sdpa_out(
+        ctx, *q, *k, *v, context - 1, {}, 0.0, true, {}, *out);
+    benchmark::DoNotOptimize(out->const_data_ptr());
+  }
+  set_counters(state, 2.0 * context * kNumKvHeads * kHeadDim * sizeof(float));
+}
+
+void BM_DecodeInt8Cache(benchmark::State& state) {
+  executorch::runtime::runtime_init();
+  const int32_t context = state.range(0);
+  auto q = rand({1, 1, kNumHeads, kHeadDim});
+  auto k = random_int8({1, context, kNumKvHeads, kHeadDim});
+  auto v = random_int8({1, context, kNumKvHeads, kHeadDim});
+  auto k_scales = full({1, context, kNumKvHeads, 1}, 0.01f);
+  auto v_scales = full({1, context, kNumKvHeads, 1}, 0.01f);
+  auto k_zero_points = random_int8({1, context, kNumKvHeads, 1});
+  auto v_zero_points = random_int8({1, context, kNumKvHeads, 1});
+  auto out = empty({1, 1, kNumHeads, kHeadDim});
+
+  for (auto _ : state) {
+    executorch::runtime::KernelRuntimeContext ctx{};
+    torch::executor::native::custom_quantized_sdpa_out(
+        ctx,
+        *q,
+        *k,
+        *v,
+        context - 1,
+        {},
+        0.0,
+        true,
+        {},
+        {},
+        {},
+        *k_zero_points,
+        *k_scales,
+        *v_zero_points,
+        *v_scales,
+        /*is_seq_at_dim_2=*/false,
+        *out);
+    benchmark::DoNotOptimize(out->const_data_ptr());
+  }
+  set_counters(
+      state,
+      2.0 * context * kNumKvHeads * (kHeadDim + sizeof(float) + 1));
+}
+
+void BM_DecodeRingCache(benchmark::State& state) {
+  executorch::runtime::runtime_init();
+  const int64_t start_pos = state.range(0);
+  const int32_t capacity = kSinkSize + kWindowSize;
+  auto q = rand({1, 1, kNumHeads, kHeadDim});
+  auto k = rand({1, 1, kNumKvHeads, kHeadDim});
+  auto v = rand({1, 1, kNumKvHeads, kHeadDim});
+  auto k_cache = rand({1, capacity, kNumKvHeads, kHeadDim});
+  auto v_cache = rand({1, capacity, kNumKvHeads, kHeadDim});
+  auto update_out = empty({1});
+  auto out = empty({1, 1, kNumHeads, kHeadDim});
+
+  int64_t pos = start_pos;
+  for (auto _ : state) {
+    executorch::runtime::KernelRuntimeContext ctx{};
+    torch::executor::native::update_ring_cache_out(
+        ctx, *k, *k_cache, pos, kSinkSize, *update_out);
+    torch::executor::native::update_ring_cache_out(
+        ctx, *v, *v_cache, pos, kSinkSize, *update_out);
+    torch::executor::native::custom_ring_sdpa_out(
+        ctx, *q, *k_cache, *v_cache, pos, kWindowSize, kSinkSize, {}, *out);
+    benchmark::DoNotOptimize(out->const_data_ptr());
+    ++pos;
+  }
+  set_counters(state, 2.0 * capacity * kNumKvHeads * kHeadDim * sizeof(float));
+}
+
+void BM_DecodeFewHeads(benchmark::State& state) {
+  executorch::runtime::runtime_init();
+  const int32_t context = state.range(0);
+  ::executorch::extension::threadpool::get_threadpool()
+      ->_unsafe_reset_threadpool(state.range(1));
+  auto q = rand({1, 1, kSmallNumHeads, kSmallHeadDim});
+  auto k = rand({1, context, kSmallNumKvHeads, kSmallHeadDim});
+  auto v = rand({1, context, kSmallNumKvHeads, kSmallHeadDim});
+  auto out = empty({1, 1, kSmallNumHeads, kSmallHeadDim});
+
+  for (auto _ : state) {
+    executorch::runtime::KernelRuntimeContext ctx{};
+    torch::executor::native::custom_sdpa_out(
+        ctx, *q, *k, *v, context - 1, {}, 0.0, true, {}, *out);
+    benchmark::DoNotOptimize(out->const_data_ptr());
+  }
+  set_counters(
+      state, 2.0 * context * kSmallNumKvHeads * kSmallHeadDim * sizeof(float));
+}
+
+BENCHMARK(BM_DecodeFloatCache)
+    ->ArgName("context")
+    ->Arg(8192)
+    ->Arg(16384)
+    ->Arg(32768)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(BM_DecodeInt8Cache)
+    ->ArgName("context")
+    ->Arg(8192)
+    ->Arg(16384)
+    ->Arg(32768)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(BM_DecodeRingCache)
+    ->ArgName("start_pos")
+    ->Arg(8192)
+    ->Arg(65536)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(BM_DecodeFewHeads)
+    ->ArgNames({"context", "threads"})
+    ->ArgsProduct({{4096, 16384, 65536}, {1, 4, 8, 16}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+} // namespace
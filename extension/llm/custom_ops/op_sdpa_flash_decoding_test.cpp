@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Checks custom_sdpa and custom_ring_sdpa on threadpools larger than batch x
+// heads, where a few queries have their keys split across threads, against a
+// float64 reference.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include <executorch/extension/llm/custom_ops/op_sdpa.h>
+#include <executorch/extension/llm/custom_ops/ring_kv_cache.h>
+#include <executorch/extension/threadpool/threadpool.h>
+
+#include <executorch/kernels/test/TestUtil.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::testing::TensorFactory;
+using torch::executor::native::RingKVCacheLayout;
+
+namespace {
+
+struct Shape {
+  int32_t batch;
+  int32_t num_heads;
+  int32_t num_kv_heads;
+  int32_t head_dim;
+  int32_t seq_len;
+  int32_t cache_len;
+};
+
+std::vector<float> random_values(size_t size, std::mt19937& generator) {
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  std::vector<float> values(size);
+  for (auto& value : values) {
+    value = distribution(generator);
+  }
+  return values;
+}
+
+// Attention of q [batch, seq_len, heads, dim] over the cache slots each query
+// attends to, for k and v [batch, cache_len, kv heads, dim].
+std::vector<float> reference_sdpa(
+    const std::vector<float>& q,
+    const std::vector<float>& k,
+    const std::vector<float>& v,
+    const Shape& shape,
+    const std::function<bool(int32_t, int32_t)>& attends) {
+  const int32_t dim = shape.head_dim;
+  std::vector<float> out(q.size());
+  for (int32_t b = 0; b < shape.batch; ++b) {
+    for (int32_t s = 0; s < shape.seq_len; ++s) {
+      for (int32_t h = 0; h < shape.num_heads; ++h) {
+        const int32_t h_kv = h / (shape.num_heads / shape.num_kv_heads);
+        const int64_t q_offset =
+            ((int64_t(b) * shape.seq_len + s) * shape.num_heads + h) * dim;
+        std::vector<double> weights(shape.cache_len, 0.0);
+        double max_weight = -INFINITY;
+        for (int32_t n = 0; n < shape.cache_len; ++n) {
+          if (!attends(s, n)) {
+            weights[n] = -INFINITY;
+            continue;
+          }
+          const int64_t k_offset =
+              ((int64_t(b) * shape.cache_len + n) * shape.num_kv_heads +
+               h_kv) *
+              dim;
+          double dot = 0;
+          for (int32_t d = 0; d < dim; ++d) {
+            dot += double(q[q_offset + d]) * k[k_offset + d];
+          }
+          weights[n] = dot / std::sqrt(double(dim));
+          max_weight = std::max(max_weight, weights[n]);
+        }
+        double sum = 0;
+        for (auto& weight : weights) {
+          weight = std::isinf(weight) ? 0.0 : std::exp(weight - max_weight);
+          sum += weight;
+        }
+        for (int32_t d = 0; d < dim; ++d) {
+          double value = 0;
+          for (int32_t n = 0; n < shape.cache_len; ++n) {
+            value += weights[n] *
+                v[((int64_t(b) * shape.cache_len + n) * shape.num_kv_heads +
+                   h_kv) *
+                      dim +
+                  d];
+          }
+          out[q_offset + d] = static_cast<float>(value / sum);
+        }
+      }
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+class OpSDPAFlashDecodingTest : public OperatorTest {
+ protected:
+  void SetUp() override {
+    OperatorTest::SetUp();
+    num_threads_ =
+        ::executorch::extension::threadpool::get_threadpool()
+            ->get_thread_count();
+  }
+
+  void TearDown() override {
+    set_num_threads(num_threads_);
+    OperatorTest::TearDown();
+  }
+
+  static void set_num_threads(uint32_t num_threads) {
+    ::executorch::extension::threadpool::get_threadpool()
+        ->_unsafe_reset_threadpool(num_threads);
+  }
+
+  // Runs custom_sdpa, or custom_ring_sdpa with ring, for the queries at
+  // start_pos onwards, and compares it with the reference.
+  void expect_matches_reference(
+      const Shape& shape,
+      int64_t start_pos,
+      const RingKVCacheLayout* ring = nullptr) {
+    SCOPED_TRACE(
+        testing::Message() << "batch=" << shape.batch
+                           << " heads=" << shape.num_heads
+                           << " seq_len=" << shape.seq_len
+                           << " start_pos=" << start_pos
+                           << " ring=" << (ring != nullptr));
+    std::mt19937 generator(start_pos * 16 + shape.seq_len);
+    const auto q_data = random_values(
+        size_t(shape.batch) * shape.seq_len * shape.num_heads * shape.head_dim,
+        generator);
+    const size_t cache_numel = size_t(shape.batch) * shape.cache_len *
+        shape.num_kv_heads * shape.head_dim;
+    const auto k_data = random_values(cache_numel, generator);
+    const auto v_data = random_values(cache_numel, generator);
+
+    TensorFactory<ScalarType::Float> tf;
+    const std::vector<int32_t> q_sizes = {
+        shape.batch, shape.seq_len, shape.num_heads, shape.head_dim};
+    const std::vector<int32_t> cache_sizes = {
+        shape.batch, shape.cache_len, shape.num_kv_heads, shape.head_dim};
+    Tensor q = tf.make(q_sizes, q_data);
+    Tensor k = tf.make(cache_sizes, k_data);
+    Tensor v = tf.make(cache_sizes, v_data);
+    Tensor out = tf.zeros(q_sizes);
+
+    std::function<bool(int32_t, int32_t)> attends;
+    if (ring != nullptr) {
+      torch::executor::native::custom_ring_sdpa_out(
+          context_,
+          q,
+          k,
+          v,
+          start_pos,
+          ring->window_size,
+          ring->sink_size,
+          {},
+          out);
+      const int64_t last_pos = start_pos + shape.seq_len - 1;
+      attends = [=](int32_t s, int32_t slot) {
+        return ring->attends(start_pos + s, ring->position(slot, last_pos));
+      };
+    } else {
+      torch::executor::native::custom_sdpa_out(
+          context_, q, k, v, start_pos, {}, 0.0, true, {}, out);
+      attends = [=](int32_t s, int32_t n) { return n <= start_pos + s; };
+    }
+    ASSERT_EQ(context_.failure_state(), executorch::runtime::Error::Ok);
+
+    const auto expected = reference_sdpa(q_data, k_data, v_data, shape, attends);
+    const float* actual = out.const_data_ptr<float>();
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_NEAR(actual[i], expected[i], 1e-4) << "at " << i;
+    }
+  }
+
+ private:
+  uint32_t num_threads_ = 1;
+};
+
+// One sequence of 2 heads is 2 tasks, fewer than all but the first threadpool.
+TEST_F(OpSDPAFlashDecodingTest, DecodeSplitsKeysAcrossThreads) {
+  for (uint32_t num_threads : {1, 3, 8, 16}) {
+    set_num_threads(num_threads);
+    SCOPED_TRACE(testing::Message() << "threads=" << num_threads);
+    for (int32_t seq_len : {1, 5, 8}) {
+      const Shape shape{1, 2, 2, 64, seq_len, 2048};
+      for (int64_t start_pos : {0, 700, 1500, 2048 - seq_len}) {
+        expect_matches_reference(shape, start_pos);
+      }
+    }
+    // Grouped query heads over 2 sequences.
+    expect_matches_reference({2, 4, 2, 32, 1, 1200}, 1100);
+  }
+}
+
+// Above kFlashDecodingMaxQSize queries the keys are not split.
+TEST_F(OpSDPAFlashDecodingTest, PrefillOnLargeThreadpool) {
+  set_num_threads(16);
+  expect_matches_reference({1, 2, 1, 64, 9, 1024}, 600);
+  expect_matches_reference({1, 1, 1, 64, 40, 1024}, 0);
+}
+
+// Splits of the ring whose slots are all outside the window are masked.
+TEST_F(OpSDPAFlashDecodingTest, RingDecodeSplitsKeysAcrossThreads) {
+  for (uint32_t num_threads : {1, 4, 16}) {
+    set_num_threads(num_threads);
+    SCOPED_TRACE(testing::Message() << "threads=" << num_threads);
+    for (int32_t seq_len : {1, 4}) {
+      // A ring of 3000 slots, most of them outside of the window.
+      const RingKVCacheLayout ring{4 + 3000, 4, 500};
+      const Shape shape{
+          1, 2, 2, 32, seq_len, static_cast<int32_t>(ring.capacity)};
+      for (int64_t start_pos : {0, 700, 1600, 5000}) {
+        expect_matches_reference(shape, start_pos, &ring);
+      }
+    }
+  }
+}
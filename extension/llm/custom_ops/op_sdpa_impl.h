@@ -10,6 +10,7 @@
 
 #include <ATen/cpu/vec/vec.h>
 #include <ATen/cpu/vec/vec_n.h>
+#include <executorch/extension/llm/custom_ops/ring_kv_cache.h>
 #include <executorch/kernels/optimized/blas/CPUBlas.h>
 #include <executorch/kernels/optimized/vec/functional.h>
 #include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
@@ -35,6 +36,10 @@ enum class SeqDim { ONE = 1, TWO };
 
 namespace sdpa::impl {
 
+// Queries up to this many, as when decoding one token or verifying a few
+// speculated ones, may have cpu_flash_attention split the keys across threads.
+constexpr int64_t kFlashDecodingMaxQSize = 8;
+
 struct MaybeQuantizedMatrixData {
   const void* data{nullptr};
   const int8_t* zero_points{nullptr};
@@ -62,6 +67,18 @@ struct MaybeQuantizedMatrixData {
         dtype(dtype_) {}
 };
 
+// Defined below, after the dequantization helpers it uses.
+inline void _float_q_at_quantized_k_gemm(
+    const int64_t q_m,
+    const int64_t k_n,
+    const int64_t qk_k,
+    const float* q_data,
+    const int64_t q_stride_m,
+    const MaybeQuantizedMatrixData& k_data,
+    const int64_t k_stride_n,
+    float* qk_data,
+    float* buf_qdq_ptr);
+
 template <typename accum_t>
 void _q_at_k_gemm(
     const int64_t q_m,
@@ -71,12 +88,33 @@ void _q_at_k_gemm(
     const int64_t q_stride_m,
     const MaybeQuantizedMatrixData& k_data,
     const int64_t k_stride_n,
-    accum_t* qk_data) {
-  ET_CHECK_MSG(q_data.dtype == k_data.dtype, "q and k must have same dtype");
+    accum_t* qk_data,
+    accum_t* buf_qdq_ptr) {
+  ET_CHECK_MSG(
+      q_data.dtype == k_data.dtype ||
+          (q_data.dtype == ScalarType::Float &&
+           k_data.dtype == ScalarType::Char),
+      "q and k must have same dtype, or k must be int8 for a float q");
   ET_CHECK_MSG(
       q_data.dtype == ScalarType::Char || q_data.dtype == ScalarType::Float,
       "q and k must be either int8 or float");
-  if (q_data.dtype == ScalarType::Char) {
+  if (k_data.dtype == ScalarType::Char && q_data.dtype == ScalarType::Float) {
+    if constexpr (std::is_same<accum_t, float>::value) {
+      _float_q_at_quantized_k_gemm(
+          q_m,
+          k_n,
+          qk_k,
+          static_cast<const float*>(q_data.data),
+          q_stride_m,
+          k_data,
+          k_stride_n,
+          qk_data,
+          buf_qdq_ptr);
+    } else {
+      ET_CHECK_MSG(
+          false, "Accumulation in dtype other than float not supported yet");
+    }
+  } else if (q_data.dtype == ScalarType::Char) {
     if constexpr (std::is_same<accum_t, float>::value) {
       int a_stride_m_tmp, b_stride_n_tmp;
       auto kernel = torchao::kernels::cpu::quantized_matmul::
@@ -203,6 +241,88 @@ void dequantize_per_channel_optimized(
   }
 }
 
+// q @ k.T for a float q and an int8 k with per row scales and zero points.
+// A few query rows, as in decode, dot the int8 rows directly:
+// q . k_n = scale_n * (q . k_int8_n - zero_point_n * sum(q)), so the cache is
+// read once at a quarter of the float bytes. More rows dequantize the block
+// into buf_qdq_ptr and use BLAS.
+inline void _float_q_at_quantized_k_gemm(
+    const int64_t q_m,
+    const int64_t k_n,
+    const int64_t qk_k,
+    const float* q_data,
+    const int64_t q_stride_m,
+    const MaybeQuantizedMatrixData& k_data,
+    const int64_t k_stride_n,
+    float* qk_data,
+    float* buf_qdq_ptr) {
+  const int8_t* k_int8 = static_cast<const int8_t*>(k_data.data);
+  if (q_m > 4) {
+    dequantize_per_channel_optimized(
+        k_int8,
+        k_data.scales,
+        k_data.zero_points,
+        buf_qdq_ptr,
+        -128,
+        127,
+        1,
+        0,
+        0,
+        k_n,
+        k_stride_n,
+        qk_k,
+        qk_k,
+        k_data.zero_points_stride);
+    ::executorch::cpublas::gemm(
+        ::executorch::cpublas::TransposeType::Transpose,
+        ::executorch::cpublas::TransposeType::NoTranspose,
+        k_n,
+        q_m,
+        qk_k,
+        1.0f,
+        buf_qdq_ptr,
+        qk_k,
+        q_data,
+        q_stride_m,
+        0.0f,
+        qk_data,
+        k_n);
+    return;
+  }
+  // Independent partial sums that the compiler keeps in vector registers.
+  constexpr int64_t kLanes = 8;
+  for (int64_t row = 0; row < q_m; ++row) {
+    const float* q_row = q_data + row * q_stride_m;
+    float q_sum = 0;
+    for (int64_t d = 0; d < qk_k; ++d) {
+      q_sum += q_row[d];
+    }
+    for (int64_t n = 0; n < k_n; ++n) {
+      const int8_t* k_row = k_int8 + n * k_stride_n;
+      float partial[kLanes] = {};
+      int64_t d = 0;
+      for (; d + kLanes <= qk_k; d += kLanes) {
+        for (int64_t lane = 0; lane < kLanes; ++lane) {
+          partial[lane] +=
+              q_row[d + lane] * static_cast<float>(k_row[d + lane]);
+        }
+      }
+      float dot = 0;
+      for (int64_t lane = 0; lane < kLanes; ++lane) {
+        dot += partial[lane];
+      }
+      for (; d < qk_k; ++d) {
+        dot += q_row[d] * static_cast<float>(k_row[d]);
+      }
+      const int64_t qparams_offset = n * k_data.zero_points_stride;
+      const float zero_point =
+          static_cast<float>(k_data.zero_points[qparams_offset]);
+      qk_data[row * k_n + n] =
+          k_data.scales[qparams_offset] * (dot - zero_point * q_sum);
+    }
+  }
+}
+
 void dequant_and_gemm(
     const int64_t m,
     const int64_t n,
@@ -512,7 +632,9 @@ TODO: Just handle conversion of bool mask to float
  *
  * This function computes scaled dot-product attention with optimizations for
  CPU.
- * It supports both regular and quantized attention computation.
+ * It supports both regular and quantized attention computation. The key and
+ value can be int8 with a float query, as with an int8 KV cache; the query
+ zero points and scales are then unused.
  *
  * @tparam scalar_t The data type for computation (e.g., float)
  * @tparam q_split_size Block size for query matrix in tiling algorithm
@@ -540,6 +662,13 @@ TODO: Just handle conversion of bool mask to float
  * @param start_pos Starting position for causal masking in generation
  * @param num_keys_for_causal_attention Number of keys to consider for causal
  attention (-1 for all)
+ * @param ring_cache Layout of key and value if they are a ring buffer cache,
+ in which case the mask follows from the positions their slots hold and
+ is_causal must be false
+ *
+ * With at most kFlashDecodingMaxQSize queries and fewer batch x heads than
+ threads, the keys are split across threads as well, flash-decoding style, and
+ the partial results merged with the log-sum-exp of each split.
  */
 template <typename scalar_t, int64_t q_split_size, int64_t kv_split_size>
 void cpu_flash_attention(
@@ -560,7 +689,8 @@ void cpu_flash_attention(
     const optional<Tensor>& v_scales,
     const SeqDim seq_dim = SeqDim::TWO,
     const int64_t start_pos = 0,
-    const int64_t num_keys_for_causal_attention = -1) {
+    const int64_t num_keys_for_causal_attention = -1,
+    const optional<RingKVCacheLayout>& ring_cache = nullopt) {
   (void)dropout_p;
 
   // Without this we have out-of-bounds writes for
@@ -614,6 +744,9 @@ void cpu_flash_attention(
       num_head,
       num_heads_kv);
   int64_t num_reps = num_head / num_heads_kv;
+  // The last position written to a ring buffer cache, which determines the
+  // position in each of its slots.
+  const int64_t ring_last_pos = start_pos + qSize - 1;
 
   bool has_attn_mask = attn_mask.has_value() && attn_mask.value().numel();
   if (has_attn_mask) {
@@ -641,6 +774,9 @@ void cpu_flash_attention(
 
   bool is_quantized_sdpa = false;
   is_quantized_sdpa = query.scalar_type() == ScalarType::Char;
+  // An int8 key and value can also go with a float query, whose product with
+  // them dequantizes the cache as it reads it.
+  const bool is_quantized_kv = key.scalar_type() == ScalarType::Char;
 
   auto strides = query.strides();
   int64_t qStrideB = strides[0];
@@ -687,7 +823,13 @@ void cpu_flash_attention(
     q_quant_params_StrideB = q_strides[0];
     q_quant_params_StrideH = q_strides[1];
     q_quant_params_StrideM = q_strides[2];
+    if (seq_dim == SeqDim::ONE) {
+      q_quant_params_StrideH = q_strides[2];
+      q_quant_params_StrideM = q_strides[1];
+    }
+  }
 
+  if (is_quantized_kv) {
     auto k_strides = k_zero_points.value().strides();
     k_quant_params_StrideB = k_strides[0];
     k_quant_params_StrideH = k_strides[1];
@@ -700,13 +842,11 @@ void cpu_flash_attention(
 
     ET_CHECK_MSG(
         (v_quant_params_StrideN == k_quant_params_StrideN) &&
-            (v_quant_params_StrideN == q_quant_params_StrideM),
+            (!is_quantized_sdpa ||
+             v_quant_params_StrideN == q_zero_points.value().strides()[2]),
         "Quant params strides must be same for seq dim");
 
     if (seq_dim == SeqDim::ONE) {
-      q_quant_params_StrideH = q_strides[2];
-      q_quant_params_StrideM = q_strides[1];
-
       k_quant_params_StrideH = k_strides[2];
       k_quant_params_StrideN = k_strides[1];
 
@@ -804,298 +944,441 @@ void cpu_flash_attention(
   scalar_t* buf_reduced_data =
       is_reduced_type ? reinterpret_cast<scalar_t*>(buf_reduced) : nullptr;
 
-  auto compute_lambda = [&](int64_t begin, int64_t end) {
-    int64_t i = 0, j = 0, k = 0;
-    data_index_init(begin, i, batchSize, j, num_head, k, qSlice);
+  // Computes query block k of head j of batch i against the keys from
+  // kv_begin, a multiple of kvSplitSize, to kv_end. Leaves the max of each row
+  // of qk in qk_max_data, the sum of exp(qk - max) in qk_sum_data, and
+  // exp(qk - max) @ v, yet to be divided by that sum, in dst_data.
+  auto compute_block = [&](int64_t i,
+                           int64_t j,
+                           int64_t k,
+                           int64_t kv_begin,
+                           int64_t kv_end,
+                           accum_t* qk_max_data,
+                           accum_t* qk_sum_data,
+                           accum_t* dst_data) {
     int ompIdx = torch::executor::get_thread_num();
-    accum_t* buf_ptr = buf_data + ompIdx * size_per_thread;
-    accum_t* qk_data = buf_ptr;
-    accum_t* qk_max_data = qk_data + qSplitSize * kvSplitSize;
-    accum_t* qk_sum_data = qk_max_data + qSplitSize;
-    accum_t* dst_data = qk_sum_data + qSplitSize;
+    accum_t* qk_data = buf_data + ompIdx * size_per_thread;
     scalar_t* qk_reduced_data = is_reduced_type
         ? buf_reduced_data + ompIdx * qSplitSize * kvSplitSize
         : nullptr;
     accum_t* buf_qdq_ptr =
         scratch_for_quant_dequant + ompIdx * size_per_thread_qdq_vec;
 
-    for (int64_t z = begin; z < end; z++) {
-      int64_t m = k * qSplitSize;
-      int64_t qBlockSize = std::min(qSplitSize, qSize - m);
-      // Initialize max and sum
-      fill_stub(
-          qk_max_data, -std::numeric_limits<accum_t>::infinity(), qBlockSize);
-      fill_stub(qk_sum_data, static_cast<accum_t>(0), qBlockSize);
-      // Original flash sdpa wasnt really meant to be used
-      // for decode the way we are using via start_pos here.
-      // Thus when num_keys is 1 during decode phase, we
-      // still need to iterate through all the kv_splits
-      // Take start_pos = 130 and k_split_size = 128
-      // Here we have to produce [1x130] of q @ k.T
-      // when seq_len = 1
-      // But if num_keys = 1 then we dont really loop over
-      // all kv_splits.
-      // When k_split_size > 130, this is not an issue because
-      // there is only one iteration of the following loop anyway.
-      // Outside of determining how many loop iterations are needed
-      // num_keys participates only in causal attention.
-      // Rest of the calculation of q @ k.T and @ v.T is same.
-      // We dont run into this bug when k_split_size < start_pos + seqlen
-      // since there is only one iteration and that applies
-      // causal attention correctly.
-      // Howeve when k_split_size > start_pos + seqlen, we have
-      // more than one iteration, however if we dont adjust num_keys
-      // we dont get more than one iteration
-      // This is unique to this deployment of flash attention since
-      // original implementation wasnt deployed on this way.
-
-      // Some of these bugs can be resolved by relying on attention mask
-      // but that requires storing attention mask in float as the current
-      // code doesnt support bool attention mask.
-      // However, lets just fix that as well.
-      int64_t num_keys =
-          is_causal ? std::min(m + start_pos + qBlockSize, kvSize) : kvSize;
-      int64_t m_start_pos = m + start_pos;
-      auto j_kv = j / num_reps;
-      fill_stub(dst_data, static_cast<accum_t>(0), qSplitSize * headSize);
-      for (int64_t n = 0; n < num_keys; n += kvSplitSize) {
-        int64_t kvBlockSize = std::min(kvSplitSize, kvSize - n);
-        // Calculate scale * q @ k.T
-        fill_stub(qk_data, static_cast<accum_t>(0), qSplitSize * kvSplitSize);
-
-        const void* q_sub_matrix_data_ptr;
-        const void* k_sub_matrix_data_ptr;
-        const float* q_scales_ptr = nullptr;
-        const float* k_scales_ptr = nullptr;
-        const int8_t* q_zero_points_ptr = nullptr;
-        const int8_t* k_zero_points_ptr = nullptr;
-        int64_t q_offset = i * qStrideB + j * qStrideH + m * qStrideM;
-        int64_t k_offset = i * kStrideB + j_kv * kStrideH + n * kStrideN;
-        if (is_quantized_sdpa) {
-          int64_t q_quant_params_offset = i * q_quant_params_StrideB +
-              j * q_quant_params_StrideH + m * q_quant_params_StrideM;
-          int64_t k_quant_params_offset = i * k_quant_params_StrideB +
-              j_kv * k_quant_params_StrideH + n * k_quant_params_StrideN;
-          q_scales_ptr =
-              q_scales.value().const_data_ptr<float>() + q_quant_params_offset;
-          k_scales_ptr =
-              k_scales.value().const_data_ptr<float>() + k_quant_params_offset;
-          q_zero_points_ptr = q_zero_points.value().const_data_ptr<int8_t>() +
-              q_quant_params_offset;
-          k_zero_points_ptr = k_zero_points.value().const_data_ptr<int8_t>() +
-              k_quant_params_offset;
-          q_sub_matrix_data_ptr = (const int8_t*)(q_data) + q_offset;
-          k_sub_matrix_data_ptr = (const int8_t*)(k_data) + k_offset;
-        } else {
-          q_sub_matrix_data_ptr = (const scalar_t*)(q_data) + q_offset;
-          k_sub_matrix_data_ptr = (const scalar_t*)(k_data) + k_offset;
-        }
-        MaybeQuantizedMatrixData q_sub_matrix_data = MaybeQuantizedMatrixData(
-            static_cast<const void*>(q_sub_matrix_data_ptr),
-            q_zero_points_ptr,
-            q_scales_ptr,
-            qBlockSize,
-            headSize,
-            q_quant_params_StrideM,
-            query.scalar_type());
-        MaybeQuantizedMatrixData k_sub_matrix_data = MaybeQuantizedMatrixData(
-            static_cast<const void*>(k_sub_matrix_data_ptr),
-            k_zero_points_ptr,
-            k_scales_ptr,
-            kvBlockSize,
-            headSize,
-            k_quant_params_StrideN,
-            key.scalar_type());
-        _q_at_k_gemm<accum_t>(
-            qBlockSize,
-            kvBlockSize,
-            headSize,
-            q_sub_matrix_data,
-            qStrideM,
-            k_sub_matrix_data,
-            kStrideN,
-            qk_data);
-
-        // There are 4 cases that is_causal has to cover to fill
-        // not-attendable-position with -inf
-        /* 1. Everything is attended to. This happens when m_start_pos > n +
-        kvSplitSize e.g m_pos [8:15] and n_pos [0:7]. Since you must attend to
-        all previous tokens matrix is full
-        + + + + + + + +
-        + + + + + + + +
-        + + + + + + + +
-        + + + + + + + +
-        + + + + + + + +
-        + + + + + + + +
-        + + + + + + + +
-           2. Everything is not attended to. However only some tokens at the
-        beginning dont attend to everything. This happens when m_start_pos <= n
-        + kvSplitSize but m_start_pos + qBlockSize > n + kvSplitSize m_start_pos
-        = 8 qBlockSize = 8 n = 4 kvSplitSize = 8 For example m_pos [8:15] but
-        n_pos is [4:11]
-        + + + + + - - -
-        + + + + + + - -
-        + + + + + + + -
-        + + + + + + + +
-        + + + + + + + +
-        + + + + + + + +
-        + + + + + + + +
-        + + + + + + + +
-           3. In this case only last few tokens have something to attend to.
-        This happens when m_start_pos < n and m_start_pos + qBlockSize >= n and
-        m_start_pos + qBlockSize <= n + kvSplitSize m_start_pos = 8 qBlockSize =
-        8 n = 13 kvSplitSize = 8 For example m_pos [8:15] but n_pos is [13:20]
-        - - - - - - - -
-        - - - - - - - -
-        - - - - - - - -
-        - - - - - - - -
-        - - - - - - - -
-        + - - - - - - -
-        + + - - - - - -
-        + + + - - - - -
-           4. In this no tokens attend to anything, but we dont really have to
-        take care of this case because the loop for (int64_t n = 0; n <
-        num_keys; n += kvSplitSize) will exit before that.
-        */
-        if (is_causal && m_start_pos <= n + kvSplitSize) {
-          // For this fn to work k_split_size > q_split_size
-          for (int32_t row = 0;
-               row < qBlockSize && (m_start_pos + row < n + (kvSplitSize - 1));
-               ++row) {
-            // When last_col is 0, it means that the entire row is not attended
-            // to because m_pos is smaller than n_pos. So everything in n is for
-            // future.
-            int64_t last_col =
-                n > (m_start_pos + row) ? 0 : row + m_start_pos + 1 - n;
-            accum_t* row_ptr = qk_data + row * kvBlockSize;
-            fill_stub(
-                row_ptr + last_col,
-                -std::numeric_limits<accum_t>::infinity(),
-                kvBlockSize - last_col);
-          }
+    int64_t m = k * qSplitSize;
+    int64_t qBlockSize = std::min(qSplitSize, qSize - m);
+    // Initialize max and sum
+    fill_stub(
+        qk_max_data, -std::numeric_limits<accum_t>::infinity(), qBlockSize);
+    fill_stub(qk_sum_data, static_cast<accum_t>(0), qBlockSize);
+    // Original flash sdpa wasnt really meant to be used
+    // for decode the way we are using via start_pos here.
+    // Thus when num_keys is 1 during decode phase, we
+    // still need to iterate through all the kv_splits
+    // Take start_pos = 130 and k_split_size = 128
+    // Here we have to produce [1x130] of q @ k.T
+    // when seq_len = 1
+    // But if num_keys = 1 then we dont really loop over
+    // all kv_splits.
+    // When k_split_size > 130, this is not an issue because
+    // there is only one iteration of the following loop anyway.
+    // Outside of determining how many loop iterations are needed
+    // num_keys participates only in causal attention.
+    // Rest of the calculation of q @ k.T and @ v.T is same.
+    // We dont run into this bug when k_split_size < start_pos + seqlen
+    // since there is only one iteration and that applies
+    // causal attention correctly.
+    // Howeve when k_split_size > start_pos + seqlen, we have
+    // more than one iteration, however if we dont adjust num_keys
+    // we dont get more than one iteration
+    // This is unique to this deployment of flash attention since
+    // original implementation wasnt deployed on this way.
+
+    // Some of these bugs can be resolved by relying on attention mask
+    // but that requires storing attention mask in float as the current
+    // code doesnt support bool attention mask.
+    // However, lets just fix that as well.
+    int64_t num_keys =
+        is_causal ? std::min(m + start_pos + qBlockSize, kvSize) : kvSize;
+    int64_t m_start_pos = m + start_pos;
+    auto j_kv = j / num_reps;
+    fill_stub(dst_data, static_cast<accum_t>(0), qSplitSize * headSize);
+    for (int64_t n = kv_begin; n < std::min(num_keys, kv_end);
+         n += kvSplitSize) {
+      int64_t kvBlockSize = std::min(kvSplitSize, kvSize - n);
+      // Calculate scale * q @ k.T
+      fill_stub(qk_data, static_cast<accum_t>(0), qSplitSize * kvSplitSize);
+
+      const void* q_sub_matrix_data_ptr;
+      const void* k_sub_matrix_data_ptr;
+      const float* q_scales_ptr = nullptr;
+      const float* k_scales_ptr = nullptr;
+      const int8_t* q_zero_points_ptr = nullptr;
+      const int8_t* k_zero_points_ptr = nullptr;
+      int64_t q_offset = i * qStrideB + j * qStrideH + m * qStrideM;
+      int64_t k_offset = i * kStrideB + j_kv * kStrideH + n * kStrideN;
+      if (is_quantized_sdpa) {
+        int64_t q_quant_params_offset = i * q_quant_params_StrideB +
+            j * q_quant_params_StrideH + m * q_quant_params_StrideM;
+        q_scales_ptr =
+            q_scales.value().const_data_ptr<float>() + q_quant_params_offset;
+        q_zero_points_ptr = q_zero_points.value().const_data_ptr<int8_t>() +
+            q_quant_params_offset;
+        q_sub_matrix_data_ptr = (const int8_t*)(q_data) + q_offset;
+      } else {
+        q_sub_matrix_data_ptr = (const scalar_t*)(q_data) + q_offset;
+      }
+      if (is_quantized_kv) {
+        int64_t k_quant_params_offset = i * k_quant_params_StrideB +
+            j_kv * k_quant_params_StrideH + n * k_quant_params_StrideN;
+        k_scales_ptr =
+            k_scales.value().const_data_ptr<float>() + k_quant_params_offset;
+        k_zero_points_ptr = k_zero_points.value().const_data_ptr<int8_t>() +
+            k_quant_params_offset;
+        k_sub_matrix_data_ptr = (const int8_t*)(k_data) + k_offset;
+      } else {
+        k_sub_matrix_data_ptr = (const scalar_t*)(k_data) + k_offset;
+      }
+      MaybeQuantizedMatrixData q_sub_matrix_data = MaybeQuantizedMatrixData(
+          static_cast<const void*>(q_sub_matrix_data_ptr),
+          q_zero_points_ptr,
+          q_scales_ptr,
+          qBlockSize,
+          headSize,
+          q_quant_params_StrideM,
+          query.scalar_type());
+      MaybeQuantizedMatrixData k_sub_matrix_data = MaybeQuantizedMatrixData(
+          static_cast<const void*>(k_sub_matrix_data_ptr),
+          k_zero_points_ptr,
+          k_scales_ptr,
+          kvBlockSize,
+          headSize,
+          k_quant_params_StrideN,
+          key.scalar_type());
+      _q_at_k_gemm<accum_t>(
+          qBlockSize,
+          kvBlockSize,
+          headSize,
+          q_sub_matrix_data,
+          qStrideM,
+          k_sub_matrix_data,
+          kStrideN,
+          qk_data,
+          buf_qdq_ptr);
+
+      // There are 4 cases that is_causal has to cover to fill
+      // not-attendable-position with -inf
+      /* 1. Everything is attended to. This happens when m_start_pos > n +
+      kvSplitSize e.g m_pos [8:15] and n_pos [0:7]. Since you must attend to
+      all previous tokens matrix is full
+      + + + + + + + +
+      + + + + + + + +
+      + + + + + + + +
+      + + + + + + + +
+      + + + + + + + +
+      + + + + + + + +
+      + + + + + + + +
+         2. Everything is not attended to. However only some tokens at the
+      beginning dont attend to everything. This happens when m_start_pos <= n
+      + kvSplitSize but m_start_pos + qBlockSize > n + kvSplitSize m_start_pos
+      = 8 qBlockSize = 8 n = 4 kvSplitSize = 8 For example m_pos [8:15] but
+      n_pos is [4:11]
+      + + + + + - - -
+      + + + + + + - -
+      + + + + + + + -
+      + + + + + + + +
+      + + + + + + + +
+      + + + + + + + +
+      + + + + + + + +
+      + + + + + + + +
+         3. In this case only last few tokens have something to attend to.
+      This happens when m_start_pos < n and m_start_pos + qBlockSize >= n and
+      m_start_pos + qBlockSize <= n + kvSplitSize m_start_pos = 8 qBlockSize =
+      8 n = 13 kvSplitSize = 8 For example m_pos [8:15] but n_pos is [13:20]
+      - - - - - - - -
+      - - - - - - - -
+      - - - - - - - -
+      - - - - - - - -
+      - - - - - - - -
+      + - - - - - - -
+      + + - - - - - -
+      + + + - - - - -
+         4. In this no tokens attend to anything, but we dont really have to
+      take care of this case because the loop for (int64_t n = 0; n <
+      num_keys; n += kvSplitSize) will exit before that.
+      */
+      if (is_causal && m_start_pos <= n + kvSplitSize) {
+        // For this fn to work k_split_size > q_split_size
+        for (int32_t row = 0;
+             row < qBlockSize && (m_start_pos + row < n + (kvSplitSize - 1));
+             ++row) {
+          // When last_col is 0, it means that the entire row is not attended
+          // to because m_pos is smaller than n_pos. So everything in n is for
+          // future.
+          int64_t last_col =
+              n > (m_start_pos + row) ? 0 : row + m_start_pos + 1 - n;
+          accum_t* row_ptr = qk_data + row * kvBlockSize;
+          fill_stub(
+              row_ptr + last_col,
+              -std::numeric_limits<accum_t>::infinity(),
+              kvBlockSize - last_col);
         }
-        // Update attention weights with attention mask
-        // And apply scaling factor
-        // qk <- qk * scaling + attn_mask
-        if (has_attn_mask) {
+      }
+      // A ring buffer cache holds positions out of order, and those out of
+      // the window of a query, or not yet written, are masked out.
+      if (ring_cache.has_value()) {
+        for (int64_t col = 0; col < kvBlockSize; ++col) {
+          const int64_t key_pos = ring_cache->position(n + col, ring_last_pos);
           for (int64_t row = 0; row < qBlockSize; ++row) {
-            vec::map2<accum_t>(
-                [scaling_factor](Vec x, Vec y) {
-                  return x * Vec(scaling_factor) + y;
-                },
-                qk_data + row * kvBlockSize,
-                qk_data + row * kvBlockSize,
-                mask_data + i * mStrideB + j * mStrideH + (m + row) * mStrideM +
-                    n,
-                kvBlockSize);
+            if (!ring_cache->attends(m_start_pos + row, key_pos)) {
+              qk_data[row * kvBlockSize + col] =
+                  -std::numeric_limits<accum_t>::infinity();
+            }
           }
         }
-        // Update coefficients with Softmax
-        accum_t tmp_max = 0, tmp_sum = 0, exp_tmp = 0;
+      }
+      // Update attention weights with attention mask
+      // And apply scaling factor
+      // qk <- qk * scaling + attn_mask
+      if (has_attn_mask) {
         for (int64_t row = 0; row < qBlockSize; ++row) {
-          if (has_attn_mask) {
-            // max per row
-            tmp_max = vec::reduce_all<accum_t>(
-                [](Vec& x, Vec& y) { return vec::maximum(x, y); },
-                qk_data + row * kvBlockSize,
-                kvBlockSize);
-          } else {
-            // apply scaling factor and max per row in fusion
-            _mul_reduce_max_fusion_kernel(
-                qk_data + row * kvBlockSize,
-                scaling_factor,
-                kvBlockSize,
-                qk_data + row * kvBlockSize,
-                tmp_max);
-          }
-          tmp_max = qk_max_data[row] > tmp_max ? qk_max_data[row] : tmp_max;
-          if (tmp_max == -std::numeric_limits<accum_t>::infinity()) {
-            // to avoid `nan = exp2f(-inf - (-inf))`
-            fill_stub(
-                conditional_data_ptr(qk_data, qk_reduced_data) +
-                    row * kvBlockSize,
-                static_cast<scalar_t>(0),
-                kvBlockSize);
-          } else {
-            // qk <- exp(qk - max) and sum per row
-            tmp_sum = tmp_max;
-            _exp_reduce_sum_fusion_kernel(
-                qk_data + row * kvBlockSize,
-                kvBlockSize,
-                conditional_data_ptr(qk_data, qk_reduced_data) +
-                    row * kvBlockSize,
-                tmp_sum);
-            // exp_tmp <- exp(max[row] - max)
-            exp_tmp = std::exp(qk_max_data[row] - tmp_max);
-            // sum[row] <- sum + exp_tmp * sum[row]
-            qk_sum_data[row] = tmp_sum + exp_tmp * qk_sum_data[row];
-            // max[row] <- max
-            qk_max_data[row] = tmp_max;
-            // dst <- dst * exp_tmp
-            if (n > 0) {
-              vec::map<accum_t>(
-                  [exp_tmp](Vec x) { return x * Vec(exp_tmp); },
-                  dst_data + row * headSize,
-                  dst_data + row * headSize,
-                  headSize);
-            }
+          vec::map2<accum_t>(
+              [scaling_factor](Vec x, Vec y) {
+                return x * Vec(scaling_factor) + y;
+              },
+              qk_data + row * kvBlockSize,
+              qk_data + row * kvBlockSize,
+              mask_data + i * mStrideB + j * mStrideH + (m + row) * mStrideM +
+                  n,
+              kvBlockSize);
+        }
+      }
+      // Update coefficients with Softmax
+      accum_t tmp_max = 0, tmp_sum = 0, exp_tmp = 0;
+      for (int64_t row = 0; row < qBlockSize; ++row) {
+        if (has_attn_mask) {
+          // max per row
+          tmp_max = vec::reduce_all<accum_t>(
+              [](Vec& x, Vec& y) { return vec::maximum(x, y); },
+              qk_data + row * kvBlockSize,
+              kvBlockSize);
+        } else {
+          // apply scaling factor and max per row in fusion
+          _mul_reduce_max_fusion_kernel(
+              qk_data + row * kvBlockSize,
+              scaling_factor,
+              kvBlockSize,
+              qk_data + row * kvBlockSize,
+              tmp_max);
+        }
+        tmp_max = qk_max_data[row] > tmp_max ? qk_max_data[row] : tmp_max;
+        if (tmp_max == -std::numeric_limits<accum_t>::infinity()) {
+          // to avoid `nan = exp2f(-inf - (-inf))`
+          fill_stub(
+              conditional_data_ptr(qk_data, qk_reduced_data) +
+                  row * kvBlockSize,
+              static_cast<scalar_t>(0),
+              kvBlockSize);
+        } else {
+          // qk <- exp(qk - max) and sum per row
+          tmp_sum = tmp_max;
+          _exp_reduce_sum_fusion_kernel(
+              qk_data + row * kvBlockSize,
+              kvBlockSize,
+              conditional_data_ptr(qk_data, qk_reduced_data) +
+                  row * kvBlockSize,
+              tmp_sum);
+          // exp_tmp <- exp(max[row] - max)
+          exp_tmp = std::exp(qk_max_data[row] - tmp_max);
+          // sum[row] <- sum + exp_tmp * sum[row]
+          qk_sum_data[row] = tmp_sum + exp_tmp * qk_sum_data[row];
+          // max[row] <- max
+          qk_max_data[row] = tmp_max;
+          // dst <- dst * exp_tmp
+          if (n > kv_begin) {
+            vec::map<accum_t>(
+                [exp_tmp](Vec x) { return x * Vec(exp_tmp); },
+                dst_data + row * headSize,
+                dst_data + row * headSize,
+                headSize);
           }
         }
+      }
 
-        const void* v_sub_matrix_data_ptr;
-        const float* v_scales_ptr = nullptr;
-        const int8_t* v_zero_points_ptr = nullptr;
-        int64_t v_offset = i * vStrideB + j_kv * vStrideH + n * vStrideN;
-        if (is_quantized_sdpa) {
-          int64_t v_quant_params_offset = i * v_quant_params_StrideB +
-              j_kv * v_quant_params_StrideH + n * v_quant_params_StrideN;
-          v_scales_ptr =
-              v_scales.value().const_data_ptr<float>() + v_quant_params_offset;
-          v_zero_points_ptr = v_zero_points.value().const_data_ptr<int8_t>() +
-              v_quant_params_offset;
-          v_sub_matrix_data_ptr = (const int8_t*)(v_data) + v_offset;
-        } else {
-          v_sub_matrix_data_ptr = (const scalar_t*)(v_data) + v_offset;
+      const void* v_sub_matrix_data_ptr;
+      const float* v_scales_ptr = nullptr;
+      const int8_t* v_zero_points_ptr = nullptr;
+      int64_t v_offset = i * vStrideB + j_kv * vStrideH + n * vStrideN;
+      if (is_quantized_kv) {
+        int64_t v_quant_params_offset = i * v_quant_params_StrideB +
+            j_kv * v_quant_params_StrideH + n * v_quant_params_StrideN;
+        v_scales_ptr =
+            v_scales.value().const_data_ptr<float>() + v_quant_params_offset;
+        v_zero_points_ptr = v_zero_points.value().const_data_ptr<int8_t>() +
+            v_quant_params_offset;
+        v_sub_matrix_data_ptr = (const int8_t*)(v_data) + v_offset;
+      } else {
+        v_sub_matrix_data_ptr = (const scalar_t*)(v_data) + v_offset;
+      }
+      MaybeQuantizedMatrixData v_sub_matrix_data = MaybeQuantizedMatrixData(
+          static_cast<const void*>(v_sub_matrix_data_ptr),
+          v_zero_points_ptr,
+          v_scales_ptr,
+          kvBlockSize,
+          headSize,
+          v_quant_params_StrideN,
+          value.scalar_type());
+      // Calculate Softmax(q @ k.T) @ v
+      _qk_at_v_gemm<accum_t>(
+          qBlockSize,
+          headSize,
+          kvBlockSize,
+          qk_data,
+          kvBlockSize,
+          v_sub_matrix_data,
+          vStrideN,
+          dst_data,
+          headSize,
+          n == kv_begin ? static_cast<accum_t>(0) : static_cast<accum_t>(1),
+          buf_qdq_ptr);
+    }
+  };
+
+  // Flash-decoding: a few queries, as when decoding, make fewer (batch, head)
+  // tasks than threads, which then sit idle while each task reads a long
+  // cache. The keys are split across threads as well, and the partial softmax
+  // of the splits merged with their log-sum-exp.
+  int64_t num_kv_splits = 1;
+  int64_t keys_per_split = kvSize;
+  const int64_t num_decode_tasks = batchSize * num_head;
+  if (qSlice == 1 && qSize <= kFlashDecodingMaxQSize &&
+      num_decode_tasks < num_thread) {
+    const int64_t num_keys =
+        is_causal ? std::min(start_pos + qSize, kvSize) : kvSize;
+    const int64_t num_kv_blocks = (num_keys - 1) / kvSplitSize + 1;
+    // Two splits per thread, to even out those that end up masked.
+    const int64_t target_splits = (2 * num_thread - 1) / num_decode_tasks + 1;
+    const int64_t blocks_per_split =
+        (num_kv_blocks - 1) / std::min(num_kv_blocks, target_splits) + 1;
+    keys_per_split = blocks_per_split * kvSplitSize;
+    num_kv_splits = (num_kv_blocks - 1) / blocks_per_split + 1;
+  }
+
+  if (num_kv_splits == 1) {
+    auto compute_lambda = [&](int64_t begin, int64_t end) {
+      int64_t i = 0, j = 0, k = 0;
+      data_index_init(begin, i, batchSize, j, num_head, k, qSlice);
+      int ompIdx = torch::executor::get_thread_num();
+      accum_t* buf_ptr = buf_data + ompIdx * size_per_thread;
+      accum_t* qk_max_data = buf_ptr + qSplitSize * kvSplitSize;
+      accum_t* qk_sum_data = qk_max_data + qSplitSize;
+      accum_t* dst_data = qk_sum_data + qSplitSize;
+
+      for (int64_t z = begin; z < end; z++) {
+        int64_t m = k * qSplitSize;
+        int64_t qBlockSize = std::min(qSplitSize, qSize - m);
+        compute_block(i, j, k, 0, kvSize, qk_max_data, qk_sum_data, dst_data);
+        // dst <- dst / sum[row]
+        // reorder MHA output with strides
+        for (int64_t row = 0; row < qBlockSize; ++row) {
+          accum_t sum_reciprocal = 1 / qk_sum_data[row];
+          vec::map<scalar_t>(
+              [sum_reciprocal](Vec x) { return x * Vec(sum_reciprocal); },
+              out_data + i * oStrideB + j * oStrideH + m * oStrideM +
+                  row * oStrideM,
+              dst_data + row * headSize,
+              headSize);
         }
-        MaybeQuantizedMatrixData v_sub_matrix_data = MaybeQuantizedMatrixData(
-            static_cast<const void*>(v_sub_matrix_data_ptr),
-            v_zero_points_ptr,
-            v_scales_ptr,
-            kvBlockSize,
-            headSize,
-            v_quant_params_StrideN,
-            value.scalar_type());
-        // Calculate Softmax(q @ k.T) @ v
-        _qk_at_v_gemm<accum_t>(
-            qBlockSize,
-            headSize,
-            kvBlockSize,
-            qk_data,
-            kvBlockSize,
-            v_sub_matrix_data,
-            vStrideN,
-            dst_data,
-            headSize,
-            n == 0 ? static_cast<accum_t>(0) : static_cast<accum_t>(1),
-            buf_qdq_ptr);
+        // Move to the next query
+        data_index_step(i, batchSize, j, num_head, k, qSlice);
       }
-      // dst <- dst / sum[row]
-      // reorder MHA output with strides
-      for (int64_t row = 0; row < qBlockSize; ++row) {
-        accum_t sum_reciprocal = 1 / qk_sum_data[row];
+    };
+    torch::executor::parallel_for(
+        0, batchSize * num_head * qSlice, 1, compute_lambda);
+    return;
+  }
+
+  // The max, sum and dst of each split of each task, one after the other.
+  const int64_t size_per_split = qSize * (2 + headSize);
+  const int64_t size_splits_bytes =
+      num_decode_tasks * num_kv_splits * size_per_split * sizeof(accum_t);
+  std::unique_ptr<char[]> allocated_buf_for_splits;
+  accum_t* splits_data;
+  Result<void*> scratch_for_splits = ctx.allocate_temp(size_splits_bytes, 64);
+  if (!scratch_for_splits.ok()) {
+    allocated_buf_for_splits = std::make_unique<char[]>(size_splits_bytes);
+    splits_data = reinterpret_cast<accum_t*>(allocated_buf_for_splits.get());
+  } else {
+    splits_data = reinterpret_cast<accum_t*>(scratch_for_splits.get());
+  }
+
+  auto compute_split_lambda = [&](int64_t begin, int64_t end) {
+    int64_t i = 0, j = 0, split = 0;
+    data_index_init(begin, i, batchSize, j, num_head, split, num_kv_splits);
+    for (int64_t z = begin; z < end; z++) {
+      accum_t* split_data = splits_data + z * size_per_split;
+      compute_block(
+          i,
+          j,
+          0,
+          split * keys_per_split,
+          (split + 1) * keys_per_split,
+          split_data,
+          split_data + qSize,
+          split_data + 2 * qSize);
+      data_index_step(i, batchSize, j, num_head, split, num_kv_splits);
+    }
+  };
+  torch::executor::parallel_for(
+      0, num_decode_tasks * num_kv_splits, 1, compute_split_lambda);
+
+  // Rescales the splits of each row to their common max, accumulating them in
+  // the dst of the first split, and divides by their rescaled sums.
+  auto merge_lambda = [&](int64_t begin, int64_t end) {
+    for (int64_t z = begin; z < end; z++) {
+      const int64_t i = z / num_head;
+      const int64_t j = z % num_head;
+      accum_t* task_data = splits_data + z * num_kv_splits * size_per_split;
+      for (int64_t row = 0; row < qSize; ++row) {
+        accum_t max = -std::numeric_limits<accum_t>::infinity();
+        for (int64_t split = 0; split < num_kv_splits; ++split) {
+          max = std::max(max, task_data[split * size_per_split + row]);
+        }
+        accum_t sum = 0;
+        accum_t* dst_row = task_data + 2 * qSize + row * headSize;
+        for (int64_t split = 0; split < num_kv_splits; ++split) {
+          const accum_t* split_data = task_data + split * size_per_split;
+          // A split whose keys are all masked out adds nothing.
+          const accum_t split_max = split_data[row];
+          const accum_t exp_tmp =
+              split_max == -std::numeric_limits<accum_t>::infinity()
+              ? static_cast<accum_t>(0)
+              : std::exp(split_max - max);
+          sum += exp_tmp * split_data[qSize + row];
+          if (split == 0) {
+            vec::map<accum_t>(
+                [exp_tmp](Vec x) { return x * Vec(exp_tmp); },
+                dst_row,
+                dst_row,
+                headSize);
+          } else {
+            vec::map2<accum_t>(
+                [exp_tmp](Vec x, Vec y) { return x + y * Vec(exp_tmp); },
+                dst_row,
+                dst_row,
+                split_data + 2 * qSize + row * headSize,
+                headSize);
+          }
+        }
+        accum_t sum_reciprocal = 1 / sum;
         vec::map<scalar_t>(
             [sum_reciprocal](Vec x) { return x * Vec(sum_reciprocal); },
-            out_data + i * oStrideB + j * oStrideH + m * oStrideM +
-                row * oStrideM,
-            dst_data + row * headSize,
+            out_data + i * oStrideB + j * oStrideH + row * oStrideM,
+            dst_row,
             headSize);
       }
-      // Move to the next query
-      data_index_step(i, batchSize, j, num_head, k, qSlice);
     }
   };
-  torch::executor::parallel_for(
-      0, batchSize * num_head * qSlice, 1, compute_lambda);
+  torch::executor::parallel_for(0, num_decode_tasks, 1, merge_lambda);
 }
 } // namespace sdpa::impl
 } // namespace native
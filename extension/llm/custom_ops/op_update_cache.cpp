@@ -7,12 +7,20 @@
  */
 
 #include <executorch/extension/llm/custom_ops/op_update_cache.h>
+#include <executorch/extension/llm/custom_ops/ring_kv_cache.h>
 
 #include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
 // @lint-ignore CLANGTIDY facebook-unused-include-check
 #include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
 
 #include <executorch/extension/kernel_util/make_boxed_from_unboxed_functor.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
 
 namespace torch {
 namespace executor {
@@ -87,6 +95,238 @@ bool validate_cache_params(
   return true;
 }
 
+bool validate_quantized_cache_params(
+    const Tensor& value,
+    const Tensor& cache,
+    const Tensor& cache_scales,
+    const Tensor& cache_zero_points) {
+  ET_CHECK_OR_RETURN_FALSE(
+      value.scalar_type() == ScalarType::Float, "value must be a Float tensor");
+  ET_CHECK_OR_RETURN_FALSE(
+      cache.scalar_type() == ScalarType::Char, "cache must be an int8 tensor");
+  ET_CHECK_OR_RETURN_FALSE(
+      cache_scales.scalar_type() == ScalarType::Float,
+      "cache scales must be a Float tensor");
+  ET_CHECK_OR_RETURN_FALSE(
+      cache_zero_points.scalar_type() == ScalarType::Char,
+      "cache zero points must be an int8 tensor");
+
+  for (int64_t i : {0, 2, 3}) {
+    ET_CHECK_OR_RETURN_FALSE(
+        value.size(i) == cache.size(i),
+        "value and cache have different sizes at dim %" PRId64 ": %zd vs %zd",
+        i,
+        value.size(i),
+        cache.size(i));
+  }
+  ET_CHECK_OR_RETURN_FALSE(
+      cache_scales.dim() == 4 && cache_zero_points.dim() == 4,
+      "cache scales and zero points must be 4D tensors");
+  for (int64_t i = 0; i < 4; ++i) {
+    const ssize_t expected = i == 3 ? 1 : cache.size(i);
+    ET_CHECK_OR_RETURN_FALSE(
+        cache_scales.size(i) == expected &&
+            cache_zero_points.size(i) == expected,
+        "cache scales and zero points must be of size "
+        "[batch, max_seq_len, num heads, 1]");
+  }
+
+  ET_CHECK_OR_RETURN_FALSE(
+      is_contiguous_dim_order(
+          cache_scales.dim_order().data(), cache_scales.dim()),
+      "cache scales must be in contiguous dim order");
+  ET_CHECK_OR_RETURN_FALSE(
+      is_contiguous_dim_order(
+          cache_zero_points.dim_order().data(), cache_zero_points.dim()),
+      "cache zero points must be in contiguous dim order");
+
+  return true;
+}
+
+bool validate_ring_cache_params(
+    const Tensor& value,
+    const Tensor& cache,
+    int64_t start_pos,
+    int64_t sink_size) {
+  ET_CHECK_OR_RETURN_FALSE(
+      cache.dim() == 4 && value.dim() == 4,
+      "value and cache must be 4D tensors");
+  for (int64_t i : {0, 2, 3}) {
+    ET_CHECK_OR_RETURN_FALSE(
+        value.size(i) == cache.size(i),
+        "value and cache have different sizes at dim %" PRId64 ": %zd vs %zd",
+        i,
+        value.size(i),
+        cache.size(i));
+  }
+  ET_CHECK_OR_RETURN_FALSE(
+      value.scalar_type() == cache.scalar_type(),
+      "value and cache must have the same dtype");
+  ET_CHECK_OR_RETURN_FALSE(
+      start_pos >= 0, "start_pos must be >= 0, got %" PRId64, start_pos);
+  ET_CHECK_OR_RETURN_FALSE(
+      sink_size >= 0 && sink_size < cache.size(1),
+      "sink_size %" PRId64 " must be in [0, cache size at dim 1: %zd)",
+      sink_size,
+      cache.size(1));
+
+  // The positions of one update that fall in the ring must not overwrite
+  // each other.
+  const int64_t end_pos = start_pos + value.size(1);
+  const int64_t ring_positions = end_pos - std::max(start_pos, sink_size);
+  ET_CHECK_OR_RETURN_FALSE(
+      ring_positions <= cache.size(1) - sink_size,
+      "Update of %zd positions from %" PRId64
+      " does not fit in the ring of %" PRId64 " slots",
+      value.size(1),
+      start_pos,
+      static_cast<int64_t>(cache.size(1) - sink_size));
+
+  ET_CHECK_OR_RETURN_FALSE(
+      is_contiguous_dim_order(cache.dim_order().data(), cache.dim()),
+      "cache must be in contiguous dim order");
+  ET_CHECK_OR_RETURN_FALSE(
+      is_contiguous_dim_order(value.dim_order().data(), value.dim()),
+      "value must be in contiguous dim order");
+
+  return true;
+}
+
+// Updates below this size are copied on the calling thread: a decode step of
+// one layer is a few KiB, less than what it costs to wake up the threadpool.
+constexpr size_t kMinParallelCopyBytes = 1 << 20;
+// Larger updates are split in chunks of this size, whatever rows and heads
+// they span, so that the threads share the prefill of a single sequence.
+constexpr size_t kCopyChunkBytes = 256 << 10;
+
+// A copy of bytes from a value to its cache.
+struct CacheCopy {
+  uint8_t* dst;
+  const uint8_t* src;
+  size_t num_bytes;
+};
+
+// Copies an update of total_bytes from a value to its cache. Updates below
+// kMinParallelCopyBytes are copied as their ranges are added, without
+// allocating. Larger ones are gathered, with ranges that follow the last one
+// in both the value and the cache merged, as consecutive positions of a batch
+// do, and run() copies them across threads in chunks of kCopyChunkBytes.
+// Copies to overlapping ranges, as repeated indices make, run one after the
+// other in the order they were added instead, so that the last one wins.
+class CacheCopier {
+ public:
+  explicit CacheCopier(size_t total_bytes) : total_bytes_(total_bytes) {}
+
+  // Copies num_bytes from src to dst, now or in run(). Nothing is copied if
+  // src already is dst.
+  void add(uint8_t* dst, const uint8_t* src, size_t num_bytes) {
+    if (dst == src || num_bytes == 0) {
+      return;
+    }
+    if (total_bytes_ < kMinParallelCopyBytes) {
+      std::memcpy(dst, src, num_bytes);
+      return;
+    }
+    if (!copies_.empty()) {
+      CacheCopy& last = copies_.back();
+      if (last.dst + last.num_bytes == dst &&
+          last.src + last.num_bytes == src) {
+        last.num_bytes += num_bytes;
+        return;
+      }
+    }
+    copies_.push_back({dst, src, num_bytes});
+  }
+
+  void run() {
+    if (copies_.empty()) {
+      return;
+    }
+    if (has_overlapping_destinations()) {
+      for (const auto& copy : copies_) {
+        std::memcpy(copy.dst, copy.src, copy.num_bytes);
+      }
+      return;
+    }
+    std::vector<CacheCopy> chunks;
+    chunks.reserve(total_bytes_ / kCopyChunkBytes + copies_.size());
+    for (const auto& copy : copies_) {
+      for (size_t offset = 0; offset < copy.num_bytes;
+           offset += kCopyChunkBytes) {
+        chunks.push_back(
+            {copy.dst + offset,
+             copy.src + offset,
+             std::min(kCopyChunkBytes, copy.num_bytes - offset)});
+      }
+    }
+    torch::executor::parallel_for(
+        0, chunks.size(), 1, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            std::memcpy(chunks[i].dst, chunks[i].src, chunks[i].num_bytes);
+          }
+        });
+  }
+
+ private:
+  bool has_overlapping_destinations() const {
+    std::vector<CacheCopy> sorted(copies_);
+    std::sort(
+        sorted.begin(),
+        sorted.end(),
+        [](const CacheCopy& a, const CacheCopy& b) { return a.dst < b.dst; });
+    for (size_t i = 1; i < sorted.size(); ++i) {
+      // If a range overlaps any that starts after it, it overlaps the next.
+      if (sorted[i - 1].dst + sorted[i - 1].num_bytes > sorted[i].dst) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const size_t total_bytes_;
+  std::vector<CacheCopy> copies_;
+};
+
+// Quantizes one row to int8 with the asymmetric qparams of
+// quantized_decomposed.choose_qparams_per_token_asymmetric, and rounds like
+// quantized_decomposed.quantize_per_token, so that the cache holds what the
+// decomposed graph would have stored.
+void quantize_row(
+    const float* in,
+    int64_t size,
+    int8_t* out,
+    float* scale_out,
+    int8_t* zero_point_out) {
+  constexpr float kQuantMin = std::numeric_limits<int8_t>::min();
+  constexpr float kQuantMax = std::numeric_limits<int8_t>::max();
+
+  float min = 0.0f;
+  float max = 0.0f;
+  for (int64_t i = 0; i < size; ++i) {
+    min = std::min(min, in[i]);
+    max = std::max(max, in[i]);
+  }
+  const float scale = std::max(
+      (max - min) / (kQuantMax - kQuantMin),
+      std::numeric_limits<float>::epsilon());
+  const float descaled_min = min / scale;
+  const float descaled_max = max / scale;
+  const float zero_point =
+      (kQuantMin + descaled_min) + (kQuantMax + descaled_max) > 0
+      ? kQuantMin - descaled_min
+      : kQuantMax - descaled_max;
+  const float rounded_zero_point =
+      std::nearbyint(std::clamp(zero_point, kQuantMin, kQuantMax));
+
+  const float inv_scale = 1.0f / scale;
+  for (int64_t i = 0; i < size; ++i) {
+    const float q = std::nearbyint(in[i] * inv_scale + rounded_zero_point);
+    out[i] = static_cast<int8_t>(std::clamp(q, kQuantMin, kQuantMax));
+  }
+  *scale_out = scale;
+  *zero_point_out = static_cast<int8_t>(rounded_zero_point);
+}
+
 // Helper function for the actual update operation
 Tensor& update_cache_impl(
     RuntimeContext& ctx,
@@ -125,8 +365,9 @@ Tensor& update_cache_impl(
       is_contiguous_dim_order(cache.dim_order().data(), cache.dim()),
       "projected value must be in contiguous dim order");
 
-  const void* value_data = value.const_data_ptr();
-  void* cache_data = cache.mutable_data_ptr();
+  const uint8_t* value_data =
+      static_cast<const uint8_t*>(value.const_data_ptr());
+  uint8_t* cache_data = static_cast<uint8_t*>(cache.mutable_data_ptr());
 
   ET_CHECK_MSG(value_data, "projected_value data is null");
   ET_CHECK_MSG(cache_data, "cache data is null");
@@ -141,6 +382,7 @@ Tensor& update_cache_impl(
   executorch::aten::SizesType num_bytes_to_copy =
       (value.numel() / value.size(0)) * value.element_size();
 
+  CacheCopier copier(value.nbytes());
   if (indices.has_value()) {
     // Use the provided indices tensor for each batch and sequence position
     const Tensor& indices_tensor = indices.value();
@@ -178,10 +420,10 @@ Tensor& update_cache_impl(
             (batch_line * value_batch_dim_stride + seq_idx * value_strides[1]) *
             value.element_size();
 
-        // Copy a single token
-        std::memcpy(
-            (uint8_t*)cache_data + cache_pos_offset,
-            (uint8_t*)value_data + value_pos_offset,
+        // Consecutive indices coalesce into a single copy
+        copier.add(
+            cache_data + cache_pos_offset,
+            value_data + value_pos_offset,
             bytes_per_token);
       }
     }
@@ -195,12 +437,13 @@ Tensor& update_cache_impl(
       executorch::aten::SizesType value_pos_offset =
           (batch_line * value_batch_dim_stride) * cache.element_size();
 
-      std::memcpy(
-          (uint8_t*)cache_data + cache_pos_offset,
-          (uint8_t*)value_data + value_pos_offset,
+      copier.add(
+          cache_data + cache_pos_offset,
+          value_data + value_pos_offset,
           num_bytes_to_copy);
     }
   }
+  copier.run();
 
   // Noone uses output. Just a placeholder.
   return output;
@@ -224,6 +467,106 @@ Tensor& update_cache_out(
   return update_cache_impl(ctx, value, cache, start_pos, output);
 }
 
+Tensor& update_quantized_cache_out(
+    RuntimeContext& ctx,
+    const Tensor& value,
+    Tensor& cache,
+    Tensor& cache_scales,
+    Tensor& cache_zero_points,
+    const int64_t start_pos,
+    Tensor& output) {
+  ET_KERNEL_CHECK(
+      ctx,
+      validate_cache_params(value, cache, start_pos, value.size(1)) &&
+          validate_quantized_cache_params(
+              value, cache, cache_scales, cache_zero_points),
+      InvalidArgument,
+      output);
+
+  const float* value_data = value.const_data_ptr<float>();
+  int8_t* cache_data = cache.mutable_data_ptr<int8_t>();
+  float* scales_data = cache_scales.mutable_data_ptr<float>();
+  int8_t* zero_points_data = cache_zero_points.mutable_data_ptr<int8_t>();
+
+  // Rows of head_dim elements; each has its own scale and zero point.
+  const int64_t num_heads = value.size(2);
+  const int64_t head_dim = value.size(3);
+  const int64_t rows_per_batch = value.size(1) * num_heads;
+  const int64_t cache_rows_per_batch = cache.size(1) * num_heads;
+  // Rows are quantized across threads once there are enough of them, over
+  // batches and heads alike.
+  const int64_t grain_size = std::max<int64_t>(
+      1, ::executorch::extension::internal::GRAIN_SIZE / head_dim);
+  torch::executor::parallel_for(
+      0,
+      value.size(0) * rows_per_batch,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          const int64_t batch = i / rows_per_batch;
+          const int64_t row = i % rows_per_batch;
+          const int64_t cache_row = batch * cache_rows_per_batch +
+              start_pos * num_heads + row;
+          quantize_row(
+              value_data + i * head_dim,
+              head_dim,
+              cache_data + cache_row * head_dim,
+              scales_data + cache_row,
+              zero_points_data + cache_row);
+        }
+      });
+
+  // Noone uses output. Just a placeholder.
+  return output;
+}
+
+Tensor& update_ring_cache_out(
+    RuntimeContext& ctx,
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    Tensor& output) {
+  ET_KERNEL_CHECK(
+      ctx,
+      validate_ring_cache_params(value, cache, start_pos, sink_size),
+      InvalidArgument,
+      output);
+
+  const RingKVCacheLayout layout{cache.size(1), sink_size, cache.size(1)};
+  const uint8_t* value_data =
+      static_cast<const uint8_t*>(value.const_data_ptr());
+  uint8_t* cache_data = static_cast<uint8_t*>(cache.mutable_data_ptr());
+  const size_t bytes_per_token =
+      value.size(2) * value.size(3) * value.element_size();
+  const int64_t seq_len = value.size(1);
+
+  CacheCopier copier(value.nbytes());
+  for (int64_t batch = 0; batch < value.size(0); ++batch) {
+    const uint8_t* batch_value = value_data + batch * seq_len * bytes_per_token;
+    uint8_t* batch_cache =
+        cache_data + batch * layout.capacity * bytes_per_token;
+    // Copies runs of consecutive slots: the update splits at most where it
+    // leaves the sinks and where it wraps around.
+    for (int64_t i = 0; i < seq_len;) {
+      const int64_t pos = start_pos + i;
+      const int64_t slot = layout.slot(pos);
+      const int64_t run = std::min(
+          seq_len - i,
+          pos < sink_size ? sink_size - pos : layout.capacity - slot);
+      copier.add(
+          batch_cache + slot * bytes_per_token,
+          batch_value + i * bytes_per_token,
+          run * bytes_per_token);
+      i += run;
+    }
+  }
+  copier.run();
+
+  // Noone uses output. Just a placeholder.
+  return output;
+}
+
 // New function that explicitly takes indices
 Tensor& update_cache_with_indices_out(
     RuntimeContext& ctx,
@@ -257,6 +600,20 @@ EXECUTORCH_LIBRARY(
     "update_cache.out",
     torch::executor::native::update_cache_out);
 
+// Quantizes the value into an int8 cache with per token and head scales and
+// zero points, which custom_quantized_sdpa dequantizes as it reads them.
+EXECUTORCH_LIBRARY(
+    llama,
+    "update_quantized_cache.out",
+    torch::executor::native::update_quantized_cache_out);
+
+// Writes into a cache used as a ring buffer with attention sinks, for
+// custom_ring_sdpa.
+EXECUTORCH_LIBRARY(
+    llama,
+    "update_ring_cache.out",
+    torch::executor::native::update_ring_cache_out);
+
 // Register the new update_cache_with_indices.out op
 EXECUTORCH_LIBRARY(
     llama,
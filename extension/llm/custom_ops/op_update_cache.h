@@ -15,7 +15,8 @@ namespace executor {
 
 namespace native {
 
-// Original update_cache_out function without indices parameter
+// Original update_cache_out function without indices parameter. Large
+// updates are copied across threads.
 Tensor& update_cache_out(
     RuntimeContext& ctx,
     const Tensor& value,
@@ -23,6 +24,29 @@ Tensor& update_cache_out(
     const int64_t start_pos,
     Tensor& output);
 
+// Quantizes value to int8 per token and head, and writes it to cache and its
+// scales and zero points to cache_scales and cache_zero_points, of size
+// [batch, max_seq_len, num heads, 1], at start_pos
+Tensor& update_quantized_cache_out(
+    RuntimeContext& ctx,
+    const Tensor& value,
+    Tensor& cache,
+    Tensor& cache_scales,
+    Tensor& cache_zero_points,
+    const int64_t start_pos,
+    Tensor& output);
+
+// Writes value at positions start_pos onwards of a cache used as a ring
+// buffer, whose first sink_size slots keep the first positions, wrapping
+// around without moving what the cache holds. See RingKVCacheLayout.
+Tensor& update_ring_cache_out(
+    RuntimeContext& ctx,
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    Tensor& output);
+
 // New function that explicitly takes indices
 Tensor& update_cache_with_indices_out(
     RuntimeContext& ctx,
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Measures update_cache writing a prefill of the given length into the
+// float32 K cache of one layer of Llama 3 8B, 8 KV heads of 128 over 8192
+// positions, on the given number of threads: from a value, and through
+// consecutive indices. The bytes_per_second are those of the value.
+
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+#include <vector>
+
+#include <executorch/extension/llm/custom_ops/op_update_cache.h>
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/extension/threadpool/threadpool.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using executorch::extension::empty;
+using executorch::extension::make_tensor_ptr;
+using executorch::extension::rand;
+
+namespace {
+
+constexpr int32_t kMaxSeqLen = 8192;
+constexpr int32_t kNumKvHeads = 8;
+constexpr int32_t kHeadDim = 128;
+
+// Sets the number of threads from the second argument, and returns the
+// prefill length from the first.
+int32_t setup(benchmark::State& state) {
+  executorch::runtime::runtime_init();
+  ::executorch::extension::threadpool::get_threadpool()
+      ->_unsafe_reset_threadpool(state.range(1));
+  return state.range(0);
+}
+
+void set_counters(benchmark::State& state, int32_t seq_len) {
+  state.SetBytesProcessed(
+      state.iterations() * seq_len * kNumKvHeads * kHeadDim * sizeof(float));
+}
+
+void BM_UpdateCache(benchmark::State& state) {
+  const int32_t seq_len = setup(state);
+  auto cache = rand({1, kMaxSeqLen, kNumKvHeads, kHeadDim});
+  auto value = rand({1, seq_len, kNumKvHeads, kHeadDim});
+  auto out = empty({1});
+
+  for (auto _ : state) {
+    executorch::runtime::KernelRuntimeContext ctx{};
+    torch::executor::native::update_cache_out(ctx, *value, *cache, 0, *out);
+    benchmark::ClobberMemory();
+  }
+  set_counters(state, seq_len);
+}
+
+void BM_UpdateCacheWithIndices(benchmark::State& state) {
+  const int32_t seq_len = setup(state);
+  auto cache = rand({1, kMaxSeqLen, kNumKvHeads, kHeadDim});
+  auto value = rand({1, seq_len, kNumKvHeads, kHeadDim});
+  std::vector<int64_t> positions(seq_len);
+  std::iota(positions.begin(), positions.end(), 0);
+  auto indices = make_tensor_ptr({1, seq_len}, std::move(positions));
+  auto out = empty({1});
+
+  for (auto _ : state) {
+    executorch::runtime::KernelRuntimeContext ctx{};
+    torch::executor::native::update_cache_with_indices_out(
+        ctx, *value, *cache, 0, *indices, *out);
+    benchmark::ClobberMemory();
+  }
+  set_counters(state, seq_len);
+}
+
+void prefill_args(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"seq_len", "threads"})
+      ->ArgsProduct({{1, 128, 512, 2048, 8192}, {1, 4}})
+      ->Unit(benchmark::kMicrosecond)
+      ->UseRealTime();
+}
+
+BENCHMARK(BM_UpdateCache)->Apply(prefill_args);
+BENCHMARK(BM_UpdateCacheWithIndices)->Apply(prefill_args);
+
+} // namespace
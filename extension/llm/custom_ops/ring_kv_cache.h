@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace torch {
+namespace executor {
+
+namespace native {
+
+/**
+ * Layout of a KV cache used as a ring buffer, for sliding window attention
+ * with attention sinks.
+ *
+ * The first sink_size slots hold the first sink_size positions for good. The
+ * other slots form the ring: position pos goes to slot
+ * sink_size + (pos - sink_size) % ring_size(), over the oldest position
+ * there, so that writes never move what is already in the cache. A query at
+ * position pos attends to the sinks and to the window_size positions up to
+ * pos.
+ *
+ * Positions are logical, the ones of the sequence, and the position held by
+ * a slot follows from the last position written, so no table of positions is
+ * kept next to the cache. A chunk of seq_len queries sees every key of its
+ * window as long as ring_size() >= window_size + seq_len - 1.
+ */
+struct RingKVCacheLayout {
+  int64_t capacity;
+  int64_t sink_size;
+  int64_t window_size;
+
+  int64_t ring_size() const {
+    return capacity - sink_size;
+  }
+
+  // Returns the slot that holds pos.
+  int64_t slot(int64_t pos) const {
+    return pos < sink_size ? pos : sink_size + (pos - sink_size) % ring_size();
+  }
+
+  // Returns the position held by slot once the positions up to last_pos have
+  // been written, or -1 if the slot is still empty.
+  int64_t position(int64_t slot, int64_t last_pos) const {
+    if (slot < sink_size) {
+      return slot <= last_pos ? slot : -1;
+    }
+    if (last_pos < sink_size) {
+      return -1;
+    }
+    const int64_t behind =
+        (this->slot(last_pos) - slot + ring_size()) % ring_size();
+    const int64_t pos = last_pos - behind;
+    return pos >= sink_size ? pos : -1;
+  }
+
+  // Returns whether a query at query_pos attends to the key at key_pos, -1
+  // for an empty slot.
+  bool attends(int64_t query_pos, int64_t key_pos) const {
+    return key_pos >= 0 && key_pos <= query_pos &&
+        (key_pos < sink_size || query_pos - key_pos < window_size);
+  }
+};
+
+} // namespace native
+} // namespace executor
+} // namespace torch
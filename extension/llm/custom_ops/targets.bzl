@@ -37,6 +37,7 @@ def define_common_targets():
                 "op_fast_hadamard_transform.h",
                 "op_sdpa.h",
                 "op_update_cache.h",
+                "ring_kv_cache.h",
             ],
             headers = [
                 "op_sdpa_impl.h",
@@ -111,6 +112,35 @@ def define_common_targets():
         ],
     )
 
+    runtime.cxx_test(
+        name = "op_quantized_sdpa_test",
+        srcs = [
+            "op_quantized_sdpa_test.cpp",
+        ],
+        visibility = ["//executorch/..."],
+        deps = [
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/kernels/test:test_util",
+            ":custom_ops",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "op_sdpa_flash_decoding_test",
+        srcs = [
+            "op_sdpa_flash_decoding_test.cpp",
+        ],
+        visibility = ["//executorch/..."],
+        deps = [
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/kernels/test:test_util",
+            "//executorch/extension/threadpool:threadpool",
+            ":custom_ops",
+        ],
+    )
+
     runtime.cxx_test(
         name = "op_sdpa_with_kv_cache_test",
         srcs = [
@@ -125,6 +155,34 @@ def define_common_targets():
         ],
     )
 
+    runtime.cxx_binary(
+        name = "op_sdpa_benchmark",
+        srcs = [
+            "op_sdpa_benchmark.cpp",
+        ],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/extension/tensor:tensor",
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/platform:platform",
+            ":custom_ops",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "op_update_cache_benchmark",
+        srcs = [
+            "op_update_cache_benchmark.cpp",
+        ],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/extension/tensor:tensor",
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/platform:platform",
+            ":custom_ops",
+        ],
+    )
+
     ## For preprocess
     runtime.python_library(
         name = "preprocess_custom_ops_py",
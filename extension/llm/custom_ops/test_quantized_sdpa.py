@@ -548,3 +548,80 @@ class SDPATestForCustomQuantizedSDPA(unittest.TestCase):
             seq_len,
             is_seq_at_dim_2=False,
         )
+
+    def _test_float_query_common(
+        self, n_heads_kv, n_heads_q, head_dim, max_seq_len, start_pos, seq_len
+    ):
+        # The query stays in float32 and only the cache is int8, as with
+        # QuantizedSDPA(quantize_query=False). Tensors are in [B, S, H, D].
+        self.is_seq_at_dim_2 = False
+        self.max_seq_len = max_seq_len
+        q = torch.randn(self.n_batch, seq_len, n_heads_q, head_dim)
+        self.kv_shape = (self.n_batch, max_seq_len, n_heads_kv, head_dim)
+        self.setup_caches_and_mask(-1, 1, False)
+
+        qparams = {}
+        quantized = {}
+        for name, value in (("k", self.k), ("v", self.v)):
+            scale, zero_point = (
+                torch.ops.quantized_decomposed.choose_qparams_per_token_asymmetric.default(
+                    value, self.quantized_dtype
+                )
+            )
+            quantized[name] = torch.ops.quantized_decomposed.quantize_per_token(
+                value,
+                scale,
+                zero_point,
+                torch.iinfo(self.quantized_dtype).min,
+                torch.iinfo(self.quantized_dtype).max,
+                self.quantized_dtype,
+            )
+            qparams[name] = (zero_point, scale)
+
+        def dequantize(name):
+            zero_point, scale = qparams[name]
+            return torch.ops.quantized_decomposed.dequantize_per_token(
+                quantized[name],
+                scale,
+                zero_point,
+                torch.iinfo(self.quantized_dtype).min,
+                torch.iinfo(self.quantized_dtype).max,
+                self.quantized_dtype,
+                self.float_dtype,
+            )
+
+        k = dequantize("k").transpose(1, 2)[:, :, : start_pos + seq_len]
+        v = dequantize("v").transpose(1, 2)[:, :, : start_pos + seq_len]
+        n_reps = n_heads_q // n_heads_kv
+        k = k.repeat_interleave(n_reps, dim=1)
+        v = v.repeat_interleave(n_reps, dim=1)
+        attn_mask = self.mask[start_pos : start_pos + seq_len, : start_pos + seq_len]
+        ref_output = F.scaled_dot_product_attention(
+            q.transpose(1, 2), k, v, attn_mask=attn_mask
+        ).transpose(1, 2)
+
+        op_output = torch.ops.llama.custom_quantized_sdpa(
+            q,
+            quantized["k"],
+            quantized["v"],
+            start_pos,
+            None,
+            0,
+            True,
+            None,
+            None,
+            None,
+            qparams["k"][0].to(dtype=torch.int8),
+            qparams["k"][1].to(dtype=torch.float32),
+            qparams["v"][0].to(dtype=torch.int8),
+            qparams["v"][1].to(dtype=torch.float32),
+            False,
+        )
+        torch.testing.assert_close(op_output, ref_output, atol=1e-4, rtol=1e-4)
+
+    def test_sdpa_float_query_int8_cache_decode(self):
+        self._test_float_query_common(8, 8, 64, 512, 200, 1)
+
+    def test_sdpa_float_query_int8_cache_prefill_gqa(self):
+        self._test_float_query_common(4, 16, 64, 512, 0, 40)
+        self._test_float_query_common(4, 16, 64, 512, 100, 40)
@@ -0,0 +1,138 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-unsafe
+
+import multiprocessing
+import unittest
+
+import torch
+import torch.nn.functional as F
+
+from executorch.extension.llm.custom_ops import custom_ops  # noqa
+
+
+def run_in_subprocess(target):
+    """
+    Decorator to run the target function in a separate subprocess
+    so as to allow cpp code to throw runtime::abort
+    """
+
+    def wrapper(*args, **kwargs):
+        p = multiprocessing.Process(target=target, args=args, kwargs=kwargs)
+        p.start()
+        p.join()
+        if p.exitcode != 0:
+            raise Exception(f"Subprocess failed with exit code {p.exitcode}")
+
+    return wrapper
+
+
+class RingSDPATest(unittest.TestCase):
+    """
+    Runs update_ring_cache and custom_ring_sdpa past the capacity of the caches,
+    and compares with attention over every position under a sliding window and
+    attention sink mask. Tensors are in [B, S, H, D] format.
+    """
+
+    def setUp(self):
+        torch.manual_seed(42)
+        self.batch_size = 1
+        self.n_heads_q = 8
+        self.n_heads_kv = 4
+        self.head_dim = 16
+
+    def _reference(self, q, k, v, start_pos, window_size, sink_size):
+        # q: [B, S, H, D] at start_pos, k and v: every position so far.
+        seq_len = q.size(1)
+        num_keys = k.size(1)
+        query_pos = start_pos + torch.arange(seq_len).view(-1, 1)
+        key_pos = torch.arange(num_keys).view(1, -1)
+        attends = (key_pos <= query_pos) & (
+            (key_pos < sink_size) | (query_pos - key_pos < window_size)
+        )
+        mask = torch.where(attends, 0.0, float("-inf"))
+        n_reps = self.n_heads_q // self.n_heads_kv
+        k = k.transpose(1, 2).repeat_interleave(n_reps, dim=1)
+        v = v.transpose(1, 2).repeat_interleave(n_reps, dim=1)
+        out = F.scaled_dot_product_attention(
+            q.transpose(1, 2), k, v, attn_mask=mask
+        )
+        return out.transpose(1, 2)
+
+    def _run(self, window_size, sink_size, chunks):
+        max_chunk = max(chunks)
+        capacity = sink_size + window_size + max_chunk - 1
+        cache_shape = (self.batch_size, capacity, self.n_heads_kv, self.head_dim)
+        k_cache = torch.zeros(cache_shape)
+        v_cache = torch.zeros(cache_shape)
+        all_k = []
+        all_v = []
+
+        start_pos = 0
+        for seq_len in chunks:
+            q = torch.randn(self.batch_size, seq_len, self.n_heads_q, self.head_dim)
+            k = torch.randn(self.batch_size, seq_len, self.n_heads_kv, self.head_dim)
+            v = torch.randn(self.batch_size, seq_len, self.n_heads_kv, self.head_dim)
+            all_k.append(k)
+            all_v.append(v)
+
+            torch.ops.llama.update_ring_cache(k, k_cache, start_pos, sink_size)
+            torch.ops.llama.update_ring_cache(v, v_cache, start_pos, sink_size)
+            op_output = torch.ops.llama.custom_ring_sdpa(
+                q, k_cache, v_cache, start_pos, window_size, sink_size
+            )
+            ref_output = self._reference(
+                q,
+                torch.cat(all_k, dim=1),
+                torch.cat(all_v, dim=1),
+                start_pos,
+                window_size,
+                sink_size,
+            )
+            torch.testing.assert_close(op_output, ref_output, atol=1e-5, rtol=1e-5)
+            start_pos += seq_len
+
+        # The caches never grew.
+        self.assertEqual(k_cache.size(1), capacity)
+        self.assertGreater(start_pos, 2 * capacity)
+
+    def test_sliding_window_decode(self):
+        self._run(window_size=16, sink_size=0, chunks=[5] + [1] * 60)
+
+    def test_attention_sinks_decode(self):
+        self._run(window_size=16, sink_size=4, chunks=[3] + [1] * 60)
+
+    def test_chunked_prefill_wraps(self):
+        self._run(window_size=8, sink_size=2, chunks=[6, 6, 1, 6, 1, 1, 6, 6, 6])
+
+    def test_prompt_longer_than_sinks(self):
+        # The first chunk fills the sinks and starts the ring.
+        self._run(window_size=12, sink_size=4, chunks=[10] + [1] * 40)
+
+    def test_window_too_large_for_chunk_fails(self):
+        cache = torch.zeros(1, 8, self.n_heads_kv, self.head_dim)
+        q = torch.randn(1, 4, self.n_heads_q, self.head_dim)
+
+        # A ring of 8 cannot hold a window of 8 for 4 queries.
+        @run_in_subprocess
+        def run_and_catch(q, cache):
+            torch.ops.llama.custom_ring_sdpa(q, cache, cache, 0, 8, 0)
+
+        with self.assertRaises(Exception):
+            run_and_catch(q, cache)
+
+    def test_update_longer_than_ring_fails(self):
+        cache = torch.zeros(1, 8, self.n_heads_kv, self.head_dim)
+        value = torch.randn(1, 7, self.n_heads_kv, self.head_dim)
+
+        # 7 positions past the 2 sinks would overwrite each other in a ring of 6.
+        @run_in_subprocess
+        def run_and_catch(value, cache):
+            torch.ops.llama.update_ring_cache(value, cache, 10, 2)
+
+        with self.assertRaises(Exception):
+            run_and_catch(value, cache)
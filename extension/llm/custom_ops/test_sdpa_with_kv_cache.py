@@ -645,3 +645,30 @@ class SDPATestForSpeculativeDecode(SDPATestCommon):
         self._test_sdpa_common(
             n_heads_kv, n_heads_q, head_dim, max_seq_len, seq_len, next_iter_seq_len
         )
+
+
+class SDPATestForFlashDecoding(SDPATestCommon):
+    # One sequence of 2 heads makes fewer tasks than the 3 threads, so that
+    # decoding splits the keys across threads.
+    def setUp(self):
+        super().setUp()
+        self.n_batch = 1
+
+    def test_sdpa_with_cache_decode(self):
+        n_heads_kv = 2
+        n_heads_q = 2
+        head_dim = 64
+        max_seq_len = 2048
+        seq_len = 1500
+        self._test_sdpa_common(n_heads_kv, n_heads_q, head_dim, max_seq_len, seq_len)
+
+    def test_sdpa_with_cache_speculative_decode(self):
+        n_heads_kv = 1
+        n_heads_q = 1
+        head_dim = 128
+        max_seq_len = 2048
+        seq_len = 1100
+        next_iter_seq_len = 5
+        self._test_sdpa_common(
+            n_heads_kv, n_heads_q, head_dim, max_seq_len, seq_len, next_iter_seq_len
+        )
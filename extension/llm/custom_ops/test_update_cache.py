@@ -431,3 +431,182 @@ class UpdateQuantizedKVCacheTest(unittest.TestCase):
         self._update_and_validate(
             k, v, k_scales, v_scales, k_zero_points, v_zero_points, start_pos
         )
+
+
+class UpdateCacheCopyTest(unittest.TestCase):
+    """
+    Covers the ways update_cache copies: directly for small updates, across
+    threads for large ones, coalesced over consecutive indices, in order when
+    indices repeat, and without a self-copy when the value is a view of the
+    cache slice it is written to.
+    """
+
+    def setUp(self):
+        torch.manual_seed(42)
+        self.num_heads = 8
+        self.head_dim = 128
+
+    def _make_cache(self, batch_size, max_seq_len):
+        return torch.randn(batch_size, max_seq_len, self.num_heads, self.head_dim)
+
+    def test_decode(self):
+        # Single tokens, copied without gathering the copies first.
+        cache = self._make_cache(2, 64)
+        expected = cache.clone()
+        value = torch.randn(2, 1, self.num_heads, self.head_dim)
+        expected[:, 17:18] = value
+        torch.ops.llama.update_cache(value, cache, 17)
+        self.assertTrue(torch.equal(cache, expected))
+
+        value = torch.randn(2, 2, self.num_heads, self.head_dim)
+        indices = torch.tensor([[40, 3], [5, 41]])
+        for batch in range(2):
+            expected[batch, indices[batch]] = value[batch]
+        torch.ops.llama.update_cache_with_indices(value, cache, 0, indices)
+        self.assertTrue(torch.equal(cache, expected))
+
+    def test_large_prefill(self):
+        # 2 x 300 tokens of 4 KiB, enough to be split across threads.
+        cache = self._make_cache(2, 512)
+        expected = cache.clone()
+        value = torch.randn(2, 300, self.num_heads, self.head_dim)
+        expected[:, 100:400] = value
+        torch.ops.llama.update_cache(value, cache, 100)
+        self.assertTrue(torch.equal(cache, expected))
+
+    def test_large_prefill_with_indices(self):
+        cache = self._make_cache(2, 512)
+        expected = cache.clone()
+        value = torch.randn(2, 300, self.num_heads, self.head_dim)
+        # Runs of consecutive indices with jumps in between and a reversed run.
+        indices = torch.cat(
+            [
+                torch.arange(200, 300),
+                torch.arange(0, 100),
+                torch.arange(511, 411, -1),
+            ]
+        ).repeat(2, 1)
+        for batch in range(2):
+            expected[batch, indices[batch]] = value[batch]
+        torch.ops.llama.update_cache_with_indices(value, cache, 0, indices)
+        self.assertTrue(torch.equal(cache, expected))
+
+    def test_large_prefill_with_duplicate_indices(self):
+        cache = self._make_cache(2, 512)
+        expected = cache.clone()
+        value = torch.randn(2, 300, self.num_heads, self.head_dim)
+        # Two runs of 150 tokens to the same positions: the second one wins.
+        indices = (torch.arange(300) % 150).repeat(2, 1)
+        for batch in range(2):
+            for seq in range(300):
+                expected[batch, indices[batch, seq]] = value[batch, seq]
+        torch.ops.llama.update_cache_with_indices(value, cache, 0, indices)
+        self.assertTrue(torch.equal(cache, expected))
+
+    def test_value_aliasing_cache(self):
+        for batch_size in [1, 3]:
+            cache = self._make_cache(batch_size, 16)
+            cache[:, 5:9] = torch.randn(batch_size, 4, self.num_heads, self.head_dim)
+            expected = cache.clone()
+            torch.ops.llama.update_cache(cache[:, 5:9], cache, 5)
+            self.assertTrue(torch.equal(cache, expected))
+
+    def test_value_aliasing_cache_large_prefill(self):
+        cache = self._make_cache(1, 1024)
+        cache[:, :600] = torch.randn(1, 600, self.num_heads, self.head_dim)
+        expected = cache.clone()
+        torch.ops.llama.update_cache(cache[:, :600], cache, 0)
+        self.assertTrue(torch.equal(cache, expected))
+
+
+class UpdateQuantizedCacheTest(unittest.TestCase):
+
+    def setUp(self):
+        torch.manual_seed(42)
+        self.batch_size = 2
+        self.max_seq_len = 16
+        self.num_heads = 4
+        self.head_dim = 32
+
+    def _make_cache(self):
+        cache_shape = (self.batch_size, self.max_seq_len, self.num_heads)
+        return (
+            torch.zeros(cache_shape + (self.head_dim,), dtype=torch.int8),
+            torch.ones(cache_shape + (1,), dtype=torch.float32),
+            torch.zeros(cache_shape + (1,), dtype=torch.int8),
+        )
+
+    def _quantize_reference(self, value):
+        scales, zero_points = (
+            torch.ops.quantized_decomposed.choose_qparams_per_token_asymmetric.default(
+                value, torch.int8
+            )
+        )
+        quantized = torch.ops.quantized_decomposed.quantize_per_token(
+            value, scales, zero_points, -128, 127, torch.int8
+        )
+        return quantized, scales.to(torch.float32), zero_points.to(torch.int8)
+
+    def _update_and_validate(self, value, start_pos):
+        cache, scales, zero_points = self._make_cache()
+        torch.ops.llama.update_quantized_cache(
+            value, cache, scales, zero_points, start_pos
+        )
+
+        seq_len = value.size(1)
+        ref_quantized, ref_scales, ref_zero_points = self._quantize_reference(value)
+        written = slice(start_pos, start_pos + seq_len)
+        torch.testing.assert_close(scales[:, written], ref_scales)
+        # The zero points and the values are rounded the same way, up to one
+        # step where the float math of the reference differs.
+        self.assertLessEqual(
+            (zero_points[:, written].int() - ref_zero_points.int()).abs().max(), 1
+        )
+        self.assertLessEqual(
+            (cache[:, written].int() - ref_quantized.int()).abs().max(), 1
+        )
+        # The rest of the cache is untouched.
+        self.assertTrue(torch.all(cache[:, :start_pos] == 0))
+        self.assertTrue(torch.all(cache[:, start_pos + seq_len :] == 0))
+
+        # What is stored dequantizes back to the value.
+        dequantized = (cache[:, written].float() - zero_points[:, written].float()) * (
+            scales[:, written]
+        )
+        torch.testing.assert_close(
+            dequantized, value, atol=scales.max().item(), rtol=0
+        )
+
+    def test_prefill(self):
+        value = torch.randn(
+            self.batch_size, 5, self.num_heads, self.head_dim, dtype=torch.float32
+        )
+        self._update_and_validate(value, 0)
+
+    def test_decode(self):
+        value = torch.randn(
+            self.batch_size, 1, self.num_heads, self.head_dim, dtype=torch.float32
+        )
+        self._update_and_validate(value, 9)
+
+    def test_transposed_value(self):
+        # [B, H, S, D] as the attention produces it, viewed as [B, S, H, D].
+        value = torch.randn(
+            self.batch_size, self.num_heads, 3, self.head_dim, dtype=torch.float32
+        ).transpose(1, 2)
+        self._update_and_validate(value, 4)
+
+    def test_constant_rows(self):
+        value = torch.full(
+            (self.batch_size, 2, self.num_heads, self.head_dim), 0.5
+        )
+        value[0, 0, 0] = 0.0
+        self._update_and_validate(value, 1)
+
+    def test_update_past_cache_end_fails(self):
+        cache, scales, zero_points = self._make_cache()
+        value = torch.randn(self.batch_size, 4, self.num_heads, self.head_dim)
+        with self.assertRaises(Exception):
+            torch.ops.llama.update_quantized_cache(
+                value, cache, scales, zero_points, self.max_seq_len - 2
+            )
@@ -99,6 +99,21 @@ class Stats:
     aggregate_sampling_time_ms: int
     """Total time spent in sampling across all tokens."""
 
+    aggregate_encoder_time_ms: int
+    """Total time spent in the image and audio encoders during prefill."""
+
+    aggregate_decoder_prefill_time_ms: int
+    """Total time spent in the text decoder during prefill."""
+
+    aggregate_encoder_wait_time_ms: int
+    """Total time the text decoder waited for encoder outputs during prefill."""
+
+    encoder_cache_hits: int
+    """Number of image and audio inputs whose encoder output was cached."""
+
+    encoder_cache_misses: int
+    """Number of image and audio inputs that missed the encoder cache."""
+
     num_prompt_tokens: int
     """Number of tokens in the input prompt."""
 
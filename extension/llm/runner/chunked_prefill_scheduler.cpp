@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/llm/runner/chunked_prefill_scheduler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+
+#include <executorch/runtime/platform/log.h>
+
+namespace executorch::extension::llm {
+
+using ::executorch::runtime::Error;
+using ::executorch::runtime::Result;
+
+namespace {
+
+// Weight of the newest sample in the running cost estimates.
+constexpr double kEstimateWeight = 0.2;
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+void update_estimate(double& estimate, double sample) {
+  estimate = estimate > 0.0
+      ? (1.0 - kEstimateWeight) * estimate + kEstimateWeight * sample
+      : sample;
+}
+
+} // namespace
+
+ChunkedPrefillScheduler::ChunkedPrefillScheduler(ChunkedPrefillConfig config)
+    : config_(config) {
+  // Every iteration must make progress.
+  config_.token_budget = std::max<int64_t>(config_.token_budget, 1);
+  config_.max_chunk_tokens = std::max<int64_t>(config_.max_chunk_tokens, 1);
+  config_.min_prefill_tokens = std::max<int64_t>(config_.min_prefill_tokens, 1);
+}
+
+Result<int64_t> ChunkedPrefillScheduler::submit(ScheduledSequence sequence) {
+  ET_CHECK_OR_RETURN_ERROR(
+      sequence.text_decoder_runner != nullptr &&
+          sequence.text_prefiller != nullptr,
+      InvalidArgument,
+      "A sequence needs a decoder runner and a prefiller");
+  ET_CHECK_OR_RETURN_ERROR(
+      !sequence.prompt_tokens.empty() && sequence.max_new_tokens > 0,
+      InvalidArgument,
+      "A sequence needs prompt tokens and max_new_tokens > 0");
+  auto scheduled = std::make_unique<Sequence>();
+  scheduled->request = std::move(sequence);
+  scheduled->pos = scheduled->request.start_pos;
+
+  std::lock_guard<std::mutex> lock(submit_mutex_);
+  const int64_t id = next_id_++;
+  scheduled->id = id;
+  submitted_.push_back(std::move(scheduled));
+  ++num_active_;
+  return id;
+}
+
+int64_t ChunkedPrefillScheduler::prefill_budget(int64_t num_decodes) const {
+  int64_t budget = std::max(
+      config_.token_budget - num_decodes, config_.min_prefill_tokens);
+  if (config_.target_inter_token_latency_ms > 0.0 && num_decodes > 0 &&
+      counters_.prefill_token_ms > 0.0) {
+    const double available = config_.target_inter_token_latency_ms -
+        num_decodes * counters_.decode_step_ms;
+    const int64_t within_target =
+        static_cast<int64_t>(available / counters_.prefill_token_ms);
+    budget = std::min(
+        budget, std::max(within_target, config_.min_prefill_tokens));
+  }
+  return budget;
+}
+
+bool ChunkedPrefillScheduler::emit(Sequence& sequence, uint64_t token) {
+  ++sequence.num_generated;
+  if (sequence.request.token_callback) {
+    sequence.request.token_callback(token);
+  }
+  return sequence.num_generated >= sequence.request.max_new_tokens ||
+      sequence.request.eos_ids.count(token) > 0;
+}
+
+void ChunkedPrefillScheduler::finish(Sequence& sequence, Error error) {
+  if (error != Error::Ok) {
+    ET_LOG(
+        Error,
+        "Sequence %" PRId64 " failed with error 0x%" PRIx32,
+        sequence.id,
+        static_cast<uint32_t>(error));
+  }
+  if (sequence.request.done_callback) {
+    sequence.request.done_callback(error);
+  }
+  --num_active_;
+}
+
+Error ChunkedPrefillScheduler::decode_step(Sequence& sequence) {
+  TextDecoderRunner* runner = sequence.request.text_decoder_runner;
+  if (!sequence.token_tensor) {
+    sequence.token_tensor = from_blob(
+        &sequence.cur_token, {1, 1}, executorch::aten::ScalarType::Long);
+  }
+  auto logits = runner->step(sequence.token_tensor, sequence.pos);
+  ET_CHECK_OK_OR_RETURN_ERROR(logits.error());
+  ++sequence.pos;
+  sequence.cur_token =
+      runner->logits_to_token(*logits, sequence.request.temperature);
+  ++counters_.decode_steps;
+  return Error::Ok;
+}
+
+Error ChunkedPrefillScheduler::prefill_chunk(
+    Sequence& sequence,
+    int64_t num_tokens) {
+  TextPrefiller* prefiller = sequence.request.text_prefiller;
+  if (sequence.num_prefilled == 0 && !prefiller->is_loaded()) {
+    ET_CHECK_OK_OR_RETURN_ERROR(prefiller->load());
+  }
+  const auto& prompt = sequence.request.prompt_tokens;
+  sequence.chunk.assign(
+      prompt.begin() + sequence.num_prefilled,
+      prompt.begin() + sequence.num_prefilled + num_tokens);
+  auto token = prefiller->prefill_chunk(
+      sequence.chunk, sequence.pos, sequence.request.temperature);
+  ET_CHECK_OK_OR_RETURN_ERROR(token.error());
+  sequence.cur_token = *token;
+  sequence.num_prefilled += num_tokens;
+  ++counters_.prefill_chunks;
+  counters_.prefill_tokens += num_tokens;
+  return Error::Ok;
+}
+
+int64_t ChunkedPrefillScheduler::step() {
+  {
+    std::lock_guard<std::mutex> lock(submit_mutex_);
+    for (auto& sequence : submitted_) {
+      prefilling_.push_back(std::move(sequence));
+    }
+    submitted_.clear();
+  }
+  if (prefilling_.empty() && decoding_.empty()) {
+    return 0;
+  }
+
+  // Decodes first: each decoding sequence gets its next token.
+  const int64_t num_decodes = decoding_.size();
+  const auto decode_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < decoding_.size();) {
+    Sequence& sequence = *decoding_[i];
+    const Error error = decode_step(sequence);
+    if (error != Error::Ok || emit(sequence, sequence.cur_token)) {
+      finish(sequence, error);
+      decoding_.erase(decoding_.begin() + i);
+    } else {
+      ++i;
+    }
+  }
+  if (num_decodes > 0) {
+    update_estimate(
+        counters_.decode_step_ms, elapsed_ms(decode_start) / num_decodes);
+  }
+
+  // Then prefill chunks, oldest sequence first, within the budget.
+  const int64_t budget = prefill_budget(num_decodes);
+  int64_t num_prefilled = 0;
+  const auto prefill_start = std::chrono::steady_clock::now();
+  while (num_prefilled < budget && !prefilling_.empty()) {
+    Sequence& sequence = *prefilling_.front();
+    const int64_t remaining =
+        sequence.request.prompt_tokens.size() - sequence.num_prefilled;
+    const int64_t num_tokens = std::min(
+        {budget - num_prefilled,
+         remaining,
+         config_.max_chunk_tokens,
+         sequence.request.text_prefiller->max_seq_len()});
+    const Error error = prefill_chunk(sequence, num_tokens);
+    num_prefilled += num_tokens;
+    if (error != Error::Ok) {
+      finish(sequence, error);
+      prefilling_.pop_front();
+    } else if (num_tokens == remaining) {
+      // The prefill produced the first token.
+      if (emit(sequence, sequence.cur_token)) {
+        finish(sequence, Error::Ok);
+      } else {
+        decoding_.push_back(std::move(prefilling_.front()));
+      }
+      prefilling_.pop_front();
+    }
+  }
+  if (num_prefilled > 0) {
+    update_estimate(
+        counters_.prefill_token_ms,
+        elapsed_ms(prefill_start) / num_prefilled);
+  }
+
+  ++counters_.iterations;
+  return num_decodes + num_prefilled;
+}
+
+void ChunkedPrefillScheduler::run() {
+  while (num_active() > 0) {
+    step();
+  }
+}
+
+} // namespace executorch::extension::llm
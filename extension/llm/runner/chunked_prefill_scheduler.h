@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Runs the prefill and decode of several sequences on one thread, cutting
+// prefills into chunks that are interleaved with decode steps, so that a long
+// prompt does not stall the token streams of the other sequences.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include <executorch/extension/llm/runner/text_decoder_runner.h>
+#include <executorch/extension/llm/runner/text_prefiller.h>
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/result.h>
+
+namespace executorch::extension::llm {
+
+/**
+ * Configuration of a ChunkedPrefillScheduler.
+ *
+ * Each iteration runs one decode step for every decoding sequence, and then
+ * prefill chunks for the waiting sequences, in arrival order, until the
+ * iteration has processed token_budget tokens. Every iteration prefills at
+ * least min_prefill_tokens, so that a prefill is never starved by decodes,
+ * and no chunk is larger than max_chunk_tokens, or the max_seq_len of the
+ * TextPrefiller of its sequence.
+ *
+ * If target_inter_token_latency_ms is positive, the scheduler measures the
+ * cost of decode steps and of prefill tokens as it runs, and lowers the
+ * prefill tokens of an iteration below the budget when they would make it
+ * last longer than the target, which is the time between two tokens of a
+ * decoding sequence.
+ */
+struct ET_EXPERIMENTAL ChunkedPrefillConfig {
+  int64_t token_budget = 512;
+  int64_t max_chunk_tokens = 512;
+  int64_t min_prefill_tokens = 16;
+  double target_inter_token_latency_ms = 0.0;
+};
+
+/**
+ * A sequence to prefill and decode.
+ *
+ * The decoder runner and the prefiller must belong to this sequence alone,
+ * with a Module whose KV cache holds no other sequence, and must outlive it.
+ * The first token is the one that the prefill produces, sampled at
+ * temperature like the others. Generation stops after max_new_tokens tokens
+ * or at a token of eos_ids.
+ */
+struct ET_EXPERIMENTAL ScheduledSequence {
+  TextDecoderRunner* text_decoder_runner = nullptr;
+  TextPrefiller* text_prefiller = nullptr;
+  std::vector<uint64_t> prompt_tokens;
+  int64_t start_pos = 0;
+  int32_t max_new_tokens = 128;
+  float temperature = 0.0f;
+  std::unordered_set<uint64_t> eos_ids;
+  // Called on the scheduling thread with each generated token.
+  std::function<void(uint64_t)> token_callback;
+  // Called on the scheduling thread once, with Error::Ok when the sequence
+  // finishes normally or with the error that ended it.
+  std::function<void(runtime::Error)> done_callback;
+};
+
+/**
+ * Schedules prefill chunks and decode steps of many sequences, in the manner
+ * of Sarathi-Serve: decodes go first, and prefills fill the rest of a token
+ * budget per iteration. Sequences can be submitted from any thread; step()
+ * and run() must be called from one thread.
+ */
+class ET_EXPERIMENTAL ChunkedPrefillScheduler {
+ public:
+  struct Counters {
+    int64_t iterations = 0;
+    int64_t prefill_chunks = 0;
+    int64_t prefill_tokens = 0;
+    int64_t decode_steps = 0;
+    // The running estimates behind target_inter_token_latency_ms.
+    double decode_step_ms = 0.0;
+    double prefill_token_ms = 0.0;
+  };
+
+  explicit ChunkedPrefillScheduler(ChunkedPrefillConfig config = {});
+
+  /**
+   * Queues a sequence, to be prefilled after the ones queued before it.
+   *
+   * @returns The id of the sequence, or InvalidArgument.
+   */
+  runtime::Result<int64_t> submit(ScheduledSequence sequence);
+
+  /**
+   * Runs one iteration: a decode step for each decoding sequence, then the
+   * prefill chunks that the budget allows. A sequence whose step fails ends
+   * with the error, without stopping the others.
+   *
+   * @returns The number of tokens processed, 0 once there is no work.
+   */
+  int64_t step();
+
+  /**
+   * Runs iterations until every submitted sequence has finished, including
+   * those submitted meanwhile.
+   */
+  void run();
+
+  /**
+   * Returns the number of submitted sequences that have not finished.
+   */
+  size_t num_active() const {
+    return num_active_.load();
+  }
+
+  const Counters& counters() const {
+    return counters_;
+  }
+
+  const ChunkedPrefillConfig& config() const {
+    return config_;
+  }
+
+ private:
+  struct Sequence {
+    int64_t id;
+    ScheduledSequence request;
+    // Prompt tokens prefilled so far.
+    size_t num_prefilled = 0;
+    int64_t pos = 0;
+    uint64_t cur_token = 0;
+    int32_t num_generated = 0;
+    // The prompt tokens of the current chunk.
+    std::vector<uint64_t> chunk;
+    // The decode step input, which wraps cur_token.
+    TensorPtr token_tensor;
+  };
+
+  // Returns the prefill tokens of the next iteration given its decodes.
+  int64_t prefill_budget(int64_t num_decodes) const;
+  // Passes the token on; returns true when the sequence is done.
+  bool emit(Sequence& sequence, uint64_t token);
+  void finish(Sequence& sequence, runtime::Error error);
+  runtime::Error decode_step(Sequence& sequence);
+  runtime::Error prefill_chunk(Sequence& sequence, int64_t num_tokens);
+
+  ChunkedPrefillConfig config_;
+  Counters counters_;
+
+  std::mutex submit_mutex_;
+  std::vector<std::unique_ptr<Sequence>> submitted_;
+  int64_t next_id_ = 0;
+  std::atomic<size_t> num_active_{0};
+
+  // Owned by the scheduling thread.
+  std::deque<std::unique_ptr<Sequence>> prefilling_;
+  std::vector<std::unique_ptr<Sequence>> decoding_;
+};
+
+} // namespace executorch::extension::llm
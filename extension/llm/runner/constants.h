@@ -18,6 +18,9 @@ inline constexpr auto kMaxContextLen = "get_max_context_len";
 inline constexpr auto kVocabSize = "get_vocab_size";
 inline constexpr auto kUseKVCache = "use_kv_cache";
 inline constexpr auto kUseSDPAWithKVCache = "use_sdpa_with_kv_cache";
+// Whether the KV caches are ring buffers that keep the last positions, as for
+// sliding window attention, so that generation is not bounded by their size.
+inline constexpr auto kUseRingKVCache = "use_ring_kv_cache";
 
 // Multimodal method name conventions
 inline constexpr auto kVisionEncoderMethod = "vision_encoder";
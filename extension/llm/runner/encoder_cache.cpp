@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/llm/runner/encoder_cache.h>
+
+#include <cinttypes>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <c10/util/safe_numerics.h>
+#include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
+#include <executorch/runtime/platform/log.h>
+
+namespace executorch::extension::llm {
+
+using ::executorch::runtime::Error;
+
+namespace {
+
+constexpr char kFileMagic[8] = {'E', 'T', 'E', 'N', 'C', 'C', '0', '2'};
+// Longer model ids are not from a file written by save().
+constexpr uint64_t kMaxModelIdLength = 1 << 16;
+constexpr uint32_t kMaxDim = 16;
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t fmix(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDULL;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+// Two independent 64-bit lanes over 8-byte words, in the style of xxHash64
+// rounds. Fields are hashed one after the other, each padded to whole words
+// and followed by its length.
+class Hasher {
+ public:
+  void update(uint64_t word) {
+    lane0_ = rotl(lane0_ + word * kPrime2, 31) * kPrime1;
+    lane1_ = rotl(lane1_ ^ (word * kPrime1), 27) * kPrime2 + kPrime3;
+  }
+
+  void update(const void* data, size_t nbytes) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    size_t i = 0;
+    for (; i + 8 <= nbytes; i += 8) {
+      uint64_t word = 0;
+      std::memcpy(&word, bytes + i, 8);
+      update(word);
+    }
+    if (i < nbytes) {
+      uint64_t word = 0;
+      std::memcpy(&word, bytes + i, nbytes - i);
+      update(word);
+    }
+    update(static_cast<uint64_t>(nbytes));
+  }
+
+  EncoderCache::Key key() const {
+    return {{fmix(lane0_), fmix(lane1_ ^ lane0_)}};
+  }
+
+ private:
+  uint64_t lane0_ = 0x165667B19E3779F9ULL;
+  uint64_t lane1_ = 0x85EBCA77C2B2AE63ULL;
+};
+
+template <typename T>
+bool write_value(std::ofstream& file, const T& value) {
+  return static_cast<bool>(
+      file.write(reinterpret_cast<const char*>(&value), sizeof(T)));
+}
+
+template <typename T>
+bool read_value(std::ifstream& file, T& value) {
+  return static_cast<bool>(
+      file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+} // namespace
+
+EncoderCache::EncoderCache(size_t max_bytes, std::string model_id)
+    : max_bytes_(max_bytes), model_id_(std::move(model_id)) {}
+
+std::optional<EncoderCache::Key> EncoderCache::key(
+    const char* method_name,
+    const MultimodalInput& input) const {
+  Hasher hasher;
+  hasher.update(model_id_.data(), model_id_.size());
+  hasher.update(method_name, std::strlen(method_name));
+  if (input.is_image()) {
+    const Image& image = input.get_image();
+    hasher.update(static_cast<uint64_t>(image.channels()));
+    hasher.update(static_cast<uint64_t>(image.height()));
+    hasher.update(static_cast<uint64_t>(image.width()));
+    if (image.is_float()) {
+      hasher.update(uint64_t{1});
+      const auto& data = image.get_float_data();
+      hasher.update(data.data(), data.size() * sizeof(float));
+    } else {
+      hasher.update(uint64_t{0});
+      const auto& data = image.get_uint8_data();
+      hasher.update(data.data(), data.size());
+    }
+    return hasher.key();
+  }
+  if (input.is_audio()) {
+    const Audio& audio = input.get_audio();
+    hasher.update(static_cast<uint64_t>(audio.get_batch_size()));
+    hasher.update(static_cast<uint64_t>(audio.get_n_bins()));
+    hasher.update(static_cast<uint64_t>(audio.get_n_frames()));
+    if (audio.is_float()) {
+      hasher.update(uint64_t{1});
+      const auto& data = audio.get_float_data();
+      hasher.update(data.data(), data.size() * sizeof(float));
+    } else {
+      hasher.update(uint64_t{0});
+      const auto& data = audio.get_uint8_data();
+      hasher.update(data.data(), data.size());
+    }
+    return hasher.key();
+  }
+  return std::nullopt;
+}
+
+TensorPtr EncoderCache::get(const Key& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++num_misses_;
+    return nullptr;
+  }
+  ++num_hits_;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->output;
+}
+
+void EncoderCache::put(const Key& key, const executorch::aten::Tensor& output) {
+  if (output.nbytes() > max_bytes_) {
+    return;
+  }
+  // Copy outside of the lock, the copy of a large output takes a while.
+  TensorPtr copy = clone_tensor_ptr(output);
+  std::lock_guard<std::mutex> lock(mutex_);
+  put_locked(key, std::move(copy));
+}
+
+void EncoderCache::put_locked(const Key& key, TensorPtr output) {
+  const size_t nbytes = output->nbytes();
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    size_bytes_ -= it->second->nbytes;
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  while (!entries_.empty() && size_bytes_ + nbytes > max_bytes_) {
+    size_bytes_ -= entries_.back().nbytes;
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+  entries_.push_front(Entry{key, std::move(output), nbytes});
+  index_[key] = entries_.begin();
+  size_bytes_ += nbytes;
+}
+
+Error EncoderCache::save(const std::string& path) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  ET_CHECK_OR_RETURN_ERROR(
+      file.is_open(), AccessFailed, "Failed to open %s", path.c_str());
+
+  bool ok = static_cast<bool>(file.write(kFileMagic, sizeof(kFileMagic))) &&
+      write_value(file, static_cast<uint64_t>(model_id_.size())) &&
+      file.write(model_id_.data(), model_id_.size()) &&
+      write_value(file, static_cast<uint64_t>(entries_.size()));
+  for (auto it = entries_.rbegin(); ok && it != entries_.rend(); ++it) {
+    const executorch::aten::Tensor& output = *it->output;
+    ok = write_value(file, it->key.hash[0]) &&
+        write_value(file, it->key.hash[1]) &&
+        write_value(file, static_cast<int32_t>(output.scalar_type())) &&
+        write_value(file, static_cast<uint32_t>(output.dim()));
+    for (ssize_t d = 0; ok && d < output.dim(); ++d) {
+      ok = write_value(file, static_cast<int32_t>(output.size(d)));
+    }
+    ok = ok && write_value(file, static_cast<uint64_t>(output.nbytes())) &&
+        file.write(
+            static_cast<const char*>(output.const_data_ptr()),
+            output.nbytes());
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      ok, AccessFailed, "Failed to write %s", path.c_str());
+  return Error::Ok;
+}
+
+Error EncoderCache::load(const std::string& path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  ET_CHECK_OR_RETURN_ERROR(
+      file.is_open(), AccessFailed, "Failed to open %s", path.c_str());
+  // Bounds the byte counts of the entries, so that a corrupt or truncated file
+  // never makes us allocate more than the file holds.
+  const std::streamoff file_size = file.tellg();
+  file.seekg(0);
+
+  char magic[sizeof(kFileMagic)];
+  uint64_t model_id_length = 0;
+  ET_CHECK_OR_RETURN_ERROR(
+      file.read(magic, sizeof(magic)) &&
+          std::memcmp(magic, kFileMagic, sizeof(magic)) == 0 &&
+          read_value(file, model_id_length) &&
+          model_id_length <= kMaxModelIdLength,
+      InvalidExternalData,
+      "%s is not an encoder cache file",
+      path.c_str());
+  std::string model_id(model_id_length, '\0');
+  uint64_t num_entries = 0;
+  ET_CHECK_OR_RETURN_ERROR(
+      file.read(model_id.data(), model_id_length) &&
+          read_value(file, num_entries),
+      InvalidExternalData,
+      "%s is not an encoder cache file",
+      path.c_str());
+  ET_CHECK_OR_RETURN_ERROR(
+      model_id == model_id_,
+      InvalidExternalData,
+      "%s was saved for model '%s', not '%s'",
+      path.c_str(),
+      model_id.c_str(),
+      model_id_.c_str());
+
+  for (uint64_t i = 0; i < num_entries; ++i) {
+    Key key;
+    int32_t dtype = 0;
+    uint32_t dim = 0;
+    ET_CHECK_OR_RETURN_ERROR(
+        read_value(file, key.hash[0]) && read_value(file, key.hash[1]) &&
+            read_value(file, dtype) && read_value(file, dim) &&
+            dim <= kMaxDim,
+        InvalidExternalData,
+        "Malformed entry %" PRIu64 " in %s",
+        i,
+        path.c_str());
+    std::vector<executorch::aten::SizesType> sizes(dim);
+    size_t numel = 1;
+    for (auto& size : sizes) {
+      int32_t value = 0;
+      ET_CHECK_OR_RETURN_ERROR(
+          read_value(file, value) && value >= 0 &&
+              !c10::mul_overflows(numel, static_cast<size_t>(value), &numel),
+          InvalidExternalData,
+          "Malformed entry %" PRIu64 " in %s",
+          i,
+          path.c_str());
+      size = value;
+    }
+    const auto type = static_cast<executorch::aten::ScalarType>(dtype);
+    uint64_t nbytes = 0;
+    size_t expected_nbytes = 0;
+    ET_CHECK_OR_RETURN_ERROR(
+        runtime::isValid(type) &&
+            !c10::mul_overflows(
+                numel, runtime::elementSize(type), &expected_nbytes) &&
+            read_value(file, nbytes) && nbytes == expected_nbytes,
+        InvalidExternalData,
+        "Malformed entry %" PRIu64 " in %s",
+        i,
+        path.c_str());
+    const std::streamoff offset = file.tellg();
+    ET_CHECK_OR_RETURN_ERROR(
+        offset >= 0 && nbytes <= static_cast<uint64_t>(file_size - offset),
+        InvalidExternalData,
+        "Truncated entry %" PRIu64 " in %s",
+        i,
+        path.c_str());
+    if (nbytes > max_bytes_) {
+      // Too large to ever be cached here; skip its data without reading it.
+      file.seekg(static_cast<std::streamoff>(nbytes), std::ios::cur);
+      continue;
+    }
+    std::vector<uint8_t> data(nbytes);
+    ET_CHECK_OR_RETURN_ERROR(
+        file.read(reinterpret_cast<char*>(data.data()), nbytes),
+        InvalidExternalData,
+        "Truncated entry %" PRIu64 " in %s",
+        i,
+        path.c_str());
+    TensorPtr output =
+        make_tensor_ptr(std::move(sizes), std::move(data), type);
+    std::lock_guard<std::mutex> lock(mutex_);
+    put_locked(key, std::move(output));
+  }
+  return Error::Ok;
+}
+
+void EncoderCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  size_bytes_ = 0;
+}
+
+size_t EncoderCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+size_t EncoderCache::size_bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_bytes_;
+}
+
+uint64_t EncoderCache::num_hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_hits_;
+}
+
+uint64_t EncoderCache::num_misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_misses_;
+}
+
+} // namespace executorch::extension::llm
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Cache of the encoder outputs of image and audio inputs, so that a
+// multimodal conversation that sends the same image or audio clip again does
+// not run its encoder again.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include <executorch/extension/llm/runner/multimodal_input.h>
+#include <executorch/extension/tensor/tensor_ptr.h>
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/platform/compiler.h>
+
+namespace executorch::extension::llm {
+
+/**
+ * A byte-bounded, least recently used cache of encoder outputs, keyed by a
+ * 128-bit hash of the model id, of the encoder method and of the dtype, shape
+ * and bytes of the input.
+ *
+ * The cache owns copies of the outputs. A lookup hands out shared ownership
+ * of the copy, so an output stays valid for as long as the caller uses it,
+ * even if the cache evicts it meanwhile. All methods are thread-safe.
+ */
+class ET_EXPERIMENTAL EncoderCache final {
+ public:
+  struct Key {
+    uint64_t hash[2];
+
+    bool operator==(const Key& other) const {
+      return hash[0] == other.hash[0] && hash[1] == other.hash[1];
+    }
+  };
+
+  /**
+   * @param max_bytes The total size of the cached outputs above which the
+   * least recently used ones are evicted.
+   * @param model_id Identifies the model whose encoder outputs are cached,
+   * e.g. the path and version of its .pte file. Outputs are only reused for
+   * the same model id, and load() rejects files saved under another one, so
+   * caches of different models, or of different exports of a model, must use
+   * different ids.
+   */
+  explicit EncoderCache(size_t max_bytes, std::string model_id = "");
+
+  EncoderCache(const EncoderCache&) = delete;
+  EncoderCache& operator=(const EncoderCache&) = delete;
+
+  /**
+   * Returns the key of an image or audio input for the given encoder method
+   * of this cache's model, or nullopt for the other inputs.
+   */
+  std::optional<Key> key(const char* method_name, const MultimodalInput& input)
+      const;
+
+  /**
+   * Returns the cached output for the key and marks it as the most recently
+   * used, or nullptr if there is none.
+   */
+  TensorPtr get(const Key& key);
+
+  /**
+   * Caches a copy of the output for the key, evicting the least recently used
+   * outputs to stay within max_bytes. Outputs larger than max_bytes are not
+   * cached.
+   */
+  void put(const Key& key, const executorch::aten::Tensor& output);
+
+  /**
+   * Writes the model id and the cached outputs to a file, from the least to
+   * the most recently used, in native byte order.
+   */
+  runtime::Error save(const std::string& path) const;
+
+  /**
+   * Adds the outputs in a file written by save() to the cache, as the most
+   * recently used in the order of the file. Fails with InvalidExternalData
+   * without adding any output if the file was saved under another model id.
+   */
+  runtime::Error load(const std::string& path);
+
+  void clear();
+
+  size_t size() const;
+  size_t size_bytes() const;
+  size_t max_bytes() const {
+    return max_bytes_;
+  }
+  const std::string& model_id() const {
+    return model_id_;
+  }
+  uint64_t num_hits() const;
+  uint64_t num_misses() const;
+
+ private:
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return static_cast<size_t>(key.hash[0]);
+    }
+  };
+  struct Entry {
+    Key key;
+    TensorPtr output;
+    size_t nbytes;
+  };
+
+  void put_locked(const Key& key, TensorPtr output);
+
+  const size_t max_bytes_;
+  const std::string model_id_;
+  mutable std::mutex mutex_;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+  size_t size_bytes_ = 0;
+  uint64_t num_hits_ = 0;
+  uint64_t num_misses_ = 0;
+};
+
+} // namespace executorch::extension::llm
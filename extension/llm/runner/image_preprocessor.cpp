@@ -0,0 +1,542 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/llm/runner/image_preprocessor.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <type_traits>
+
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+#include <executorch/runtime/platform/log.h>
+
+namespace executorch::extension::llm {
+
+using ::executorch::aten::ScalarType;
+using ::executorch::aten::SizesType;
+using ::executorch::runtime::Error;
+using ::executorch::runtime::Result;
+
+namespace {
+
+// Output rows per task of the threadpool.
+constexpr int64_t kRowGrainSize = 8;
+// Floats of an input row combined by the vertical pass at a time.
+constexpr size_t kVerticalBlock = 256;
+
+float bilinear_filter(float x) {
+  x = std::abs(x);
+  return x < 1.0f ? 1.0f - x : 0.0f;
+}
+
+float bicubic_filter(float x) {
+  constexpr float a = -0.5f;
+  x = std::abs(x);
+  if (x < 1.0f) {
+    return ((a + 2.0f) * x - (a + 3.0f)) * x * x + 1.0f;
+  }
+  if (x < 2.0f) {
+    return (((x - 5.0f) * x + 8.0f) * x - 4.0f) * a;
+  }
+  return 0.0f;
+}
+
+// The filter taps along one axis: output i reads the `taps` inputs from
+// start[i] on, weighted by weights[i * taps + k]. Every output has the same
+// number of taps, those past the filter support weigh zero, so that the
+// loops over them have a fixed trip count.
+struct AxisTaps {
+  int32_t taps = 0;
+  std::vector<int32_t> start;
+  std::vector<float> weights;
+};
+
+// Taps of the outputs [crop_offset, crop_offset + crop_size) of an axis
+// resized from in_size to out_size, with pixel centers aligned as PIL does.
+AxisTaps compute_taps(
+    int32_t in_size,
+    int32_t out_size,
+    int32_t crop_offset,
+    int32_t crop_size,
+    ResizeFilter filter,
+    bool antialias) {
+  const double scale = static_cast<double>(in_size) / out_size;
+  const double filter_scale = antialias ? std::max(scale, 1.0) : 1.0;
+  const double support =
+      (filter == ResizeFilter::Bicubic ? 2.0 : 1.0) * filter_scale;
+  const auto filter_fn =
+      filter == ResizeFilter::Bicubic ? bicubic_filter : bilinear_filter;
+
+  AxisTaps axis;
+  axis.taps = std::min(
+      static_cast<int32_t>(std::ceil(support)) * 2 + 1, in_size);
+  axis.start.resize(crop_size);
+  axis.weights.assign(static_cast<size_t>(crop_size) * axis.taps, 0.0f);
+  for (int32_t i = 0; i < crop_size; ++i) {
+    const double center = (crop_offset + i + 0.5) * scale;
+    const int32_t lo =
+        std::max(static_cast<int32_t>(center - support + 0.5), 0);
+    const int32_t hi =
+        std::min(static_cast<int32_t>(center + support + 0.5), in_size);
+    // Near the end of the axis the window starts early instead of running
+    // past it, and its first taps weigh zero.
+    const int32_t start = std::min(lo, in_size - axis.taps);
+    float* weights = &axis.weights[static_cast<size_t>(i) * axis.taps];
+    double total = 0.0;
+    for (int32_t j = lo; j < hi; ++j) {
+      const float weight =
+          filter_fn(static_cast<float>((j + 0.5 - center) / filter_scale));
+      weights[j - start] = weight;
+      total += weight;
+    }
+    if (total != 0.0) {
+      for (int32_t k = 0; k < axis.taps; ++k) {
+        weights[k] = static_cast<float>(weights[k] / total);
+      }
+    }
+    axis.start[i] = start;
+  }
+  return axis;
+}
+
+struct Geometry {
+  int32_t resized_width;
+  int32_t resized_height;
+  int32_t crop_x;
+  int32_t crop_y;
+  int32_t crop_width;
+  int32_t crop_height;
+};
+
+int32_t scale_edge(int32_t edge, int32_t target, int32_t other) {
+  return std::max(
+      static_cast<int32_t>(other * static_cast<double>(target) / edge), 1);
+}
+
+Error compute_geometry(
+    const ImagePreprocessorConfig& config,
+    int32_t width,
+    int32_t height,
+    int32_t channels,
+    Geometry& geometry) {
+  ET_CHECK_OR_RETURN_ERROR(
+      width > 0 && height > 0,
+      InvalidArgument,
+      "Invalid image size %" PRId32 "x%" PRId32,
+      width,
+      height);
+  ET_CHECK_OR_RETURN_ERROR(
+      channels >= 1 && channels <= 4,
+      InvalidArgument,
+      "Images must have 1 to 4 channels, got %" PRId32,
+      channels);
+  ET_CHECK_OR_RETURN_ERROR(
+      config.dtype == ScalarType::Float || config.dtype == ScalarType::Half ||
+          config.dtype == ScalarType::BFloat16 ||
+          config.dtype == ScalarType::Byte,
+      InvalidArgument,
+      "Unsupported output dtype %s",
+      ::executorch::runtime::toString(config.dtype));
+  ET_CHECK_OR_RETURN_ERROR(
+      (config.mean.empty() ||
+       config.mean.size() == static_cast<size_t>(channels)) &&
+          (config.std.empty() ||
+           config.std.size() == static_cast<size_t>(channels)),
+      InvalidArgument,
+      "mean and std must have one value per channel");
+  for (float deviation : config.std) {
+    ET_CHECK_OR_RETURN_ERROR(
+        deviation != 0.0f, InvalidArgument, "std must not be zero");
+  }
+
+  if (config.shortest_edge > 0 || config.longest_edge > 0) {
+    const bool width_is_edge = config.shortest_edge > 0
+        ? width <= height
+        : width >= height;
+    const int32_t target = config.shortest_edge > 0 ? config.shortest_edge
+                                                    : config.longest_edge;
+    if (width_is_edge) {
+      geometry.resized_width = target;
+      geometry.resized_height = scale_edge(width, target, height);
+    } else {
+      geometry.resized_height = target;
+      geometry.resized_width = scale_edge(height, target, width);
+    }
+  } else if (config.resize_width > 0 && config.resize_height > 0) {
+    geometry.resized_width = config.resize_width;
+    geometry.resized_height = config.resize_height;
+  } else {
+    geometry.resized_width = width;
+    geometry.resized_height = height;
+  }
+
+  geometry.crop_width =
+      config.crop_width > 0 ? config.crop_width : geometry.resized_width;
+  geometry.crop_height =
+      config.crop_height > 0 ? config.crop_height : geometry.resized_height;
+  ET_CHECK_OR_RETURN_ERROR(
+      geometry.crop_width <= geometry.resized_width &&
+          geometry.crop_height <= geometry.resized_height,
+      InvalidArgument,
+      "Crop %" PRId32 "x%" PRId32 " is larger than the resized image %" PRId32
+      "x%" PRId32,
+      geometry.crop_width,
+      geometry.crop_height,
+      geometry.resized_width,
+      geometry.resized_height);
+  geometry.crop_x = (geometry.resized_width - geometry.crop_width) / 2;
+  geometry.crop_y = (geometry.resized_height - geometry.crop_height) / 2;
+
+  ET_CHECK_OR_RETURN_ERROR(
+      config.tile_size <= 0 ||
+          (geometry.crop_width % config.tile_size == 0 &&
+           geometry.crop_height % config.tile_size == 0),
+      InvalidArgument,
+      "Output %" PRId32 "x%" PRId32 " is not a multiple of tile size %" PRId32,
+      geometry.crop_width,
+      geometry.crop_height,
+      config.tile_size);
+  return Error::Ok;
+}
+
+// Everything the row loop needs to know about one image.
+struct Plan {
+  const uint8_t* data;
+  size_t stride;
+  int32_t channels;
+  int32_t width;
+  int32_t height;
+  AxisTaps x;
+  AxisTaps y;
+  // Per channel, output = clamp(pixel, 0, 255) * scale + bias.
+  float scale[4];
+  float bias[4];
+};
+
+// Reduces an interleaved float row, which starts at input column x.start[0],
+// to one row of `width` outputs per channel.
+template <int kChannels>
+void horizontal_pass(const float* row, const AxisTaps& x, float* out) {
+  const int32_t taps = x.taps;
+  const size_t width = x.start.size();
+  const int32_t first_column = x.start[0];
+  for (size_t i = 0; i < width; ++i) {
+    const float* src =
+        row + static_cast<size_t>(x.start[i] - first_column) * kChannels;
+    const float* weights = &x.weights[i * taps];
+    float acc[kChannels] = {};
+    for (int32_t k = 0; k < taps; ++k) {
+      for (int c = 0; c < kChannels; ++c) {
+        acc[c] += weights[k] * src[k * kChannels + c];
+      }
+    }
+    for (int c = 0; c < kChannels; ++c) {
+      out[c * width + i] = acc[c];
+    }
+  }
+}
+
+void horizontal_pass(
+    int32_t channels,
+    const float* row,
+    const AxisTaps& x,
+    float* out) {
+  switch (channels) {
+    case 1:
+      return horizontal_pass<1>(row, x, out);
+    case 2:
+      return horizontal_pass<2>(row, x, out);
+    case 3:
+      return horizontal_pass<3>(row, x, out);
+    default:
+      return horizontal_pass<4>(row, x, out);
+  }
+}
+
+template <typename CTYPE>
+void store_row(
+    const float* row,
+    int32_t n,
+    float scale,
+    float bias,
+    CTYPE* out) {
+  for (int32_t i = 0; i < n; ++i) {
+    const float pixel = std::min(std::max(row[i], 0.0f), 255.0f);
+    if constexpr (std::is_same_v<CTYPE, uint8_t>) {
+      out[i] = static_cast<uint8_t>(pixel + 0.5f);
+    } else {
+      out[i] = static_cast<CTYPE>(pixel * scale + bias);
+    }
+  }
+}
+
+// Computes output row y of an image and stores it into out, the output of
+// the whole image. The vertical pass runs first, over the contiguous bytes of
+// the input rows, so that it vectorizes and the scalar horizontal pass only
+// sees as many rows as there are outputs.
+template <typename CTYPE>
+void preprocess_row(
+    const Plan& plan,
+    int32_t tile_size,
+    int32_t y,
+    CTYPE* out,
+    std::vector<float>& row,
+    std::vector<float>& resized) {
+  const int32_t width = plan.width;
+  const int32_t first_column = plan.x.start[0];
+  const size_t row_size =
+      static_cast<size_t>(plan.x.start.back() + plan.x.taps - first_column) *
+      plan.channels;
+  row.resize(row_size);
+  resized.resize(static_cast<size_t>(plan.channels) * width);
+
+  const int32_t taps = plan.y.taps;
+  const float* weights = &plan.y.weights[static_cast<size_t>(y) * taps];
+  const uint8_t* first_row = plan.data +
+      static_cast<size_t>(plan.y.start[y]) * plan.stride +
+      static_cast<size_t>(first_column) * plan.channels;
+  for (size_t begin = 0; begin < row_size; begin += kVerticalBlock) {
+    const size_t n = std::min(kVerticalBlock, row_size - begin);
+    // Whole blocks accumulate into a local array with a fixed trip count,
+    // which needs neither alias checks nor a remainder loop to vectorize.
+    float acc[kVerticalBlock] = {};
+    for (int32_t k = 0; k < taps; ++k) {
+      const float weight = weights[k];
+      if (weight == 0.0f) {
+        continue;
+      }
+      const uint8_t* src = first_row + k * plan.stride + begin;
+      if (n == kVerticalBlock) {
+        for (size_t j = 0; j < kVerticalBlock; ++j) {
+          acc[j] += weight * static_cast<float>(src[j]);
+        }
+      } else {
+        for (size_t j = 0; j < n; ++j) {
+          acc[j] += weight * static_cast<float>(src[j]);
+        }
+      }
+    }
+    std::copy(acc, acc + n, row.begin() + begin);
+  }
+  horizontal_pass(plan.channels, row.data(), plan.x, resized.data());
+
+  for (int32_t c = 0; c < plan.channels; ++c) {
+    const float* values = resized.data() + static_cast<size_t>(c) * width;
+    if (tile_size <= 0) {
+      store_row(
+          values,
+          width,
+          plan.scale[c],
+          plan.bias[c],
+          out + (static_cast<size_t>(c) * plan.height + y) * width);
+      continue;
+    }
+    // The [num_tiles, channels, tile_size, tile_size] layout of
+    // preprocess::tile_crop, where the tiles are in row-major order.
+    const size_t tile_numel = static_cast<size_t>(tile_size) * tile_size;
+    const int32_t tiles_per_row = width / tile_size;
+    CTYPE* tile_row = out +
+        (static_cast<size_t>(y / tile_size) * tiles_per_row * plan.channels +
+         c) *
+            tile_numel +
+        static_cast<size_t>(y % tile_size) * tile_size;
+    for (int32_t t = 0; t < tiles_per_row; ++t) {
+      store_row(
+          values + t * tile_size,
+          tile_size,
+          plan.scale[c],
+          plan.bias[c],
+          tile_row + t * plan.channels * tile_numel);
+    }
+  }
+}
+
+template <typename CTYPE>
+Error run(const std::vector<Plan>& plans, int32_t tile_size, CTYPE* out) {
+  // The output rows of all the images, one after the other.
+  std::vector<int64_t> row_offsets(plans.size() + 1, 0);
+  for (size_t i = 0; i < plans.size(); ++i) {
+    row_offsets[i + 1] = row_offsets[i] + plans[i].height;
+  }
+  const size_t image_numel = static_cast<size_t>(plans[0].channels) *
+      plans[0].height * plans[0].width;
+
+  const bool success = ::executorch::extension::parallel_for(
+      0, row_offsets.back(), kRowGrainSize, [&](int64_t begin, int64_t end) {
+        std::vector<float> row;
+        std::vector<float> resized;
+        size_t image = std::upper_bound(
+                           row_offsets.begin(), row_offsets.end(), begin) -
+            row_offsets.begin() - 1;
+        for (int64_t i = begin; i < end; ++i) {
+          while (i >= row_offsets[image + 1]) {
+            ++image;
+          }
+          preprocess_row(
+              plans[image],
+              tile_size,
+              static_cast<int32_t>(i - row_offsets[image]),
+              out + image * image_numel,
+              row,
+              resized);
+        }
+      });
+  ET_CHECK_OR_RETURN_ERROR(success, Internal, "parallel_for failed");
+  return Error::Ok;
+}
+
+} // namespace
+
+ImagePreprocessor::ImagePreprocessor(ImagePreprocessorConfig config)
+    : config_(std::move(config)) {}
+
+Result<std::vector<SizesType>> ImagePreprocessor::output_sizes(
+    int32_t width,
+    int32_t height,
+    int32_t channels) const {
+  Geometry geometry;
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      compute_geometry(config_, width, height, channels, geometry));
+  if (config_.tile_size > 0) {
+    const int32_t tile = config_.tile_size;
+    return std::vector<SizesType>{
+        (geometry.crop_width / tile) * (geometry.crop_height / tile),
+        channels,
+        tile,
+        tile};
+  }
+  return std::vector<SizesType>{
+      channels, geometry.crop_height, geometry.crop_width};
+}
+
+Result<TensorPtr> ImagePreprocessor::preprocess(
+    const ImageBuffer& image) const {
+  auto sizes = output_sizes(image.width, image.height, image.channels);
+  ET_CHECK_OK_OR_RETURN_ERROR(sizes.error());
+  auto tensor = empty(std::move(*sizes), config_.dtype);
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      preprocess_into(&image, 1, tensor->mutable_data_ptr()));
+  return tensor;
+}
+
+Result<TensorPtr> ImagePreprocessor::preprocess(
+    const std::vector<ImageBuffer>& images) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      !images.empty(), InvalidArgument, "No images to preprocess");
+  auto sizes =
+      output_sizes(images[0].width, images[0].height, images[0].channels);
+  ET_CHECK_OK_OR_RETURN_ERROR(sizes.error());
+  for (size_t i = 1; i < images.size(); ++i) {
+    auto other =
+        output_sizes(images[i].width, images[i].height, images[i].channels);
+    ET_CHECK_OK_OR_RETURN_ERROR(other.error());
+    ET_CHECK_OR_RETURN_ERROR(
+        *other == *sizes,
+        InvalidArgument,
+        "Image %zu has a different output size than image 0",
+        i);
+  }
+  sizes->insert(sizes->begin(), static_cast<SizesType>(images.size()));
+  auto tensor = empty(std::move(*sizes), config_.dtype);
+  ET_CHECK_OK_OR_RETURN_ERROR(preprocess_into(
+      images.data(), images.size(), tensor->mutable_data_ptr()));
+  return tensor;
+}
+
+Result<Image> ImagePreprocessor::preprocess_to_image(
+    const ImageBuffer& image) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      config_.tile_size <= 0 &&
+          (config_.dtype == ScalarType::Float ||
+           config_.dtype == ScalarType::Byte),
+      InvalidArgument,
+      "Images hold untiled Float or Byte data");
+  auto sizes = output_sizes(image.width, image.height, image.channels);
+  ET_CHECK_OK_OR_RETURN_ERROR(sizes.error());
+  const int32_t height = (*sizes)[1];
+  const int32_t width = (*sizes)[2];
+  const size_t numel = static_cast<size_t>(image.channels) * height * width;
+  if (config_.dtype == ScalarType::Byte) {
+    std::vector<uint8_t> data(numel);
+    ET_CHECK_OK_OR_RETURN_ERROR(preprocess_into(&image, 1, data.data()));
+    return Image(std::move(data), width, height, image.channels);
+  }
+  std::vector<float> data(numel);
+  ET_CHECK_OK_OR_RETURN_ERROR(preprocess_into(&image, 1, data.data()));
+  return Image(std::move(data), width, height, image.channels);
+}
+
+Error ImagePreprocessor::preprocess_into(
+    const ImageBuffer* images,
+    size_t num_images,
+    void* out) const {
+  std::vector<Plan> plans(num_images);
+  for (size_t i = 0; i < num_images; ++i) {
+    const ImageBuffer& image = images[i];
+    Geometry geometry;
+    ET_CHECK_OK_OR_RETURN_ERROR(compute_geometry(
+        config_, image.width, image.height, image.channels, geometry));
+    const size_t row_bytes = static_cast<size_t>(image.width) * image.channels;
+    ET_CHECK_OR_RETURN_ERROR(
+        image.data != nullptr &&
+            image.stride >= 0 &&
+            (image.stride == 0 ||
+             static_cast<size_t>(image.stride) >= row_bytes),
+        InvalidArgument,
+        "Image %zu has no data or a stride shorter than its rows",
+        i);
+
+    Plan& plan = plans[i];
+    plan.data = image.data;
+    plan.stride = image.stride > 0 ? image.stride : row_bytes;
+    plan.channels = image.channels;
+    plan.width = geometry.crop_width;
+    plan.height = geometry.crop_height;
+    plan.x = compute_taps(
+        image.width,
+        geometry.resized_width,
+        geometry.crop_x,
+        geometry.crop_width,
+        config_.filter,
+        config_.antialias);
+    plan.y = compute_taps(
+        image.height,
+        geometry.resized_height,
+        geometry.crop_y,
+        geometry.crop_height,
+        config_.filter,
+        config_.antialias);
+    for (int32_t c = 0; c < image.channels; ++c) {
+      const float mean = config_.mean.empty() ? 0.0f : config_.mean[c];
+      const float deviation = config_.std.empty() ? 1.0f : config_.std[c];
+      plan.scale[c] = config_.rescale / deviation;
+      plan.bias[c] = -mean / deviation;
+    }
+  }
+
+  const int32_t tile_size = config_.tile_size;
+  switch (config_.dtype) {
+    case ScalarType::Float:
+      return run(plans, tile_size, static_cast<float*>(out));
+    case ScalarType::Half:
+      return run(plans, tile_size, static_cast<executorch::aten::Half*>(out));
+    case ScalarType::BFloat16:
+      return run(
+          plans, tile_size, static_cast<executorch::aten::BFloat16*>(out));
+    case ScalarType::Byte:
+      return run(plans, tile_size, static_cast<uint8_t*>(out));
+    default:
+      // compute_geometry() rejects the other dtypes.
+      return Error::InvalidArgument;
+  }
+}
+
+} // namespace executorch::extension::llm
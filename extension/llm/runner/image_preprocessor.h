@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Turns 8-bit images, as they come out of an image decoder or a camera, into
+// the input tensors of image encoders: resize, center crop, normalization,
+// HWC to CHW and dtype conversion in one pass over the pixels.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <executorch/extension/llm/runner/image.h>
+#include <executorch/extension/tensor/tensor_ptr.h>
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/compiler.h>
+
+namespace executorch::extension::llm {
+
+enum class ResizeFilter {
+  Bilinear,
+  // Keys cubic with a = -0.5, as PIL uses.
+  Bicubic,
+};
+
+/**
+ * An 8-bit image with interleaved channels (HWC), such as RGB. The image does
+ * not own its pixels.
+ */
+struct ET_EXPERIMENTAL ImageBuffer {
+  const uint8_t* data = nullptr;
+  int32_t width = 0;
+  int32_t height = 0;
+  int32_t channels = 3;
+  // Bytes from the start of one row to the next; width * channels if 0.
+  int32_t stride = 0;
+};
+
+struct ET_EXPERIMENTAL ImagePreprocessorConfig {
+  // The size to resize to. If shortest_edge or longest_edge is set instead,
+  // that edge is resized to it and the other one keeps the aspect ratio. If
+  // none is set, the image keeps its size.
+  int32_t resize_width = 0;
+  int32_t resize_height = 0;
+  int32_t shortest_edge = 0;
+  int32_t longest_edge = 0;
+  ResizeFilter filter = ResizeFilter::Bicubic;
+  // Whether downscaling widens the filter to cover all the pixels that map to
+  // an output pixel, as PIL does, rather than sampling some of them.
+  bool antialias = true;
+
+  // The size of the region kept from the center of the resized image. Zero
+  // keeps the whole image.
+  int32_t crop_width = 0;
+  int32_t crop_height = 0;
+
+  // Floating point outputs are (pixel * rescale - mean[c]) / std[c], where
+  // the resized pixels are clamped to [0, 255]. Empty mean and std stand for
+  // zeros and ones.
+  float rescale = 1.0f / 255.0f;
+  std::vector<float> mean;
+  std::vector<float> std;
+
+  // Float, Half, BFloat16 or Byte. Byte outputs are the resized pixels,
+  // rounded, without rescale and normalization.
+  executorch::aten::ScalarType dtype = executorch::aten::ScalarType::Float;
+
+  // If positive, the output is cut into tile_size x tile_size tiles in the
+  // layout of the preprocess::tile_crop op, [num_tiles, channels, tile_size,
+  // tile_size], rather than [channels, height, width].
+  int32_t tile_size = 0;
+};
+
+/**
+ * Preprocesses images for an image encoder, with the output rows spread over
+ * the threadpool.
+ *
+ * The resize is separable and precomputes the filter taps of each output row
+ * and column. For each output row, a vertical pass combines the input rows
+ * under the filter into one float row, in a loop over their contiguous bytes
+ * that vectorizes, and a horizontal pass reduces it to the output row of each
+ * channel, which is clamped, normalized and converted as it is stored. No
+ * intermediate image is written out, and pixels outside the crop are never
+ * computed.
+ */
+class ET_EXPERIMENTAL ImagePreprocessor final {
+ public:
+  explicit ImagePreprocessor(ImagePreprocessorConfig config);
+
+  /**
+   * Returns the sizes of the output for an image of the given size, or
+   * InvalidArgument if the config does not apply to it.
+   */
+  runtime::Result<std::vector<executorch::aten::SizesType>>
+  output_sizes(int32_t width, int32_t height, int32_t channels = 3) const;
+
+  /**
+   * Preprocesses an image into a new tensor of output_sizes().
+   */
+  runtime::Result<TensorPtr> preprocess(const ImageBuffer& image) const;
+
+  /**
+   * Preprocesses images into a new tensor of their output_sizes(), which must
+   * be the same, with a leading batch dimension. The rows of all the images
+   * are spread over the threadpool together.
+   */
+  runtime::Result<TensorPtr> preprocess(
+      const std::vector<ImageBuffer>& images) const;
+
+  /**
+   * Preprocesses an image into an Image to pass to a MultimodalRunner. The
+   * dtype must be Float or Byte, and the output must not be tiled.
+   */
+  runtime::Result<Image> preprocess_to_image(const ImageBuffer& image) const;
+
+  const ImagePreprocessorConfig& config() const {
+    return config_;
+  }
+
+ private:
+  runtime::Error preprocess_into(
+      const ImageBuffer* images,
+      size_t num_images,
+      void* out) const;
+
+  ImagePreprocessorConfig config_;
+};
+
+} // namespace executorch::extension::llm
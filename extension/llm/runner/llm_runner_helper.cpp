@@ -13,6 +13,7 @@
 #include <executorch/extension/llm/runner/multimodal_decoder_runner.h>
 #include <executorch/extension/llm/runner/multimodal_prefiller.h>
 #include <executorch/extension/llm/runner/multimodal_runner.h>
+#include <executorch/extension/llm/runner/pipelined_multimodal_prefiller.h>
 #include <executorch/extension/llm/runner/stats.h>
 #include <executorch/extension/llm/runner/text_llm_runner.h>
 #include <executorch/extension/llm/runner/text_prefiller.h>
@@ -96,6 +97,7 @@ get_llm_metadata(tokenizers::Tokenizer* tokenizer, Module* module) {
       {llm::kMaxContextLen, 128},
       {llm::kUseKVCache, true},
       {llm::kUseSDPAWithKVCache, false},
+      {llm::kUseRingKVCache, false},
   });
 
   // Read metadata from the model
@@ -284,7 +286,8 @@ std::unique_ptr<MultimodalRunner> create_multimodal_runner(
     const std::string& model_path,
     std::unique_ptr<::tokenizers::Tokenizer> tokenizer,
     std::optional<const std::string> data_path,
-    Module::LoadMode load_mode) {
+    Module::LoadMode load_mode,
+    size_t num_encoder_threads) {
   // Sanity check tokenizer
   if (!tokenizer || !tokenizer->is_loaded()) {
     ET_LOG(Error, "Tokenizer is null or not loaded");
@@ -318,15 +321,39 @@ std::unique_ptr<MultimodalRunner> create_multimodal_runner(
   auto text_decoder_runner =
       std::make_unique<MultimodalDecoderRunner>(module.get(), io_manager.get());
 
+  auto stats = std::make_unique<Stats>();
+
   // Create multimodal_prefiller
-  auto multimodal_prefiller = std::make_unique<MultimodalPrefiller>(
-      module.get(),
-      text_decoder_runner.get(),
-      tokenizer.get(),
-      io_manager.get());
+  std::unique_ptr<MultimodalPrefiller> multimodal_prefiller;
+  if (num_encoder_threads > 0) {
+    // Without external data, the encoder modules share the program, and its
+    // constant data, with the main module, which loaded it for the metadata.
+    std::vector<std::unique_ptr<Module>> encoder_modules;
+    for (size_t i = 0; i < num_encoder_threads; ++i) {
+      if (data_path.has_value()) {
+        encoder_modules.push_back(
+            std::make_unique<Module>(model_path, data_path.value(), load_mode));
+      } else {
+        encoder_modules.push_back(std::make_unique<Module>(module->program()));
+      }
+    }
+    multimodal_prefiller = std::make_unique<PipelinedMultimodalPrefiller>(
+        module.get(),
+        text_decoder_runner.get(),
+        tokenizer.get(),
+        io_manager.get(),
+        std::move(encoder_modules),
+        stats.get());
+  } else {
+    multimodal_prefiller = std::make_unique<MultimodalPrefiller>(
+        module.get(),
+        text_decoder_runner.get(),
+        tokenizer.get(),
+        io_manager.get(),
+        stats.get());
+  }
 
   // Create text_token_generator with stats
-  auto stats = std::make_unique<Stats>();
   auto text_token_generator = std::make_unique<TextTokenGenerator>(
       tokenizer.get(),
       text_decoder_runner.get(),
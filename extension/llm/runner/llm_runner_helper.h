@@ -150,6 +150,10 @@ ET_EXPERIMENTAL std::unique_ptr<TextLLMRunner> create_text_llm_runner(
  * @param model_path Path to the model file
  * @param tokenizer Initialized tokenizer instance
  * @param data_path Optional path to additional .ptd required by the model
+ * @param load_mode How to load the model file
+ * @param num_encoder_threads Number of threads, each with its own instance
+ * of the encoder methods, that run the image and audio encoders ahead of the
+ * text decoder during prefill. 0 runs them in turn with the text decoder.
  * @return std::unique_ptr<MultimodalRunner> Initialized MultimodalRunner
  * instance, or nullptr on failure
  */
@@ -157,6 +161,7 @@ ET_EXPERIMENTAL std::unique_ptr<MultimodalRunner> create_multimodal_runner(
     const std::string& model_path,
     std::unique_ptr<::tokenizers::Tokenizer> tokenizer,
     std::optional<const std::string> data_path = std::nullopt,
-    Module::LoadMode load_mode = Module::LoadMode::File);
+    Module::LoadMode load_mode = Module::LoadMode::File,
+    size_t num_encoder_threads = 0);
 
 } // namespace executorch::extension::llm
@@ -0,0 +1,506 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/llm/runner/log_mel_spectrogram.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <limits>
+
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/kernels/portable/cpu/util/vectorized_math.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+#include <executorch/runtime/platform/log.h>
+#include <pocketfft_hdronly.h>
+
+namespace executorch::extension::llm {
+
+using ::executorch::aten::ScalarType;
+using ::executorch::aten::SizesType;
+using ::executorch::aten::Tensor;
+using ::executorch::runtime::Error;
+using ::executorch::runtime::Result;
+
+namespace {
+
+// Frames per task of the threadpool.
+constexpr int64_t kFrameGrainSize = 8;
+constexpr float kLog10OfE = 0.434294481903251828f;
+constexpr double kPi = 3.14159265358979323846;
+
+// The Slaney mel scale of librosa, linear below 1 kHz and logarithmic above.
+constexpr double kMelLinearHz = 200.0 / 3.0;
+constexpr double kMelLogHz = 1000.0;
+constexpr double kMelLogMel = kMelLogHz / kMelLinearHz;
+
+double hz_to_mel(double hz) {
+  const double log_step = std::log(6.4) / 27.0;
+  return hz < kMelLogHz ? hz / kMelLinearHz
+                        : kMelLogMel + std::log(hz / kMelLogHz) / log_step;
+}
+
+double mel_to_hz(double mel) {
+  const double log_step = std::log(6.4) / 27.0;
+  return mel < kMelLogMel ? mel * kMelLinearHz
+                          : kMelLogHz * std::exp(log_step * (mel - kMelLogMel));
+}
+
+int64_t padded_length(const LogMelConfig& config, int64_t num_samples) {
+  if (config.pad_to_multiple <= 0) {
+    return num_samples;
+  }
+  return (num_samples + config.pad_to_multiple - 1) / config.pad_to_multiple *
+      config.pad_to_multiple;
+}
+
+// Returns the index of the frame dimension of a tensor of the layout.
+size_t frame_dim(const LogMelConfig& config, size_t dim) {
+  return config.layout == MelLayout::MelsByFrames ? dim - 1 : dim - 2;
+}
+
+Error check_output(
+    const LogMelConfig& config,
+    const Tensor& out,
+    int64_t num_frames) {
+  ET_CHECK_OR_RETURN_ERROR(
+      out.scalar_type() == ScalarType::Float ||
+          out.scalar_type() == ScalarType::Half ||
+          out.scalar_type() == ScalarType::BFloat16,
+      InvalidArgument,
+      "Unsupported output dtype %s",
+      ::executorch::runtime::toString(out.scalar_type()));
+  ET_CHECK_OR_RETURN_ERROR(
+      out.dim() >= 2, InvalidArgument, "The output needs at least 2 dims");
+  const size_t frames = frame_dim(config, out.dim());
+  const size_t mels = config.layout == MelLayout::MelsByFrames
+      ? out.dim() - 2
+      : out.dim() - 1;
+  ET_CHECK_OR_RETURN_ERROR(
+      out.size(frames) == num_frames && out.size(mels) == config.n_mels &&
+          out.numel() == num_frames * config.n_mels,
+      InvalidArgument,
+      "The output must hold %" PRId64 " frames of %" PRId32 " mels",
+      num_frames,
+      config.n_mels);
+  return Error::Ok;
+}
+
+template <typename CTYPE>
+void store_frames(
+    const LogMelConfig& config,
+    const float* log_mels,
+    int64_t count,
+    float min_log_mel,
+    CTYPE* out) {
+  const float scale = 1.0f / config.log_divisor;
+  const int32_t n_mels = config.n_mels;
+  for (int64_t t = 0; t < count; ++t) {
+    const float* row = log_mels + t * n_mels;
+    for (int32_t m = 0; m < n_mels; ++m) {
+      const float value =
+          (std::max(row[m], min_log_mel) + config.log_offset) * scale;
+      const int64_t index = config.layout == MelLayout::MelsByFrames
+          ? m * count + t
+          : t * n_mels + m;
+      out[index] = static_cast<CTYPE>(value);
+    }
+  }
+}
+
+} // namespace
+
+struct LogMelSpectrogram::Plan {
+  explicit Plan(size_t n_fft) : fft(n_fft) {}
+
+  std::vector<float> window;
+  pocketfft::detail::pocketfft_r<float> fft;
+  // Mel filter m weighs the bins from mel_first_bin[m] on with
+  // mel_weights[mel_offsets[m]] to mel_weights[mel_offsets[m + 1] - 1].
+  std::vector<int32_t> mel_first_bin;
+  std::vector<int32_t> mel_offsets;
+  std::vector<float> mel_weights;
+};
+
+// A view of the audio: sample i of the stream is data[i - offset], the
+// samples from num_real on are zeros, and the audio reflects around its
+// first sample and, for a finite length, its last one.
+struct LogMelSpectrogram::Signal {
+  const float* data;
+  int64_t offset;
+  int64_t num_real;
+  int64_t length;
+
+  float sample(int64_t i) const {
+    if (i < 0) {
+      i = -i;
+    }
+    if (i >= length) {
+      i = 2 * length - 2 - i;
+    }
+    return i < num_real ? data[i - offset] : 0.0f;
+  }
+};
+
+Result<LogMelSpectrogram> LogMelSpectrogram::create(LogMelConfig config) {
+  const float nyquist = config.sample_rate / 2.0f;
+  if (config.f_max <= 0.0f) {
+    config.f_max = nyquist;
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      config.sample_rate > 0 && config.n_fft > 0 && config.hop_length > 0 &&
+          config.n_mels > 0,
+      InvalidArgument,
+      "sample_rate, n_fft, hop_length and n_mels must be positive");
+  ET_CHECK_OR_RETURN_ERROR(
+      config.f_min >= 0.0f && config.f_min < config.f_max &&
+          config.f_max <= nyquist,
+      InvalidArgument,
+      "Invalid mel frequency range [%f, %f]",
+      static_cast<double>(config.f_min),
+      static_cast<double>(config.f_max));
+  ET_CHECK_OR_RETURN_ERROR(
+      config.log_floor > 0.0f && config.log_divisor != 0.0f &&
+          config.pad_to_multiple >= 0,
+      InvalidArgument,
+      "log_floor must be positive, log_divisor nonzero and pad_to_multiple "
+      "not negative");
+
+  const int32_t n_fft = config.n_fft;
+  auto plan = std::make_unique<Plan>(n_fft);
+  plan->window.resize(n_fft);
+  for (int32_t i = 0; i < n_fft; ++i) {
+    plan->window[i] =
+        static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / n_fft));
+  }
+
+  // Triangular filters between consecutive mel points, scaled to the same
+  // area as Slaney's ("slaney" norm in librosa).
+  const int32_t n_bins = n_fft / 2 + 1;
+  const int32_t n_mels = config.n_mels;
+  const double min_mel = hz_to_mel(config.f_min);
+  const double max_mel = hz_to_mel(config.f_max);
+  std::vector<double> mel_hz(n_mels + 2);
+  for (int32_t i = 0; i < n_mels + 2; ++i) {
+    mel_hz[i] = mel_to_hz(min_mel + (max_mel - min_mel) * i / (n_mels + 1));
+  }
+  plan->mel_first_bin.resize(n_mels);
+  plan->mel_offsets.assign(1, 0);
+  for (int32_t m = 0; m < n_mels; ++m) {
+    const double norm = 2.0 / (mel_hz[m + 2] - mel_hz[m]);
+    int32_t first_bin = -1;
+    int32_t last_bin = -1;
+    std::vector<float> weights;
+    for (int32_t k = 0; k < n_bins; ++k) {
+      const double hz = static_cast<double>(k) * config.sample_rate / n_fft;
+      const double lower = (hz - mel_hz[m]) / (mel_hz[m + 1] - mel_hz[m]);
+      const double upper =
+          (mel_hz[m + 2] - hz) / (mel_hz[m + 2] - mel_hz[m + 1]);
+      const double weight = std::max(0.0, std::min(lower, upper)) * norm;
+      weights.push_back(static_cast<float>(weight));
+      if (weight > 0.0) {
+        first_bin = first_bin < 0 ? k : first_bin;
+        last_bin = k;
+      }
+    }
+    // A filter narrower than a bin can cover none of them.
+    plan->mel_first_bin[m] = std::max(first_bin, 0);
+    if (first_bin >= 0) {
+      plan->mel_weights.insert(
+          plan->mel_weights.end(),
+          weights.begin() + first_bin,
+          weights.begin() + last_bin + 1);
+    }
+    plan->mel_offsets.push_back(
+        static_cast<int32_t>(plan->mel_weights.size()));
+  }
+
+  return LogMelSpectrogram(std::move(config), std::move(plan));
+}
+
+LogMelSpectrogram::LogMelSpectrogram(
+    LogMelConfig config,
+    std::unique_ptr<const Plan> plan)
+    : config_(std::move(config)), plan_(std::move(plan)) {}
+
+LogMelSpectrogram::LogMelSpectrogram(LogMelSpectrogram&&) noexcept = default;
+LogMelSpectrogram& LogMelSpectrogram::operator=(
+    LogMelSpectrogram&&) noexcept = default;
+LogMelSpectrogram::~LogMelSpectrogram() = default;
+
+int64_t LogMelSpectrogram::num_frames(int64_t num_samples) const {
+  return padded_length(config_, num_samples) / config_.hop_length;
+}
+
+Result<TensorPtr> LogMelSpectrogram::compute(
+    const float* samples,
+    size_t num_samples) const {
+  const SizesType frames = num_frames(num_samples);
+  auto tensor = empty(
+      config_.layout == MelLayout::MelsByFrames
+          ? std::vector<SizesType>{1, config_.n_mels, frames}
+          : std::vector<SizesType>{1, frames, config_.n_mels});
+  ET_CHECK_OK_OR_RETURN_ERROR(compute_into(samples, num_samples, *tensor));
+  return tensor;
+}
+
+Error LogMelSpectrogram::compute_into(
+    const float* samples,
+    size_t num_samples,
+    Tensor& out) const {
+  const int64_t frames = num_frames(num_samples);
+  ET_CHECK_OK_OR_RETURN_ERROR(check_output(config_, out, frames));
+  if (frames == 0) {
+    return Error::Ok;
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      samples != nullptr || num_samples == 0, InvalidArgument, "No samples");
+  const int64_t length = padded_length(config_, num_samples);
+  ET_CHECK_OR_RETURN_ERROR(
+      length > config_.n_fft / 2,
+      InvalidArgument,
+      "%" PRId64 " samples are too few to reflect a window of %" PRId32,
+      length,
+      config_.n_fft);
+
+  std::vector<float> log_mels(frames * config_.n_mels);
+  const Signal signal{
+      samples, 0, static_cast<int64_t>(num_samples), length};
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      compute_log_mels(signal, 0, frames, log_mels.data()));
+  return store(
+      log_mels.data(),
+      frames,
+      *std::max_element(log_mels.begin(), log_mels.end()),
+      out);
+}
+
+Error LogMelSpectrogram::compute_log_mels(
+    const Signal& signal,
+    int64_t first_frame,
+    int64_t count,
+    float* log_mels) const {
+  const Plan& plan = *plan_;
+  const int32_t n_fft = config_.n_fft;
+  const int32_t n_bins = n_fft / 2 + 1;
+  const int32_t n_mels = config_.n_mels;
+  const float log_floor = config_.log_floor;
+
+  const bool success = ::executorch::extension::parallel_for(
+      0, count, kFrameGrainSize, [&](int64_t begin, int64_t end) {
+        std::vector<float> frame(n_fft);
+        std::vector<float> power(n_bins);
+        for (int64_t t = begin; t < end; ++t) {
+          const int64_t start =
+              (first_frame + t) * config_.hop_length - n_fft / 2;
+          if (start >= 0 && start + n_fft <= signal.num_real) {
+            const float* src = signal.data + (start - signal.offset);
+            for (int32_t k = 0; k < n_fft; ++k) {
+              frame[k] = src[k] * plan.window[k];
+            }
+          } else {
+            for (int32_t k = 0; k < n_fft; ++k) {
+              frame[k] = signal.sample(start + k) * plan.window[k];
+            }
+          }
+
+          // In place, the real FFT leaves r0, r1, i1, r2, i2, ..., and
+          // r(n/2) last for even n.
+          plan.fft.exec(frame.data(), 1.0f, /*r2hc=*/true);
+          power[0] = frame[0] * frame[0];
+          for (int32_t k = 1; k < (n_fft + 1) / 2; ++k) {
+            const float re = frame[2 * k - 1];
+            const float im = frame[2 * k];
+            power[k] = re * re + im * im;
+          }
+          if (n_fft % 2 == 0) {
+            power[n_bins - 1] = frame[n_fft - 1] * frame[n_fft - 1];
+          }
+
+          float* row = log_mels + t * n_mels;
+          for (int32_t m = 0; m < n_mels; ++m) {
+            const float* bins = power.data() + plan.mel_first_bin[m];
+            const float* weights =
+                plan.mel_weights.data() + plan.mel_offsets[m];
+            const int32_t n = plan.mel_offsets[m + 1] - plan.mel_offsets[m];
+            float acc = 0.0f;
+            for (int32_t k = 0; k < n; ++k) {
+              acc += weights[k] * bins[k];
+            }
+            row[m] = std::max(acc, log_floor);
+          }
+        }
+
+        float* rows = log_mels + begin * n_mels;
+        const size_t n = static_cast<size_t>(end - begin) * n_mels;
+        ::executorch::math::fast_log_n(rows, rows, n);
+        for (size_t i = 0; i < n; ++i) {
+          rows[i] *= kLog10OfE;
+        }
+      });
+  ET_CHECK_OR_RETURN_ERROR(success, Internal, "parallel_for failed");
+  return Error::Ok;
+}
+
+Error LogMelSpectrogram::store(
+    const float* log_mels,
+    int64_t count,
+    float max_log_mel,
+    Tensor& out) const {
+  const float min_log_mel = config_.dynamic_range > 0.0f
+      ? max_log_mel - config_.dynamic_range
+      : -std::numeric_limits<float>::infinity();
+  switch (out.scalar_type()) {
+    case ScalarType::Float:
+      store_frames(
+          config_,
+          log_mels,
+          count,
+          min_log_mel,
+          out.mutable_data_ptr<float>());
+      return Error::Ok;
+    case ScalarType::Half:
+      store_frames(
+          config_,
+          log_mels,
+          count,
+          min_log_mel,
+          out.mutable_data_ptr<executorch::aten::Half>());
+      return Error::Ok;
+    case ScalarType::BFloat16:
+      store_frames(
+          config_,
+          log_mels,
+          count,
+          min_log_mel,
+          out.mutable_data_ptr<executorch::aten::BFloat16>());
+      return Error::Ok;
+    default:
+      // check_output() rejects the other dtypes.
+      return Error::InvalidArgument;
+  }
+}
+
+LogMelStream::LogMelStream(const LogMelSpectrogram& spectrogram)
+    : spectrogram_(spectrogram) {
+  reset();
+}
+
+namespace {
+
+// The number of frames whose windows lie within the first num_samples
+// samples, with the reflection at the start of the audio.
+int64_t complete_frames(const LogMelConfig& config, int64_t num_samples) {
+  const int32_t half = config.n_fft / 2;
+  const int32_t right = config.n_fft - half;
+  // The first frame reflects sample `half`, one past its window for even
+  // n_fft.
+  if (num_samples < right || num_samples <= half) {
+    return 0;
+  }
+  return (num_samples - right) / config.hop_length + 1;
+}
+
+} // namespace
+
+int64_t LogMelStream::num_ready_frames(size_t num_samples) const {
+  return std::max<int64_t>(
+      complete_frames(spectrogram_.config(), num_samples_ + num_samples) -
+          next_frame_,
+      0);
+}
+
+int64_t LogMelStream::num_final_frames() const {
+  return std::max<int64_t>(
+      spectrogram_.num_frames(num_samples_) - next_frame_, 0);
+}
+
+Result<int64_t> LogMelStream::accept(
+    const float* samples,
+    size_t num_samples,
+    TensorPtr& out) {
+  ET_CHECK_OR_RETURN_ERROR(
+      samples != nullptr || num_samples == 0, InvalidArgument, "No samples");
+  buffer_.insert(buffer_.end(), samples, samples + num_samples);
+  num_samples_ += num_samples;
+  return emit(
+      complete_frames(spectrogram_.config(), num_samples_),
+      std::numeric_limits<int64_t>::max(),
+      out);
+}
+
+Result<int64_t> LogMelStream::finish(TensorPtr& out) {
+  const LogMelConfig& config = spectrogram_.config();
+  const int64_t length = padded_length(config, num_samples_);
+  const int64_t end_frame =
+      std::max(spectrogram_.num_frames(num_samples_), next_frame_);
+  if (end_frame > next_frame_ && length <= config.n_fft / 2) {
+    ET_LOG(
+        Error,
+        "%" PRId64 " samples are too few to reflect a window of %" PRId32,
+        length,
+        config.n_fft);
+    reset();
+    return Error::InvalidArgument;
+  }
+  auto result = emit(end_frame, length, out);
+  reset();
+  return result;
+}
+
+void LogMelStream::reset() {
+  buffer_.clear();
+  buffer_start_ = 0;
+  num_samples_ = 0;
+  next_frame_ = 0;
+  max_log_mel_ = -std::numeric_limits<float>::infinity();
+}
+
+Result<int64_t> LogMelStream::emit(
+    int64_t end_frame,
+    int64_t signal_length,
+    TensorPtr& out) {
+  const LogMelConfig& config = spectrogram_.config();
+  const int64_t count = end_frame - next_frame_;
+  ET_CHECK_OR_RETURN_ERROR(
+      out && out->dim() >= 2,
+      InvalidArgument,
+      "The output needs at least 2 dims");
+  std::vector<SizesType> sizes(out->sizes().begin(), out->sizes().end());
+  sizes[frame_dim(config, sizes.size())] = count;
+  ET_CHECK_OK_OR_RETURN_ERROR(resize_tensor_ptr(out, sizes));
+  ET_CHECK_OK_OR_RETURN_ERROR(check_output(config, *out, count));
+  if (count == 0) {
+    return 0;
+  }
+
+  log_mels_.resize(count * config.n_mels);
+  const LogMelSpectrogram::Signal signal{
+      buffer_.data(), buffer_start_, num_samples_, signal_length};
+  ET_CHECK_OK_OR_RETURN_ERROR(spectrogram_.compute_log_mels(
+      signal, next_frame_, count, log_mels_.data()));
+  max_log_mel_ = std::max(
+      max_log_mel_, *std::max_element(log_mels_.begin(), log_mels_.end()));
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      spectrogram_.store(log_mels_.data(), count, max_log_mel_, *out));
+  next_frame_ = end_frame;
+
+  // Later frames start at keep_from or after it, which stays 0 while they
+  // still reflect around the first sample.
+  const int64_t keep_from = std::min(
+      std::max<int64_t>(next_frame_ * config.hop_length - config.n_fft / 2, 0),
+      num_samples_);
+  if (keep_from > buffer_start_) {
+    buffer_.erase(buffer_.begin(), buffer_.begin() + (keep_from - buffer_start_));
+    buffer_start_ = keep_from;
+  }
+  return count;
+}
+
+} // namespace executorch::extension::llm
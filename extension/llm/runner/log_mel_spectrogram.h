@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Computes the log-mel spectrogram of mono audio natively, as the input of
+// audio encoders such as Whisper's, without a preprocessor model.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <executorch/extension/tensor/tensor_ptr.h>
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/compiler.h>
+
+namespace executorch::extension::llm {
+
+enum class MelLayout {
+  // [..., n_mels, n_frames], as Whisper's encoder takes.
+  MelsByFrames,
+  // [..., n_frames, n_mels].
+  FramesByMels,
+};
+
+/**
+ * The defaults are those of Whisper, and of WhisperAudioProcessor in
+ * extension/audio/mel_spectrogram.py: a periodic Hann window, frames centered
+ * on every hop_length-th sample with reflection at the edges, the power
+ * spectrum, Slaney mel filters and
+ *
+ *   log_mel = max(log10(max(mel, log_floor)), max_log_mel - dynamic_range)
+ *   output = (log_mel + log_offset) / log_divisor
+ *
+ * where max_log_mel is the largest log_mel of the audio.
+ */
+struct ET_EXPERIMENTAL LogMelConfig {
+  int32_t sample_rate = 16000;
+  int32_t n_fft = 400;
+  int32_t hop_length = 160;
+  int32_t n_mels = 80;
+  // The frequency range of the mel filters; f_max of 0 is sample_rate / 2.
+  float f_min = 0.0f;
+  float f_max = 0.0f;
+
+  float log_floor = 1e-10f;
+  // Zero or less disables the clamping relative to the maximum.
+  float dynamic_range = 8.0f;
+  float log_offset = 4.0f;
+  float log_divisor = 4.0f;
+
+  // If positive, the audio is padded with zeros to a multiple of this many
+  // samples, as Whisper pads to 30 s chunks (480000 samples).
+  int64_t pad_to_multiple = 0;
+
+  MelLayout layout = MelLayout::MelsByFrames;
+};
+
+/**
+ * Computes log-mel spectrograms, with the frames spread over the threadpool.
+ *
+ * Each frame is windowed, transformed with a real FFT from pocketfft, squared
+ * into its power spectrum and reduced by the mel filters, which are stored as
+ * the contiguous range of bins each one covers rather than as a dense
+ * [n_mels, n_fft / 2 + 1] matrix. The logarithms are taken in bulk with the
+ * polynomial log of vectorized_math.h. Audio of num_samples samples gives
+ * num_samples / hop_length frames after padding.
+ */
+class ET_EXPERIMENTAL LogMelSpectrogram final {
+ public:
+  /**
+   * Returns a LogMelSpectrogram for the config, with its window, FFT plan and
+   * mel filters precomputed, or InvalidArgument.
+   */
+  static runtime::Result<LogMelSpectrogram> create(LogMelConfig config = {});
+
+  LogMelSpectrogram(LogMelSpectrogram&&) noexcept;
+  LogMelSpectrogram& operator=(LogMelSpectrogram&&) noexcept;
+  ~LogMelSpectrogram();
+
+  /**
+   * Returns the number of frames of audio of num_samples samples.
+   */
+  int64_t num_frames(int64_t num_samples) const;
+
+  /**
+   * Computes the log-mel spectrogram of the samples into a new Float tensor
+   * of shape [1, n_mels, num_frames] or [1, num_frames, n_mels].
+   */
+  runtime::Result<TensorPtr> compute(
+      const float* samples,
+      size_t num_samples) const;
+
+  /**
+   * Computes the log-mel spectrogram of the samples into out, such as the
+   * input tensor of an encoder. out must be Float, Half or BFloat16, its last
+   * two dimensions must be those of the layout and the others must be 1.
+   */
+  runtime::Error compute_into(
+      const float* samples,
+      size_t num_samples,
+      executorch::aten::Tensor& out) const;
+
+  const LogMelConfig& config() const {
+    return config_;
+  }
+
+ private:
+  friend class LogMelStream;
+  struct Plan;
+  struct Signal;
+
+  LogMelSpectrogram(LogMelConfig config, std::unique_ptr<const Plan> plan);
+
+  // Computes frames [first_frame, first_frame + count) of the signal into
+  // log_mels, one row of n_mels floored log10 values per frame.
+  runtime::Error compute_log_mels(
+      const Signal& signal,
+      int64_t first_frame,
+      int64_t count,
+      float* log_mels) const;
+
+  // Clamps and scales count frames of log_mels, and stores them into out.
+  runtime::Error store(
+      const float* log_mels,
+      int64_t count,
+      float max_log_mel,
+      executorch::aten::Tensor& out) const;
+
+  LogMelConfig config_;
+  std::unique_ptr<const Plan> plan_;
+};
+
+/**
+ * Computes the log-mel spectrogram of audio that arrives in chunks, emitting
+ * each frame as soon as the samples under its window are available, and the
+ * last frames, which reflect at the end of the audio, when the stream
+ * finishes. The frames are the same as those of LogMelSpectrogram::compute()
+ * over all the samples, except for the dynamic_range clamping, which is
+ * relative to the maximum of the frames emitted so far.
+ */
+class ET_EXPERIMENTAL LogMelStream final {
+ public:
+  explicit LogMelStream(const LogMelSpectrogram& spectrogram);
+
+  /**
+   * Returns the number of frames that accept() of num_samples more samples
+   * emits, to size the out tensor.
+   */
+  int64_t num_ready_frames(size_t num_samples) const;
+
+  /**
+   * Returns the number of frames that finish() emits.
+   */
+  int64_t num_final_frames() const;
+
+  /**
+   * Appends samples to the stream and writes the frames that became complete
+   * into out, which is resized to hold exactly them along its frame
+   * dimension; see LogMelSpectrogram::compute_into() for its other
+   * requirements. out must have room for num_ready_frames(num_samples)
+   * frames.
+   *
+   * @returns The number of frames written, possibly zero.
+   */
+  runtime::Result<int64_t> accept(
+      const float* samples,
+      size_t num_samples,
+      TensorPtr& out);
+
+  /**
+   * Ends the stream and writes its remaining num_final_frames() frames into
+   * out, as accept() does. The stream can then be reused for new audio.
+   */
+  runtime::Result<int64_t> finish(TensorPtr& out);
+
+  /**
+   * Drops the samples received so far and starts a new stream.
+   */
+  void reset();
+
+  int64_t num_frames_emitted() const {
+    return next_frame_;
+  }
+
+ private:
+  runtime::Result<int64_t>
+  emit(int64_t end_frame, int64_t signal_length, TensorPtr& out);
+
+  const LogMelSpectrogram& spectrogram_;
+  // The samples from index buffer_start_ of the stream on.
+  std::vector<float> buffer_;
+  int64_t buffer_start_ = 0;
+  int64_t num_samples_ = 0;
+  int64_t next_frame_ = 0;
+  float max_log_mel_;
+  std::vector<float> log_mels_;
+};
+
+} // namespace executorch::extension::llm
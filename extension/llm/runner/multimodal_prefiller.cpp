@@ -10,6 +10,8 @@
 // audio (to be implemented)) to prefill the KV cache of a multimodal LLM.
 // @lint-ignore-every CLANGTIDY facebook-hte-Deprecated
 
+#include <optional>
+
 #include <executorch/extension/llm/runner/constants.h>
 #include <executorch/extension/llm/runner/multimodal_prefiller.h>
 #include <executorch/extension/llm/runner/util.h>
@@ -21,11 +23,13 @@ MultimodalPrefiller::MultimodalPrefiller(
     Module* module,
     MultimodalDecoderRunner* decoder_runner,
     Tokenizer* tokenizer,
-    IOManager* io_manager)
+    IOManager* io_manager,
+    Stats* stats)
     : module_(module),
       text_decoder_runner_(decoder_runner),
       tokenizer_(tokenizer),
-      io_manager_(io_manager) {}
+      io_manager_(io_manager),
+      stats_(stats) {}
 
 /**
  * Prefill an LLM Module with the given multimodal input.
@@ -39,12 +43,62 @@ Result<uint64_t> MultimodalPrefiller::prefill(
     int64_t& start_pos,
     int32_t bos,
     int32_t eos) {
-  // 1. Run encoder model.
+  // 1. Run encoder model, unless its output is cached.
+  const long encode_start_ms = time_in_ms();
+  TensorPtr cached_output;
+  auto encode_result = encode_cached(module_, input, bos, eos, cached_output);
+  if (!encode_result.ok()) {
+    return encode_result.error();
+  }
+  const long encode_end_ms = time_in_ms();
+
+  // 2. Run decoder model for prefill.
+  auto prefill_result = prefill_embeddings(encode_result.get(), start_pos);
+  if (stats_ != nullptr) {
+    if (input.is_image() || input.is_audio()) {
+      if (cached_output) {
+        ++stats_->encoder_cache_hits;
+      } else if (encoder_cache_ != nullptr) {
+        ++stats_->encoder_cache_misses;
+      }
+      stats_->aggregate_encoder_time_ms += encode_end_ms - encode_start_ms;
+      stats_->aggregate_decoder_prefill_time_ms +=
+          time_in_ms() - encode_end_ms;
+    } else {
+      stats_->aggregate_decoder_prefill_time_ms +=
+          time_in_ms() - encode_start_ms;
+    }
+  }
+  return prefill_result;
+}
+
+Result<uint64_t> MultimodalPrefiller::prefill(
+    ::executorch::runtime::Span<const MultimodalInput> inputs,
+    int64_t& start_pos,
+    int32_t bos,
+    int32_t eos) {
+  uint64_t last_token = 0;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    auto prefill_result = prefill(
+        inputs[i], start_pos, i == 0 ? bos : 0, i == 0 ? eos : 0);
+    if (!prefill_result.ok()) {
+      return prefill_result.error();
+    }
+    last_token = prefill_result.get();
+  }
+  return last_token;
+}
+
+Result<::executorch::runtime::EValue> MultimodalPrefiller::encode(
+    Module* module,
+    const MultimodalInput& input,
+    int32_t bos,
+    int32_t eos) {
   ::executorch::runtime::EValue encoder_output;
   if (input.is_image()) {
     const Image& image = input.get_image();
 
-    auto method_meta_result = module_->method_meta(kVisionEncoderMethod);
+    auto method_meta_result = module->method_meta(kVisionEncoderMethod);
     ET_CHECK_OK_OR_RETURN_ERROR(
         method_meta_result.error(),
         "Failed to get method_meta for %s",
@@ -109,7 +163,7 @@ Result<uint64_t> MultimodalPrefiller::prefill(
         ::executorch::runtime::toString(image_tensor->scalar_type()));
     // Run image encoder
     auto image_encoder_result =
-        module_->execute(kVisionEncoderMethod, image_tensor);
+        module->execute(kVisionEncoderMethod, image_tensor);
     ET_CHECK_OK_OR_RETURN_ERROR(image_encoder_result.error());
     auto image_encoder_outputs = image_encoder_result.get();
 
@@ -117,7 +171,7 @@ Result<uint64_t> MultimodalPrefiller::prefill(
   } else if (input.is_audio()) {
     const Audio& audio = input.get_audio();
 
-    auto method_meta_result = module_->method_meta(kAudioEncoderMethod);
+    auto method_meta_result = module->method_meta(kAudioEncoderMethod);
     ET_CHECK_OK_OR_RETURN_ERROR(
         method_meta_result.error(),
         "Failed to get method_meta for %s",
@@ -167,7 +221,7 @@ Result<uint64_t> MultimodalPrefiller::prefill(
 
     // Run audio encoder
     auto audio_encoder_result =
-        module_->execute(kAudioEncoderMethod, audio_tensor);
+        module->execute(kAudioEncoderMethod, audio_tensor);
     if (audio_encoder_result.error() != ::executorch::runtime::Error::Ok) {
       return ::executorch::runtime::Error::Internal;
     }
@@ -208,9 +262,36 @@ Result<uint64_t> MultimodalPrefiller::prefill(
     // For any other input types, return error
     return ::executorch::runtime::Error::NotSupported;
   }
+  return encoder_output;
+}
 
-  // 2. Run decoder model for prefill.
+Result<::executorch::runtime::EValue> MultimodalPrefiller::encode_cached(
+    Module* module,
+    const MultimodalInput& input,
+    int32_t bos,
+    int32_t eos,
+    TensorPtr& cached_output) {
+  std::optional<EncoderCache::Key> key;
+  if (encoder_cache_ != nullptr) {
+    key = encoder_cache_->key(
+        input.is_image() ? kVisionEncoderMethod : kAudioEncoderMethod, input);
+  }
+  if (key.has_value()) {
+    cached_output = encoder_cache_->get(*key);
+    if (cached_output) {
+      return ::executorch::runtime::EValue(*cached_output);
+    }
+  }
+  auto encode_result = encode(module, input, bos, eos);
+  if (key.has_value() && encode_result.ok() && encode_result->isTensor()) {
+    encoder_cache_->put(*key, encode_result->toTensor());
+  }
+  return encode_result;
+}
 
+Result<uint64_t> MultimodalPrefiller::prefill_embeddings(
+    const ::executorch::runtime::EValue& encoder_output,
+    int64_t& start_pos) {
   // Get expected shape of cache position tensor, which should be the second
   // argument
 
@@ -11,11 +11,17 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
+#include <executorch/extension/llm/runner/encoder_cache.h>
 #include <executorch/extension/llm/runner/multimodal_decoder_runner.h>
 #include <executorch/extension/llm/runner/multimodal_input.h>
+#include <executorch/extension/llm/runner/stats.h>
 #include <executorch/extension/llm/runner/text_decoder_runner.h>
 #include <executorch/extension/llm/sampler/sampler.h>
 #include <executorch/extension/module/module.h>
+#include <executorch/runtime/core/span.h>
 #include <executorch/runtime/platform/compiler.h>
 #include <pytorch/tokenizers/tokenizer.h>
 
@@ -29,11 +35,16 @@ using tokenizers::Tokenizer;
 // This prefiller supports both image and audio inputs
 class ET_EXPERIMENTAL MultimodalPrefiller {
  public:
+  /**
+   * @param stats If not null, receives the time spent in the encoders and in
+   * the text decoder during prefill.
+   */
   explicit MultimodalPrefiller(
       Module* module,
       MultimodalDecoderRunner* decoder_runner,
       Tokenizer* tokenizer,
-      IOManager* io_manager);
+      IOManager* io_manager,
+      Stats* stats = nullptr);
 
   /**
    * Prefill an LLM Module with the given multimodal input.
@@ -48,16 +59,97 @@ class ET_EXPERIMENTAL MultimodalPrefiller {
       int32_t bos = 0,
       int32_t eos = 0);
 
+  /**
+   * Prefill an LLM Module with the given multimodal inputs, in order.
+   * @param inputs The multimodal inputs to the multimodal LLM.
+   * @param start_pos The starting position in KV cache of the first input in
+   * the LLM. It's passed as reference and will be updated inside this
+   * function.
+   * @param bos The number of BOS tokens to prepend to the first input, if it
+   * is text.
+   * @param eos The number of EOS tokens to append to the first input, if it
+   * is text.
+   * @return The next token of the LLM Module after the last input.
+   */
+  virtual Result<uint64_t> prefill(
+      ::executorch::runtime::Span<const MultimodalInput> inputs,
+      int64_t& start_pos,
+      int32_t bos = 0,
+      int32_t eos = 0);
+
+  /**
+   * Prefill an LLM Module with all of the given multimodal inputs, in order.
+   */
+  Result<uint64_t> prefill(
+      const std::vector<MultimodalInput>& inputs,
+      int64_t& start_pos,
+      int32_t bos = 0,
+      int32_t eos = 0) {
+    return prefill(
+        ::executorch::runtime::Span<const MultimodalInput>(
+            inputs.data(), inputs.size()),
+        start_pos,
+        bos,
+        eos);
+  }
+
   virtual Error load();
   virtual bool is_method_loaded();
 
+  /**
+   * Reuse the encoder outputs of image and audio inputs from the given cache,
+   * and cache those of new ones. The cache can be shared with other
+   * prefillers of the same model. Pass nullptr to always run the encoders.
+   */
+  void set_encoder_cache(std::shared_ptr<EncoderCache> encoder_cache) {
+    encoder_cache_ = std::move(encoder_cache);
+  }
+
   virtual ~MultimodalPrefiller() = default;
 
  protected:
+  /**
+   * Run the encoder of an image or audio input on the given Module, or the
+   * token embedding of a text or tokens input on module_.
+   * @return The embeddings of the input, which stay valid until the same
+   * method of the same Module runs again.
+   */
+  virtual Result<::executorch::runtime::EValue> encode(
+      Module* module,
+      const MultimodalInput& input,
+      int32_t bos,
+      int32_t eos);
+
+  /**
+   * Like encode(), but reuse the output for an image or audio input from the
+   * encoder cache if it is there, and cache it otherwise.
+   * @param cached_output Set to the cached output that is returned, if any,
+   * which it keeps alive for as long as the caller uses it.
+   */
+  Result<::executorch::runtime::EValue> encode_cached(
+      Module* module,
+      const MultimodalInput& input,
+      int32_t bos,
+      int32_t eos,
+      TensorPtr& cached_output);
+
+  /**
+   * Run the text decoder on the embeddings of an input.
+   * @param encoder_output The output of encode().
+   * @param start_pos The starting position in KV cache of the embeddings. It
+   * will be advanced past them.
+   * @return The next token of the LLM Module after prefill.
+   */
+  virtual Result<uint64_t> prefill_embeddings(
+      const ::executorch::runtime::EValue& encoder_output,
+      int64_t& start_pos);
+
   Module* module_;
   MultimodalDecoderRunner* text_decoder_runner_;
   Tokenizer* tokenizer_;
   IOManager* io_manager_;
+  Stats* stats_;
+  std::shared_ptr<EncoderCache> encoder_cache_;
 };
 
 } // namespace executorch::extension::llm
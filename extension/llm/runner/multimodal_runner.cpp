@@ -89,36 +89,32 @@ Result<uint64_t> MultimodalRunner::prefill(
     const std::vector<MultimodalInput>& inputs,
     int32_t num_bos,
     int32_t num_eos) {
-  uint64_t last_token = 0;
-  for (size_t i = 0; i < inputs.size(); ++i) {
-    const auto& input = inputs[i];
-    int32_t bos = 0;
-    int32_t eos = 0;
-    if (i == 0 && pos_ == 0) {
-      if (input.is_text() || input.is_tokens()) {
-        bos = num_bos;
-        eos = num_eos;
-      } else if (num_bos > 0) {
-        // Non-text first input: prepend BOS via a token input
-        auto it = metadata_.find(kBosId);
-        if (it != metadata_.end()) {
-          std::vector<uint64_t> bos_tokens(
-              num_bos, static_cast<uint64_t>(it->second));
-          MultimodalInput bos_input(std::move(bos_tokens));
-          auto bos_result = multimodal_prefiller_->prefill(bos_input, pos_);
-          if (!bos_result.ok()) {
-            return bos_result.error();
-          }
-          last_token = bos_result.get();
+  int32_t bos = 0;
+  int32_t eos = 0;
+  if (!inputs.empty() && pos_ == 0) {
+    const auto& input = inputs[0];
+    if (input.is_text() || input.is_tokens()) {
+      bos = num_bos;
+      eos = num_eos;
+    } else if (num_bos > 0) {
+      // Non-text first input: prepend BOS via a token input
+      auto it = metadata_.find(kBosId);
+      if (it != metadata_.end()) {
+        std::vector<uint64_t> bos_tokens(
+            num_bos, static_cast<uint64_t>(it->second));
+        MultimodalInput bos_input(std::move(bos_tokens));
+        auto bos_result = multimodal_prefiller_->prefill(bos_input, pos_);
+        if (!bos_result.ok()) {
+          return bos_result.error();
         }
       }
     }
-    auto prefill_result = multimodal_prefiller_->prefill(input, pos_, bos, eos);
-    if (!prefill_result.ok()) {
-      return prefill_result.error();
-    }
-    last_token = prefill_result.get();
   }
+  auto prefill_result = multimodal_prefiller_->prefill(inputs, pos_, bos, eos);
+  if (!prefill_result.ok()) {
+    return prefill_result.error();
+  }
+  const uint64_t last_token = prefill_result.get();
   prefill_next_token_ = last_token;
   return last_token;
 }
@@ -263,22 +259,34 @@ Error MultimodalRunner::generate(
   // Reset internal state and start inference
   stats_->inference_start_ms = time_in_ms();
 
+  int32_t bos = 0;
+  int32_t eos = 0;
+  if (pos_ == 0 && (inputs[0].is_text() || inputs[0].is_tokens())) {
+    bos = config.num_bos;
+    eos = config.num_eos;
+  }
+  // Process multimodal inputs in order. A text last input is echoed right
+  // before it is prefilled, after the inputs in front of it.
+  const bool echo_last = config.echo && inputs.back().is_text();
   uint64_t prefill_next_token = 0;
-  // Process multimodal inputs in order
-  for (size_t i = 0; i < inputs.size(); ++i) {
-    const MultimodalInput& input = inputs[i];
-    if (config.echo && i == inputs.size() - 1 && input.is_text()) {
-      wrapped_callback(input.get_text());
-    }
-    int32_t bos = 0;
-    int32_t eos = 0;
-    if (i == 0 && pos_ == 0) {
-      if (input.is_text() || input.is_tokens()) {
-        bos = config.num_bos;
-        eos = config.num_eos;
-      }
+  if (!echo_last || inputs.size() > 1) {
+    auto prefill_result = multimodal_prefiller_->prefill(
+        ::executorch::runtime::Span<const MultimodalInput>(
+            inputs.data(), inputs.size() - (echo_last ? 1 : 0)),
+        pos_,
+        bos,
+        eos);
+    if (!prefill_result.ok()) {
+      return prefill_result.error();
     }
-    auto prefill_result = multimodal_prefiller_->prefill(input, pos_, bos, eos);
+    prefill_next_token = prefill_result.get();
+    bos = 0;
+    eos = 0;
+  }
+  if (echo_last) {
+    wrapped_callback(inputs.back().get_text());
+    auto prefill_result =
+        multimodal_prefiller_->prefill(inputs.back(), pos_, bos, eos);
     if (!prefill_result.ok()) {
       return prefill_result.error();
     }
@@ -19,6 +19,7 @@
 #include <string>
 #include <unordered_map>
 
+#include <executorch/extension/llm/runner/encoder_cache.h>
 #include <executorch/extension/llm/runner/image.h>
 #include <executorch/extension/llm/runner/image_prefiller.h>
 #include <executorch/extension/llm/runner/io_manager/io_manager.h>
@@ -166,6 +167,15 @@ class ET_EXPERIMENTAL MultimodalRunner : public IRunner {
     return prefill(inputs, num_bos, num_eos);
   }
 
+  /**
+   * Reuse the encoder outputs of images and audio clips that were already
+   * prefilled, by this or another runner sharing the cache, instead of
+   * running their encoders again. Pass nullptr to stop caching.
+   */
+  void set_encoder_cache(std::shared_ptr<EncoderCache> encoder_cache) {
+    multimodal_prefiller_->set_encoder_cache(std::move(encoder_cache));
+  }
+
   void stop() override {
     text_token_generator_->stop();
   }
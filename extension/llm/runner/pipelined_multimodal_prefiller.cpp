@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/llm/runner/pipelined_multimodal_prefiller.h>
+
+#include <algorithm>
+
+#include <executorch/extension/llm/runner/constants.h>
+#include <executorch/extension/llm/runner/util.h>
+
+namespace executorch::extension::llm {
+
+using ::executorch::runtime::EValue;
+
+namespace {
+
+bool is_encoder_input(const MultimodalInput& input) {
+  return input.is_image() || input.is_audio();
+}
+
+const char* const kEncoderMethods[] = {
+    kVisionEncoderMethod,
+    kAudioEncoderMethod,
+};
+
+} // namespace
+
+PipelinedMultimodalPrefiller::PipelinedMultimodalPrefiller(
+    Module* module,
+    MultimodalDecoderRunner* decoder_runner,
+    Tokenizer* tokenizer,
+    IOManager* io_manager,
+    std::vector<std::unique_ptr<Module>> encoder_modules,
+    Stats* stats)
+    : MultimodalPrefiller(module, decoder_runner, tokenizer, io_manager, stats),
+      encoder_modules_(std::move(encoder_modules)) {}
+
+PipelinedMultimodalPrefiller::~PipelinedMultimodalPrefiller() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void PipelinedMultimodalPrefiller::run_worker(size_t worker) {
+  Module* module = encoder_modules_[worker].get();
+  uint64_t round = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [&]() { return stopped_ || round_ != round; });
+    if (stopped_) {
+      return;
+    }
+    round = round_;
+    // Worker w encodes jobs w, w + num_workers_, ...
+    for (size_t k = worker; k < jobs_.size(); k += num_workers_) {
+      // The previous output of this Module lives in its planned memory,
+      // which the next run overwrites.
+      cv_.wait(lock, [&]() {
+        return cancelled_ || k < num_workers_ ||
+            num_consumed_ > k - num_workers_;
+      });
+      if (cancelled_) {
+        break;
+      }
+      const MultimodalInput& input = *jobs_[k].input;
+      lock.unlock();
+      const long start_ms = time_in_ms();
+      TensorPtr cached_output;
+      auto encode_result = encode_cached(module, input, 0, 0, cached_output);
+      const long end_ms = time_in_ms();
+      lock.lock();
+      EncoderJob& job = jobs_[k];
+      job.done = true;
+      job.cached_output = std::move(cached_output);
+      job.encoder_time_ms = end_ms - start_ms;
+      if (encode_result.ok()) {
+        job.output = std::move(encode_result.get());
+      } else {
+        job.error = encode_result.error();
+      }
+      cv_.notify_all();
+      if (!encode_result.ok()) {
+        break;
+      }
+    }
+    ++num_idle_workers_;
+    cv_.notify_all();
+  }
+}
+
+Result<uint64_t> PipelinedMultimodalPrefiller::prefill(
+    ::executorch::runtime::Span<const MultimodalInput> inputs,
+    int64_t& start_pos,
+    int32_t bos,
+    int32_t eos) {
+  size_t num_jobs = 0;
+  for (const auto& input : inputs) {
+    num_jobs += is_encoder_input(input) ? 1 : 0;
+  }
+  const size_t num_workers = std::min(encoder_modules_.size(), num_jobs);
+  if (num_workers == 0) {
+    return MultimodalPrefiller::prefill(inputs, start_pos, bos, eos);
+  }
+
+  while (workers_.size() < encoder_modules_.size()) {
+    const size_t worker = workers_.size();
+    workers_.emplace_back([this, worker]() { run_worker(worker); });
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.clear();
+    for (const auto& input : inputs) {
+      if (is_encoder_input(input)) {
+        jobs_.emplace_back();
+        jobs_.back().input = &input;
+      }
+    }
+    num_workers_ = num_workers;
+    num_consumed_ = 0;
+    cancelled_ = false;
+    num_idle_workers_ = 0;
+    ++round_;
+  }
+  cv_.notify_all();
+
+  // Prefill on this thread, in the order of the inputs.
+  uint64_t last_token = 0;
+  Error error = Error::Ok;
+  size_t next_job = 0;
+  for (size_t i = 0; i < inputs.size() && error == Error::Ok; ++i) {
+    const MultimodalInput& input = inputs[i];
+    if (!is_encoder_input(input)) {
+      auto prefill_result = MultimodalPrefiller::prefill(
+          input, start_pos, i == 0 ? bos : 0, i == 0 ? eos : 0);
+      if (prefill_result.ok()) {
+        last_token = prefill_result.get();
+      } else {
+        error = prefill_result.error();
+      }
+      continue;
+    }
+
+    EncoderJob& job = jobs_[next_job];
+    const long wait_start_ms = time_in_ms();
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&]() { return job.done; });
+    }
+    const long prefill_start_ms = time_in_ms();
+    error = job.error;
+    if (error == Error::Ok) {
+      auto prefill_result = prefill_embeddings(job.output, start_pos);
+      if (prefill_result.ok()) {
+        last_token = prefill_result.get();
+      } else {
+        error = prefill_result.error();
+      }
+    }
+    if (stats_ != nullptr) {
+      stats_->aggregate_encoder_wait_time_ms +=
+          prefill_start_ms - wait_start_ms;
+      stats_->aggregate_encoder_time_ms += job.encoder_time_ms;
+      if (job.cached_output) {
+        ++stats_->encoder_cache_hits;
+      } else if (encoder_cache_ != nullptr) {
+        ++stats_->encoder_cache_misses;
+      }
+      stats_->aggregate_decoder_prefill_time_ms +=
+          time_in_ms() - prefill_start_ms;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      job.output = EValue();
+      job.cached_output = nullptr;
+      num_consumed_ = ++next_job;
+    }
+    cv_.notify_all();
+  }
+
+  {
+    // Wait for the workers to finish with the jobs, which refer to `inputs`.
+    std::unique_lock<std::mutex> lock(mutex_);
+    cancelled_ = true;
+    cv_.notify_all();
+    cv_.wait(lock, [&]() { return num_idle_workers_ == workers_.size(); });
+    jobs_.clear();
+  }
+  if (error != Error::Ok) {
+    return error;
+  }
+  return last_token;
+}
+
+::executorch::runtime::Error PipelinedMultimodalPrefiller::load() {
+  ET_CHECK_OK_OR_RETURN_ERROR(MultimodalPrefiller::load());
+
+  auto method_names_result = module_->method_names();
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      method_names_result.error(), "Failed to get method names");
+  const std::unordered_set<std::string> methods = method_names_result.get();
+  for (auto& encoder_module : encoder_modules_) {
+    for (const char* method_name : kEncoderMethods) {
+      if (methods.find(method_name) != methods.end()) {
+        ET_CHECK_OK_OR_RETURN_ERROR(encoder_module->load_method(method_name));
+      }
+    }
+  }
+  return ::executorch::runtime::Error::Ok;
+}
+
+bool PipelinedMultimodalPrefiller::is_method_loaded() {
+  if (!MultimodalPrefiller::is_method_loaded()) {
+    return false;
+  }
+  auto method_names_result = module_->method_names();
+  if (!method_names_result.ok()) {
+    return false;
+  }
+  const std::unordered_set<std::string> methods = method_names_result.get();
+  for (auto& encoder_module : encoder_modules_) {
+    for (const char* method_name : kEncoderMethods) {
+      if (methods.find(method_name) != methods.end() &&
+          !encoder_module->is_method_loaded(method_name)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace executorch::extension::llm
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Multimodal prefiller that runs the encoders of the image and audio inputs
+// of a prompt on their own threads, overlapped with each other and with the
+// text decoder prefill.
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <executorch/extension/llm/runner/multimodal_prefiller.h>
+
+namespace executorch::extension::llm {
+
+/**
+ * A MultimodalPrefiller that prefills a sequence of inputs as a pipeline.
+ *
+ * Every encoder Module runs the image and audio encoders of a share of the
+ * inputs, in order, on a thread of its own, while the text decoder prefills
+ * the KV cache on the calling thread, one input after the other as before.
+ * Prefilling several images or long audio then takes about as long as its
+ * slowest stage instead of the sum of all of them, given enough cores.
+ *
+ * The encoder Modules must load the same program as `module` and each have
+ * their own Method instances, so that they can run at the same time as each
+ * other and as `module`. An encoder Module does not encode its next input
+ * until the text decoder has consumed the output of its previous one, which
+ * bounds the memory to one output per encoder Module. Every encoder Module
+ * has a thread of its own, started by the first prefill and kept for the
+ * next ones until the prefiller is destroyed.
+ */
+class ET_EXPERIMENTAL PipelinedMultimodalPrefiller
+    : public MultimodalPrefiller {
+ public:
+  explicit PipelinedMultimodalPrefiller(
+      Module* module,
+      MultimodalDecoderRunner* decoder_runner,
+      Tokenizer* tokenizer,
+      IOManager* io_manager,
+      std::vector<std::unique_ptr<Module>> encoder_modules,
+      Stats* stats = nullptr);
+
+  ~PipelinedMultimodalPrefiller() override;
+
+  using MultimodalPrefiller::prefill;
+
+  /**
+   * Prefill an LLM Module with the given multimodal inputs, in order, with
+   * the encoders of the image and audio inputs running ahead of the text
+   * decoder on the encoder Modules. Falls back to prefilling one input at a
+   * time if there are no encoder Modules or no image and audio inputs.
+   */
+  Result<uint64_t> prefill(
+      ::executorch::runtime::Span<const MultimodalInput> inputs,
+      int64_t& start_pos,
+      int32_t bos = 0,
+      int32_t eos = 0) override;
+
+  Error load() override;
+  bool is_method_loaded() override;
+
+ private:
+  // An image or audio input and, once its encoder has run, its embeddings.
+  struct EncoderJob {
+    const MultimodalInput* input = nullptr;
+    bool done = false;
+    Error error = Error::Ok;
+    ::executorch::runtime::EValue output;
+    // Keeps output alive if it came from the encoder cache.
+    TensorPtr cached_output;
+    long encoder_time_ms = 0;
+  };
+
+  // Encodes the share of the jobs of every prefill that belongs to
+  // encoder_modules_[worker], until the prefiller is destroyed.
+  void run_worker(size_t worker);
+
+  std::vector<std::unique_ptr<Module>> encoder_modules_;
+  std::vector<std::thread> workers_;
+
+  // State shared with the workers, guarded by mutex_.
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopped_ = false;
+  // Incremented by every prefill that runs the workers.
+  uint64_t round_ = 0;
+  // The jobs of the current prefill, and the number of workers encoding them.
+  std::vector<EncoderJob> jobs_;
+  size_t num_workers_ = 0;
+  // Number of jobs whose output the text decoder is done with.
+  size_t num_consumed_ = 0;
+  bool cancelled_ = false;
+  // Number of workers that are done with the current prefill.
+  size_t num_idle_workers_ = 0;
+};
+
+} // namespace executorch::extension::llm
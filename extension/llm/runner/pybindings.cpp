@@ -325,6 +325,16 @@ PYBIND11_MODULE(_llm_runner, m) {
       .def_readonly("inference_end_ms", &Stats::inference_end_ms)
       .def_readonly(
           "aggregate_sampling_time_ms", &Stats::aggregate_sampling_time_ms)
+      .def_readonly(
+          "aggregate_encoder_time_ms", &Stats::aggregate_encoder_time_ms)
+      .def_readonly(
+          "aggregate_decoder_prefill_time_ms",
+          &Stats::aggregate_decoder_prefill_time_ms)
+      .def_readonly(
+          "aggregate_encoder_wait_time_ms",
+          &Stats::aggregate_encoder_wait_time_ms)
+      .def_readonly("encoder_cache_hits", &Stats::encoder_cache_hits)
+      .def_readonly("encoder_cache_misses", &Stats::encoder_cache_misses)
       .def_readonly("num_prompt_tokens", &Stats::num_prompt_tokens)
       .def_readonly("num_generated_tokens", &Stats::num_generated_tokens)
       .def("on_sampling_begin", &Stats::on_sampling_begin)
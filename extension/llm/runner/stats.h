@@ -45,6 +45,20 @@ struct ET_EXPERIMENTAL Stats {
   long inference_end_ms;
   // Keep a running total of the time spent in sampling.
   long aggregate_sampling_time_ms = 0;
+  // Running totals of the time spent in the encoders of the image and audio
+  // inputs of the prompt, and in the text decoder (including token
+  // embeddings) during prefill. Encoders of several inputs may run at the
+  // same time as each other and as the text decoder, so their total can
+  // exceed the prompt evaluation time.
+  long aggregate_encoder_time_ms = 0;
+  long aggregate_decoder_prefill_time_ms = 0;
+  // Running total of the time the text decoder spent waiting for the output
+  // of an encoder during prefill.
+  long aggregate_encoder_wait_time_ms = 0;
+  // Image and audio inputs whose encoder output was, or was not, reused from
+  // the encoder cache.
+  int64_t encoder_cache_hits = 0;
+  int64_t encoder_cache_misses = 0;
   // Token count from prompt
   int64_t num_prompt_tokens;
   // Token count from generated (total - prompt)
@@ -81,6 +95,11 @@ struct ET_EXPERIMENTAL Stats {
     first_token_ms = 0;
     inference_end_ms = 0;
     aggregate_sampling_time_ms = 0;
+    aggregate_encoder_time_ms = 0;
+    aggregate_decoder_prefill_time_ms = 0;
+    aggregate_encoder_wait_time_ms = 0;
+    encoder_cache_hits = 0;
+    encoder_cache_misses = 0;
     num_prompt_tokens = 0;
     num_generated_tokens = 0;
     gpu_total_bytes = static_cast<uint64_t>(-1);
@@ -107,6 +126,19 @@ inline std::string stats_to_json_string(const Stats& stats) {
      << "\"first_token_ms\":" << stats.first_token_ms << ","
      << "\"aggregate_sampling_time_ms\":" << stats.aggregate_sampling_time_ms
      << ",";
+  // Only include the prefill stages if the prompt had image or audio inputs.
+  if (stats.aggregate_encoder_time_ms > 0) {
+    ss << "\"aggregate_encoder_time_ms\":" << stats.aggregate_encoder_time_ms
+       << ",\"aggregate_decoder_prefill_time_ms\":"
+       << stats.aggregate_decoder_prefill_time_ms
+       << ",\"aggregate_encoder_wait_time_ms\":"
+       << stats.aggregate_encoder_wait_time_ms << ",";
+  }
+  // Only include the encoder cache stats if there is an encoder cache.
+  if (stats.encoder_cache_hits + stats.encoder_cache_misses > 0) {
+    ss << "\"encoder_cache_hits\":" << stats.encoder_cache_hits
+       << ",\"encoder_cache_misses\":" << stats.encoder_cache_misses << ",";
+  }
   // Only include GPU fields in the JSON if gpu_total_bytes is valid (not
   // equal to sentinel -1)
   if (stats.gpu_total_bytes != static_cast<uint64_t>(-1)) {
@@ -192,6 +224,34 @@ inline void print_report(const Stats& stats) {
       (double)stats.aggregate_sampling_time_ms /
           stats.SCALING_FACTOR_UNITS_PER_SECOND);
 
+  if (stats.aggregate_encoder_time_ms > 0) {
+    ET_LOG(
+        Info,
+        "\t\tPrefill encoders:\t%f (seconds)",
+        (double)stats.aggregate_encoder_time_ms /
+            stats.SCALING_FACTOR_UNITS_PER_SECOND);
+    ET_LOG(
+        Info,
+        "\t\tPrefill decoder:\t%f (seconds)",
+        (double)stats.aggregate_decoder_prefill_time_ms /
+            stats.SCALING_FACTOR_UNITS_PER_SECOND);
+    ET_LOG(
+        Info,
+        "\t\tWaiting for encoders:\t%f (seconds)",
+        (double)stats.aggregate_encoder_wait_time_ms /
+            stats.SCALING_FACTOR_UNITS_PER_SECOND);
+  }
+  const int64_t encoder_cache_lookups =
+      stats.encoder_cache_hits + stats.encoder_cache_misses;
+  if (encoder_cache_lookups > 0) {
+    ET_LOG(
+        Info,
+        "\t\tEncoder cache hits:\t%" PRId64 " of %" PRId64 " (%.1f%%)",
+        stats.encoder_cache_hits,
+        encoder_cache_lookups,
+        100.0 * stats.encoder_cache_hits / encoder_cache_lookups);
+  }
+
   // GPU memory reporting (only meaningful if GPU fields were populated)
   if (stats.gpu_total_bytes != static_cast<uint64_t>(-1)) {
     ET_LOG(
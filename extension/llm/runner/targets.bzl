@@ -90,32 +90,48 @@ def define_common_targets():
             name = "multimodal_runner_lib" + aten_suffix,
             exported_headers = [
                 "audio.h",
+                "encoder_cache.h",
                 "image.h",
+                "image_preprocessor.h",
+                "log_mel_spectrogram.h",
                 "wav_loader.h",
                 "multimodal_input.h",
                 "multimodal_runner.h",
                 "multimodal_prefiller.h",
                 "multimodal_decoder_runner.h",
+                "pipelined_multimodal_prefiller.h",
             ],
             srcs = [
+                "encoder_cache.cpp",
+                "image_preprocessor.cpp",
+                "log_mel_spectrogram.cpp",
                 "multimodal_prefiller.cpp",
+                "pipelined_multimodal_prefiller.cpp",
             ],
             exported_deps = [
                 ":text_decoder_runner" + aten_suffix,
                 ":text_prefiller" + aten_suffix,
                 ":image_prefiller" + aten_suffix,
                 ":text_token_generator" + aten_suffix,
+                "//executorch/extension/threadpool:threadpool",
+                "//executorch/kernels/optimized/cpu:fft_utils",
+                "//executorch/kernels/portable/cpu/util:vectorized_math",
+            ],
+            deps = [
+                "//executorch/runtime/core/portable_type/c10/c10:c10",
             ],
         )
 
         runtime.cxx_library(
             name = "runner_lib" + aten_suffix,
             exported_headers = [
+                "chunked_prefill_scheduler.h",
                 "text_llm_runner.h",
                 "llm_runner_helper.h",
                 "constants.h",
             ],
             srcs = [
+                "chunked_prefill_scheduler.cpp",
                 "text_llm_runner.cpp",
                 "llm_runner_helper.cpp",
                 "multimodal_runner.cpp",
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ * @lint-ignore-every CLANGTIDY facebook-hte-Deprecated
+ */
+
+// Measures the inter-token latency of decoding chats while long prompts
+// arrive, with ChunkedPrefillScheduler. The model is simulated: a step costs
+// 400 us plus 4 us per token. The first argument is the token budget, 0 for
+// prefilling each prompt at once as TextLLMRunner does, and the second the
+// target_inter_token_latency_ms in microseconds, 0 for none. The "p50_ms" and
+// "p99_ms" counters are the percentiles of the time between two tokens of a
+// chat.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <executorch/extension/llm/runner/chunked_prefill_scheduler.h>
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using executorch::extension::TensorPtr;
+using executorch::extension::llm::ChunkedPrefillConfig;
+using executorch::extension::llm::ChunkedPrefillScheduler;
+using executorch::extension::llm::ScheduledSequence;
+using executorch::extension::llm::TextDecoderRunner;
+using executorch::extension::llm::TextPrefiller;
+using executorch::runtime::Error;
+using executorch::runtime::Result;
+
+namespace {
+
+constexpr int kVocabSize = 32;
+constexpr int kNumChats = 4;
+constexpr int kChatPromptTokens = 16;
+constexpr int kChatNewTokens = 96;
+constexpr int kDocumentPromptTokens = 2048;
+// The chat decode iterations after which each document arrives.
+constexpr int kDocumentArrivals[] = {8, 40};
+
+class SimulatedTextDecoderRunner : public TextDecoderRunner {
+ public:
+  SimulatedTextDecoderRunner()
+      : TextDecoderRunner(nullptr, nullptr),
+        logits_(executorch::extension::make_tensor_ptr(
+            {1, kVocabSize},
+            std::vector<float>(kVocabSize))) {}
+
+  Result<executorch::aten::Tensor> step(TensorPtr& input, int64_t start_pos)
+      override {
+    std::this_thread::sleep_for(
+        std::chrono::microseconds(400 + 4 * input->numel()));
+    float* logits = logits_->mutable_data_ptr<float>();
+    std::fill(logits, logits + kVocabSize, 0.0f);
+    logits[(start_pos + input->numel()) % (kVocabSize - 1) + 1] = 1.0f;
+    return *logits_;
+  }
+
+  bool is_method_loaded() override {
+    return true;
+  }
+
+  Error load() override {
+    return Error::Ok;
+  }
+
+ private:
+  TensorPtr logits_;
+};
+
+struct SimulatedSequence {
+  SimulatedSequence()
+      : prefiller(
+            &runner,
+            true,
+            /*enable_parallel_prefill=*/true,
+            kDocumentPromptTokens) {}
+
+  SimulatedTextDecoderRunner runner;
+  TextPrefiller prefiller;
+};
+
+void BM_ChunkedPrefill(benchmark::State& state) {
+  executorch::runtime::runtime_init();
+  ChunkedPrefillConfig config;
+  config.token_budget = state.range(0) > 0 ? state.range(0) : (1 << 20);
+  config.max_chunk_tokens = config.token_budget;
+  config.min_prefill_tokens = 16;
+  config.target_inter_token_latency_ms = state.range(1) / 1000.0;
+
+  std::vector<std::unique_ptr<SimulatedSequence>> sequences;
+  for (size_t i = 0; i < kNumChats + std::size(kDocumentArrivals); ++i) {
+    sequences.push_back(std::make_unique<SimulatedSequence>());
+  }
+  auto make = [&](size_t i, size_t prompt_tokens, int32_t max_new_tokens) {
+    ScheduledSequence sequence;
+    sequence.text_decoder_runner = &sequences[i]->runner;
+    sequence.text_prefiller = &sequences[i]->prefiller;
+    sequence.prompt_tokens.assign(prompt_tokens, 1);
+    sequence.max_new_tokens = max_new_tokens;
+    return sequence;
+  };
+
+  std::vector<double> gaps_ms;
+  for (auto _ : state) {
+    ChunkedPrefillScheduler scheduler(config);
+    std::vector<std::chrono::steady_clock::time_point> last_token(kNumChats);
+    for (size_t i = 0; i < kNumChats; ++i) {
+      auto chat = make(i, kChatPromptTokens, kChatNewTokens);
+      chat.token_callback = [&, i](uint64_t) {
+        const auto now = std::chrono::steady_clock::now();
+        if (last_token[i].time_since_epoch().count() != 0) {
+          gaps_ms.push_back(
+              std::chrono::duration<double, std::milli>(now - last_token[i])
+                  .count());
+        }
+        last_token[i] = now;
+      };
+      scheduler.submit(std::move(chat));
+    }
+    size_t next_document = 0;
+    while (scheduler.num_active() > 0) {
+      if (next_document < std::size(kDocumentArrivals) &&
+          scheduler.counters().decode_steps >=
+              kNumChats * kDocumentArrivals[next_document]) {
+        scheduler.submit(
+            make(kNumChats + next_document, kDocumentPromptTokens, 16));
+        ++next_document;
+      }
+      scheduler.step();
+    }
+  }
+
+  std::sort(gaps_ms.begin(), gaps_ms.end());
+  if (!gaps_ms.empty()) {
+    state.counters["p50_ms"] = gaps_ms[gaps_ms.size() / 2];
+    state.counters["p99_ms"] = gaps_ms[gaps_ms.size() * 99 / 100];
+  }
+}
+
+BENCHMARK(BM_ChunkedPrefill)
+    ->ArgNames({"budget", "target_us"})
+    ->Args({0, 0})
+    ->Args({512, 0})
+    ->Args({128, 0})
+    ->Args({512, 4000})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
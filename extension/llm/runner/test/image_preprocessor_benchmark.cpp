@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ * @lint-ignore-every CLANGTIDY facebook-hte-Deprecated
+ */
+
+// Measures the throughput of ImagePreprocessor on 1920x1080 RGB frames
+// turned into the 336x336 inputs of a CLIP image encoder: shortest edge
+// resized to 336, center crop and normalization to Float, with the bilinear
+// and the bicubic filter, for batches of 1 and 4 frames.
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <executorch/extension/llm/runner/image_preprocessor.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using executorch::extension::llm::ImageBuffer;
+using executorch::extension::llm::ImagePreprocessor;
+using executorch::extension::llm::ImagePreprocessorConfig;
+using executorch::extension::llm::ResizeFilter;
+
+namespace {
+
+constexpr int32_t kWidth = 1920;
+constexpr int32_t kHeight = 1080;
+
+void BM_PreprocessClip(benchmark::State& state) {
+  executorch::runtime::runtime_init();
+  const auto filter = static_cast<ResizeFilter>(state.range(0));
+  const int64_t batch_size = state.range(1);
+
+  std::vector<uint8_t> pixels(kWidth * kHeight * 3);
+  for (size_t i = 0; i < pixels.size(); ++i) {
+    pixels[i] = static_cast<uint8_t>(i * 7 % 251);
+  }
+  const std::vector<ImageBuffer> images(
+      batch_size, ImageBuffer{pixels.data(), kWidth, kHeight});
+
+  ImagePreprocessorConfig config;
+  config.shortest_edge = 336;
+  config.crop_width = 336;
+  config.crop_height = 336;
+  config.filter = filter;
+  config.mean = {0.48145466f, 0.4578275f, 0.40821073f};
+  config.std = {0.26862954f, 0.26130258f, 0.27577711f};
+  ImagePreprocessor preprocessor(config);
+
+  for (auto _ : state) {
+    auto output = preprocessor.preprocess(images);
+    benchmark::DoNotOptimize(output.ok());
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+  state.SetBytesProcessed(state.iterations() * batch_size * pixels.size());
+}
+
+BENCHMARK(BM_PreprocessClip)
+    ->ArgNames({"bicubic", "batch"})
+    ->Args({static_cast<int64_t>(ResizeFilter::Bilinear), 1})
+    ->Args({static_cast<int64_t>(ResizeFilter::Bicubic), 1})
+    ->Args({static_cast<int64_t>(ResizeFilter::Bicubic), 4})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ * @lint-ignore-every CLANGTIDY facebook-hte-Deprecated
+ */
+
+// Measures LogMelSpectrogram on 30 s of 16 kHz audio with Whisper's
+// settings, computed at once into an encoder input and streamed in chunks of
+// the given number of milliseconds. The "RTF" counter is the real-time
+// factor: seconds of compute per second of audio.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <executorch/extension/llm/runner/log_mel_spectrogram.h>
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using executorch::extension::TensorPtr;
+using executorch::extension::llm::LogMelConfig;
+using executorch::extension::llm::LogMelSpectrogram;
+using executorch::extension::llm::LogMelStream;
+
+namespace {
+
+constexpr int32_t kSampleRate = 16000;
+constexpr size_t kNumSamples = 30 * kSampleRate;
+
+std::vector<float> make_audio() {
+  std::vector<float> audio(kNumSamples);
+  for (size_t i = 0; i < audio.size(); ++i) {
+    audio[i] = 0.5f * std::sin(i * 0.05f) + 0.1f * std::sin(i * 1.7f);
+  }
+  return audio;
+}
+
+void set_real_time_factor(benchmark::State& state) {
+  state.counters["RTF"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * kNumSamples / kSampleRate,
+      benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+void BM_LogMelWhole(benchmark::State& state) {
+  executorch::runtime::runtime_init();
+  const auto audio = make_audio();
+  LogMelConfig config;
+  config.pad_to_multiple = kNumSamples;
+  auto spectrogram = LogMelSpectrogram::create(config);
+  auto encoder_input = executorch::extension::empty(
+      {1, config.n_mels, static_cast<int32_t>(
+                             spectrogram->num_frames(audio.size()))});
+
+  for (auto _ : state) {
+    auto error =
+        spectrogram->compute_into(audio.data(), audio.size(), *encoder_input);
+    benchmark::DoNotOptimize(error);
+  }
+  set_real_time_factor(state);
+}
+
+void BM_LogMelStream(benchmark::State& state) {
+  executorch::runtime::runtime_init();
+  const auto audio = make_audio();
+  const size_t chunk = state.range(0) * kSampleRate / 1000;
+  auto spectrogram = LogMelSpectrogram::create();
+  LogMelStream stream(*spectrogram);
+  TensorPtr out = executorch::extension::empty(
+      {1, spectrogram->config().n_mels,
+       static_cast<int32_t>(chunk / spectrogram->config().hop_length + 4)});
+
+  for (auto _ : state) {
+    for (size_t offset = 0; offset < audio.size(); offset += chunk) {
+      auto frames = stream.accept(
+          audio.data() + offset, std::min(chunk, audio.size() - offset), out);
+      benchmark::DoNotOptimize(frames.ok());
+    }
+    auto frames = stream.finish(out);
+    benchmark::DoNotOptimize(frames.ok());
+  }
+  set_real_time_factor(state);
+}
+
+BENCHMARK(BM_LogMelWhole)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_LogMelStream)
+    ->ArgName("chunk_ms")
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
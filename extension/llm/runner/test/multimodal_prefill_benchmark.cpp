@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ * @lint-ignore-every CLANGTIDY facebook-hte-Deprecated
+ */
+
+// Measures the prefill of a multi-image request, a text prompt around four
+// images, with the encoders run in turn on the decoder Module against the
+// encoders run ahead of the decoder on 1, 2 and 4 encoder Modules, and that
+// of a multi-turn conversation that sends the same image every turn, with
+// and without an encoder cache. The stages are simulated by sleeping, as if
+// each encoder ran on a core of its own, so that the numbers show the
+// schedule rather than the model: the image encoder takes 30 ms and the
+// decoder prefill 10 ms per input. The images and their embeddings have
+// realistic sizes, so the cost of hashing and copying them is real.
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <executorch/extension/llm/runner/pipelined_multimodal_prefiller.h>
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using executorch::extension::make_tensor_ptr;
+using executorch::extension::Module;
+using executorch::extension::TensorPtr;
+using executorch::extension::llm::EncoderCache;
+using executorch::extension::llm::Image;
+using executorch::extension::llm::MultimodalInput;
+using executorch::extension::llm::PipelinedMultimodalPrefiller;
+using executorch::extension::llm::Stats;
+using executorch::runtime::EValue;
+using executorch::runtime::Result;
+
+namespace {
+
+constexpr auto kEncoderTime = std::chrono::milliseconds(30);
+constexpr auto kDecoderPrefillTime = std::chrono::milliseconds(10);
+constexpr int kNumImages = 4;
+constexpr int kNumTurns = 8;
+constexpr int32_t kImageSize = 336;
+// 576 image tokens of 1024 floats.
+constexpr int32_t kNumImageTokens = 576;
+constexpr int32_t kEmbeddingDim = 1024;
+
+MultimodalInput make_image() {
+  return MultimodalInput(Image(
+      std::vector<uint8_t>(3 * kImageSize * kImageSize, 128),
+      kImageSize,
+      kImageSize,
+      3));
+}
+
+class SimulatedPrefiller : public PipelinedMultimodalPrefiller {
+ public:
+  SimulatedPrefiller(
+      Module* module,
+      std::vector<std::unique_ptr<Module>> encoder_modules,
+      Stats* stats)
+      : PipelinedMultimodalPrefiller(
+            module,
+            nullptr,
+            nullptr,
+            nullptr,
+            std::move(encoder_modules),
+            stats),
+        image_embeddings_(make_tensor_ptr(
+            {1, kNumImageTokens, kEmbeddingDim},
+            std::vector<float>(kNumImageTokens * kEmbeddingDim))) {}
+
+ protected:
+  Result<EValue> encode(
+      Module* module,
+      const MultimodalInput& input,
+      int32_t bos,
+      int32_t eos) override {
+    (void)module;
+    (void)bos;
+    (void)eos;
+    if (input.is_image()) {
+      std::this_thread::sleep_for(kEncoderTime);
+      return EValue(*image_embeddings_);
+    }
+    return EValue(static_cast<int64_t>(0));
+  }
+
+  Result<uint64_t> prefill_embeddings(
+      const EValue& encoder_output,
+      int64_t& start_pos) override {
+    (void)encoder_output;
+    std::this_thread::sleep_for(kDecoderPrefillTime);
+    ++start_pos;
+    return static_cast<uint64_t>(start_pos);
+  }
+
+ private:
+  TensorPtr image_embeddings_;
+};
+
+void BM_MultiImagePrefill(benchmark::State& state) {
+  executorch::runtime::runtime_init();
+  const int num_encoder_modules = static_cast<int>(state.range(0));
+
+  std::vector<MultimodalInput> inputs;
+  inputs.emplace_back(std::vector<uint64_t>{1, 2, 3});
+  for (int i = 0; i < kNumImages; ++i) {
+    inputs.push_back(make_image());
+  }
+  inputs.emplace_back(std::vector<uint64_t>{4, 5, 6});
+
+  // The simulated stages never run the Modules, so they are never loaded.
+  Module module("unused.pte");
+  std::vector<std::unique_ptr<Module>> encoder_modules;
+  for (int i = 0; i < num_encoder_modules; ++i) {
+    encoder_modules.push_back(std::make_unique<Module>("unused.pte"));
+  }
+  Stats stats;
+  SimulatedPrefiller prefiller(&module, std::move(encoder_modules), &stats);
+
+  for (auto _ : state) {
+    int64_t start_pos = 0;
+    auto result = prefiller.prefill(inputs, start_pos);
+    benchmark::DoNotOptimize(result.ok());
+  }
+  state.counters["encoder_wait_ms"] = benchmark::Counter(
+      stats.aggregate_encoder_wait_time_ms, benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * kNumImages);
+}
+
+BENCHMARK(BM_MultiImagePrefill)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Each turn of the conversation sends the same image again with a new
+// question, as chat templates that restate the whole context do.
+void BM_MultiTurnPrefill(benchmark::State& state) {
+  executorch::runtime::runtime_init();
+  const bool use_cache = state.range(0) != 0;
+
+  std::vector<MultimodalInput> inputs;
+  inputs.emplace_back(std::vector<uint64_t>{1, 2, 3});
+  inputs.push_back(make_image());
+  inputs.emplace_back(std::vector<uint64_t>{4, 5, 6});
+
+  Module module("unused.pte");
+  Stats stats;
+  SimulatedPrefiller prefiller(&module, {}, &stats);
+
+  for (auto _ : state) {
+    if (use_cache) {
+      prefiller.set_encoder_cache(
+          std::make_shared<EncoderCache>(64 * 1024 * 1024));
+    }
+    int64_t start_pos = 0;
+    for (int turn = 0; turn < kNumTurns; ++turn) {
+      auto result = prefiller.prefill(inputs, start_pos);
+      benchmark::DoNotOptimize(result.ok());
+    }
+  }
+  state.counters["encoder_cache_hits"] = benchmark::Counter(
+      stats.encoder_cache_hits, benchmark::Counter::kAvgIterations);
+  state.counters["turn_ms"] = benchmark::Counter(
+      state.iterations() * kNumTurns,
+      benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+BENCHMARK(BM_MultiTurnPrefill)
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
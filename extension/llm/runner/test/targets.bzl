@@ -36,6 +36,53 @@ def define_common_targets():
         ],
     )
 
+    runtime.cxx_test(
+        name = "test_chunked_prefill_scheduler",
+        srcs = ["test_chunked_prefill_scheduler.cpp"],
+        deps = [
+            "//executorch/extension/llm/runner:runner_lib",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "chunked_prefill_benchmark",
+        srcs = ["chunked_prefill_benchmark.cpp"],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/extension/llm/runner:runner_lib",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "test_encoder_cache",
+        srcs = ["test_encoder_cache.cpp"],
+        deps = [
+            "//executorch/extension/llm/runner:multimodal_runner_lib",
+            "//executorch/extension/testing_util:temp_file",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "test_image_preprocessor",
+        srcs = ["test_image_preprocessor.cpp"],
+        deps = [
+            "//executorch/extension/llm/runner:multimodal_runner_lib",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "test_log_mel_spectrogram",
+        srcs = ["test_log_mel_spectrogram.cpp"],
+        deps = [
+            "//executorch/extension/llm/runner:multimodal_runner_lib",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
     runtime.cxx_test(
         name = "test_multimodal_input",
         srcs = ["test_multimodal_input.cpp"],
@@ -44,6 +91,45 @@ def define_common_targets():
         ],
     )
 
+    runtime.cxx_test(
+        name = "test_pipelined_multimodal_prefiller",
+        srcs = ["test_pipelined_multimodal_prefiller.cpp"],
+        deps = [
+            "//executorch/extension/llm/runner:multimodal_runner_lib",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "multimodal_prefill_benchmark",
+        srcs = ["multimodal_prefill_benchmark.cpp"],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/extension/llm/runner:multimodal_runner_lib",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "image_preprocessor_benchmark",
+        srcs = ["image_preprocessor_benchmark.cpp"],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/extension/llm/runner:multimodal_runner_lib",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "log_mel_spectrogram_benchmark",
+        srcs = ["log_mel_spectrogram_benchmark.cpp"],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/extension/llm/runner:multimodal_runner_lib",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
     runtime.cxx_test(
         name = "test_util",
         srcs = ["test_util.cpp"],
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ * @lint-ignore-every CLANGTIDY facebook-hte-Deprecated
+ */
+
+#include <executorch/extension/llm/runner/chunked_prefill_scheduler.h>
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace ::testing;
+using executorch::extension::make_tensor_ptr;
+using executorch::extension::TensorPtr;
+using executorch::extension::llm::ChunkedPrefillConfig;
+using executorch::extension::llm::ChunkedPrefillScheduler;
+using executorch::extension::llm::ScheduledSequence;
+using executorch::extension::llm::TextDecoderRunner;
+using executorch::extension::llm::TextPrefiller;
+using executorch::runtime::Error;
+using executorch::runtime::Result;
+
+namespace {
+
+constexpr int kVocabSize = 16;
+
+struct Call {
+  int sequence;
+  int64_t num_tokens;
+  int64_t start_pos;
+};
+
+// Predicts the last input token plus one, and logs its steps.
+class FakeTextDecoderRunner : public TextDecoderRunner {
+ public:
+  FakeTextDecoderRunner(int sequence, std::vector<Call>* calls)
+      : TextDecoderRunner(nullptr, nullptr),
+        sequence_(sequence),
+        calls_(calls),
+        logits_(make_tensor_ptr({1, kVocabSize}, std::vector<float>(kVocabSize))) {}
+
+  Result<executorch::aten::Tensor> step(TensorPtr& input, int64_t start_pos)
+      override {
+    calls_->push_back({sequence_, input->numel(), start_pos});
+    if (fail_at_step_ == static_cast<int>(calls_->size()) - 1) {
+      return Error::Internal;
+    }
+    std::this_thread::sleep_for(
+        step_time_ + per_token_time_ * input->numel());
+    const int64_t last = input->const_data_ptr<int64_t>()[input->numel() - 1];
+    float* logits = logits_->mutable_data_ptr<float>();
+    std::fill(logits, logits + kVocabSize, 0.0f);
+    logits[(last + 1) % kVocabSize] = 1.0f;
+    return *logits_;
+  }
+
+  bool is_method_loaded() override {
+    return true;
+  }
+
+  Error load() override {
+    return Error::Ok;
+  }
+
+  // The logits of the last step, as the sampler left them.
+  const float* logits() const {
+    return logits_->const_data_ptr<float>();
+  }
+
+  int fail_at_step_ = -1;
+  std::chrono::microseconds step_time_{0};
+  std::chrono::microseconds per_token_time_{0};
+
+ private:
+  int sequence_;
+  std::vector<Call>* calls_;
+  TensorPtr logits_;
+};
+
+struct TestSequence {
+  TestSequence(int id, std::vector<Call>* calls, int64_t max_seq_len = 128)
+      : runner(id, calls),
+        prefiller(&runner, true, /*enable_parallel_prefill=*/true, max_seq_len) {}
+
+  ScheduledSequence make(std::vector<uint64_t> prompt, int32_t max_new_tokens) {
+    ScheduledSequence sequence;
+    sequence.text_decoder_runner = &runner;
+    sequence.text_prefiller = &prefiller;
+    sequence.prompt_tokens = std::move(prompt);
+    sequence.max_new_tokens = max_new_tokens;
+    sequence.token_callback = [this](uint64_t token) {
+      tokens.push_back(token);
+    };
+    sequence.done_callback = [this](Error error) {
+      done = true;
+      result = error;
+    };
+    return sequence;
+  }
+
+  FakeTextDecoderRunner runner;
+  TextPrefiller prefiller;
+  std::vector<uint64_t> tokens;
+  bool done = false;
+  Error result = Error::Ok;
+};
+
+class ChunkedPrefillSchedulerTest : public Test {
+ protected:
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+  }
+
+  std::vector<Call> calls_;
+};
+
+} // namespace
+
+TEST_F(ChunkedPrefillSchedulerTest, InterleavesDecodesWithPrefillChunks) {
+  ChunkedPrefillConfig config;
+  config.token_budget = 32;
+  config.max_chunk_tokens = 32;
+  config.min_prefill_tokens = 1;
+  ChunkedPrefillScheduler scheduler(config);
+
+  TestSequence chat(0, &calls_);
+  TestSequence document(1, &calls_, /*max_seq_len=*/20);
+  ASSERT_TRUE(scheduler.submit(chat.make({1, 2, 3, 4}, 10)).ok());
+  ASSERT_TRUE(
+      scheduler.submit(document.make(std::vector<uint64_t>(100, 7), 3)).ok());
+  EXPECT_EQ(scheduler.num_active(), 2);
+
+  // The whole chat prompt and a chunk of the document, which its prefiller
+  // caps at 20 tokens, then 8 more within the budget of 32.
+  EXPECT_EQ(scheduler.step(), 32);
+  ASSERT_EQ(calls_.size(), 3);
+  EXPECT_EQ(calls_[0].sequence, 0);
+  EXPECT_EQ(calls_[0].num_tokens, 4);
+  EXPECT_EQ(calls_[1].num_tokens, 20);
+  EXPECT_EQ(calls_[2].num_tokens, 8);
+  EXPECT_EQ(calls_[2].start_pos, 20);
+  EXPECT_EQ(chat.tokens, std::vector<uint64_t>{5});
+
+  // Then one decode step of the chat before each 31 tokens of the document.
+  EXPECT_EQ(scheduler.step(), 32);
+  EXPECT_EQ(calls_[3].sequence, 0);
+  EXPECT_EQ(calls_[3].num_tokens, 1);
+  EXPECT_EQ(calls_[3].start_pos, 4);
+  EXPECT_EQ(calls_[4].num_tokens, 20);
+  EXPECT_EQ(calls_[4].start_pos, 28);
+  EXPECT_EQ(calls_[5].num_tokens, 11);
+  EXPECT_EQ(chat.tokens, (std::vector<uint64_t>{5, 6}));
+
+  scheduler.run();
+  EXPECT_EQ(scheduler.num_active(), 0);
+  EXPECT_TRUE(chat.done);
+  EXPECT_TRUE(document.done);
+  EXPECT_EQ(chat.result, Error::Ok);
+  EXPECT_EQ(chat.tokens.size(), 10);
+  EXPECT_EQ(chat.tokens.back(), 14);
+  EXPECT_EQ(document.tokens, (std::vector<uint64_t>{8, 9, 10}));
+
+  // No prefill ran more than 31 tokens between two steps of the chat, and
+  // the document was prefilled in order.
+  int64_t prefilled_since_chat = 0;
+  int64_t document_pos = 0;
+  for (const auto& call : calls_) {
+    if (call.sequence == 0) {
+      prefilled_since_chat = 0;
+    } else {
+      prefilled_since_chat += call.num_tokens;
+      EXPECT_LE(prefilled_since_chat, 32);
+      EXPECT_EQ(call.start_pos, document_pos);
+      document_pos += call.num_tokens;
+    }
+  }
+  EXPECT_EQ(document_pos, 102);
+  EXPECT_EQ(scheduler.counters().prefill_tokens, 104);
+  EXPECT_EQ(scheduler.counters().decode_steps, 9 + 2);
+}
+
+TEST_F(ChunkedPrefillSchedulerTest, StopsAtEosAndIsolatesFailures) {
+  ChunkedPrefillScheduler scheduler;
+  TestSequence stops(0, &calls_);
+  TestSequence fails(1, &calls_);
+  auto sequence = stops.make({3}, 100);
+  sequence.eos_ids = {6};
+  ASSERT_TRUE(scheduler.submit(std::move(sequence)).ok());
+  ASSERT_TRUE(scheduler.submit(fails.make({1, 2}, 100)).ok());
+  // Both runners log to calls_: the prefills are calls 0 and 1, and call 3 is
+  // the first decode step of the second sequence.
+  fails.runner.fail_at_step_ = 3;
+
+  scheduler.run();
+  EXPECT_TRUE(stops.done);
+  EXPECT_EQ(stops.result, Error::Ok);
+  EXPECT_EQ(stops.tokens, (std::vector<uint64_t>{4, 5, 6}));
+  EXPECT_TRUE(fails.done);
+  EXPECT_EQ(fails.result, Error::Internal);
+  EXPECT_EQ(fails.tokens, std::vector<uint64_t>{3});
+
+  EXPECT_EQ(
+      scheduler.submit(ScheduledSequence{}).error(), Error::InvalidArgument);
+  EXPECT_EQ(
+      scheduler.submit(stops.make({}, 10)).error(), Error::InvalidArgument);
+}
+
+TEST_F(ChunkedPrefillSchedulerTest, SamplesFirstTokenAtTemperature) {
+  ChunkedPrefillScheduler scheduler;
+  TestSequence greedy(0, &calls_);
+  TestSequence sampled(1, &calls_);
+  // With one new token, the prefill samples the only token of each sequence.
+  ASSERT_TRUE(scheduler.submit(greedy.make({3}, 1)).ok());
+  auto sequence = sampled.make({3}, 1);
+  sequence.temperature = 2.0f;
+  ASSERT_TRUE(scheduler.submit(std::move(sequence)).ok());
+  scheduler.run();
+  ASSERT_EQ(calls_.size(), 2);
+
+  // Argmax leaves the logits as they are, while sampling at a temperature
+  // turns them into probabilities in place.
+  EXPECT_EQ(greedy.tokens, std::vector<uint64_t>{4});
+  EXPECT_EQ(greedy.runner.logits()[0], 0.0f);
+  ASSERT_EQ(sampled.tokens.size(), 1);
+  EXPECT_LT(sampled.tokens[0], kVocabSize);
+  const float* probabilities = sampled.runner.logits();
+  EXPECT_GT(probabilities[0], 0.0f);
+  EXPECT_NEAR(
+      std::accumulate(probabilities, probabilities + kVocabSize, 0.0f),
+      1.0f,
+      1e-5f);
+}
+
+TEST_F(ChunkedPrefillSchedulerTest, LatencyTargetShrinksPrefillChunks) {
+  ChunkedPrefillConfig config;
+  config.token_budget = 1024;
+  config.max_chunk_tokens = 1024;
+  config.min_prefill_tokens = 4;
+  config.target_inter_token_latency_ms = 10.0;
+  ChunkedPrefillScheduler scheduler(config);
+
+  TestSequence chat(0, &calls_, 1024);
+  TestSequence document(1, &calls_, 1024);
+  // Decode steps take about 2 ms and prefill tokens 0.1 ms, so 80 prefill
+  // tokens fit within the target next to a decode step.
+  for (auto* sequence : {&chat, &document}) {
+    sequence->runner.step_time_ = std::chrono::microseconds(2000);
+    sequence->runner.per_token_time_ = std::chrono::microseconds(100);
+  }
+  ASSERT_TRUE(scheduler.submit(chat.make({1}, 1000)).ok());
+  ASSERT_TRUE(scheduler.step() > 0);
+  ASSERT_TRUE(
+      scheduler.submit(document.make(std::vector<uint64_t>(1500, 7), 1)).ok());
+  while (!document.done) {
+    scheduler.step();
+  }
+
+  // Once the costs are measured, the chunks stay well below the budget.
+  int64_t largest_late_chunk = 0;
+  int num_chunks = 0;
+  for (const auto& call : calls_) {
+    if (call.sequence == 1 && ++num_chunks > 3) {
+      largest_late_chunk = std::max(largest_late_chunk, call.num_tokens);
+    }
+  }
+  EXPECT_GT(num_chunks, 10);
+  EXPECT_LT(largest_late_chunk, 200);
+  EXPECT_GT(scheduler.counters().decode_step_ms, 0.0);
+  EXPECT_GT(scheduler.counters().prefill_token_ms, 0.0);
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ * @lint-ignore-every CLANGTIDY facebook-hte-Deprecated
+ */
+
+#include <executorch/extension/llm/runner/encoder_cache.h>
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/extension/testing_util/temp_file.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace ::testing;
+using executorch::extension::make_tensor_ptr;
+using executorch::extension::TensorPtr;
+using executorch::extension::llm::Audio;
+using executorch::extension::llm::EncoderCache;
+using executorch::extension::llm::Image;
+using executorch::extension::llm::MultimodalInput;
+using executorch::extension::testing::TempFile;
+using executorch::runtime::Error;
+
+namespace {
+
+MultimodalInput make_image(uint8_t value, int32_t width = 4) {
+  return MultimodalInput(
+      Image(std::vector<uint8_t>(width * 2 * 3, value), width, 2, 3));
+}
+
+EncoderCache::Key image_key(uint8_t value, const std::string& model_id = "") {
+  return EncoderCache(0, model_id)
+      .key("vision_encoder", make_image(value))
+      .value();
+}
+
+template <typename T>
+void append(std::string& file, const T& value) {
+  file.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// A file with one float entry of the given sizes, whose byte count is that of
+// the sizes multiplied in wrapping 64-bit arithmetic.
+std::string make_file_with_sizes(const std::vector<int32_t>& sizes) {
+  std::string file("ETENCC02");
+  append(file, uint64_t{0}); // model id length
+  append(file, uint64_t{1}); // num_entries
+  append(file, uint64_t{1}); // hash
+  append(file, uint64_t{2});
+  append(file, static_cast<int32_t>(executorch::aten::ScalarType::Float));
+  append(file, static_cast<uint32_t>(sizes.size()));
+  uint64_t nbytes = sizeof(float);
+  for (int32_t size : sizes) {
+    append(file, size);
+    nbytes *= static_cast<uint64_t>(size);
+  }
+  append(file, nbytes);
+  return file;
+}
+
+// A [1, n] float output filled with value, of 4 * n bytes.
+TensorPtr make_output(float value, int32_t n = 4) {
+  return make_tensor_ptr({1, n}, std::vector<float>(n, value));
+}
+
+class EncoderCacheTest : public Test {
+ protected:
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+  }
+};
+
+} // namespace
+
+TEST_F(EncoderCacheTest, KeysDependOnContentShapeAndMethod) {
+  const EncoderCache cache(0);
+  const auto key = image_key(1);
+  EXPECT_EQ(key, image_key(1));
+  EXPECT_FALSE(key == image_key(2));
+  EXPECT_FALSE(key == cache.key("vision_encoder", make_image(1, 2)).value());
+  EXPECT_FALSE(key == cache.key("audio_encoder", make_image(1)).value());
+
+  MultimodalInput image(Image(std::vector<float>(24, 1.0f), 4, 2, 3));
+  MultimodalInput audio(Audio(std::vector<float>(24, 1.0f), 1, 4, 6));
+  EXPECT_FALSE(
+      cache.key("vision_encoder", image).value() ==
+      cache.key("vision_encoder", audio).value());
+  EXPECT_FALSE(
+      cache.key("vision_encoder", MultimodalInput("text")).has_value());
+}
+
+TEST_F(EncoderCacheTest, KeysDependOnModelId) {
+  EXPECT_EQ(image_key(1, "llava.pte"), image_key(1, "llava.pte"));
+  EXPECT_FALSE(image_key(1, "llava.pte") == image_key(1));
+  EXPECT_FALSE(image_key(1, "llava.pte") == image_key(1, "gemma3.pte"));
+}
+
+TEST_F(EncoderCacheTest, GetReturnsCopyOfPutOutput) {
+  EncoderCache cache(1024);
+  EXPECT_EQ(cache.get(image_key(1)), nullptr);
+
+  auto output = make_output(3.0f);
+  cache.put(image_key(1), *output);
+  output->mutable_data_ptr<float>()[0] = 0.0f;
+
+  auto cached = cache.get(image_key(1));
+  ASSERT_NE(cached, nullptr);
+  EXPECT_EQ(cached->size(1), 4);
+  EXPECT_EQ(cached->const_data_ptr<float>()[0], 3.0f);
+  EXPECT_EQ(cache.num_hits(), 1);
+  EXPECT_EQ(cache.num_misses(), 1);
+  EXPECT_EQ(cache.size_bytes(), 16);
+}
+
+TEST_F(EncoderCacheTest, EvictsLeastRecentlyUsedPastMaxBytes) {
+  EncoderCache cache(48);
+  cache.put(image_key(1), *make_output(1.0f));
+  cache.put(image_key(2), *make_output(2.0f));
+  cache.put(image_key(3), *make_output(3.0f));
+  auto held = cache.get(image_key(1));
+
+  cache.put(image_key(4), *make_output(4.0f));
+
+  EXPECT_EQ(cache.size(), 3);
+  EXPECT_EQ(cache.size_bytes(), 48);
+  EXPECT_EQ(cache.get(image_key(2)), nullptr);
+  EXPECT_NE(cache.get(image_key(1)), nullptr);
+  EXPECT_NE(cache.get(image_key(3)), nullptr);
+  EXPECT_NE(cache.get(image_key(4)), nullptr);
+
+  // Outputs too large for the cache are not cached, and do not evict.
+  cache.put(image_key(5), *make_output(5.0f, 16));
+  EXPECT_EQ(cache.get(image_key(5)), nullptr);
+  EXPECT_EQ(cache.size(), 3);
+
+  // An evicted output stays valid while it is held.
+  cache.clear();
+  EXPECT_EQ(held->const_data_ptr<float>()[3], 1.0f);
+}
+
+TEST_F(EncoderCacheTest, SaveAndLoadRoundTrip) {
+  EncoderCache cache(1024);
+  cache.put(image_key(1), *make_output(1.0f));
+  cache.put(image_key(2), *make_output(2.0f, 8));
+  TempFile file("");
+  ASSERT_EQ(cache.save(file.path()), Error::Ok);
+
+  // Loading into a smaller cache keeps the most recently used outputs.
+  EncoderCache loaded(32);
+  ASSERT_EQ(loaded.load(file.path()), Error::Ok);
+  EXPECT_EQ(loaded.size(), 1);
+  auto output = loaded.get(image_key(2));
+  ASSERT_NE(output, nullptr);
+  EXPECT_EQ(output->dim(), 2);
+  EXPECT_EQ(output->size(1), 8);
+  EXPECT_EQ(output->const_data_ptr<float>()[7], 2.0f);
+  EXPECT_EQ(loaded.get(image_key(1)), nullptr);
+}
+
+TEST_F(EncoderCacheTest, LoadRejectsOtherFiles) {
+  EncoderCache cache(1024);
+  TempFile file("not an encoder cache");
+  EXPECT_EQ(cache.load(file.path()), Error::InvalidExternalData);
+  EXPECT_EQ(cache.load(file.path() + ".missing"), Error::AccessFailed);
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST_F(EncoderCacheTest, LoadRejectsOtherModels) {
+  EncoderCache cache(1024, "llava.pte");
+  cache.put(image_key(1, "llava.pte"), *make_output(1.0f));
+  TempFile file("");
+  ASSERT_EQ(cache.save(file.path()), Error::Ok);
+
+  EncoderCache other(1024, "gemma3.pte");
+  EXPECT_EQ(other.load(file.path()), Error::InvalidExternalData);
+  EXPECT_EQ(other.size(), 0);
+
+  EncoderCache same(1024, "llava.pte");
+  ASSERT_EQ(same.load(file.path()), Error::Ok);
+  EXPECT_NE(same.get(image_key(1, "llava.pte")), nullptr);
+}
+
+TEST_F(EncoderCacheTest, LoadRejectsOverflowingSizes) {
+  EncoderCache cache(1024);
+  // The number of elements overflows.
+  TempFile numel_file(make_file_with_sizes({1 << 30, 1 << 30, 1 << 30}));
+  EXPECT_EQ(cache.load(numel_file.path()), Error::InvalidExternalData);
+  // The number of elements fits, but not the number of bytes.
+  TempFile nbytes_file(make_file_with_sizes({1 << 30, 1 << 30, 4}));
+  EXPECT_EQ(cache.load(nbytes_file.path()), Error::InvalidExternalData);
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST_F(EncoderCacheTest, LoadRejectsSizesPastTheEndOfTheFile) {
+  EncoderCache cache(1024);
+  // A valid 1 GiB entry whose data is missing from the file.
+  TempFile file(make_file_with_sizes({1 << 14, 1 << 14}));
+  EXPECT_EQ(cache.load(file.path()), Error::InvalidExternalData);
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST_F(EncoderCacheTest, LoadSkipsEntriesLargerThanMaxBytes) {
+  EncoderCache cache(1024);
+  cache.put(image_key(1), *make_output(1.0f, 64));
+  cache.put(image_key(2), *make_output(2.0f));
+  cache.put(image_key(3), *make_output(3.0f, 64));
+  TempFile file("");
+  ASSERT_EQ(cache.save(file.path()), Error::Ok);
+
+  // Only the 16-byte output fits; the entries around it are skipped.
+  EncoderCache loaded(128);
+  ASSERT_EQ(loaded.load(file.path()), Error::Ok);
+  EXPECT_EQ(loaded.size(), 1);
+  auto output = loaded.get(image_key(2));
+  ASSERT_NE(output, nullptr);
+  EXPECT_EQ(output->const_data_ptr<float>()[3], 2.0f);
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ * @lint-ignore-every CLANGTIDY facebook-hte-Deprecated
+ */
+
+#include <executorch/extension/llm/runner/image_preprocessor.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+using namespace ::testing;
+using executorch::aten::ScalarType;
+using executorch::aten::SizesType;
+using executorch::extension::llm::ImageBuffer;
+using executorch::extension::llm::ImagePreprocessor;
+using executorch::extension::llm::ImagePreprocessorConfig;
+using executorch::extension::llm::ResizeFilter;
+using executorch::runtime::Error;
+
+namespace {
+
+// An HWC image whose pixels all differ.
+std::vector<uint8_t> make_pixels(int32_t width, int32_t height, int32_t c) {
+  std::vector<uint8_t> pixels(width * height * c);
+  for (size_t i = 0; i < pixels.size(); ++i) {
+    pixels[i] = static_cast<uint8_t>(i * 7 % 251);
+  }
+  return pixels;
+}
+
+class ImagePreprocessorTest : public Test {
+ protected:
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+  }
+};
+
+} // namespace
+
+TEST_F(ImagePreprocessorTest, NormalizesAndTransposesToChw) {
+  const auto pixels = make_pixels(3, 2, 3);
+  ImagePreprocessorConfig config;
+  config.mean = {0.5f, 0.25f, 0.0f};
+  config.std = {0.5f, 0.25f, 2.0f};
+  ImagePreprocessor preprocessor(config);
+
+  auto output = preprocessor.preprocess(ImageBuffer{pixels.data(), 3, 2});
+  ASSERT_TRUE(output.ok());
+  const auto& tensor = **output;
+  ASSERT_EQ(tensor.dim(), 3);
+  EXPECT_EQ(tensor.size(0), 3);
+  EXPECT_EQ(tensor.size(1), 2);
+  EXPECT_EQ(tensor.size(2), 3);
+  const float* data = tensor.const_data_ptr<float>();
+  for (int c = 0; c < 3; ++c) {
+    for (int i = 0; i < 6; ++i) {
+      const float expected =
+          (pixels[i * 3 + c] / 255.0f - config.mean[c]) / config.std[c];
+      EXPECT_NEAR(data[c * 6 + i], expected, 1e-5f);
+    }
+  }
+}
+
+TEST_F(ImagePreprocessorTest, DownscalesWithAndWithoutAntialias) {
+  const std::vector<uint8_t> pixels = {0, 100, 200, 250};
+  const ImageBuffer image{pixels.data(), 4, 1, 1};
+  ImagePreprocessorConfig config;
+  config.resize_width = 2;
+  config.resize_height = 1;
+  config.filter = ResizeFilter::Bilinear;
+  config.dtype = ScalarType::Byte;
+
+  // Antialiasing widens the triangle filter to two input pixels.
+  auto output = ImagePreprocessor(config).preprocess(image);
+  ASSERT_TRUE(output.ok());
+  EXPECT_EQ((*output)->const_data_ptr<uint8_t>()[0], 71);
+  EXPECT_EQ((*output)->const_data_ptr<uint8_t>()[1], 207);
+
+  config.antialias = false;
+  auto sampled = ImagePreprocessor(config).preprocess(image);
+  ASSERT_TRUE(sampled.ok());
+  EXPECT_EQ((*sampled)->const_data_ptr<uint8_t>()[0], 50);
+  EXPECT_EQ((*sampled)->const_data_ptr<uint8_t>()[1], 225);
+}
+
+TEST_F(ImagePreprocessorTest, ResizeKeepsConstantImages) {
+  const std::vector<uint8_t> pixels(37 * 23 * 3, 93);
+  for (auto filter : {ResizeFilter::Bilinear, ResizeFilter::Bicubic}) {
+    ImagePreprocessorConfig config;
+    config.filter = filter;
+    config.shortest_edge = 50;
+    config.crop_width = 48;
+    config.crop_height = 48;
+    config.dtype = ScalarType::Byte;
+    auto output = ImagePreprocessor(config).preprocess(
+        ImageBuffer{pixels.data(), 37, 23});
+    ASSERT_TRUE(output.ok());
+    EXPECT_EQ((*output)->size(1), 48);
+    EXPECT_EQ((*output)->size(2), 48);
+    const uint8_t* data = (*output)->const_data_ptr<uint8_t>();
+    for (ssize_t i = 0; i < (*output)->numel(); ++i) {
+      ASSERT_EQ(data[i], 93);
+    }
+  }
+}
+
+TEST_F(ImagePreprocessorTest, ComputesOutputSizes) {
+  ImagePreprocessorConfig config;
+  config.shortest_edge = 336;
+  auto sizes = ImagePreprocessor(config).output_sizes(1920, 1080);
+  ASSERT_TRUE(sizes.ok());
+  EXPECT_EQ(*sizes, (std::vector<SizesType>{3, 336, 597}));
+
+  config.shortest_edge = 0;
+  config.longest_edge = 336;
+  auto portrait = ImagePreprocessor(config).output_sizes(1080, 1920);
+  ASSERT_TRUE(portrait.ok());
+  EXPECT_EQ(*portrait, (std::vector<SizesType>{3, 336, 189}));
+
+  config.crop_width = 112;
+  config.crop_height = 224;
+  config.tile_size = 56;
+  auto tiled = ImagePreprocessor(config).output_sizes(1080, 1920);
+  ASSERT_TRUE(tiled.ok());
+  EXPECT_EQ(*tiled, (std::vector<SizesType>{8, 3, 56, 56}));
+
+  config.tile_size = 100;
+  EXPECT_EQ(
+      ImagePreprocessor(config).output_sizes(1080, 1920).error(),
+      Error::InvalidArgument);
+  config.tile_size = 0;
+  config.crop_width = 200;
+  EXPECT_EQ(
+      ImagePreprocessor(config).output_sizes(1080, 1920).error(),
+      Error::InvalidArgument);
+  config.crop_width = 0;
+  config.mean = {0.5f};
+  EXPECT_EQ(
+      ImagePreprocessor(config).output_sizes(1080, 1920).error(),
+      Error::InvalidArgument);
+}
+
+TEST_F(ImagePreprocessorTest, TilesCropInTileCropLayout) {
+  constexpr int32_t kWidth = 6, kHeight = 4, kTile = 2;
+  const auto pixels = make_pixels(kWidth, kHeight, 3);
+  ImagePreprocessorConfig config;
+  config.crop_width = 4;
+  config.crop_height = 2;
+  config.dtype = ScalarType::Byte;
+  auto chw = ImagePreprocessor(config).preprocess(
+      ImageBuffer{pixels.data(), kWidth, kHeight});
+  ASSERT_TRUE(chw.ok());
+  config.tile_size = kTile;
+  auto tiles = ImagePreprocessor(config).preprocess(
+      ImageBuffer{pixels.data(), kWidth, kHeight});
+  ASSERT_TRUE(tiles.ok());
+  ASSERT_EQ((*tiles)->size(0), 2);
+
+  // The crop is the center of the image, unchanged.
+  const uint8_t* in = (*chw)->const_data_ptr<uint8_t>();
+  EXPECT_EQ(in[0], pixels[(1 * kWidth + 1) * 3]);
+  EXPECT_EQ(in[2 * 8 + 1 * 4 + 3], pixels[(2 * kWidth + 4) * 3 + 2]);
+
+  // The loop of preprocess::tile_crop over the untiled output.
+  const uint8_t* out = (*tiles)->const_data_ptr<uint8_t>();
+  size_t out_ix = 0;
+  for (int bh = 0; bh < 2 / kTile; ++bh) {
+    for (int bw = 0; bw < 4 / kTile; ++bw) {
+      for (int c = 0; c < 3; ++c) {
+        for (int h = 0; h < kTile; ++h) {
+          for (int w = 0; w < kTile; ++w) {
+            const int in_h = bh * kTile + h;
+            const int in_w = bw * kTile + w;
+            EXPECT_EQ(out[out_ix++], in[c * 2 * 4 + in_h * 4 + in_w]);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_F(ImagePreprocessorTest, BatchMatchesSingleImages) {
+  const auto first = make_pixels(40, 30, 3);
+  auto second = make_pixels(40, 30, 3);
+  for (auto& pixel : second) {
+    pixel = 255 - pixel;
+  }
+  // A padded copy of the second image, to read through a stride.
+  std::vector<uint8_t> padded(30 * 128);
+  for (int y = 0; y < 30; ++y) {
+    std::copy_n(&second[y * 120], 120, &padded[y * 128]);
+  }
+  ImagePreprocessorConfig config;
+  config.resize_width = 24;
+  config.resize_height = 64;
+  ImagePreprocessor preprocessor(config);
+
+  auto batch = preprocessor.preprocess(std::vector<ImageBuffer>{
+      {first.data(), 40, 30}, {padded.data(), 40, 30, 3, 128}});
+  ASSERT_TRUE(batch.ok());
+  ASSERT_EQ((*batch)->dim(), 4);
+  EXPECT_EQ((*batch)->size(0), 2);
+  const float* data = (*batch)->const_data_ptr<float>();
+  const size_t image_numel = 3 * 64 * 24;
+  size_t offset = 0;
+  for (const auto* pixels : {&first, &std::as_const(second)}) {
+    auto single = preprocessor.preprocess(ImageBuffer{pixels->data(), 40, 30});
+    ASSERT_TRUE(single.ok());
+    const float* expected = (*single)->const_data_ptr<float>();
+    for (size_t i = 0; i < image_numel; ++i) {
+      ASSERT_EQ(data[offset + i], expected[i]);
+    }
+    offset += image_numel;
+  }
+
+  EXPECT_EQ(
+      preprocessor
+          .preprocess(std::vector<ImageBuffer>{
+              {first.data(), 40, 30}, {first.data(), 40, 30, 1}})
+          .error(),
+      Error::InvalidArgument);
+}
+
+TEST_F(ImagePreprocessorTest, ConvertsToHalfBFloat16AndImages) {
+  const auto pixels = make_pixels(20, 20, 3);
+  const ImageBuffer image{pixels.data(), 20, 20};
+  ImagePreprocessorConfig config;
+  config.resize_width = 16;
+  config.resize_height = 12;
+  config.mean = {0.48f, 0.46f, 0.41f};
+  config.std = {0.27f, 0.26f, 0.28f};
+  auto expected = ImagePreprocessor(config).preprocess(image);
+  ASSERT_TRUE(expected.ok());
+  const float* reference = (*expected)->const_data_ptr<float>();
+
+  config.dtype = ScalarType::Half;
+  auto half = ImagePreprocessor(config).preprocess(image);
+  ASSERT_TRUE(half.ok());
+  EXPECT_EQ((*half)->scalar_type(), ScalarType::Half);
+  config.dtype = ScalarType::BFloat16;
+  auto bf16 = ImagePreprocessor(config).preprocess(image);
+  ASSERT_TRUE(bf16.ok());
+  for (ssize_t i = 0; i < (*expected)->numel(); ++i) {
+    EXPECT_NEAR(
+        static_cast<float>(
+            (*half)->const_data_ptr<executorch::aten::Half>()[i]),
+        reference[i],
+        1e-2f);
+    EXPECT_NEAR(
+        static_cast<float>(
+            (*bf16)->const_data_ptr<executorch::aten::BFloat16>()[i]),
+        reference[i],
+        3e-2f);
+  }
+
+  config.dtype = ScalarType::Float;
+  auto converted = ImagePreprocessor(config).preprocess_to_image(image);
+  ASSERT_TRUE(converted.ok());
+  EXPECT_EQ(converted->width(), 16);
+  EXPECT_EQ(converted->height(), 12);
+  ASSERT_TRUE(converted->is_float());
+  for (ssize_t i = 0; i < (*expected)->numel(); ++i) {
+    ASSERT_EQ(converted->get_float_data()[i], reference[i]);
+  }
+  config.dtype = ScalarType::Half;
+  EXPECT_EQ(
+      ImagePreprocessor(config).preprocess_to_image(image).error(),
+      Error::InvalidArgument);
+}
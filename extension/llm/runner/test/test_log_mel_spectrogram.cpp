@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ * @lint-ignore-every CLANGTIDY facebook-hte-Deprecated
+ */
+
+#include <executorch/extension/llm/runner/log_mel_spectrogram.h>
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace ::testing;
+using executorch::aten::ScalarType;
+using executorch::extension::TensorPtr;
+using executorch::extension::llm::LogMelConfig;
+using executorch::extension::llm::LogMelSpectrogram;
+using executorch::extension::llm::LogMelStream;
+using executorch::extension::llm::MelLayout;
+using executorch::runtime::Error;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// A chirp with some noise-like content, so that all the mel bands see energy.
+std::vector<float> make_audio(size_t num_samples) {
+  std::vector<float> audio(num_samples);
+  for (size_t i = 0; i < num_samples; ++i) {
+    const double t = i / 16000.0;
+    audio[i] = static_cast<float>(
+        0.5 * std::sin(2 * kPi * (200.0 + 3000.0 * t) * t) +
+        0.1 * std::sin(i * 1.7) * std::cos(i * 0.31));
+  }
+  return audio;
+}
+
+double hz_to_mel(double hz) {
+  return hz < 1000.0 ? hz * 3.0 / 200.0
+                     : 15.0 + std::log(hz / 1000.0) * 27.0 / std::log(6.4);
+}
+
+double mel_to_hz(double mel) {
+  return mel < 15.0 ? mel * 200.0 / 3.0
+                    : 1000.0 * std::exp(std::log(6.4) / 27.0 * (mel - 15.0));
+}
+
+// WhisperAudioProcessor.forward() of extension/audio/mel_spectrogram.py in
+// double precision, with a dense filterbank and a direct DFT, as
+// [n_mels, n_frames].
+std::vector<double> reference_log_mel(
+    const LogMelConfig& config,
+    const std::vector<float>& audio) {
+  const int n_fft = config.n_fft;
+  const int n_bins = n_fft / 2 + 1;
+  const int n_mels = config.n_mels;
+  const int pad = n_fft / 2;
+  const int n = static_cast<int>(audio.size());
+  const int n_frames = n / config.hop_length;
+
+  std::vector<double> mel_hz(n_mels + 2);
+  for (int i = 0; i < n_mels + 2; ++i) {
+    mel_hz[i] = mel_to_hz(hz_to_mel(config.sample_rate / 2.0) * i / (n_mels + 1));
+  }
+  std::vector<double> filters(n_mels * n_bins);
+  for (int m = 0; m < n_mels; ++m) {
+    for (int k = 0; k < n_bins; ++k) {
+      const double hz = k * static_cast<double>(config.sample_rate) / n_fft;
+      const double lower = (hz - mel_hz[m]) / (mel_hz[m + 1] - mel_hz[m]);
+      const double upper =
+          (mel_hz[m + 2] - hz) / (mel_hz[m + 2] - mel_hz[m + 1]);
+      filters[m * n_bins + k] = std::max(0.0, std::min(lower, upper)) * 2.0 /
+          (mel_hz[m + 2] - mel_hz[m]);
+    }
+  }
+
+  std::vector<double> log_mel(n_mels * n_frames);
+  std::vector<double> frame(n_fft);
+  for (int t = 0; t < n_frames; ++t) {
+    for (int j = 0; j < n_fft; ++j) {
+      int i = t * config.hop_length - pad + j;
+      i = i < 0 ? -i : i;
+      i = i >= n ? 2 * n - 2 - i : i;
+      frame[j] = audio[i] * 0.5 * (1.0 - std::cos(2.0 * kPi * j / n_fft));
+    }
+    std::vector<double> power(n_bins);
+    for (int k = 0; k < n_bins; ++k) {
+      double re = 0.0, im = 0.0;
+      for (int j = 0; j < n_fft; ++j) {
+        const double angle = -2.0 * kPi * ((k * j) % n_fft) / n_fft;
+        re += frame[j] * std::cos(angle);
+        im += frame[j] * std::sin(angle);
+      }
+      power[k] = re * re + im * im;
+    }
+    for (int m = 0; m < n_mels; ++m) {
+      double mel = 0.0;
+      for (int k = 0; k < n_bins; ++k) {
+        mel += filters[m * n_bins + k] * power[k];
+      }
+      log_mel[m * n_frames + t] = std::log10(std::max(mel, 1e-10));
+    }
+  }
+  const double max_log_mel = *std::max_element(log_mel.begin(), log_mel.end());
+  for (auto& value : log_mel) {
+    value = (std::max(value, max_log_mel - 8.0) + 4.0) / 4.0;
+  }
+  return log_mel;
+}
+
+class LogMelSpectrogramTest : public Test {
+ protected:
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+  }
+};
+
+} // namespace
+
+TEST_F(LogMelSpectrogramTest, MatchesWhisperFeatureExtraction) {
+  const auto audio = make_audio(4000);
+  LogMelConfig config;
+  auto spectrogram = LogMelSpectrogram::create(config);
+  ASSERT_TRUE(spectrogram.ok());
+  EXPECT_EQ(spectrogram->num_frames(audio.size()), 25);
+
+  auto output = spectrogram->compute(audio.data(), audio.size());
+  ASSERT_TRUE(output.ok());
+  ASSERT_EQ((*output)->dim(), 3);
+  EXPECT_EQ((*output)->size(0), 1);
+  EXPECT_EQ((*output)->size(1), 80);
+  EXPECT_EQ((*output)->size(2), 25);
+
+  const auto expected = reference_log_mel(config, audio);
+  const float* data = (*output)->const_data_ptr<float>();
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(data[i], expected[i], 2e-4) << "at " << i;
+  }
+
+  // The other layout transposes the frames and the mels.
+  config.layout = MelLayout::FramesByMels;
+  auto transposed = LogMelSpectrogram::create(config);
+  ASSERT_TRUE(transposed.ok());
+  auto frames = transposed->compute(audio.data(), audio.size());
+  ASSERT_TRUE(frames.ok());
+  EXPECT_EQ((*frames)->size(1), 25);
+  EXPECT_EQ((*frames)->size(2), 80);
+  for (int t = 0; t < 25; ++t) {
+    for (int m = 0; m < 80; ++m) {
+      ASSERT_EQ((*frames)->const_data_ptr<float>()[t * 80 + m], data[m * 25 + t]);
+    }
+  }
+}
+
+TEST_F(LogMelSpectrogramTest, PadsToMultipleAndWritesIntoEncoderInput) {
+  const auto audio = make_audio(2500);
+  LogMelConfig config;
+  config.pad_to_multiple = 1600;
+  auto spectrogram = LogMelSpectrogram::create(config);
+  ASSERT_TRUE(spectrogram.ok());
+  EXPECT_EQ(spectrogram->num_frames(audio.size()), 20);
+
+  auto padded_audio = audio;
+  padded_audio.resize(3200, 0.0f);
+  config.pad_to_multiple = 0;
+  auto unpadded = LogMelSpectrogram::create(config);
+  ASSERT_TRUE(unpadded.ok());
+  auto expected = unpadded->compute(padded_audio.data(), padded_audio.size());
+  ASSERT_TRUE(expected.ok());
+
+  for (auto dtype : {ScalarType::Float, ScalarType::BFloat16}) {
+    auto encoder_input = executorch::extension::empty({1, 80, 20}, dtype);
+    ASSERT_EQ(
+        spectrogram->compute_into(audio.data(), audio.size(), *encoder_input),
+        Error::Ok);
+    for (ssize_t i = 0; i < encoder_input->numel(); ++i) {
+      const float value = dtype == ScalarType::Float
+          ? encoder_input->const_data_ptr<float>()[i]
+          : static_cast<float>(
+                encoder_input
+                    ->const_data_ptr<executorch::aten::BFloat16>()[i]);
+      EXPECT_NEAR(
+          value,
+          (*expected)->const_data_ptr<float>()[i],
+          dtype == ScalarType::Float ? 0.0f : 1e-2f);
+    }
+  }
+
+  auto wrong_size = executorch::extension::empty({1, 80, 19});
+  EXPECT_EQ(
+      spectrogram->compute_into(audio.data(), audio.size(), *wrong_size),
+      Error::InvalidArgument);
+  auto wrong_dtype = executorch::extension::empty({1, 80, 20}, ScalarType::Int);
+  EXPECT_EQ(
+      spectrogram->compute_into(audio.data(), audio.size(), *wrong_dtype),
+      Error::InvalidArgument);
+}
+
+TEST_F(LogMelSpectrogramTest, StreamMatchesWholeAudio) {
+  const auto audio = make_audio(9000);
+  LogMelConfig config;
+  // The stream clamps relative to the maximum so far.
+  config.dynamic_range = 0.0f;
+  config.layout = MelLayout::FramesByMels;
+  auto spectrogram = LogMelSpectrogram::create(config);
+  ASSERT_TRUE(spectrogram.ok());
+  auto expected = spectrogram->compute(audio.data(), audio.size());
+  ASSERT_TRUE(expected.ok());
+
+  LogMelStream stream(*spectrogram);
+  // Run twice to check that finish() leaves the stream ready for reuse.
+  for (int run = 0; run < 2; ++run) {
+    TensorPtr out = executorch::extension::empty({1, 64, 80});
+    std::vector<float> frames;
+    size_t offset = 0;
+    size_t chunk = 1;
+    while (offset < audio.size()) {
+      const size_t n = std::min(chunk, audio.size() - offset);
+      const int64_t ready = stream.num_ready_frames(n);
+      auto emitted = stream.accept(audio.data() + offset, n, out);
+      ASSERT_TRUE(emitted.ok());
+      ASSERT_EQ(*emitted, ready);
+      ASSERT_EQ(out->size(1), ready);
+      frames.insert(
+          frames.end(),
+          out->const_data_ptr<float>(),
+          out->const_data_ptr<float>() + out->numel());
+      offset += n;
+      chunk = chunk * 3 + 7;
+    }
+    EXPECT_EQ(stream.num_final_frames(), 56 - stream.num_frames_emitted());
+    auto last = stream.finish(out);
+    ASSERT_TRUE(last.ok());
+    frames.insert(
+        frames.end(),
+        out->const_data_ptr<float>(),
+        out->const_data_ptr<float>() + out->numel());
+    EXPECT_EQ(stream.num_frames_emitted(), 0);
+
+    ASSERT_EQ(frames.size(), static_cast<size_t>((*expected)->numel()));
+    for (size_t i = 0; i < frames.size(); ++i) {
+      ASSERT_EQ(frames[i], (*expected)->const_data_ptr<float>()[i]) << i;
+    }
+  }
+}
+
+TEST_F(LogMelSpectrogramTest, RejectsInvalidConfigsAndShortAudio) {
+  LogMelConfig config;
+  config.n_mels = 0;
+  EXPECT_EQ(LogMelSpectrogram::create(config).error(), Error::InvalidArgument);
+  config.n_mels = 80;
+  config.f_max = 9000.0f;
+  EXPECT_EQ(LogMelSpectrogram::create(config).error(), Error::InvalidArgument);
+  config.f_max = 0.0f;
+  config.log_floor = 0.0f;
+  EXPECT_EQ(LogMelSpectrogram::create(config).error(), Error::InvalidArgument);
+
+  // One frame, but too few samples to reflect the first window.
+  auto spectrogram = LogMelSpectrogram::create();
+  ASSERT_TRUE(spectrogram.ok());
+  const auto audio = make_audio(180);
+  EXPECT_EQ(
+      spectrogram->compute(audio.data(), audio.size()).error(),
+      Error::InvalidArgument);
+  auto empty = spectrogram->compute(audio.data(), 100);
+  ASSERT_TRUE(empty.ok());
+  EXPECT_EQ((*empty)->size(2), 0);
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ * @lint-ignore-every CLANGTIDY facebook-hte-Deprecated
+ */
+
+#include <executorch/extension/llm/runner/pipelined_multimodal_prefiller.h>
+#include <executorch/extension/tensor/tensor_ptr_maker.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace ::testing;
+using executorch::extension::make_tensor_ptr;
+using executorch::extension::Module;
+using executorch::extension::TensorPtr;
+using executorch::extension::llm::EncoderCache;
+using executorch::extension::llm::Image;
+using executorch::extension::llm::MultimodalInput;
+using executorch::extension::llm::PipelinedMultimodalPrefiller;
+using executorch::extension::llm::Stats;
+using executorch::runtime::Error;
+using executorch::runtime::EValue;
+using executorch::runtime::Result;
+
+namespace {
+
+// Encodes every input to an integer, the first token of a tokens input or
+// the width of an image, and prefills by recording it. Images of width 0
+// fail to encode.
+class FakePipelinedPrefiller : public PipelinedMultimodalPrefiller {
+ public:
+  FakePipelinedPrefiller(
+      Module* module,
+      std::vector<std::unique_ptr<Module>> encoder_modules,
+      Stats* stats)
+      : PipelinedMultimodalPrefiller(
+            module,
+            nullptr,
+            nullptr,
+            nullptr,
+            std::move(encoder_modules),
+            stats) {}
+
+  std::vector<int64_t> prefilled;
+  std::atomic<int> max_running_encoders{0};
+  std::atomic<int> images_on_main_module{0};
+  std::atomic<int> images_encoded{0};
+
+  std::set<std::thread::id> encoder_threads() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return encoder_threads_;
+  }
+
+ protected:
+  Result<EValue> encode(
+      Module* module,
+      const MultimodalInput& input,
+      int32_t bos,
+      int32_t eos) override {
+    (void)bos;
+    (void)eos;
+    if (input.is_tokens()) {
+      EXPECT_EQ(module, module_);
+      return EValue(static_cast<int64_t>(input.get_tokens()[0]));
+    }
+    if (module == module_) {
+      ++images_on_main_module;
+    }
+    const int running = ++running_encoders_;
+    int expected = max_running_encoders.load();
+    while (running > expected &&
+           !max_running_encoders.compare_exchange_weak(expected, running)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    --running_encoders_;
+    const int32_t width = input.get_image().width();
+    if (width == 0) {
+      return Error::InvalidArgument;
+    }
+    ++images_encoded;
+    auto output = make_tensor_ptr(std::vector<int64_t>{width});
+    std::lock_guard<std::mutex> lock(mutex_);
+    encoder_threads_.insert(std::this_thread::get_id());
+    outputs_.push_back(output);
+    return EValue(*output);
+  }
+
+  Result<uint64_t> prefill_embeddings(
+      const EValue& encoder_output,
+      int64_t& start_pos) override {
+    const int64_t value = encoder_output.isTensor()
+        ? encoder_output.toTensor().const_data_ptr<int64_t>()[0]
+        : encoder_output.toInt();
+    prefilled.push_back(value);
+    ++start_pos;
+    return static_cast<uint64_t>(value);
+  }
+
+ private:
+  std::atomic<int> running_encoders_{0};
+  std::mutex mutex_;
+  std::vector<TensorPtr> outputs_;
+  std::set<std::thread::id> encoder_threads_;
+};
+
+MultimodalInput make_image(int32_t width) {
+  return MultimodalInput(Image(std::vector<uint8_t>(width), width, 1, 1));
+}
+
+MultimodalInput make_tokens(uint64_t token) {
+  return MultimodalInput(std::vector<uint64_t>{token});
+}
+
+class PipelinedMultimodalPrefillerTest : public Test {
+ protected:
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+    stats_.reset();
+  }
+
+  // The fake encoder does not run the Modules, so they are never loaded.
+  std::vector<std::unique_ptr<Module>> make_encoder_modules(size_t n) {
+    std::vector<std::unique_ptr<Module>> modules;
+    for (size_t i = 0; i < n; ++i) {
+      modules.push_back(std::make_unique<Module>("unused.pte"));
+    }
+    return modules;
+  }
+
+  Module module_{"unused.pte"};
+  Stats stats_;
+};
+
+} // namespace
+
+TEST_F(PipelinedMultimodalPrefillerTest, OverlapsEncodersAndPrefillsInOrder) {
+  FakePipelinedPrefiller prefiller(&module_, make_encoder_modules(3), &stats_);
+  std::vector<MultimodalInput> inputs;
+  inputs.push_back(make_tokens(0));
+  inputs.push_back(make_image(1));
+  inputs.push_back(make_tokens(2));
+  for (int32_t width = 3; width < 8; ++width) {
+    inputs.push_back(make_image(width));
+  }
+
+  int64_t start_pos = 10;
+  auto result = prefiller.prefill(inputs, start_pos);
+
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.get(), 7);
+  EXPECT_EQ(start_pos, 18);
+  EXPECT_EQ(
+      prefiller.prefilled, (std::vector<int64_t>{0, 1, 2, 3, 4, 5, 6, 7}));
+  EXPECT_EQ(prefiller.images_on_main_module.load(), 0);
+  EXPECT_GT(prefiller.max_running_encoders.load(), 1);
+  EXPECT_LE(prefiller.max_running_encoders.load(), 3);
+  // Six images of 20 ms each.
+  EXPECT_GE(stats_.aggregate_encoder_time_ms, 6 * 15);
+}
+
+TEST_F(PipelinedMultimodalPrefillerTest, ReusesEncoderThreadsAcrossPrefills) {
+  FakePipelinedPrefiller prefiller(&module_, make_encoder_modules(2), &stats_);
+  std::vector<MultimodalInput> inputs;
+  for (int32_t width = 1; width < 5; ++width) {
+    inputs.push_back(make_image(width));
+  }
+
+  int64_t start_pos = 0;
+  ASSERT_TRUE(prefiller.prefill(inputs, start_pos).ok());
+  const std::set<std::thread::id> threads = prefiller.encoder_threads();
+  EXPECT_EQ(threads.size(), 2);
+  EXPECT_EQ(threads.count(std::this_thread::get_id()), 0);
+
+  // A failed prefill leaves the threads ready for the next one.
+  std::vector<MultimodalInput> failing;
+  failing.push_back(make_image(0));
+  failing.push_back(make_image(1));
+  failing.push_back(make_image(2));
+  EXPECT_EQ(
+      prefiller.prefill(failing, start_pos).error(), Error::InvalidArgument);
+
+  prefiller.prefilled.clear();
+  ASSERT_TRUE(prefiller.prefill(inputs, start_pos).ok());
+  EXPECT_EQ(prefiller.prefilled, (std::vector<int64_t>{1, 2, 3, 4}));
+  EXPECT_EQ(prefiller.encoder_threads(), threads);
+}
+
+TEST_F(PipelinedMultimodalPrefillerTest, EncoderErrorStopsPrefill) {
+  FakePipelinedPrefiller prefiller(&module_, make_encoder_modules(2), &stats_);
+  std::vector<MultimodalInput> inputs;
+  inputs.push_back(make_image(1));
+  inputs.push_back(make_image(0));
+  inputs.push_back(make_tokens(2));
+  inputs.push_back(make_image(3));
+  inputs.push_back(make_image(4));
+
+  int64_t start_pos = 0;
+  auto result = prefiller.prefill(inputs, start_pos);
+
+  EXPECT_EQ(result.error(), Error::InvalidArgument);
+  EXPECT_EQ(prefiller.prefilled, (std::vector<int64_t>{1}));
+  EXPECT_EQ(start_pos, 1);
+}
+
+TEST_F(PipelinedMultimodalPrefillerTest, WithoutEncoderModulesPrefillsInTurn) {
+  FakePipelinedPrefiller prefiller(&module_, {}, &stats_);
+  std::vector<MultimodalInput> inputs;
+  inputs.push_back(make_tokens(0));
+  inputs.push_back(make_image(1));
+  inputs.push_back(make_image(2));
+
+  int64_t start_pos = 0;
+  auto result = prefiller.prefill(inputs, start_pos);
+
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.get(), 2);
+  EXPECT_EQ(prefiller.prefilled, (std::vector<int64_t>{0, 1, 2}));
+  EXPECT_EQ(prefiller.images_on_main_module.load(), 2);
+  EXPECT_EQ(prefiller.max_running_encoders.load(), 1);
+}
+
+TEST_F(PipelinedMultimodalPrefillerTest, EncoderCacheSkipsRepeatedImages) {
+  auto cache = std::make_shared<EncoderCache>(1024);
+  FakePipelinedPrefiller prefiller(&module_, {}, &stats_);
+  prefiller.set_encoder_cache(cache);
+  std::vector<MultimodalInput> inputs;
+  inputs.push_back(make_image(1));
+  inputs.push_back(make_image(2));
+  inputs.push_back(make_image(1));
+  inputs.push_back(make_tokens(5));
+  inputs.push_back(make_image(2));
+
+  int64_t start_pos = 0;
+  ASSERT_TRUE(prefiller.prefill(inputs, start_pos).ok());
+  EXPECT_EQ(prefiller.prefilled, (std::vector<int64_t>{1, 2, 1, 5, 2}));
+  EXPECT_EQ(prefiller.images_encoded.load(), 2);
+  EXPECT_EQ(stats_.encoder_cache_hits, 2);
+  EXPECT_EQ(stats_.encoder_cache_misses, 2);
+
+  // A later turn on the encoder Modules reuses the same cache.
+  FakePipelinedPrefiller next_turn(&module_, make_encoder_modules(2), &stats_);
+  next_turn.set_encoder_cache(cache);
+  stats_.reset();
+  ASSERT_TRUE(next_turn.prefill(inputs, start_pos).ok());
+  EXPECT_EQ(next_turn.prefilled, (std::vector<int64_t>{1, 2, 1, 5, 2}));
+  EXPECT_EQ(next_turn.images_encoded.load(), 0);
+  EXPECT_EQ(stats_.encoder_cache_hits, 4);
+  EXPECT_EQ(stats_.encoder_cache_misses, 0);
+}
@@ -497,4 +497,90 @@ TEST_F(RunnerTest, GenerateEmptyWithoutPrefillFails) {
   EXPECT_EQ(err, Error::InvalidState);
 }
 
+// Test that a ring buffer KV cache generates past max_context_len
+TEST_F(RunnerTest, RingKVCacheGeneratesPastMaxContextLen) {
+  auto tokenizer = createMockTokenizer();
+  auto text_decoder_runner = createMockTextDecoderRunner();
+  auto text_prefiller = createMockTextPrefiller(text_decoder_runner.get());
+
+  std::unique_ptr<executorch::llm::Stats> stats =
+      std::make_unique<executorch::llm::Stats>();
+  auto text_token_generator = createTextTokenGenerator(
+      tokenizer.get(), text_decoder_runner.get(), stats.get());
+
+  auto metadata = createDefaultMetadata();
+  metadata["use_ring_kv_cache"] = true;
+  auto module = std::make_unique<MockModule>();
+  auto io_manager =
+      std::make_unique<executorch::extension::llm::IOManager>(*module);
+  TextLLMRunner runner(
+      metadata,
+      std::unique_ptr<::tokenizers::Tokenizer>(tokenizer.release()),
+      std::move(module),
+      std::move(text_decoder_runner),
+      std::unique_ptr<::executorch::extension::llm::TextPrefiller>(
+          text_prefiller.release()),
+      std::move(io_manager),
+      std::move(text_token_generator),
+      std::move(stats));
+
+  runner.load();
+
+  // A limit above the max_context_len of 128 holds.
+  GenerationConfig config;
+  config.echo = false;
+  config.max_new_tokens = 300;
+  CallbackCounter counter;
+  Error err = runner.generate(
+      "test prompt", config, [&counter](const std::string& token) {
+        counter.callback(token);
+      });
+  EXPECT_EQ(err, Error::Ok);
+  EXPECT_EQ(counter.getCount(), 300);
+
+  // Without a limit, generation goes on until it is stopped.
+  config.max_new_tokens = -1;
+  int count = 0;
+  err = runner.generate("test prompt", config, [&](const std::string&) {
+    if (++count == 1000) {
+      runner.stop();
+    }
+  });
+  EXPECT_EQ(err, Error::Ok);
+  EXPECT_EQ(count, 1000);
+}
+
+// Test that only kUnboundedNewTokens generates without a limit
+TEST_F(RunnerTest, TokenGeneratorUnboundedOnlyForSentinel) {
+  auto tokenizer = createMockTokenizer();
+  auto text_decoder_runner = createMockTextDecoderRunner();
+  Stats stats;
+  auto text_token_generator = createTextTokenGenerator(
+      tokenizer.get(), text_decoder_runner.get(), &stats);
+
+  // A budget of 0 tokens left, as when prefill produced the only one, and
+  // other negative values generate nothing.
+  EXPECT_CALL(*text_decoder_runner, step(_, _)).Times(0);
+  for (int32_t max_new_tokens : {0, -1, -5}) {
+    auto result = text_token_generator->generate({4}, 10, max_new_tokens);
+    ASSERT_TRUE(result.ok());
+    EXPECT_EQ(result.get(), 0);
+  }
+  Mock::VerifyAndClearExpectations(text_decoder_runner.get());
+
+  int count = 0;
+  auto result = text_token_generator->generate(
+      {4},
+      10,
+      TextTokenGenerator::kUnboundedNewTokens,
+      0.0f,
+      [&](const std::string&) {
+        if (++count == 500) {
+          text_token_generator->stop();
+        }
+      });
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.get(), 500);
+}
+
 } // namespace
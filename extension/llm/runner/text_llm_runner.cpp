@@ -20,6 +20,8 @@
 #include <pytorch/tokenizers/sentencepiece.h>
 #include <pytorch/tokenizers/tiktoken.h>
 
+#include <limits>
+
 namespace executorch::extension::llm {
 
 using ::executorch::extension::Module;
@@ -110,8 +112,15 @@ Error TextLLMRunner::generate(
   stats_->inference_start_ms = time_in_ms();
   shouldStop_ = false;
 
-  // Capture remaining KV cache capacity before prefill (pos_ will change)
-  int64_t max_context_len = metadata_.at(kMaxContextLen) - pos_;
+  // Capture remaining KV cache capacity before prefill (pos_ will change). A
+  // ring buffer KV cache keeps the last positions only, so the context is not
+  // bounded by its size.
+  const auto ring_kv_cache = metadata_.find(kUseRingKVCache);
+  const bool use_ring_kv_cache =
+      ring_kv_cache != metadata_.end() && ring_kv_cache->second;
+  int64_t max_context_len = use_ring_kv_cache
+      ? std::numeric_limits<int32_t>::max()
+      : metadata_.at(kMaxContextLen) - pos_;
 
   uint64_t cur_token = 0;
   int num_prompt_tokens = 0;
@@ -212,10 +221,13 @@ Error TextLLMRunner::generate(
   text_token_generator_->set_ignore_eos(config.ignore_eos);
 
   // Generate max_new_tokens - 1 because prefill already generated 1 token.
+  // Without a limit, a ring buffer KV cache generates until EOS or stop().
+  const bool unbounded = use_ring_kv_cache && config.max_new_tokens == -1 &&
+      config.seq_len == -1;
   auto generate_result = text_token_generator_->generate(
       prompt_tokens,
       pos_,
-      max_new_tokens - 1,
+      unbounded ? TextTokenGenerator::kUnboundedNewTokens : max_new_tokens - 1,
       temperature_ == -1.0f ? config.temperature : temperature_,
       wrapped_callback);
   if (!generate_result.ok()) {
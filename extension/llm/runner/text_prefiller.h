@@ -43,11 +43,14 @@ class ET_EXPERIMENTAL TextPrefiller {
    * @param prompt_tokens The chunk of text prompt tokens to process.
    * @param start_pos The starting position in KV cache of the input in the LLM
    * Module.
+   * @param temperature The temperature to sample the next token at; 0 takes
+   * the most likely token.
    * @return The next token of the LLM Module after prefilling this chunk.
    */
   virtual ::executorch::runtime::Result<uint64_t> prefill_chunk(
       std::vector<uint64_t>& prompt_tokens,
-      int64_t& start_pos);
+      int64_t& start_pos,
+      float temperature = 0.0f);
 
   /**
    * Load the necessary resources for the TextPrefiller.
@@ -66,6 +69,13 @@ class ET_EXPERIMENTAL TextPrefiller {
     return text_decoder_runner_->is_method_loaded();
   }
 
+  /**
+   * The most tokens that prefill_chunk() takes at once.
+   */
+  int64_t max_seq_len() const {
+    return max_seq_len_;
+  }
+
  private:
   /**
    * Note: TextPrefiller does not own the TextDecoderRunner instance.
@@ -14,12 +14,21 @@
 #include <executorch/extension/tensor/tensor.h>
 #include <pytorch/tokenizers/tokenizer.h>
 
+#include <limits>
+
 namespace executorch {
 namespace extension {
 namespace llm {
 
 class ET_EXPERIMENTAL TextTokenGenerator {
  public:
+  /**
+   * Pass as max_new_tokens to generate until EOS or stop(), which needs a
+   * model whose KV cache is a ring buffer.
+   */
+  static constexpr int32_t kUnboundedNewTokens =
+      std::numeric_limits<int32_t>::max();
+
   TextTokenGenerator(
       ::tokenizers::Tokenizer* tokenizer,
       TextDecoderRunner* text_decoder_runner,
@@ -44,7 +53,8 @@ class ET_EXPERIMENTAL TextTokenGenerator {
    * the prompt tokens + the first token generated by prefill.
    * @param start_pos The start position of the new tokens, based on how many
    * prompt tokens is prefilled.
-   * @param max_new_tokens Maximum number of new tokens to generate.
+   * @param max_new_tokens Maximum number of new tokens to generate, or
+   * kUnboundedNewTokens. Nothing is generated if it is not positive.
    * @param temperature controls the randomness of predictions by scaling the
    * logits before applying softmax. A higher temperature results in more
    * random predictions, while a lower temperature results in more deterministic
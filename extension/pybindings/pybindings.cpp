@@ -7,10 +7,17 @@
  */
 
 #include <algorithm>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <pybind11/iostream.h>
 #include <pybind11/pybind11.h>
@@ -106,6 +113,7 @@ using torch::executor::ETDumpGen;
 #ifndef USE_ATEN_LIB
 using ::executorch::extension::alias_attensor_to_etensor;
 using ::executorch::extension::alias_etensor_to_attensor;
+using ::executorch::extension::executorch_to_torch_scalar_type;
 using ::executorch::extension::torch_to_executorch_scalar_type;
 #endif // !USE_ATEN_LIB
 
@@ -272,13 +280,78 @@ inline std::unique_ptr<Module> load_module_from_data_loader(
       nullptr); // data_map_loader
 }
 
-inline py::list get_outputs_as_py_list(
+// Returns an at::Tensor that aliases `tensor` and keeps `owner`, which owns
+// the memory of `tensor`, alive for as long as the alias is alive.
+at::Tensor alias_tensor_with_owner(
+    const executorch::aten::Tensor& tensor,
+    std::shared_ptr<void> owner) {
+  const auto keep_owner_alive = [owner = std::move(owner)](void*) {};
+#ifdef USE_ATEN_LIB
+  return at::from_blob(
+      tensor.mutable_data_ptr(),
+      tensor.sizes(),
+      tensor.strides(),
+      keep_owner_alive,
+      tensor.options());
+#else
+  std::vector<int64_t> sizes(tensor.sizes().begin(), tensor.sizes().end());
+  std::vector<int64_t> strides(
+      tensor.strides().begin(), tensor.strides().end());
+  return at::from_blob(
+      tensor.mutable_data_ptr(),
+      sizes,
+      strides,
+      keep_owner_alive,
+      at::TensorOptions(executorch_to_torch_scalar_type(tensor.scalar_type())));
+#endif
+}
+
+/**
+ * The outputs of an execution, with the tensors converted to at::Tensors.
+ * Creating them does not need the GIL, so that the outputs can be cloned
+ * before the next execution of the method overwrites them, without waiting
+ * for the GIL.
+ */
+struct ExecutionOutputs {
+  std::vector<EValue> values;
+  // Defined for the tensor outputs only.
+  std::vector<at::Tensor> tensors;
+};
+
+// Clones the tensor outputs if `clone_outputs`, and aliases them otherwise.
+// An alias keeps `owner` alive if it is not null.
+ExecutionOutputs convert_outputs(
     const std::vector<EValue>& outputs,
-    bool clone_outputs = true) {
-  const auto outputs_size = outputs.size();
+    bool clone_outputs,
+    std::shared_ptr<void> owner = nullptr) {
+  ExecutionOutputs result{outputs, std::vector<at::Tensor>(outputs.size())};
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    if (Tag::Tensor != outputs[i].tag) {
+      continue;
+    }
+    const auto& tensor = outputs[i].toTensor();
+    if (owner != nullptr && !clone_outputs) {
+      result.tensors[i] = alias_tensor_with_owner(tensor, owner);
+      continue;
+    }
+#ifdef USE_ATEN_LIB
+    // Clone so the outputs in python do not share a lifetime with the
+    // module object
+    result.tensors[i] = clone_outputs ? tensor.clone() : tensor;
+#else
+    result.tensors[i] = clone_outputs
+        ? alias_attensor_to_etensor(tensor).clone()
+        : alias_attensor_to_etensor(tensor);
+#endif
+  }
+  return result;
+}
+
+py::list outputs_to_py_list(const ExecutionOutputs& outputs) {
+  const auto outputs_size = outputs.values.size();
   py::list list(outputs_size);
   for (size_t i = 0; i < outputs_size; ++i) {
-    auto& v = outputs[i];
+    auto& v = outputs.values[i];
     if (Tag::None == v.tag) {
       list[i] = py::none();
     } else if (Tag::Int == v.tag) {
@@ -290,28 +363,308 @@ inline py::list get_outputs_as_py_list(
     } else if (Tag::String == v.tag) {
       list[i] = py::cast(std::string(v.toString().data()));
     } else if (Tag::Tensor == v.tag) {
+      list[i] = py::cast(outputs.tensors[i]);
+    } else {
+      ET_ASSERT_UNREACHABLE_MSG("Invalid model output type");
+    }
+  }
+  return list;
+}
+
+inline py::list get_outputs_as_py_list(
+    const std::vector<EValue>& outputs,
+    bool clone_outputs = true) {
+  return outputs_to_py_list(convert_outputs(outputs, clone_outputs));
+}
+
+// Returns the dtype of the elements of a buffer, if it is supported.
+std::optional<at::ScalarType> buffer_scalar_type(const py::buffer_info& info) {
+  if (info.format == "e") {
+    return at::ScalarType::Half;
+  } else if (info.item_type_is_equivalent_to<float>()) {
+    return at::ScalarType::Float;
+  } else if (info.item_type_is_equivalent_to<double>()) {
+    return at::ScalarType::Double;
+  } else if (info.item_type_is_equivalent_to<bool>()) {
+    return at::ScalarType::Bool;
+  } else if (info.item_type_is_equivalent_to<int8_t>()) {
+    return at::ScalarType::Char;
+  } else if (info.item_type_is_equivalent_to<uint8_t>()) {
+    return at::ScalarType::Byte;
+  } else if (info.item_type_is_equivalent_to<int16_t>()) {
+    return at::ScalarType::Short;
+  } else if (info.item_type_is_equivalent_to<int32_t>()) {
+    return at::ScalarType::Int;
+  } else if (info.item_type_is_equivalent_to<int64_t>()) {
+    return at::ScalarType::Long;
+  }
+  return std::nullopt;
+}
+
+/**
+ * Returns `input` as an at::Tensor that shares its memory, if it is a
+ * torch.Tensor, supports DLPack (e.g. numpy arrays) or exposes its memory
+ * through the buffer protocol (e.g. array.array or memoryview). The buffers
+ * that are viewed are added to `buffers`, which must outlive the tensor.
+ */
+std::optional<at::Tensor> as_at_tensor(
+    const py::handle& input,
+    std::vector<py::buffer_info>& buffers) {
+  const std::string& type_str = py::str(input.get_type());
+  if (type_str == "<class 'torch.Tensor'>") {
+    return input.cast<at::Tensor>();
+  }
+  if (py::hasattr(input, "__dlpack__")) {
+    return py::module_::import("torch")
+        .attr("from_dlpack")(input)
+        .cast<at::Tensor>();
+  }
+  if (!py::isinstance<py::buffer>(input)) {
+    return std::nullopt;
+  }
+  py::buffer_info info = py::reinterpret_borrow<py::buffer>(input).request();
+  const auto scalar_type = buffer_scalar_type(info);
+  if (!scalar_type.has_value()) {
+    throw std::runtime_error(
+        "Unsupported buffer format '" + info.format + "'");
+  }
+  std::vector<int64_t> sizes(info.shape.begin(), info.shape.end());
+  std::vector<int64_t> strides;
+  for (const auto stride : info.strides) {
+    if (stride % info.itemsize != 0) {
+      throw std::runtime_error(
+          "Buffer strides must be a multiple of the item size");
+    }
+    strides.push_back(stride / info.itemsize);
+  }
+  at::Tensor tensor = at::from_blob(
+      info.ptr, sizes, strides, at::TensorOptions(*scalar_type));
+  buffers.push_back(std::move(info));
+  return tensor;
+}
+
+/**
+ * The inputs of an execution, converted from python objects. The tensors
+ * alias the memory of the python objects, which are kept alive. Must be
+ * destroyed with the GIL held.
+ */
+struct MethodInputs {
+  std::vector<EValue> values;
+  std::vector<at::Tensor> at_tensors;
+  std::vector<py::buffer_info> buffers;
+#ifndef USE_ATEN_LIB // Portable mode
+  // So the ETensors and their metadata stay in scope for the execution.
+  std::vector<torch::executor::TensorImpl> tensor_impls;
+  std::vector<std::vector<torch::executor::Tensor::SizesType>> sizes;
+  std::vector<std::vector<torch::executor::Tensor::StridesType>> strides;
+  std::vector<std::vector<torch::executor::Tensor::DimOrderType>> dim_orders;
+#endif
+};
+
+std::unique_ptr<MethodInputs> prepare_method_inputs(
+    const std::string& method_name,
+    const py::sequence& inputs) {
+  const auto inputs_size = py::len(inputs);
+  auto result = std::make_unique<MethodInputs>();
+  result->values.reserve(inputs_size);
+#ifndef USE_ATEN_LIB // Portable mode
+  // We store pointers to these vector elements so important to reserve so
+  // that we don't lose those on a vector resize. Don't need to do this for
+  // the others since they are vectors of vectors, and we don't store a
+  // pointer to the root level vector data.
+  result->tensor_impls.reserve(inputs_size);
+#endif
+
+  // Convert python objects into EValues.
+  for (size_t i = 0; i < inputs_size; ++i) {
+    py::object python_input = inputs[i];
+    if (auto maybe_tensor = as_at_tensor(python_input, result->buffers)) {
+      result->at_tensors.push_back(*maybe_tensor);
+      auto& at_tensor = result->at_tensors.back();
+
 #ifdef USE_ATEN_LIB
-      // Clone so the outputs in python do not share a lifetime with the
-      // module object
-      if (clone_outputs) {
-        list[i] = py::cast(v.toTensor().clone());
-      } else {
-        list[i] = py::cast(v.toTensor());
-      }
+      EValue evalue(at_tensor);
 #else
-      if (clone_outputs) {
-        list[i] = py::cast(alias_attensor_to_etensor(v.toTensor()).clone());
+      // convert at::Tensor to torch::executor::Tensor
+      auto type = torch_to_executorch_scalar_type(at_tensor.options().dtype());
+      size_t dim = at_tensor.dim();
+      // cant directly alias at::Tensor sizes and strides due to int64 vs
+      // int32 typing conflict
+      result->sizes.emplace_back(
+          at_tensor.sizes().begin(), at_tensor.sizes().end());
+      result->strides.emplace_back(
+          at_tensor.strides().begin(), at_tensor.strides().end());
+
+      // Only works for MemoryFormat::Contiguous or MemoryFormat::ChannelsLast
+      // inputs
+      std::vector<torch::executor::Tensor::DimOrderType> dim_order;
+      if (at_tensor.is_contiguous()) {
+        for (size_t cur_dim = 0; cur_dim < dim; cur_dim++) {
+          dim_order.push_back(cur_dim);
+        }
+      } else if (
+          at_tensor.is_contiguous(at::MemoryFormat::ChannelsLast) &&
+          at_tensor.dim() == 4) {
+        dim_order = decltype(dim_order)({0, 2, 3, 1});
       } else {
-        list[i] = py::cast(alias_attensor_to_etensor(v.toTensor()));
+        auto error_msg = "Input " + std::to_string(i) + "for method " +
+            method_name + " should be contiguous or channels-last.";
+        throw std::runtime_error(error_msg);
       }
+      result->dim_orders.push_back(std::move(dim_order));
+      result->tensor_impls.emplace_back(
+          type,
+          dim,
+          result->sizes.back().data(),
+          nullptr,
+          result->dim_orders.back().data(),
+          result->strides.back().data());
+
+      torch::executor::Tensor temp =
+          torch::executor::Tensor(&result->tensor_impls.back());
+      alias_etensor_to_attensor(at_tensor, temp);
+      EValue evalue(temp);
 #endif
+
+      result->values.push_back(evalue);
+    } else if (py::isinstance<py::none>(python_input)) {
+      result->values.push_back(EValue());
+    } else if (py::isinstance<py::bool_>(python_input)) {
+      result->values.push_back(EValue(py::cast<bool>(python_input)));
+    } else if (py::isinstance<py::int_>(python_input)) {
+      result->values.push_back(EValue(py::cast<int64_t>(python_input)));
     } else {
-      ET_ASSERT_UNREACHABLE_MSG("Invalid model output type");
+      const std::string& type_str = py::str(python_input.get_type());
+      throw std::runtime_error(
+          "Unsupported python type " + type_str +
+          ". Ensure that inputs are passed as a flat list of tensors.");
     }
   }
-  return list;
+  return result;
 }
 
+/**
+ * Runs the tasks submitted to it in order, on a thread of its own that is
+ * started by the first submission. Destroying the executor waits for the
+ * thread with the GIL released, unless the executor is destroyed by a task on
+ * that thread, e.g. one that drops the last reference to the executor's owner.
+ * The threads of all executors are stopped by shutdown_all() at interpreter
+ * exit, since a thread that acquires the GIL after finalization hangs.
+ */
+class SerialExecutor final {
+ public:
+  SerialExecutor() : state_(std::make_shared<State>()) {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    registry().push_back(state_.get());
+  }
+
+  SerialExecutor(const SerialExecutor&) = delete;
+  SerialExecutor& operator=(const SerialExecutor&) = delete;
+
+  ~SerialExecutor() {
+    {
+      std::lock_guard<std::mutex> lock(registry_mutex());
+      auto& states = registry();
+      states.erase(
+          std::remove(states.begin(), states.end(), state_.get()), states.end());
+    }
+    join(stop(*state_));
+  }
+
+  // `task` runs without the GIL, and is destroyed with the GIL held.
+  void submit(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->stopped) {
+      throw std::runtime_error("The interpreter is shutting down");
+    }
+    state_->tasks.push_back(std::move(task));
+    if (!state_->thread.joinable()) {
+      state_->thread = std::thread([state = state_]() { run(*state); });
+    }
+    state_->condition.notify_one();
+  }
+
+  // Waits for the tasks of every executor to finish and stops their threads.
+  // Registered with atexit, so it is called with the GIL held.
+  static void shutdown_all() {
+    std::vector<std::thread> threads;
+    {
+      std::lock_guard<std::mutex> lock(registry_mutex());
+      for (State* state : registry()) {
+        threads.push_back(stop(*state));
+      }
+    }
+    for (auto& thread : threads) {
+      join(std::move(thread));
+    }
+  }
+
+ private:
+  struct State {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::function<void()>> tasks;
+    std::thread thread;
+    bool stopped = false;
+  };
+
+  static std::mutex& registry_mutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  // The states of the live executors.
+  static std::vector<State*>& registry() {
+    static std::vector<State*> states;
+    return states;
+  }
+
+  // Asks the thread to exit once it is idle, and returns it.
+  static std::thread stop(State& state) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.stopped = true;
+    state.condition.notify_all();
+    return std::move(state.thread);
+  }
+
+  static void join(std::thread thread) {
+    if (!thread.joinable()) {
+      return;
+    }
+    if (thread.get_id() == std::this_thread::get_id()) {
+      // Destroyed by its own task; the thread exits after that task.
+      thread.detach();
+    } else if (PyGILState_Check()) {
+      // The remaining tasks need the GIL.
+      py::gil_scoped_release no_gil;
+      thread.join();
+    } else {
+      thread.join();
+    }
+  }
+
+  static void run(State& state) {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.condition.wait(
+            lock, [&state]() { return state.stopped || !state.tasks.empty(); });
+        if (state.tasks.empty()) {
+          return;
+        }
+        task = std::move(state.tasks.front());
+        state.tasks.pop_front();
+      }
+      task();
+      py::gil_scoped_acquire gil;
+      task = nullptr;
+    }
+  }
+
+  std::shared_ptr<State> state_;
+};
+
 static constexpr size_t kDEFAULT_BUNDLED_INPUT_POOL_SIZE = 16 * 1024U;
 
 struct PyBundledModule : public BundledModule {
@@ -724,119 +1077,102 @@ struct PyModule final {
         std::move(loader), data_path, enable_etdump, debug_buffer_size);
   }
 
+  /**
+   * Runs a method. With `release_gil`, the GIL is released while the method
+   * executes, so that other python threads can run meanwhile; the output of
+   * the runtime is then not redirected to python's sys.stdout/sys.stderr.
+   *
+   * Tensor inputs share the memory of the python objects. Unless
+   * `clone_outputs`, tensor outputs share the memory of the method: they
+   * keep the module alive, and are overwritten by its next execution.
+   */
   py::list run_method(
+      const std::string& method_name,
+      const py::sequence& inputs,
+      bool clone_outputs = true,
+      bool release_gil = false) {
+    std::optional<py::scoped_ostream_redirect> redirect_stdout;
+    std::optional<py::scoped_estream_redirect> redirect_stderr;
+    if (!release_gil) {
+      redirect_stdout.emplace();
+      redirect_stderr.emplace();
+    }
+    const auto method_inputs = prepare_method_inputs(method_name, inputs);
+    ExecutionOutputs outputs;
+    if (release_gil) {
+      py::gil_scoped_release no_gil;
+      outputs = execute(method_name, method_inputs->values, clone_outputs);
+    } else {
+      outputs = execute(method_name, method_inputs->values, clone_outputs);
+    }
+    return outputs_to_py_list(outputs);
+  }
+
+  /**
+   * Like run_method() with `release_gil`, but returns a
+   * concurrent.futures.Future of the outputs immediately; await it in
+   * asyncio with asyncio.wrap_future(). The executions of a module run one
+   * at a time in submission order, on a thread owned by the module. The
+   * inputs must not be modified until the future is done.
+   */
+  static py::object run_method_async(
+      const py::object& self,
       const std::string& method_name,
       const py::sequence& inputs,
       bool clone_outputs = true) {
-    const auto inputs_size = py::len(inputs);
-    std::vector<EValue> cpp_inputs;
-    cpp_inputs.reserve(inputs_size);
-
-#ifndef USE_ATEN_LIB // Portable mode
-    // So the ETensors and their metadata stay in scope for
-    // Module->run_method.
-    std::vector<torch::executor::TensorImpl> input_tensors;
-    std::vector<std::vector<torch::executor::Tensor::SizesType>> input_sizes;
-    std::vector<std::vector<torch::executor::Tensor::StridesType>>
-        input_strides;
-    std::vector<std::vector<torch::executor::Tensor::DimOrderType>>
-        input_dim_order;
-    // We store pointers to these vector elements so important to reserve so
-    // that we don't lose those on a vector resize. Don't need to do this for
-    // the others since they are vectors of vectors, and we don't store a
-    // pointer to the root level vector data.
-    input_tensors.reserve(inputs_size);
-#endif
-
-    // Convert python objects into EValues.
-    for (size_t i = 0; i < inputs_size; ++i) {
-      auto python_input = inputs[i];
-      const std::string& type_str = py::str(python_input.get_type());
-      if (type_str == "<class 'torch.Tensor'>") {
-        auto at_tensor = python_input.cast<at::Tensor>();
-
-#ifdef USE_ATEN_LIB
-        EValue evalue(at_tensor);
-#else
-        // convert at::Tensor to torch::executor::Tensor
-        auto type =
-            torch_to_executorch_scalar_type(at_tensor.options().dtype());
-        size_t dim = at_tensor.dim();
-        // cant directly alias at::Tensor sizes and strides due to int64 vs
-        // int32 typing conflict
-        input_sizes.emplace_back(
-            at_tensor.sizes().begin(), at_tensor.sizes().end());
-        input_strides.emplace_back(
-            at_tensor.strides().begin(), at_tensor.strides().end());
-
-        // Only works for MemoryFormat::Contiguous or MemoryFormat::ChannelsLast
-        // inputs
-        std::vector<torch::executor::Tensor::DimOrderType> dim_order;
-        if (at_tensor.is_contiguous()) {
-          for (size_t cur_dim = 0; cur_dim < dim; cur_dim++) {
-            dim_order.push_back(cur_dim);
+    PyModule* module = &self.cast<PyModule&>();
+    std::shared_ptr<MethodInputs> method_inputs =
+        prepare_method_inputs(method_name, inputs);
+    py::object future =
+        py::module_::import("concurrent.futures").attr("Future")();
+    // The task keeps `self`, and thus `module`, alive.
+    module->async_executor_.submit(
+        [self, module, future, method_inputs, method_name, clone_outputs]() {
+          py::gil_scoped_acquire gil;
+          // Nothing may escape the executor thread, not even a failure to
+          // report a failure on a future that is already done.
+          auto set_exception = [&future](const py::object& exception) {
+            try {
+              future.attr("set_exception")(exception);
+            } catch (py::error_already_set&) {
+            }
+          };
+          try {
+            if (!future.attr("set_running_or_notify_cancel")().cast<bool>()) {
+              return;
+            }
+            std::optional<ExecutionOutputs> outputs;
+            {
+              py::gil_scoped_release no_gil;
+              outputs = module->execute(
+                  method_name, method_inputs->values, clone_outputs);
+            }
+            future.attr("set_result")(outputs_to_py_list(*outputs));
+          } catch (py::error_already_set& e) {
+            set_exception(e.value());
+          } catch (const std::exception& e) {
+            set_exception(
+                py::reinterpret_borrow<py::object>(PyExc_RuntimeError)(
+                    e.what()));
           }
-        } else if (
-            at_tensor.is_contiguous(at::MemoryFormat::ChannelsLast) &&
-            at_tensor.dim() == 4) {
-          dim_order = decltype(dim_order)({0, 2, 3, 1});
-        } else {
-          auto error_msg = "Input " + std::to_string(i) + "for method " +
-              method_name + " should be contiguous or channels-last.";
-          throw std::runtime_error(error_msg);
-        }
-        input_dim_order.push_back(std::move(dim_order));
-        input_tensors.emplace_back(
-            type,
-            dim,
-            input_sizes.back().data(),
-            nullptr,
-            input_dim_order.back().data(),
-            input_strides.back().data());
-
-        torch::executor::Tensor temp =
-            torch::executor::Tensor(&input_tensors.back());
-        alias_etensor_to_attensor(at_tensor, temp);
-        EValue evalue(temp);
-#endif
-
-        cpp_inputs.push_back(evalue);
-      } else if (py::isinstance<py::none>(python_input)) {
-        cpp_inputs.push_back(EValue());
-      } else if (py::isinstance<py::bool_>(python_input)) {
-        cpp_inputs.push_back(EValue(py::cast<bool>(python_input)));
-      } else if (py::isinstance<py::int_>(python_input)) {
-        cpp_inputs.push_back(EValue(py::cast<int64_t>(python_input)));
-      } else {
-        throw std::runtime_error(
-            "Unsupported python type " + type_str +
-            ". Ensure that inputs are passed as a flat list of tensors.");
-      }
-    }
-
-    // Set up output storage before execution.
-    allocate_output_tensors(method_name);
-    auto outputs = module_->execute(method_name, cpp_inputs);
-    THROW_IF_ERROR(
-        outputs.error(),
-        "Failed to execute method %s, error: 0x%" PRIx32,
-        method_name.c_str(),
-        static_cast<uint32_t>(outputs.error()));
-
-    // Retrieve outputs
-    return get_outputs_as_py_list(outputs.get(), clone_outputs);
+        });
+    return future;
   }
 
-  py::list forward(const py::sequence& inputs, bool clone_outputs = true) {
-    return run_method("forward", inputs, clone_outputs);
+  py::list forward(
+      const py::sequence& inputs,
+      bool clone_outputs = true,
+      bool release_gil = false) {
+    return run_method("forward", inputs, clone_outputs, release_gil);
   }
 
   py::list forward_single_input(
       const torch::Tensor& inputTensor,
-      bool clone_outputs = true) {
+      bool clone_outputs = true,
+      bool release_gil = false) {
     py::list py_list;
     py_list.append(py::cast(inputTensor));
-    return run_method("forward", py_list, clone_outputs);
+    return run_method("forward", py_list, clone_outputs, release_gil);
   }
 
   bool has_etdump() {
@@ -876,6 +1212,7 @@ struct PyModule final {
   py::list plan_execute(
       const std::string method_name,
       bool clone_outputs = true) {
+    const auto lock = lock_execution();
     auto status = module_->load_method(method_name);
 
     THROW_IF_ERROR(
@@ -919,6 +1256,54 @@ struct PyModule final {
   // Need to keep-alive output tensors until they can be compared in case of
   // bundled programs.
   std::vector<std::optional<TensorPtr>> output_tensors_;
+  // Serializes the executions of the module, which may run without the GIL.
+  std::mutex execution_mutex_;
+  // Runs the executions of run_method_async().
+  SerialExecutor async_executor_;
+
+  // Keeps the memory that the uncloned tensor outputs of an execution alias
+  // alive: the module, whose planned memory holds most outputs, and the
+  // storage allocated for the outputs that are not memory planned.
+  struct OutputsOwner {
+    std::shared_ptr<Module> module;
+    std::vector<std::optional<TensorPtr>> output_tensors;
+  };
+
+  // Locks execution_mutex_. If another execution holds it, waits without the
+  // GIL, so that the other execution can finish if it needs the GIL.
+  std::unique_lock<std::mutex> lock_execution() {
+    std::unique_lock<std::mutex> lock(execution_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      if (PyGILState_Check()) {
+        py::gil_scoped_release no_gil;
+        lock.lock();
+      } else {
+        lock.lock();
+      }
+    }
+    return lock;
+  }
+
+  // Executes a method and converts its outputs, which does not need the GIL.
+  ExecutionOutputs execute(
+      const std::string& method_name,
+      const std::vector<EValue>& inputs,
+      bool clone_outputs) {
+    const auto lock = lock_execution();
+    // Set up output storage before execution.
+    allocate_output_tensors(method_name);
+    auto outputs = module_->execute(method_name, inputs);
+    THROW_IF_ERROR(
+        outputs.error(),
+        "Failed to execute method %s, error: 0x%" PRIx32,
+        method_name.c_str(),
+        static_cast<uint32_t>(outputs.error()));
+    return convert_outputs(
+        outputs.get(),
+        clone_outputs,
+        std::make_shared<OutputsOwner>(
+            OutputsOwner{module_, output_tensors_}));
+  }
 
   // Set debug buffer for potential event tracer.
   std::unique_ptr<torch::executor::ETDumpGen> setup_event_tracer(
@@ -1578,6 +1963,10 @@ PYBIND11_MODULE(EXECUTORCH_PYTHON_MODULE_NAME, m) {
       py::arg("non_const_pool_size") = kDEFAULT_BUNDLED_INPUT_POOL_SIZE,
       call_guard);
 
+  // Stops the threads of run_method_async() before the interpreter finalizes.
+  py::module_::import("atexit").attr("register")(
+      py::cpp_function(&SerialExecutor::shutdown_all));
+
   // Import the PyDataLoader type from the shared module.
   // This ensures the type is registered once and shared across all modules.
   py::module_::import("executorch.extension.pybindings.data_loader");
@@ -1641,19 +2030,27 @@ PYBIND11_MODULE(EXECUTORCH_PYTHON_MODULE_NAME, m) {
           py::arg("method_name"),
           call_guard)
       .def("method_names", &PyModule::method_names, call_guard)
+      // The methods that execute the module redirect cout and cerr themselves,
+      // since the redirection is not thread safe without the GIL.
       .def(
           "run_method",
           &PyModule::run_method,
           py::arg("method_name"),
           py::arg("inputs") = py::list(),
           py::arg("clone_outputs") = true,
-          call_guard)
+          py::arg("release_gil") = false)
+      .def(
+          "run_method_async",
+          &PyModule::run_method_async,
+          py::arg("method_name"),
+          py::arg("inputs") = py::list(),
+          py::arg("clone_outputs") = true)
       .def(
           "forward",
           &PyModule::forward,
           py::arg("inputs") = py::list(),
           py::arg("clone_outputs") = true,
-          call_guard)
+          py::arg("release_gil") = false)
       .def("has_etdump", &PyModule::has_etdump, call_guard)
       .def(
           "write_etdump_result_to_file",
@@ -1666,13 +2063,13 @@ PYBIND11_MODULE(EXECUTORCH_PYTHON_MODULE_NAME, m) {
           &PyModule::forward,
           py::arg("inputs") = py::list(),
           py::arg("clone_outputs") = true,
-          call_guard)
+          py::arg("release_gil") = false)
       .def(
           "__call__",
           &PyModule::forward_single_input,
           py::arg("inputs") = py::list(),
           py::arg("clone_outputs") = true,
-          call_guard);
+          py::arg("release_gil") = false);
 
   py::class_<PyBundledModule>(m, "BundledModule")
       .def(
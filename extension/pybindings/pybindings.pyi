@@ -7,6 +7,7 @@
 # pyre-strict
 from __future__ import annotations
 
+import concurrent.futures
 from typing import Any, Dict, Enum, List, Optional, Sequence, Tuple
 
 from executorch.exir._warnings import experimental
@@ -33,19 +34,53 @@ class ExecuTorchModule:
     """
 
     # pyre-ignore[2, 3]: "Any" in parameter and return type annotations.
-    def __call__(self, inputs: Any, clone_outputs: bool = True) -> List[Any]: ...
+    def __call__(
+        self, inputs: Any, clone_outputs: bool = True, release_gil: bool = False
+    ) -> List[Any]: ...
     # pyre-ignore[2, 3]: "Any" in parameter and return type annotations.
     def run_method(
         self,
         method_name: str,
         inputs: Sequence[Any],  # pyre-ignore[2]: "Any" in parameter type annotations.
         clone_outputs: bool = True,
-    ) -> List[Any]: ...
+        release_gil: bool = False,
+    ) -> List[Any]:
+        """Runs a method.
+
+        Tensor inputs may be torch.Tensors, objects that support DLPack (e.g.
+        numpy arrays) or objects that expose a buffer; their memory is used
+        without a copy.
+
+        Args:
+            clone_outputs: If False, the tensor outputs share the memory of the
+                method instead of being copied. They keep the module alive,
+                and are overwritten by the next execution of the method.
+            release_gil: Release the GIL while the method executes, so that
+                other Python threads can run. The executions of a module still
+                run one at a time. The output of the runtime is then not
+                redirected to sys.stdout and sys.stderr.
+        """
+        ...
+    # pyre-ignore[2, 3]: "Any" in parameter and return type annotations.
+    def run_method_async(
+        self,
+        method_name: str,
+        inputs: Sequence[Any],  # pyre-ignore[2]: "Any" in parameter type annotations.
+        clone_outputs: bool = True,
+    ) -> concurrent.futures.Future[List[Any]]:
+        """Runs a method without the GIL on a thread owned by the module, and
+        returns a future of its outputs. Use asyncio.wrap_future() to await it.
+
+        The executions of a module run one at a time, in submission order. The
+        inputs must not be modified until the future is done.
+        """
+        ...
     # pyre-ignore[2, 3]: "Any" in parameter and return type annotations.
     def forward(
         self,
         inputs: Sequence[Any],  # pyre-ignore[2]: "Any" in parameter type annotations.
         clone_outputs: bool = True,
+        release_gil: bool = False,
     ) -> List[Any]: ...
     # pyre-ignore[2, 3]: "Any" in parameter and return type annotations.
     def plan_execute(
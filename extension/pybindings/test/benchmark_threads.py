@@ -0,0 +1,132 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-unsafe
+
+"""Measures the inference throughput of the pybindings from Python threads.
+
+Each thread serves requests with a module of its own, loaded from the same
+program, as a serving process with several model replicas would. Every
+request also does some Python work, standing in for pre- and post-processing.
+The executions overlap each other and the Python work only when the GIL is
+released.
+
+    python -m executorch.extension.pybindings.test.benchmark_threads \\
+        --threads 1 2 4 8
+"""
+
+import argparse
+import asyncio
+import concurrent.futures
+import time
+
+import torch
+
+from executorch.extension.pybindings import portable_lib as runtime
+from executorch.extension.pybindings.test.make_test import create_program
+
+
+class ModuleMLP(torch.nn.Module):
+    def __init__(self, dim: int, hidden_dim: int):
+        super().__init__()
+        self.dim = dim
+        self.up = torch.nn.Linear(dim, hidden_dim)
+        self.down = torch.nn.Linear(hidden_dim, dim)
+
+    def forward(self, x: torch.Tensor):
+        return self.down(torch.relu(self.up(x)))
+
+    def get_methods_to_export(self):
+        return ("forward",)
+
+    def get_inputs(self):
+        return (torch.randn(8, self.dim),)
+
+
+def python_work(iterations: int) -> int:
+    total = 0
+    for i in range(iterations):
+        total += i * i
+    return total
+
+
+def run_threads(modules, inputs, mode: str, requests: int, args) -> float:
+    """Returns the number of requests served per second."""
+
+    def serve(module) -> None:
+        for _ in range(requests):
+            python_work(args.python_work)
+            module.forward(
+                inputs,
+                clone_outputs=args.clone_outputs,
+                release_gil=mode == "release_gil",
+            )
+
+    start = time.perf_counter()
+    with concurrent.futures.ThreadPoolExecutor(max_workers=len(modules)) as pool:
+        for future in [pool.submit(serve, module) for module in modules]:
+            future.result()
+    return len(modules) * requests / (time.perf_counter() - start)
+
+
+def run_async(modules, inputs, requests: int, args) -> float:
+    """Returns the number of requests served per second."""
+
+    async def serve(module) -> None:
+        for _ in range(requests):
+            python_work(args.python_work)
+            await asyncio.wrap_future(
+                module.run_method_async(
+                    "forward", inputs, clone_outputs=args.clone_outputs
+                )
+            )
+
+    async def serve_all() -> None:
+        await asyncio.gather(*[serve(module) for module in modules])
+
+    start = time.perf_counter()
+    asyncio.run(serve_all())
+    return len(modules) * requests / (time.perf_counter() - start)
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4, 8])
+    parser.add_argument("--requests", type=int, default=200)
+    parser.add_argument("--dim", type=int, default=256)
+    parser.add_argument("--hidden_dim", type=int, default=1024)
+    parser.add_argument(
+        "--python_work",
+        type=int,
+        default=2000,
+        help="Iterations of Python work per request.",
+    )
+    parser.add_argument(
+        "--clone_outputs",
+        action=argparse.BooleanOptionalAction,
+        default=True,
+    )
+    args = parser.parse_args()
+
+    program, inputs = create_program(ModuleMLP(args.dim, args.hidden_dim))
+    buffer = program.buffer
+    print(f"{'threads':>8} {'gil':>12} {'release_gil':>12} {'async':>12}")
+    for threads in args.threads:
+        modules = [
+            runtime._load_for_executorch_from_buffer(buffer) for _ in range(threads)
+        ]
+        # Warm up.
+        run_threads(modules, inputs, "release_gil", 2, args)
+        results = [
+            run_threads(modules, inputs, "gil", args.requests, args),
+            run_threads(modules, inputs, "release_gil", args.requests, args),
+            run_async(modules, inputs, args.requests, args),
+        ]
+        print(f"{threads:>8}" + "".join(f" {r:>10.1f}/s" for r in results))
+
+
+if __name__ == "__main__":
+    main()
@@ -6,6 +6,10 @@
 
 # pyre-unsafe
 
+import array
+import asyncio
+import concurrent.futures
+import subprocess
 import sys
 import unittest
 from io import StringIO
@@ -274,6 +278,106 @@ class PybindingsTest(unittest.TestCase):
         inputs = ([*inputs],)
         self.assertRaises(RuntimeError, executorch_module, inputs)
 
+    def test_release_gil(self):
+        exported_program, inputs = create_program(ModuleAdd())
+        executorch_module = self.load_fn(exported_program.buffer)
+        expected = inputs[0] + inputs[1]
+
+        executorch_output = executorch_module.run_method(
+            "forward", inputs, release_gil=True
+        )[0]
+        self.assertTrue(torch.allclose(expected, executorch_output))
+
+        # Executions from several threads are serialized.
+        with concurrent.futures.ThreadPoolExecutor(max_workers=4) as pool:
+            futures = [
+                pool.submit(executorch_module.forward, inputs, release_gil=True)
+                for _ in range(16)
+            ]
+            for future in futures:
+                self.assertTrue(torch.allclose(expected, future.result()[0]))
+
+    def test_run_method_async(self):
+        exported_program, inputs = create_program(ModuleAdd())
+        executorch_module = self.load_fn(exported_program.buffer)
+
+        future = executorch_module.run_method_async("forward", inputs)
+        self.assertTrue(torch.allclose(inputs[0] + inputs[1], future.result()[0]))
+
+        async def run_all():
+            return await asyncio.gather(
+                *[
+                    asyncio.wrap_future(
+                        executorch_module.run_method_async(
+                            "forward", (inputs[0] * i, inputs[1])
+                        )
+                    )
+                    for i in range(4)
+                ]
+            )
+
+        for i, outputs in enumerate(asyncio.run(run_all())):
+            self.assertTrue(torch.allclose(inputs[0] * i + inputs[1], outputs[0]))
+
+        failed = executorch_module.run_method_async("forward", (inputs[0],))
+        self.assertRaises(RuntimeError, failed.result)
+
+        # Dropping the module leaves the pending executions running.
+        futures = [
+            executorch_module.run_method_async("forward", inputs) for _ in range(4)
+        ]
+        del executorch_module
+        for future in futures:
+            self.assertTrue(torch.allclose(inputs[0] + inputs[1], future.result()[0]))
+
+    def test_run_method_async_at_exit(self):
+        # The interpreter exits cleanly while executions are pending.
+        script = f"""
+from {self.runtime.__name__} import _load_for_executorch_from_buffer
+from executorch.extension.pybindings.test.make_test import create_program, ModuleAdd
+
+program, inputs = create_program(ModuleAdd())
+module = _load_for_executorch_from_buffer(program.buffer)
+futures = [module.run_method_async("forward", inputs) for _ in range(16)]
+"""
+        result = subprocess.run([sys.executable, "-c", script], timeout=300)
+        self.assertEqual(result.returncode, 0)
+
+    def test_zero_copy_inputs(self):
+        exported_program, inputs = create_program(ModuleAdd())
+        executorch_module = self.load_fn(exported_program.buffer)
+        expected = inputs[0] + inputs[1]
+
+        # Through DLPack.
+        executorch_output = executorch_module.forward(
+            (inputs[0].numpy(), inputs[1].numpy())
+        )[0]
+        self.assertTrue(torch.allclose(expected, executorch_output))
+
+        # Through the buffer protocol.
+        buffers = []
+        for t in inputs:
+            data = memoryview(array.array("f", t.flatten().tolist()))
+            buffers.append(data.cast("B").cast("f", t.shape))
+        executorch_output = executorch_module.forward(buffers)[0]
+        self.assertTrue(torch.allclose(expected, executorch_output))
+
+        self.assertRaises(
+            RuntimeError,
+            executorch_module.forward,
+            (memoryview(b"abcd").cast("c"), inputs[1]),
+        )
+
+    def test_uncloned_output_lifespan(self):
+        def lower_function_call():
+            program, inputs = create_program(ModuleMulti())
+            executorch_module = self.load_fn(program.buffer)
+            return executorch_module.forward(inputs, clone_outputs=False)
+
+        # The outputs keep the module, and thus their memory, alive.
+        outputs = lower_function_call()
+        self.assertTrue(torch.allclose(outputs[0], torch.ones(2, 2) * 2))
+
     def test_program_methods_one(self):
         exported_program, _ = create_program(ModuleAdd())
         executorch_program = self.load_prog_fn(exported_program.buffer)
@@ -45,12 +45,22 @@ Tensor& amax_out(
       ctx, tensors_have_same_dim_order(in, out), InvalidArgument, out);
 
   ReduceOverDimListPlan plan(in, dim_list);
+  const ContiguousReductionPlan contiguous_plan(in, dim_list);
 
   // @lint-ignore CLANGTIDY facebook-hte-CArray
   static constexpr const char op_name[] = "amax.out";
 
   ET_SWITCH_REALHBBF16_TYPES(in.scalar_type(), ctx, op_name, CTYPE, [&]() {
     CTYPE* out_data = out.mutable_data_ptr<CTYPE>();
+    if (contiguous_plan.is_supported()) {
+      const bool success = contiguous_plan.execute<CTYPE>(
+          MaxReducer<reduce_acc_t<CTYPE>>(),
+          [&](const size_t out_ix, const auto max_v) {
+            out_data[out_ix] = static_cast<CTYPE>(max_v);
+          });
+      ET_KERNEL_CHECK_MSG(ctx, success, Internal, , "parallel_for failed");
+      return;
+    }
     const bool success = parallel_for_each_reduce_over_dim_list_output_index(
         in, dim_list, out, [&](const auto begin, const auto end) {
           for (const auto out_ix : c10::irange(begin, end)) {
@@ -8,6 +8,7 @@
 
 #include <cstring>
 
+#include <executorch/kernels/portable/cpu/util/concat_util.h>
 #include <executorch/kernels/portable/cpu/util/copy_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -62,6 +63,26 @@ Tensor& cat_out(
   // @lint-ignore CLANGTIDY facebook-hte-CArray
   static constexpr const char op_name[] = "cat.out";
 
+  // Without any conversion, cat only moves bytes.
+  bool same_dtypes = true;
+  for (size_t i = 0; i < ninputs; ++i) {
+    same_dtypes = same_dtypes && tensors[i].scalar_type() == out_type;
+  }
+  if (same_dtypes) {
+    const size_t element_size = out.element_size();
+    concat_copy(
+        out.mutable_data_ptr<char>(),
+        outer,
+        ninputs,
+        [&](const size_t j) -> size_t {
+          return tensors[j].numel() == 0
+              ? 0
+              : tensors[j].size(dim) * dim_stride * element_size;
+        },
+        [&](const size_t j) { return tensors[j].const_data_ptr(); });
+    return out;
+  }
+
   if (out_is_complex) {
     // TODO: The current support for complex dtype enforces that input and
     // output tensors have the same dtype. Support mixed dtypes in the future.
@@ -8,6 +8,7 @@
 
 #include <cstring>
 
+#include <executorch/kernels/portable/cpu/util/gather_util.h>
 #include <executorch/kernels/portable/cpu/util/kernel_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -38,6 +39,8 @@ void embedding_kernel(
   const CTYPE* indices_ptr = indices.const_data_ptr<CTYPE>();
   ssize_t weight_height = weight.size(0);
   const auto indices_numel = indices.numel();
+  // Check all the indices before copying any row, so that the copies can be
+  // spread across threads.
   for (int i = 0; i < indices_numel; i++) {
     // Ensure index is larger than 0 and smaller than weight.size(0)
     ET_KERNEL_CHECK_MSG(
@@ -57,13 +60,16 @@ void embedding_kernel(
         "indices_ptr[%d] %ld < 0",
         i,
         static_cast<long>(indices_ptr[i]));
-    if (w_data != nullptr) {
-      memcpy(
-          out_data,
-          w_data + nbytes_per_entry * indices_ptr[i],
-          nbytes_per_entry);
-    }
-    out_data += nbytes_per_entry;
+  }
+  if (w_data != nullptr) {
+    gather_rows(
+        w_data,
+        out_data,
+        indices_ptr,
+        indices_numel,
+        /*leading=*/1,
+        weight_height,
+        nbytes_per_entry);
   }
 }
 } // namespace
@@ -11,6 +11,7 @@
 #include <cstdint>
 #include <cstring>
 
+#include <executorch/kernels/portable/cpu/util/gather_util.h>
 #include <executorch/kernels/portable/cpu/util/index_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -88,7 +89,9 @@ Tensor& gather_out(
   static constexpr auto name = "gather.out";
 
   ET_SWITCH_REALHBBF16_TYPES(in.scalar_type(), ctx, name, CTYPE, [&]() {
-    gather_helper<CTYPE>(in, index, out, dim);
+    if (!gather_along_dim<CTYPE>(in, dim, index, out)) {
+      gather_helper<CTYPE>(in, index, out, dim);
+    }
   });
 
   return out;
@@ -9,8 +9,9 @@
 #include <cmath>
 
 #include <executorch/kernels/portable/cpu/math_constants.h>
+#include <executorch/kernels/portable/cpu/pattern/pattern.h>
 #include <executorch/kernels/portable/cpu/util/activation_ops_util.h>
-#include <executorch/kernels/portable/cpu/util/functional_util.h>
+#include <executorch/kernels/portable/cpu/util/vectorized_math.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
 namespace torch {
@@ -21,66 +22,47 @@ using Tensor = executorch::aten::Tensor;
 using ScalarType = executorch::aten::ScalarType;
 using string_view = std::string_view;
 
+namespace {
+
+double gelu(double x) {
+  if (x == -std::numeric_limits<double>::infinity()) {
+    return 0.0;
+  } else if (x == std::numeric_limits<double>::infinity()) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return 0.5 * x * (1 + std::erf(x * M_SQRT1_2));
+}
+
+double gelu_tanh(double x) {
+  if (x == -std::numeric_limits<double>::infinity()) {
+    return 0.0;
+  } else if (x == std::numeric_limits<double>::infinity()) {
+    return std::numeric_limits<double>::infinity();
+  }
+  const double kBeta = M_SQRT2 * M_2_SQRTPI * 0.5;
+  const double kKappa = static_cast<float>(0.044715);
+
+  const double x_cubed = x * x * x;
+  const double inner = kBeta * (x + kKappa * x_cubed);
+  return 0.5 * x * (1.0 + std::tanh(inner));
+}
+
+} // namespace
+
 Tensor& gelu_out(
     KernelRuntimeContext& ctx,
     const Tensor& in,
     string_view approximate,
     Tensor& out) {
-  (void)ctx;
-
   ET_KERNEL_CHECK(
       ctx, check_gelu_args(in, approximate, out), InvalidArgument, out);
 
-  ET_KERNEL_CHECK(
-      ctx, resize_tensor(out, in.sizes()) == Error::Ok, InvalidArgument, out);
-
-  ET_KERNEL_CHECK(
-      ctx, tensors_have_same_dim_order(in, out), InvalidArgument, out);
-
-  ET_SWITCH_FLOATHBF16_TYPES(in.scalar_type(), ctx, "gelu.out", CTYPE, [&]() {
-    if (approximate == "tanh") {
-      apply_unary_map_fn(
-          [](const CTYPE x) {
-            if (x == -std::numeric_limits<CTYPE>::infinity()) {
-              return static_cast<CTYPE>(0.0);
-            } else if (x == std::numeric_limits<CTYPE>::infinity()) {
-              return std::numeric_limits<CTYPE>::infinity();
-            }
-            const CTYPE kBeta = M_SQRT2 * M_2_SQRTPI * 0.5;
-            const CTYPE kKappa = static_cast<float>(0.044715);
-
-            const CTYPE x_cubed = x * x * x;
-            const CTYPE inner = kBeta * (x + kKappa * x_cubed);
-            const CTYPE ret = 0.5 * x * (1.0 + std::tanh(inner));
-
-            return ret;
-          },
-          in.const_data_ptr<CTYPE>(),
-          out.mutable_data_ptr<CTYPE>(),
-          in.numel());
-    } else if (approximate == "none") {
-      apply_unary_map_fn(
-          [](const CTYPE x) {
-            if (x == -std::numeric_limits<CTYPE>::infinity()) {
-              return static_cast<CTYPE>(0.0);
-            } else if (x == std::numeric_limits<CTYPE>::infinity()) {
-              return std::numeric_limits<CTYPE>::infinity();
-            }
-            return static_cast<CTYPE>(0.5 * x * (1 + std::erf(x * M_SQRT1_2)));
-          },
-          in.const_data_ptr<CTYPE>(),
-          out.mutable_data_ptr<CTYPE>(),
-          in.numel());
-    } else {
-      ET_CHECK_MSG(
-          false,
-          "Invalid approximation format: %.*s for gelu",
-          static_cast<int>(approximate.length()),
-          approximate.data());
-    }
-  });
-
-  return out;
+  if (approximate == "tanh") {
+    return internal::unary_ufunc_realhbbf16_to_floathbf16(
+        gelu_tanh, executorch::math::fast_gelu_tanh_n, ctx, in, out);
+  }
+  return internal::unary_ufunc_realhbbf16_to_floathbf16(
+      gelu, executorch::math::fast_gelu_n, ctx, in, out);
 }
 
 } // namespace native
@@ -15,6 +15,7 @@
 
 #include <executorch/kernels/portable/cpu/util/advanced_index_util.h>
 #include <executorch/kernels/portable/cpu/util/broadcast_util.h>
+#include <executorch/kernels/portable/cpu/util/gather_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
 namespace torch {
@@ -173,19 +174,14 @@ Tensor& fast_path(
   static constexpr const char op_name[] = "index.Tensor_out";
 
   ET_SWITCH_TWO_TYPES(Long, Int, index_type, ctx, op_name, CTYPE, [&]() {
-    const CTYPE* const index_arr = index.const_data_ptr<CTYPE>();
-    CTYPE dim_size = static_cast<CTYPE>(in.size(dim));
-    for (const auto i : c10::irange(leading_dims)) {
-      const char* src = in_data + i * in_dim_length * length_per_step;
-      char* dest = out_data + i * out_dim_length * length_per_step;
-      for (const auto j : c10::irange(out_dim_length)) {
-        auto index_val =
-            index_arr[j] < 0 ? index_arr[j] + dim_size : index_arr[j];
-        const char* copy_src = src + index_val * length_per_step;
-        char* copy_dest = dest + j * length_per_step;
-        memcpy(copy_dest, copy_src, length_per_step);
-      }
-    }
+    gather_rows(
+        in_data,
+        out_data,
+        index.const_data_ptr<CTYPE>(),
+        out_dim_length,
+        leading_dims,
+        in_dim_length,
+        length_per_step);
   });
 
   return out;
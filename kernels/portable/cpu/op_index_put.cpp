@@ -7,10 +7,12 @@
  */
 
 #include <c10/util/irange.h>
+#include <cinttypes>
 #include <cstring>
 
 #include <executorch/kernels/portable/cpu/util/advanced_index_util.h>
 #include <executorch/kernels/portable/cpu/util/broadcast_util.h>
+#include <executorch/kernels/portable/cpu/util/gather_util.h>
 #include <executorch/runtime/core/exec_aten/util/tensor_shape_to_c_string.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -22,6 +24,45 @@ using Tensor = executorch::aten::Tensor;
 using TensorOptList =
     executorch::aten::ArrayRef<executorch::aten::optional<Tensor>>;
 
+namespace {
+
+// Returns true and sets `dim` if `indices` is a single 1-dimensional Long or
+// Int index tensor and `values` has the sizes of `in[indices]`, so that
+// index_put copies or adds whole rows of `values`.
+bool check_row_scatter_conditions(
+    const Tensor& in,
+    TensorOptList indices,
+    const Tensor& values,
+    const Tensor::SizesType* x_sizes,
+    size_t x_dim,
+    size_t* dim) {
+  bool found_index = false;
+  for (const auto i : c10::irange(indices.size())) {
+    if (indices[i].has_value()) {
+      const Tensor& index = indices[i].value();
+      if (found_index || index.dim() != 1 ||
+          (index.scalar_type() != ScalarType::Long &&
+           index.scalar_type() != ScalarType::Int)) {
+        return false;
+      }
+      found_index = true;
+      *dim = i;
+    }
+  }
+  if (!found_index || static_cast<ssize_t>(x_dim) != in.dim() ||
+      values.dim() != in.dim() || !has_contiguous_strides(values)) {
+    return false;
+  }
+  for (const auto i : c10::irange(x_dim)) {
+    if (values.size(i) != x_sizes[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
 Tensor& index_put_out(
     KernelRuntimeContext& ctx,
     const Tensor& in,
@@ -100,6 +141,54 @@ Tensor& index_put_out(
   // To start, copy the input data into the out tensor
   memcpy(out.mutable_data_ptr<char>(), in.const_data_ptr<char>(), in.nbytes());
 
+  size_t row_dim = 0;
+  if (check_row_scatter_conditions(
+          in, indices, values, x_sizes, x_dim, &row_dim)) {
+    const Tensor& index = indices[row_dim].value();
+    const int64_t dim_length = in.size(row_dim);
+    const size_t leading_dims = getLeadingDims(in, row_dim);
+    const size_t trailing_dims = getTrailingDims(in, row_dim);
+    ET_SWITCH_TWO_TYPES(
+        Long, Int, index.scalar_type(), ctx, "index_put.out", INDEX, [&]() {
+          const INDEX* const index_arr = index.const_data_ptr<INDEX>();
+          for (const auto i : c10::irange(index.numel())) {
+            ET_KERNEL_CHECK_MSG(
+                ctx,
+                index_arr[i] >= -dim_length && index_arr[i] < dim_length,
+                InvalidArgument,
+                ,
+                "Index %" PRId64
+                " is out of bounds for input dimension %zu with size %" PRId64,
+                static_cast<int64_t>(index_arr[i]),
+                row_dim,
+                dim_length);
+          }
+          if (!accumulate) {
+            scatter_rows(
+                values.const_data_ptr<char>(),
+                out.mutable_data_ptr<char>(),
+                index_arr,
+                index.numel(),
+                leading_dims,
+                dim_length,
+                trailing_dims * in.element_size());
+            return;
+          }
+          ET_SWITCH_REALHBBF16_TYPES(
+              in_type, ctx, "index_put.out", CTYPE, [&]() {
+                scatter_add_rows(
+                    values.const_data_ptr<CTYPE>(),
+                    out.mutable_data_ptr<CTYPE>(),
+                    index_arr,
+                    index.numel(),
+                    leading_dims,
+                    dim_length,
+                    trailing_dims);
+              });
+        });
+    return out;
+  }
+
   // In what follows, `x = in[indices]`. This tensor is implicit, and it would
   // be much easier to be able to allocate memory, and then call index.Tensor
   // to compute `x`. But since we can't do that, we have to keep track of its
@@ -315,16 +404,14 @@ Tensor& index_put_(
   char* in_data = in.mutable_data_ptr<char>();
 
   ET_SWITCH_TWO_TYPES(Long, Int, index_type, ctx, "index_put_", CTYPE, [&]() {
-    const CTYPE* const index_arr = index.const_data_ptr<CTYPE>();
-    for (const auto i : c10::irange(leading_dims)) {
-      const char* src = values_data + i * values_dim_length * length_per_step;
-      char* dest = in_data + i * in_dim_length * length_per_step;
-      for (const auto j : c10::irange(values_dim_length)) {
-        const char* copy_src = src + j * length_per_step;
-        char* copy_dest = dest + index_arr[j] * length_per_step;
-        memcpy(copy_dest, copy_src, length_per_step);
-      }
-    }
+    scatter_rows(
+        values_data,
+        in_data,
+        index.const_data_ptr<CTYPE>(),
+        values_dim_length,
+        leading_dims,
+        in_dim_length,
+        length_per_step);
   });
 
   return in;
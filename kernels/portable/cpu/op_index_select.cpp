@@ -6,11 +6,11 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <c10/util/irange.h>
 #include <cinttypes>
 #include <cstdint>
 #include <cstring>
 
+#include <executorch/kernels/portable/cpu/util/gather_util.h>
 #include <executorch/kernels/portable/cpu/util/index_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -73,16 +73,14 @@ Tensor& index_select_out(
 
   ET_SWITCH_TWO_TYPES(
       Long, Int, ix_type, ctx, "index_select.out", CTYPE, [&]() {
-        const CTYPE* const index_arr = index.mutable_data_ptr<CTYPE>();
-        for (const auto i : c10::irange(leading_dims)) {
-          const char* src = input_data + i * in_dim_length * length_per_step;
-          char* dest = out_data + i * out_dim_length * length_per_step;
-          for (const auto j : c10::irange(out_dim_length)) {
-            const char* copy_src = src + index_arr[j] * length_per_step;
-            memcpy(dest, copy_src, length_per_step);
-            dest += length_per_step;
-          }
-        }
+        gather_rows(
+            input_data,
+            out_data,
+            index.const_data_ptr<CTYPE>(),
+            out_dim_length,
+            leading_dims,
+            in_dim_length,
+            length_per_step);
       });
 
   return out;
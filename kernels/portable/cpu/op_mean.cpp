@@ -49,12 +49,23 @@ Tensor& mean_dim_out(
   if (in.numel() > 0) {
     plan.emplace(in, dim_list);
   }
+  const ContiguousReductionPlan contiguous_plan(in, dim_list);
   // @lint-ignore CLANGTIDY facebook-hte-CArray
   static constexpr const char op_name[] = "mean.out";
   ET_SWITCH_REALHBBF16_TYPES(in.scalar_type(), ctx, op_name, CTYPE_IN, [&] {
     ET_SWITCH_FLOATHBF16_TYPES(out.scalar_type(), ctx, op_name, CTYPE_OUT, [&] {
       CTYPE_OUT* out_data = out.mutable_data_ptr<CTYPE_OUT>();
       const size_t num = get_reduced_dim_product(in, dim_list);
+      if (contiguous_plan.is_supported()) {
+        const bool success = contiguous_plan.execute<CTYPE_IN>(
+            SumReducer<reduce_acc_t<CTYPE_OUT>>(),
+            [&](const size_t out_ix, const auto sum) {
+              out_data[out_ix] =
+                  static_cast<CTYPE_OUT>(sum / static_cast<float>(num));
+            });
+        ET_KERNEL_CHECK_MSG(ctx, success, Internal, , "parallel_for failed");
+        return;
+      }
       const bool success = parallel_for_each_reduce_over_dim_list_output_index(
           in, dim_list, out, [&](const auto begin, const auto end) {
             for (const auto out_ix : c10::irange(begin, end)) {
@@ -12,6 +12,7 @@
 #include <cstring>
 
 #include <executorch/kernels/portable/cpu/scalar_utils.h>
+#include <executorch/kernels/portable/cpu/util/gather_util.h>
 #include <executorch/kernels/portable/cpu/util/index_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -42,6 +43,13 @@ void scatter_src_helper(
     dim += nonzero_dim(in);
   }
 
+  if (scatter_along_dim<CTYPE>(
+          src, dim, index, out, [](CTYPE& out_val, const CTYPE src_val) {
+            out_val = src_val;
+          })) {
+    return;
+  }
+
   for (const auto ix : c10::irange(index.numel())) {
     // @lint-ignore CLANGTIDY facebook-hte-CArray
     size_t ix_coord[kTensorDimensionLimit];
@@ -7,6 +7,7 @@
  */
 
 #include <c10/util/irange.h>
+#include <executorch/kernels/portable/cpu/util/gather_util.h>
 #include <executorch/kernels/portable/cpu/util/index_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 #include <cstring>
@@ -29,6 +30,12 @@ void scatter_add_helper(
     const Tensor& index,
     Tensor& out,
     int64_t dim) {
+  if (scatter_along_dim<CTYPE>(
+          src, dim, index, out, [](CTYPE& out_val, const CTYPE src_val) {
+            out_val += src_val;
+          })) {
+    return;
+  }
   for (const auto ix : c10::irange(index.numel())) {
     size_t ix_coord[kTensorDimensionLimit];
     indexToCoordinate(index, ix, ix_coord);
@@ -9,6 +9,7 @@
 #include <cstdint>
 #include <cstring>
 
+#include <executorch/kernels/portable/cpu/util/concat_util.h>
 #include <executorch/kernels/portable/cpu/util/copy_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -58,6 +59,24 @@ void split_copy_Tensor_out(
   ScalarType in_type = input.scalar_type();
   ScalarType out_type = out[0].scalar_type();
 
+  // Without any conversion, the split only moves bytes.
+  bool same_dtypes = true;
+  for (size_t i = 0; i < out.size(); ++i) {
+    same_dtypes = same_dtypes && out[i].scalar_type() == in_type;
+  }
+  if (same_dtypes) {
+    const size_t element_size = input.element_size();
+    split_concat_copy(
+        input.const_data_ptr<char>(),
+        leading_dims,
+        out.size(),
+        [&](const size_t i) -> size_t {
+          return out[i].size(dim) * trailing_dims * element_size;
+        },
+        [&](const size_t i) { return out[i].mutable_data_ptr(); });
+    return;
+  }
+
   ET_SWITCH_REALHBBF16_TYPES(
       in_type, ctx, "split_copy.Tensor_out", CTYPE_IN, [&]() {
         ET_SWITCH_REALHBBF16_TYPES(
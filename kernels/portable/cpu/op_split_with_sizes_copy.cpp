@@ -11,6 +11,7 @@
 #include <cstring>
 
 #include <executorch/kernels/portable/cpu/util/broadcast_util.h>
+#include <executorch/kernels/portable/cpu/util/concat_util.h>
 #include <executorch/kernels/portable/cpu/util/copy_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -74,6 +75,26 @@ void split_with_sizes_copy_out(
   ScalarType in_type = in.scalar_type();
   ScalarType out_type = out[0].scalar_type();
 
+  // Without any conversion or broadcasting, the split only moves bytes.
+  bool is_plain_copy = true;
+  for (const auto i : c10::irange(split_sizes.size())) {
+    target_out_sizes[dim] = static_cast<Tensor::SizesType>(split_sizes[i]);
+    is_plain_copy = is_plain_copy && out[i].scalar_type() == in_type &&
+        out[i].sizes().equals({target_out_sizes, target_out_ndim});
+  }
+  if (is_plain_copy) {
+    const size_t element_size = in.element_size();
+    split_concat_copy(
+        in.const_data_ptr<char>(),
+        leading_dims,
+        out.size(),
+        [&](const size_t i) -> size_t {
+          return split_sizes[i] * trailing_dims * element_size;
+        },
+        [&](const size_t i) { return out[i].mutable_data_ptr(); });
+    return;
+  }
+
   ET_SWITCH_REALHBBF16_TYPES(in_type, ctx, __func__, CTYPE_IN, [&]() {
     ET_SWITCH_REALHBBF16_TYPES(out_type, ctx, __func__, CTYPE_OUT, [&]() {
       const CTYPE_IN* in_data = in.const_data_ptr<CTYPE_IN>();
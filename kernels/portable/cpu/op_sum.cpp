@@ -12,6 +12,7 @@
 #include <executorch/runtime/platform/assert.h>
 
 #include <optional>
+#include <type_traits>
 
 namespace torch {
 namespace executor {
@@ -50,6 +51,7 @@ Tensor& sum_dim_out(
   if (in.numel() > 0) {
     plan.emplace(in, dim_list);
   }
+  const ContiguousReductionPlan contiguous_plan(in, dim_list);
   // @lint-ignore CLANGTIDY facebook-hte-CArray
   static constexpr const char op_name[] = "sum.IntList_out";
 
@@ -79,6 +81,21 @@ Tensor& sum_dim_out(
       ET_SWITCH_REALHBBF16_TYPES(
           out.scalar_type(), ctx, op_name, CTYPE_OUT, [&] {
             CTYPE_OUT* out_data = out.mutable_data_ptr<CTYPE_OUT>();
+            // Bool sums saturate at every step, which the accumulators of
+            // the contiguous plan would not.
+            if constexpr (!std::is_same_v<CTYPE_OUT, bool>) {
+              if (contiguous_plan.is_supported()) {
+                const bool success =
+                    contiguous_plan.execute<CTYPE_IN>(
+                        SumReducer<reduce_acc_t<CTYPE_OUT>>(),
+                        [&](const size_t out_ix, const auto sum) {
+                          out_data[out_ix] = static_cast<CTYPE_OUT>(sum);
+                        });
+                ET_KERNEL_CHECK_MSG(
+                    ctx, success, Internal, , "parallel_for failed");
+                return;
+              }
+            }
             const bool success =
                 parallel_for_each_reduce_over_dim_list_output_index(
                     in, dim_list, out, [&](const auto begin, const auto end) {
@@ -8,6 +8,7 @@
 
 #include <executorch/kernels/portable/cpu/util/copy_ops_util.h>
 #include <executorch/runtime/core/exec_aten/util/tensor_util.h>
+#include <executorch/runtime/core/portable_type/float16_convert.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
 namespace torch {
@@ -18,12 +19,10 @@ using Tensor = executorch::aten::Tensor;
 
 template <typename SELF_CTYPE, typename OUT_CTYPE>
 void _to_impl(const Tensor& self, Tensor& out) {
-  auto self_data = self.mutable_data_ptr<SELF_CTYPE>();
-  auto out_data = out.mutable_data_ptr<OUT_CTYPE>();
-
-  for (int i = 0; i < self.numel(); i++) {
-    out_data[i] = static_cast<OUT_CTYPE>(self_data[i]);
-  }
+  executorch::runtime::etensor::convert_array(
+      self.const_data_ptr<SELF_CTYPE>(),
+      out.mutable_data_ptr<OUT_CTYPE>(),
+      self.numel());
 }
 
 // to_copy.out(Tensor self, *, bool non_blocking=False, MemoryFormat?
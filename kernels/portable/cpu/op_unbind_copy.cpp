@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <cstring>
 
+#include <executorch/kernels/portable/cpu/util/concat_util.h>
 #include <executorch/kernels/portable/cpu/util/copy_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -55,6 +56,22 @@ void unbind_copy_int_out(
   ScalarType in_type = input.scalar_type();
   ScalarType out_type = out[0].scalar_type();
 
+  // Without any conversion, unbind only moves bytes.
+  bool same_dtypes = true;
+  for (const auto i : c10::irange(out.size())) {
+    same_dtypes = same_dtypes && out[i].scalar_type() == in_type;
+  }
+  if (same_dtypes) {
+    const size_t row_bytes = trailing_dims * input.element_size();
+    split_concat_copy(
+        input.const_data_ptr<char>(),
+        leading_dims,
+        out.size(),
+        [row_bytes](ET_UNUSED const size_t i) { return row_bytes; },
+        [&](const size_t i) { return out[i].mutable_data_ptr(); });
+    return;
+  }
+
   ET_SWITCH_REALHBBF16_TYPES(
       in_type, ctx, "unbind_copy.int_out", CTYPE_IN, [&]() {
         ET_SWITCH_REALHBBF16_TYPES(
@@ -108,6 +108,27 @@ Tensor& unary_ufunc_realhbbf16_to_floathbf16(
         fn, fn, ctx, in, out);                                                \
   }
 
+/**
+ * Like unary_ufunc_realhbbf16_to_floathbf16(), but computes every input dtype
+ * other than double in float a block at a time with fn_float_n, which maps
+ * `n` floats from its first argument to its second, e.g. one of the
+ * vectorized functions of vectorized_math.h. The blocks are split between
+ * threads.
+ */
+Tensor& unary_ufunc_realhbbf16_to_floathbf16(
+    double (*fn_double)(double),
+    void (*fn_float_n)(const float*, float*, size_t),
+    KernelRuntimeContext& ctx,
+    const Tensor& in,
+    Tensor& out);
+
+#define DEFINE_UNARY_UFUNC_REALHBBF16_TO_FLOATHBF16_VECTORIZED(                \
+    op_name, fn, fn_float_n)                                                  \
+  Tensor& op_name(KernelRuntimeContext& ctx, const Tensor& in, Tensor& out) { \
+    return internal::unary_ufunc_realhbbf16_to_floathbf16(                    \
+        fn, fn_float_n, ctx, in, out);                                        \
+  }
+
 } // namespace internal
 } // namespace native
 } // namespace executor
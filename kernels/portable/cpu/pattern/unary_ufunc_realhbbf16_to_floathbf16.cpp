@@ -6,9 +6,14 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <type_traits>
+
 #include <executorch/kernels/portable/cpu/pattern/pattern.h>
 #include <executorch/kernels/portable/cpu/util/functional_util.h>
+#include <executorch/runtime/core/portable_type/float16_convert.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
 
 namespace torch {
 namespace executor {
@@ -60,6 +65,82 @@ Tensor& unary_ufunc_realhbbf16_to_floathbf16(
   return out;
 }
 
+namespace {
+
+// Elements that fn_float_n computes at a time.
+constexpr size_t kFloatBlockSize = 256;
+
+} // namespace
+
+Tensor& unary_ufunc_realhbbf16_to_floathbf16(
+    double (*fn_double)(double),
+    void (*fn_float_n)(const float*, float*, size_t),
+    KernelRuntimeContext& ctx,
+    const Tensor& in,
+    Tensor& out) {
+  ET_KERNEL_CHECK(ctx, tensor_is_floating_type(out), InvalidArgument, out);
+
+  // Resize for dynamic shape
+  ET_KERNEL_CHECK_MSG(
+      ctx,
+      resize_tensor(out, in.sizes()) == Error::Ok,
+      InvalidArgument,
+      out,
+      "Failed to resize output tensor.");
+
+  ET_KERNEL_CHECK(
+      ctx, tensors_have_same_dim_order(in, out), InvalidArgument, out);
+
+  const auto in_type = in.scalar_type();
+  const auto out_type = out.scalar_type();
+
+  ET_SWITCH_REALHBBF16_TYPES(in_type, ctx, __func__, CTYPE_IN, [&] {
+    ET_SWITCH_FLOATHBF16_TYPES(out_type, ctx, __func__, CTYPE_OUT, [&] {
+      const CTYPE_IN* const in_data = in.const_data_ptr<CTYPE_IN>();
+      CTYPE_OUT* const out_data = out.mutable_data_ptr<CTYPE_OUT>();
+      if constexpr (std::is_same_v<CTYPE_IN, double>) {
+        (void)fn_float_n;
+        apply_unary_map_fn(
+            [fn_double](const double val_in) {
+              return static_cast<CTYPE_OUT>(fn_double(val_in));
+            },
+            in_data,
+            out_data,
+            in.numel());
+      } else {
+        (void)fn_double;
+        ::executorch::extension::parallel_for(
+            0,
+            in.numel(),
+            ::executorch::extension::internal::GRAIN_SIZE,
+            [&](const auto begin, const auto end) {
+              float block[kFloatBlockSize];
+              for (auto i = begin; i < end; i += kFloatBlockSize) {
+                const size_t n =
+                    std::min<size_t>(kFloatBlockSize, end - i);
+                const float* block_in = block;
+                if constexpr (std::is_same_v<CTYPE_IN, float>) {
+                  block_in = in_data + i;
+                } else {
+                  ::executorch::runtime::etensor::convert_array(
+                      in_data + i, block, n);
+                }
+                if constexpr (std::is_same_v<CTYPE_OUT, float>) {
+                  fn_float_n(block_in, out_data + i, n);
+                } else {
+                  fn_float_n(block_in, block, n);
+                  ::executorch::runtime::etensor::convert_array(
+                      static_cast<const float*>(block), out_data + i, n);
+                }
+              }
+            });
+      }
+    });
+  });
+
+  return out;
+}
+
 } // namespace internal
 } // namespace native
 } // namespace executor
@@ -373,4 +373,100 @@ class BroadcastIndexesRange {
  private:
   std::array<const Tensor*, kNumInputs + 1> tensors_;
 };
+
+/**
+ * The index space of a broadcasting op over an output tensor and kNumInputs
+ * input tensors, with the dimensions of size 1 dropped and adjacent
+ * dimensions merged wherever every input can step through both of them with
+ * a single stride. Common broadcasts collapse to at most three dimensions:
+ *
+ *   [B, S, D] + [D]            -> sizes [B * S, D], strides {[0, 1]}
+ *   [B, S, D] * [B, S, 1]      -> sizes [B * S, D], strides {[1, 0]}
+ *   [B, H, S, S] * [B, 1, S, S] -> sizes [B, H, S * S],
+ *                                  strides {[S * S, 0, 1]}
+ *
+ * A scalar input has stride 0 in every dimension, and inputs that are not
+ * broadcast collapse together with the output into a single dimension.
+ *
+ * Like BroadcastIndexesRange, this does not support non-contiguous outputs:
+ * output element i is at linear index i.
+ */
+template <std::size_t kNumInputs>
+struct CollapsedBroadcastShape {
+  using ShapeType =
+      std::array<ssize_t, executorch::runtime::kTensorDimensionLimit>;
+
+  // Number of collapsed dimensions; at least 1.
+  std::size_t dim = 1;
+  // Collapsed output sizes, outermost first.
+  ShapeType sizes = {1};
+  // Per-input strides, in elements, over the collapsed dimensions. A
+  // stride of 0 means that the input is broadcast over the dimension.
+  std::array<ShapeType, kNumInputs> strides = {};
+
+  ssize_t inner_size() const {
+    return sizes[dim - 1];
+  }
+
+  ssize_t inner_stride(std::size_t input_idx) const {
+    return strides[input_idx][dim - 1];
+  }
+};
+
+/**
+ * Computes the CollapsedBroadcastShape of an op with output `output` and
+ * inputs `args`, which must be broadcastable to the output.
+ */
+template <typename... Args>
+CollapsedBroadcastShape<sizeof...(Args)> collapse_broadcast_shape(
+    const Tensor& output,
+    const Args&... args) {
+  static_assert(
+      (std::is_same_v<Args, Tensor> && ...),
+      "collapse_broadcast_shape requires input tensor arguments!");
+  constexpr auto kNumInputs = sizeof...(Args);
+  const std::array<const Tensor*, kNumInputs> inputs = {(&args)...};
+  CollapsedBroadcastShape<kNumInputs> result;
+
+  std::size_t dim = 0;
+  for (const auto out_dim : c10::irange(output.dim())) {
+    const ssize_t size = output.size(out_dim);
+    if (size == 1) {
+      continue;
+    }
+    std::array<ssize_t, kNumInputs> strides = {};
+    for (const auto input_idx : c10::irange(kNumInputs)) {
+      const Tensor& t = *inputs[input_idx];
+      const ssize_t t_dim = out_dim - (output.dim() - t.dim());
+      strides[input_idx] =
+          t_dim < 0 || t.size(t_dim) == 1 ? 0 : t.strides()[t_dim];
+    }
+    // Merge into the previous dimension if every input steps through
+    // the previous dimension as if it were the outer part of this one.
+    bool mergeable = dim > 0;
+    for (const auto input_idx : c10::irange(kNumInputs)) {
+      mergeable = mergeable &&
+          result.strides[input_idx][dim - 1] == strides[input_idx] * size;
+    }
+    if (mergeable) {
+      result.sizes[dim - 1] *= size;
+      for (const auto input_idx : c10::irange(kNumInputs)) {
+        result.strides[input_idx][dim - 1] = strides[input_idx];
+      }
+    } else {
+      result.sizes[dim] = size;
+      for (const auto input_idx : c10::irange(kNumInputs)) {
+        result.strides[input_idx][dim] = strides[input_idx];
+      }
+      dim++;
+    }
+  }
+  if (dim > 0) {
+    result.dim = dim;
+  } else {
+    // Every dimension has size 1 (or the output is 0-D).
+    result.sizes[0] = output.numel();
+  }
+  return result;
+}
 } // namespace torch::executor
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace torch {
+namespace executor {
+
+// Bytes of the packed tensor that each unit of work of a concat copy covers.
+constexpr size_t kConcatChunkBytes = 128 * 1024;
+// Concat copies of at least this many bytes use non-temporal stores, where
+// available, since their output would evict everything else from the caches
+// without being read back before the end of the copy.
+constexpr size_t kConcatStreamingMinBytes = 16 * 1024 * 1024;
+
+namespace internal {
+
+// Copies `n` bytes, with non-temporal stores when `streaming` is set and the
+// target supports them.
+inline void concat_copy_bytes(
+    char* dst,
+    const char* src,
+    size_t n,
+    bool streaming) {
+#if defined(__SSE2__)
+  constexpr size_t kVectorBytes = sizeof(__m128i);
+  if (streaming && n >= 4 * kVectorBytes) {
+    const size_t head =
+        (kVectorBytes - reinterpret_cast<uintptr_t>(dst) % kVectorBytes) %
+        kVectorBytes;
+    std::memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    n -= head;
+    for (; n >= 4 * kVectorBytes;
+         n -= 4 * kVectorBytes, dst += 4 * kVectorBytes,
+         src += 4 * kVectorBytes) {
+      for (size_t v = 0; v < 4; ++v) {
+        _mm_stream_si128(
+            reinterpret_cast<__m128i*>(dst) + v,
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src) + v));
+      }
+    }
+  }
+#else
+  (void)streaming;
+#endif
+  std::memcpy(dst, src, n);
+}
+
+// Orders the non-temporal stores of a thread before whatever it does next.
+inline void concat_copy_fence(bool streaming) {
+#if defined(__SSE2__)
+  if (streaming) {
+    _mm_sfence();
+  }
+#else
+  (void)streaming;
+#endif
+}
+
+/**
+ * Walks the packed tensor of a concat copy of `outer` rows in chunks of
+ * kConcatChunkBytes spread across threads, calling
+ * fn(packed_offset, j, part_offset, n, streaming) for every contiguous run of
+ * `n` bytes that goes between byte `packed_offset` of the packed tensor and
+ * byte `part_offset` of part j. When a single part is not empty, its rows are
+ * contiguous in the packed tensor too, and whole chunks are one run.
+ */
+template <typename PartBytesFn, typename RunFn>
+void for_each_concat_run(
+    size_t outer,
+    size_t num_parts,
+    const PartBytesFn& part_row_bytes,
+    const RunFn& fn) {
+  size_t row_bytes = 0;
+  size_t non_empty_parts = 0;
+  for (size_t j = 0; j < num_parts; ++j) {
+    const size_t part_bytes = part_row_bytes(j);
+    row_bytes += part_bytes;
+    non_empty_parts += part_bytes != 0 ? 1 : 0;
+  }
+  const size_t total_bytes = outer * row_bytes;
+  if (total_bytes == 0) {
+    return;
+  }
+  // A single part is copied as one row.
+  const bool single_part = non_empty_parts == 1;
+  const size_t rows = single_part ? 1 : outer;
+  const size_t packed_row_bytes = total_bytes / rows;
+  const bool streaming = total_bytes >= kConcatStreamingMinBytes;
+  const int64_t num_chunks =
+      (total_bytes + kConcatChunkBytes - 1) / kConcatChunkBytes;
+  // The bytes of part j in every row of the packed tensor.
+  const auto packed_part_bytes = [&](const size_t j) {
+    const size_t part_bytes = part_row_bytes(j);
+    return single_part && part_bytes != 0 ? packed_row_bytes : part_bytes;
+  };
+
+  ::executorch::extension::parallel_for(
+      0, num_chunks, 1, [&](const int64_t begin, const int64_t end) {
+        size_t offset = begin * kConcatChunkBytes;
+        const size_t chunk_end =
+            std::min(total_bytes, end * kConcatChunkBytes);
+        size_t row = offset / packed_row_bytes;
+        size_t row_offset = offset % packed_row_bytes;
+        // Find the part that the chunk starts in.
+        size_t j = 0;
+        size_t part_begin = 0;
+        while (row_offset >= part_begin + packed_part_bytes(j)) {
+          part_begin += packed_part_bytes(j);
+          ++j;
+        }
+        while (offset < chunk_end) {
+          const size_t part_bytes = packed_part_bytes(j);
+          const size_t n = std::min(
+              part_begin + part_bytes - row_offset, chunk_end - offset);
+          if (n != 0) {
+            fn(offset,
+               j,
+               row * part_bytes + (row_offset - part_begin),
+               n,
+               streaming);
+          }
+          offset += n;
+          row_offset += n;
+          if (row_offset == part_begin + part_bytes) {
+            part_begin += part_bytes;
+            if (++j == num_parts) {
+              j = 0;
+              part_begin = 0;
+              row_offset = 0;
+              ++row;
+            }
+          }
+        }
+        concat_copy_fence(streaming);
+      });
+}
+
+} // namespace internal
+
+/**
+ * Packs `outer` rows into `out`: row i of `out` is made of the
+ * part_row_bytes(j) bytes of row i of every part j, one part after the
+ * other, where the rows of part j are contiguous at part_data(j). This is
+ * cat along a dimension, with `outer` covering the dimensions before it, and
+ * stack. The copy is split into chunks of the same size spread across
+ * threads.
+ */
+template <typename PartBytesFn, typename PartDataFn>
+void concat_copy(
+    char* out,
+    size_t outer,
+    size_t num_parts,
+    const PartBytesFn& part_row_bytes,
+    const PartDataFn& part_data) {
+  internal::for_each_concat_run(
+      outer,
+      num_parts,
+      part_row_bytes,
+      [&](const size_t offset,
+          const size_t j,
+          const size_t part_offset,
+          const size_t n,
+          const bool streaming) {
+        const void* const data = part_data(j);
+        internal::concat_copy_bytes(
+            out + offset,
+            static_cast<const char*>(data) + part_offset,
+            n,
+            streaming);
+      });
+}
+
+/**
+ * The inverse of concat_copy: unpacks the rows of `in` into the parts, which
+ * part_data(j) returns writable pointers to. This is split and unbind.
+ */
+template <typename PartBytesFn, typename PartDataFn>
+void split_concat_copy(
+    const char* in,
+    size_t outer,
+    size_t num_parts,
+    const PartBytesFn& part_row_bytes,
+    const PartDataFn& part_data) {
+  internal::for_each_concat_run(
+      outer,
+      num_parts,
+      part_row_bytes,
+      [&](const size_t offset,
+          const size_t j,
+          const size_t part_offset,
+          const size_t n,
+          const bool streaming) {
+        void* const data = part_data(j);
+        internal::concat_copy_bytes(
+            static_cast<char*>(data) + part_offset, in + offset, n, streaming);
+      });
+}
+
+} // namespace executor
+} // namespace torch
@@ -10,6 +10,8 @@
 #include <c10/util/irange.h>
 
 #include <executorch/kernels/portable/cpu/util/broadcast_util.h>
+#include <executorch/kernels/portable/cpu/util/dim_order_transpose_util.h>
+#include <executorch/runtime/core/portable_type/float16_convert.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
 namespace torch {
@@ -86,6 +88,20 @@ void _to_dim_order_copy_impl(const Tensor& self, Tensor& out) {
   auto self_data = self.mutable_data_ptr<SELF_CTYPE>();
   auto out_data = out.mutable_data_ptr<OUT_CTYPE>();
 
+  // With the same strides, elements keep their offsets: convert in bulk.
+  if (self.strides() == out.strides()) {
+    executorch::runtime::etensor::convert_array(
+        self_data, out_data, self.numel());
+    return;
+  }
+
+  // Conversions between contiguous and channels last transpose matrices.
+  DimOrderTranspose transpose;
+  if (get_dim_order_transpose(self, out, &transpose)) {
+    dim_order_transpose_copy(self_data, out_data, transpose);
+    return;
+  }
+
   // Here we make a slightly off-label use of
   // BroadcastIndexesRange. It always assumes it doesn't have to care
   // about different dim_order between input and output, but we can
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+#include <executorch/runtime/core/portable_type/float16_convert.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+
+namespace torch {
+namespace executor {
+
+// Side of the square tiles that dim order transposes copy at a time, so that
+// both the rows read and the rows written by a tile stay in L1.
+constexpr int64_t kDimOrderTransposeTile = 32;
+
+/**
+ * Describes a change of dim order that amounts to transposing `batch`
+ * independent [rows x cols] matrices: the input holds them as
+ * [batch][rows][cols] and the output as [batch][cols][rows]. Contiguous to
+ * channels last is rows = C and cols = H * W (* D), and channels last to
+ * contiguous the other way around.
+ */
+struct DimOrderTranspose {
+  int64_t batch;
+  int64_t rows;
+  int64_t cols;
+};
+
+/**
+ * Returns true and fills `transpose` if copying `in` into `out`, which have
+ * the same sizes, only moves a trailing group of dimensions of the dim order
+ * of `in` in front of the group of dimensions before it. Dimensions of size 1
+ * are ignored since they do not change any offset.
+ */
+inline bool get_dim_order_transpose(
+    const Tensor& in,
+    const Tensor& out,
+    DimOrderTranspose* transpose) {
+  const auto in_dim_order = in.dim_order();
+  const auto out_dim_order = out.dim_order();
+  if (in_dim_order.size() != out_dim_order.size()) {
+    return false;
+  }
+  uint8_t in_order[kTensorDimensionLimit];
+  uint8_t out_order[kTensorDimensionLimit];
+  size_t ndim = 0;
+  for (size_t i = 0; i < in_dim_order.size(); ++i) {
+    if (in.size(in_dim_order[i]) != 1) {
+      in_order[ndim++] = in_dim_order[i];
+    }
+  }
+  size_t out_ndim = 0;
+  for (size_t i = 0; i < out_dim_order.size(); ++i) {
+    if (in.size(out_dim_order[i]) != 1) {
+      out_order[out_ndim++] = out_dim_order[i];
+    }
+  }
+
+  size_t prefix = 0;
+  while (prefix < ndim && in_order[prefix] == out_order[prefix]) {
+    ++prefix;
+  }
+  if (prefix == ndim) {
+    return false;
+  }
+  // in_order is prefix + B + C and out_order must be prefix + C + B, where C
+  // starts with out_order[prefix].
+  size_t split = prefix + 1;
+  while (split < ndim && in_order[split] != out_order[prefix]) {
+    ++split;
+  }
+  if (split == ndim) {
+    return false;
+  }
+  const size_t c_dims = ndim - split;
+  for (size_t i = 0; i < c_dims; ++i) {
+    if (out_order[prefix + i] != in_order[split + i]) {
+      return false;
+    }
+  }
+  for (size_t i = prefix; i < split; ++i) {
+    if (out_order[c_dims + i] != in_order[i]) {
+      return false;
+    }
+  }
+
+  transpose->batch = 1;
+  transpose->rows = 1;
+  transpose->cols = 1;
+  for (size_t i = 0; i < ndim; ++i) {
+    const int64_t size = in.size(in_order[i]);
+    if (i < prefix) {
+      transpose->batch *= size;
+    } else if (i < split) {
+      transpose->rows *= size;
+    } else {
+      transpose->cols *= size;
+    }
+  }
+  return true;
+}
+
+namespace internal {
+
+// Transposes a [tile_rows x tile_cols] tile. `in` points to the tile in a
+// [rows x cols] matrix and `out` to where it goes in the [cols x rows]
+// transposed matrix.
+template <typename OUT_CTYPE, typename IN_CTYPE>
+void transpose_tile(
+    const IN_CTYPE* __restrict__ in,
+    OUT_CTYPE* __restrict__ out,
+    int64_t rows,
+    int64_t cols,
+    int64_t tile_rows,
+    int64_t tile_cols) {
+  if constexpr (std::is_same_v<OUT_CTYPE, IN_CTYPE>) {
+    for (int64_t j = 0; j < tile_cols; ++j) {
+      OUT_CTYPE* __restrict__ out_row = out + j * rows;
+      for (int64_t i = 0; i < tile_rows; ++i) {
+        out_row[i] = in[i * cols + j];
+      }
+    }
+  } else {
+    // Convert the rows of the tile in bulk first, then transpose the
+    // converted values.
+    OUT_CTYPE converted[kDimOrderTransposeTile * kDimOrderTransposeTile];
+    if (tile_cols == cols) {
+      // Whole rows are contiguous in `in`.
+      ::executorch::runtime::etensor::convert_array(
+          in, converted, tile_rows * cols);
+    } else {
+      for (int64_t i = 0; i < tile_rows; ++i) {
+        ::executorch::runtime::etensor::convert_array(
+            in + i * cols, converted + i * tile_cols, tile_cols);
+      }
+    }
+    for (int64_t j = 0; j < tile_cols; ++j) {
+      OUT_CTYPE* __restrict__ out_row = out + j * rows;
+      for (int64_t i = 0; i < tile_rows; ++i) {
+        out_row[i] = converted[i * tile_cols + j];
+      }
+    }
+  }
+}
+
+} // namespace internal
+
+/**
+ * Copies the matrices described by `transpose` from `in` to `out`, casting
+ * every element to OUT_CTYPE. The matrices are split into tiles of about
+ * kDimOrderTransposeTile^2 elements, which are spread across threads with
+ * parallel_for. Thin matrices, like the three channels of an image, get tiles
+ * that are longer along their long side.
+ */
+template <typename OUT_CTYPE, typename IN_CTYPE>
+void dim_order_transpose_copy(
+    const IN_CTYPE* in,
+    OUT_CTYPE* out,
+    const DimOrderTranspose& transpose) {
+  const int64_t rows = transpose.rows;
+  const int64_t cols = transpose.cols;
+  if (transpose.batch == 0 || rows == 0 || cols == 0) {
+    return;
+  }
+  constexpr int64_t kTileSize =
+      kDimOrderTransposeTile * kDimOrderTransposeTile;
+  const int64_t tile_rows = rows < kDimOrderTransposeTile
+      ? rows
+      : std::max(kDimOrderTransposeTile, kTileSize / cols);
+  const int64_t tile_cols = std::max<int64_t>(1, kTileSize / tile_rows);
+  const int64_t row_tiles = (rows + tile_rows - 1) / tile_rows;
+  const int64_t col_tiles = (cols + tile_cols - 1) / tile_cols;
+  const int64_t tiles_per_matrix = row_tiles * col_tiles;
+
+  ::executorch::extension::parallel_for(
+      0,
+      transpose.batch * tiles_per_matrix,
+      std::max<int64_t>(
+          1, ::executorch::extension::internal::GRAIN_SIZE / kTileSize),
+      [&](const int64_t begin, const int64_t end) {
+        for (int64_t tile = begin; tile < end; ++tile) {
+          const int64_t b = tile / tiles_per_matrix;
+          const int64_t i = (tile % tiles_per_matrix) / col_tiles * tile_rows;
+          const int64_t j = (tile % col_tiles) * tile_cols;
+          const int64_t matrix_offset = b * rows * cols;
+          const int64_t num_cols = std::min(tile_cols, cols - j);
+          internal::transpose_tile(
+              in + matrix_offset + i * cols + j,
+              out + matrix_offset + j * rows + i,
+              rows,
+              cols,
+              std::min(tile_rows, rows - i),
+              num_cols);
+        }
+      });
+}
+
+} // namespace executor
+} // namespace torch
@@ -8,8 +8,13 @@
 
 #pragma once
 
+#include <executorch/runtime/core/portable_type/float16_convert.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
+#if defined(ET_USE_PYTORCH_HEADERS) && ET_USE_PYTORCH_HEADERS
+#include <ATen/cpu/vec/vec.h>
+#endif // ET_USE_PYTORCH_HEADERS
+
 namespace torch {
 namespace executor {
 namespace native {
@@ -425,6 +430,170 @@ load_to_compute_fn<CTYPE_COMPUTE> get_load_to_compute_fn(
       >(context, t, dtypes);
 }
 
+/**
+ * Converts `n` contiguous elements of type From at `from_ptr` to To. Uses the
+ * SIMD converters of ATen where they exist, otherwise the bulk converters of
+ * portable_type (e.g. Half/BFloat16 <-> float).
+ */
+template <typename To, typename From>
+void load_and_convert_block(const void* from_ptr, To* to, size_t n) {
+  const From* from = reinterpret_cast<const From*>(from_ptr);
+#if defined(ET_USE_PYTORCH_HEADERS) && ET_USE_PYTORCH_HEADERS
+  at::vec::convert(from, to, static_cast<int64_t>(n));
+#else // ET_USE_PYTORCH_HEADERS
+  ::executorch::runtime::etensor::convert_array(from, to, n);
+#endif // ET_USE_PYTORCH_HEADERS
+}
+
+template <typename To, typename From>
+void convert_and_store_block(const From* from, void* to_ptr, size_t n) {
+  To* to = reinterpret_cast<To*>(to_ptr);
+#if defined(ET_USE_PYTORCH_HEADERS) && ET_USE_PYTORCH_HEADERS
+  at::vec::convert(from, to, static_cast<int64_t>(n));
+#else // ET_USE_PYTORCH_HEADERS
+  ::executorch::runtime::etensor::convert_array(from, to, n);
+#endif // ET_USE_PYTORCH_HEADERS
+}
+
+template <typename CTYPE_COMPUTE>
+using load_block_to_compute_fn = void (*)(const void*, CTYPE_COMPUTE*, size_t);
+
+template <typename CTYPE_COMPUTE>
+using store_compute_block_to_tensor_fn =
+    void (*)(const CTYPE_COMPUTE*, void*, size_t);
+
+/**
+ * Calls `fn` with a null `CTYPE*`, where CTYPE is the C type of `t`, for the
+ * dtypes allowed by `dtypes`. Fails `context` for any other dtype.
+ */
+template <typename CTYPE_COMPUTE, const char* op_name, typename Fn>
+void switch_supported_tensor_dtypes(
+    KernelRuntimeContext& context,
+    const Tensor& t,
+    SupportedTensorDtypes dtypes,
+    const Fn& fn) {
+  // Calls `fn` only if `t` holds the C type of `tag`.
+  const auto call_if_dtype_of = [&](auto* tag) {
+    using CTYPE = std::remove_pointer_t<decltype(tag)>;
+    if (t.scalar_type() == CppTypeToScalarType<CTYPE>::value) {
+      fn(tag);
+    } else {
+      context.fail(torch::executor::Error::InvalidArgument);
+      ET_LOG(
+          Error,
+          "Unhandled dtype %s for %s",
+          ::executorch::runtime::toString(t.scalar_type()),
+          op_name);
+    }
+  };
+  switch (dtypes) {
+    case SupportedTensorDtypes::REALHBBF16:
+      ET_SWITCH_REALHBBF16_TYPES(
+          t.scalar_type(), context, op_name, CTYPE, [&]() -> void {
+            fn(static_cast<CTYPE*>(nullptr));
+          });
+      return;
+    case SupportedTensorDtypes::REALHBF16:
+      ET_SWITCH_REALHBF16_TYPES(
+          t.scalar_type(), context, op_name, CTYPE, [&]() -> void {
+            fn(static_cast<CTYPE*>(nullptr));
+          });
+      return;
+    case SupportedTensorDtypes::FLOATHBF16:
+      ET_SWITCH_FLOATHBF16_TYPES(
+          t.scalar_type(), context, op_name, CTYPE, [&]() -> void {
+            fn(static_cast<CTYPE*>(nullptr));
+          });
+      return;
+    case SupportedTensorDtypes::INTB:
+      ET_SWITCH_INT_TYPES_AND(
+          Bool, t.scalar_type(), context, op_name, CTYPE, [&]() -> void {
+            fn(static_cast<CTYPE*>(nullptr));
+          });
+      return;
+    case SupportedTensorDtypes::BOOL:
+      call_if_dtype_of(static_cast<bool*>(nullptr));
+      return;
+    case SupportedTensorDtypes::BOOL_OR_BYTE:
+      ET_SWITCH_TWO_TYPES(
+          Bool,
+          Byte,
+          t.scalar_type(),
+          context,
+          op_name,
+          CTYPE,
+          [&]() -> void { fn(static_cast<CTYPE*>(nullptr)); });
+      return;
+    case SupportedTensorDtypes::SAME_AS_COMPUTE:
+      call_if_dtype_of(static_cast<CTYPE_COMPUTE*>(nullptr));
+      return;
+    case SupportedTensorDtypes::SAME_AS_COMMON:
+      if constexpr (std::is_same_v<CTYPE_COMPUTE, float>) {
+        ET_SWITCH_THREE_TYPES(
+            Float,
+            Half,
+            BFloat16,
+            t.scalar_type(),
+            context,
+            op_name,
+            CTYPE,
+            [&]() -> void { fn(static_cast<CTYPE*>(nullptr)); });
+      } else {
+        call_if_dtype_of(static_cast<CTYPE_COMPUTE*>(nullptr));
+      }
+      return;
+  }
+  ET_CHECK(false);
+}
+
+/**
+ * Returns a function that converts contiguous elements of `t` to
+ * CTYPE_COMPUTE, or nullptr (and fails `context`) if the dtype of `t` is not
+ * in `dtypes`. Unlike get_load_to_compute_fn(), the cost of the indirect call
+ * is paid once per block rather than once per element.
+ */
+template <typename CTYPE_COMPUTE, const char* op_name>
+load_block_to_compute_fn<CTYPE_COMPUTE> get_load_block_to_compute_fn(
+    KernelRuntimeContext& context,
+    const Tensor& t,
+    SupportedTensorDtypes dtypes) {
+  load_block_to_compute_fn<CTYPE_COMPUTE> result = nullptr;
+  switch_supported_tensor_dtypes<
+      CTYPE_COMPUTE,
+#ifdef EXECUTORCH_SELECTIVE_BUILD_DTYPE
+      op_name
+#else // EXECUTORCH_SELECTIVE_BUILD_DTYPE
+      kGenericElementwiseOpName
+#endif // EXECUTORCH_SELECTIVE_BUILD_DTYPE
+      >(context, t, dtypes, [&result](auto* tag) {
+    using CTYPE = std::remove_pointer_t<decltype(tag)>;
+    result = load_and_convert_block<CTYPE_COMPUTE, CTYPE>;
+  });
+  return result;
+}
+
+/// The store counterpart of get_load_block_to_compute_fn().
+template <typename CTYPE_COMPUTE, const char* op_name>
+store_compute_block_to_tensor_fn<CTYPE_COMPUTE>
+get_store_compute_block_to_tensor_fn(
+    KernelRuntimeContext& context,
+    const Tensor& t,
+    SupportedTensorDtypes dtypes) {
+  store_compute_block_to_tensor_fn<CTYPE_COMPUTE> result = nullptr;
+  switch_supported_tensor_dtypes<
+      CTYPE_COMPUTE,
+#ifdef EXECUTORCH_SELECTIVE_BUILD_DTYPE
+      op_name
+#else // EXECUTORCH_SELECTIVE_BUILD_DTYPE
+      kGenericElementwiseOpName
+#endif // EXECUTORCH_SELECTIVE_BUILD_DTYPE
+      >(context, t, dtypes, [&result](auto* tag) {
+    using CTYPE = std::remove_pointer_t<decltype(tag)>;
+    result = convert_and_store_block<CTYPE, CTYPE_COMPUTE>;
+  });
+  return result;
+}
+
 bool check_tensor_dtype(
     const Tensor t,
     SupportedTensorDtypes dtypes,
@@ -22,6 +22,7 @@
 #include <ATen/cpu/vec/vec.h>
 #endif // ET_USE_PYTORCH_HEADERS
 
+#include <algorithm>
 #include <array>
 #include <utility>
 
@@ -71,6 +72,306 @@ constexpr bool can_use_vectorized() {
 }
 #endif // ET_USE_PYTORCH_HEADERS
 
+template <typename CTYPE_COMPUTE, typename... Args>
+inline bool validate_elementwise_fn_inputs(
+    KernelRuntimeContext& ctx,
+    const Tensor& out,
+    SupportedTensorDtypes out_dtypes,
+    Args... inputs) {
+  static_assert(
+      (std::is_same_v<Args, std::pair<const Tensor*, SupportedTensorDtypes>> &&
+       ...));
+  constexpr auto compute_type = CppTypeToScalarType<CTYPE_COMPUTE>::value;
+  const auto check_input_dtype = [](auto input, auto compute_type) {
+    return internal::check_tensor_dtype(
+        *input.first, input.second, compute_type);
+  };
+  ET_KERNEL_CHECK(
+      ctx,
+      (check_input_dtype(inputs, compute_type) && ...) &&
+          internal::check_tensor_dtype(out, out_dtypes, compute_type),
+      InvalidArgument,
+      false);
+
+  return true;
+}
+
+// Number of elements that the block-convert path converts at a time. The
+// compute-typed scratch blocks of three inputs and the output fit in L1.
+constexpr size_t kElementwiseBlockSize = 256;
+
+// Computes `out[i] = compute_fun(inputs[0][i], ...)` for i in [0, n).
+template <typename CTYPE_COMPUTE, typename Op, typename... Args>
+inline void apply_compute_fn_to_block(
+    const Op& compute_fun,
+    const std::array<const CTYPE_COMPUTE*, sizeof...(Args)>& inputs,
+    CTYPE_COMPUTE* out,
+    size_t n) {
+  static constexpr auto kNumInputs = sizeof...(Args);
+  size_t idx = 0;
+#if defined(ET_USE_PYTORCH_HEADERS) && ET_USE_PYTORCH_HEADERS
+  if constexpr (can_use_vectorized<CTYPE_COMPUTE, Op, Args...>()) {
+    using Vec = at::vec::Vectorized<CTYPE_COMPUTE>;
+    for (; idx + Vec::size() <= n; idx += Vec::size()) {
+      std::array<Vec, kNumInputs> loaded_vec_inputs{};
+      for (const auto input_idx : c10::irange(kNumInputs)) {
+        loaded_vec_inputs[input_idx] = Vec::loadu(&inputs[input_idx][idx]);
+      }
+      std::apply(compute_fun, loaded_vec_inputs).store(&out[idx]);
+    }
+  }
+#endif // ET_USE_PYTORCH_HEADERS
+  for (; idx < n; ++idx) {
+    std::array<CTYPE_COMPUTE, kNumInputs> loaded_inputs{};
+    for (const auto input_idx : c10::irange(kNumInputs)) {
+      loaded_inputs[input_idx] = inputs[input_idx][idx];
+    }
+    out[idx] = std::apply(compute_fun, loaded_inputs);
+  }
+}
+
+// Whether every input either has the shape of `out` (ignoring leading 1s) or
+// is a single element.
+template <typename... Args>
+inline bool inputs_are_elementwise_or_scalar(
+    const Tensor& out,
+    Args... inputs) {
+  return (
+      (inputs.first->numel() == 1 ||
+       torch::executor::internal::sizes_match_ignoring_leading_1s(
+           inputs.first->sizes(), out.sizes())) &&
+      ...);
+}
+
+/**
+ * Computes the shape over which apply_compute_fn_to_collapsed_rows() runs an
+ * op, and returns whether it can: the innermost collapsed dimension of every
+ * input must either be contiguous or broadcast. Inputs that are not broadcast
+ * (or are scalars) are treated as flat, like the other paths that skip
+ * broadcasting do.
+ */
+template <typename... Args>
+inline bool get_collapsed_rows_shape(
+    const Tensor& out,
+    CollapsedBroadcastShape<sizeof...(Args)>& shape,
+    Args... inputs) {
+  static constexpr auto kNumInputs = sizeof...(inputs);
+  if (inputs_are_elementwise_or_scalar(out, inputs...)) {
+    shape = CollapsedBroadcastShape<kNumInputs>();
+    shape.sizes[0] = out.numel();
+    const std::array<bool, kNumInputs> is_scalar = {
+        (inputs.first->numel() == 1)...};
+    for (const auto input_idx : c10::irange(kNumInputs)) {
+      shape.strides[input_idx][0] = is_scalar[input_idx] ? 0 : 1;
+    }
+    return true;
+  }
+  shape = collapse_broadcast_shape(out, (*inputs.first)...);
+  for (const auto input_idx : c10::irange(kNumInputs)) {
+    const auto inner_stride = shape.inner_stride(input_idx);
+    if (inner_stride != 0 && inner_stride != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Rows shorter than this are left to the per-element loop of
+// dtype_specialized_elementwise_fn_impl(), whose per-element cost is lower
+// than the per-row cost of apply_compute_fn_to_collapsed_rows().
+constexpr ssize_t kMinCollapsedRowSize = 16;
+
+// An input of apply_compute_fn_to_collapsed_rows().
+template <typename CTYPE_COMPUTE>
+struct BlockInputInfo {
+  // nullptr if the input has the compute dtype.
+  load_block_to_compute_fn<CTYPE_COMPUTE> load_block_to_compute;
+  const char* data_ptr;
+  ssize_t element_size;
+};
+
+/**
+ * Runs compute_fun over the rows, i.e. the innermost dimension, of a
+ * collapsed broadcast shape. Within a row each input is either contiguous
+ * or a single broadcast value, which covers the scalar, row vector ([B, S,
+ * D] + [D]), column vector ([B, S, D] * [B, S, 1]) and outer ([B, H, S, S] *
+ * [B, 1, S, S]) broadcasts: contiguous spans are processed a block at a time
+ * (converted to CTYPE_COMPUTE in scratch buffers if needed, vectorized when
+ * possible), and a broadcast value is converted and splatted once per row,
+ * or once in total for a scalar. The output is split between threads by
+ * element, so that a single long row is split too.
+ *
+ * store_compute_block_to_out is nullptr if the output has the compute dtype.
+ */
+template <typename CTYPE_COMPUTE, typename Op, typename... Args>
+inline void apply_compute_fn_to_collapsed_rows(
+    const Op& compute_fun,
+    const CollapsedBroadcastShape<sizeof...(Args)>& shape,
+    const std::array<BlockInputInfo<CTYPE_COMPUTE>, sizeof...(Args)>&
+        inputs_info,
+    const Tensor& out,
+    store_compute_block_to_tensor_fn<CTYPE_COMPUTE>
+        store_compute_block_to_out) {
+  static constexpr auto kNumInputs = sizeof...(Args);
+  char* const data_out = reinterpret_cast<char*>(out.mutable_data_ptr());
+  const auto out_element_size = out.element_size();
+  const ssize_t row_size = shape.inner_size();
+  const size_t num_outer_dims = shape.dim - 1;
+  if (row_size == 0) {
+    return;
+  }
+
+  ::executorch::extension::parallel_for(
+      0,
+      out.numel(),
+      ::executorch::extension::internal::GRAIN_SIZE,
+      [&](const auto begin, const auto end) {
+        CTYPE_COMPUTE input_blocks[kNumInputs][kElementwiseBlockSize];
+        CTYPE_COMPUTE out_block[kElementwiseBlockSize];
+
+        // Index of the current row over the outer dimensions, and the
+        // offset of its start in each input.
+        typename CollapsedBroadcastShape<kNumInputs>::ShapeType outer_index =
+            {};
+        std::array<ssize_t, kNumInputs> row_offsets = {};
+        // For inputs broadcast within a row, the offset of the value that
+        // input_blocks holds; -1 if none.
+        std::array<ssize_t, kNumInputs> splatted_offsets;
+        splatted_offsets.fill(-1);
+
+        ssize_t row = begin / row_size;
+        ssize_t col = begin % row_size;
+        for (size_t dim = num_outer_dims; dim > 0; --dim) {
+          outer_index[dim - 1] = row % shape.sizes[dim - 1];
+          row /= shape.sizes[dim - 1];
+          for (const auto input_idx : c10::irange(kNumInputs)) {
+            row_offsets[input_idx] +=
+                outer_index[dim - 1] * shape.strides[input_idx][dim - 1];
+          }
+        }
+
+        for (ssize_t idx = begin; idx < end;) {
+          const ssize_t row_end = std::min<ssize_t>(row_size, col + end - idx);
+          for (const auto input_idx : c10::irange(kNumInputs)) {
+            const auto& input_info = inputs_info[input_idx];
+            const auto offset = row_offsets[input_idx];
+            if (shape.inner_stride(input_idx) != 0 ||
+                splatted_offsets[input_idx] == offset) {
+              continue;
+            }
+            const char* const data =
+                &input_info.data_ptr[offset * input_info.element_size];
+            CTYPE_COMPUTE value;
+            if (input_info.load_block_to_compute != nullptr) {
+              input_info.load_block_to_compute(data, &value, 1);
+            } else {
+              value = *reinterpret_cast<const CTYPE_COMPUTE*>(data);
+            }
+            std::fill_n(input_blocks[input_idx], kElementwiseBlockSize, value);
+            splatted_offsets[input_idx] = offset;
+          }
+
+          for (ssize_t block_begin = col; block_begin < row_end;
+               block_begin += kElementwiseBlockSize) {
+            const size_t n = std::min<size_t>(
+                kElementwiseBlockSize, row_end - block_begin);
+            std::array<const CTYPE_COMPUTE*, kNumInputs> block_inputs{};
+            for (const auto input_idx : c10::irange(kNumInputs)) {
+              const auto& input_info = inputs_info[input_idx];
+              const char* const data = &input_info.data_ptr
+                  [(row_offsets[input_idx] + block_begin) *
+                   input_info.element_size];
+              if (shape.inner_stride(input_idx) == 0) {
+                block_inputs[input_idx] = input_blocks[input_idx];
+              } else if (input_info.load_block_to_compute == nullptr) {
+                block_inputs[input_idx] =
+                    reinterpret_cast<const CTYPE_COMPUTE*>(data);
+              } else {
+                input_info.load_block_to_compute(
+                    data, input_blocks[input_idx], n);
+                block_inputs[input_idx] = input_blocks[input_idx];
+              }
+            }
+
+            char* const block_out =
+                &data_out[(idx + block_begin - col) * out_element_size];
+            if (store_compute_block_to_out == nullptr) {
+              apply_compute_fn_to_block<CTYPE_COMPUTE, Op, Args...>(
+                  compute_fun,
+                  block_inputs,
+                  reinterpret_cast<CTYPE_COMPUTE*>(block_out),
+                  n);
+            } else {
+              apply_compute_fn_to_block<CTYPE_COMPUTE, Op, Args...>(
+                  compute_fun, block_inputs, out_block, n);
+              store_compute_block_to_out(out_block, block_out, n);
+            }
+          }
+
+          idx += row_end - col;
+          col = 0;
+          // Step to the next row.
+          for (size_t dim = num_outer_dims; dim > 0; --dim) {
+            if (++outer_index[dim - 1] < shape.sizes[dim - 1]) {
+              for (const auto input_idx : c10::irange(kNumInputs)) {
+                row_offsets[input_idx] += shape.strides[input_idx][dim - 1];
+              }
+              break;
+            }
+            outer_index[dim - 1] = 0;
+            for (const auto input_idx : c10::irange(kNumInputs)) {
+              row_offsets[input_idx] -= (shape.sizes[dim - 1] - 1) *
+                  shape.strides[input_idx][dim - 1];
+            }
+          }
+        }
+      });
+}
+
+/**
+ * Mixed-dtype path of apply_elementwise_fn_generic_impl() for the
+ * broadcasts that apply_compute_fn_to_collapsed_rows() supports. Rather than
+ * converting each element through a function pointer, it converts blocks of
+ * each input to CTYPE_COMPUTE and the result blocks to the output dtype.
+ * Inputs and outputs that already have the compute dtype are used in place.
+ */
+template <
+    typename CTYPE_COMPUTE,
+    const char* op_name,
+    typename Op,
+    typename... Args>
+inline void apply_elementwise_fn_block_convert_impl(
+    const Op& compute_fun,
+    KernelRuntimeContext& ctx,
+    const Tensor& out,
+    SupportedTensorDtypes out_dtypes,
+    const CollapsedBroadcastShape<sizeof...(Args)>& shape,
+    Args... inputs) {
+  static constexpr auto kNumInputs = sizeof...(inputs);
+  constexpr auto compute_type = CppTypeToScalarType<CTYPE_COMPUTE>::value;
+
+  const std::array<BlockInputInfo<CTYPE_COMPUTE>, kNumInputs> inputs_info = {
+      (BlockInputInfo<CTYPE_COMPUTE>{
+          inputs.first->scalar_type() == compute_type
+              ? nullptr
+              : internal::get_load_block_to_compute_fn<CTYPE_COMPUTE, op_name>(
+                    ctx, *inputs.first, inputs.second),
+          reinterpret_cast<const char*>(inputs.first->const_data_ptr()),
+          inputs.first->element_size(),
+      })...};
+
+  const auto store_compute_block_to_out = out.scalar_type() == compute_type
+      ? nullptr
+      : internal::get_store_compute_block_to_tensor_fn<CTYPE_COMPUTE, op_name>(
+            ctx, out, out_dtypes);
+  if (ctx.failure_state() != Error::Ok) {
+    return;
+  }
+
+  apply_compute_fn_to_collapsed_rows<CTYPE_COMPUTE, Op, Args...>(
+      compute_fun, shape, inputs_info, out, store_compute_block_to_out);
+}
+
 template <
     typename CTYPE_COMPUTE,
     typename CTYPE_OUT,
@@ -167,6 +468,28 @@ inline void dtype_specialized_elementwise_fn_impl(
   }
 #endif // ET_USE_PYTORCH_HEADERS
 
+  if constexpr (!support_noncontiguous_tensors) {
+    CollapsedBroadcastShape<kNumInputs> shape;
+    if (get_collapsed_rows_shape(out, shape, inputs...) &&
+        shape.inner_size() >= kMinCollapsedRowSize) {
+      const std::array<BlockInputInfo<CTYPE_COMPUTE>, kNumInputs>
+          inputs_info = {(BlockInputInfo<CTYPE_COMPUTE>{
+              nullptr,
+              reinterpret_cast<const char*>(inputs.first->const_data_ptr()),
+              sizeof(CTYPE_COMPUTE),
+          })...};
+      store_compute_block_to_tensor_fn<CTYPE_COMPUTE>
+          store_compute_block_to_out = nullptr;
+      if constexpr (!std::is_same_v<CTYPE_OUT, CTYPE_COMPUTE>) {
+        store_compute_block_to_out =
+            convert_and_store_block<CTYPE_OUT, CTYPE_COMPUTE>;
+      }
+      apply_compute_fn_to_collapsed_rows<CTYPE_COMPUTE, Op, Args...>(
+          compute_fun, shape, inputs_info, out, store_compute_block_to_out);
+      return;
+    }
+  }
+
   ::executorch::extension::parallel_for(
       0,
       out.numel(),
@@ -193,30 +516,6 @@ inline void dtype_specialized_elementwise_fn_impl(
       });
 }
 
-template <typename CTYPE_COMPUTE, typename... Args>
-inline bool validate_elementwise_fn_inputs(
-    KernelRuntimeContext& ctx,
-    const Tensor& out,
-    SupportedTensorDtypes out_dtypes,
-    Args... inputs) {
-  static_assert(
-      (std::is_same_v<Args, std::pair<const Tensor*, SupportedTensorDtypes>> &&
-       ...));
-  constexpr auto compute_type = CppTypeToScalarType<CTYPE_COMPUTE>::value;
-  const auto check_input_dtype = [](auto input, auto compute_type) {
-    return internal::check_tensor_dtype(
-        *input.first, input.second, compute_type);
-  };
-  ET_KERNEL_CHECK(
-      ctx,
-      (check_input_dtype(inputs, compute_type) && ...) &&
-          internal::check_tensor_dtype(out, out_dtypes, compute_type),
-      InvalidArgument,
-      false);
-
-  return true;
-}
-
 template <
     typename CTYPE_COMPUTE,
     const char* op_name,
@@ -231,6 +530,15 @@ inline void apply_elementwise_fn_generic_impl(
     Args... inputs) {
   static constexpr auto kNumInputs = sizeof...(inputs);
 
+  if constexpr (!support_noncontiguous_tensors) {
+    CollapsedBroadcastShape<kNumInputs> shape;
+    if (get_collapsed_rows_shape(out, shape, inputs...)) {
+      apply_elementwise_fn_block_convert_impl<CTYPE_COMPUTE, op_name>(
+          compute_fun, ctx, out, out_dtypes, shape, inputs...);
+      return;
+    }
+  }
+
   struct InputInfo {
     load_to_compute_fn<CTYPE_COMPUTE> load_to_compute;
     const char* data_ptr;
@@ -0,0 +1,449 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <executorch/runtime/kernel/kernel_includes.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+
+namespace torch {
+namespace executor {
+
+// How many rows ahead of the one being copied gather_rows prefetches.
+constexpr int64_t kGatherPrefetchDistance = 8;
+// Rows of at least this many bytes are prefetched. Smaller rows usually come
+// from tables that stay in cache.
+constexpr size_t kGatherPrefetchMinRowBytes = 64;
+// Bytes, or elements for the typed variants, of the column chunks that
+// scatters split rows into to spread them across threads.
+constexpr int64_t kScatterChunkSize = 4096;
+
+namespace internal {
+
+inline void prefetch_for_read(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address, /*rw=*/0);
+#else
+  (void)address;
+#endif
+}
+
+// Maps a negative index, counted from the end of a dimension of length
+// `dim_length`, to the equivalent non-negative one.
+template <typename INDEX>
+int64_t wrap_gather_index(INDEX index, int64_t dim_length) {
+  return index < 0 ? static_cast<int64_t>(index) + dim_length
+                   : static_cast<int64_t>(index);
+}
+
+// Units of work of `unit_size` elements that parallel_for gives each thread
+// at least.
+inline int64_t gather_grain_size(int64_t unit_size) {
+  return std::max<int64_t>(
+      1,
+      ::executorch::extension::internal::GRAIN_SIZE /
+          std::max<int64_t>(1, unit_size));
+}
+
+// Calls fn(std::integral_constant<size_t, kRowBytes>()), where kRowBytes is
+// `row_bytes` for the sizes of small rows and 0 otherwise. Copies of rows of a
+// size known at compile time are single loads and stores rather than calls to
+// memcpy.
+template <typename Fn>
+void with_row_bytes(size_t row_bytes, const Fn& fn) {
+  switch (row_bytes) {
+    case 1:
+      fn(std::integral_constant<size_t, 1>());
+      break;
+    case 2:
+      fn(std::integral_constant<size_t, 2>());
+      break;
+    case 4:
+      fn(std::integral_constant<size_t, 4>());
+      break;
+    case 8:
+      fn(std::integral_constant<size_t, 8>());
+      break;
+    case 16:
+      fn(std::integral_constant<size_t, 16>());
+      break;
+    default:
+      fn(std::integral_constant<size_t, 0>());
+      break;
+  }
+}
+
+// Copies rows [begin, end) of gather_rows. kRowBytes is the size of the rows
+// when it is known at compile time, and 0 otherwise.
+template <size_t kRowBytes, typename INDEX>
+void gather_row_range(
+    const char* in,
+    char* out,
+    const INDEX* index,
+    int64_t num_indices,
+    int64_t in_dim_length,
+    size_t row_bytes,
+    int64_t begin,
+    int64_t end) {
+  const size_t bytes = kRowBytes != 0 ? kRowBytes : row_bytes;
+  const bool prefetch = bytes >= kGatherPrefetchMinRowBytes;
+  int64_t slice = begin / num_indices;
+  int64_t j = begin % num_indices;
+  char* dst = out + begin * bytes;
+  for (int64_t r = begin; r < end; ++slice, j = 0) {
+    const char* const src = in + slice * in_dim_length * bytes;
+    const int64_t j_end = std::min(num_indices, j + (end - r));
+    for (; j < j_end; ++j, ++r, dst += bytes) {
+      if (prefetch && j + kGatherPrefetchDistance < j_end) {
+        prefetch_for_read(
+            src +
+            wrap_gather_index(
+                index[j + kGatherPrefetchDistance], in_dim_length) *
+                bytes);
+      }
+      std::memcpy(
+          dst, src + wrap_gather_index(index[j], in_dim_length) * bytes, bytes);
+    }
+  }
+}
+
+// Calls fn(slice, col_begin, col_end) for the column chunks of the rows of
+// every slice, spread across threads. Each call covers a disjoint part of the
+// output, so scatters with repeated indices stay ordered and race free.
+template <typename Fn>
+void for_each_scatter_chunk(
+    int64_t leading,
+    int64_t num_indices,
+    int64_t row_size,
+    const Fn& fn) {
+  const int64_t num_chunks = (row_size + kScatterChunkSize - 1) /
+      kScatterChunkSize;
+  ::executorch::extension::parallel_for(
+      0,
+      leading * num_chunks,
+      gather_grain_size(
+          num_indices * std::min<int64_t>(row_size, kScatterChunkSize)),
+      [&](const int64_t begin, const int64_t end) {
+        for (int64_t unit = begin; unit < end; ++unit) {
+          const int64_t col_begin = (unit % num_chunks) * kScatterChunkSize;
+          fn(unit / num_chunks,
+             col_begin,
+             std::min(row_size, col_begin + kScatterChunkSize));
+        }
+      });
+}
+
+} // namespace internal
+
+/**
+ * Gathers rows of `row_bytes` bytes: `in` holds `leading` slices of
+ * `in_dim_length` rows, and slice i of `out` gets the rows `index[0]`, ...,
+ * `index[num_indices - 1]` of slice i of `in`. This is index_select along a
+ * dimension, with the dimensions after it making up the rows. Negative
+ * indices count from the end; all indices must be in range.
+ *
+ * Rows are spread across threads, and the rows a few indices ahead are
+ * prefetched, since embedding tables are usually larger than the caches.
+ */
+template <typename INDEX>
+void gather_rows(
+    const char* in,
+    char* out,
+    const INDEX* index,
+    int64_t num_indices,
+    int64_t leading,
+    int64_t in_dim_length,
+    size_t row_bytes) {
+  if (num_indices == 0 || leading == 0 || row_bytes == 0) {
+    return;
+  }
+  ::executorch::extension::parallel_for(
+      0,
+      leading * num_indices,
+      internal::gather_grain_size(static_cast<int64_t>(row_bytes)),
+      [&](const int64_t begin, const int64_t end) {
+        internal::with_row_bytes(row_bytes, [&](const auto kRowBytes) {
+          internal::gather_row_range<decltype(kRowBytes)::value>(
+              in,
+              out,
+              index,
+              num_indices,
+              in_dim_length,
+              row_bytes,
+              begin,
+              end);
+        });
+      });
+}
+
+/**
+ * The inverse of gather_rows: row j of slice i of `src` is copied to row
+ * `index[j]` of slice i of `out`, which has `out_dim_length` rows per slice.
+ * When an index repeats, the last row copied to it wins, like when copying
+ * one row after the other. Work is split across slices and column chunks of
+ * the rows, so every row of `out` is only written by one thread.
+ */
+template <typename INDEX>
+void scatter_rows(
+    const char* src,
+    char* out,
+    const INDEX* index,
+    int64_t num_indices,
+    int64_t leading,
+    int64_t out_dim_length,
+    size_t row_bytes) {
+  if (num_indices == 0 || leading == 0 || row_bytes == 0) {
+    return;
+  }
+  internal::with_row_bytes(row_bytes, [&](const auto kRowBytes) {
+    internal::for_each_scatter_chunk(
+        leading,
+        num_indices,
+        static_cast<int64_t>(row_bytes),
+        [&](const int64_t slice,
+            const int64_t col_begin,
+            const int64_t col_end) {
+          // Small rows are never split, so they are copied whole.
+          const size_t bytes = kRowBytes != 0
+              ? kRowBytes
+              : static_cast<size_t>(col_end - col_begin);
+          const char* src_row =
+              src + slice * num_indices * row_bytes + col_begin;
+          char* const dst =
+              out + slice * out_dim_length * row_bytes + col_begin;
+          for (int64_t j = 0; j < num_indices; ++j, src_row += row_bytes) {
+            std::memcpy(
+                dst +
+                    internal::wrap_gather_index(index[j], out_dim_length) *
+                        row_bytes,
+                src_row,
+                bytes);
+          }
+        });
+  });
+}
+
+/**
+ * Like scatter_rows, but adds the rows of `src`, of `row_size` CTYPE values,
+ * to the rows of `out` instead of copying them. Rows with repeated indices
+ * are all added, in order.
+ */
+template <typename CTYPE, typename INDEX>
+void scatter_add_rows(
+    const CTYPE* src,
+    CTYPE* out,
+    const INDEX* index,
+    int64_t num_indices,
+    int64_t leading,
+    int64_t out_dim_length,
+    int64_t row_size) {
+  if (num_indices == 0 || leading == 0 || row_size == 0) {
+    return;
+  }
+  internal::for_each_scatter_chunk(
+      leading,
+      num_indices,
+      row_size,
+      [&](const int64_t slice, const int64_t col_begin, const int64_t col_end) {
+        const CTYPE* src_row =
+            src + slice * num_indices * row_size + col_begin;
+        CTYPE* const dst = out + slice * out_dim_length * row_size + col_begin;
+        for (int64_t j = 0; j < num_indices; ++j, src_row += row_size) {
+          CTYPE* const dst_row =
+              dst +
+              internal::wrap_gather_index(index[j], out_dim_length) * row_size;
+          for (int64_t k = 0; k < col_end - col_begin; ++k) {
+            dst_row[k] += src_row[k];
+          }
+        }
+      });
+}
+
+/**
+ * Returns true if `t` is laid out contiguously, ignoring the strides of
+ * dimensions of size 1. Unlike tensor_is_contiguous, this is meant for picking
+ * a fast path, so it does not log.
+ */
+inline bool has_contiguous_strides(const Tensor& t) {
+  int64_t expected_stride = 1;
+  for (int64_t d = t.dim() - 1; d >= 0; --d) {
+    if (t.size(d) != 1 && t.strides()[d] != expected_stride) {
+      return false;
+    }
+    expected_stride *= t.size(d);
+  }
+  return true;
+}
+
+/**
+ * Describes indexing a tensor along `dim` with an index tensor of the same
+ * rank, like gather and scatter do: the index is viewed as
+ * [outer][index_length][inner], where `inner` covers the dimensions after
+ * `dim`, which must have the same sizes in both tensors so that the inner
+ * values are contiguous in both.
+ */
+struct IndexAlongDim {
+  int64_t outer;
+  int64_t index_length;
+  int64_t inner;
+};
+
+namespace internal {
+
+// Returns the offset in `t` of the first element of row `outer` of an
+// IndexAlongDim of `index`.
+inline int64_t outer_offset(
+    const Tensor& t,
+    const Tensor& index,
+    int64_t dim,
+    int64_t outer) {
+  int64_t offset = 0;
+  for (int64_t d = dim - 1; d >= 0; --d) {
+    offset += (outer % index.size(d)) * t.strides()[d];
+    outer /= index.size(d);
+  }
+  return offset;
+}
+
+} // namespace internal
+
+/**
+ * Returns true and fills `along` if indexing `t` along `dim` with `index`
+ * can run on contiguous inner values. `t` and `index` must have the same
+ * non-zero rank and contiguous strides.
+ */
+inline bool get_index_along_dim(
+    const Tensor& t,
+    int64_t dim,
+    const Tensor& index,
+    IndexAlongDim* along) {
+  if (index.dim() == 0 || t.dim() != index.dim() ||
+      !has_contiguous_strides(t) ||
+      !has_contiguous_strides(index)) {
+    return false;
+  }
+  along->outer = 1;
+  along->index_length = index.size(dim);
+  along->inner = 1;
+  for (int64_t d = 0; d < index.dim(); ++d) {
+    if (d < dim) {
+      along->outer *= index.size(d);
+    } else if (d > dim) {
+      if (index.size(d) != t.size(d)) {
+        return false;
+      }
+      along->inner *= index.size(d);
+    }
+  }
+  return true;
+}
+
+/**
+ * gather along `dim`: out[..., j, ...] = in[..., index[..., j, ...], ...].
+ * Returns false, without writing anything, if the tensors do not fit an
+ * IndexAlongDim; `out` has the sizes of `index`. Output rows are spread
+ * across threads.
+ */
+template <typename CTYPE>
+bool gather_along_dim(
+    const Tensor& in,
+    int64_t dim,
+    const Tensor& index,
+    Tensor& out) {
+  IndexAlongDim along;
+  if (!get_index_along_dim(in, dim, index, &along) ||
+      !has_contiguous_strides(out)) {
+    return false;
+  }
+  const CTYPE* const in_data = in.const_data_ptr<CTYPE>();
+  const int64_t* const index_data = index.const_data_ptr<int64_t>();
+  CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+  const int64_t inner = along.inner;
+  const int64_t dim_stride = in.strides()[dim];
+  ::executorch::extension::parallel_for(
+      0,
+      along.outer * along.index_length,
+      internal::gather_grain_size(inner),
+      [&](const int64_t begin, const int64_t end) {
+        int64_t outer = -1;
+        int64_t in_offset = 0;
+        for (int64_t row = begin; row < end; ++row) {
+          if (row / along.index_length != outer) {
+            outer = row / along.index_length;
+            in_offset = internal::outer_offset(in, index, dim, outer);
+          }
+          const CTYPE* const in_row = in_data + in_offset;
+          const int64_t* const index_row = index_data + row * inner;
+          CTYPE* const out_row = out_data + row * inner;
+          if (inner == 1) {
+            out_row[0] = in_row[index_row[0] * dim_stride];
+          } else {
+            for (int64_t k = 0; k < inner; ++k) {
+              out_row[k] = in_row[index_row[k] * dim_stride + k];
+            }
+          }
+        }
+      });
+  return true;
+}
+
+/**
+ * scatter along `dim`: calls op(out[..., index[..., j, ...], ...],
+ * src[..., j, ...]) for every element of `index`, where `src` is at least as
+ * large as `index`. Returns false, without calling `op`, if the tensors do
+ * not fit an IndexAlongDim. Elements that land on the same output are
+ * visited in the order of `index`, and work is split so that every output
+ * element is only visited by one thread.
+ */
+template <typename CTYPE, typename Op>
+bool scatter_along_dim(
+    const Tensor& src,
+    int64_t dim,
+    const Tensor& index,
+    Tensor& out,
+    const Op& op) {
+  IndexAlongDim along;
+  IndexAlongDim unused;
+  if (!get_index_along_dim(out, dim, index, &along) ||
+      !get_index_along_dim(src, dim, index, &unused)) {
+    return false;
+  }
+  const CTYPE* const src_data = src.const_data_ptr<CTYPE>();
+  const int64_t* const index_data = index.const_data_ptr<int64_t>();
+  CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+  const int64_t src_dim_stride = src.strides()[dim];
+  const int64_t out_dim_stride = out.strides()[dim];
+  internal::for_each_scatter_chunk(
+      along.outer,
+      along.index_length,
+      along.inner,
+      [&](const int64_t outer, const int64_t col_begin, const int64_t col_end) {
+        const CTYPE* src_row = src_data +
+            internal::outer_offset(src, index, dim, outer) + col_begin;
+        CTYPE* const out_slice = out_data +
+            internal::outer_offset(out, index, dim, outer) + col_begin;
+        const int64_t* index_row = index_data +
+            outer * along.index_length * along.inner + col_begin;
+        for (int64_t j = 0; j < along.index_length; ++j) {
+          for (int64_t k = 0; k < col_end - col_begin; ++k) {
+            op(out_slice[index_row[k] * out_dim_stride + k], src_row[k]);
+          }
+          src_row += src_dim_stride;
+          index_row += along.inner;
+        }
+      });
+  return true;
+}
+
+} // namespace executor
+} // namespace torch
@@ -10,6 +10,7 @@
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <executorch/runtime/core/exec_aten/util/tensor_util.h>
 #include <executorch/runtime/platform/assert.h>
+#include <algorithm>
 #include <cstring>
 
 namespace torch {
@@ -204,6 +205,53 @@ size_t get_init_index(
   return init_ix;
 }
 
+bool get_reduction_groups(
+    const Tensor& in,
+    const std::optional<executorch::aten::ArrayRef<int64_t>>& dim_list,
+    ReductionGroups* groups) {
+  bool is_reduced[kTensorDimensionLimit];
+  const bool reduce_all =
+      !dim_list.has_value() || dim_list.value().size() == 0;
+  std::fill(is_reduced, is_reduced + in.dim(), reduce_all);
+  if (!reduce_all && in.dim() > 0) {
+    for (const auto& d : dim_list.value()) {
+      is_reduced[_normalize_non_neg_d(d, in.dim())] = true;
+    }
+  }
+
+  // Walk the dimensions from the innermost, then reverse the groups.
+  size_t size = 0;
+  int64_t stride = 1;
+  for (int64_t d = in.dim() - 1; d >= 0; --d) {
+    if (in.size(d) == 1) {
+      continue;
+    }
+    if (in.strides()[d] != stride) {
+      return false;
+    }
+    if (size > 0 && groups->reduced[size - 1] == is_reduced[d]) {
+      groups->sizes[size - 1] *= in.size(d);
+    } else {
+      groups->sizes[size] = in.size(d);
+      groups->strides[size] = stride;
+      groups->reduced[size] = is_reduced[d];
+      ++size;
+    }
+    stride *= in.size(d);
+  }
+  if (size == 0) {
+    groups->sizes[0] = 1;
+    groups->strides[0] = 1;
+    groups->reduced[0] = false;
+    size = 1;
+  }
+  std::reverse(groups->sizes, groups->sizes + size);
+  std::reverse(groups->strides, groups->strides + size);
+  std::reverse(groups->reduced, groups->reduced + size);
+  groups->size = size;
+  return true;
+}
+
 //
 // Resize out tensor of reduction op
 //
@@ -11,8 +11,11 @@
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <executorch/runtime/core/exec_aten/util/tensor_util.h>
 #include <executorch/runtime/kernel/thread_parallel_interface.h>
+#include <algorithm>
 #include <cstring>
+#include <limits>
 #include <tuple>
+#include <type_traits>
 
 namespace torch {
 namespace executor {
@@ -687,6 +690,521 @@ CTYPE reduce_over_dim_list(
   return plan.execute<CTYPE>(reduce_fun, out_ix);
 }
 
+//
+// Reductions over contiguous tensors
+//
+
+/**
+ * The dimensions of a contiguous tensor grouped for a reduction. Adjacent
+ * dimensions that are all reduced or all kept merge into one group, and
+ * dimensions of size 1 are dropped, so reduced and kept groups alternate.
+ * Groups are ordered from the outermost to the innermost, and there is always
+ * at least one.
+ */
+struct ReductionGroups {
+  size_t size;
+  int64_t sizes[kTensorDimensionLimit];
+  int64_t strides[kTensorDimensionLimit];
+  bool reduced[kTensorDimensionLimit];
+};
+
+/**
+ * Fills `groups` for reducing `in` over `dim_list`, where a null or empty
+ * `dim_list` reduces over all the dimensions. Returns false if `in` is not
+ * contiguous.
+ */
+bool get_reduction_groups(
+    const executorch::aten::Tensor& in,
+    const std::optional<executorch::aten::ArrayRef<int64_t>>& dim_list,
+    ReductionGroups* groups);
+
+namespace internal {
+
+// Values that reductions over contiguous values convert and reduce at a time.
+constexpr int64_t kReduceBlockSize = 256;
+// Independent accumulators of the reductions over contiguous values, which
+// the compiler keeps in the lanes of vector registers.
+constexpr int64_t kReduceLanes = 8;
+// Columns that reductions over rows accumulate at a time.
+constexpr int64_t kReduceRowBlockSize = 64;
+// Most chunks that the reduction of an output is split into, to spread it
+// across threads when there are few outputs.
+constexpr int64_t kMaxReduceChunks = 16;
+// Fewest values in each of those chunks.
+constexpr int64_t kMinReduceChunkSize = 16384;
+
+// Returns `x` if it already holds ACC values, otherwise converts its `n`
+// values into `buffer` and returns that.
+template <typename ACC, typename T>
+const ACC* load_reduce_block(const T* x, int64_t n, ACC* buffer) {
+  if constexpr (std::is_same_v<ACC, T>) {
+    (void)n;
+    (void)buffer;
+    return x;
+  } else {
+    for (int64_t i = 0; i < n; ++i) {
+      buffer[i] = static_cast<ACC>(x[i]);
+    }
+    return buffer;
+  }
+}
+
+// Calls `fn` with `width`, as a compile-time constant when it is a full
+// kReduceRowBlockSize, so that loops over full row blocks have a trip count
+// the compiler can vectorize without a cost model.
+template <typename Fn>
+void with_row_block_width(int64_t width, const Fn& fn) {
+  if (width == kReduceRowBlockSize) {
+    fn(std::integral_constant<int64_t, kReduceRowBlockSize>());
+  } else {
+    fn(width);
+  }
+}
+
+// Reduces the values in the lanes of `lanes` with `combine` pairwise.
+template <typename ACC, typename Combine>
+ACC combine_reduce_lanes(ACC* lanes, const Combine& combine) {
+  for (int64_t width = kReduceLanes / 2; width > 0; width /= 2) {
+    for (int64_t l = 0; l < width; ++l) {
+      lanes[l] = combine(lanes[l], lanes[l + width]);
+    }
+  }
+  return lanes[0];
+}
+
+} // namespace internal
+
+/**
+ * Reducer for ContiguousReductionPlan that sums values cast to ACC.
+ * Floating-point sums are pairwise over contiguous values and compensated
+ * (Kahan) over rows, so their error grows with the logarithm of the number of
+ * values, or not at all, rather than linearly.
+ */
+template <typename ACC>
+struct SumReducer {
+  using acc_type = ACC;
+
+  ACC identity() const {
+    return ACC(0);
+  }
+
+  ACC combine(ACC a, ACC b) const {
+    return a + b;
+  }
+
+  // Returns the sum of the `n` contiguous values at `x`.
+  template <typename T>
+  ACC reduce(const T* x, int64_t n) const {
+    using internal::kReduceBlockSize;
+    if constexpr (std::is_floating_point_v<ACC>) {
+      if (n > kReduceBlockSize) {
+        const int64_t half =
+            (n / 2 + kReduceBlockSize - 1) / kReduceBlockSize *
+            kReduceBlockSize;
+        return reduce(x, half) + reduce(x + half, n - half);
+      }
+      return reduce_block(x, n);
+    } else {
+      ACC sum = 0;
+      for (int64_t i = 0; i < n; i += kReduceBlockSize) {
+        sum += reduce_block(x + i, std::min(kReduceBlockSize, n - i));
+      }
+      return sum;
+    }
+  }
+
+  // Adds the `rows` rows of `width` <= kReduceRowBlockSize contiguous values
+  // at `x`, `stride` apart, to `acc`.
+  template <typename T>
+  void reduce_rows(
+      const T* x,
+      int64_t rows,
+      int64_t stride,
+      int64_t width,
+      ACC* acc) const {
+    internal::with_row_block_width(width, [&](const auto width) {
+      ACC buffer[internal::kReduceRowBlockSize];
+      ACC sum[internal::kReduceRowBlockSize];
+      std::copy(acc, acc + width, sum);
+      if constexpr (std::is_floating_point_v<ACC>) {
+        ACC compensation[internal::kReduceRowBlockSize] = {};
+        for (int64_t r = 0; r < rows; ++r) {
+          const ACC* const row =
+              internal::load_reduce_block(x + r * stride, width, buffer);
+          for (int64_t w = 0; w < width; ++w) {
+            const ACC y = row[w] - compensation[w];
+            const ACC t = sum[w] + y;
+            compensation[w] = (t - sum[w]) - y;
+            sum[w] = t;
+          }
+        }
+      } else {
+        for (int64_t r = 0; r < rows; ++r) {
+          const ACC* const row =
+              internal::load_reduce_block(x + r * stride, width, buffer);
+          for (int64_t w = 0; w < width; ++w) {
+            sum[w] += row[w];
+          }
+        }
+      }
+      std::copy(sum, sum + width, acc);
+    });
+  }
+
+ private:
+  // Returns the sum of the n <= kReduceBlockSize contiguous values at `x`.
+  template <typename T>
+  ACC reduce_block(const T* x, int64_t n) const {
+    // Lets the compiler bound the loops by the size of the buffer.
+    n = std::min(n, internal::kReduceBlockSize);
+    ACC buffer[internal::kReduceBlockSize];
+    const ACC* const values = internal::load_reduce_block(x, n, buffer);
+    ACC lanes[internal::kReduceLanes] = {};
+    int64_t i = 0;
+    for (; i + internal::kReduceLanes <= n; i += internal::kReduceLanes) {
+      for (int64_t l = 0; l < internal::kReduceLanes; ++l) {
+        lanes[l] += values[i + l];
+      }
+    }
+    for (; i < n; ++i) {
+      lanes[0] += values[i];
+    }
+    return internal::combine_reduce_lanes(
+        lanes, [](ACC a, ACC b) { return a + b; });
+  }
+};
+
+/**
+ * Reducer for ContiguousReductionPlan that finds the largest (kIsMax) or the
+ * smallest value cast to ACC. NaN wins over every other value, like in
+ * PyTorch.
+ */
+template <typename ACC, bool kIsMax>
+struct ExtremumReducer {
+  using acc_type = ACC;
+
+  ACC identity() const {
+    if constexpr (std::numeric_limits<ACC>::has_infinity) {
+      return kIsMax ? -std::numeric_limits<ACC>::infinity()
+                    : std::numeric_limits<ACC>::infinity();
+    } else {
+      return kIsMax ? std::numeric_limits<ACC>::lowest()
+                    : std::numeric_limits<ACC>::max();
+    }
+  }
+
+  ACC combine(ACC acc, ACC v) const {
+    // v != v only holds for NaN.
+    return v != v || (kIsMax ? v > acc : v < acc) ? v : acc;
+  }
+
+  template <typename T>
+  ACC reduce(const T* x, int64_t n) const {
+    ACC buffer[internal::kReduceBlockSize];
+    ACC lanes[internal::kReduceLanes];
+    std::fill(lanes, lanes + internal::kReduceLanes, identity());
+    for (int64_t begin = 0; begin < n; begin += internal::kReduceBlockSize) {
+      const int64_t size = std::min(internal::kReduceBlockSize, n - begin);
+      const ACC* const values =
+          internal::load_reduce_block(x + begin, size, buffer);
+      int64_t i = 0;
+      for (; i + internal::kReduceLanes <= size;
+           i += internal::kReduceLanes) {
+        for (int64_t l = 0; l < internal::kReduceLanes; ++l) {
+          lanes[l] = combine(lanes[l], values[i + l]);
+        }
+      }
+      for (; i < size; ++i) {
+        lanes[0] = combine(lanes[0], values[i]);
+      }
+    }
+    return internal::combine_reduce_lanes(
+        lanes, [this](ACC a, ACC b) { return combine(a, b); });
+  }
+
+  template <typename T>
+  void reduce_rows(
+      const T* x,
+      int64_t rows,
+      int64_t stride,
+      int64_t width,
+      ACC* acc) const {
+    internal::with_row_block_width(width, [&](const auto width) {
+      ACC buffer[internal::kReduceRowBlockSize];
+      ACC result[internal::kReduceRowBlockSize];
+      std::copy(acc, acc + width, result);
+      for (int64_t r = 0; r < rows; ++r) {
+        const ACC* const row =
+            internal::load_reduce_block(x + r * stride, width, buffer);
+        for (int64_t w = 0; w < width; ++w) {
+          result[w] = combine(result[w], row[w]);
+        }
+      }
+      std::copy(result, result + width, acc);
+    });
+  }
+};
+
+template <typename ACC>
+using MaxReducer = ExtremumReducer<ACC, /*kIsMax=*/true>;
+
+template <typename ACC>
+using MinReducer = ExtremumReducer<ACC, /*kIsMax=*/false>;
+
+/**
+ * The type that reductions of CTYPE values accumulate in: float for Half and
+ * BFloat16, and CTYPE otherwise.
+ */
+template <typename CTYPE>
+using reduce_acc_t = std::conditional_t<
+    std::is_same_v<CTYPE, executorch::aten::Half> ||
+        std::is_same_v<CTYPE, executorch::aten::BFloat16>,
+    float,
+    CTYPE>;
+
+/**
+ * Execution plan for reducing a contiguous tensor over a list of dimensions
+ * with loops that walk the input in memory order, as an alternative to
+ * calling {map_,}reduce_over_dim_list for every output element.
+ *
+ * When the innermost dimensions are reduced, every output reduces contiguous
+ * runs of values. When they are kept, rows of outputs accumulate rows of the
+ * input, like when reducing over the outer dimensions. Work is split across
+ * threads over the outputs, or over the reduced values when there are too few
+ * outputs to keep the threads busy. The split only depends on the shapes, so
+ * results do not depend on the number of threads.
+ *
+ * The Reducer has an `acc_type` and the following methods:
+ *
+ *   acc_type identity() const;
+ *   acc_type combine(acc_type acc, acc_type v) const;
+ *   // Reduces the n contiguous values at x.
+ *   acc_type reduce(const T* x, int64_t n) const;
+ *   // Combines the rows rows of width <= internal::kReduceRowBlockSize
+ *   // contiguous values at x, stride apart, into acc[0, width).
+ *   void reduce_rows(
+ *       const T* x, int64_t rows, int64_t stride, int64_t width,
+ *       acc_type* acc) const;
+ *
+ * SumReducer, MaxReducer and MinReducer implement it.
+ */
+class ContiguousReductionPlan {
+ public:
+  ContiguousReductionPlan(
+      const executorch::aten::Tensor& in,
+      const std::optional<executorch::aten::ArrayRef<int64_t>>& dim_list)
+      : in_(in) {
+    supported_ =
+        in.numel() > 0 && get_reduction_groups(in, dim_list, &groups_);
+  }
+
+  /**
+   * Whether the plan can run: false if the input is empty or not contiguous.
+   */
+  bool is_supported() const {
+    return supported_;
+  }
+
+  /**
+   * Reduces the input, of type CTYPE_IN, with `reducer`, and calls
+   * `store(out_ix, acc)` with the result of every output element. Calls for
+   * different output elements may run concurrently. Returns false if
+   * parallel_for failed.
+   */
+  template <typename CTYPE_IN, typename Reducer, typename Store>
+  [[nodiscard]] bool execute(const Reducer& reducer, const Store& store)
+      const {
+    ET_CHECK_MSG(supported_, "Unsupported contiguous reduction");
+    if (groups_.reduced[groups_.size - 1]) {
+      return reduce_inner<CTYPE_IN>(reducer, store);
+    }
+    return reduce_outer<CTYPE_IN>(reducer, store);
+  }
+
+ private:
+  // Returns the offset of index `ix` over the groups in [0, end) that are
+  // reduced, or kept.
+  int64_t group_offset(bool reduced, size_t end, int64_t ix) const {
+    int64_t offset = 0;
+    for (size_t g = end; g > 0; --g) {
+      if (groups_.reduced[g - 1] == reduced) {
+        offset += (ix % groups_.sizes[g - 1]) * groups_.strides[g - 1];
+        ix /= groups_.sizes[g - 1];
+      }
+    }
+    return offset;
+  }
+
+  int64_t group_numel(bool reduced, size_t end) const {
+    int64_t numel = 1;
+    for (size_t g = 0; g < end; ++g) {
+      if (groups_.reduced[g] == reduced) {
+        numel *= groups_.sizes[g];
+      }
+    }
+    return numel;
+  }
+
+  // The innermost group is reduced: every output reduces runs of `length`
+  // contiguous values, one for each index of the other reduced groups.
+  template <typename CTYPE_IN, typename Reducer, typename Store>
+  bool reduce_inner(const Reducer& reducer, const Store& store) const {
+    using ACC = typename Reducer::acc_type;
+    const CTYPE_IN* const data = in_.const_data_ptr<CTYPE_IN>();
+    const size_t outer_end = groups_.size - 1;
+    const int64_t length = groups_.sizes[outer_end];
+    const int64_t out_numel = group_numel(false, outer_end);
+    const int64_t runs = group_numel(true, outer_end);
+
+    // Reduces the values in [begin, end) of every run of output out_ix.
+    const auto reduce_runs = [&](int64_t out_ix, int64_t begin, int64_t end) {
+      const CTYPE_IN* const base =
+          data + group_offset(false, outer_end, out_ix) + begin;
+      ACC acc = reducer.identity();
+      for (int64_t run = 0; run < runs; ++run) {
+        acc = reducer.combine(
+            acc,
+            reducer.reduce(
+                base + group_offset(true, outer_end, run), end - begin));
+      }
+      return acc;
+    };
+
+    const int64_t chunks = std::min(
+        internal::kMaxReduceChunks, length / internal::kMinReduceChunkSize);
+    if (out_numel < internal::kMaxReduceChunks && chunks > 1) {
+      const int64_t chunk_size = (length + chunks - 1) / chunks;
+      for (int64_t out_ix = 0; out_ix < out_numel; ++out_ix) {
+        ACC partials[internal::kMaxReduceChunks];
+        const bool success = ::executorch::extension::parallel_for(
+            0, chunks, 1, [&](const int64_t begin, const int64_t end) {
+              for (int64_t chunk = begin; chunk < end; ++chunk) {
+                partials[chunk] = reduce_runs(
+                    out_ix,
+                    std::min(length, chunk * chunk_size),
+                    std::min(length, (chunk + 1) * chunk_size));
+              }
+            });
+        if (!success) {
+          return false;
+        }
+        ACC acc = partials[0];
+        for (int64_t chunk = 1; chunk < chunks; ++chunk) {
+          acc = reducer.combine(acc, partials[chunk]);
+        }
+        store(out_ix, acc);
+      }
+      return true;
+    }
+
+    return ::executorch::extension::parallel_for(
+        0,
+        out_numel,
+        std::max<int64_t>(
+            1,
+            ::executorch::extension::internal::GRAIN_SIZE / (runs * length)),
+        [&](const int64_t begin, const int64_t end) {
+          for (int64_t out_ix = begin; out_ix < end; ++out_ix) {
+            store(out_ix, reduce_runs(out_ix, 0, length));
+          }
+        });
+  }
+
+  // The innermost group is kept: rows of `width` outputs reduce `rows` rows
+  // of the input, `width` apart, for each index of the other reduced groups.
+  template <typename CTYPE_IN, typename Reducer, typename Store>
+  bool reduce_outer(const Reducer& reducer, const Store& store) const {
+    using ACC = typename Reducer::acc_type;
+    constexpr int64_t kBlock = internal::kReduceRowBlockSize;
+    const CTYPE_IN* const data = in_.const_data_ptr<CTYPE_IN>();
+    const size_t last = groups_.size - 1;
+    const int64_t width = groups_.sizes[last];
+    const bool has_rows = last > 0 && groups_.reduced[last - 1];
+    const size_t outer_end = has_rows ? last - 1 : last;
+    const int64_t rows = has_rows ? groups_.sizes[last - 1] : 1;
+    const int64_t out_rows = group_numel(false, outer_end);
+    const int64_t runs = group_numel(true, outer_end);
+    const int64_t column_blocks = (width + kBlock - 1) / kBlock;
+    const int64_t units = out_rows * column_blocks;
+
+    // Reduces rows [begin, end) of every run of the column block of unit
+    // into acc.
+    const auto reduce_unit_rows =
+        [&](int64_t unit, int64_t begin, int64_t end, ACC* acc) {
+          const int64_t column = (unit % column_blocks) * kBlock;
+          const CTYPE_IN* const base = data +
+              group_offset(false, outer_end, unit / column_blocks) + column +
+              begin * width;
+          std::fill(acc, acc + kBlock, reducer.identity());
+          for (int64_t run = 0; run < runs; ++run) {
+            reducer.reduce_rows(
+                base + group_offset(true, outer_end, run),
+                end - begin,
+                width,
+                std::min(kBlock, width - column),
+                acc);
+          }
+        };
+    const auto store_unit = [&](int64_t unit, const ACC* acc) {
+      const int64_t column = (unit % column_blocks) * kBlock;
+      const int64_t out_ix = unit / column_blocks * width + column;
+      for (int64_t w = 0; w < std::min(kBlock, width - column); ++w) {
+        store(out_ix + w, acc[w]);
+      }
+    };
+
+    const int64_t chunks = std::min(
+        internal::kMaxReduceChunks,
+        rows * std::min(kBlock, width) / internal::kMinReduceChunkSize);
+    if (units < internal::kMaxReduceChunks && chunks > 1) {
+      const int64_t chunk_rows = (rows + chunks - 1) / chunks;
+      for (int64_t unit = 0; unit < units; ++unit) {
+        ACC partials[internal::kMaxReduceChunks][kBlock];
+        const bool success = ::executorch::extension::parallel_for(
+            0, chunks, 1, [&](const int64_t begin, const int64_t end) {
+              for (int64_t chunk = begin; chunk < end; ++chunk) {
+                reduce_unit_rows(
+                    unit,
+                    std::min(rows, chunk * chunk_rows),
+                    std::min(rows, (chunk + 1) * chunk_rows),
+                    partials[chunk]);
+              }
+            });
+        if (!success) {
+          return false;
+        }
+        for (int64_t chunk = 1; chunk < chunks; ++chunk) {
+          for (int64_t w = 0; w < kBlock; ++w) {
+            partials[0][w] =
+                reducer.combine(partials[0][w], partials[chunk][w]);
+          }
+        }
+        store_unit(unit, partials[0]);
+      }
+      return true;
+    }
+
+    return ::executorch::extension::parallel_for(
+        0,
+        units,
+        std::max<int64_t>(
+            1,
+            ::executorch::extension::internal::GRAIN_SIZE /
+                (runs * rows * kBlock)),
+        [&](const int64_t begin, const int64_t end) {
+          ACC acc[kBlock];
+          for (int64_t unit = begin; unit < end; ++unit) {
+            reduce_unit_rows(unit, 0, rows, acc);
+            store_unit(unit, acc);
+          }
+        });
+  }
+
+  const executorch::aten::Tensor& in_;
+  bool supported_;
+  ReductionGroups groups_;
+};
+
 //
 // Compute reduced out tensor size and dim
 //
@@ -10,6 +10,7 @@
 #include <tuple>
 
 #include <c10/util/irange.h>
+#include <executorch/kernels/portable/cpu/util/concat_util.h>
 #include <executorch/kernels/portable/cpu/util/copy_ops_util.h>
 #include <executorch/kernels/portable/cpu/util/stack_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
@@ -97,6 +98,23 @@ Tensor& stack_out_impl(
   const size_t ninputs = tensors.size();
 
   const auto out_type = out.scalar_type();
+
+  // Without any conversion, stack only moves bytes.
+  bool same_dtypes = true;
+  for (size_t i = 0; i < ninputs; ++i) {
+    same_dtypes = same_dtypes && tensors[i].scalar_type() == out_type;
+  }
+  if (same_dtypes) {
+    const size_t row_bytes = inner * out.element_size();
+    concat_copy(
+        out.mutable_data_ptr<char>(),
+        outer,
+        ninputs,
+        [row_bytes](ET_UNUSED const size_t j) { return row_bytes; },
+        [&](const size_t j) { return tensors[j].const_data_ptr(); });
+    return out;
+  }
+
   ET_SWITCH_REALHBBF16_TYPES(out_type, ctx, "stack.out", CTYPE_OUT, [&] {
     CTYPE_OUT* out_ptr = out.mutable_data_ptr<CTYPE_OUT>();
     for (size_t i = 0; i < outer; ++i) {
@@ -19,7 +19,10 @@ def define_common_targets():
             "//executorch/kernels/portable/cpu/util:kernel_ops_util",
             "//executorch/kernels/portable/cpu:vec_ops",
             "//executorch/kernels/portable/cpu/util:matmul_ops_util",
+            "//executorch/kernels/portable/cpu/util:concat_util",
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            "//executorch/kernels/portable/cpu/util:dim_order_transpose_util",
+            "//executorch/kernels/portable/cpu/util:gather_util",
             "//executorch/kernels/portable/cpu/util:transpose_util",
             "//executorch/kernels/portable/cpu/util:index_util",
             "//executorch/kernels/portable/cpu/util:math_util",
@@ -98,6 +101,18 @@ def define_common_targets():
             "dtype_util.h",
         ],
         compiler_flags = ["-Wno-missing-prototypes"],
+        exported_deps = [
+            "//executorch/runtime/core/portable_type:scalar_type",
+        ] + (select({
+            # Zephyr builds use -fno-exceptions → ET_HAS_EXCEPTIONS=0 →
+            # ET_USE_PYTORCH_HEADERS=0, so ATen vectorization is unused.
+            "ovr_config//os:zephyr": [],
+            "DEFAULT": [
+                "//executorch/runtime/core/portable_type/c10/c10:aten_headers_for_executorch",
+            ],
+        }) if not runtime.is_oss else [
+            "//executorch/runtime/core/portable_type/c10/c10:aten_headers_for_executorch",
+        ]),
         deps = [
             "//executorch/runtime/kernel:kernel_includes",
         ],
@@ -159,6 +174,8 @@ def define_common_targets():
         compiler_flags = ["-Wno-missing-prototypes"],
         exported_deps = [
             ":broadcast_util",
+            ":dim_order_transpose_util",
+            "//executorch/runtime/core/portable_type:scalar_type",
         ],
         deps = [
             "//executorch/runtime/kernel:kernel_includes",
@@ -166,6 +183,43 @@ def define_common_targets():
         visibility = ["PUBLIC"],
     )
 
+    runtime.cxx_library(
+        name = "dim_order_transpose_util",
+        exported_headers = [
+            "dim_order_transpose_util.h",
+        ],
+        exported_deps = [
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/core/portable_type:scalar_type",
+            "//executorch/runtime/kernel:kernel_includes",
+        ],
+        visibility = ["PUBLIC"],
+    )
+
+    runtime.cxx_library(
+        name = "concat_util",
+        exported_headers = [
+            "concat_util.h",
+        ],
+        exported_deps = [
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/kernel:kernel_includes",
+        ],
+        visibility = ["PUBLIC"],
+    )
+
+    runtime.cxx_library(
+        name = "gather_util",
+        exported_headers = [
+            "gather_util.h",
+        ],
+        exported_deps = [
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/kernel:kernel_includes",
+        ],
+        visibility = ["PUBLIC"],
+    )
+
     runtime.cxx_library(
         name = "distance_util",
         srcs = ["distance_util.cpp"],
@@ -327,6 +381,7 @@ def define_common_targets():
         srcs = ["stack_util.cpp"],
         exported_headers = ["stack_util.h"],
         deps = [
+            "//executorch/kernels/portable/cpu/util:concat_util",
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
         ],
         exported_deps = [
@@ -16,6 +16,8 @@ using executorch::aten::ScalarType;
 using executorch::aten::Tensor;
 using executorch::runtime::testing::TensorFactory;
 using torch::executor::BroadcastIndexesRange;
+using torch::executor::collapse_broadcast_shape;
+using torch::executor::CollapsedBroadcastShape;
 using torch::executor::delinearize_index;
 using torch::executor::linearize_access_indexes;
 
@@ -264,3 +266,97 @@ TEST(BroadcastIndexesRangeTest, FourDBroadcastingWithOneDimsInOutput) {
   four_d_broadcasting_test<2, 3, 1, 5>();
   four_d_broadcasting_test<2, 1, 3, 1>();
 }
+
+template <size_t kNumInputs>
+void expect_collapsed_shape(
+    const CollapsedBroadcastShape<kNumInputs>& shape,
+    const std::vector<ssize_t>& sizes,
+    const std::array<std::vector<ssize_t>, kNumInputs>& strides) {
+  ASSERT_EQ(shape.dim, sizes.size());
+  EXPECT_EQ(
+      std::vector<ssize_t>(
+          shape.sizes.begin(), shape.sizes.begin() + shape.dim),
+      sizes);
+  for (const auto input_idx : c10::irange(kNumInputs)) {
+    EXPECT_EQ(
+        std::vector<ssize_t>(
+            shape.strides[input_idx].begin(),
+            shape.strides[input_idx].begin() + shape.dim),
+        strides[input_idx]);
+  }
+}
+
+TEST(BroadcastIndexesRangeTest, CollapseBroadcastShape) {
+  TensorFactory<ScalarType::Int> tf;
+
+  // [B, S, D] + [D]
+  Tensor out = tf.zeros({2, 3, 4});
+  expect_collapsed_shape<2>(
+      collapse_broadcast_shape(out, tf.zeros({2, 3, 4}), tf.zeros({4})),
+      {6, 4},
+      {{{4, 1}, {0, 1}}});
+  // [B, S, D] * [B, S, 1]
+  expect_collapsed_shape<2>(
+      collapse_broadcast_shape(out, tf.zeros({2, 3, 4}), tf.zeros({2, 3, 1})),
+      {6, 4},
+      {{{4, 1}, {1, 0}}});
+  // [S, D] broadcast over B, and a scalar.
+  expect_collapsed_shape<2>(
+      collapse_broadcast_shape(out, tf.zeros({1, 3, 4}), tf.zeros({})),
+      {2, 12},
+      {{{0, 1}, {0, 0}}});
+  // Not broadcast, and a scalar.
+  expect_collapsed_shape<2>(
+      collapse_broadcast_shape(out, out, tf.zeros({1})), {24}, {{{1}, {0}}});
+
+  // [B, H, S, S] * [B, 1, S, S], with dimensions of size 1 in the output.
+  Tensor attn = tf.zeros({2, 1, 3, 4, 4});
+  expect_collapsed_shape<2>(
+      collapse_broadcast_shape(attn, attn, tf.zeros({2, 1, 1, 4, 4})),
+      {2, 3, 16},
+      {{{48, 16, 1}, {16, 0, 1}}});
+
+  // Only dimensions of size 1.
+  Tensor scalar_out = tf.zeros({1, 1});
+  expect_collapsed_shape<1>(
+      collapse_broadcast_shape(scalar_out, tf.zeros({1})), {1}, {{{0}}});
+}
+
+// Walking the collapsed shape visits the same input elements as
+// BroadcastIndexesRange.
+TEST(BroadcastIndexesRangeTest, CollapseBroadcastShapeMatchesRange) {
+  TensorFactory<ScalarType::Int> tf;
+  Tensor out = tf.zeros({2, 3, 4, 5});
+  std::array<Tensor, 6> input_tensors = {
+      tf.zeros({2, 1, 4, 1}),
+      tf.zeros({1, 3, 1, 5}),
+      tf.zeros({3, 4, 5}),
+      tf.zeros({2, 3, 1, 1}),
+      tf.zeros({1, 1, 4, 5}),
+      tf.zeros({5}),
+  };
+  for (const auto& a : input_tensors) {
+    for (const auto& b : input_tensors) {
+      const auto shape = collapse_broadcast_shape(out, a, b);
+      std::array<ssize_t, executorch::runtime::kTensorDimensionLimit> index =
+          {};
+      for (const auto [out_idx, a_idx, b_idx] :
+           BroadcastIndexesRange<2>(out, a, b)) {
+        ssize_t collapsed_a_idx = 0;
+        ssize_t collapsed_b_idx = 0;
+        for (const auto dim : c10::irange(shape.dim)) {
+          collapsed_a_idx += index[dim] * shape.strides[0][dim];
+          collapsed_b_idx += index[dim] * shape.strides[1][dim];
+        }
+        EXPECT_EQ(collapsed_a_idx, a_idx) << "at output index " << out_idx;
+        EXPECT_EQ(collapsed_b_idx, b_idx) << "at output index " << out_idx;
+        for (size_t dim = shape.dim; dim > 0; --dim) {
+          if (++index[dim - 1] < shape.sizes[dim - 1]) {
+            break;
+          }
+          index[dim - 1] = 0;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Measures the copies of cat, stack, split and unbind in LLM and multimodal
+// models: appending a token to a KV cache, merging image and text
+// embeddings, stacking the heads of attention, and splitting fused QKV
+// projections. Each case runs through concat_util and, as a baseline,
+// through the loops the ops used before: one memcpy per row of every input
+// for cat, and one element at a time for the others. The bytes processed are
+// the bytes copied.
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <executorch/kernels/portable/cpu/util/concat_util.h>
+#include <executorch/runtime/platform/runtime.h>
+
+namespace {
+
+struct ConcatCase {
+  const char* name;
+  size_t outer;
+  // Elements of every part in each row.
+  std::vector<size_t> part_sizes;
+  // Whether the op packs the parts (cat, stack) or unpacks them (split,
+  // unbind).
+  bool pack;
+};
+
+const std::vector<ConcatCase>& cases() {
+  static const std::vector<ConcatCase> cases = {
+      // cat([k_cache, k_new], dim=2) for 32 heads of 128 channels and 2048
+      // cached positions.
+      {"cat_kv_cache_32x(2048+1)x128", 32, {2048 * 128, 128}, true},
+      // cat([image_embeddings, text_embeddings], dim=1) with a hidden size
+      // of 4096.
+      {"cat_multimodal_(576+512)x4096", 1, {576 * 4096, 512 * 4096}, true},
+      // stack of 8 heads of [64, 1024] along dim 1.
+      {"stack_8x64x1024_dim1",
+       64,
+       {1024, 1024, 1024, 1024, 1024, 1024, 1024, 1024},
+       true},
+      // split_with_sizes of a fused QKV projection of 128 tokens.
+      {"split_qkv_128x(3x4096)", 128, {4096, 4096, 4096}, false},
+      // unbind of a [4, 16, 4096] tensor along dim 1.
+      {"unbind_4x16x4096_dim1",
+       4,
+       std::vector<size_t>(16, 4096),
+       false},
+      // A small cat that only pays for overheads.
+      {"cat_small_4x(64+64)", 4, {64, 64}, true},
+  };
+  return cases;
+}
+
+void BM_ConcatCopy(
+    benchmark::State& state,
+    const ConcatCase& c,
+    bool baseline) {
+  size_t row_size = 0;
+  for (const auto size : c.part_sizes) {
+    row_size += size;
+  }
+  std::vector<float> packed(c.outer * row_size, 1.0f);
+  std::vector<std::vector<float>> parts;
+  for (const auto size : c.part_sizes) {
+    parts.emplace_back(c.outer * size, 2.0f);
+  }
+  const size_t num_parts = parts.size();
+  const auto part_row_bytes = [&](const size_t j) {
+    return c.part_sizes[j] * sizeof(float);
+  };
+
+  for (auto _ : state) {
+    if (baseline) {
+      float* packed_row = packed.data();
+      for (size_t i = 0; i < c.outer; ++i) {
+        for (size_t j = 0; j < num_parts; ++j) {
+          const size_t size = c.part_sizes[j];
+          float* const part_row = parts[j].data() + i * size;
+          if (c.pack) {
+            std::memcpy(packed_row, part_row, size * sizeof(float));
+          } else {
+            for (size_t k = 0; k < size; ++k) {
+              part_row[k] = packed_row[k];
+            }
+          }
+          packed_row += size;
+        }
+      }
+    } else if (c.pack) {
+      torch::executor::concat_copy(
+          reinterpret_cast<char*>(packed.data()),
+          c.outer,
+          num_parts,
+          part_row_bytes,
+          [&](const size_t j) { return parts[j].data(); });
+    } else {
+      torch::executor::split_concat_copy(
+          reinterpret_cast<const char*>(packed.data()),
+          c.outer,
+          num_parts,
+          part_row_bytes,
+          [&](const size_t j) { return parts[j].data(); });
+    }
+    benchmark::DoNotOptimize(packed.data());
+    benchmark::DoNotOptimize(parts.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(
+      state.iterations() * packed.size() * sizeof(float));
+}
+
+const bool registered = [] {
+  executorch::runtime::runtime_init();
+  for (const auto& c : cases()) {
+    for (const bool baseline : {true, false}) {
+      const std::string name = std::string("BM_ConcatCopy/") + c.name +
+          (baseline ? "/per_row" : "/concat_util");
+      benchmark::RegisterBenchmark(
+          name.c_str(), [&c, baseline](benchmark::State& state) {
+            BM_ConcatCopy(state, c, baseline);
+          });
+    }
+  }
+  return true;
+}();
+
+} // namespace
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/portable/cpu/util/concat_util.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+using torch::executor::concat_copy;
+using torch::executor::kConcatChunkBytes;
+using torch::executor::split_concat_copy;
+
+namespace {
+
+// Checks concat_copy and split_concat_copy against copying each row of each
+// part in turn, for parts with `part_sizes` bytes per row.
+void expect_concat_copy_matches(
+    size_t outer,
+    const std::vector<size_t>& part_sizes) {
+  size_t row_size = 0;
+  std::vector<std::vector<uint8_t>> parts;
+  for (const auto size : part_sizes) {
+    std::vector<uint8_t> part(outer * size);
+    for (size_t k = 0; k < part.size(); ++k) {
+      part[k] = static_cast<uint8_t>(k * 7 + parts.size() * 31 + 1);
+    }
+    parts.push_back(part);
+    row_size += size;
+  }
+
+  std::vector<uint8_t> expected;
+  for (size_t i = 0; i < outer; ++i) {
+    for (size_t j = 0; j < parts.size(); ++j) {
+      expected.insert(
+          expected.end(),
+          parts[j].begin() + i * part_sizes[j],
+          parts[j].begin() + (i + 1) * part_sizes[j]);
+    }
+  }
+  const auto part_row_bytes = [&](const size_t j) { return part_sizes[j]; };
+
+  std::vector<uint8_t> packed(outer * row_size, 0);
+  concat_copy(
+      reinterpret_cast<char*>(packed.data()),
+      outer,
+      parts.size(),
+      part_row_bytes,
+      [&](const size_t j) { return parts[j].data(); });
+  EXPECT_EQ(packed, expected);
+
+  std::vector<std::vector<uint8_t>> split_parts;
+  for (const auto& part : parts) {
+    split_parts.emplace_back(part.size(), 0);
+  }
+  split_concat_copy(
+      reinterpret_cast<const char*>(expected.data()),
+      outer,
+      parts.size(),
+      part_row_bytes,
+      [&](const size_t j) { return split_parts[j].data(); });
+  EXPECT_EQ(split_parts, parts);
+}
+
+} // namespace
+
+TEST(ConcatUtilTest, SmallRows) {
+  expect_concat_copy_matches(3, {4, 12, 1});
+  expect_concat_copy_matches(1, {8, 8});
+  expect_concat_copy_matches(5, {0, 3, 0, 2});
+}
+
+TEST(ConcatUtilTest, ChunksSplitRowsAndParts) {
+  // Chunk boundaries fall inside parts, at the end of parts and between
+  // rows.
+  expect_concat_copy_matches(7, {kConcatChunkBytes / 3, 1, 5000});
+  expect_concat_copy_matches(2, {kConcatChunkBytes, kConcatChunkBytes / 2});
+  expect_concat_copy_matches(300, {1000, 0, 24});
+}
+
+TEST(ConcatUtilTest, SinglePartIsCopiedAsOneRow) {
+  expect_concat_copy_matches(40, {0, 0, 10000, 0});
+}
+
+TEST(ConcatUtilTest, EmptyParts) {
+  expect_concat_copy_matches(4, {0, 0});
+  expect_concat_copy_matches(0, {3, 5});
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Measures the dim order conversions that _to_dim_order_copy and
+// _clone_dim_order run at the delegate boundaries of image models, between
+// contiguous and channels last, with and without a change of dtype. Each case
+// runs through _to_dim_order_copy_impl and, as a baseline, through the
+// per-element strided copy. The bytes processed count both the bytes read and
+// the bytes written.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <executorch/kernels/portable/cpu/util/broadcast_indexes_range.h>
+#include <executorch/kernels/portable/cpu/util/copy_ops_util.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::testing::TensorFactory;
+
+namespace {
+
+struct Shape {
+  const char* name;
+  std::vector<int32_t> sizes;
+};
+
+const std::vector<Shape>& shapes() {
+  static const std::vector<Shape> shapes = {
+      // Input image.
+      {"1x3x224x224", {1, 3, 224, 224}},
+      // Early, middle and late feature maps of a ResNet-like model.
+      {"1x64x112x112", {1, 64, 112, 112}},
+      {"1x256x56x56", {1, 256, 56, 56}},
+      {"1x1024x14x14", {1, 1024, 14, 14}},
+      // Video clip.
+      {"1x64x8x56x56", {1, 64, 8, 56, 56}},
+  };
+  return shapes;
+}
+
+template <typename OUT_CTYPE, typename IN_CTYPE>
+void per_element_copy(const Tensor& self, Tensor& out) {
+  const auto self_data = self.const_data_ptr<IN_CTYPE>();
+  auto out_data = out.mutable_data_ptr<OUT_CTYPE>();
+  for (const auto [unused_index, self_data_index, out_data_index] :
+       torch::executor::BroadcastIndexesRange<
+           2,
+           /*support_noncontiguous_input_tensors=*/true>(self, self, out)) {
+    (void)unused_index;
+    out_data[out_data_index] =
+        static_cast<OUT_CTYPE>(self_data[self_data_index]);
+  }
+}
+
+template <ScalarType IN_DTYPE, ScalarType OUT_DTYPE>
+void BM_DimOrderCopy(
+    benchmark::State& state,
+    const std::vector<int32_t>& sizes,
+    bool to_channels_last,
+    bool per_element) {
+  using IN_CTYPE = typename TensorFactory<IN_DTYPE>::ctype;
+  using OUT_CTYPE = typename TensorFactory<OUT_DTYPE>::ctype;
+  TensorFactory<IN_DTYPE> tf_in;
+  TensorFactory<OUT_DTYPE> tf_out;
+  Tensor in = to_channels_last ? tf_in.ones(sizes)
+                               : tf_in.full_channels_last(sizes, 1);
+  Tensor out = to_channels_last ? tf_out.full_channels_last(sizes, 0)
+                                : tf_out.zeros(sizes);
+  for (auto _ : state) {
+    if (per_element) {
+      per_element_copy<OUT_CTYPE, IN_CTYPE>(in, out);
+    } else {
+      torch::executor::_to_dim_order_copy_impl<IN_CTYPE, OUT_CTYPE>(in, out);
+    }
+    benchmark::DoNotOptimize(out.const_data_ptr());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(
+      state.iterations() * in.numel() *
+      (sizeof(IN_CTYPE) + sizeof(OUT_CTYPE)));
+}
+
+template <ScalarType IN_DTYPE, ScalarType OUT_DTYPE>
+void register_dim_order_copies(const char* dtypes) {
+  for (const auto& shape : shapes()) {
+    for (const bool to_channels_last : {true, false}) {
+      for (const bool per_element : {true, false}) {
+        const std::string name = std::string("BM_DimOrderCopy/") + dtypes +
+            "/" + shape.name +
+            (to_channels_last ? "/to_channels_last" : "/to_contiguous") +
+            (per_element ? "/per_element" : "/transpose");
+        benchmark::RegisterBenchmark(
+            name.c_str(),
+            [&shape, to_channels_last, per_element](benchmark::State& state) {
+              BM_DimOrderCopy<IN_DTYPE, OUT_DTYPE>(
+                  state, shape.sizes, to_channels_last, per_element);
+            });
+      }
+    }
+  }
+}
+
+const bool registered = [] {
+  executorch::runtime::runtime_init();
+  register_dim_order_copies<ScalarType::Float, ScalarType::Float>(
+      "float_float");
+  register_dim_order_copies<ScalarType::Byte, ScalarType::Byte>("uint8_uint8");
+  register_dim_order_copies<ScalarType::Half, ScalarType::Float>(
+      "half_float");
+  register_dim_order_copies<ScalarType::Float, ScalarType::Half>(
+      "float_half");
+  return true;
+}();
+
+} // namespace
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/portable/cpu/util/dim_order_transpose_util.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::testing::TensorFactory;
+using torch::executor::dim_order_transpose_copy;
+using torch::executor::DimOrderTranspose;
+using torch::executor::get_dim_order_transpose;
+
+namespace {
+
+std::vector<uint8_t> contiguous(size_t ndim) {
+  std::vector<uint8_t> dim_order(ndim);
+  for (size_t i = 0; i < ndim; ++i) {
+    dim_order[i] = static_cast<uint8_t>(i);
+  }
+  return dim_order;
+}
+
+std::vector<uint8_t> channels_last(size_t ndim) {
+  std::vector<uint8_t> dim_order = {0};
+  for (size_t i = 2; i < ndim; ++i) {
+    dim_order.push_back(static_cast<uint8_t>(i));
+  }
+  dim_order.push_back(1);
+  return dim_order;
+}
+
+size_t numel_of(const std::vector<int32_t>& sizes) {
+  size_t numel = 1;
+  for (const auto size : sizes) {
+    numel *= size;
+  }
+  return numel;
+}
+
+// Checks that transposing a tensor of dim order `in_dim_order` into one of
+// dim order `out_dim_order` matches copying it element by element.
+template <ScalarType IN_DTYPE, ScalarType OUT_DTYPE>
+void expect_transpose_matches_copy(
+    const std::vector<int32_t>& sizes,
+    const std::vector<uint8_t>& in_dim_order,
+    const std::vector<uint8_t>& out_dim_order) {
+  using IN_CTYPE = typename TensorFactory<IN_DTYPE>::ctype;
+  using OUT_CTYPE = typename TensorFactory<OUT_DTYPE>::ctype;
+  TensorFactory<IN_DTYPE> tf_in;
+  TensorFactory<OUT_DTYPE> tf_out;
+
+  const int64_t numel = numel_of(sizes);
+  std::vector<IN_CTYPE> in_data(numel);
+  for (int64_t i = 0; i < numel; ++i) {
+    in_data[i] = static_cast<IN_CTYPE>(static_cast<float>(i % 251) * 0.75f);
+  }
+  Tensor in = tf_in.make_with_dimorder(sizes, in_data, in_dim_order);
+  Tensor out = tf_out.make_with_dimorder(
+      sizes, std::vector<OUT_CTYPE>(numel), out_dim_order);
+
+  // Walk every element through the strides of both tensors.
+  std::vector<OUT_CTYPE> expected_data(numel);
+  std::vector<int64_t> index(sizes.size(), 0);
+  for (int64_t i = 0; i < numel; ++i) {
+    int64_t in_offset = 0;
+    int64_t out_offset = 0;
+    for (size_t d = 0; d < sizes.size(); ++d) {
+      in_offset += index[d] * in.strides()[d];
+      out_offset += index[d] * out.strides()[d];
+    }
+    expected_data[out_offset] = static_cast<OUT_CTYPE>(in_data[in_offset]);
+    for (size_t d = sizes.size(); d > 0 && ++index[d - 1] == sizes[d - 1];
+         --d) {
+      index[d - 1] = 0;
+    }
+  }
+
+  DimOrderTranspose transpose;
+  ASSERT_TRUE(get_dim_order_transpose(in, out, &transpose));
+  dim_order_transpose_copy(
+      in.const_data_ptr<IN_CTYPE>(),
+      out.mutable_data_ptr<OUT_CTYPE>(),
+      transpose);
+  EXPECT_TENSOR_EQ(
+      out, tf_out.make_with_dimorder(sizes, expected_data, out_dim_order));
+}
+
+void expect_transpose(
+    const std::vector<int32_t>& sizes,
+    const std::vector<uint8_t>& in_dim_order,
+    const std::vector<uint8_t>& out_dim_order,
+    int64_t batch,
+    int64_t rows,
+    int64_t cols) {
+  TensorFactory<ScalarType::Float> tf;
+  Tensor in = tf.make_with_dimorder(
+      sizes, std::vector<float>(numel_of(sizes)), in_dim_order);
+  Tensor out = tf.make_with_dimorder(
+      sizes, std::vector<float>(numel_of(sizes)), out_dim_order);
+  DimOrderTranspose transpose;
+  ASSERT_TRUE(get_dim_order_transpose(in, out, &transpose));
+  EXPECT_EQ(transpose.batch, batch);
+  EXPECT_EQ(transpose.rows, rows);
+  EXPECT_EQ(transpose.cols, cols);
+}
+
+void expect_no_transpose(
+    const std::vector<int32_t>& sizes,
+    const std::vector<uint8_t>& in_dim_order,
+    const std::vector<uint8_t>& out_dim_order) {
+  TensorFactory<ScalarType::Float> tf;
+  Tensor in = tf.make_with_dimorder(
+      sizes, std::vector<float>(numel_of(sizes)), in_dim_order);
+  Tensor out = tf.make_with_dimorder(
+      sizes, std::vector<float>(numel_of(sizes)), out_dim_order);
+  DimOrderTranspose transpose;
+  EXPECT_FALSE(get_dim_order_transpose(in, out, &transpose));
+}
+
+} // namespace
+
+TEST(DimOrderTransposeUtilTest, GetDimOrderTranspose) {
+  expect_transpose({2, 3, 4, 5}, contiguous(4), channels_last(4), 2, 3, 20);
+  expect_transpose({2, 3, 4, 5}, channels_last(4), contiguous(4), 2, 20, 3);
+  expect_transpose(
+      {2, 3, 4, 5, 6}, contiguous(5), channels_last(5), 2, 3, 120);
+  expect_transpose(
+      {2, 3, 4, 5, 6}, channels_last(5), contiguous(5), 2, 120, 3);
+  // Dimensions of size 1 do not matter.
+  expect_transpose({1, 3, 1, 5}, contiguous(4), channels_last(4), 1, 3, 5);
+  expect_transpose({4, 3, 5}, {2, 0, 1}, {0, 1, 2}, 1, 5, 12);
+}
+
+TEST(DimOrderTransposeUtilTest, GetDimOrderTransposeRejectsOtherOrders) {
+  expect_no_transpose({2, 3, 4, 5}, contiguous(4), contiguous(4));
+  expect_no_transpose({2, 3, 4, 5}, channels_last(4), channels_last(4));
+  expect_no_transpose({2, 3, 4, 5}, contiguous(4), {0, 3, 2, 1});
+  expect_no_transpose({2, 3, 4, 5}, {1, 0, 3, 2}, contiguous(4));
+  // With single channel, channels last is the same as contiguous.
+  expect_no_transpose({2, 1, 4, 5}, contiguous(4), channels_last(4));
+}
+
+TEST(DimOrderTransposeUtilTest, ContiguousToChannelsLast) {
+  // Several tiles in both directions, with partial ones at the ends.
+  expect_transpose_matches_copy<ScalarType::Float, ScalarType::Float>(
+      {2, 37, 9, 11}, contiguous(4), channels_last(4));
+  // Thin matrices: few channels, many pixels.
+  expect_transpose_matches_copy<ScalarType::Byte, ScalarType::Byte>(
+      {1, 3, 40, 50}, contiguous(4), channels_last(4));
+  expect_transpose_matches_copy<ScalarType::Double, ScalarType::Double>(
+      {2, 5, 3, 4, 6}, contiguous(5), channels_last(5));
+}
+
+TEST(DimOrderTransposeUtilTest, ChannelsLastToContiguous) {
+  expect_transpose_matches_copy<ScalarType::Float, ScalarType::Float>(
+      {2, 37, 9, 11}, channels_last(4), contiguous(4));
+  expect_transpose_matches_copy<ScalarType::Char, ScalarType::Char>(
+      {1, 3, 40, 50}, channels_last(4), contiguous(4));
+  expect_transpose_matches_copy<ScalarType::Half, ScalarType::Half>(
+      {2, 5, 3, 4, 6}, channels_last(5), contiguous(5));
+}
+
+TEST(DimOrderTransposeUtilTest, ConvertsDtypes) {
+  expect_transpose_matches_copy<ScalarType::Half, ScalarType::Float>(
+      {2, 37, 9, 11}, contiguous(4), channels_last(4));
+  expect_transpose_matches_copy<ScalarType::Float, ScalarType::BFloat16>(
+      {1, 40, 6, 7}, channels_last(4), contiguous(4));
+  expect_transpose_matches_copy<ScalarType::Byte, ScalarType::Float>(
+      {1, 3, 40, 50}, contiguous(4), channels_last(4));
+  expect_transpose_matches_copy<ScalarType::Float, ScalarType::Long>(
+      {3, 33, 2, 17}, channels_last(4), contiguous(4));
+}
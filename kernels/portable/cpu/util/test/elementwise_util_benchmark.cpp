@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Measures a binary elementwise op (a * b + a, computed in float) over a
+// matrix of input dtypes and broadcast patterns, and over the broadcasts of
+// common transformer shapes. Each case runs through the block-convert path and,
+// as a baseline, through the per-element path, which is what
+// SupportNoncontiguousInputTensors still selects.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <executorch/kernels/portable/cpu/util/elementwise_util.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::KernelRuntimeContext;
+using executorch::runtime::testing::TensorFactory;
+using torch::executor::native::utils::SupportedTensorDtypes;
+using torch::executor::native::utils::internal::SupportNoncontiguousInputTensors;
+
+namespace {
+
+static constexpr const char kOpName[] = "elementwise_util_benchmark";
+
+constexpr int32_t kRows = 64;
+constexpr int32_t kCols = 1024;
+
+enum class Broadcast {
+  // b has the shape of a.
+  kNone,
+  // b has a single element.
+  kScalar,
+  // b is a row that is broadcast over the rows of a.
+  kRow,
+};
+
+const char* broadcast_name(Broadcast broadcast) {
+  switch (broadcast) {
+    case Broadcast::kNone:
+      return "same_shape";
+    case Broadcast::kScalar:
+      return "scalar";
+    case Broadcast::kRow:
+      return "row";
+  }
+  return "";
+}
+
+template <ScalarType A, ScalarType B, ScalarType OUT>
+void run_mul_add(
+    benchmark::State& state,
+    const std::vector<int32_t>& a_sizes,
+    const std::vector<int32_t>& b_sizes,
+    const std::vector<int32_t>& out_sizes,
+    bool per_element) {
+  TensorFactory<A> tf_a;
+  TensorFactory<B> tf_b;
+  TensorFactory<OUT> tf_out;
+  Tensor a = tf_a.ones(a_sizes);
+  Tensor b = tf_b.ones(b_sizes);
+  Tensor out = tf_out.zeros(out_sizes);
+  KernelRuntimeContext ctx;
+
+  const auto mul_add = [](const auto val_a, const auto val_b) {
+    return val_a * val_b + val_a;
+  };
+  for (auto _ : state) {
+    if (per_element) {
+      torch::executor::native::utils::apply_bitensor_elementwise_fn<
+          float,
+          kOpName,
+          SupportedTensorDtypes::REALHBF16>(
+          mul_add,
+          ctx,
+          a,
+          SupportedTensorDtypes::REALHBBF16,
+          b,
+          SupportedTensorDtypes::REALHBBF16,
+          out,
+          SupportNoncontiguousInputTensors());
+    } else {
+      torch::executor::native::utils::apply_bitensor_elementwise_fn<
+          float,
+          kOpName,
+          SupportedTensorDtypes::REALHBF16>(
+          mul_add,
+          ctx,
+          a,
+          SupportedTensorDtypes::REALHBBF16,
+          b,
+          SupportedTensorDtypes::REALHBBF16,
+          out);
+    }
+    benchmark::DoNotOptimize(out.const_data_ptr());
+  }
+  if (ctx.failure_state() != executorch::runtime::Error::Ok) {
+    state.SkipWithError("Kernel failed");
+  }
+  state.SetItemsProcessed(state.iterations() * out.numel());
+}
+
+template <ScalarType A, ScalarType B, ScalarType OUT>
+void BM_MulAdd(
+    benchmark::State& state,
+    Broadcast broadcast,
+    bool per_element) {
+  const std::vector<int32_t> b_sizes = broadcast == Broadcast::kNone
+      ? std::vector<int32_t>{kRows, kCols}
+      : (broadcast == Broadcast::kScalar ? std::vector<int32_t>{1}
+                                         : std::vector<int32_t>{kCols});
+  run_mul_add<A, B, OUT>(
+      state, {kRows, kCols}, b_sizes, {kRows, kCols}, per_element);
+}
+
+// Broadcasts of a transformer layer with batch 1, 8 heads, sequence length
+// 128 and model dimension 512.
+struct TransformerBroadcast {
+  const char* name;
+  std::vector<int32_t> a_sizes;
+  std::vector<int32_t> b_sizes;
+};
+
+const std::vector<TransformerBroadcast>& transformer_broadcasts() {
+  static const std::vector<TransformerBroadcast> broadcasts = {
+      // Bias add: [B, S, D] + [D].
+      {"bias_row", {1, 128, 512}, {512}},
+      // Normalization scale: [B, S, D] * [B, S, 1].
+      {"norm_column", {1, 128, 512}, {1, 128, 1}},
+      // Attention mask shared by the heads: [B, H, S, S] * [B, 1, S, S].
+      {"mask_outer", {1, 8, 128, 128}, {1, 1, 128, 128}},
+      // Causal mask shared by the batch: [B, H, S, S] * [S, S].
+      {"mask_leading", {2, 8, 128, 128}, {128, 128}},
+      // Per-head scale: [B, H, S, Dh] * [1, H, 1, 1].
+      {"head_scale", {1, 8, 128, 64}, {1, 8, 1, 1}},
+  };
+  return broadcasts;
+}
+
+template <ScalarType A, ScalarType B, ScalarType OUT>
+void register_transformer_cases(const char* name) {
+  for (const auto& broadcast : transformer_broadcasts()) {
+    for (const bool per_element : {false, true}) {
+      const std::string full_name = std::string("BM_TransformerBroadcast/") +
+          name + "/" + broadcast.name +
+          (per_element ? "/per_element" : "/collapsed");
+      benchmark::RegisterBenchmark(
+          full_name.c_str(),
+          [&broadcast, per_element](benchmark::State& state) {
+            run_mul_add<A, B, OUT>(
+                state,
+                broadcast.a_sizes,
+                broadcast.b_sizes,
+                broadcast.a_sizes,
+                per_element);
+          });
+    }
+  }
+}
+
+template <ScalarType A, ScalarType B, ScalarType OUT>
+void register_case(const char* name) {
+  for (const Broadcast broadcast :
+       {Broadcast::kNone, Broadcast::kScalar, Broadcast::kRow}) {
+    for (const bool per_element : {false, true}) {
+      const std::string full_name = std::string("BM_MulAdd/") + name + "/" +
+          broadcast_name(broadcast) +
+          (per_element ? "/per_element" : "/block_convert");
+      benchmark::RegisterBenchmark(
+          full_name.c_str(),
+          [broadcast, per_element](benchmark::State& state) {
+            BM_MulAdd<A, B, OUT>(state, broadcast, per_element);
+          });
+    }
+  }
+}
+
+const bool registered = [] {
+  executorch::runtime::runtime_init();
+  register_case<ScalarType::Float, ScalarType::Float, ScalarType::Float>(
+      "f32_f32_to_f32");
+  register_case<ScalarType::Half, ScalarType::Float, ScalarType::Float>(
+      "f16_f32_to_f32");
+  register_case<ScalarType::Half, ScalarType::Half, ScalarType::Half>(
+      "f16_f16_to_f16");
+  register_case<ScalarType::BFloat16, ScalarType::Float, ScalarType::BFloat16>(
+      "bf16_f32_to_bf16");
+  register_case<ScalarType::Long, ScalarType::Float, ScalarType::Float>(
+      "i64_f32_to_f32");
+  register_case<ScalarType::Int, ScalarType::Int, ScalarType::Float>(
+      "i32_i32_to_f32");
+  register_transformer_cases<
+      ScalarType::Float,
+      ScalarType::Float,
+      ScalarType::Float>("f32_f32_to_f32");
+  register_transformer_cases<
+      ScalarType::Half,
+      ScalarType::Float,
+      ScalarType::Half>("f16_f32_to_f16");
+  return true;
+}();
+
+} // namespace
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/portable/cpu/util/elementwise_util.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <vector>
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::KernelRuntimeContext;
+using executorch::runtime::testing::TensorFactory;
+using torch::executor::native::utils::SupportedTensorDtypes;
+using torch::executor::native::utils::internal::kElementwiseBlockSize;
+
+namespace {
+
+static constexpr const char kOpName[] = "elementwise_util_test";
+
+template <typename T>
+std::vector<T> iota_values(size_t n, double start, double step) {
+  std::vector<T> values(n);
+  for (size_t i = 0; i < n; ++i) {
+    values[i] = static_cast<T>(start + step * static_cast<double>(i));
+  }
+  return values;
+}
+
+// Computes a * b + 1 with the elementwise utilities.
+void mul_add_one(
+    KernelRuntimeContext& ctx,
+    const Tensor& a,
+    const Tensor& b,
+    const Tensor& out) {
+  torch::executor::native::utils::apply_bitensor_elementwise_fn<
+      float,
+      kOpName,
+      SupportedTensorDtypes::REALHBF16>(
+      [](const auto val_a, const auto val_b) {
+        return val_a * val_b + decltype(val_a)(1);
+      },
+      ctx,
+      a,
+      SupportedTensorDtypes::REALHBBF16,
+      b,
+      SupportedTensorDtypes::REALHBBF16,
+      out);
+}
+
+} // namespace
+
+class ElementwiseUtilTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+  }
+
+  KernelRuntimeContext ctx_;
+};
+
+// Not a multiple of the block size, so that the last block is partial.
+constexpr int32_t kNumel = 3 * kElementwiseBlockSize + 17;
+
+TEST_F(ElementwiseUtilTest, HalfTimesFloat) {
+  TensorFactory<ScalarType::Half> tf_half;
+  TensorFactory<ScalarType::Float> tf_float;
+
+  const auto a_values =
+      iota_values<executorch::aten::Half>(kNumel, -4.0, 0.0078125);
+  const auto b_values = iota_values<float>(kNumel, 0.5, 0.001);
+  Tensor a = tf_half.make({kNumel}, a_values);
+  Tensor b = tf_float.make({kNumel}, b_values);
+  Tensor out = tf_float.zeros({kNumel});
+
+  mul_add_one(ctx_, a, b, out);
+  ASSERT_EQ(ctx_.failure_state(), executorch::runtime::Error::Ok);
+
+  std::vector<float> expected(kNumel);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    expected[i] = static_cast<float>(a_values[i]) * b_values[i] + 1.0f;
+  }
+  EXPECT_TENSOR_EQ(out, tf_float.make({kNumel}, expected));
+}
+
+TEST_F(ElementwiseUtilTest, LongTimesFloatIntoBFloat16) {
+  TensorFactory<ScalarType::Long> tf_long;
+  TensorFactory<ScalarType::Float> tf_float;
+  TensorFactory<ScalarType::BFloat16> tf_bf16;
+
+  const auto a_values = iota_values<int64_t>(kNumel, -500.0, 1.0);
+  const auto b_values = iota_values<float>(kNumel, -1.0, 0.01);
+  Tensor a = tf_long.make({kNumel}, a_values);
+  Tensor b = tf_float.make({kNumel}, b_values);
+  Tensor out = tf_bf16.zeros({kNumel});
+
+  mul_add_one(ctx_, a, b, out);
+  ASSERT_EQ(ctx_.failure_state(), executorch::runtime::Error::Ok);
+
+  std::vector<executorch::aten::BFloat16> expected(kNumel);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    expected[i] = static_cast<executorch::aten::BFloat16>(
+        static_cast<float>(a_values[i]) * b_values[i] + 1.0f);
+  }
+  EXPECT_TENSOR_EQ(out, tf_bf16.make({kNumel}, expected));
+}
+
+TEST_F(ElementwiseUtilTest, ScalarOfOtherDtype) {
+  TensorFactory<ScalarType::Float> tf_float;
+  TensorFactory<ScalarType::Int> tf_int;
+
+  const auto a_values = iota_values<float>(2 * (kNumel / 2), 0.0, 0.25);
+  Tensor a = tf_float.make({2, kNumel / 2}, a_values);
+  Tensor b = tf_int.make({1}, {3});
+  Tensor out = tf_float.zeros({2, kNumel / 2});
+
+  // Scalar on either side.
+  mul_add_one(ctx_, a, b, out);
+  std::vector<float> expected(a_values.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    expected[i] = a_values[i] * 3.0f + 1.0f;
+  }
+  EXPECT_TENSOR_EQ(out, tf_float.make({2, kNumel / 2}, expected));
+
+  Tensor out_swapped = tf_float.zeros({2, kNumel / 2});
+  mul_add_one(ctx_, b, a, out_swapped);
+  EXPECT_TENSOR_EQ(out_swapped, out);
+}
+
+TEST_F(ElementwiseUtilTest, RowBroadcast) {
+  TensorFactory<ScalarType::Half> tf_half;
+  TensorFactory<ScalarType::Float> tf_float;
+
+  Tensor a = tf_half.make({2, 3}, {1, 2, 3, 4, 5, 6});
+  Tensor b = tf_float.make({3}, {1, 10, 100});
+  Tensor out = tf_float.zeros({2, 3});
+
+  mul_add_one(ctx_, a, b, out);
+  EXPECT_TENSOR_EQ(out, tf_float.make({2, 3}, {2, 21, 301, 5, 51, 601}));
+}
+
+// Checks mul_add_one() against BroadcastIndexesRange for the common
+// broadcasts, with inputs of the compute dtype (the dtype-specialized path)
+// and of mixed dtypes (the block-convert path).
+template <ScalarType A_DTYPE>
+void test_broadcast_shapes(KernelRuntimeContext& ctx) {
+  using CTYPE_A = typename TensorFactory<A_DTYPE>::ctype;
+  TensorFactory<A_DTYPE> tf_a;
+  TensorFactory<ScalarType::Float> tf_float;
+
+  using Sizes = std::vector<int32_t>;
+  const std::vector<std::array<Sizes, 3>> cases = {
+      // Row vector: [B, S, D] + [D].
+      {Sizes{2, 5, 300}, Sizes{300}, Sizes{2, 5, 300}},
+      // Column vector: [B, S, D] * [B, S, 1].
+      {Sizes{2, 5, 300}, Sizes{2, 5, 1}, Sizes{2, 5, 300}},
+      // Outer broadcast: [B, H, S, S] * [B, 1, S, S].
+      {Sizes{2, 3, 17, 17}, Sizes{2, 1, 17, 17}, Sizes{2, 3, 17, 17}},
+      // Both inputs broadcast: [S, 1] * [1, D].
+      {Sizes{33, 1}, Sizes{1, 40}, Sizes{33, 40}},
+      // Scalar, with a broadcast over a middle dimension.
+      {Sizes{1}, Sizes{4, 1, 20}, Sizes{4, 3, 20}},
+      // Rows that are too short for the dtype-specialized path.
+      {Sizes{7, 3}, Sizes{7, 1}, Sizes{7, 3}},
+  };
+  for (const auto& [a_sizes, b_sizes, out_sizes] : cases) {
+    Tensor a = tf_a.ones(a_sizes);
+    Tensor b = tf_float.ones(b_sizes);
+    const auto a_values = iota_values<CTYPE_A>(a.numel(), -8.0, 0.0625);
+    const auto b_values = iota_values<float>(b.numel(), 0.5, 0.125);
+    a = tf_a.make(a_sizes, a_values);
+    b = tf_float.make(b_sizes, b_values);
+    Tensor out = tf_float.zeros(out_sizes);
+
+    mul_add_one(ctx, a, b, out);
+    ASSERT_EQ(ctx.failure_state(), executorch::runtime::Error::Ok);
+
+    std::vector<float> expected(out.numel());
+    for (const auto [out_idx, a_idx, b_idx] :
+         torch::executor::BroadcastIndexesRange<2>(out, a, b)) {
+      expected[out_idx] =
+          static_cast<float>(a_values[a_idx]) * b_values[b_idx] + 1.0f;
+    }
+    EXPECT_TENSOR_EQ(out, tf_float.make(out_sizes, expected));
+  }
+}
+
+TEST_F(ElementwiseUtilTest, BroadcastShapes) {
+  test_broadcast_shapes<ScalarType::Float>(ctx_);
+}
+
+TEST_F(ElementwiseUtilTest, BroadcastShapesMixedDtypes) {
+  test_broadcast_shapes<ScalarType::Half>(ctx_);
+}
+
+TEST_F(ElementwiseUtilTest, BoolConditionAndBoolOutput) {
+  TensorFactory<ScalarType::Bool> tf_bool;
+  TensorFactory<ScalarType::Float> tf_float;
+  TensorFactory<ScalarType::Half> tf_half;
+
+  std::vector<uint8_t> cond_values(kNumel);
+  for (size_t i = 0; i < cond_values.size(); ++i) {
+    cond_values[i] = i % 3 == 0;
+  }
+  const auto a_values = iota_values<float>(kNumel, 0.0, 1.0);
+  const auto b_values =
+      iota_values<executorch::aten::Half>(kNumel, 0.0, -1.0 / 64);
+  Tensor a = tf_float.make({kNumel}, a_values);
+  Tensor b = tf_half.make({kNumel}, b_values);
+  Tensor cond = tf_bool.make({kNumel}, cond_values);
+  Tensor out = tf_half.zeros({kNumel});
+
+  torch::executor::native::utils::apply_tritensor_elementwise_fn<
+      float,
+      kOpName,
+      SupportedTensorDtypes::SAME_AS_COMMON>(
+      [](const float val_a, const float val_b, const float val_c) {
+        return val_c ? val_a : val_b;
+      },
+      ctx_,
+      a,
+      SupportedTensorDtypes::REALHBBF16,
+      b,
+      SupportedTensorDtypes::REALHBBF16,
+      cond,
+      SupportedTensorDtypes::BOOL_OR_BYTE,
+      out);
+  ASSERT_EQ(ctx_.failure_state(), executorch::runtime::Error::Ok);
+
+  std::vector<executorch::aten::Half> expected(kNumel);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    expected[i] = cond_values[i]
+        ? static_cast<executorch::aten::Half>(a_values[i])
+        : b_values[i];
+  }
+  EXPECT_TENSOR_EQ(out, tf_half.make({kNumel}, expected));
+
+  Tensor is_positive = tf_bool.zeros({kNumel});
+  torch::executor::native::utils::apply_bitensor_elementwise_fn<
+      float,
+      kOpName,
+      SupportedTensorDtypes::BOOL>(
+      [](const float val_a, const float val_b) { return val_a + val_b > 0; },
+      ctx_,
+      a,
+      SupportedTensorDtypes::REALHBBF16,
+      b,
+      SupportedTensorDtypes::REALHBBF16,
+      is_positive);
+  ASSERT_EQ(ctx_.failure_state(), executorch::runtime::Error::Ok);
+  std::vector<uint8_t> expected_positive(kNumel);
+  for (size_t i = 0; i < expected_positive.size(); ++i) {
+    expected_positive[i] =
+        a_values[i] + static_cast<float>(b_values[i]) > 0.0f;
+  }
+  EXPECT_TENSOR_EQ(is_positive, tf_bool.make({kNumel}, expected_positive));
+}
+
+TEST_F(ElementwiseUtilTest, UnsupportedDtypeFails) {
+  TensorFactory<ScalarType::Float> tf_float;
+  TensorFactory<ScalarType::Int> tf_int;
+
+  Tensor a = tf_float.ones({4});
+  Tensor b = tf_int.ones({4});
+  Tensor out = tf_float.zeros({4});
+
+  torch::executor::native::utils::apply_bitensor_elementwise_fn<
+      float,
+      kOpName,
+      SupportedTensorDtypes::REALHBF16>(
+      [](const float val_a, const float val_b) { return val_a + val_b; },
+      ctx_,
+      a,
+      SupportedTensorDtypes::FLOATHBF16,
+      b,
+      SupportedTensorDtypes::FLOATHBF16,
+      out);
+  EXPECT_NE(ctx_.failure_state(), executorch::runtime::Error::Ok);
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Measures the gathers and scatters of embedding lookups, index_select,
+// index_put_ and gather. Each case runs through gather_util and, as a
+// baseline, through the loops the ops used before: one memcpy per row, or
+// coordinate arithmetic per element. The bytes processed are the bytes
+// copied.
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <executorch/kernels/portable/cpu/util/gather_util.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::testing::TensorFactory;
+
+namespace {
+
+struct RowCase {
+  const char* name;
+  int64_t leading;
+  int64_t dim_length;
+  int64_t num_indices;
+  size_t row_bytes;
+};
+
+const std::vector<RowCase>& row_cases() {
+  static const std::vector<RowCase> cases = {
+      // Token embeddings of an LLM: a 32000 x 1024 float table.
+      {"embedding_32000x4096B_256", 1, 32000, 256, 4096},
+      // index_select of single floats and of short rows.
+      {"index_select_1x1048576x4B_262144", 1, 1 << 20, 1 << 18, 4},
+      {"index_select_64x1024x24B_512", 64, 1024, 512, 24},
+      // Rows of a KV cache updated or read back by position.
+      {"kv_rows_8x2048x512B_128", 8, 2048, 128, 512},
+  };
+  return cases;
+}
+
+std::vector<int64_t> random_indices(int64_t n, int64_t dim_length) {
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int64_t> dist(0, dim_length - 1);
+  std::vector<int64_t> indices(n);
+  for (auto& index : indices) {
+    index = dist(gen);
+  }
+  return indices;
+}
+
+void BM_GatherRows(benchmark::State& state, const RowCase& c, bool per_row) {
+  const std::vector<char> in(c.leading * c.dim_length * c.row_bytes, 1);
+  std::vector<char> out(c.leading * c.num_indices * c.row_bytes);
+  const std::vector<int64_t> index = random_indices(c.num_indices, c.dim_length);
+  for (auto _ : state) {
+    if (per_row) {
+      for (int64_t i = 0; i < c.leading; ++i) {
+        const char* src = in.data() + i * c.dim_length * c.row_bytes;
+        char* dest = out.data() + i * c.num_indices * c.row_bytes;
+        for (int64_t j = 0; j < c.num_indices; ++j) {
+          std::memcpy(dest, src + index[j] * c.row_bytes, c.row_bytes);
+          dest += c.row_bytes;
+        }
+      }
+    } else {
+      torch::executor::gather_rows(
+          in.data(),
+          out.data(),
+          index.data(),
+          c.num_indices,
+          c.leading,
+          c.dim_length,
+          c.row_bytes);
+    }
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * out.size());
+}
+
+void BM_ScatterRows(benchmark::State& state, const RowCase& c, bool per_row) {
+  const std::vector<char> src(c.leading * c.num_indices * c.row_bytes, 1);
+  std::vector<char> out(c.leading * c.dim_length * c.row_bytes);
+  const std::vector<int64_t> index = random_indices(c.num_indices, c.dim_length);
+  for (auto _ : state) {
+    if (per_row) {
+      for (int64_t i = 0; i < c.leading; ++i) {
+        const char* from = src.data() + i * c.num_indices * c.row_bytes;
+        char* dest = out.data() + i * c.dim_length * c.row_bytes;
+        for (int64_t j = 0; j < c.num_indices; ++j) {
+          std::memcpy(dest + index[j] * c.row_bytes, from, c.row_bytes);
+          from += c.row_bytes;
+        }
+      }
+    } else {
+      torch::executor::scatter_rows(
+          src.data(),
+          out.data(),
+          index.data(),
+          c.num_indices,
+          c.leading,
+          c.dim_length,
+          c.row_bytes);
+    }
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+// gather along the last dimension, like picking the top-k logits of a batch.
+void BM_GatherAlongDim(benchmark::State& state, bool per_element) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Long> tf_long;
+  constexpr int32_t kRows = 256;
+  constexpr int32_t kVocab = 32000;
+  constexpr int32_t kK = 1024;
+  Tensor in = tf.ones({kRows, kVocab});
+  const std::vector<int64_t> indices = random_indices(kRows * kK, kVocab);
+  Tensor index = tf_long.make({kRows, kK}, indices);
+  Tensor out = tf.zeros({kRows, kK});
+  const float* const in_data = in.const_data_ptr<float>();
+  float* const out_data = out.mutable_data_ptr<float>();
+  for (auto _ : state) {
+    if (per_element) {
+      for (int64_t ix = 0; ix < index.numel(); ++ix) {
+        size_t ix_coord[executorch::runtime::kTensorDimensionLimit];
+        executorch::runtime::indexToCoordinate(index, ix, ix_coord);
+        size_t in_coord[executorch::runtime::kTensorDimensionLimit];
+        in_coord[0] = ix_coord[0];
+        in_coord[1] = indices[ix];
+        out_data[executorch::runtime::coordinateToIndex(out, ix_coord)] =
+            in_data[executorch::runtime::coordinateToIndex(in, in_coord)];
+      }
+    } else {
+      (void)torch::executor::gather_along_dim<float>(in, 1, index, out);
+    }
+    benchmark::DoNotOptimize(out_data);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * out.nbytes());
+}
+
+const bool registered = [] {
+  executorch::runtime::runtime_init();
+  for (const auto& c : row_cases()) {
+    for (const bool per_row : {true, false}) {
+      const char* const variant = per_row ? "/per_row" : "/gather_util";
+      benchmark::RegisterBenchmark(
+          (std::string("BM_GatherRows/") + c.name + variant).c_str(),
+          [&c, per_row](benchmark::State& state) {
+            BM_GatherRows(state, c, per_row);
+          });
+      benchmark::RegisterBenchmark(
+          (std::string("BM_ScatterRows/") + c.name + variant).c_str(),
+          [&c, per_row](benchmark::State& state) {
+            BM_ScatterRows(state, c, per_row);
+          });
+    }
+  }
+  for (const bool per_element : {true, false}) {
+    benchmark::RegisterBenchmark(
+        per_element ? "BM_GatherAlongDim/256x32000_k1024/per_element"
+                    : "BM_GatherAlongDim/256x32000_k1024/gather_util",
+        [per_element](benchmark::State& state) {
+          BM_GatherAlongDim(state, per_element);
+        });
+  }
+  return true;
+}();
+
+} // namespace
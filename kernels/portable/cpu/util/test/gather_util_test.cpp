@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/portable/cpu/util/gather_util.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::testing::TensorFactory;
+using torch::executor::gather_along_dim;
+using torch::executor::gather_rows;
+using torch::executor::get_index_along_dim;
+using torch::executor::IndexAlongDim;
+using torch::executor::scatter_add_rows;
+using torch::executor::scatter_along_dim;
+using torch::executor::scatter_rows;
+
+namespace {
+
+std::vector<uint8_t> iota_bytes(size_t n) {
+  std::vector<uint8_t> bytes(n);
+  for (size_t i = 0; i < n; ++i) {
+    bytes[i] = static_cast<uint8_t>(i * 7 + 3);
+  }
+  return bytes;
+}
+
+// Checks gather_rows against copying the rows one at a time, for rows of
+// `row_bytes` bytes.
+void expect_gather_rows_matches(size_t row_bytes) {
+  constexpr int64_t kLeading = 3;
+  constexpr int64_t kDimLength = 20;
+  const std::vector<int64_t> index = {0, 19, -1, 5, 5, -20, 7, 12, 3, 3, 0,
+                                      1, 2, 18, 17, 16, 9, 11, 4};
+  const int64_t num_indices = index.size();
+  const std::vector<uint8_t> in = iota_bytes(kLeading * kDimLength * row_bytes);
+
+  std::vector<uint8_t> expected(kLeading * num_indices * row_bytes);
+  for (int64_t i = 0; i < kLeading; ++i) {
+    for (int64_t j = 0; j < num_indices; ++j) {
+      const int64_t row = index[j] < 0 ? index[j] + kDimLength : index[j];
+      std::memcpy(
+          expected.data() + (i * num_indices + j) * row_bytes,
+          in.data() + (i * kDimLength + row) * row_bytes,
+          row_bytes);
+    }
+  }
+
+  std::vector<uint8_t> out(expected.size());
+  gather_rows(
+      reinterpret_cast<const char*>(in.data()),
+      reinterpret_cast<char*>(out.data()),
+      index.data(),
+      num_indices,
+      kLeading,
+      kDimLength,
+      row_bytes);
+  EXPECT_EQ(out, expected) << "row_bytes = " << row_bytes;
+}
+
+} // namespace
+
+TEST(GatherUtilTest, GatherRows) {
+  // Sizes copied with single loads and stores, and ones that are not, small
+  // and large enough to be prefetched.
+  for (const size_t row_bytes : {1, 2, 4, 8, 16, 3, 24, 64, 1000}) {
+    expect_gather_rows_matches(row_bytes);
+  }
+}
+
+TEST(GatherUtilTest, ScatterRowsLastRepeatedIndexWins) {
+  const std::vector<int32_t> index = {2, 0, 2, -1};
+  // Two slices of four rows of two values.
+  const std::vector<float> src = {
+      1, 2, 3, 4, 5, 6, 7, 8, 11, 12, 13, 14, 15, 16, 17, 18};
+  std::vector<float> out(2 * 4 * 2, 0.0f);
+  scatter_rows(
+      reinterpret_cast<const char*>(src.data()),
+      reinterpret_cast<char*>(out.data()),
+      index.data(),
+      index.size(),
+      /*leading=*/2,
+      /*out_dim_length=*/4,
+      2 * sizeof(float));
+  const std::vector<float> expected = {
+      3, 4, 0, 0, 5, 6, 7, 8, 13, 14, 0, 0, 15, 16, 17, 18};
+  EXPECT_EQ(out, expected);
+}
+
+TEST(GatherUtilTest, ScatterAddRowsAddsRepeatedIndices) {
+  const std::vector<int64_t> index = {1, 1, 0};
+  const std::vector<int32_t> src = {1, 2, 10, 20, 100, 200};
+  std::vector<int32_t> out = {5, 5, 5, 5};
+  scatter_add_rows(
+      src.data(),
+      out.data(),
+      index.data(),
+      index.size(),
+      /*leading=*/1,
+      /*out_dim_length=*/2,
+      /*row_size=*/2);
+  const std::vector<int32_t> expected = {105, 205, 16, 27};
+  EXPECT_EQ(out, expected);
+}
+
+TEST(GatherUtilTest, ScatterRowsSplitsLongRows) {
+  // Rows longer than a scatter chunk are split across several units of work.
+  constexpr int64_t kRowSize = 3 * torch::executor::kScatterChunkSize + 5;
+  const std::vector<int64_t> index = {1, 0, 1};
+  std::vector<int32_t> src(index.size() * kRowSize);
+  for (size_t i = 0; i < src.size(); ++i) {
+    src[i] = static_cast<int32_t>(i);
+  }
+  std::vector<int32_t> out(2 * kRowSize, 0);
+  scatter_add_rows(
+      src.data(),
+      out.data(),
+      index.data(),
+      index.size(),
+      /*leading=*/1,
+      /*out_dim_length=*/2,
+      kRowSize);
+  for (int64_t k = 0; k < kRowSize; ++k) {
+    ASSERT_EQ(out[k], src[kRowSize + k]);
+    ASSERT_EQ(out[kRowSize + k], src[k] + src[2 * kRowSize + k]);
+  }
+}
+
+TEST(GatherUtilTest, GetIndexAlongDim) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Long> tf_long;
+  Tensor in = tf.zeros({4, 5, 6, 7});
+  IndexAlongDim along;
+  ASSERT_TRUE(get_index_along_dim(in, 1, tf_long.zeros({2, 3, 6, 7}), &along));
+  EXPECT_EQ(along.outer, 2);
+  EXPECT_EQ(along.index_length, 3);
+  EXPECT_EQ(along.inner, 42);
+  ASSERT_TRUE(get_index_along_dim(in, 3, tf_long.zeros({1, 2, 3, 9}), &along));
+  EXPECT_EQ(along.outer, 6);
+  EXPECT_EQ(along.index_length, 9);
+  EXPECT_EQ(along.inner, 1);
+  // The dimensions after `dim` must match.
+  EXPECT_FALSE(
+      get_index_along_dim(in, 1, tf_long.zeros({4, 5, 6, 6}), &along));
+  EXPECT_FALSE(get_index_along_dim(in, 0, tf_long.zeros({4, 5, 6}), &along));
+  EXPECT_FALSE(get_index_along_dim(
+      tf.full_channels_last({4, 5, 6, 7}, 0),
+      0,
+      tf_long.zeros({4, 5, 6, 7}),
+      &along));
+}
+
+TEST(GatherUtilTest, GatherAlongDim) {
+  TensorFactory<ScalarType::Int> tf;
+  TensorFactory<ScalarType::Long> tf_long;
+  // clang-format off
+  Tensor in = tf.make({2, 3, 2}, {
+      0, 1,    2, 3,    4, 5,
+      6, 7,    8, 9,   10, 11});
+  // clang-format on
+  Tensor index = tf_long.make({1, 4, 2}, {2, 0, 1, 1, 0, 2, 2, 2});
+  Tensor out = tf.zeros({1, 4, 2});
+  ASSERT_TRUE(gather_along_dim<int32_t>(in, 1, index, out));
+  EXPECT_TENSOR_EQ(out, tf.make({1, 4, 2}, {4, 1, 2, 3, 0, 5, 4, 5}));
+
+  // Along the last dimension, with an index smaller than the input in the
+  // other ones.
+  index = tf_long.make({2, 2, 3}, {1, 1, 0, 0, 1, 0, 1, 0, 0, 1, 1, 1});
+  out = tf.zeros({2, 2, 3});
+  ASSERT_TRUE(gather_along_dim<int32_t>(in, 2, index, out));
+  EXPECT_TENSOR_EQ(
+      out, tf.make({2, 2, 3}, {1, 1, 0, 2, 3, 2, 7, 6, 6, 9, 9, 9}));
+}
+
+TEST(GatherUtilTest, ScatterAlongDim) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Long> tf_long;
+  Tensor src = tf.make({2, 3}, {1, 2, 3, 4, 5, 6});
+  Tensor index = tf_long.make({2, 2}, {0, 2, 0, 1});
+  Tensor out = tf.zeros({2, 4});
+  ASSERT_TRUE(scatter_along_dim<float>(
+      src, 1, index, out, [](float& out_val, const float src_val) {
+        out_val += src_val;
+      }));
+  EXPECT_TENSOR_EQ(out, tf.make({2, 4}, {1, 0, 2, 0, 4, 5, 0, 0}));
+
+  // Repeated indices along dim 0 are visited in order.
+  index = tf_long.make({2, 3}, {1, 1, 0, 1, 0, 0});
+  out = tf.zeros({2, 3});
+  ASSERT_TRUE(scatter_along_dim<float>(
+      src, 0, index, out, [](float& out_val, const float src_val) {
+        out_val = src_val;
+      }));
+  EXPECT_TENSOR_EQ(out, tf.make({2, 3}, {0, 5, 6, 4, 2, 0}));
+}
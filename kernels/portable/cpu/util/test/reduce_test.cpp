@@ -22,6 +22,7 @@ using executorch::runtime::testing::TensorFactory;
 using std::optional;
 using torch::executor::apply_over_dim;
 using torch::executor::apply_over_dim_list;
+using torch::executor::ContiguousReductionPlan;
 using torch::executor::get_out_numel;
 
 void _apply_over_dim(const Tensor& in, const optional<int64_t>& dim) {
@@ -581,3 +582,108 @@ TEST(ReduceUtilTest, ApplyOverDimListInvalid) {
   ET_EXPECT_DEATH(
       apply_over_dim_list([](size_t in_ix) { return; }, in, dim_list, 0), "");
 }
+
+namespace {
+
+// Checks that ContiguousReductionPlan sums and finds the maximum like
+// MapReduceOverDimListPlan does for every output.
+void expect_contiguous_reduction_matches(
+    const std::vector<int32_t>& sizes,
+    const std::vector<int64_t>& dims) {
+  TensorFactory<ScalarType::Long> tf;
+  Tensor in = tf.zeros(sizes);
+  int64_t* const in_data = in.mutable_data_ptr<int64_t>();
+  for (ssize_t i = 0; i < in.numel(); ++i) {
+    in_data[i] = (i * 7919) % 1000 - 500;
+  }
+  const optional<ArrayRef<int64_t>> dim_list =
+      ArrayRef<int64_t>(dims.data(), dims.size());
+  const size_t out_numel = get_out_numel(in, dim_list);
+  std::vector<int64_t> sums(out_numel);
+  std::vector<int64_t> maxes(out_numel);
+
+  const ContiguousReductionPlan plan(in, dim_list);
+  ASSERT_TRUE(plan.is_supported());
+  ASSERT_TRUE(plan.execute<int64_t>(
+      torch::executor::SumReducer<int64_t>(),
+      [&](const size_t out_ix, const int64_t sum) { sums[out_ix] = sum; }));
+  ASSERT_TRUE(plan.execute<int64_t>(
+      torch::executor::MaxReducer<int64_t>(),
+      [&](const size_t out_ix, const int64_t max) { maxes[out_ix] = max; }));
+
+  const torch::executor::MapReduceOverDimListPlan reference(in, dim_list);
+  for (size_t out_ix = 0; out_ix < out_numel; ++out_ix) {
+    EXPECT_EQ(
+        sums[out_ix],
+        (reference.execute<int64_t, int64_t>(
+            [](int64_t v) { return v; },
+            [](int64_t v, int64_t acc) { return acc + v; },
+            out_ix)))
+        << "sum at " << out_ix;
+    EXPECT_EQ(
+        maxes[out_ix],
+        (reference.execute<int64_t, int64_t>(
+            [](int64_t v) { return v; },
+            [](int64_t v, int64_t acc) { return std::max(v, acc); },
+            out_ix)))
+        << "max at " << out_ix;
+  }
+}
+
+} // namespace
+
+TEST(ReduceUtilTest, ContiguousReductionPlanMatchesReduceOverDimList) {
+  for (const auto& dims : std::vector<std::vector<int64_t>>{
+           {},
+           {3},
+           {-1},
+           {0},
+           {1},
+           {1, 2},
+           {2, 3},
+           {0, 2},
+           {0, 3},
+           {1, 3},
+           {0, 1, 2, 3}}) {
+    expect_contiguous_reduction_matches({2, 3, 4, 70}, dims);
+  }
+  // Dimensions of size 1 are skipped.
+  expect_contiguous_reduction_matches({1, 3, 1, 5}, {0});
+  expect_contiguous_reduction_matches({1, 3, 1, 5}, {2});
+  expect_contiguous_reduction_matches({1, 3, 1, 5}, {1, 3});
+  expect_contiguous_reduction_matches({1}, {0});
+  // Few outputs of long reductions, which are split into chunks.
+  expect_contiguous_reduction_matches({3, 40000}, {1});
+  expect_contiguous_reduction_matches({40000, 3}, {0});
+  expect_contiguous_reduction_matches({2, 20000, 3}, {0, 1});
+  expect_contiguous_reduction_matches({100001}, {});
+}
+
+TEST(ReduceUtilTest, ContiguousReductionPlanRejectsNonContiguous) {
+  TensorFactory<ScalarType::Float> tf;
+  Tensor channels_last = tf.full_channels_last({2, 3, 4, 5}, 1);
+  EXPECT_FALSE(ContiguousReductionPlan(channels_last, {}).is_supported());
+  Tensor empty = tf.zeros({2, 0, 3});
+  EXPECT_FALSE(ContiguousReductionPlan(empty, {}).is_supported());
+}
+
+TEST(ReduceUtilTest, ContiguousReductionPlanSumsFloatsAccurately) {
+  // Summing 0.1f one value at a time in float drifts by more than 1e-3 after
+  // 10^5 values.
+  TensorFactory<ScalarType::Float> tf;
+  for (const auto& [sizes, dim] : std::vector<
+           std::pair<std::vector<int32_t>, int64_t>>{
+           {{4, 100000}, 1}, {{100000, 4}, 0}, {{100, 4}, 0}}) {
+    Tensor in = tf.full(sizes, 0.1f);
+    const int64_t dims[1] = {dim};
+    const optional<ArrayRef<int64_t>> dim_list = ArrayRef<int64_t>(dims, 1);
+    const ContiguousReductionPlan plan(in, dim_list);
+    ASSERT_TRUE(plan.is_supported());
+    const double expected = 0.1 * static_cast<float>(sizes[dim]);
+    ASSERT_TRUE(plan.execute<float>(
+        torch::executor::SumReducer<float>(),
+        [&](const size_t out_ix, const float sum) {
+          EXPECT_NEAR(sum, expected, expected * 1e-6) << "at " << out_ix;
+        }));
+  }
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Measures float sums over the reduction layouts of common models: the
+// innermost dimension (softmax, layer norm), the outermost one (a batch), a
+// middle one, the spatial dimensions of an image (global average pooling),
+// everything but the channels (batch norm statistics), and the whole tensor.
+// Each case runs through ContiguousReductionPlan and, as a baseline, through
+// MapReduceOverDimListPlan for every output element. The bytes processed are
+// the bytes read.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <executorch/kernels/portable/cpu/util/reduce_util.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using executorch::aten::ArrayRef;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::testing::TensorFactory;
+
+namespace {
+
+struct Layout {
+  const char* name;
+  std::vector<int32_t> sizes;
+  std::vector<int64_t> dims;
+};
+
+const std::vector<Layout>& layouts() {
+  static const std::vector<Layout> layouts = {
+      {"inner_1024x4096", {1024, 4096}, {1}},
+      {"outer_4096x1024", {4096, 1024}, {0}},
+      {"middle_64x256x64", {64, 256, 64}, {1}},
+      {"spatial_8x256x28x28", {8, 256, 28, 28}, {2, 3}},
+      {"batch_norm_8x64x56x56", {8, 64, 56, 56}, {0, 2, 3}},
+      {"all_4194304", {1 << 22}, {}},
+  };
+  return layouts;
+}
+
+void BM_Sum(benchmark::State& state, const Layout& layout, bool per_element) {
+  TensorFactory<ScalarType::Float> tf;
+  Tensor in = tf.ones(layout.sizes);
+  const std::optional<ArrayRef<int64_t>> dim_list =
+      ArrayRef<int64_t>(layout.dims.data(), layout.dims.size());
+  std::vector<int32_t> out_sizes = layout.sizes;
+  for (const auto d : layout.dims) {
+    out_sizes[d] = 1;
+  }
+  if (layout.dims.empty()) {
+    out_sizes.assign(out_sizes.size(), 1);
+  }
+  Tensor out = tf.zeros(out_sizes);
+  float* const out_data = out.mutable_data_ptr<float>();
+
+  const torch::executor::MapReduceOverDimListPlan plan(in, dim_list);
+  const torch::executor::ContiguousReductionPlan contiguous_plan(
+      in, dim_list);
+  for (auto _ : state) {
+    if (per_element) {
+      (void)torch::executor::
+          parallel_for_each_reduce_over_dim_list_output_index(
+              in, dim_list, out, [&](const auto begin, const auto end) {
+            for (auto out_ix = begin; out_ix < end; ++out_ix) {
+              out_data[out_ix] = plan.execute<float, float>(
+                  [](float v) { return v; },
+                  [](float v, float acc) { return acc + v; },
+                  out_ix);
+            }
+          });
+    } else {
+      (void)contiguous_plan.execute<float>(
+          torch::executor::SumReducer<float>(),
+          [&](const size_t out_ix, const float sum) {
+            out_data[out_ix] = sum;
+          });
+    }
+    benchmark::DoNotOptimize(out_data);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * in.nbytes());
+}
+
+const bool registered = [] {
+  executorch::runtime::runtime_init();
+  for (const auto& layout : layouts()) {
+    for (const bool per_element : {true, false}) {
+      const std::string name = std::string("BM_Sum/") + layout.name +
+          (per_element ? "/per_element" : "/contiguous");
+      benchmark::RegisterBenchmark(
+          name.c_str(), [&layout, per_element](benchmark::State& state) {
+            BM_Sum(state, layout, per_element);
+          });
+    }
+  }
+  return true;
+}();
+
+} // namespace
@@ -23,6 +23,88 @@ def define_common_targets():
         ],
     )
 
+    runtime.cxx_test(
+        name = "dim_order_transpose_util_test",
+        srcs = ["dim_order_transpose_util_test.cpp"],
+        deps = [
+            "//executorch/kernels/portable/cpu/util:dim_order_transpose_util",
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "dim_order_copy_benchmark",
+        srcs = ["dim_order_copy_benchmark.cpp"],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/kernels/portable/cpu/util:broadcast_indexes_range",
+            "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "elementwise_util_test",
+        srcs = ["elementwise_util_test.cpp"],
+        deps = [
+            "//executorch/kernels/portable/cpu/util:elementwise_util",
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "elementwise_util_benchmark",
+        srcs = ["elementwise_util_benchmark.cpp"],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/kernels/portable/cpu/util:elementwise_util",
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "gather_util_test",
+        srcs = ["gather_util_test.cpp"],
+        deps = [
+            "//executorch/kernels/portable/cpu/util:gather_util",
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "gather_util_benchmark",
+        srcs = ["gather_util_benchmark.cpp"],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/kernels/portable/cpu/util:gather_util",
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "concat_util_test",
+        srcs = ["concat_util_test.cpp"],
+        deps = [
+            "//executorch/kernels/portable/cpu/util:concat_util",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "concat_copy_benchmark",
+        srcs = ["concat_copy_benchmark.cpp"],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/kernels/portable/cpu/util:concat_util",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
     runtime.cxx_test(
         name = "reduce_test",
         srcs = ["reduce_test.cpp"],
@@ -33,6 +115,17 @@ def define_common_targets():
         ],
     )
 
+    runtime.cxx_binary(
+        name = "reduce_util_benchmark",
+        srcs = ["reduce_util_benchmark.cpp"],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/kernels/portable/cpu/util:reduce_util",
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+        ],
+    )
+
     # this test requires ET_USE_PYTORCH_HEADERS, which doesn't work in OSS Buck.
     if not runtime.is_oss:
         runtime.cxx_test(
@@ -43,3 +136,12 @@ def define_common_targets():
                 "//executorch/runtime/core/portable_type/c10/c10:aten_headers_for_executorch",
             ],
         )
+
+    runtime.cxx_binary(
+        name = "vectorized_math_benchmark",
+        srcs = ["vectorized_math_benchmark.cpp"],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/kernels/portable/cpu/util:vectorized_math",
+        ],
+    )
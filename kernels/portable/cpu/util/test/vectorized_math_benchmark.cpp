@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Measures the polynomial approximations of vectorized_math.h against the
+// standard library functions that the unary ops called per element before.
+// Each case maps 64K floats spread over the range that matters for the
+// function, and reports as max_ulp the largest error of the results against
+// the function evaluated in double and rounded to float.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <executorch/kernels/portable/cpu/util/vectorized_math.h>
+
+namespace {
+
+constexpr size_t kNumElements = 64 * 1024;
+
+struct MathCase {
+  const char* name;
+  float min;
+  float max;
+  float (*std_fn)(float);
+  void (*fast_fn_n)(const float*, float*, size_t);
+  double (*reference)(double);
+};
+
+const std::vector<MathCase>& cases() {
+  static const std::vector<MathCase> cases = {
+      // Without the subnormal results below -87, which are slow on most
+      // CPUs either way.
+      {"exp",
+       -87.0f,
+       88.0f,
+       [](float x) { return std::exp(x); },
+       executorch::math::fast_exp_n,
+       [](double x) { return std::exp(x); }},
+      {"log",
+       0.0f,
+       1.0e6f,
+       [](float x) { return std::log(x); },
+       executorch::math::fast_log_n,
+       [](double x) { return std::log(x); }},
+      {"tanh",
+       -10.0f,
+       10.0f,
+       [](float x) { return std::tanh(x); },
+       executorch::math::fast_tanh_n,
+       [](double x) { return std::tanh(x); }},
+      {"sigmoid",
+       -20.0f,
+       20.0f,
+       [](float x) { return 1.0f / (1.0f + std::exp(-x)); },
+       executorch::math::fast_sigmoid_n,
+       [](double x) { return 1.0 / (1.0 + std::exp(-x)); }},
+      {"silu",
+       -20.0f,
+       20.0f,
+       [](float x) { return x / (1.0f + std::exp(-x)); },
+       executorch::math::fast_silu_n,
+       [](double x) { return x / (1.0 + std::exp(-x)); }},
+      {"erf",
+       -5.0f,
+       5.0f,
+       [](float x) { return std::erf(x); },
+       executorch::math::fast_erf_n,
+       [](double x) { return std::erf(x); }},
+      {"gelu",
+       -3.0f,
+       6.0f,
+       [](float x) {
+         return 0.5f * x * (1.0f + std::erf(x * 0.707106781186547524f));
+       },
+       executorch::math::fast_gelu_n,
+       [](double x) { return 0.5 * x * (1.0 + std::erf(x * M_SQRT1_2)); }},
+      {"gelu_tanh",
+       -3.0f,
+       6.0f,
+       [](float x) {
+         const float inner =
+             0.797884560802865355f * (x + 0.044715f * x * x * x);
+         return 0.5f * x * (1.0f + std::tanh(inner));
+       },
+       executorch::math::fast_gelu_tanh_n,
+       [](double x) {
+         const double inner =
+             0.797884560802865355 * (x + 0.044715 * x * x * x);
+         return 0.5 * x * (1.0 + std::tanh(inner));
+       }},
+  };
+  return cases;
+}
+
+// The error of `result` in units in the last place of the float nearest to
+// `expected`.
+double ulp_error(float result, double expected) {
+  const float rounded = static_cast<float>(expected);
+  if (std::isnan(rounded) || std::isinf(rounded)) {
+    return result == rounded || (std::isnan(result) && std::isnan(rounded))
+        ? 0.0
+        : INFINITY;
+  }
+  int exponent = 0;
+  std::frexp(rounded, &exponent);
+  const double ulp = std::ldexp(1.0, std::max(exponent - 24, -149));
+  return std::fabs(static_cast<double>(result) - expected) / ulp;
+}
+
+void BM_UnaryMath(benchmark::State& state, const MathCase& c, bool fast) {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> dist(c.min, c.max);
+  std::vector<float> in(kNumElements);
+  for (auto& x : in) {
+    x = dist(gen);
+  }
+  std::vector<float> out(kNumElements);
+
+  for (auto _ : state) {
+    if (fast) {
+      c.fast_fn_n(in.data(), out.data(), in.size());
+    } else {
+      for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = c.std_fn(in[i]);
+      }
+    }
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+
+  double max_ulp = 0.0;
+  for (size_t i = 0; i < in.size(); ++i) {
+    max_ulp = std::max(max_ulp, ulp_error(out[i], c.reference(in[i])));
+  }
+  state.counters["max_ulp"] = max_ulp;
+  state.SetItemsProcessed(state.iterations() * in.size());
+}
+
+const bool registered = [] {
+  for (const auto& c : cases()) {
+    for (const bool fast : {false, true}) {
+      const std::string name = std::string("BM_UnaryMath/") + c.name +
+          (fast ? "/vectorized_math" : "/std");
+      benchmark::RegisterBenchmark(
+          name.c_str(), [&c, fast](benchmark::State& state) {
+            BM_UnaryMath(state, c, fast);
+          });
+    }
+  }
+  return true;
+}();
+
+} // namespace
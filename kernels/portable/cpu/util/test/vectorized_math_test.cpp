@@ -12,7 +12,12 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
 
 #ifndef ET_USE_PYTORCH_HEADERS
 #error "This test requires ET_USE_PYTORCH_HEADERS!"
@@ -93,3 +98,182 @@ TEST(VectorizedMathTest, BinaryInt64ToFloat) {
 }
 
 } // namespace
+
+namespace {
+
+// The error of `result` in units in the last place of the float nearest to
+// `expected`.
+double ulp_error(float result, double expected) {
+  const float rounded = static_cast<float>(expected);
+  if (std::isnan(rounded) || std::isinf(rounded)) {
+    return result == rounded || (std::isnan(result) && std::isnan(rounded))
+        ? 0.0
+        : INFINITY;
+  }
+  int exponent = 0;
+  std::frexp(rounded, &exponent);
+  const double ulp = std::ldexp(1.0, std::max(exponent - 24, -149));
+  return std::fabs(static_cast<double>(result) - expected) / ulp;
+}
+
+// Checks fn_n against `reference`, evaluated in double, on a sample of all
+// float bit patterns that includes the special values, skipping inputs below
+// `min_x`.
+template <typename Reference>
+void expect_within_ulp(
+    void (*fn_n)(const float*, float*, size_t),
+    const Reference& reference,
+    double max_ulp,
+    float min_x = -std::numeric_limits<float>::infinity()) {
+  std::vector<float> in = {
+      0.0f,
+      -0.0f,
+      std::numeric_limits<float>::denorm_min(),
+      std::numeric_limits<float>::min(),
+      std::numeric_limits<float>::max(),
+      -std::numeric_limits<float>::max(),
+      std::numeric_limits<float>::infinity(),
+      -std::numeric_limits<float>::infinity(),
+      std::numeric_limits<float>::quiet_NaN(),
+  };
+  for (uint64_t bits = 0; bits <= UINT32_MAX; bits += 65537) {
+    const uint32_t b = static_cast<uint32_t>(bits);
+    float x;
+    std::memcpy(&x, &b, sizeof(x));
+    in.push_back(x);
+  }
+  std::vector<float> out(in.size());
+  fn_n(in.data(), out.data(), in.size());
+  for (const auto i : c10::irange(in.size())) {
+    if (in[i] < min_x) {
+      continue;
+    }
+    EXPECT_LE(ulp_error(out[i], reference(in[i])), max_ulp)
+        << "x = " << in[i] << ", result = " << out[i];
+  }
+}
+
+// Checks fn_n against `reference` on every float in [lo, hi) and on its
+// negation.
+template <typename Reference>
+void expect_within_ulp_between(
+    void (*fn_n)(const float*, float*, size_t),
+    const Reference& reference,
+    double max_ulp,
+    float lo,
+    float hi) {
+  std::vector<float> in;
+  for (float x = lo; x < hi; x = std::nextafter(x, hi)) {
+    in.push_back(x);
+    in.push_back(-x);
+  }
+  std::vector<float> out(in.size());
+  fn_n(in.data(), out.data(), in.size());
+  for (const auto i : c10::irange(in.size())) {
+    ASSERT_LE(ulp_error(out[i], reference(in[i])), max_ulp)
+        << "x = " << in[i] << ", result = " << out[i];
+  }
+}
+
+} // namespace
+
+TEST(VectorizedMathTest, FastExp) {
+  expect_within_ulp(
+      executorch::math::fast_exp_n, [](double x) { return std::exp(x); }, 1);
+  for (const float nan :
+       {std::numeric_limits<float>::quiet_NaN(),
+        -std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::signaling_NaN()}) {
+    EXPECT_TRUE(std::isnan(executorch::math::fast_exp(nan)));
+  }
+}
+
+TEST(VectorizedMathTest, FastLog) {
+  expect_within_ulp(
+      executorch::math::fast_log_n, [](double x) { return std::log(x); }, 1);
+}
+
+TEST(VectorizedMathTest, FastTanh) {
+  expect_within_ulp(
+      executorch::math::fast_tanh_n, [](double x) { return std::tanh(x); }, 2);
+}
+
+TEST(VectorizedMathTest, FastSigmoidAndSilu) {
+  expect_within_ulp(
+      executorch::math::fast_sigmoid_n,
+      [](double x) { return 1.0 / (1.0 + std::exp(-x)); },
+      3);
+  const auto silu = [](double x) { return x / (1.0 + std::exp(-x)); };
+  expect_within_ulp(executorch::math::fast_silu_n, silu, 4, -87.0f);
+  // Below -87, sigmoid(x) is subnormal and only its absolute error is
+  // bounded.
+  for (const float x : {-87.5f, -90.0f, -100.0f, -104.0f, -200.0f}) {
+    EXPECT_NEAR(
+        executorch::math::fast_silu(x),
+        silu(x),
+        -x * std::numeric_limits<float>::denorm_min());
+  }
+}
+
+TEST(VectorizedMathTest, FastErf) {
+  const auto erf = [](double x) { return std::erf(x); };
+  expect_within_ulp(executorch::math::fast_erf_n, erf, 8);
+  // The largest errors, and the results that round up to 1 before clamping,
+  // are all in [2, 4), which the sample above barely touches.
+  expect_within_ulp_between(executorch::math::fast_erf_n, erf, 8, 2.0f, 4.0f);
+  EXPECT_EQ(executorch::math::fast_erf(3.61257148f), 1.0f);
+  EXPECT_EQ(executorch::math::fast_erf(-3.61257148f), -1.0f);
+}
+
+TEST(VectorizedMathTest, FastGelu) {
+  // Away from the cancellation for large negative x, which is checked with
+  // an absolute bound below.
+  const auto gelu = [](double x) {
+    return x < -1.0 ? 0.0 : 0.5 * x * (1.0 + std::erf(x * M_SQRT1_2));
+  };
+  const auto gelu_tanh = [](double x) {
+    const double inner = std::sqrt(2.0 / M_PI) * (x + 0.044715 * x * x * x);
+    return x < -1.0 ? 0.0 : 0.5 * x * (1.0 + std::tanh(inner));
+  };
+  for (const float x : {-1.0f, -0.5f, 1e-3f, 0.25f, 1.5f, 3.0f, 10.0f}) {
+    EXPECT_LE(ulp_error(executorch::math::fast_gelu(x), gelu(x)), 6) << x;
+    EXPECT_LE(
+        ulp_error(executorch::math::fast_gelu_tanh(x), gelu_tanh(x)), 4)
+        << x;
+  }
+  for (const float x : {-50.0f, -10.0f, -5.2f, -5.0f, -3.0f, -2.0f}) {
+    EXPECT_NEAR(
+        executorch::math::fast_gelu(x),
+        0.5 * x * (1.0 + std::erf(x * M_SQRT1_2)),
+        1.2e-6)
+        << x;
+    const double inner = std::sqrt(2.0 / M_PI) * (x + 0.044715 * x * x * x);
+    EXPECT_NEAR(
+        executorch::math::fast_gelu_tanh(x),
+        0.5 * x * (1.0 + std::tanh(inner)),
+        1e-7)
+        << x;
+  }
+  EXPECT_EQ(
+      executorch::math::fast_gelu(-std::numeric_limits<float>::infinity()),
+      0.0f);
+  EXPECT_EQ(
+      executorch::math::fast_gelu_tanh(std::numeric_limits<float>::infinity()),
+      std::numeric_limits<float>::infinity());
+}
+
+TEST(VectorizedMathTest, FastArrayFunctionsInPlace) {
+  // Lengths with and without a partial block, computed in place.
+  for (const size_t n : {1, 63, 64, 100, 256}) {
+    std::vector<float> x(n);
+    for (const auto i : c10::irange(n)) {
+      x[i] = static_cast<float>(i) * 0.125f - 4.0f;
+    }
+    std::vector<float> expected(n);
+    for (const auto i : c10::irange(n)) {
+      expected[i] = executorch::math::fast_tanh(x[i]);
+    }
+    executorch::math::fast_tanh_n(x.data(), x.data(), n);
+    EXPECT_EQ(x, expected);
+  }
+}
@@ -15,6 +15,11 @@
 #include <ATen/cpu/vec/vec.h>
 #endif // ET_USE_PYTORCH_HEADERS
 
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <type_traits>
 
 #if defined(ET_USE_PYTORCH_HEADERS) && ET_USE_PYTORCH_HEADERS
@@ -146,3 +151,294 @@ T rsqrt(T x) {
 ET_INTERNAL_VECTORIZED_STD_FLOAT_BINARY_FUNC(atan2)
 ET_INTERNAL_VECTORIZED_STD_FLOAT_BINARY_FUNC(fmod)
 ET_INTERNAL_VECTORIZED_STD_FLOAT_BINARY_FUNC(pow)
+
+/*
+ * Polynomial approximations of transcendental functions for float.
+ *
+ * They have no branches or library calls, so that the compiler vectorizes
+ * loops over them for whatever SIMD extension the build targets, and they
+ * handle infinities, NaNs and subnormals like the standard library. Unless
+ * a function says otherwise, each bound is the largest error against the
+ * correctly rounded result over all float inputs, in units in the last
+ * place (ULP).
+ *
+ * The *_n variants apply a function to `n` contiguous floats; `in` and `out`
+ * may be the same array. The ops compute Half and BFloat16 in float, so
+ * these cover all three dtypes; double keeps using the standard library.
+ */
+namespace executorch {
+inline namespace math {
+namespace internal {
+
+inline float bits_to_float(uint32_t bits) {
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+inline uint32_t float_to_bits(float x) {
+  uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+/**
+ * cond ? a : b, computed on the bits. With the default -ftrapping-math, GCC
+ * sinks the float arithmetic that only one side of a ?: needs into a branch
+ * and then cannot if-convert the loop, which leaves it scalar.
+ */
+inline float select(bool cond, float a, float b) {
+  const uint32_t mask = 0u - static_cast<uint32_t>(cond);
+  return bits_to_float((float_to_bits(a) & mask) | (float_to_bits(b) & ~mask));
+}
+
+// Whether x is NaN, without a floating-point comparison.
+inline bool is_nan_bits(float x) {
+  return (float_to_bits(x) & 0x7fffffffu) > 0x7f800000u;
+}
+
+// Returns x clamped to [-limit, limit] for limit > 0, or NaN for NaN.
+inline float clamp_abs(float x, float limit) {
+  const uint32_t bits = float_to_bits(x);
+  return select(
+      (bits & 0x7fffffffu) > float_to_bits(limit) && !is_nan_bits(x),
+      bits_to_float((bits & 0x80000000u) | float_to_bits(limit)),
+      x);
+}
+
+// Floats that map_float_array() processes per loop. The trip count of the
+// loop is a compile-time constant and the loop works on local arrays, so
+// that it vectorizes without runtime alias checks or an epilogue.
+constexpr size_t kFloatMapBlockSize = 64;
+
+template <typename Fn>
+inline void map_float_block(const Fn& fn, const float* in, float* out) {
+  float x[kFloatMapBlockSize];
+  float y[kFloatMapBlockSize];
+  std::memcpy(x, in, sizeof(x));
+  for (size_t i = 0; i < kFloatMapBlockSize; ++i) {
+    y[i] = fn(x[i]);
+  }
+  std::memcpy(out, y, sizeof(y));
+}
+
+template <typename Fn>
+inline void
+map_float_array(const Fn& fn, const float* in, float* out, size_t n) {
+  size_t i = 0;
+  for (; i + kFloatMapBlockSize <= n; i += kFloatMapBlockSize) {
+    map_float_block(fn, in + i, out + i);
+  }
+  if (i < n) {
+    float x[kFloatMapBlockSize] = {};
+    std::memcpy(x, in + i, (n - i) * sizeof(float));
+    map_float_block(fn, x, x);
+    std::memcpy(out + i, x, (n - i) * sizeof(float));
+  }
+}
+
+} // namespace internal
+
+/**
+ * e^x, within 1 ULP.
+ *
+ * x is split into n * ln(2) + r with |r| <= ln(2) / 2, e^r is evaluated with
+ * the degree 7 polynomial of Cephes' expf, and 2^n is applied as two powers
+ * of two so that subnormal results are not flushed to zero.
+ */
+inline float fast_exp(float x) {
+  constexpr float kLog2e = 1.44269504088896341f;
+  // ln(2) split so that n * kLn2Hi is exact.
+  constexpr float kLn2Hi = 0.693359375f;
+  constexpr float kLn2Lo = -2.12194440e-4f;
+  // Adding and subtracting 1.5 * 2^23 rounds to the nearest integer.
+  constexpr float kRoundShift = 12582912.0f;
+  // e^x overflows above 88.72 and rounds to zero below -103.98, which
+  // clamping keeps, along with n in [-150, 150].
+  x = internal::clamp_abs(x, 104.0f);
+  const float n = (x * kLog2e + kRoundShift) - kRoundShift;
+  const float r = (x - n * kLn2Hi) - n * kLn2Lo;
+  float p = 1.9875691500e-4f;
+  p = p * r + 1.3981999507e-3f;
+  p = p * r + 8.3334519073e-3f;
+  p = p * r + 4.1665795894e-2f;
+  p = p * r + 1.6666665459e-1f;
+  p = p * r + 5.0000001201e-1f;
+  p = p * r * r + r + 1.0f;
+  // Both halves of 2^n are normal floats. Converting a NaN n to an integer
+  // is undefined, so NaN takes n = 0 and is returned as is.
+  const bool nan = internal::is_nan_bits(x);
+  const int32_t ni = static_cast<int32_t>(internal::select(nan, 0.0f, n));
+  const int32_t n1 = ni / 2;
+  const int32_t n2 = ni - n1;
+  const float result = p *
+      internal::bits_to_float(static_cast<uint32_t>(n1 + 127) << 23) *
+      internal::bits_to_float(static_cast<uint32_t>(n2 + 127) << 23);
+  return internal::select(nan, x, result);
+}
+
+/**
+ * Natural logarithm, within 1 ULP. Returns NaN for negative inputs and -inf
+ * for zero.
+ *
+ * x is split into 2^e * m with m in [sqrt(1/2), sqrt(2)), and log(m) is
+ * evaluated with the degree 9 polynomial of Cephes' logf.
+ */
+inline float fast_log(float x) {
+  const uint32_t bits = internal::float_to_bits(x);
+  // Scale subnormals (and zero) into the normal range.
+  const bool subnormal = bits < 0x00800000u;
+  const uint32_t scaled =
+      internal::float_to_bits(internal::select(subnormal, x * 8388608.0f, x));
+  // m in [0.5, 1).
+  float m = internal::bits_to_float((scaled & 0x007fffffu) | 0x3f000000u);
+  float e = static_cast<float>(static_cast<int32_t>(scaled >> 23) - 126) -
+      internal::select(subnormal, 23.0f, 0.0f);
+  // m < sqrt(1/2)
+  const bool below = internal::float_to_bits(m) < 0x3f3504f3u;
+  e = e - internal::select(below, 1.0f, 0.0f);
+  m = internal::select(below, m + m, m) - 1.0f;
+  const float z = m * m;
+  float p = 7.0376836292e-2f;
+  p = p * m - 1.1514610310e-1f;
+  p = p * m + 1.1676998740e-1f;
+  p = p * m - 1.2420140846e-1f;
+  p = p * m + 1.4249322787e-1f;
+  p = p * m - 1.6668057665e-1f;
+  p = p * m + 2.0000714765e-1f;
+  p = p * m - 2.4999993993e-1f;
+  p = p * m + 3.3333331174e-1f;
+  float y = p * m * z;
+  y += e * -2.12194440e-4f;
+  y -= 0.5f * z;
+  float result = m + y + e * 0.693359375f;
+  // +inf and NaN give themselves, zeros -inf and other negatives NaN.
+  result = internal::select(bits >= 0x7f800000u, x, result);
+  result = internal::select(
+      (bits & 0x7fffffffu) == 0,
+      -std::numeric_limits<float>::infinity(),
+      result);
+  return internal::select(
+      bits > 0x80000000u && !internal::is_nan_bits(x),
+      std::numeric_limits<float>::quiet_NaN(),
+      result);
+}
+
+/**
+ * Hyperbolic tangent, within 2 ULP. Below |x| = 0.625 it uses the odd
+ * polynomial of Cephes' tanhf, above it 1 - 2 / (e^(2|x|) + 1).
+ */
+inline float fast_tanh(float x) {
+  const float z = x * x;
+  float p = -5.70498872745e-3f;
+  p = p * z + 2.06390887954e-2f;
+  p = p * z - 5.37397155531e-2f;
+  p = p * z + 1.33314422036e-1f;
+  p = p * z - 3.33332819422e-1f;
+  const float small = p * z * x + x;
+  const uint32_t bits = internal::float_to_bits(x);
+  const float a = internal::bits_to_float(bits & 0x7fffffffu);
+  const float large = internal::bits_to_float(
+      internal::float_to_bits(1.0f - 2.0f / (fast_exp(a + a) + 1.0f)) |
+      (bits & 0x80000000u));
+  // 0.625f
+  return internal::select((bits & 0x7fffffffu) < 0x3f200000u, small, large);
+}
+
+/**
+ * 1 / (1 + e^-x), within 3 ULP. Negative x use e^x / (1 + e^x), which
+ * does not overflow before the result becomes subnormal.
+ */
+inline float fast_sigmoid(float x) {
+  const uint32_t bits = internal::float_to_bits(x);
+  const float e = fast_exp(internal::bits_to_float(bits | 0x80000000u));
+  const float positive = 1.0f / (1.0f + e);
+  return internal::select(
+      (bits & 0x80000000u) != 0 && !internal::is_nan_bits(x),
+      e * positive,
+      positive);
+}
+
+/**
+ * x * sigmoid(x), within 4 ULP for x >= -87. Below that, sigmoid(x) is
+ * subnormal and the error is at most -x times the smallest subnormal.
+ */
+inline float fast_silu(float x) {
+  return x * fast_sigmoid(x);
+}
+
+/**
+ * Error function, within 8 ULP (7.95 at most, near 3.2, over all floats).
+ * x * P(x^2) / Q(x^2), the rational approximation of Eigen and XLA, clamped
+ * to [-1, 1], for |x| < 3.92, beyond which erf(x) rounds to +-1.
+ */
+inline float fast_erf(float x) {
+  const uint32_t bits = internal::float_to_bits(x);
+  const bool saturated = (bits & 0x7fffffffu) >=
+          internal::float_to_bits(3.92f) &&
+      !internal::is_nan_bits(x);
+  x = internal::clamp_abs(x, 4.0f);
+  const float z = x * x;
+  float p = -2.72614225801306e-10f;
+  p = p * z + 2.77068142495902e-08f;
+  p = p * z - 2.10102402082508e-06f;
+  p = p * z - 5.69250639462346e-05f;
+  p = p * z - 7.34990630326855e-04f;
+  p = p * z - 2.95459980854025e-03f;
+  p = p * z - 1.60960333262415e-02f;
+  float q = -1.45660718464996e-05f;
+  q = q * z - 2.13374055278905e-04f;
+  q = q * z - 1.68282697438203e-03f;
+  q = q * z - 7.37332916720468e-03f;
+  q = q * z - 1.42647390514189e-02f;
+  // p / q first, so that x * p does not become subnormal for tiny x. Near
+  // 3.6 the approximation rounds slightly above 1.
+  return internal::select(
+      saturated,
+      internal::bits_to_float((bits & 0x80000000u) | 0x3f800000u),
+      internal::clamp_abs(x * (p / q), 1.0f));
+}
+
+/**
+ * The exact GELU, x / 2 * (1 + erf(x / sqrt(2))), and its tanh
+ * approximation, x / 2 * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 x^3))),
+ * within 6 and 4 ULP for x >= -1. For smaller x, where the result cancels
+ * to zero, only their absolute error is bounded: by 1.2e-6, from the error
+ * of fast_erf near -1, and by 1e-7.
+ */
+inline float fast_gelu(float x) {
+  constexpr float kSqrtHalf = 0.707106781186547524f;
+  const float result = 0.5f * x * (1.0f + fast_erf(x * kSqrtHalf));
+  return internal::select(
+      x == -std::numeric_limits<float>::infinity(), 0.0f, result);
+}
+
+inline float fast_gelu_tanh(float x) {
+  // sqrt(2 / pi)
+  constexpr float kBeta = 0.797884560802865355f;
+  constexpr float kKappa = 0.044715f;
+  const float inner = kBeta * (x + kKappa * x * x * x);
+  const float result = 0.5f * x * (1.0f + fast_tanh(inner));
+  return internal::select(
+      x == -std::numeric_limits<float>::infinity(), 0.0f, result);
+}
+
+#define ET_INTERNAL_FAST_FLOAT_ARRAY_FUNC(name)                 \
+  inline void name##_n(const float* in, float* out, size_t n) { \
+    internal::map_float_array(                                  \
+        [](const float x) { return name(x); }, in, out, n);     \
+  }
+
+ET_INTERNAL_FAST_FLOAT_ARRAY_FUNC(fast_exp)
+ET_INTERNAL_FAST_FLOAT_ARRAY_FUNC(fast_log)
+ET_INTERNAL_FAST_FLOAT_ARRAY_FUNC(fast_tanh)
+ET_INTERNAL_FAST_FLOAT_ARRAY_FUNC(fast_sigmoid)
+ET_INTERNAL_FAST_FLOAT_ARRAY_FUNC(fast_silu)
+ET_INTERNAL_FAST_FLOAT_ARRAY_FUNC(fast_erf)
+ET_INTERNAL_FAST_FLOAT_ARRAY_FUNC(fast_gelu)
+ET_INTERNAL_FAST_FLOAT_ARRAY_FUNC(fast_gelu_tanh)
+
+#undef ET_INTERNAL_FAST_FLOAT_ARRAY_FUNC
+
+} // namespace math
+} // namespace executorch
@@ -7,10 +7,12 @@
  */
 
 #include <executorch/kernels/portable/cpu/util/reduce_util.h>
+#include <executorch/runtime/core/portable_type/float16_convert.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 #include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <type_traits>
 #if defined(__aarch64__) || defined(__ARM_NEON)
 #include <arm_neon.h>
 #endif
@@ -245,6 +247,35 @@ void dequantize_per_channel_optimized(
       axis);
 }
 
+/**
+ * Computes (in[i] - zero_point) * scale for `numel` elements. Half outputs are
+ * computed in float a block at a time and then converted in bulk, which gives
+ * the same results as converting every element.
+ */
+template <typename IN_CTYPE, typename OUT_CTYPE>
+void dequantize_per_tensor_impl(
+    const IN_CTYPE* in,
+    OUT_CTYPE* out,
+    size_t numel,
+    int32_t zero_point,
+    float scale) {
+  if constexpr (std::is_same_v<OUT_CTYPE, executorch::aten::Half>) {
+    constexpr size_t kBlockSize = 256;
+    float block[kBlockSize];
+    for (size_t begin = 0; begin < numel; begin += kBlockSize) {
+      const size_t size = std::min(kBlockSize, numel - begin);
+      for (size_t i = 0; i < size; i++) {
+        block[i] = (in[begin + i] - zero_point) * scale;
+      }
+      executorch::runtime::etensor::convert_array(block, out + begin, size);
+    }
+  } else {
+    for (size_t i = 0; i < numel; i++) {
+      out[i] = static_cast<OUT_CTYPE>((in[i] - zero_point) * scale);
+    }
+  }
+}
+
 } // namespace
 
 /**
@@ -281,12 +312,12 @@ Tensor& dequantize_per_tensor_out(
      * get inlined without LTO, particularly in ATen mode. */                  \
     auto* out_data_ptr = out.mutable_data_ptr<OUT_CTYPE>();                    \
     const auto* input_data_ptr = input.const_data_ptr<IN_CTYPE>();             \
-    const auto input_numel = input.numel();                                    \
-    for (size_t i = 0; i < input_numel; i++) {                                 \
-      out_data_ptr[i] = static_cast<OUT_CTYPE>(                                \
-          (input_data_ptr[i] - static_cast<int32_t>(zero_point)) *             \
-          static_cast<float>(scale));                                          \
-    }                                                                          \
+    dequantize_per_tensor_impl(                                                \
+        input_data_ptr,                                                        \
+        out_data_ptr,                                                          \
+        input.numel(),                                                         \
+        static_cast<int32_t>(zero_point),                                      \
+        static_cast<float>(scale));                                            \
   } break;
 #define CALCULATE_INT_TYPE(IN_CTYPE, in_dtype)                \
   case ScalarType::in_dtype:                                  \
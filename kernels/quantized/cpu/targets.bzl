@@ -16,6 +16,7 @@ _QUANT_OPS = (
         name = "op_dequantize",
         deps = [
             "//executorch/kernels/portable/cpu/util:reduce_util",
+            "//executorch/runtime/core/portable_type:scalar_type",
         ],
         _aten_mode_deps = [
             "//executorch/kernels/portable/cpu/util:reduce_util_aten",
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file
+ * Converts arrays of Half or BFloat16 to and from float. The results are
+ * identical to those of converting the elements one at a time with the
+ * constructors and conversion operators of Half and BFloat16, but use the
+ * conversion instructions of the host where it has them: F16C or AVX-512 on
+ * x86, fcvt on AArch64. Without F16C, x86 runs the bit manipulations of the
+ * scalar Half conversions on SSE2 vectors. BFloat16 rounds to nearest even,
+ * with SSE2 or NEON integer arithmetic.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <executorch/runtime/core/portable_type/bfloat16.h>
+#include <executorch/runtime/core/portable_type/half.h>
+
+#if defined(__F16C__) || defined(__AVX512F__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace executorch::runtime::etensor {
+
+/// Converts `n` Half values at `src` to float.
+inline void convert_to_float(const Half* src, float* dst, size_t n) {
+  size_t i = 0;
+#if defined(__AVX512F__)
+  for (; i + 16 <= n; i += 16) {
+    const __m256i h =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm512_storeu_ps(dst + i, _mm512_cvtph_ps(h));
+  }
+#endif // __AVX512F__
+#if defined(__F16C__)
+  for (; i + 8 <= n; i += 8) {
+    const __m128i h =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+#elif defined(__aarch64__)
+  for (; i + 4 <= n; i += 4) {
+    const float16x4_t h = vreinterpret_f16_u16(
+        vld1_u16(reinterpret_cast<const uint16_t*>(src + i)));
+    vst1q_f32(dst + i, vcvt_f32_f16(h));
+  }
+#elif defined(__SSE2__)
+  // The branchless algorithm of fp16_ieee_to_fp32_value(), four lanes at a
+  // time: normal values are rebiased by scaling, denormals are built as
+  // 0.5 + mantissa * 2^-24 and then have the 0.5 subtracted.
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i exp_offset = _mm_set1_epi32(0xE0 << 23);
+  const __m128 exp_scale = _mm_castsi128_ps(_mm_set1_epi32(15 << 23));
+  const __m128i magic_mask = _mm_set1_epi32(126 << 23);
+  const __m128 magic_bias = _mm_set1_ps(0.5f);
+  const __m128i sign_mask = _mm_set1_epi32(INT32_MIN);
+  // two_w < 2^27, halved so that the signed comparison works.
+  const __m128i denormalized_cutoff = _mm_set1_epi32(1 << 26);
+  const auto widen = [&](const __m128i w) {
+    const __m128i two_w = _mm_add_epi32(w, w);
+    const __m128 normalized = _mm_mul_ps(
+        _mm_castsi128_ps(_mm_add_epi32(_mm_srli_epi32(two_w, 4), exp_offset)),
+        exp_scale);
+    const __m128 denormalized = _mm_sub_ps(
+        _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(two_w, 17), magic_mask)),
+        magic_bias);
+    const __m128i is_denormal =
+        _mm_cmplt_epi32(_mm_srli_epi32(two_w, 1), denormalized_cutoff);
+    const __m128i magnitude = _mm_or_si128(
+        _mm_and_si128(is_denormal, _mm_castps_si128(denormalized)),
+        _mm_andnot_si128(is_denormal, _mm_castps_si128(normalized)));
+    return _mm_castsi128_ps(
+        _mm_or_si128(_mm_and_si128(w, sign_mask), magnitude));
+  };
+  for (; i + 8 <= n; i += 8) {
+    const __m128i h =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_ps(dst + i, widen(_mm_unpacklo_epi16(zero, h)));
+    _mm_storeu_ps(dst + i + 4, widen(_mm_unpackhi_epi16(zero, h)));
+  }
+#endif // __F16C__
+  for (; i < n; ++i) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+/// Converts `n` float values at `src` to Half, rounding to nearest even.
+inline void convert_from_float(const float* src, Half* dst, size_t n) {
+  size_t i = 0;
+#if defined(__AVX512F__)
+  for (; i + 16 <= n; i += 16) {
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(dst + i),
+        _mm512_cvtps_ph(_mm512_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+  }
+#endif // __AVX512F__
+#if defined(__F16C__)
+  for (; i + 8 <= n; i += 8) {
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dst + i),
+        _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+  }
+#elif defined(__aarch64__)
+  for (; i + 4 <= n; i += 4) {
+    const float16x4_t h = vcvt_f16_f32(vld1q_f32(src + i));
+    vst1_u16(reinterpret_cast<uint16_t*>(dst + i), vreinterpret_u16_f16(h));
+  }
+#elif defined(__SSE2__)
+  // The branchless algorithm of fp16_ieee_from_fp32_value(), four lanes at a
+  // time: adding a power of two chosen from the exponent rounds the mantissa
+  // to the 10 bits of Half.
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(INT32_MAX));
+  const __m128 scale_to_inf = _mm_castsi128_ps(_mm_set1_epi32(239 << 23));
+  const __m128 scale_to_zero = _mm_castsi128_ps(_mm_set1_epi32(17 << 23));
+  const __m128i exp_mask = _mm_set1_epi32(0xFF000000);
+  const __m128i min_bias = _mm_set1_epi32(0x71000000 >> 1);
+  const __m128i bias_offset = _mm_set1_epi32(0x07800000);
+  const __m128i inf_bits = _mm_set1_epi32(0x7F800000);
+  const __m128i nan = _mm_set1_epi32(0x7E00);
+  const auto narrow = [&](const __m128 x) {
+    const __m128 base = _mm_mul_ps(
+        _mm_mul_ps(_mm_and_ps(x, abs_mask), scale_to_inf), scale_to_zero);
+    const __m128i w = _mm_castps_si128(x);
+    const __m128i shl1_w = _mm_add_epi32(w, w);
+    // max(bias, 0x71000000) >> 1, with the shift first so that the signed
+    // comparison works.
+    __m128i half_bias = _mm_srli_epi32(_mm_and_si128(shl1_w, exp_mask), 1);
+    const __m128i is_small = _mm_cmplt_epi32(half_bias, min_bias);
+    half_bias = _mm_or_si128(
+        _mm_and_si128(is_small, min_bias),
+        _mm_andnot_si128(is_small, half_bias));
+    const __m128i bits = _mm_castps_si128(_mm_add_ps(
+        _mm_castsi128_ps(_mm_add_epi32(half_bias, bias_offset)), base));
+    const __m128i nonsign = _mm_add_epi32(
+        _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(0x7C00)),
+        _mm_and_si128(bits, _mm_set1_epi32(0x0FFF)));
+    const __m128i is_nan = _mm_cmpgt_epi32(
+        _mm_castps_si128(_mm_and_ps(x, abs_mask)), inf_bits);
+    const __m128i magnitude = _mm_or_si128(
+        _mm_and_si128(is_nan, nan), _mm_andnot_si128(is_nan, nonsign));
+    const __m128i sign = _mm_srli_epi32(_mm_andnot_si128(
+        _mm_castps_si128(abs_mask), w), 16);
+    // Sign extends the 16-bit results so that _mm_packs_epi32 keeps them.
+    return _mm_srai_epi32(
+        _mm_slli_epi32(_mm_or_si128(sign, magnitude), 16), 16);
+  };
+  for (; i + 8 <= n; i += 8) {
+    const __m128i lo = narrow(_mm_loadu_ps(src + i));
+    const __m128i hi = narrow(_mm_loadu_ps(src + i + 4));
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lo, hi));
+  }
+#endif // __F16C__
+  for (; i < n; ++i) {
+    dst[i] = static_cast<Half>(src[i]);
+  }
+}
+
+/// Converts `n` BFloat16 values at `src` to float.
+inline void convert_to_float(const BFloat16* src, float* dst, size_t n) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 8 <= n; i += 8) {
+    const __m128i h =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    // Interleaving zeros below each value shifts it into the high half.
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(zero, h));
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(zero, h));
+  }
+#elif defined(__aarch64__)
+  for (; i + 4 <= n; i += 4) {
+    const uint16x4_t h = vld1_u16(reinterpret_cast<const uint16_t*>(src + i));
+    vst1q_u32(reinterpret_cast<uint32_t*>(dst + i), vshll_n_u16(h, 16));
+  }
+#endif // __SSE2__
+  for (; i < n; ++i) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+/**
+ * Converts `n` float values at `src` to BFloat16, rounding to nearest even.
+ * NaNs become the canonical quiet NaN 0x7FC0, like BFloat16(float) does.
+ */
+inline void convert_from_float(const float* src, BFloat16* dst, size_t n) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i one = _mm_set1_epi32(1);
+  const __m128i bias = _mm_set1_epi32(0x7FFF);
+  const __m128i nan = _mm_set1_epi32(0x7FC0);
+  // Rounds the four values of `x` to the upper 16 bits of their lanes, then
+  // sign extends those into the lanes so that _mm_packs_epi32 keeps them.
+  const auto round = [&](const __m128 x) {
+    const __m128i u = _mm_castps_si128(x);
+    const __m128i lsb = _mm_and_si128(_mm_srli_epi32(u, 16), one);
+    const __m128i rounded =
+        _mm_srai_epi32(_mm_add_epi32(u, _mm_add_epi32(bias, lsb)), 16);
+    const __m128i is_nan = _mm_castps_si128(_mm_cmpunord_ps(x, x));
+    return _mm_or_si128(
+        _mm_and_si128(is_nan, nan), _mm_andnot_si128(is_nan, rounded));
+  };
+  for (; i + 8 <= n; i += 8) {
+    const __m128i lo = round(_mm_loadu_ps(src + i));
+    const __m128i hi = round(_mm_loadu_ps(src + i + 4));
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lo, hi));
+  }
+#elif defined(__aarch64__)
+  const uint32x4_t one = vdupq_n_u32(1);
+  const uint32x4_t bias = vdupq_n_u32(0x7FFF);
+  const uint32x4_t nan = vdupq_n_u32(0x7FC00000);
+  for (; i + 4 <= n; i += 4) {
+    const float32x4_t x = vld1q_f32(src + i);
+    const uint32x4_t u = vreinterpretq_u32_f32(x);
+    const uint32x4_t lsb = vandq_u32(vshrq_n_u32(u, 16), one);
+    const uint32x4_t rounded = vaddq_u32(u, vaddq_u32(bias, lsb));
+    const uint32x4_t is_number = vceqq_f32(x, x);
+    vst1_u16(
+        reinterpret_cast<uint16_t*>(dst + i),
+        vshrn_n_u32(vbslq_u32(is_number, rounded, nan), 16));
+  }
+#endif // __SSE2__
+  for (; i < n; ++i) {
+    dst[i] = static_cast<BFloat16>(src[i]);
+  }
+}
+
+namespace internal {
+
+template <typename T>
+constexpr bool is_float16_v =
+    std::is_same_v<T, Half> || std::is_same_v<T, BFloat16>;
+
+// Whether static_cast<To>() of a From value equals converting the value to
+// float first. Every Half and BFloat16 value is a float, and BFloat16 is only
+// constructed from float; Half converts from other types directly on AArch64,
+// which matters only for values that float would round.
+template <typename To, typename From>
+constexpr bool converts_through_float_v = is_float16_v<From> ||
+    (is_float16_v<To> &&
+     (std::is_same_v<To, BFloat16> ||
+      (std::is_integral_v<From> && sizeof(From) <= 2)));
+
+// The number of elements that convert_array() converts through float at a
+// time.
+constexpr size_t kConvertBlockSize = 256;
+
+} // namespace internal
+
+/**
+ * Converts `n` elements at `src` to To, with the same results as
+ * static_cast<To>() on every element. Conversions to or from Half and
+ * BFloat16 go through float with the converters above where that gives the
+ * same results.
+ */
+template <typename To, typename From>
+void convert_array(const From* src, To* dst, size_t n) {
+  if constexpr (std::is_same_v<To, From>) {
+    if (n > 0 && src != dst) {
+      std::memcpy(dst, src, n * sizeof(To));
+    }
+  } else if constexpr (
+      internal::is_float16_v<From> && std::is_same_v<To, float>) {
+    convert_to_float(src, dst, n);
+  } else if constexpr (
+      internal::is_float16_v<To> && std::is_same_v<From, float>) {
+    convert_from_float(src, dst, n);
+  } else if constexpr (internal::is_float16_v<From>) {
+    float block[internal::kConvertBlockSize];
+    for (size_t begin = 0; begin < n; begin += internal::kConvertBlockSize) {
+      const size_t size = std::min(internal::kConvertBlockSize, n - begin);
+      convert_to_float(src + begin, block, size);
+      for (size_t i = 0; i < size; ++i) {
+        dst[begin + i] = static_cast<To>(block[i]);
+      }
+    }
+  } else if constexpr (internal::converts_through_float_v<To, From>) {
+    float block[internal::kConvertBlockSize];
+    for (size_t begin = 0; begin < n; begin += internal::kConvertBlockSize) {
+      const size_t size = std::min(internal::kConvertBlockSize, n - begin);
+      for (size_t i = 0; i < size; ++i) {
+        block[i] = static_cast<float>(src[begin + i]);
+      }
+      convert_from_float(block, dst + begin, size);
+    }
+  } else {
+    for (size_t i = 0; i < n; ++i) {
+      dst[i] = static_cast<To>(src[i]);
+    }
+  }
+}
+
+} // namespace executorch::runtime::etensor
@@ -51,6 +51,7 @@ def define_common_targets():
             "bfloat16.h",
             "bfloat16_math.h",
             "complex.h",
+            "float16_convert.h",
             "half.h",
             "scalar_type.h",
             "qint_types.h",
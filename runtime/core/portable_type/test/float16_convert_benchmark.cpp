@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Measures the throughput of the bulk Half/BFloat16 <-> float converters
+// against converting one element at a time, on arrays that fit in L1 and on
+// arrays that do not fit in cache. The bytes processed count both the bytes
+// read and the bytes written.
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <executorch/runtime/core/portable_type/float16_convert.h>
+
+using executorch::runtime::etensor::BFloat16;
+using executorch::runtime::etensor::convert_array;
+using executorch::runtime::etensor::Half;
+
+namespace {
+
+template <typename To, typename From>
+void scalar_convert(const From* src, To* dst, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    dst[i] = static_cast<To>(src[i]);
+  }
+}
+
+template <typename To, typename From, bool kBulk>
+void BM_Convert(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  std::vector<From> src(n);
+  for (size_t i = 0; i < n; ++i) {
+    src[i] = static_cast<From>(static_cast<float>(i % 1000) * 0.37f - 150.f);
+  }
+  std::vector<To> dst(n);
+  for (auto _ : state) {
+    if constexpr (kBulk) {
+      convert_array(src.data(), dst.data(), n);
+    } else {
+      scalar_convert(src.data(), dst.data(), n);
+    }
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(
+      state.iterations() * n * (sizeof(From) + sizeof(To)));
+}
+
+#define BENCHMARK_CONVERSION(To, From)                      \
+  BENCHMARK_TEMPLATE(BM_Convert, To, From, /*kBulk=*/false) \
+      ->Arg(4096)                                           \
+      ->Arg(1 << 22);                                       \
+  BENCHMARK_TEMPLATE(BM_Convert, To, From, /*kBulk=*/true)  \
+      ->Arg(4096)                                           \
+      ->Arg(1 << 22)
+
+BENCHMARK_CONVERSION(float, Half);
+BENCHMARK_CONVERSION(Half, float);
+BENCHMARK_CONVERSION(float, BFloat16);
+BENCHMARK_CONVERSION(BFloat16, float);
+BENCHMARK_CONVERSION(int32_t, Half);
+BENCHMARK_CONVERSION(Half, uint8_t);
+
+} // namespace
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/runtime/core/portable_type/float16_convert.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using executorch::runtime::etensor::BFloat16;
+using executorch::runtime::etensor::convert_array;
+using executorch::runtime::etensor::convert_from_float;
+using executorch::runtime::etensor::convert_to_float;
+using executorch::runtime::etensor::Half;
+
+namespace {
+
+uint32_t bits_of(float f) {
+  uint32_t bits;
+  std::memcpy(&bits, &f, sizeof(bits));
+  return bits;
+}
+
+float float_from_bits(uint32_t bits) {
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+// Floats spread over every exponent, plus the ones at the edges of the
+// rounding of Half and BFloat16: ties, denormals, infinities and NaNs.
+std::vector<float> interesting_floats() {
+  std::vector<float> values;
+  for (uint64_t bits = 0; bits <= 0xFFFFFFFF; bits += 40009) {
+    values.push_back(float_from_bits(static_cast<uint32_t>(bits)));
+  }
+  for (const uint32_t base : {0x3F800000u, 0x477FE000u, 0x38800000u}) {
+    for (uint32_t low = 0; low < 0x10000; low += 0x0FFF) {
+      values.push_back(float_from_bits(base | low));
+      values.push_back(float_from_bits(base | low | 0x8000));
+      values.push_back(float_from_bits((base | low) ^ 0x80000000));
+    }
+  }
+  for (const uint32_t bits :
+       {0x00000000u,
+        0x80000000u,
+        0x00000001u,
+        0x33800000u,
+        0x33000001u,
+        0x477FF000u,
+        0x477FEFFFu,
+        0x7F7FFFFFu,
+        0x7F7F8000u,
+        0x7F800000u,
+        0xFF800000u,
+        0x7FC00000u,
+        0xFFC00001u,
+        0x7F800001u,
+        0x7FBFFFFFu}) {
+    values.push_back(float_from_bits(bits));
+  }
+  return values;
+}
+
+template <typename T>
+void expect_to_float_matches_scalar() {
+  std::vector<T> src(0x10000);
+  for (uint32_t bits = 0; bits < 0x10000; ++bits) {
+    src[bits].x = static_cast<uint16_t>(bits);
+  }
+  // Every length up to a few vectors exercises the scalar tails.
+  for (size_t n : {size_t(0), size_t(1), size_t(7), size_t(17), src.size()}) {
+    std::vector<float> dst(n);
+    convert_to_float(src.data(), dst.data(), n);
+    for (size_t i = 0; i < n; ++i) {
+      EXPECT_EQ(bits_of(dst[i]), bits_of(static_cast<float>(src[i])))
+          << "at bits 0x" << std::hex << src[i].x;
+    }
+  }
+}
+
+template <typename T>
+void expect_from_float_matches_scalar() {
+  const std::vector<float> src = interesting_floats();
+  for (size_t n : {size_t(0), size_t(3), size_t(9), size_t(33), src.size()}) {
+    std::vector<T> dst(n);
+    convert_from_float(src.data(), dst.data(), n);
+    for (size_t i = 0; i < n; ++i) {
+      EXPECT_EQ(dst[i].x, static_cast<T>(src[i]).x)
+          << "at float bits 0x" << std::hex << bits_of(src[i]);
+    }
+  }
+}
+
+template <typename To, typename From>
+void expect_convert_array_matches_static_cast(const std::vector<From>& src) {
+  // Not a vector, which would pack bools.
+  std::unique_ptr<To[]> dst(new To[src.size()]);
+  convert_array(src.data(), dst.get(), src.size());
+  for (size_t i = 0; i < src.size(); ++i) {
+    EXPECT_EQ(dst[i], static_cast<To>(src[i])) << "at " << i;
+  }
+}
+
+} // namespace
+
+TEST(Float16ConvertTest, HalfToFloatMatchesScalar) {
+  expect_to_float_matches_scalar<Half>();
+}
+
+TEST(Float16ConvertTest, BFloat16ToFloatMatchesScalar) {
+  expect_to_float_matches_scalar<BFloat16>();
+}
+
+TEST(Float16ConvertTest, FloatToHalfMatchesScalar) {
+  expect_from_float_matches_scalar<Half>();
+}
+
+TEST(Float16ConvertTest, FloatToBFloat16MatchesScalar) {
+  expect_from_float_matches_scalar<BFloat16>();
+}
+
+TEST(Float16ConvertTest, ConvertArrayMatchesStaticCast) {
+  // More elements than a block of the conversions through float.
+  std::vector<int16_t> ints(1000);
+  std::vector<float> floats(1000);
+  for (size_t i = 0; i < ints.size(); ++i) {
+    ints[i] = static_cast<int16_t>(i * 131 - 60000);
+    floats[i] = static_cast<float>(i) * 0.37f - 150.f;
+  }
+  std::vector<Half> halves(floats.size());
+  std::vector<BFloat16> bfloats(floats.size());
+  convert_from_float(floats.data(), halves.data(), floats.size());
+  convert_from_float(floats.data(), bfloats.data(), floats.size());
+
+  expect_convert_array_matches_static_cast<Half>(ints);
+  expect_convert_array_matches_static_cast<BFloat16>(ints);
+  expect_convert_array_matches_static_cast<Half>(floats);
+  expect_convert_array_matches_static_cast<int32_t>(halves);
+  expect_convert_array_matches_static_cast<double>(halves);
+  expect_convert_array_matches_static_cast<bool>(halves);
+  expect_convert_array_matches_static_cast<BFloat16>(halves);
+  expect_convert_array_matches_static_cast<Half>(bfloats);
+  expect_convert_array_matches_static_cast<int64_t>(bfloats);
+  expect_convert_array_matches_static_cast<Half>(
+      std::vector<int64_t>{0, 1, -7, 65504, 70000, (int64_t(1) << 40) + 1});
+  expect_convert_array_matches_static_cast<BFloat16>(
+      std::vector<double>{0.1, -2.5, 1e30, 1e-30});
+  expect_convert_array_matches_static_cast<Half>(
+      std::vector<uint8_t>{1, 0, 255});
+  expect_convert_array_matches_static_cast<float>(floats);
+}
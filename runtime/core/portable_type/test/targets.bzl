@@ -15,6 +15,23 @@ def define_common_targets():
         ],
     )
 
+    runtime.cxx_test(
+        name = "float16_convert_test",
+        srcs = ["float16_convert_test.cpp"],
+        deps = [
+            "//executorch/runtime/core/portable_type:scalar_type",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "float16_convert_benchmark",
+        srcs = ["float16_convert_benchmark.cpp"],
+        deps = [
+            "//third-party/benchmark:benchmark",
+            "//executorch/runtime/core/portable_type:scalar_type",
+        ],
+    )
+
     runtime.cxx_test(
         name = "optional_test",
         srcs = ["optional_test.cpp"],
@@ -0,0 +1,602 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/runtime/executor/memory_planner.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <executorch/runtime/core/exec_aten/util/tensor_util.h>
+#include <executorch/runtime/platform/log.h>
+#include <executorch/schema/program_generated.h>
+
+namespace executorch {
+namespace ET_RUNTIME_NAMESPACE {
+
+namespace {
+
+bool lifetimes_overlap(const PlannedTensorInfo& a, const PlannedTensorInfo& b) {
+  if (a.is_persistent || b.is_persistent) {
+    return true;
+  }
+  return a.first_use <= b.last_use && b.first_use <= a.last_use;
+}
+
+size_t align_up(size_t value, size_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Inserts `index` into the first `count` entries of `placed`, which are kept
+// sorted by offset.
+void insert_by_offset(
+    size_t* placed,
+    size_t count,
+    size_t index,
+    const size_t* offsets) {
+  size_t pos = count;
+  while (pos > 0 && offsets[placed[pos - 1]] > offsets[index]) {
+    placed[pos] = placed[pos - 1];
+    --pos;
+  }
+  placed[pos] = index;
+}
+
+template <typename T>
+Error allocate_list(MemoryAllocator* allocator, size_t count, T** out) {
+  if (count == 0) {
+    *out = nullptr;
+    return Error::Ok;
+  }
+  *out = allocator->allocateList<T>(count);
+  ET_CHECK_OR_RETURN_ERROR(
+      *out != nullptr,
+      MemoryAllocationFailed,
+      "Failed to allocate %" ET_PRIsize_t " entries of %" ET_PRIsize_t
+      " bytes",
+      count,
+      sizeof(T));
+  return Error::Ok;
+}
+
+// Sets alias_of[i] to the first tensor of the alias set of tensor i: the
+// tensors at the same buffer and offset whose lifetimes overlap, such as a
+// view and its base. `order` is scratch for `tensors.size()` entries.
+void find_aliases(
+    Span<const PlannedTensorInfo> tensors,
+    size_t* alias_of,
+    size_t* order) {
+  size_t num_used = 0;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    alias_of[i] = i;
+    if (tensors[i].is_persistent || tensors[i].first_use >= 0) {
+      order[num_used++] = i;
+    }
+  }
+  std::sort(order, order + num_used, [&tensors](size_t a, size_t b) {
+    const PlannedTensorInfo& ta = tensors[a];
+    const PlannedTensorInfo& tb = tensors[b];
+    if (ta.buffer_index != tb.buffer_index) {
+      return ta.buffer_index < tb.buffer_index;
+    }
+    if (ta.offset != tb.offset) {
+      return ta.offset < tb.offset;
+    }
+    if (ta.is_persistent != tb.is_persistent) {
+      return ta.is_persistent;
+    }
+    if (ta.first_use != tb.first_use) {
+      return ta.first_use < tb.first_use;
+    }
+    return a < b;
+  });
+
+  size_t first = 0;
+  bool persistent = false;
+  int64_t last_use = -1;
+  for (size_t k = 0; k < num_used; ++k) {
+    const PlannedTensorInfo& tensor = tensors[order[k]];
+    const PlannedTensorInfo& head = tensors[order[first]];
+    if (k > 0 && head.buffer_index == tensor.buffer_index &&
+        head.offset == tensor.offset &&
+        (persistent || tensor.first_use <= last_use)) {
+      alias_of[order[k]] = order[first];
+      last_use = std::max(last_use, tensor.last_use);
+      continue;
+    }
+    first = k;
+    persistent = tensor.is_persistent;
+    last_use = tensor.last_use;
+  }
+}
+
+int32_t round_up_dim(int32_t value, int32_t granularity) {
+  if (granularity > 0) {
+    return (value + granularity - 1) / granularity * granularity;
+  }
+  int32_t rounded = 1;
+  while (rounded < value && rounded <= INT32_MAX / 2) {
+    rounded *= 2;
+  }
+  return rounded < value ? value : rounded;
+}
+
+} // namespace
+
+Error plan_greedy_by_size(
+    Span<const PlannedTensorInfo> tensors,
+    size_t alignment,
+    Span<size_t> offsets,
+    Span<size_t> buffer_sizes,
+    Span<size_t> scratch) {
+  const size_t n = tensors.size();
+  ET_CHECK_OR_RETURN_ERROR(
+      alignment > 0 && (alignment & (alignment - 1)) == 0,
+      InvalidArgument,
+      "Alignment %" ET_PRIsize_t " is not a power of 2",
+      alignment);
+  ET_CHECK_OR_RETURN_ERROR(
+      offsets.size() >= n && scratch.size() >= 2 * n,
+      InvalidArgument,
+      "Output spans are too small for %" ET_PRIsize_t " tensors",
+      n);
+  for (size_t b = 0; b < buffer_sizes.size(); ++b) {
+    buffer_sizes[b] = 0;
+  }
+
+  size_t* order = scratch.data();
+  size_t* placed = scratch.data() + n;
+  size_t num_order = 0;
+  size_t num_placed = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const PlannedTensorInfo& tensor = tensors[i];
+    ET_CHECK_OR_RETURN_ERROR(
+        tensor.buffer_index < buffer_sizes.size(),
+        InvalidArgument,
+        "Tensor at value %" ET_PRIsize_t " is in buffer %" ET_PRIsize_t
+        " of %" ET_PRIsize_t,
+        tensor.value_index,
+        tensor.buffer_index,
+        buffer_sizes.size());
+    if (tensor.is_persistent) {
+      offsets[i] = tensor.offset;
+      insert_by_offset(placed, num_placed++, i, offsets.data());
+      buffer_sizes[tensor.buffer_index] = std::max(
+          buffer_sizes[tensor.buffer_index], tensor.offset + tensor.nbytes);
+    } else if (tensor.first_use < 0) {
+      offsets[i] = 0;
+    } else {
+      order[num_order++] = i;
+    }
+  }
+
+  std::sort(order, order + num_order, [&tensors](size_t a, size_t b) {
+    if (tensors[a].nbytes != tensors[b].nbytes) {
+      return tensors[a].nbytes > tensors[b].nbytes;
+    }
+    if (tensors[a].first_use != tensors[b].first_use) {
+      return tensors[a].first_use < tensors[b].first_use;
+    }
+    return a < b;
+  });
+
+  for (size_t k = 0; k < num_order; ++k) {
+    const size_t i = order[k];
+    const PlannedTensorInfo& tensor = tensors[i];
+    // Walk the conflicting tensors by increasing offset and take the first
+    // gap that is large enough.
+    size_t candidate = 0;
+    for (size_t p = 0; p < num_placed; ++p) {
+      const PlannedTensorInfo& other = tensors[placed[p]];
+      if (other.buffer_index != tensor.buffer_index ||
+          !lifetimes_overlap(tensor, other)) {
+        continue;
+      }
+      const size_t other_offset = offsets[placed[p]];
+      if (candidate + tensor.nbytes <= other_offset) {
+        break;
+      }
+      candidate =
+          std::max(candidate, align_up(other_offset + other.nbytes, alignment));
+    }
+    offsets[i] = candidate;
+    insert_by_offset(placed, num_placed++, i, offsets.data());
+    buffer_sizes[tensor.buffer_index] = std::max(
+        buffer_sizes[tensor.buffer_index], candidate + tensor.nbytes);
+  }
+  return Error::Ok;
+}
+
+Result<RuntimeMemoryPlanner> RuntimeMemoryPlanner::create(
+    Method* method,
+    MemoryAllocator* allocator,
+    const MemoryPlannerConfig& config) {
+#ifdef USE_ATEN_LIB
+  (void)method;
+  (void)allocator;
+  (void)config;
+  ET_LOG(Error, "Runtime memory planning is not supported in ATen mode");
+  return Error::NotSupported;
+#else
+  ET_CHECK_OR_RETURN_ERROR(
+      method != nullptr && allocator != nullptr,
+      InvalidArgument,
+      "Method and allocator must not be null");
+  ET_CHECK_OR_RETURN_ERROR(
+      method->initialized(),
+      InvalidState,
+      "Method must be initialized before it is re-planned");
+  ET_CHECK_OR_RETURN_ERROR(
+      config.max_cached_plans > 0 && config.bucket_granularity >= 0 &&
+          config.alignment > 0 &&
+          (config.alignment & (config.alignment - 1)) == 0,
+      InvalidArgument,
+      "Invalid memory planner config");
+
+  // Lifetimes are computed over the linear order of the instructions, which
+  // does not hold once a jump can revisit them.
+  const auto chains = method->serialization_plan_->chains();
+  for (size_t c = 0; chains != nullptr && c < chains->size(); ++c) {
+    const auto instructions = chains->Get(c)->instructions();
+    for (size_t i = 0; instructions != nullptr && i < instructions->size();
+         ++i) {
+      ET_CHECK_OR_RETURN_ERROR(
+          instructions->Get(i)->instr_args_type() !=
+              executorch_flatbuffer::InstructionArguments::JumpFalseCall,
+          NotSupported,
+          "Methods with control flow can not be re-planned");
+    }
+  }
+
+  MethodMeta meta = method->method_meta();
+  RuntimeMemoryPlanner planner(method, config);
+
+  const size_t n = meta.num_planned_tensors();
+  ET_CHECK_OK_OR_RETURN_ERROR(allocate_list(allocator, n, &planner.tensors_));
+  ET_CHECK_OK_OR_RETURN_ERROR(allocate_list(allocator, n, &planner.measured_));
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      allocate_list(allocator, n, &planner.export_offsets_));
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      allocate_list(allocator, 2 * n, &planner.scratch_));
+  Result<size_t> num_tensors =
+      meta.planned_tensor_infos(Span<PlannedTensorInfo>(planner.tensors_, n));
+  if (!num_tensors.ok()) {
+    return num_tensors.error();
+  }
+  planner.num_tensors_ = num_tensors.get();
+  for (size_t i = 0; i < planner.num_tensors_; ++i) {
+    planner.export_offsets_[i] = planner.tensors_[i].offset;
+  }
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      allocate_list(allocator, n, &planner.alias_of_));
+  find_aliases(
+      Span<const PlannedTensorInfo>(planner.tensors_, planner.num_tensors_),
+      planner.alias_of_,
+      planner.scratch_);
+
+  planner.num_buffers_ = meta.num_memory_planned_buffers();
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      allocate_list(allocator, planner.num_buffers_, &planner.buffers_));
+  HierarchicalAllocator* planned_memory =
+      method->memory_manager_->planned_memory();
+  ET_CHECK_OR_RETURN_ERROR(
+      planner.num_buffers_ == 0 || planned_memory != nullptr,
+      InvalidState,
+      "Method has memory-planned buffers but no planned memory");
+  for (size_t b = 0; b < planner.num_buffers_; ++b) {
+    Result<int64_t> size = meta.memory_planned_buffer_size(b);
+    if (!size.ok()) {
+      return size.error();
+    }
+    Result<void*> base = planned_memory->get_offset_address(
+        static_cast<uint32_t>(b), 0, static_cast<size_t>(size.get()));
+    if (!base.ok()) {
+      return base.error();
+    }
+    planner.buffers_[b] = Span<uint8_t>(
+        static_cast<uint8_t*>(base.get()), static_cast<size_t>(size.get()));
+  }
+
+  planner.num_inputs_ = meta.num_inputs();
+  ET_CHECK_OK_OR_RETURN_ERROR(allocate_list(
+      allocator, planner.num_inputs_ + 1, &planner.input_dims_begin_));
+  planner.num_dims_ = 0;
+  for (size_t i = 0; i < planner.num_inputs_; ++i) {
+    planner.input_dims_begin_[i] = planner.num_dims_;
+    Result<Tag> tag = meta.input_tag(i);
+    if (!tag.ok()) {
+      return tag.error();
+    }
+    if (tag.get() == Tag::Tensor) {
+      Result<TensorInfo> info = meta.input_tensor_meta(i);
+      if (!info.ok()) {
+        return info.error();
+      }
+      planner.num_dims_ += info->sizes().size();
+    }
+  }
+  planner.input_dims_begin_[planner.num_inputs_] = planner.num_dims_;
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      allocate_list(allocator, planner.num_dims_, &planner.upper_bounds_));
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      allocate_list(allocator, planner.num_dims_, &planner.bucket_));
+  ET_CHECK_OK_OR_RETURN_ERROR(allocate_list(
+      allocator, planner.num_inputs_, &planner.saved_input_set_));
+  for (size_t i = 0; i < planner.num_inputs_; ++i) {
+    const size_t begin = planner.input_dims_begin_[i];
+    if (planner.input_dims_begin_[i + 1] == begin) {
+      continue;
+    }
+    Result<TensorInfo> info = meta.input_tensor_meta(i);
+    if (!info.ok()) {
+      return info.error();
+    }
+    for (size_t d = 0; d < info->sizes().size(); ++d) {
+      planner.upper_bounds_[begin + d] = info->sizes()[d];
+    }
+  }
+
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      allocate_list(allocator, config.max_cached_plans, &planner.plans_));
+  for (size_t p = 0; p < config.max_cached_plans; ++p) {
+    CachedPlan& plan = planner.plans_[p];
+    ET_CHECK_OK_OR_RETURN_ERROR(
+        allocate_list(allocator, planner.num_dims_, &plan.bucket));
+    ET_CHECK_OK_OR_RETURN_ERROR(
+        allocate_list(allocator, planner.num_tensors_, &plan.offsets));
+    ET_CHECK_OK_OR_RETURN_ERROR(
+        allocate_list(allocator, planner.num_buffers_, &plan.buffer_sizes));
+    plan.last_used = 0;
+    plan.valid = false;
+  }
+  return planner;
+#endif // USE_ATEN_LIB
+}
+
+Error RuntimeMemoryPlanner::compute_bucket(
+    executorch::aten::ArrayRef<EValue> inputs,
+    int32_t* bucket) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      inputs.size() == num_inputs_,
+      InvalidArgument,
+      "Expected %" ET_PRIsize_t " inputs but got %" ET_PRIsize_t,
+      num_inputs_,
+      inputs.size());
+  for (size_t i = 0; i < num_inputs_; ++i) {
+    const size_t begin = input_dims_begin_[i];
+    const size_t dim = input_dims_begin_[i + 1] - begin;
+    if (dim == 0 && !inputs[i].isTensor()) {
+      continue;
+    }
+    ET_CHECK_OR_RETURN_ERROR(
+        inputs[i].isTensor() &&
+            static_cast<size_t>(inputs[i].toTensor().dim()) == dim,
+        InvalidArgument,
+        "Input %" ET_PRIsize_t " must be a tensor of %" ET_PRIsize_t
+        " dimensions",
+        i,
+        dim);
+    const auto sizes = inputs[i].toTensor().sizes();
+    for (size_t d = 0; d < dim; ++d) {
+      const int32_t upper_bound = upper_bounds_[begin + d];
+      ET_CHECK_OR_RETURN_ERROR(
+          sizes[d] <= upper_bound,
+          InvalidArgument,
+          "Dimension %" ET_PRIsize_t " of input %" ET_PRIsize_t
+          " exceeds its upper bound %" PRId32,
+          d,
+          i,
+          upper_bound);
+      bucket[begin + d] = std::min(
+          round_up_dim(sizes[d], config_.bucket_granularity), upper_bound);
+    }
+  }
+  return Error::Ok;
+}
+
+Error RuntimeMemoryPlanner::prepare(executorch::aten::ArrayRef<EValue> inputs) {
+  ET_CHECK_OR_RETURN_ERROR(
+      !method_->in_progress(),
+      InvalidState,
+      "Can not re-plan a method while it is executing");
+  ET_CHECK_OK_OR_RETURN_ERROR(compute_bucket(inputs, bucket_));
+
+  // On a miss, replace an unused slot or else the least recently used plan.
+  CachedPlan* victim = &plans_[0];
+  for (size_t p = 0; p < config_.max_cached_plans; ++p) {
+    CachedPlan& plan = plans_[p];
+    if (plan.valid && std::equal(bucket_, bucket_ + num_dims_, plan.bucket)) {
+      plan.last_used = ++clock_;
+      return apply(&plan);
+    }
+    if (!victim->valid) {
+      continue;
+    }
+    if (!plan.valid || plan.last_used < victim->last_used) {
+      victim = &plan;
+    }
+  }
+
+  victim->valid = false;
+  ET_CHECK_OK_OR_RETURN_ERROR(calibrate(bucket_, victim));
+  victim->valid = true;
+  victim->last_used = ++clock_;
+  return apply(victim);
+}
+
+Error RuntimeMemoryPlanner::calibrate(
+    const int32_t* bucket,
+    CachedPlan* plan) {
+  MethodMeta meta = method_->method_meta();
+  bool has_state = false;
+  for (size_t i = 0; i < num_tensors_; ++i) {
+    has_state |= tensors_[i].is_persistent;
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      !has_state || config_.allow_calibration_with_state,
+      NotSupported,
+      "Calibration would update the state of the method; see "
+      "MemoryPlannerConfig::allow_calibration_with_state");
+  for (size_t i = 0; i < num_inputs_; ++i) {
+    if (input_dims_begin_[i + 1] == input_dims_begin_[i]) {
+      continue;
+    }
+    ET_CHECK_OR_RETURN_ERROR(
+        meta.input_tensor_meta(i)->is_memory_planned(),
+        NotSupported,
+        "Calibration requires memory-planned inputs, input %" ET_PRIsize_t
+        " is not",
+        i);
+  }
+  for (size_t i = 0; i < meta.num_outputs(); ++i) {
+    Result<Tag> tag = meta.output_tag(i);
+    ET_CHECK_OR_RETURN_ERROR(
+        !tag.ok() || tag.get() != Tag::Tensor ||
+            meta.output_tensor_meta(i)->is_memory_planned(),
+        NotSupported,
+        "Calibration requires memory-planned outputs, output %" ET_PRIsize_t
+        " is not",
+        i);
+  }
+
+  // Run with the export-time plan, which fits any shape, on zero-filled
+  // inputs at the upper bound of the bucket.
+  ET_CHECK_OK_OR_RETURN_ERROR(restore());
+  for (size_t i = 0; i < num_inputs_; ++i) {
+    saved_input_set_[i] = method_->input_set_[i];
+    const size_t begin = input_dims_begin_[i];
+    const size_t dim = input_dims_begin_[i + 1] - begin;
+    if (dim > 0) {
+      executorch::aten::Tensor tensor =
+          method_->mutable_value(method_->get_input_index(i)).toTensor();
+      ET_CHECK_OK_OR_RETURN_ERROR(resize_tensor(
+          tensor,
+          executorch::aten::ArrayRef<executorch::aten::SizesType>(
+              bucket + begin, dim)));
+      memset(tensor.mutable_data_ptr(), 0, tensor.nbytes());
+    }
+    method_->input_set_[i] = true;
+  }
+  Error err = method_->execute();
+  for (size_t i = 0; i < num_inputs_; ++i) {
+    const bool is_tensor = input_dims_begin_[i + 1] > input_dims_begin_[i];
+    method_->input_set_[i] = !is_tensor && saved_input_set_[i];
+  }
+  if (err != Error::Ok) {
+    ET_LOG(Error, "Calibration failed: 0x%" PRIx32, static_cast<uint32_t>(err));
+    return err;
+  }
+  ++num_calibrations_;
+
+  for (size_t i = 0; i < num_tensors_; ++i) {
+    measured_[i] = tensors_[i];
+    const EValue& value = method_->get_value(tensors_[i].value_index);
+    if (!tensors_[i].is_persistent && value.isTensor()) {
+      measured_[i].nbytes =
+          std::min(value.toTensor().nbytes(), tensors_[i].nbytes);
+    }
+  }
+  // A view shares the memory of its base, so the tensors of an alias set are
+  // placed as one block that is live as long as any of them and as large as
+  // the largest.
+  for (size_t i = 0; i < num_tensors_; ++i) {
+    const size_t first = alias_of_[i];
+    if (first == i) {
+      continue;
+    }
+    PlannedTensorInfo& block = measured_[first];
+    block.nbytes = std::max(block.nbytes, measured_[i].nbytes);
+    block.last_use = std::max(block.last_use, measured_[i].last_use);
+    measured_[i].first_use = -1;
+    measured_[i].last_use = -1;
+    measured_[i].is_persistent = false;
+  }
+  std::copy(bucket, bucket + num_dims_, plan->bucket);
+  ET_CHECK_OK_OR_RETURN_ERROR(plan_greedy_by_size(
+      Span<const PlannedTensorInfo>(measured_, num_tensors_),
+      config_.alignment,
+      Span<size_t>(plan->offsets, num_tensors_),
+      Span<size_t>(plan->buffer_sizes, num_buffers_),
+      Span<size_t>(scratch_, 2 * num_tensors_)));
+  for (size_t i = 0; i < num_tensors_; ++i) {
+    plan->offsets[i] = plan->offsets[alias_of_[i]];
+  }
+
+  // The heuristic is not guaranteed to beat the export-time plan; keep the
+  // latter if it does not fit.
+  for (size_t b = 0; b < num_buffers_; ++b) {
+    if (plan->buffer_sizes[b] > buffers_[b].size()) {
+      ET_LOG(
+          Info,
+          "Re-planned buffer %" ET_PRIsize_t
+          " does not fit, keeping the export-time plan",
+          b);
+      std::copy(
+          export_offsets_, export_offsets_ + num_tensors_, plan->offsets);
+      for (size_t c = 0; c < num_buffers_; ++c) {
+        plan->buffer_sizes[c] = buffers_[c].size();
+      }
+      break;
+    }
+  }
+  return Error::Ok;
+}
+
+Error RuntimeMemoryPlanner::apply(const CachedPlan* plan) {
+  if (plan == current_) {
+    return Error::Ok;
+  }
+#ifndef USE_ATEN_LIB
+  const size_t* offsets = plan != nullptr ? plan->offsets : export_offsets_;
+  for (size_t i = 0; i < num_tensors_; ++i) {
+    const PlannedTensorInfo& tensor = tensors_[i];
+    EValue& value = method_->mutable_value(tensor.value_index);
+    if (tensor.is_persistent || !value.isTensor()) {
+      continue;
+    }
+    value.toTensor().unsafeGetTensorImpl()->set_data(
+        buffers_[tensor.buffer_index].data() + offsets[i]);
+  }
+#endif // USE_ATEN_LIB
+  // The data of planned inputs has moved, so they need to be set again.
+  for (size_t i = 0; i < num_inputs_; ++i) {
+    if (input_dims_begin_[i + 1] > input_dims_begin_[i]) {
+      method_->input_set_[i] = false;
+    }
+  }
+  current_ = plan;
+  return Error::Ok;
+}
+
+Error RuntimeMemoryPlanner::restore() {
+  ET_CHECK_OR_RETURN_ERROR(
+      !method_->in_progress(),
+      InvalidState,
+      "Can not re-plan a method while it is executing");
+  return apply(nullptr);
+}
+
+size_t RuntimeMemoryPlanner::planned_buffer_size(size_t buffer_index) const {
+  ET_CHECK_MSG(
+      buffer_index < num_buffers_,
+      "%" ET_PRIsize_t " >= %" ET_PRIsize_t,
+      buffer_index,
+      num_buffers_);
+  return current_ != nullptr ? current_->buffer_sizes[buffer_index]
+                             : buffers_[buffer_index].size();
+}
+
+size_t RuntimeMemoryPlanner::num_cached_plans() const {
+  size_t count = 0;
+  for (size_t p = 0; p < config_.max_cached_plans; ++p) {
+    count += plans_[p].valid ? 1 : 0;
+  }
+  return count;
+}
+
+} // namespace ET_RUNTIME_NAMESPACE
+} // namespace executorch
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/evalue.h>
+#include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/core/span.h>
+#include <executorch/runtime/executor/method.h>
+#include <executorch/runtime/executor/method_meta.h>
+#include <executorch/runtime/platform/compiler.h>
+
+namespace executorch {
+namespace ET_RUNTIME_NAMESPACE {
+
+/**
+ * EXPERIMENTAL: Assigns new offsets to memory-planned tensors with the
+ * greedy-by-size heuristic: tensors are placed from the largest to the
+ * smallest, each at the lowest offset of its buffer that does not overlap a
+ * tensor already placed there whose lifetime intersects its own.
+ *
+ * Persistent tensors (see PlannedTensorInfo::is_persistent) keep their offset
+ * and are treated as live during the whole method. Tensors that are never
+ * used are given offset 0.
+ *
+ * @param[in] tensors The tensors to place. Their `nbytes` is the size to
+ *     reserve, which may be smaller than the size planned during export.
+ * @param[in] alignment The alignment of every offset. Must be a power of 2.
+ * @param[out] offsets Receives the new offset of every tensor. Must hold
+ *     `tensors.size()` entries.
+ * @param[out] buffer_sizes Receives the number of bytes used in every buffer.
+ *     Must hold an entry for every `buffer_index` of `tensors`.
+ * @param[in] scratch Temporary storage for `2 * tensors.size()` entries.
+ *
+ * @retval Error::Ok on success.
+ * @retval Error::InvalidArgument if a span is too small or `alignment` is not
+ *     a power of 2.
+ */
+ET_NODISCARD Error plan_greedy_by_size(
+    Span<const PlannedTensorInfo> tensors,
+    size_t alignment,
+    Span<size_t> offsets,
+    Span<size_t> buffer_sizes,
+    Span<size_t> scratch);
+
+/// Configuration of a RuntimeMemoryPlanner.
+struct MemoryPlannerConfig {
+  /// Dynamic input dimensions are rounded up to a multiple of this value to
+  /// form the shape bucket that a plan is made for. 0 rounds them up to the
+  /// next power of two. Buckets never exceed the upper bounds of the inputs.
+  int32_t bucket_granularity = 0;
+
+  /// Maximum number of plans to keep. When full, the least recently used plan
+  /// is replaced.
+  size_t max_cached_plans = 8;
+
+  /// Alignment of every tensor in the re-planned buffers.
+  size_t alignment = 16;
+
+  /// Whether a method that holds persistent state (e.g. a KV cache in a
+  /// mutable buffer) may be calibrated. Calibration executes the method, which
+  /// updates that state.
+  bool allow_calibration_with_state = false;
+};
+
+/**
+ * EXPERIMENTAL: Re-plans the memory-planned tensors of a Method for the shapes
+ * of its actual inputs.
+ *
+ * The memory plan of a .pte file is made for the upper bounds of dynamic
+ * shapes, so every execution touches memory for the largest input. For each
+ * shape bucket, this planner executes the method once on zero-filled inputs
+ * at the bucket's upper bound (a "calibration"), measures the size of every
+ * planned tensor, and packs them with plan_greedy_by_size() into the lowest
+ * addresses of the same planned buffers. Tensors that share memory in the
+ * export-time plan, such as a view and its base, are placed as one block.
+ * Plans are cached per bucket, and prepare() moves the tensors to the plan of
+ * the bucket of the next inputs.
+ *
+ * This lowers the resident memory of executions with small inputs when the
+ * planned buffers are committed lazily (e.g. allocated with mmap). It assumes
+ * that tensor sizes do not shrink when an input dimension grows, which holds
+ * for shapes that are computed from the input shapes, but not for shapes that
+ * depend on input values (e.g. the output of nonzero).
+ *
+ * Not supported in ATen mode, for methods that contain control flow, or for
+ * calibration of methods whose inputs or outputs are not memory-planned.
+ *
+ * Usage:
+ * @code
+ *   RuntimeMemoryPlanner planner =
+ *       RuntimeMemoryPlanner::create(&method, &allocator).get();
+ *   ...
+ *   ET_CHECK_OK_OR_RETURN_ERROR(planner.prepare(inputs));
+ *   ET_CHECK_OK_OR_RETURN_ERROR(method.set_inputs(inputs));
+ *   ET_CHECK_OK_OR_RETURN_ERROR(method.execute());
+ * @endcode
+ */
+class RuntimeMemoryPlanner final {
+ public:
+  /**
+   * Creates a planner for `method`.
+   *
+   * @param[in] method The method to re-plan. Must outlive the planner, and
+   *     must only be re-planned by this planner.
+   * @param[in] allocator Allocator for the tensor lifetimes and the plan
+   *     cache. Must outlive the planner.
+   * @param[in] config The planner configuration.
+   */
+  ET_NODISCARD static Result<RuntimeMemoryPlanner> create(
+      Method* method,
+      MemoryAllocator* allocator,
+      const MemoryPlannerConfig& config = MemoryPlannerConfig());
+
+  /**
+   * Moves the planned tensors of the method to the plan of the bucket of
+   * `inputs`, calibrating it first if it is not cached. Must be called before
+   * set_input(), since the data of planned inputs moves, and not while the
+   * method is executing.
+   *
+   * @param[in] inputs The inputs that the method will be executed with, in
+   *     the order of set_inputs(). Only the sizes of tensors are used.
+   */
+  ET_NODISCARD Error prepare(executorch::aten::ArrayRef<EValue> inputs);
+
+  /// Moves the planned tensors back to the plan made during export.
+  ET_NODISCARD Error restore();
+
+  /// Bytes of `buffer_index` that the current plan uses.
+  size_t planned_buffer_size(size_t buffer_index) const;
+
+  size_t num_cached_plans() const;
+
+  size_t num_calibrations() const {
+    return num_calibrations_;
+  }
+
+ private:
+  struct CachedPlan {
+    // Upper bound of every input dimension in the bucket.
+    int32_t* bucket;
+    size_t* offsets;
+    size_t* buffer_sizes;
+    uint64_t last_used;
+    bool valid;
+  };
+
+  RuntimeMemoryPlanner(Method* method, const MemoryPlannerConfig& config)
+      : method_(method), config_(config) {}
+
+  Error compute_bucket(
+      executorch::aten::ArrayRef<EValue> inputs,
+      int32_t* bucket) const;
+  Error calibrate(const int32_t* bucket, CachedPlan* plan);
+  Error apply(const CachedPlan* plan);
+
+  Method* method_;
+  MemoryPlannerConfig config_;
+
+  // Planned tensors with their placement from the export-time plan.
+  PlannedTensorInfo* tensors_ = nullptr;
+  size_t num_tensors_ = 0;
+  // Tensors with their sizes measured during calibration.
+  PlannedTensorInfo* measured_ = nullptr;
+  size_t* export_offsets_ = nullptr;
+  // Index of the first tensor of the alias set of every tensor.
+  size_t* alias_of_ = nullptr;
+  size_t* scratch_ = nullptr;
+
+  Span<uint8_t>* buffers_ = nullptr;
+  size_t num_buffers_ = 0;
+
+  // Upper bound of every dimension of every tensor input, with the
+  // dimensions of input i starting at input_dims_begin_[i].
+  int32_t* upper_bounds_ = nullptr;
+  size_t* input_dims_begin_ = nullptr;
+  size_t num_inputs_ = 0;
+  size_t num_dims_ = 0;
+  int32_t* bucket_ = nullptr;
+  bool* saved_input_set_ = nullptr;
+
+  CachedPlan* plans_ = nullptr;
+  // Plan the tensors are placed with, or nullptr for the export-time plan.
+  const CachedPlan* current_ = nullptr;
+  uint64_t clock_ = 0;
+  size_t num_calibrations_ = 0;
+};
+
+} // namespace ET_RUNTIME_NAMESPACE
+} // namespace executorch
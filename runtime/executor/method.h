@@ -44,6 +44,7 @@ struct NamedData;
 
 // Forward declare Program to avoid a circular reference.
 class Program;
+class RuntimeMemoryPlanner;
 
 // Forward declare internal types.
 class BackendDelegate;
@@ -314,6 +315,8 @@ class Method final {
   friend class Program;
   // Let Executor call the ctor and init().
   friend class Executor;
+  // Let RuntimeMemoryPlanner move the memory-planned tensors.
+  friend class RuntimeMemoryPlanner;
 
   enum class InitializationState : uint8_t {
     Uninitialized,
@@ -6,6 +6,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <cinttypes>
+
 #include <c10/util/safe_numerics.h>
 #include <executorch/runtime/core/error.h>
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
@@ -376,5 +378,196 @@ size_t MethodMeta::num_instructions() const {
   }
   return num_instructions;
 }
+
+namespace {
+
+using EValueVector =
+    flatbuffers::Vector<flatbuffers::Offset<executorch_flatbuffer::EValue>>;
+
+const executorch_flatbuffer::AllocationDetails* get_allocation_info(
+    const executorch_flatbuffer::EValue* value) {
+  if (value == nullptr ||
+      value->val_type() != executorch_flatbuffer::KernelTypes::Tensor) {
+    return nullptr;
+  }
+  return value->val_as_Tensor()->allocation_info();
+}
+
+// Extends the lifetime of the planned tensor at `value_index`, or of every
+// planned tensor of the tensor list at `value_index`, to cover `instruction`.
+void mark_use(
+    const EValueVector* values,
+    Span<PlannedTensorInfo> infos,
+    int32_t value_index,
+    int64_t instruction) {
+  if (value_index < 0 || static_cast<size_t>(value_index) >= values->size()) {
+    return;
+  }
+  const auto* value = values->Get(value_index);
+  const flatbuffers::Vector<int32_t>* items = nullptr;
+  if (value->val_type() == executorch_flatbuffer::KernelTypes::TensorList) {
+    items = value->val_as_TensorList()->items();
+  } else if (
+      value->val_type() ==
+      executorch_flatbuffer::KernelTypes::OptionalTensorList) {
+    items = value->val_as_OptionalTensorList()->items();
+  }
+  if (items != nullptr) {
+    for (size_t i = 0; i < items->size(); ++i) {
+      // Tensor lists only hold tensors, so this does not recurse further.
+      mark_use(values, infos, items->Get(i), instruction);
+    }
+    return;
+  }
+  if (get_allocation_info(value) == nullptr) {
+    return;
+  }
+  // `infos` is sorted by value index.
+  size_t lo = 0;
+  size_t hi = infos.size();
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (infos[mid].value_index < static_cast<size_t>(value_index)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == infos.size() ||
+      infos[lo].value_index != static_cast<size_t>(value_index)) {
+    return;
+  }
+  PlannedTensorInfo& info = infos[lo];
+  if (info.first_use == -1 || instruction < info.first_use) {
+    info.first_use = instruction;
+  }
+  if (instruction > info.last_use) {
+    info.last_use = instruction;
+  }
+}
+
+} // namespace
+
+size_t MethodMeta::num_planned_tensors() const {
+  const auto values = s_plan_->values();
+  if (values == nullptr) {
+    return 0;
+  }
+  size_t count = 0;
+  for (size_t i = 0; i < values->size(); ++i) {
+    if (get_allocation_info(values->Get(i)) != nullptr) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+Result<size_t> MethodMeta::planned_tensor_infos(
+    Span<PlannedTensorInfo> infos) const {
+  const auto values = s_plan_->values();
+  if (values == nullptr) {
+    return 0;
+  }
+  const size_t num_buffers = num_memory_planned_buffers();
+  size_t count = 0;
+  for (size_t i = 0; i < values->size(); ++i) {
+    const auto* value = values->Get(i);
+    const auto* allocation_info = get_allocation_info(value);
+    if (allocation_info == nullptr) {
+      continue;
+    }
+    ET_CHECK_OR_RETURN_ERROR(
+        count < infos.size(),
+        InvalidArgument,
+        "infos holds %zu entries, but the method has more planned tensors",
+        infos.size());
+    const auto* tensor = value->val_as_Tensor();
+    ET_CHECK_OR_RETURN_ERROR(
+        tensor->sizes() != nullptr,
+        InvalidProgram,
+        "Missing sizes of tensor at value %zu",
+        i);
+    ET_CHECK_OR_RETURN_ERROR(
+        allocation_info->memory_id() >= 1 &&
+            allocation_info->memory_id() <= num_buffers,
+        InvalidProgram,
+        "Invalid memory_id %" PRIu32 " of tensor at value %zu",
+        allocation_info->memory_id(),
+        i);
+    Result<size_t> nbytes = calculate_nbytes(
+        Span<const int32_t>(tensor->sizes()->data(), tensor->sizes()->size()),
+        static_cast<executorch::aten::ScalarType>(tensor->scalar_type()));
+    ET_CHECK_OK_OR_RETURN_ERROR(nbytes.error());
+
+    PlannedTensorInfo& info = infos[count++];
+    info.value_index = i;
+    // Memory id zero is reserved, see memory_planned_buffer_size().
+    info.buffer_index = allocation_info->memory_id() - 1;
+    info.offset = static_cast<size_t>(
+        static_cast<uint64_t>(allocation_info->memory_offset_high()) << 32 |
+        allocation_info->memory_offset_low());
+    info.nbytes = nbytes.get();
+    info.first_use = -1;
+    info.last_use = -1;
+    info.is_persistent = tensor->data_buffer_idx() > 0 ||
+        (tensor->extra_tensor_info() != nullptr &&
+         tensor->extra_tensor_info()->location() ==
+             executorch_flatbuffer::TensorDataLocation::EXTERNAL);
+  }
+  Span<PlannedTensorInfo> planned(infos.data(), count);
+
+  int64_t instruction = 0;
+  const auto chains = s_plan_->chains();
+  for (size_t c = 0; chains != nullptr && c < chains->size(); ++c) {
+    const auto* chain = chains->Get(c);
+    if (chain == nullptr || chain->instructions() == nullptr) {
+      continue;
+    }
+    const auto* instructions = chain->instructions();
+    for (size_t i = 0; i < instructions->size(); ++i, ++instruction) {
+      const auto* instr = instructions->Get(i);
+      const flatbuffers::Vector<int32_t>* args = nullptr;
+      switch (instr->instr_args_type()) {
+        case executorch_flatbuffer::InstructionArguments::KernelCall:
+          args = instr->instr_args_as_KernelCall()->args();
+          break;
+        case executorch_flatbuffer::InstructionArguments::DelegateCall:
+          args = instr->instr_args_as_DelegateCall()->args();
+          break;
+        case executorch_flatbuffer::InstructionArguments::MoveCall: {
+          const auto* move_call = instr->instr_args_as_MoveCall();
+          mark_use(values, planned, move_call->move_from(), instruction);
+          mark_use(values, planned, move_call->move_to(), instruction);
+        } break;
+        case executorch_flatbuffer::InstructionArguments::FreeCall:
+          mark_use(
+              values,
+              planned,
+              instr->instr_args_as_FreeCall()->value_index(),
+              instruction);
+          break;
+        default:
+          break;
+      }
+      for (size_t a = 0; args != nullptr && a < args->size(); ++a) {
+        mark_use(values, planned, args->Get(a), instruction);
+      }
+    }
+  }
+
+  // Inputs must be live before the first instruction runs and outputs after
+  // the last one.
+  if (instruction > 0) {
+    const auto inputs = s_plan_->inputs();
+    for (size_t i = 0; inputs != nullptr && i < inputs->size(); ++i) {
+      mark_use(values, planned, inputs->Get(i), 0);
+    }
+    const auto outputs = s_plan_->outputs();
+    for (size_t i = 0; outputs != nullptr && i < outputs->size(); ++i) {
+      mark_use(values, planned, outputs->Get(i), instruction - 1);
+    }
+  }
+  return count;
+}
 } // namespace ET_RUNTIME_NAMESPACE
 } // namespace executorch
@@ -132,6 +132,40 @@ class TensorInfo final {
   size_t nbytes_;
 };
 
+/**
+ * Placement and lifetime of a memory-planned tensor of a method, as decided by
+ * the memory planning pass during export. See
+ * MethodMeta::planned_tensor_infos().
+ */
+struct PlannedTensorInfo {
+  /// Index of the tensor in the values table of the method.
+  size_t value_index;
+
+  /// Index of the memory-planned buffer that holds the tensor, in the same
+  /// numbering as MethodMeta::memory_planned_buffer_size().
+  size_t buffer_index;
+
+  /// Offset in bytes of the tensor data in that buffer.
+  size_t offset;
+
+  /// Size in bytes reserved for the tensor. For dynamically shaped tensors
+  /// this is the size at their upper bound shape.
+  size_t nbytes;
+
+  /// Indices of the first and the last instruction that use the tensor,
+  /// directly or through a tensor list. Instructions are counted across all
+  /// chains in order, as in MethodMeta::num_instructions(). Method inputs are
+  /// considered live from the first instruction and method outputs until the
+  /// last one. Both are -1 if the tensor is never used.
+  int64_t first_use;
+  int64_t last_use;
+
+  /// True if the tensor holds state that must survive across executions,
+  /// i.e. a mutable buffer initialized from the program or from external
+  /// data. Such a tensor must keep its memory to itself.
+  bool is_persistent;
+};
+
 /**
  * Describes a a method in an ExecuTorch program.
  *
@@ -265,6 +299,27 @@ class MethodMeta final {
    */
   ET_EXPERIMENTAL size_t num_instructions() const;
 
+  /**
+   * Get the number of memory-planned tensors in this method, i.e. tensors
+   * whose data lives at a fixed offset of one of the memory-planned buffers.
+   *
+   * @returns The number of memory-planned tensors.
+   */
+  ET_EXPERIMENTAL size_t num_planned_tensors() const;
+
+  /**
+   * Reconstructs the placement and lifetime of every memory-planned tensor
+   * from the program, in increasing order of value index. This walks all
+   * instructions of the method, so it is meant for tooling and diagnostics
+   * rather than for the hot path.
+   *
+   * @param[out] infos Storage for at least num_planned_tensors() entries.
+   * @returns The number of entries written on success, or an error if
+   * `infos` is too small or the program is malformed.
+   */
+  ET_EXPERIMENTAL Result<size_t> planned_tensor_infos(
+      Span<PlannedTensorInfo> infos) const;
+
   /**
    * DEPRECATED: Use num_memory_planned_buffers() instead.
    */
@@ -93,6 +93,7 @@ def define_common_targets():
                 "program_validation.h",
             ],
             exported_headers = [
+                "memory_planner.h",
                 "method.h",
                 "method_meta.h",
                 "program.h",
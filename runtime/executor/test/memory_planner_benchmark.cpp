@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Measures the resident memory of the planned buffers against the input
+// length, with the export-time memory plan and with RuntimeMemoryPlanner.
+// The planned buffers are fresh anonymous mappings, so only the pages that an
+// execution touches become resident; the `arena_resident_bytes` counter is
+// their peak over all iterations, as reported by mincore().
+//
+// Runs on the model at $ET_MODULE_DYNAMIC_MLP_PATH by default, or on the
+// model at $ET_MEMORY_PLANNER_BENCHMARK_MODEL, whose first input must be a
+// tensor with a dynamic leading dimension.
+
+#include <benchmark/benchmark.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/runtime/executor/memory_planner.h>
+#include <executorch/runtime/executor/program.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using executorch::aten::ArrayRef;
+using executorch::aten::Tensor;
+using executorch::aten::TensorImpl;
+using executorch::extension::FileDataLoader;
+using executorch::runtime::Error;
+using executorch::runtime::EValue;
+using executorch::runtime::HierarchicalAllocator;
+using executorch::runtime::MemoryAllocator;
+using executorch::runtime::MemoryManager;
+using executorch::runtime::Method;
+using executorch::runtime::MethodMeta;
+using executorch::runtime::Program;
+using executorch::runtime::Result;
+using executorch::runtime::RuntimeMemoryPlanner;
+using executorch::runtime::Span;
+using executorch::runtime::TensorInfo;
+
+namespace {
+
+constexpr size_t kMethodMemBytes = 1024 * 1024U;
+constexpr size_t kPlannerMemBytes = 256 * 1024U;
+
+const char* model_path() {
+  const char* path = std::getenv("ET_MEMORY_PLANNER_BENCHMARK_MODEL");
+  return path != nullptr ? path : std::getenv("ET_MODULE_DYNAMIC_MLP_PATH");
+}
+
+// An anonymous mapping, whose pages are only committed when touched.
+class LazyBuffer {
+ public:
+  explicit LazyBuffer(size_t size) : size_(size) {
+    void* data = mmap(
+        nullptr,
+        size_,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0);
+    data_ = data != MAP_FAILED ? static_cast<uint8_t*>(data) : nullptr;
+  }
+
+  ~LazyBuffer() {
+    if (data_ != nullptr) {
+      munmap(data_, size_);
+    }
+  }
+
+  LazyBuffer(const LazyBuffer&) = delete;
+  LazyBuffer& operator=(const LazyBuffer&) = delete;
+
+  uint8_t* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  // Returns the pages to the system; the next access sees zeros.
+  void release() {
+    if (data_ != nullptr) {
+      madvise(data_, size_, MADV_DONTNEED);
+    }
+  }
+
+  size_t resident_bytes() const {
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    std::vector<unsigned char> pages((size_ + page_size - 1) / page_size);
+    if (data_ == nullptr || mincore(data_, size_, pages.data()) != 0) {
+      return 0;
+    }
+    size_t resident = 0;
+    for (unsigned char page : pages) {
+      resident += (page & 1) ? page_size : 0;
+    }
+    return resident;
+  }
+
+ private:
+  uint8_t* data_;
+  size_t size_;
+};
+
+// A float input of `length` rows, with the other dimensions at their upper
+// bound in `info`.
+class Input {
+ public:
+  Input(const TensorInfo& info, int32_t length)
+      : sizes_(info.sizes().begin(), info.sizes().end()),
+        dim_order_(info.dim_order().begin(), info.dim_order().end()),
+        strides_(sizes_.size()) {
+    sizes_[0] = length;
+    size_t numel = 1;
+    for (size_t d = sizes_.size(); d > 0; --d) {
+      strides_[d - 1] = static_cast<int32_t>(numel);
+      numel *= sizes_[d - 1];
+    }
+    data_.assign(numel, 0.5f);
+    impl_ = std::make_unique<TensorImpl>(
+        info.scalar_type(),
+        static_cast<ssize_t>(sizes_.size()),
+        sizes_.data(),
+        data_.data(),
+        dim_order_.data(),
+        strides_.data());
+  }
+
+  EValue value() {
+    return EValue(Tensor(impl_.get()));
+  }
+
+ private:
+  std::vector<int32_t> sizes_;
+  std::vector<uint8_t> dim_order_;
+  std::vector<int32_t> strides_;
+  std::vector<float> data_;
+  std::unique_ptr<TensorImpl> impl_;
+};
+
+void run(benchmark::State& state, bool replan) {
+  const int32_t length = static_cast<int32_t>(state.range(0));
+  Result<FileDataLoader> loader = FileDataLoader::from(model_path());
+  if (!loader.ok()) {
+    state.SkipWithError("Failed to open the model");
+    return;
+  }
+  Result<Program> program = Program::load(&loader.get());
+  if (!program.ok()) {
+    state.SkipWithError("Failed to load the program");
+    return;
+  }
+  Result<MethodMeta> meta = program->method_meta("forward");
+  if (!meta.ok() || meta->num_inputs() == 0 ||
+      !meta->input_tensor_meta(0).ok() ||
+      meta->input_tensor_meta(0)->scalar_type() !=
+          executorch::aten::ScalarType::Float) {
+    state.SkipWithError("The first input must be a float tensor");
+    return;
+  }
+
+  std::vector<std::unique_ptr<LazyBuffer>> buffers;
+  std::vector<Span<uint8_t>> spans;
+  for (size_t b = 0; b < meta->num_memory_planned_buffers(); ++b) {
+    buffers.push_back(std::make_unique<LazyBuffer>(
+        static_cast<size_t>(meta->memory_planned_buffer_size(b).get())));
+    spans.emplace_back(buffers.back()->data(), buffers.back()->size());
+  }
+  HierarchicalAllocator planned_memory({spans.data(), spans.size()});
+  std::vector<uint8_t> method_pool(kMethodMemBytes);
+  MemoryAllocator method_allocator(kMethodMemBytes, method_pool.data());
+  MemoryManager memory_manager(&method_allocator, &planned_memory);
+  Result<Method> method = program->load_method("forward", &memory_manager);
+  if (!method.ok()) {
+    state.SkipWithError("Failed to load the method");
+    return;
+  }
+
+  std::vector<uint8_t> planner_pool(kPlannerMemBytes);
+  MemoryAllocator planner_allocator(kPlannerMemBytes, planner_pool.data());
+  Result<RuntimeMemoryPlanner> planner =
+      RuntimeMemoryPlanner::create(&method.get(), &planner_allocator);
+  if (!planner.ok()) {
+    state.SkipWithError("Failed to create the planner");
+    return;
+  }
+
+  Input input(meta->input_tensor_meta(0).get(), length);
+  EValue inputs[1] = {input.value()};
+  if (replan) {
+    // Calibrate outside of the measurement, and drop the pages that the
+    // calibration touched. Only the first input is varied, so this only
+    // supports single-input methods.
+    if (planner->prepare(ArrayRef<EValue>(inputs, 1)) != Error::Ok) {
+      state.SkipWithError("Failed to re-plan the method");
+      return;
+    }
+    for (auto& buffer : buffers) {
+      buffer->release();
+    }
+  }
+  for (auto _ : state) {
+    if (replan) {
+      (void)planner->prepare(ArrayRef<EValue>(inputs, 1));
+    }
+    if (method->set_input(inputs[0], 0) != Error::Ok ||
+        method->execute() != Error::Ok) {
+      state.SkipWithError("Failed to execute the method");
+      return;
+    }
+  }
+
+  size_t resident = 0;
+  size_t planned = 0;
+  for (size_t b = 0; b < buffers.size(); ++b) {
+    resident += buffers[b]->resident_bytes();
+    planned += planner->planned_buffer_size(b);
+  }
+  state.counters["arena_resident_bytes"] = resident;
+  state.counters["arena_planned_bytes"] = planned;
+  state.counters["calibrations"] = planner->num_calibrations();
+}
+
+void BM_ExportPlan(benchmark::State& state) {
+  run(state, /*replan=*/false);
+}
+
+void BM_RuntimePlan(benchmark::State& state) {
+  run(state, /*replan=*/true);
+}
+
+BENCHMARK(BM_ExportPlan)->RangeMultiplier(4)->Range(1, 128);
+BENCHMARK(BM_RuntimePlan)->RangeMultiplier(4)->Range(1, 128);
+
+// Make sure the PAL is initialized before the first tick is read.
+const bool runtime_initialized = [] {
+  executorch::runtime::runtime_init();
+  return true;
+}();
+
+} // namespace
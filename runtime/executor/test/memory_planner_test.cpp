@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/runtime/executor/memory_planner.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/runtime/executor/program.h>
+#include <executorch/runtime/executor/test/managed_memory_manager.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using executorch::aten::ArrayRef;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::aten::TensorImpl;
+using executorch::extension::FileDataLoader;
+using executorch::runtime::Error;
+using executorch::runtime::EValue;
+using executorch::runtime::MemoryAllocator;
+using executorch::runtime::MemoryPlannerConfig;
+using executorch::runtime::Method;
+using executorch::runtime::plan_greedy_by_size;
+using executorch::runtime::PlannedTensorInfo;
+using executorch::runtime::Program;
+using executorch::runtime::Result;
+using executorch::runtime::RuntimeMemoryPlanner;
+using executorch::runtime::Span;
+using executorch::runtime::testing::ManagedMemoryManager;
+
+namespace {
+
+constexpr size_t kPlannedMemBytes = 256 * 1024U;
+constexpr size_t kMethodMemBytes = 32 * 1024U;
+constexpr size_t kPlannerMemBytes = 32 * 1024U;
+
+PlannedTensorInfo make_tensor(
+    size_t buffer_index,
+    size_t offset,
+    size_t nbytes,
+    int64_t first_use,
+    int64_t last_use,
+    bool is_persistent = false) {
+  PlannedTensorInfo info;
+  info.value_index = 0;
+  info.buffer_index = buffer_index;
+  info.offset = offset;
+  info.nbytes = nbytes;
+  info.first_use = first_use;
+  info.last_use = last_use;
+  info.is_persistent = is_persistent;
+  return info;
+}
+
+Error plan(
+    const std::vector<PlannedTensorInfo>& tensors,
+    size_t alignment,
+    std::vector<size_t>& offsets,
+    std::vector<size_t>& buffer_sizes) {
+  offsets.assign(tensors.size(), 0);
+  std::vector<size_t> scratch(2 * tensors.size());
+  return plan_greedy_by_size(
+      Span<const PlannedTensorInfo>(tensors.data(), tensors.size()),
+      alignment,
+      Span<size_t>(offsets.data(), offsets.size()),
+      Span<size_t>(buffer_sizes.data(), buffer_sizes.size()),
+      Span<size_t>(scratch.data(), scratch.size()));
+}
+
+// A 2D float input of the dynamic MLP, which maps [seq_len, 16] to
+// [seq_len, 16].
+class MlpInput {
+ public:
+  explicit MlpInput(int32_t seq_len)
+      : sizes_{seq_len, 16},
+        data_(seq_len * 16),
+        impl_(
+            ScalarType::Float,
+            2,
+            sizes_,
+            data_.data(),
+            dim_order_,
+            strides_) {
+    for (size_t i = 0; i < data_.size(); ++i) {
+      data_[i] = static_cast<float>(i % 7) * 0.25f - 0.5f;
+    }
+  }
+
+  EValue value() {
+    return EValue(Tensor(&impl_));
+  }
+
+ private:
+  int32_t sizes_[2];
+  uint8_t dim_order_[2] = {0, 1};
+  int32_t strides_[2] = {16, 1};
+  std::vector<float> data_;
+  TensorImpl impl_;
+};
+
+} // namespace
+
+class PlanGreedyBySizeTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+  }
+};
+
+TEST_F(PlanGreedyBySizeTest, ReusesMemoryOfDisjointLifetimes) {
+  // a and c are never live together, so c goes where a was.
+  std::vector<PlannedTensorInfo> tensors = {
+      make_tensor(0, 0, 64, 0, 1),
+      make_tensor(0, 64, 32, 1, 2),
+      make_tensor(0, 96, 48, 2, 3),
+  };
+  std::vector<size_t> offsets;
+  std::vector<size_t> buffer_sizes(1);
+  ASSERT_EQ(plan(tensors, 16, offsets, buffer_sizes), Error::Ok);
+
+  EXPECT_EQ(offsets[0], 0);
+  EXPECT_EQ(offsets[1], 64);
+  EXPECT_EQ(offsets[2], 0);
+  EXPECT_EQ(buffer_sizes[0], 96);
+}
+
+TEST_F(PlanGreedyBySizeTest, AlignsOffsets) {
+  std::vector<PlannedTensorInfo> tensors = {
+      make_tensor(0, 0, 20, 0, 0),
+      make_tensor(0, 0, 12, 0, 0),
+  };
+  std::vector<size_t> offsets;
+  std::vector<size_t> buffer_sizes(1);
+  ASSERT_EQ(plan(tensors, 32, offsets, buffer_sizes), Error::Ok);
+
+  EXPECT_EQ(offsets[0], 0);
+  EXPECT_EQ(offsets[1], 32);
+  EXPECT_EQ(buffer_sizes[0], 44);
+}
+
+TEST_F(PlanGreedyBySizeTest, FillsGapsBetweenLiveTensors) {
+  // The state stays at 64, and b and c both fit in the gap below it.
+  std::vector<PlannedTensorInfo> tensors = {
+      make_tensor(0, 64, 16, 0, 0, /*is_persistent=*/true),
+      make_tensor(0, 0, 32, 0, 1),
+      make_tensor(0, 0, 32, 1, 1),
+  };
+  std::vector<size_t> offsets;
+  std::vector<size_t> buffer_sizes(1);
+  ASSERT_EQ(plan(tensors, 16, offsets, buffer_sizes), Error::Ok);
+
+  EXPECT_EQ(offsets[0], 64);
+  EXPECT_EQ(offsets[1], 0);
+  EXPECT_EQ(offsets[2], 32);
+  EXPECT_EQ(buffer_sizes[0], 80);
+}
+
+TEST_F(PlanGreedyBySizeTest, PersistentTensorsAreAlwaysLive) {
+  std::vector<PlannedTensorInfo> tensors = {
+      make_tensor(0, 0, 16, -1, -1, /*is_persistent=*/true),
+      make_tensor(0, 0, 16, 3, 3),
+      make_tensor(1, 0, 16, -1, -1),
+  };
+  std::vector<size_t> offsets;
+  std::vector<size_t> buffer_sizes(2);
+  ASSERT_EQ(plan(tensors, 16, offsets, buffer_sizes), Error::Ok);
+
+  EXPECT_EQ(offsets[0], 0);
+  EXPECT_EQ(offsets[1], 16);
+  // Unused tensors take no memory.
+  EXPECT_EQ(offsets[2], 0);
+  EXPECT_EQ(buffer_sizes[0], 32);
+  EXPECT_EQ(buffer_sizes[1], 0);
+}
+
+TEST_F(PlanGreedyBySizeTest, RejectsInvalidArguments) {
+  std::vector<PlannedTensorInfo> tensors = {make_tensor(1, 0, 16, 0, 0)};
+  std::vector<size_t> offsets;
+  std::vector<size_t> one_buffer(1);
+  std::vector<size_t> two_buffers(2);
+
+  // Unknown buffer.
+  EXPECT_EQ(plan(tensors, 16, offsets, one_buffer), Error::InvalidArgument);
+  // Alignment is not a power of 2.
+  EXPECT_EQ(plan(tensors, 24, offsets, two_buffers), Error::InvalidArgument);
+  EXPECT_EQ(plan(tensors, 0, offsets, two_buffers), Error::InvalidArgument);
+
+  // Too small scratch.
+  size_t offset = 0;
+  size_t scratch = 0;
+  EXPECT_EQ(
+      plan_greedy_by_size(
+          Span<const PlannedTensorInfo>(tensors.data(), tensors.size()),
+          16,
+          Span<size_t>(&offset, 1),
+          Span<size_t>(two_buffers.data(), two_buffers.size()),
+          Span<size_t>(&scratch, 1)),
+      Error::InvalidArgument);
+}
+
+class RuntimeMemoryPlannerTest : public ::testing::Test {
+ protected:
+  void load_program(const char* path, const char* module_name) {
+    Result<FileDataLoader> loader = FileDataLoader::from(path);
+    ASSERT_EQ(loader.error(), Error::Ok);
+    loaders_.insert(
+        {module_name,
+         std::make_unique<FileDataLoader>(std::move(loader.get()))});
+
+    Result<Program> program = Program::load(
+        loaders_[module_name].get(),
+        Program::Verification::InternalConsistency);
+    ASSERT_EQ(program.error(), Error::Ok);
+    programs_.insert(
+        {module_name, std::make_unique<Program>(std::move(program.get()))});
+  }
+
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+
+    load_program(std::getenv("ET_MODULE_ADD_PATH"), "add");
+    load_program(std::getenv("ET_MODULE_DYNAMIC_MLP_PATH"), "mlp");
+    load_program(std::getenv("ET_MODULE_DYNAMIC_VIEW_PATH"), "view");
+  }
+
+  // Runs the MLP on `input` and returns a copy of its output.
+  std::vector<float> run_mlp(
+      Method& method,
+      RuntimeMemoryPlanner* planner,
+      MlpInput& input) {
+    EValue inputs[1] = {input.value()};
+    if (planner != nullptr) {
+      Error err = planner->prepare(ArrayRef<EValue>(inputs, 1));
+      EXPECT_EQ(err, Error::Ok);
+    }
+    EXPECT_EQ(method.set_input(inputs[0], 0), Error::Ok);
+    EXPECT_EQ(method.execute(), Error::Ok);
+    const Tensor out = method.get_output(0).toTensor();
+    return std::vector<float>(
+        out.const_data_ptr<float>(), out.const_data_ptr<float>() + out.numel());
+  }
+
+ private:
+  std::unordered_map<std::string, std::unique_ptr<FileDataLoader>> loaders_;
+
+ protected:
+  std::unordered_map<std::string, std::unique_ptr<Program>> programs_;
+  std::unique_ptr<uint8_t[]> planner_pool_{new uint8_t[kPlannerMemBytes]};
+  MemoryAllocator planner_allocator_{kPlannerMemBytes, planner_pool_.get()};
+};
+
+TEST_F(RuntimeMemoryPlannerTest, StaticShapesCalibrateOnce) {
+  ManagedMemoryManager mmm(kPlannedMemBytes, kMethodMemBytes);
+  Result<Method> method = programs_["add"]->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+
+  Result<RuntimeMemoryPlanner> planner =
+      RuntimeMemoryPlanner::create(&method.get(), &planner_allocator_);
+  ASSERT_EQ(planner.error(), Error::Ok);
+  const size_t export_size = planner->planned_buffer_size(0);
+
+  float x_data[4] = {1.f, 2.f, 3.f, 4.f};
+  float y_data[4] = {10.f, 20.f, 30.f, 40.f};
+  int32_t sizes[2] = {2, 2};
+  uint8_t dim_order[2] = {0, 1};
+  int32_t strides[2] = {2, 1};
+  TensorImpl x(ScalarType::Float, 2, sizes, x_data, dim_order, strides);
+  TensorImpl y(ScalarType::Float, 2, sizes, y_data, dim_order, strides);
+  EValue inputs[3] = {EValue(Tensor(&x)), EValue(Tensor(&y)), EValue(1.0)};
+
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(planner->prepare(ArrayRef<EValue>(inputs, 3)), Error::Ok);
+    for (size_t j = 0; j < 3; ++j) {
+      ASSERT_EQ(method->set_input(inputs[j], j), Error::Ok);
+    }
+    ASSERT_EQ(method->execute(), Error::Ok);
+
+    const float* out = method->get_output(0).toTensor().const_data_ptr<float>();
+    // ModuleAdd computes x + alpha * y.
+    for (size_t k = 0; k < 4; ++k) {
+      EXPECT_FLOAT_EQ(out[k], x_data[k] + y_data[k]);
+    }
+  }
+  EXPECT_EQ(planner->num_calibrations(), 1);
+  EXPECT_EQ(planner->num_cached_plans(), 1);
+  EXPECT_LE(planner->planned_buffer_size(0), export_size);
+}
+
+TEST_F(RuntimeMemoryPlannerTest, PrepareRequiresInputsAgain) {
+  ManagedMemoryManager mmm(kPlannedMemBytes, kMethodMemBytes);
+  Result<Method> method = programs_["mlp"]->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+  Result<RuntimeMemoryPlanner> planner =
+      RuntimeMemoryPlanner::create(&method.get(), &planner_allocator_);
+  ASSERT_EQ(planner.error(), Error::Ok);
+
+  MlpInput input(8);
+  EValue inputs[1] = {input.value()};
+  ASSERT_EQ(method->set_input(inputs[0], 0), Error::Ok);
+  ASSERT_EQ(planner->prepare(ArrayRef<EValue>(inputs, 1)), Error::Ok);
+  // The input moved with the plan, so it has to be set again.
+  EXPECT_EQ(method->execute(), Error::InvalidArgument);
+}
+
+TEST_F(RuntimeMemoryPlannerTest, SmallInputsUseLessMemory) {
+  ManagedMemoryManager mmm(kPlannedMemBytes, kMethodMemBytes);
+  Result<Method> method = programs_["mlp"]->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+  Result<RuntimeMemoryPlanner> planner =
+      RuntimeMemoryPlanner::create(&method.get(), &planner_allocator_);
+  ASSERT_EQ(planner.error(), Error::Ok);
+  const size_t export_size = planner->planned_buffer_size(0);
+
+  MlpInput short_input(5);
+  const std::vector<float> expected =
+      run_mlp(method.get(), /*planner=*/nullptr, short_input);
+  ASSERT_EQ(expected.size(), 5 * 16);
+
+  const std::vector<float> actual =
+      run_mlp(method.get(), &planner.get(), short_input);
+  EXPECT_EQ(actual, expected);
+  // 5 rounds up to a bucket of 8 rows out of 128.
+  EXPECT_LT(planner->planned_buffer_size(0) * 8, export_size);
+
+  // Back on the export-time plan, the results do not change.
+  ASSERT_EQ(planner->restore(), Error::Ok);
+  EXPECT_EQ(planner->planned_buffer_size(0), export_size);
+  EXPECT_EQ(run_mlp(method.get(), nullptr, short_input), expected);
+}
+
+TEST_F(RuntimeMemoryPlannerTest, ViewsKeepTheMemoryOfTheirBase) {
+  // The view model maps [seq_len, 16] to a [4 * seq_len, 16] view of a linear
+  // layer, which is used after its base is dead.
+  ManagedMemoryManager mmm(kPlannedMemBytes, kMethodMemBytes);
+  Result<Method> method = programs_["view"]->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+  Result<RuntimeMemoryPlanner> planner =
+      RuntimeMemoryPlanner::create(&method.get(), &planner_allocator_);
+  ASSERT_EQ(planner.error(), Error::Ok);
+
+  MlpInput input(5);
+  const std::vector<float> expected =
+      run_mlp(method.get(), /*planner=*/nullptr, input);
+  ASSERT_EQ(expected.size(), 4 * 5 * 16);
+
+  // Nothing may be placed over the base while the view is live.
+  EXPECT_EQ(run_mlp(method.get(), &planner.get(), input), expected);
+  EXPECT_EQ(run_mlp(method.get(), &planner.get(), input), expected);
+  EXPECT_EQ(planner->num_calibrations(), 1);
+}
+
+TEST_F(RuntimeMemoryPlannerTest, CachesPlansPerBucket) {
+  ManagedMemoryManager mmm(kPlannedMemBytes, kMethodMemBytes);
+  Result<Method> method = programs_["mlp"]->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+  MemoryPlannerConfig config;
+  config.bucket_granularity = 32;
+  config.max_cached_plans = 2;
+  Result<RuntimeMemoryPlanner> planner =
+      RuntimeMemoryPlanner::create(&method.get(), &planner_allocator_, config);
+  ASSERT_EQ(planner.error(), Error::Ok);
+
+  MlpInput len_3(3);
+  MlpInput len_30(30);
+  MlpInput len_40(40);
+  MlpInput len_100(100);
+
+  run_mlp(method.get(), &planner.get(), len_3);
+  const size_t small_size = planner->planned_buffer_size(0);
+  run_mlp(method.get(), &planner.get(), len_30);
+  EXPECT_EQ(planner->num_calibrations(), 1);
+  EXPECT_EQ(planner->planned_buffer_size(0), small_size);
+
+  run_mlp(method.get(), &planner.get(), len_40);
+  EXPECT_EQ(planner->num_calibrations(), 2);
+  EXPECT_GT(planner->planned_buffer_size(0), small_size);
+  EXPECT_EQ(planner->num_cached_plans(), 2);
+
+  // Touch the bucket of 32 so that the bucket of 64 is the one evicted.
+  run_mlp(method.get(), &planner.get(), len_30);
+  run_mlp(method.get(), &planner.get(), len_100);
+  EXPECT_EQ(planner->num_calibrations(), 3);
+  run_mlp(method.get(), &planner.get(), len_3);
+  EXPECT_EQ(planner->num_calibrations(), 3);
+  run_mlp(method.get(), &planner.get(), len_40);
+  EXPECT_EQ(planner->num_calibrations(), 4);
+  EXPECT_EQ(planner->num_cached_plans(), 2);
+
+  // Every plan computes the same rows as the export-time plan.
+  ASSERT_EQ(planner->restore(), Error::Ok);
+  std::vector<float> expected = run_mlp(method.get(), nullptr, len_40);
+  EXPECT_EQ(run_mlp(method.get(), &planner.get(), len_40), expected);
+}
+
+TEST_F(RuntimeMemoryPlannerTest, RejectsInvalidInputs) {
+  ManagedMemoryManager mmm(kPlannedMemBytes, kMethodMemBytes);
+  Result<Method> method = programs_["mlp"]->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+  Result<RuntimeMemoryPlanner> planner =
+      RuntimeMemoryPlanner::create(&method.get(), &planner_allocator_);
+  ASSERT_EQ(planner.error(), Error::Ok);
+
+  // Larger than the upper bound.
+  MlpInput too_long(129);
+  EValue inputs[2] = {too_long.value(), EValue(1.0)};
+  EXPECT_EQ(
+      planner->prepare(ArrayRef<EValue>(inputs, 1)), Error::InvalidArgument);
+  // Wrong number of inputs.
+  EXPECT_EQ(
+      planner->prepare(ArrayRef<EValue>(inputs, 2)), Error::InvalidArgument);
+  // Not a tensor.
+  EXPECT_EQ(
+      planner->prepare(ArrayRef<EValue>(inputs + 1, 1)),
+      Error::InvalidArgument);
+  EXPECT_EQ(planner->num_calibrations(), 0);
+
+  MemoryPlannerConfig bad_config;
+  bad_config.alignment = 12;
+  EXPECT_EQ(
+      RuntimeMemoryPlanner::create(
+          &method.get(), &planner_allocator_, bad_config)
+          .error(),
+      Error::InvalidArgument);
+  EXPECT_EQ(
+      RuntimeMemoryPlanner::create(nullptr, &planner_allocator_).error(),
+      Error::InvalidArgument);
+}
@@ -21,6 +21,7 @@
 using namespace ::testing;
 using executorch::runtime::Error;
 using executorch::runtime::MethodMeta;
+using executorch::runtime::PlannedTensorInfo;
 using executorch::runtime::Program;
 using executorch::runtime::Result;
 using executorch::runtime::Span;
@@ -137,6 +138,43 @@ TEST_F(MethodMetaTest, MethodMetaApi) {
       Error::InvalidArgument);
 }
 
+TEST_F(MethodMetaTest, PlannedTensorInfoApi) {
+  Result<MethodMeta> method_meta = programs_["add"]->method_meta("forward");
+  ASSERT_EQ(method_meta.error(), Error::Ok);
+
+  const size_t num_planned = method_meta->num_planned_tensors();
+  EXPECT_GT(num_planned, 0);
+  const int64_t num_instructions =
+      static_cast<int64_t>(method_meta->num_instructions());
+
+  std::vector<PlannedTensorInfo> infos(num_planned);
+  Result<size_t> count = method_meta->planned_tensor_infos(
+      Span<PlannedTensorInfo>(infos.data(), infos.size()));
+  ASSERT_EQ(count.error(), Error::Ok);
+  EXPECT_EQ(count.get(), num_planned);
+
+  for (size_t i = 0; i < num_planned; ++i) {
+    const PlannedTensorInfo& info = infos[i];
+    if (i > 0) {
+      EXPECT_LT(infos[i - 1].value_index, info.value_index);
+    }
+    ASSERT_LT(info.buffer_index, method_meta->num_memory_planned_buffers());
+    EXPECT_LE(
+        info.offset + info.nbytes,
+        method_meta->memory_planned_buffer_size(info.buffer_index).get());
+    // Every planned tensor of AddModule is an input, output or temporary of
+    // an add, so it is used by some instruction.
+    EXPECT_GE(info.first_use, 0);
+    EXPECT_LE(info.first_use, info.last_use);
+    EXPECT_LT(info.last_use, num_instructions);
+  }
+
+  // Too small output span fails
+  Result<size_t> too_small = method_meta->planned_tensor_infos(
+      Span<PlannedTensorInfo>(infos.data(), num_planned - 1));
+  EXPECT_EQ(too_small.error(), Error::InvalidArgument);
+}
+
 TEST_F(MethodMetaTest, TensorInfoApi) {
   Result<MethodMeta> method_meta = programs_["add"]->method_meta("forward");
   ASSERT_EQ(method_meta.error(), Error::Ok);
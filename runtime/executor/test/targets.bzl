@@ -114,6 +114,8 @@ def define_common_targets(is_fbcode = False):
             "ET_MODULE_ADD_HALF_PATH": "$(location fbcode//executorch/test/models:exported_programs[ModuleAddHalf.pte])",
             "ET_MODULE_ADD_PATH": "$(location fbcode//executorch/test/models:exported_programs[ModuleAdd.pte])",
             "ET_MODULE_DYNAMIC_CAT_UNALLOCATED_IO_PATH": "$(location fbcode//executorch/test/models:exported_programs[ModuleDynamicCatUnallocatedIO.pte])",
+            "ET_MODULE_DYNAMIC_MLP_PATH": "$(location fbcode//executorch/test/models:exported_programs[ModuleDynamicMLP.pte])",
+            "ET_MODULE_DYNAMIC_VIEW_PATH": "$(location fbcode//executorch/test/models:exported_programs[ModuleDynamicView.pte])",
             "ET_MODULE_INDEX_PATH": "$(location fbcode//executorch/test/models:exported_programs[ModuleIndex.pte])",
             "ET_MODULE_ADD_MUL_PATH": "$(location fbcode//executorch/test/models:exported_programs[ModuleAddMul.pte])",
             "ET_MODULE_MULTI_ENTRY_PATH": "$(location fbcode//executorch/test/models:exported_programs[ModuleMultipleEntry.pte])",
@@ -169,6 +171,33 @@ def define_common_targets(is_fbcode = False):
             env = modules_env,
         )
 
+        runtime.cxx_test(
+            name = "memory_planner_test",
+            srcs = [
+                "memory_planner_test.cpp",
+            ],
+            deps = [
+                ":managed_memory_manager",
+                "//executorch/runtime/executor:program",
+                "//executorch/extension/data_loader:file_data_loader",
+                "//executorch/kernels/portable:generated_lib",
+            ],
+            env = modules_env,
+        )
+
+        runtime.cxx_binary(
+            name = "memory_planner_benchmark",
+            srcs = [
+                "memory_planner_benchmark.cpp",
+            ],
+            deps = [
+                "//third-party/benchmark:benchmark",
+                "//executorch/runtime/executor:program",
+                "//executorch/extension/data_loader:file_data_loader",
+                "//executorch/kernels/portable:generated_lib",
+            ],
+        )
+
         runtime.cxx_test(
             name = "method_meta_test",
             srcs = [
@@ -33,6 +33,7 @@ EXECUTORCH_SRCS = [
 ]
 
 PROGRAM_NO_PRIM_OPS_SRCS = [
+    "memory_planner.cpp",
     "method.cpp",
     "method_meta.cpp",
     "program.cpp",
@@ -355,9 +356,14 @@ EXTENSION_RUNNER_UTIL_SRCS = [
 ]
 
 EXTENSION_LLM_RUNNER_SRCS = [
+    "extension/llm/runner/chunked_prefill_scheduler.cpp",
+    "extension/llm/runner/encoder_cache.cpp",
+    "extension/llm/runner/image_preprocessor.cpp",
+    "extension/llm/runner/log_mel_spectrogram.cpp",
     "extension/llm/runner/llm_runner_helper.cpp",
     "extension/llm/runner/multimodal_prefiller.cpp",
     "extension/llm/runner/multimodal_runner.cpp",
+    "extension/llm/runner/pipelined_multimodal_prefiller.cpp",
     "extension/llm/runner/text_decoder_runner.cpp",
     "extension/llm/runner/text_llm_runner.cpp",
     "extension/llm/runner/text_prefiller.cpp",
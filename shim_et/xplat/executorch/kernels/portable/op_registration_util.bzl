@@ -398,6 +398,7 @@ ATEN_OPS = (
     op_target(
         name = "op_cat",
         deps = [
+            "//executorch/kernels/portable/cpu/util:concat_util",
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
         ],
     ),
@@ -513,6 +514,7 @@ ATEN_OPS = (
         name = "op_embedding",
         deps = [
             "//executorch/kernels/portable/cpu/util:kernel_ops_util",
+            "//executorch/kernels/portable/cpu/util:gather_util",
         ],
     ),
     op_target(
@@ -532,12 +534,14 @@ ATEN_OPS = (
         name = "op_erf",
         deps = [
             "//executorch/kernels/portable/cpu/pattern:pattern",
+            "//executorch/kernels/portable/cpu/util:vectorized_math",
         ],
     ),
     op_target(
         name = "op_exp",
         deps = [
             "//executorch/kernels/portable/cpu/pattern:pattern",
+            "//executorch/kernels/portable/cpu/util:vectorized_math",
         ],
     ),
     op_target(
@@ -615,6 +619,7 @@ ATEN_OPS = (
         name = "op_gather",
         deps = [
             "//executorch/kernels/portable/cpu/util:index_util",
+            "//executorch/kernels/portable/cpu/util:gather_util",
         ],
     ),
     op_target(
@@ -631,8 +636,9 @@ ATEN_OPS = (
         name = "op_gelu",
         deps = [
             ":math_constants",
+            "//executorch/kernels/portable/cpu/pattern:pattern",
             "//executorch/kernels/portable/cpu/util:activation_ops_util",
-            "//executorch/kernels/portable/cpu/util:functional_util",
+            "//executorch/kernels/portable/cpu/util:vectorized_math",
         ],
     ),
     op_target(
@@ -674,6 +680,7 @@ ATEN_OPS = (
         deps = [
             "//executorch/kernels/portable/cpu/util:advanced_index_util",
             "//executorch/kernels/portable/cpu/util:broadcast_util",
+            "//executorch/kernels/portable/cpu/util:gather_util",
         ],
     ),
     op_target(
@@ -681,12 +688,14 @@ ATEN_OPS = (
         deps = [
             "//executorch/kernels/portable/cpu/util:advanced_index_util",
             "//executorch/kernels/portable/cpu/util:broadcast_util",
+            "//executorch/kernels/portable/cpu/util:gather_util",
         ],
     ),
     op_target(
         name = "op_index_select",
         deps = [
             "//executorch/kernels/portable/cpu/util:index_util",
+            "//executorch/kernels/portable/cpu/util:gather_util",
         ],
     ),
     op_target(
@@ -728,6 +737,7 @@ ATEN_OPS = (
         name = "op_log",
         deps = [
             "//executorch/kernels/portable/cpu/pattern:pattern",
+            "//executorch/kernels/portable/cpu/util:vectorized_math",
         ],
     ),
     op_target(
@@ -1121,12 +1131,14 @@ ATEN_OPS = (
         deps = [
             ":scalar_utils",
             "//executorch/kernels/portable/cpu/util:index_util",
+            "//executorch/kernels/portable/cpu/util:gather_util",
         ],
     ),
     op_target(
         name = "op_scatter_add",
         deps = [
             "//executorch/kernels/portable/cpu/util:index_util",
+            "//executorch/kernels/portable/cpu/util:gather_util",
             "//executorch/runtime/core/exec_aten/util:scalar_type_util",
             "//executorch/runtime/core/exec_aten/util:tensor_util",
         ],
@@ -1149,10 +1161,8 @@ ATEN_OPS = (
     op_target(
         name = "op_sigmoid",
         deps = [
-            "//executorch/kernels/portable/cpu/util:functional_util",
-            "//executorch/kernels/portable/cpu/util:elementwise_util",
-            "//executorch/kernels/portable/cpu/util:broadcast_util",
-            "//executorch/kernels/portable/cpu/util:dtype_util",
+            "//executorch/kernels/portable/cpu/pattern:pattern",
+            "//executorch/kernels/portable/cpu/util:vectorized_math",
         ],
     ),
     op_target(
@@ -1198,6 +1208,7 @@ ATEN_OPS = (
     op_target(
         name = "op_split_copy",
         deps = [
+            "//executorch/kernels/portable/cpu/util:concat_util",
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
         ],
     ),
@@ -1205,6 +1216,7 @@ ATEN_OPS = (
         name = "op_split_with_sizes_copy",
         deps = [
             "//executorch/kernels/portable/cpu/util:broadcast_util",
+            "//executorch/kernels/portable/cpu/util:concat_util",
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
         ],
     ),
@@ -1257,6 +1269,7 @@ ATEN_OPS = (
         name = "op_tanh",
         deps = [
             "//executorch/kernels/portable/cpu/pattern:pattern",
+            "//executorch/kernels/portable/cpu/util:vectorized_math",
         ],
     ),
     op_target(
@@ -1290,6 +1303,7 @@ ATEN_OPS = (
     op_target(
         name = "op_unbind_copy",
         deps = [
+            "//executorch/kernels/portable/cpu/util:concat_util",
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
         ],
     ),
@@ -143,6 +143,40 @@ class ModuleDynamicCatUnallocatedIO(nn.Module):
         return {"capture_config": CaptureConfig(pt2_mode=True, enable_aot=True)}
 
 
+class ModuleDynamicMLP(nn.Module):
+    def __init__(self):
+        super().__init__()
+        self.linear1 = nn.Linear(16, 64)
+        self.linear2 = nn.Linear(64, 16)
+
+    def forward(self, x):
+        return self.linear2(torch.relu(self.linear1(x)))
+
+    def get_random_inputs(self):
+        return (torch.randn(128, 16),)
+
+    def get_dynamic_shapes(self):
+        return ({0: Dim("seq_len", max=128)},)
+
+
+class ModuleDynamicView(nn.Module):
+    def __init__(self):
+        super().__init__()
+        self.linear = nn.Linear(16, 64)
+
+    def forward(self, x):
+        # The view shares the memory of its base, which is dead after the view
+        # is made, while the view is used until the add.
+        h = self.linear(x).view(-1, 16)
+        return torch.sigmoid(h) + h
+
+    def get_random_inputs(self):
+        return (torch.randn(128, 16),)
+
+    def get_dynamic_shapes(self):
+        return ({0: Dim("seq_len", max=128)},)
+
+
 class ModuleAddMul(torch.nn.Module):
     def __init__(self):
         super().__init__()
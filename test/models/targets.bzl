@@ -70,6 +70,8 @@ def define_common_targets():
         "ModuleIndex",
         "ModuleIntBool",
         "ModuleDynamicCatUnallocatedIO",
+        "ModuleDynamicMLP",
+        "ModuleDynamicView",
         "ModuleSimpleTrain",
         "ModuleStateful",
         "ModuleSharedState",
@@ -53,3 +53,34 @@ function(et_cxx_test target_name)
   add_test(NAME ${target_name} COMMAND ${target_name})
 
 endfunction()
+
+# A helper function to generate a google benchmark cxx executable target. The
+# target is only defined when google benchmark is installed, otherwise it is
+# skipped with a status message. @param target_name: name for the executable
+# @param SOURCES <list_of_sources>: benchmark sources to be compiled @param
+# EXTRA_LIBS <list_of_libs>: additional libraries to be linked against the
+# target. benchmark, benchmark_main and executorch_core are linked by default.
+#
+# Example: et_cxx_benchmark(my_benchmark SOURCES my_benchmark.cpp EXTRA_LIBS
+# portable_kernels)
+#
+function(et_cxx_benchmark target_name)
+
+  set(multi_arg_names SOURCES EXTRA_LIBS)
+  cmake_parse_arguments(ET_CXX_BENCHMARK "" "" "${multi_arg_names}" ${ARGN})
+
+  if(NOT TARGET benchmark::benchmark)
+    find_package(benchmark CONFIG QUIET)
+  endif()
+  if(NOT TARGET benchmark::benchmark)
+    message(STATUS "google benchmark not found, skipping ${target_name}")
+    return()
+  endif()
+
+  add_executable(${target_name} ${ET_CXX_BENCHMARK_SOURCES})
+  target_link_libraries(
+    ${target_name} benchmark::benchmark benchmark::benchmark_main
+    executorch_core ${ET_CXX_BENCHMARK_EXTRA_LIBS}
+  )
+
+endfunction()